@@ -18,6 +18,7 @@ import onl.YamlUtils
 import subprocess
 import platform
 import ast
+from onl.platform.bringup import ModuleLoader, DeviceLoader, Timeline
 
 class OnlInfoObject(object):
     DEFAULT_INDENT="    "
@@ -210,43 +211,40 @@ class OnlPlatformBase(object):
         #    /lib/modules/<kernel>
         #
 
-        kdir = "/lib/modules/%s" % os.uname()[2]
-        basename = "-".join(self.PLATFORM.split('-')[:-1])
-        odir = "%s/onl" % kdir
-        vdir = "%s/%s" % (odir, self.MANUFACTURER.lower())
-        bdir = "%s/%s" % (vdir, basename)
-        pdir = "%s/%s" % (vdir, self.PLATFORM)
-
-        searchdirs = [ os.path.join(vdir, self.PLATFORM),
-                       os.path.join(vdir, basename),
-                       os.path.join(vdir, "common"),
-                       os.path.join(odir, "onl", "common"),
-                       odir,
-                       kdir,
-                       ]
-
-        trypaths = []
-        for d in searchdirs:
-            for e in [ ".ko", "" ]:
-                path = os.path.join(d, "%s%s" % (module, e))
-                if os.path.exists(path):
-                    cmd = "insmod %s %s" % (path, " ".join([ "%s=%s" % (k,v) for (k,v) in params.iteritems() ]))
-                    subprocess.check_call(cmd, shell=True);
-                    return True
-                else:
-                    trypaths.append(path)
+        path, trypaths = self.module_loader().find(module)
+        if path is not None:
+            self.module_loader().load(path, params)
+            return True
 
         if required:
             raise RuntimeError("kernel module %s could not be found.\n The following paths were searched: \n    %s\n" % (module, "\n   ".join(trypaths)))
         else:
             return False
 
+    def module_loader(self):
+        if not hasattr(self, '_module_loader'):
+            kdir = "/lib/modules/%s" % os.uname()[2]
+            basename = "-".join(self.PLATFORM.split('-')[:-1])
+            odir = "%s/onl" % kdir
+            vdir = "%s/%s" % (odir, self.MANUFACTURER.lower())
+
+            searchdirs = [ os.path.join(vdir, self.PLATFORM),
+                           os.path.join(vdir, basename),
+                           os.path.join(vdir, "common"),
+                           os.path.join(odir, "onl", "common"),
+                           odir,
+                           kdir,
+                           ]
+            self._module_loader = ModuleLoader(searchdirs)
+        return self._module_loader
+
     def insmod_platform(self):
         kv = os.uname()[2]
         # Insert all modules in the platform module directories
         directories = [ self.PLATFORM,
                         '-'.join(self.PLATFORM.split('-')[:-1]) ]
 
+        modules = []
         for subdir in directories:
             d = "/lib/modules/%s/onl/%s/%s" % (kv,
                                                self.MANUFACTURER.lower(),
@@ -254,7 +252,32 @@ class OnlPlatformBase(object):
             if os.path.isdir(d):
                 for f in os.listdir(d):
                     if f.endswith(".ko"):
-                        self.insmod(f)
+                        modules.append((os.path.join(d, f), {}))
+        self.module_loader().load_all(modules)
+
+    def bringup(self, modules=[], devices=[], ordered=[]):
+        """Loads the modules, then instantiates the i2c devices.
+
+        modules is a list of module names or (name, params) pairs.
+        They are loaded in dependency order, independent modules
+        concurrently.
+
+        devices is a list of (driver, addr, bus_number) tuples.
+        Devices on independent buses are created concurrently.
+        Muxes, gpio expanders and the platform drivers named in
+        ordered (those which create i2c buses or gpiochips) are
+        created one at a time, in list order."""
+        paths = []
+        for m in modules:
+            (name, params) = m if isinstance(m, tuple) else (m, {})
+            path, trypaths = self.module_loader().find(name)
+            if path is None:
+                raise RuntimeError("kernel module %s could not be found.\n The following paths were searched: \n    %s\n" % (name, "\n   ".join(trypaths)))
+            paths.append((path, params))
+
+        self.module_loader().load_all(paths)
+        DeviceLoader(self.new_i2c_device, ordered).load_all(devices)
+        return True
 
     def onie_machine_get(self):
         mc = self.basedir_onl("etc/onie/machine.json")
@@ -5,8 +5,10 @@
 ############################################################
 import sys
 import os
+import subprocess
 from onl.platform.base import OnlPlatformBase
 from onl.platform.current import OnlPlatform
+from onl.platform.bringup import Timeline
 import shutil
 
 def msg(s, fatal=False):
@@ -76,13 +78,20 @@ def baseconfig():
                 [msg("*** %s\n" % x) for x in buf.splitlines(False)]
             mod.clear_warnings()
 
-    if not platform.baseconfig():
-        msg("*** platform class baseconfig failed.\n", fatal=True)
+    with Timeline("%s baseconfig" % platform.platform()):
+        if not platform.baseconfig():
+            msg("*** platform class baseconfig failed.\n", fatal=True)
 
     if os.path.exists(ONLPDUMP):
-        os.system("%s -i > %s/oids" % (ONLPDUMP,platform.basedir_onl()))
-        os.system("%s -o -j > %s/onie-info.json" % (ONLPDUMP, platform.basedir_onl()))
-        os.system("%s -x -j > %s/platform-info.json" % (ONLPDUMP, platform.basedir_onl()))
+        # The dumps are independent; run them concurrently.
+        with Timeline("onlpdump"):
+            dumps = [ subprocess.Popen(cmd, shell=True) for cmd in
+                      [ "%s -i > %s/oids" % (ONLPDUMP,platform.basedir_onl()),
+                        "%s -o -j > %s/onie-info.json" % (ONLPDUMP, platform.basedir_onl()),
+                        "%s -x -j > %s/platform-info.json" % (ONLPDUMP, platform.basedir_onl()),
+                        ] ]
+            for p in dumps:
+                p.wait()
 
     msg("Setting up base platform configuration for %s: done\n" %
         platform.platform())
@@ -0,0 +1,233 @@
+############################################################
+#
+# Platform Bring-up
+#
+# Kernel modules and i2c devices are brought up as a
+# dependency graph:
+#
+# - Modules are loaded with finit_module(2) in the order
+#   given by their modinfo dependencies. Modules which do
+#   not depend on each other are loaded concurrently.
+#
+# - i2c devices are grouped by bus. Each bus is populated
+#   in list order, independent buses concurrently. Devices
+#   which allocate numbered resources (muxes and other i2c
+#   adapters, gpio expanders) are created one at a time, in
+#   list order, so the bus numbers and gpiochip bases they
+#   are given do not change.
+#
+#   Only platforms which call bringup() are populated this
+#   way. new_i2c_devices() creates devices one at a time.
+#
+# Every step is recorded in the boot timeline.
+#
+############################################################
+import os
+import re
+import time
+import errno
+import ctypes
+import platform
+import threading
+import subprocess
+
+TIMELINE='/var/log/onl-boot-timeline'
+
+# How long to wait for an i2c bus created by a mux.
+BUS_WAIT_TIMEOUT=5.0
+
+# Drivers which create i2c buses or gpiochips. Their bus numbers
+# and gpio bases depend on the order in which they are probed.
+ORDERED_DRIVERS=re.compile(r'^(pca95\d\d|pca9505|pca9698|pca6\d\d\d|pcal\d+|'
+                           r'tca[69]\d\d\d|pcf857\d|max73\d\d|mcp230\d\d)|'
+                           r'mux|gpio')
+
+class Timeline(object):
+    """Records boot steps as '<start> <duration> <step>' lines.
+
+    The boot.d scripts write the same format."""
+
+    lock = threading.Lock()
+
+    def __init__(self, step):
+        self.step = step
+
+    def __enter__(self):
+        self.start = time.time()
+        return self
+
+    def __exit__(self, type_, value, tb):
+        Timeline.record(self.step, self.start)
+        return False
+
+    @staticmethod
+    def record(step, start, end=None):
+        if end is None:
+            end = time.time()
+        line = "%.3f %8.3f %s\n" % (start, end - start, step)
+        with Timeline.lock:
+            try:
+                with open(TIMELINE, "a") as f:
+                    f.write(line)
+            except IOError:
+                pass
+
+
+class ModuleLoader(object):
+
+    # finit_module(2) system call numbers.
+    SYS_FINIT_MODULE = { 'x86_64'  : 313,
+                         'i386'    : 350,
+                         'i686'    : 350,
+                         'armv7l'  : 379,
+                         'aarch64' : 273,
+                         'ppc'     : 353,
+                         'ppc64'   : 353,
+                         }
+
+    def __init__(self, searchdirs):
+        self.searchdirs = searchdirs
+        self.index = {}
+        self.nr = self.SYS_FINIT_MODULE.get(platform.machine(), None)
+        self.libc = ctypes.CDLL(None, use_errno=True)
+
+    def find(self, module):
+        """Returns the path of the module, or the list of paths searched."""
+        trypaths = []
+        for d in self.searchdirs:
+            if d not in self.index:
+                self.index[d] = set(os.listdir(d)) if os.path.isdir(d) else set()
+            for e in [ ".ko", "" ]:
+                f = "%s%s" % (module, e)
+                if f in self.index[d]:
+                    return (os.path.join(d, f), None)
+                trypaths.append(os.path.join(d, f))
+        return (None, trypaths)
+
+    @staticmethod
+    def name(path):
+        return os.path.basename(path).replace('.ko', '').replace('-', '_')
+
+    @staticmethod
+    def depends(path):
+        """Returns the module's modinfo dependencies."""
+        with open(path, "rb") as f:
+            data = f.read()
+        i = data.find("\0depends=")
+        if i < 0:
+            return []
+        i += len("\0depends=")
+        return [ d for d in data[i:data.find("\0", i)].split(',') if d ]
+
+    def load(self, path, params={}):
+        args = " ".join([ "%s=%s" % (k,v) for (k,v) in params.iteritems() ])
+        with Timeline("insmod %s" % os.path.basename(path)):
+            if self.nr is not None:
+                fd = os.open(path, os.O_RDONLY)
+                try:
+                    rv = self.libc.syscall(self.nr, fd, ctypes.c_char_p(args), 0)
+                    err = ctypes.get_errno()
+                finally:
+                    os.close(fd)
+                if rv == 0 or err == errno.EEXIST:
+                    return
+                if err != errno.ENOSYS:
+                    raise OSError(err, "%s: %s" % (path, os.strerror(err)))
+            subprocess.check_call("insmod %s %s" % (path, args), shell=True)
+
+    def load_all(self, modules):
+        """Loads (path, params) pairs in dependency order.
+
+        Dependencies on modules outside the list are assumed
+        to be loaded already."""
+        pending = dict([ (self.name(p), (p, params)) for (p, params) in modules ])
+        deps = dict([ (n, set(self.depends(p)) & set(pending.keys()))
+                      for (n, (p, params)) in pending.iteritems() ])
+        errors = []
+
+        def load(n):
+            try:
+                self.load(*pending[n])
+            except Exception, e:
+                errors.append(e)
+
+        while pending:
+            ready = [ n for n in pending if not (deps[n] & set(pending.keys())) ]
+            if not ready:
+                # Circular dependencies. Load the rest in list order.
+                ready = [ self.name(p) for (p, params) in modules if self.name(p) in pending ]
+                for n in ready:
+                    load(n)
+            else:
+                threads = [ threading.Thread(target=load, args=(n,)) for n in ready ]
+                for t in threads:
+                    t.start()
+                for t in threads:
+                    t.join()
+            for n in ready:
+                del pending[n]
+            if errors:
+                raise errors[0]
+
+
+class DeviceLoader(object):
+
+    def __init__(self, create, ordered=[]):
+        # create(driver, addr, bus_number) instantiates one device.
+        self.create = create
+        # Platform drivers which also create buses or gpiochips.
+        self.ordered = ordered
+
+    def is_ordered(self, driver):
+        return driver in self.ordered or ORDERED_DRIVERS.search(driver) is not None
+
+    def bus_wait(self, bus_number):
+        bus = '/sys/bus/i2c/devices/i2c-%d' % bus_number
+        deadline = time.time() + BUS_WAIT_TIMEOUT
+        while not os.path.exists(bus) and time.time() < deadline:
+            time.sleep(0.01)
+
+    def populate(self, bus_number, devices):
+        start = time.time()
+        self.bus_wait(bus_number)
+        for (driver, addr) in devices:
+            self.create(driver, addr, bus_number)
+        Timeline.record("i2c-%d: %s" % (bus_number,
+                                        ", ".join([ "%s@0x%x" % d for d in devices ])),
+                        start)
+
+    def populate_all(self, devices):
+        buses = []
+        bydev = {}
+        for (driver, addr, bus_number) in devices:
+            if bus_number not in bydev:
+                buses.append(bus_number)
+                bydev[bus_number] = []
+            bydev[bus_number].append((driver, addr))
+
+        if len(buses) == 1:
+            self.populate(buses[0], bydev[buses[0]])
+            return
+
+        threads = [ threading.Thread(target=self.populate, args=(b, bydev[b])) for b in buses ]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+    def load_all(self, devices):
+        """Instantiates (driver, addr, bus_number) devices.
+
+        Each device which creates buses or gpiochips waits for the
+        devices listed before it, and is created alone."""
+        segment = []
+        for (driver, addr, bus_number) in devices:
+            if self.is_ordered(driver):
+                if segment:
+                    self.populate_all(segment)
+                    segment = []
+                self.populate(bus_number, [ (driver, addr) ])
+            else:
+                segment.append((driver, addr, bus_number))
+        if segment:
+            self.populate_all(segment)
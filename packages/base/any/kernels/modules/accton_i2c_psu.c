@@ -51,13 +51,34 @@
  */
 static const unsigned short normal_i2c[] = { I2C_CLIENT_END };
 
+/* Refresh interval of the telemetry registers, in ms */
+static unsigned int update_interval = 1500;
+module_param(update_interval, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(update_interval, "Telemetry refresh interval in ms (default 1500)");
+
+/* Registers are refreshed in groups, only the group of the attribute being
+ * read is refreshed. The static group (identity strings, vout mode) is read
+ * once, and again only after a read fails or power good changes (PSU
+ * removed, replaced or unplugged). The status group is refreshed on every
+ * update so a power good change is noticed.
+ */
+enum accton_i2c_psu_update_group {
+    UPDATE_STATIC = 0,
+    UPDATE_STATUS,
+    UPDATE_POWER,
+    UPDATE_TEMP,
+    UPDATE_FAN,
+    UPDATE_GROUP_COUNT
+};
+
 /* Each client has this additional data 
  */
 struct accton_i2c_psu_data {
     struct device      *hwmon_dev;
     struct mutex        update_lock;
-    char                valid;           /* !=0 if registers are valid */
-    unsigned long       last_updated;    /* In jiffies */
+    char                valid;           /* !=0 if the last update succeeded */
+    char                group_valid[UPDATE_GROUP_COUNT];   /* !=0 if the group is valid */
+    unsigned long       group_updated[UPDATE_GROUP_COUNT]; /* In jiffies */
     u8   vout_mode;     /* Register value */
     u16  v_in;          /* Register value */
     u16  v_out;         /* Register value */
@@ -66,6 +87,8 @@ struct accton_i2c_psu_data {
     u16  p_in;          /* Register value */
     u16  p_out;         /* Register value */
     u16  temp_input[2]; /* Register value */
+    u16  status_word;   /* Register value */
+    char power_good;    /* Power good at the last status update */
     u8   fan_fault;     /* Register value */
     u16  fan_duty_cycle[2];  /* Register value */
     u16  fan_speed[2];  /* Register value */
@@ -86,7 +109,8 @@ static ssize_t show_byte(struct device *dev, struct device_attribute *da,
 			 char *buf);
 			 			 
 static int accton_i2c_psu_write_word(struct i2c_client *client, u8 reg, u16 value);
-static struct accton_i2c_psu_data *accton_i2c_psu_update_device(struct device *dev);
+static struct accton_i2c_psu_data *accton_i2c_psu_update_device(struct device *dev,
+                                                                struct device_attribute *da);
 
 enum accton_i2c_psu_sysfs_attributes {
     PSU_V_IN,
@@ -180,7 +204,7 @@ static ssize_t show_linear(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
+    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev, da);
 
     u16 value = 0;
     int exponent, mantissa;
@@ -232,7 +256,7 @@ static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
+    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev, da);
 
     u8 shift = (attr->index == PSU_FAN1_FAULT) ? 7 : 6;
 
@@ -242,7 +266,7 @@ static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da,
 static ssize_t show_vout(struct device *dev, struct device_attribute *da,
              char *buf)
 {
-    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
+    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev, da);
     int exponent, mantissa;    
 
     exponent = two_complement_to_int(data->vout_mode, 5, 0x1f);
@@ -256,7 +280,7 @@ static ssize_t show_byte(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-	struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
+	struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev, da);
 	
 	if (!data->valid) {
 		return 0;
@@ -270,7 +294,7 @@ static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-	struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
+	struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev, da);
 	u8 *ptr = NULL;
 
 	if (!data->valid) {
@@ -506,102 +530,189 @@ EXIT_READ_BLOCK_DATA:
 
 
 struct reg_data_byte {
+    u8   group;
     u8   reg;
     u8  *value;
 };
 
 struct reg_data_word {
+    u8   group;
     u8   reg;
     u16 *value;
 };
 
-static struct accton_i2c_psu_data *accton_i2c_psu_update_device(struct device *dev)
+static int accton_i2c_psu_attr_group(int index)
+{
+    switch (index) {
+    case PSU_V_IN:
+    case PSU_V_OUT:
+    case PSU_I_IN:
+    case PSU_I_OUT:
+    case PSU_P_IN:
+    case PSU_P_OUT:
+        return UPDATE_POWER;
+    case PSU_TEMP1_INPUT:
+        return UPDATE_TEMP;
+    case PSU_FAN1_FAULT:
+        return UPDATE_STATUS;
+    case PSU_FAN1_DUTY_CYCLE:
+    case PSU_FAN1_SPEED:
+        return UPDATE_FAN;
+    default:
+        return UPDATE_STATIC;
+    }
+}
+
+static int accton_i2c_psu_update_group(struct i2c_client *client,
+                                       struct accton_i2c_psu_data *data, int group)
+{
+    int i, status, failed = 0;
+    struct reg_data_byte regs_byte[] = { {UPDATE_STATIC, PMBUS_REGISTER_VOUT_MODE, &data->vout_mode},
+                                         {UPDATE_STATUS, PMBUS_REGISTER_STATUS_FAN, &data->fan_fault}};
+    struct reg_data_word regs_word[] = { {UPDATE_STATUS, PMBUS_REGISTER_STATUS_WORD, &data->status_word},
+                                         {UPDATE_POWER, PMBUS_REGISTER_READ_VIN, &data->v_in},
+                                         {UPDATE_POWER, PMBUS_REGISTER_READ_VOUT, &data->v_out},
+                                         {UPDATE_POWER, PMBUS_REGISTER_READ_IIN, &data->i_in},
+                                         {UPDATE_POWER, PMBUS_REGISTER_READ_IOUT, &data->i_out},
+                                         {UPDATE_POWER, PMBUS_REGISTER_READ_POUT, &data->p_out},
+                                         {UPDATE_POWER, PMBUS_REGISTER_READ_PIN, &data->p_in},
+                                         {UPDATE_TEMP,  PMBUS_REGISTER_READ_TEMPERATURE_1, &(data->temp_input[0])},
+                                         {UPDATE_TEMP,  PMBUS_REGISTER_READ_TEMPERATURE_2, &(data->temp_input[1])},
+                                         {UPDATE_FAN,   PMBUS_REGISTER_FAN_COMMAND_1, &(data->fan_duty_cycle[0])},
+                                         {UPDATE_FAN,   PMBUS_REGISTER_READ_FAN_SPEED_1, &(data->fan_speed[0])},
+                                         {UPDATE_FAN,   PMBUS_REGISTER_READ_FAN_SPEED_2, &(data->fan_speed[1])},
+                                         };
+
+    /* Read byte data */        
+    for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
+        if (regs_byte[i].group != group) {
+            continue;
+        }
+
+        status = accton_i2c_psu_read_byte(client, regs_byte[i].reg);
+        
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_byte[i].reg, status);
+            failed = 1;
+        }
+        else {
+            *(regs_byte[i].value) = status;
+        }
+    }
+                
+    /* Read word data */                    
+    for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
+        if (regs_word[i].group != group) {
+            continue;
+        }
+
+        status = accton_i2c_psu_read_word(client, regs_word[i].reg);
+        
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_word[i].reg, status);
+            failed = 1;
+        }
+        else {
+            *(regs_word[i].value) = status;
+        }
+    }
+
+    /* Telemetry read errors are not fatal, but the PSU may have been
+     * replaced, so read the static registers again next time.
+     */
+    if (failed) {
+        data->group_valid[UPDATE_STATIC] = 0;
+    }
+
+    if (group != UPDATE_STATIC) {
+        return 0;
+    }
+
+    /* Read mfr_id */
+    status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_ID, data->mfr_id,
+                                     ARRAY_SIZE(data->mfr_id));
+    if (status < 0) {
+        dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_ID, status);
+        return status;
+    }
+    /* Read mfr_model */
+    status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_MODEL, data->mfr_model,
+                                     ARRAY_SIZE(data->mfr_model));
+    if (status < 0) {
+        dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_MODEL, status);
+        return status;
+    }
+    /* Read mfr_revsion */
+    status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_REVISION, data->mfr_revsion,
+                                     ARRAY_SIZE(data->mfr_revsion));
+    if (status < 0) {
+        dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_REVISION, status);
+        return status;
+    }
+    /* Read mfr_serial */
+    status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_SERIAL, data->mfr_serial,
+                                     ARRAY_SIZE(data->mfr_serial));
+    if (status < 0) {
+        dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_SERIAL, status);
+        return status;
+    }
+
+    return failed ? -EIO : 0;
+}
+
+static struct accton_i2c_psu_data *accton_i2c_psu_update_device(struct device *dev,
+                                                                struct device_attribute *da)
 {
     struct i2c_client *client = to_i2c_client(dev);
     struct accton_i2c_psu_data *data = i2c_get_clientdata(client);
+    struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+    int groups[] = { UPDATE_STATUS, UPDATE_STATIC, accton_i2c_psu_attr_group(attr->index) };
+    int i, group, status;
+    char power_good;
     
     mutex_lock(&data->update_lock);
 
-    if (time_after(jiffies, data->last_updated + HZ + HZ / 2)
-        || !data->valid) {
-        int i, status, length;
-        u8 command, buf;
-        struct reg_data_byte regs_byte[] = { {PMBUS_REGISTER_VOUT_MODE, &data->vout_mode},
-                                             {PMBUS_REGISTER_STATUS_FAN, &data->fan_fault}};
-        struct reg_data_word regs_word[] = { {PMBUS_REGISTER_READ_VIN, &data->v_in},
-                                             {PMBUS_REGISTER_READ_VOUT, &data->v_out},
-                                             {PMBUS_REGISTER_READ_IIN, &data->i_in},
-                                             {PMBUS_REGISTER_READ_IOUT, &data->i_out},
-                                             {PMBUS_REGISTER_READ_POUT, &data->p_out},
-                                             {PMBUS_REGISTER_READ_PIN, &data->p_in},
-                                             {PMBUS_REGISTER_READ_TEMPERATURE_1, &(data->temp_input[0])},
-                                             {PMBUS_REGISTER_READ_TEMPERATURE_2, &(data->temp_input[1])},
-                                             {PMBUS_REGISTER_FAN_COMMAND_1, &(data->fan_duty_cycle[0])},
-                                             {PMBUS_REGISTER_READ_FAN_SPEED_1, &(data->fan_speed[0])},
-                                             {PMBUS_REGISTER_READ_FAN_SPEED_2, &(data->fan_speed[1])},
-                                             };
-
-        dev_dbg(&client->dev, "Starting accton_i2c_psu update\n");
-
-        /* Read byte data */        
-        for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
-            status = accton_i2c_psu_read_byte(client, regs_byte[i].reg);
-            
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_byte[i].reg, status);
-            }
-            else {
-                *(regs_byte[i].value) = status;
-            }
+    data->valid = 0;
+
+    for (i = 0; i < ARRAY_SIZE(groups); i++) {
+        group = groups[i];
+
+        if (data->group_valid[group] && (group == UPDATE_STATIC ||
+            time_before(jiffies, data->group_updated[group] +
+                                 msecs_to_jiffies(update_interval)))) {
+            continue;
         }
-                    
-        /* Read word data */                    
-        for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
-            status = accton_i2c_psu_read_word(client, regs_word[i].reg);
-            
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_word[i].reg, status);
-            }
-            else {
-                *(regs_word[i].value) = status;
+
+        dev_dbg(&client->dev, "Starting accton_i2c_psu update, group %d\n", group);
+        data->group_valid[group] = 0;
+
+        status = accton_i2c_psu_update_group(client, data, group);
+        if (status < 0) {
+            /* The PSU may have been replaced, re-read everything */
+            memset(data->group_valid, 0, sizeof(data->group_valid));
+            goto exit;
+        }
+
+        data->group_updated[group] = jiffies;
+        data->group_valid[group] = 1;
+
+        if (group == UPDATE_STATUS) {
+            /* Power good (high byte bit 3 of status_word, 0=>OK) drops when
+             * the PSU is pulled or loses input, re-read the static registers
+             * on either edge.
+             */
+            power_good = (data->status_word & 0x800) ? 0 : 1;
+            if (power_good != data->power_good) {
+                data->power_good = power_good;
+                data->group_valid[UPDATE_STATIC] = 0;
             }
-            
         }
-        /* Read mfr_id */
-		status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_ID, data->mfr_id,
-										 ARRAY_SIZE(data->mfr_id));
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_ID, status);
-			goto exit;
-		}		
-		/* Read mfr_model */		
-		status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_MODEL, data->mfr_model,
-										 ARRAY_SIZE(data->mfr_model));
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_MODEL, status);
-			goto exit;
-		}
-        /* Read mfr_revsion */		
-		status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_REVISION, data->mfr_revsion,
-										 ARRAY_SIZE(data->mfr_revsion));
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_REVISION, status);
-			goto exit;
-		}
-		/* Read mfr_serial */
-		status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_SERIAL, data->mfr_serial,
-										 ARRAY_SIZE(data->mfr_serial));
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_SERIAL, status);
-			goto exit;
-		}
-        
-        data->last_updated = jiffies;
-        data->valid = 1;
     }
 
+    data->valid = 1;
+
 exit:
     mutex_unlock(&data->update_lock);
 
@@ -38,13 +38,34 @@
  */
 static const unsigned short normal_i2c[] = { 0x3c, 0x3d, 0x3e, 0x3f, I2C_CLIENT_END };
 
+/* Refresh interval of the telemetry registers, in ms */
+static unsigned int update_interval = 1500;
+module_param(update_interval, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(update_interval, "Telemetry refresh interval in ms (default 1500)");
+
+/* Registers are refreshed in groups, only the group of the attribute being
+ * read is refreshed. The static group (vout mode) is read once, and again
+ * only after a read fails or power good changes (PSU removed, replaced or
+ * unplugged). The status group is refreshed on every update so a power
+ * good change is noticed.
+ */
+enum cpr_4011_4mxx_update_group {
+    UPDATE_STATIC = 0,
+    UPDATE_STATUS,
+    UPDATE_POWER,
+    UPDATE_TEMP,
+    UPDATE_FAN,
+    UPDATE_GROUP_COUNT
+};
+
 /* Each client has this additional data 
  */
 struct cpr_4011_4mxx_data {
     struct device      *hwmon_dev;
     struct mutex        update_lock;
-    char                valid;           /* !=0 if registers are valid */
-    unsigned long       last_updated;    /* In jiffies */
+    char                valid;           /* !=0 if the last update succeeded */
+    char                group_valid[UPDATE_GROUP_COUNT];   /* !=0 if the group is valid */
+    unsigned long       group_updated[UPDATE_GROUP_COUNT]; /* In jiffies */
     u8   vout_mode;     /* Register value */
     u16  v_in;          /* Register value */
     u16  v_out;         /* Register value */
@@ -53,6 +74,8 @@ struct cpr_4011_4mxx_data {
     u16  p_in;          /* Register value */
     u16  p_out;         /* Register value */
     u16  temp_input[2]; /* Register value */
+    u16  status_word;   /* Register value */
+    char power_good;    /* Power good at the last status update */
     u8   fan_fault;     /* Register value */
     u16  fan_duty_cycle[2];  /* Register value */
     u16  fan_speed[2];  /* Register value */
@@ -63,7 +86,8 @@ static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da, c
 static ssize_t show_vout(struct device *dev, struct device_attribute *da, char *buf);
 static ssize_t set_fan_duty_cycle(struct device *dev, struct device_attribute *da, const char *buf, size_t count);
 static int cpr_4011_4mxx_write_word(struct i2c_client *client, u8 reg, u16 value);
-static struct cpr_4011_4mxx_data *cpr_4011_4mxx_update_device(struct device *dev);
+static struct cpr_4011_4mxx_data *cpr_4011_4mxx_update_device(struct device *dev,
+                                                              struct device_attribute *da);
 
 enum cpr_4011_4mxx_sysfs_attributes {
     PSU_V_IN,
@@ -142,7 +166,7 @@ static ssize_t show_linear(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev);
+    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev, da);
 
     u16 value = 0;
     int exponent, mantissa;
@@ -190,7 +214,7 @@ static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev);
+    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev, da);
 
     u8 shift = (attr->index == PSU_FAN1_FAULT) ? 7 : 6;
 
@@ -200,7 +224,7 @@ static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da,
 static ssize_t show_vout(struct device *dev, struct device_attribute *da,
              char *buf)
 {
-    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev);
+    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev, da);
     int exponent, mantissa;
     int multiplier = 1000;
 
@@ -320,72 +344,159 @@ static int cpr_4011_4mxx_write_word(struct i2c_client *client, u8 reg, u16 value
 }
 
 struct reg_data_byte {
+    u8   group;
     u8   reg;
     u8  *value;
 };
 
 struct reg_data_word {
+    u8   group;
     u8   reg;
     u16 *value;
 };
 
-static struct cpr_4011_4mxx_data *cpr_4011_4mxx_update_device(struct device *dev)
+static int cpr_4011_4mxx_attr_group(int index)
+{
+    switch (index) {
+    case PSU_V_IN:
+    case PSU_V_OUT:
+    case PSU_I_IN:
+    case PSU_I_OUT:
+    case PSU_P_IN:
+    case PSU_P_OUT:
+        return UPDATE_POWER;
+    case PSU_TEMP1_INPUT:
+        return UPDATE_TEMP;
+    case PSU_FAN1_FAULT:
+        return UPDATE_STATUS;
+    case PSU_FAN1_DUTY_CYCLE:
+    case PSU_FAN1_SPEED:
+        return UPDATE_FAN;
+    default:
+        return UPDATE_STATIC;
+    }
+}
+
+static int cpr_4011_4mxx_update_group(struct i2c_client *client,
+                                      struct cpr_4011_4mxx_data *data, int group)
+{
+    int i, status, failed = 0;
+    struct reg_data_byte regs_byte[] = { {UPDATE_STATIC, 0x20, &data->vout_mode},
+                                         {UPDATE_STATUS, 0x81, &data->fan_fault}};
+    struct reg_data_word regs_word[] = { {UPDATE_STATUS, 0x79, &data->status_word},
+                                         {UPDATE_POWER, 0x88, &data->v_in},
+                                         {UPDATE_POWER, 0x8b, &data->v_out},
+                                         {UPDATE_POWER, 0x89, &data->i_in},
+                                         {UPDATE_POWER, 0x8c, &data->i_out},
+                                         {UPDATE_POWER, 0x96, &data->p_out},
+                                         {UPDATE_POWER, 0x97, &data->p_in},
+                                         {UPDATE_TEMP,  0x8d, &(data->temp_input[0])},
+                                         {UPDATE_TEMP,  0x8e, &(data->temp_input[1])},
+                                         {UPDATE_FAN,   0x3b, &(data->fan_duty_cycle[0])},
+                                         {UPDATE_FAN,   0x3c, &(data->fan_duty_cycle[1])},
+                                         {UPDATE_FAN,   0x90, &(data->fan_speed[0])},
+                                         {UPDATE_FAN,   0x91, &(data->fan_speed[1])}};
+
+    /* Read byte data */        
+    for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
+        if (regs_byte[i].group != group) {
+            continue;
+        }
+
+        status = cpr_4011_4mxx_read_byte(client, regs_byte[i].reg);
+        
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_byte[i].reg, status);
+            failed = 1;
+        }
+        else {
+            *(regs_byte[i].value) = status;
+        }
+    }
+                
+    /* Read word data */                    
+    for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
+        if (regs_word[i].group != group) {
+            continue;
+        }
+
+        status = cpr_4011_4mxx_read_word(client, regs_word[i].reg);
+        
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_word[i].reg, status);
+            failed = 1;
+        }
+        else {
+            *(regs_word[i].value) = status;
+        }
+    }
+
+    if (!failed) {
+        return 0;
+    }
+
+    /* Telemetry read errors are not fatal, but the PSU may have been
+     * replaced, so read the static registers again next time.
+     */
+    data->group_valid[UPDATE_STATIC] = 0;
+
+    return (group == UPDATE_STATIC) ? -EIO : 0;
+}
+
+static struct cpr_4011_4mxx_data *cpr_4011_4mxx_update_device(struct device *dev,
+                                                              struct device_attribute *da)
 {
     struct i2c_client *client = to_i2c_client(dev);
     struct cpr_4011_4mxx_data *data = i2c_get_clientdata(client);
+    struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+    int groups[] = { UPDATE_STATUS, UPDATE_STATIC, cpr_4011_4mxx_attr_group(attr->index) };
+    int i, group, status;
+    char power_good;
     
     mutex_lock(&data->update_lock);
 
-    if (time_after(jiffies, data->last_updated + HZ + HZ / 2)
-        || !data->valid) {
-        int i, status;
-        struct reg_data_byte regs_byte[] = { {0x20, &data->vout_mode},
-                                             {0x81, &data->fan_fault}};
-        struct reg_data_word regs_word[] = { {0x88, &data->v_in},
-                                             {0x8b, &data->v_out},
-                                             {0x89, &data->i_in},
-                                             {0x8c, &data->i_out},
-                                             {0x96, &data->p_out},
-                                             {0x97, &data->p_in},
-                                             {0x8d, &(data->temp_input[0])},
-                                             {0x8e, &(data->temp_input[1])},
-                                             {0x3b, &(data->fan_duty_cycle[0])},
-                                             {0x3c, &(data->fan_duty_cycle[1])},
-                                             {0x90, &(data->fan_speed[0])},
-                                             {0x91, &(data->fan_speed[1])}};
-
-        dev_dbg(&client->dev, "Starting cpr_4011_4mxx update\n");
-
-        /* Read byte data */        
-        for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
-            status = cpr_4011_4mxx_read_byte(client, regs_byte[i].reg);
-            
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_byte[i].reg, status);
-            }
-            else {
-                *(regs_byte[i].value) = status;
-            }
+    data->valid = 0;
+
+    for (i = 0; i < ARRAY_SIZE(groups); i++) {
+        group = groups[i];
+
+        if (data->group_valid[group] && (group == UPDATE_STATIC ||
+            time_before(jiffies, data->group_updated[group] +
+                                 msecs_to_jiffies(update_interval)))) {
+            continue;
         }
-                    
-        /* Read word data */                    
-        for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
-            status = cpr_4011_4mxx_read_word(client, regs_word[i].reg);
-            
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_word[i].reg, status);
-            }
-            else {
-                *(regs_word[i].value) = status;
+
+        dev_dbg(&client->dev, "Starting cpr_4011_4mxx update, group %d\n", group);
+        data->group_valid[group] = 0;
+
+        status = cpr_4011_4mxx_update_group(client, data, group);
+        if (status < 0) {
+            /* The PSU may have been replaced, re-read everything */
+            memset(data->group_valid, 0, sizeof(data->group_valid));
+            goto exit;
+        }
+
+        data->group_updated[group] = jiffies;
+        data->group_valid[group] = 1;
+
+        if (group == UPDATE_STATUS) {
+            /* Power good (high byte bit 3 of status_word, 0=>OK) drops when
+             * the PSU is pulled or loses input, re-read the static registers
+             * on either edge.
+             */
+            power_good = (data->status_word & 0x800) ? 0 : 1;
+            if (power_good != data->power_good) {
+                data->power_good = power_good;
+                data->group_valid[UPDATE_STATIC] = 0;
             }
         }
-        
-        data->last_updated = jiffies;
-        data->valid = 1;
     }
 
+    data->valid = 1;
+
+exit:
     mutex_unlock(&data->update_lock);
 
     return data;
@@ -41,6 +41,26 @@
  */
 static const unsigned short normal_i2c[] = { I2C_CLIENT_END };
 
+/* Refresh interval of the telemetry registers, in ms */
+static unsigned int update_interval = 1500;
+module_param(update_interval, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(update_interval, "Telemetry refresh interval in ms (default 1500)");
+
+/* Registers are refreshed in groups, only the group of the attribute being
+ * read is refreshed. The static group (model, serial, vout mode) is read
+ * once, and again only after a read fails or power good changes (PSU
+ * removed, replaced or unplugged). The status group is refreshed on every
+ * update so a power good change is noticed.
+ */
+enum dps850_update_group {
+	UPDATE_STATIC = 0,
+	UPDATE_STATUS,
+	UPDATE_POWER,
+	UPDATE_TEMP,
+	UPDATE_FAN,
+	UPDATE_GROUP_COUNT
+};
+
 enum chips {
 	DPS850
 };
@@ -50,10 +70,13 @@ enum chips {
 struct dps850_data {
 	struct device	  *hwmon_dev;
 	struct mutex		update_lock;
-	char				valid;		 /* !=0 if registers are valid */
-	unsigned long	   last_updated;   /* In jiffies */
+	char				valid;		 /* !=0 if the last update succeeded */
+	char				group_valid[UPDATE_GROUP_COUNT];   /* !=0 if the group is valid */
+	unsigned long		group_updated[UPDATE_GROUP_COUNT]; /* In jiffies */
 	u8	 chip;			/* chip id */
 	u8   vout_mode;	 	/* Register value */
+	u16  status_word;	/* Register value */
+	char power_good;	/* Power good at the last status update */
 	u16  v_in;		  	/* Register value */
 	u16  v_out;		 	/* Register value */
 	u16  i_in;		  	/* Register value */
@@ -72,7 +95,8 @@ static ssize_t show_vout_by_mode(struct device *dev, struct device_attribute *da
 			 char *buf);
 static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
 			 char *buf);
-static struct dps850_data *dps850_update_device(struct device *dev);
+static struct dps850_data *dps850_update_device(struct device *dev,
+						 struct device_attribute *da);
 static int dps850_write_word(struct i2c_client *client, u8 reg, u16 value);
 
 enum dps850_sysfs_attributes {
@@ -133,7 +157,7 @@ static ssize_t show_linear(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
 	struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-	struct dps850_data *data = dps850_update_device(dev);
+	struct dps850_data *data = dps850_update_device(dev, da);
 
 	u16 value = 0;
 	int exponent, mantissa;
@@ -181,7 +205,7 @@ static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
 	struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-	struct dps850_data *data = dps850_update_device(dev);
+	struct dps850_data *data = dps850_update_device(dev, da);
 	u8 *ptr = NULL;
 
 	if (!data->valid) {
@@ -205,7 +229,7 @@ static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
 static ssize_t show_vout_by_mode(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
-	struct dps850_data *data = dps850_update_device(dev);
+	struct dps850_data *data = dps850_update_device(dev, da);
 	int exponent, mantissa;
 	int multiplier = 1000;
 
@@ -388,114 +412,186 @@ static int dps850_read_block(struct i2c_client *client, u8 command, u8 *data,
 }
 
 struct reg_data_byte {
+	u8   group;
 	u8   reg;
 	u8  *value;
 };
 
 struct reg_data_word {
+	u8   group;
 	u8   reg;
 	u16 *value;
 };
 
-static struct dps850_data *dps850_update_device(struct device *dev)
+static int dps850_attr_group(int index)
 {
-	struct i2c_client *client = to_i2c_client(dev);
-	struct dps850_data *data = i2c_get_clientdata(client);
+	switch (index) {
+	case PSU_V_IN:
+	case PSU_V_OUT:
+	case PSU_I_IN:
+	case PSU_I_OUT:
+	case PSU_P_IN:
+	case PSU_P_OUT:
+		return UPDATE_POWER;
+	case PSU_TEMP1_INPUT:
+	case PSU_TEMP2_INPUT:
+	case PSU_TEMP3_INPUT:
+		return UPDATE_TEMP;
+	case PSU_FAN1_SPEED:
+		return UPDATE_FAN;
+	default:
+		return UPDATE_STATIC;
+	}
+}
 
-	mutex_lock(&data->update_lock);
+static int dps850_update_group(struct i2c_client *client,
+			       struct dps850_data *data, int group)
+{
+	int i, status, length;
+	u8 command, buf;
+	struct reg_data_byte regs_byte[] = { {UPDATE_STATIC, 0x20, &data->vout_mode}};
+	struct reg_data_word regs_word[] = { {UPDATE_STATUS, 0x79, &data->status_word},
+										 {UPDATE_POWER, 0x88, &data->v_in},
+										 {UPDATE_POWER, 0x8b, &data->v_out},
+										 {UPDATE_POWER, 0x89, &data->i_in},
+										 {UPDATE_POWER, 0x8c, &data->i_out},
+										 {UPDATE_POWER, 0x96, &data->p_out},
+										 {UPDATE_POWER, 0x97, &data->p_in},
+										 {UPDATE_TEMP,  0x8d, &(data->temp_input[0])},
+										 {UPDATE_TEMP,  0x8e, &(data->temp_input[1])},
+										 {UPDATE_TEMP,  0x8f, &(data->temp_input[2])},
+										 {UPDATE_FAN,   0x90, &data->fan_speed}};
+
+	/* Read byte data */
+	for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
+		if (regs_byte[i].group != group)
+			continue;
 
-	if (time_after(jiffies, data->last_updated + HZ + HZ / 2)
-		|| !data->valid) {
-		int i, status, length;
-		u8 command, buf;
-		struct reg_data_byte regs_byte[] = { {0x20, &data->vout_mode}};
-		struct reg_data_word regs_word[] = { {0x88, &data->v_in},
-											 {0x8b, &data->v_out},
-											 {0x89, &data->i_in},
-											 {0x8c, &data->i_out},
-											 {0x96, &data->p_out},
-											 {0x97, &data->p_in},
-											 {0x8d, &(data->temp_input[0])},
-											 {0x8e, &(data->temp_input[1])},
-											 {0x8f, &(data->temp_input[2])},
-											 {0x90, &data->fan_speed}};
-
-		dev_dbg(&client->dev, "Starting dps850 update\n");
-		data->valid = 0;
-
-		/* Read byte data */
-		for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
-			status = dps850_read_byte(client, regs_byte[i].reg);
-
-			if (status < 0) {
-				dev_dbg(&client->dev, "reg %d, err %d\n",
-						regs_byte[i].reg, status);
-				goto exit;
-			}
-			else {
-				*(regs_byte[i].value) = status;
-			}
+		status = dps850_read_byte(client, regs_byte[i].reg);
+
+		if (status < 0) {
+			dev_dbg(&client->dev, "reg %d, err %d\n",
+					regs_byte[i].reg, status);
+			return status;
 		}
+		else {
+			*(regs_byte[i].value) = status;
+		}
+	}
 
-		/* Read word data */
-		for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
-			status = dps850_read_word(client, regs_word[i].reg);
+	/* Read word data */
+	for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
+		if (regs_word[i].group != group)
+			continue;
 
-			if (status < 0) {
-				dev_dbg(&client->dev, "reg %d, err %d\n",
-						regs_word[i].reg, status);
-				goto exit;
-			}
-			else {
-				*(regs_word[i].value) = status;
-			}
-		}
+		status = dps850_read_word(client, regs_word[i].reg);
 
-		/* Read mfr_model */
-		command = 0x9a;
-		length  = 1;
-		memset(data->mfr_model, 0, sizeof(data->mfr_model));
-		
-		/* Read first byte to determine the length of data */
-		status = dps850_read_block(client, command, &buf, length);
 		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-			goto exit;
+			dev_dbg(&client->dev, "reg %d, err %d\n",
+					regs_word[i].reg, status);
+			return status;
 		}
-		
-		status = dps850_read_block(client, command, data->mfr_model, buf+1);
-		data->mfr_model[buf+1] = '\0';
-
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-			goto exit;
+		else {
+			*(regs_word[i].value) = status;
 		}
+	}
 
+	if (group != UPDATE_STATIC)
+		return 0;
 
-		/* Read mfr_serial */
-		command = 0x9e;
-		length  = 1;
-		memset(data->mfr_serial, 0, sizeof(data->mfr_serial));
-		
-		/* Read first byte to determine the length of data */
-		status = dps850_read_block(client, command, &buf, length);
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-			goto exit;
-		}
-		
- 		status = dps850_read_block(client, command, data->mfr_serial, buf+1);
-		data->mfr_serial[buf+1] = '\0';
+	/* Read mfr_model */
+	command = 0x9a;
+	length  = 1;
+	memset(data->mfr_model, 0, sizeof(data->mfr_model));
+
+	/* Read first byte to determine the length of data */
+	status = dps850_read_block(client, command, &buf, length);
+	if (status < 0) {
+		dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+		return status;
+	}
+
+	status = dps850_read_block(client, command, data->mfr_model, buf+1);
+	data->mfr_model[buf+1] = '\0';
+
+	if (status < 0) {
+		dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+		return status;
+	}
+
+	/* Read mfr_serial */
+	command = 0x9e;
+	length  = 1;
+	memset(data->mfr_serial, 0, sizeof(data->mfr_serial));
+
+	/* Read first byte to determine the length of data */
+	status = dps850_read_block(client, command, &buf, length);
+	if (status < 0) {
+		dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+		return status;
+	}
+
+	status = dps850_read_block(client, command, data->mfr_serial, buf+1);
+	data->mfr_serial[buf+1] = '\0';
+
+	if (status < 0) {
+		dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+		return status;
+	}
+
+	return 0;
+}
+
+static struct dps850_data *dps850_update_device(struct device *dev,
+						 struct device_attribute *da)
+{
+	struct i2c_client *client = to_i2c_client(dev);
+	struct dps850_data *data = i2c_get_clientdata(client);
+	struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+	int groups[] = { UPDATE_STATUS, UPDATE_STATIC, dps850_attr_group(attr->index) };
+	int i, group, status;
+	char power_good;
+
+	mutex_lock(&data->update_lock);
 
+	data->valid = 0;
+
+	for (i = 0; i < ARRAY_SIZE(groups); i++) {
+		group = groups[i];
+
+		if (data->group_valid[group] && (group == UPDATE_STATIC ||
+			time_before(jiffies, data->group_updated[group] +
+					     msecs_to_jiffies(update_interval))))
+			continue;
+
+		dev_dbg(&client->dev, "Starting dps850 update, group %d\n", group);
+		data->group_valid[group] = 0;
+
+		status = dps850_update_group(client, data, group);
 		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+			/* The PSU may have been replaced, re-read everything */
+			memset(data->group_valid, 0, sizeof(data->group_valid));
 			goto exit;
 		}
 
-		data->last_updated = jiffies;
-		data->valid = 1;
+		data->group_updated[group] = jiffies;
+		data->group_valid[group] = 1;
+
+		if (group == UPDATE_STATUS) {
+			/* Power good (high byte bit 3 of status_word, 0=>OK) drops when
+			 * the PSU is pulled or loses input, re-read the static registers
+			 * on either edge.
+			 */
+			power_good = (data->status_word & 0x800) ? 0 : 1;
+			if (power_good != data->power_good) {
+				data->power_good = power_good;
+				data->group_valid[UPDATE_STATIC] = 0;
+			}
+		}
 	}
 
+	data->valid = 1;
+
 exit:
 	mutex_unlock(&data->update_lock);
 
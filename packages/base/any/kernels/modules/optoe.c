@@ -207,6 +207,25 @@ struct optoe_data {
 	/* dev_class: ONE_ADDR (QSFP) or TWO_ADDR (SFP) */
 	int dev_class;
 
+	/*
+	 * With page_cache set: the page last seen in the page select
+	 * register, or -1 if unknown.  Only a hint; it is checked against
+	 * the module before every paged access.
+	 */
+	int page;
+	unsigned int page_selects_avoided;
+	unsigned int page_moves;
+
+	/*
+	 * With page_cache set: the paging capability registers read from
+	 * the module, or -1 if unknown.  Reset whenever an access fails or
+	 * the page is found moved, as that is how a module removal or reset
+	 * shows up, and by the cache_invalidate attribute.
+	 */
+	int pageable_reg;
+	int ddm_reg;
+	unsigned int pageable_reads_avoided;
+
 	struct i2c_client *client[];
 };
 
@@ -228,6 +247,24 @@ static unsigned int io_limit = OPTOE_PAGE_SIZE;
  */
 static unsigned int write_timeout = 25;
 
+/*
+ * Leave the last page selected instead of writing the page select
+ * register before and after every paged access, and remember the
+ * module's paging capability instead of reading it on every access.
+ * The page select register is read back before each paged access, so a
+ * module reset or swap, or a raw i2c-dev write to it, is noticed; a
+ * read replaces the two writes.  The capability is forgotten when an
+ * access fails or the page is found moved; use the cache_invalidate
+ * attribute after replacing a module without either happening.
+ * Software which reads upper page 0 through i2c-dev without selecting
+ * it must not be used with this set, as the page is no longer returned
+ * to 0.
+ */
+static bool page_cache;
+module_param(page_cache, bool, 0644);
+MODULE_PARM_DESC(page_cache,
+	"Leave the last page selected and cache the paging capability (default: false)");
+
 /*
  * flags to distinguish one-address (QSFP family) from two-address (SFP family)
  * If the family is not known, figure it out when the device is accessed
@@ -506,6 +543,38 @@ static ssize_t optoe_eeprom_write(struct optoe_data *optoe,
 }
 
 
+static void optoe_cache_invalidate(struct optoe_data *optoe)
+{
+	optoe->page = -1;
+	optoe->pageable_reg = -1;
+	optoe->ddm_reg = -1;
+}
+
+/*
+ * Read one of the registers describing the module's paging capability,
+ * from the cache if page_cache is set and it has been read before.
+ */
+static ssize_t optoe_capability_read(struct optoe_data *optoe,
+		int *cached, u8 *regval, unsigned int offset)
+{
+	ssize_t status;
+
+	if (page_cache && *cached >= 0) {
+		*regval = *cached;
+		optoe->pageable_reads_avoided++;
+		return 1;
+	}
+
+	status = optoe_eeprom_read(optoe, optoe->client[0], regval, offset, 1);
+	if (status < 0) {
+		optoe_cache_invalidate(optoe);
+		return status;
+	}
+
+	*cached = page_cache ? *regval : -1;
+	return status;
+}
+
 static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 				char *buf, loff_t off,
 				size_t count, int opcode)
@@ -515,20 +584,55 @@ static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 	uint8_t page = 0;
 	loff_t phy_offset = off;
 	int ret = 0;
+	bool pager, paged;
 
 	page = optoe_translate_offset(optoe, &phy_offset, &client);
 	dev_dbg(&client->dev,
 		"%s off %lld  page:%d phy_offset:%lld, count:%ld, opcode:%d\n",
 		__func__, off, page, phy_offset, (long int) count, opcode);
-	if (page > 0) {
+
+	/*
+	 * Without page_cache the page register is left at 0 after every
+	 * access, so only other pages are selected.  With page_cache it is
+	 * left wherever the last access put it, so any paged access
+	 * (including upper page 0) selects its page unless it is already
+	 * selected.  The register is read back first: the module may have
+	 * been reset or replaced, or the page written through i2c-dev,
+	 * since the last access.
+	 */
+	pager = !(optoe->dev_class == TWO_ADDR && client == optoe->client[0]);
+	paged = pager && phy_offset >= OPTOE_PAGE_SIZE;
+	if (page_cache && paged) {
+		u8 selected;
+
+		ret = optoe_eeprom_read(optoe, client, &selected,
+			OPTOE_PAGE_SELECT_REG, 1);
+		if (ret < 0) {
+			optoe_cache_invalidate(optoe);
+			return ret;
+		}
+		if (optoe->page >= 0 && selected != optoe->page) {
+			/* reset or replaced: the capability may be stale too */
+			optoe->page_moves++;
+			optoe->pageable_reg = -1;
+			optoe->ddm_reg = -1;
+		}
+		optoe->page = selected;
+	}
+	if (page_cache && paged && page == optoe->page) {
+		optoe->page_selects_avoided++;
+	} else if (page > 0 ||
+		   (paged && (page_cache || optoe->page > 0))) {
 		ret = optoe_eeprom_write(optoe, client, &page,
 			OPTOE_PAGE_SELECT_REG, 1);
 		if (ret < 0) {
 			dev_dbg(&client->dev,
 				"Write page register for page %d failed ret:%d!\n",
 					page, ret);
+			optoe_cache_invalidate(optoe);
 			return ret;
 		}
+		optoe->page = page;
 	}
 
 	while (count) {
@@ -542,18 +646,23 @@ static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 				buf, phy_offset, count);
 		}
 		if (status <= 0) {
+			optoe_cache_invalidate(optoe);
 			if (retval == 0)
 				retval = status;
 			break;
 		}
+
 		buf += status;
 		phy_offset += status;
 		count -= status;
 		retval += status;
 	}
 
-
-	if (page > 0) {
+	if (page_cache) {
+		/* leave the page selected for the next access */
+		if (page > 0)
+			optoe->page_selects_avoided++;
+	} else if (page > 0) {
 		/* return the page register to page 0 (why?) */
 		page = 0;
 		ret = optoe_eeprom_write(optoe, client, &page,
@@ -565,6 +674,7 @@ static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 			if (retval == 0)
 				retval = ret;
 		}
+		optoe->page = 0;
 	}
 	return retval;
 }
@@ -572,7 +682,8 @@ static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 /*
  * Figure out if this access is within the range of supported pages.
  * Note this is called on every access because we don't know if the
- * module has been replaced since the last call.
+ * module has been replaced since the last call.  With page_cache set the
+ * capability registers are only read again once the cache is invalidated.
  * If/when modules support more pages, this is the routine to update
  * to validate and allow access to additional pages.
  *
@@ -601,8 +712,8 @@ static ssize_t optoe_page_legal(struct optoe_data *optoe,
 		if (off >= TWO_ADDR_EEPROM_SIZE)
 			return OPTOE_EOF;
 		/* in between, are pages supported? */
-		status = optoe_eeprom_read(optoe, client, &regval,
-				TWO_ADDR_PAGEABLE_REG, 1);
+		status = optoe_capability_read(optoe, &optoe->pageable_reg,
+				&regval, TWO_ADDR_PAGEABLE_REG);
 		if (status < 0)
 			return status;  /* error out (no module?) */
 		if (regval & TWO_ADDR_PAGEABLE) {
@@ -615,8 +726,8 @@ static ssize_t optoe_page_legal(struct optoe_data *optoe,
 
 			/* will be accessing addr 0x51, is that supported? */
 			/* byte 92, bit 6 implies DDM support, 0x51 support */
-			status = optoe_eeprom_read(optoe, client, &regval,
-						TWO_ADDR_0X51_REG, 1);
+			status = optoe_capability_read(optoe, &optoe->ddm_reg,
+						&regval, TWO_ADDR_0X51_REG);
 			if (status < 0)
 				return status;
 			if (regval & TWO_ADDR_0X51_SUPP) {
@@ -642,8 +753,8 @@ static ssize_t optoe_page_legal(struct optoe_data *optoe,
 		if (off >= ONE_ADDR_EEPROM_SIZE)
 			return OPTOE_EOF;
 		/* in between, are pages supported? */
-		status = optoe_eeprom_read(optoe, client, &regval,
-				ONE_ADDR_PAGEABLE_REG, 1);
+		status = optoe_capability_read(optoe, &optoe->pageable_reg,
+				&regval, ONE_ADDR_PAGEABLE_REG);
 		if (status < 0)
 			return status;  /* error out (no module?) */
 
@@ -892,6 +1003,7 @@ static ssize_t set_dev_class(struct device *dev,
 		optoe->num_addresses = 1;
 	}
 	optoe->dev_class = dev_class;
+	optoe_cache_invalidate(optoe);
 	mutex_unlock(&optoe->lock);
 
 	return count;
@@ -943,11 +1055,52 @@ static DEVICE_ATTR(port_name,  0644, show_port_name, set_port_name);
 
 static DEVICE_ATTR(dev_class,  0644, show_dev_class, set_dev_class);
 
+/*
+ * page_cache statistics: page select writes avoided, the number of times
+ * the page was found moved by something else, then paging capability
+ * reads avoided.  The first counts writes, not transactions: each paged
+ * access still reads the page select register back.
+ */
+static ssize_t show_cache_stats(struct device *dev,
+			struct device_attribute *dattr, char *buf)
+{
+	struct i2c_client *client = to_i2c_client(dev);
+	struct optoe_data *optoe = i2c_get_clientdata(client);
+	ssize_t count;
+
+	mutex_lock(&optoe->lock);
+	count = sprintf(buf, "%u %u %u\n", optoe->page_selects_avoided,
+			optoe->page_moves, optoe->pageable_reads_avoided);
+	mutex_unlock(&optoe->lock);
+
+	return count;
+}
+
+/* Forget the selected page and capability, e.g. after a module swap */
+static ssize_t set_cache_invalidate(struct device *dev,
+			struct device_attribute *attr,
+			const char *buf, size_t count)
+{
+	struct i2c_client *client = to_i2c_client(dev);
+	struct optoe_data *optoe = i2c_get_clientdata(client);
+
+	mutex_lock(&optoe->lock);
+	optoe_cache_invalidate(optoe);
+	mutex_unlock(&optoe->lock);
+
+	return count;
+}
+
+static DEVICE_ATTR(cache_stats, 0444, show_cache_stats, NULL);
+static DEVICE_ATTR(cache_invalidate, 0200, NULL, set_cache_invalidate);
+
 static struct attribute *optoe_attrs[] = {
 #ifndef EEPROM_CLASS
 	&dev_attr_port_name.attr,
 #endif
 	&dev_attr_dev_class.attr,
+	&dev_attr_cache_stats.attr,
+	&dev_attr_cache_invalidate.attr,
 	NULL,
 };
 
@@ -1028,6 +1181,7 @@ static int optoe_probe(struct i2c_client *client,
 	}
 
 	mutex_init(&optoe->lock);
+	optoe_cache_invalidate(optoe);
 
 	/* determine whether this is a one-address or two-address module */
 	if ((strcmp(client->name, "optoe1") == 0) ||
@@ -41,10 +41,30 @@
 
 static int support_i2c_block = 1; // 1: support I2C_FUNC_SMBUS_I2C_BLOCK 0: not support
 
+/* Refresh interval of the telemetry registers, in ms */
+static unsigned int update_interval = 1500;
+module_param(update_interval, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(update_interval, "Telemetry refresh interval in ms (default 1500)");
+
 /* Addresses scanned
  */
 static const unsigned short normal_i2c[] = { I2C_CLIENT_END };
 
+/* Registers are refreshed in groups, only the group of the attribute being
+ * read is refreshed. The static group (identity and limits) is read once,
+ * and again only after a read fails or power good changes (PSU removed,
+ * replaced or unplugged). The status group is refreshed on every update
+ * so a power good change is noticed.
+ */
+enum ym2651y_update_group {
+    UPDATE_STATIC = 0,
+    UPDATE_STATUS,
+    UPDATE_POWER,
+    UPDATE_TEMP,
+    UPDATE_FAN,
+    UPDATE_GROUP_COUNT
+};
+
 enum chips {
     YM2651,
     YM2401,
@@ -58,11 +78,13 @@ enum chips {
 struct ym2651y_data {
     struct device     *hwmon_dev;
     struct mutex        update_lock;
-    char                valid;         /* !=0 if registers are valid */
-    unsigned long      last_updated;    /* In jiffies */
+    char                valid;         /* !=0 if the last update succeeded */
+    char                group_valid[UPDATE_GROUP_COUNT];   /* !=0 if the group is valid */
+    unsigned long       group_updated[UPDATE_GROUP_COUNT]; /* In jiffies */
     u8   chip;          /* chip id */
     u8   capability;     /* Register value */
     u16  status_word;   /* Register value */
+    char power_good;    /* Power good at the last status update */
     u8   fan_fault;   /* Register value */
     u8   over_temp;   /* Register value */
     u16  v_in;        /* Register value */
@@ -105,7 +127,8 @@ static ssize_t show_over_temp(struct device *dev, struct device_attribute *da,
              char *buf);
 static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
              char *buf);
-static struct ym2651y_data *ym2651y_update_device(struct device *dev);
+static struct ym2651y_data *ym2651y_update_device(struct device *dev,
+                                                  struct device_attribute *da);
 static ssize_t set_fan_duty_cycle(struct device *dev, struct device_attribute *da,
              const char *buf, size_t count);
 static int ym2651y_write_word(struct i2c_client *client, u8 reg, u16 value);
@@ -217,7 +240,7 @@ static ssize_t show_byte(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_data *data = ym2651y_update_device(dev, da);
 
     if (!data->valid) {
         return 0;
@@ -231,7 +254,7 @@ static ssize_t show_word(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_data *data = ym2651y_update_device(dev, da);
     u16 status = 0;
 
     if (!data->valid) {
@@ -292,7 +315,7 @@ static ssize_t show_linear(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_data *data = ym2651y_update_device(dev, da);
     u8 *ptr = NULL;
 
     u16 value = 0;
@@ -399,7 +422,7 @@ static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_data *data = ym2651y_update_device(dev, da);
     u8 shift;
 
     if (!data->valid) {
@@ -414,7 +437,7 @@ static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da,
 static ssize_t show_over_temp(struct device *dev, struct device_attribute *da,
              char *buf)
 {
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_data *data = ym2651y_update_device(dev, da);
 
     if (!data->valid) {
         return 0;
@@ -427,7 +450,7 @@ static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_data *data = ym2651y_update_device(dev, da);
     u8 *ptr = NULL;
 
     if (!data->valid) {
@@ -476,7 +499,7 @@ static ssize_t show_vout_by_mode(struct device *dev, struct device_attribute *da
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_data *data = ym2651y_update_device(dev, da);
     int exponent, mantissa;
     int multiplier = 1000;
 
@@ -737,208 +760,291 @@ static int ym2651y_read_block(struct i2c_client *client, u8 command, u8 *data,
 }
 
 struct reg_data_byte {
+    u8   group;
     u8   reg;
     u8  *value;
 };
 
 struct reg_data_word {
+    u8   group;
     u8   reg;
     u16 *value;
 };
 
-static struct ym2651y_data *ym2651y_update_device(struct device *dev)
+static int ym2651y_attr_group(int index)
 {
-    struct i2c_client *client = to_i2c_client(dev);
-    struct ym2651y_data *data = i2c_get_clientdata(client);
+    switch (index) {
+    case PSU_POWER_ON:
+    case PSU_TEMP_FAULT:
+    case PSU_POWER_GOOD:
+    case PSU_FAN1_FAULT:
+    case PSU_OVER_TEMP:
+        return UPDATE_STATUS;
+    case PSU_V_IN:
+    case PSU_I_IN:
+    case PSU_P_IN:
+    case PSU_V_OUT:
+    case PSU_I_OUT:
+    case PSU_P_OUT:
+        return UPDATE_POWER;
+    case PSU_TEMP1_INPUT:
+    case PSU_TEMP2_INPUT:
+    case PSU_TEMP3_INPUT:
+        return UPDATE_TEMP;
+    case PSU_FAN1_SPEED:
+    case PSU_FAN1_DUTY_CYCLE:
+        return UPDATE_FAN;
+    default:
+        return UPDATE_STATIC;
+    }
+}
 
-    mutex_lock(&data->update_lock);
+static int ym2651y_update_group(struct i2c_client *client,
+                                struct ym2651y_data *data, int group)
+{
+    int i, status, length;
+    u8 command, buf;
+    struct reg_data_byte regs_byte[] = { {UPDATE_STATIC, 0x19, &data->capability},
+                                         {UPDATE_STATIC, 0x20, &data->vout_mode},
+                                         {UPDATE_STATUS, 0x7d, &data->over_temp},
+                                         {UPDATE_STATUS, 0x81, &data->fan_fault},
+                                         {UPDATE_STATIC, 0x98, &data->pmbus_revision}};
+    struct reg_data_word regs_word[] = { {UPDATE_STATUS, 0x79, &data->status_word},
+                                         {UPDATE_POWER,  0x88, &data->v_in},
+                                         {UPDATE_POWER,  0x8b, &data->v_out},
+                                         {UPDATE_POWER,  0x89, &data->i_in},
+                                         {UPDATE_POWER,  0x8c, &data->i_out},
+                                         {UPDATE_POWER,  0x97, &data->p_in},
+                                         {UPDATE_POWER,  0x96, &data->p_out},
+                                         {UPDATE_TEMP,   0x8d, &(data->temp[0])},
+                                         {UPDATE_TEMP,   0x8e, &(data->temp[1])},
+                                         {UPDATE_TEMP,   0x8f, &(data->temp[2])},
+                                         {UPDATE_FAN,    0x3b, &(data->fan_duty_cycle[0])},
+                                         {UPDATE_FAN,    0x3c, &(data->fan_duty_cycle[1])},
+                                         {UPDATE_FAN,    0x90, &data->fan_speed},
+                                         {UPDATE_STATIC, 0xa0, &data->mfr_vin_min},
+                                         {UPDATE_STATIC, 0xa1, &data->mfr_vin_max},
+                                         {UPDATE_STATIC, 0xa2, &data->mfr_iin_max},
+                                         {UPDATE_STATIC, 0xa3, &data->mfr_pin_max},
+                                         {UPDATE_STATIC, 0xa4, &data->mfr_vout_min},
+                                         {UPDATE_STATIC, 0xa5, &data->mfr_vout_max},
+                                         {UPDATE_STATIC, 0xa6, &data->mfr_iout_max},
+                                         {UPDATE_STATIC, 0xa7, &data->mfr_pout_max}};
+
+    /* Read byte data */
+    for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
+        if (regs_byte[i].group != group) {
+            continue;
+        }
 
-    if (time_after(jiffies, data->last_updated + HZ + HZ / 2)
-        || !data->valid) {
-        int i, status, length;
-        u8 command, buf;
-        struct reg_data_byte regs_byte[] = { {0x19, &data->capability},
-                                             {0x20, &data->vout_mode},
-                                             {0x7d, &data->over_temp},
-                                             {0x81, &data->fan_fault},
-                                             {0x98, &data->pmbus_revision}};
-        struct reg_data_word regs_word[] = { {0x79, &data->status_word},
-                                             {0x88, &data->v_in},
-                                             {0x8b, &data->v_out},
-                                             {0x89, &data->i_in},
-                                             {0x8c, &data->i_out},
-                                             {0x97, &data->p_in},
-                                             {0x96, &data->p_out},
-                                             {0x8d, &(data->temp[0])},
-                                             {0x8e, &(data->temp[1])},
-                                             {0x8f, &(data->temp[2])},
-                                             {0x3b, &(data->fan_duty_cycle[0])},
-                                             {0x3c, &(data->fan_duty_cycle[1])},
-                                             {0x90, &data->fan_speed},
-                                             {0xa0, &data->mfr_vin_min},
-                                             {0xa1, &data->mfr_vin_max},
-                                             {0xa2, &data->mfr_iin_max},
-                                             {0xa3, &data->mfr_pin_max},
-                                             {0xa4, &data->mfr_vout_min},
-                                             {0xa5, &data->mfr_vout_max},
-                                             {0xa6, &data->mfr_iout_max},
-                                             {0xa7, &data->mfr_pout_max}};
-
-        dev_dbg(&client->dev, "Starting ym2651 update\n");
-        data->valid = 0;
-
-        /* Read byte data */
-        for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
-            status = ym2651y_read_byte(client, regs_byte[i].reg);
+        status = ym2651y_read_byte(client, regs_byte[i].reg);
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_byte[i].reg, status);
-                goto exit;
-            }
-            else {
-                *(regs_byte[i].value) = status;
-            }
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_byte[i].reg, status);
+            return status;
+        }
+        else {
+            *(regs_byte[i].value) = status;
         }
+    }
 
-        /* Read word data */
-        for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
-            status = ym2651y_read_word(client, regs_word[i].reg);
+    /* Read word data */
+    for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
+        if (regs_word[i].group != group) {
+            continue;
+        }
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_word[i].reg, status);
-                goto exit;
-            }
-            else {
-                *(regs_word[i].value) = status;
-            }
+        status = ym2651y_read_word(client, regs_word[i].reg);
+
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_word[i].reg, status);
+            return status;
         }
+        else {
+            *(regs_word[i].value) = status;
+        }
+    }
 
-        if (support_i2c_block) {
+    if (group != UPDATE_STATIC) {
+        return 0;
+    }
 
-            /* Read fan_direction */
-            command = 0xC3;
-            status = ym2651y_read_block(client, command, data->fan_dir,
-                                         ARRAY_SIZE(data->fan_dir)-1);
-            if (data->fan_dir[0] < ARRAY_SIZE(data->fan_dir)-2) {
-                data->fan_dir[data->fan_dir[0]+1] = '\0';
-            }
-            else {
-                data->fan_dir[ARRAY_SIZE(data->fan_dir)-1] = '\0';
-            }
+    if (support_i2c_block) {
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+        /* Read fan_direction */
+        command = 0xC3;
+        status = ym2651y_read_block(client, command, data->fan_dir,
+                                     ARRAY_SIZE(data->fan_dir)-1);
+        if (data->fan_dir[0] < ARRAY_SIZE(data->fan_dir)-2) {
+            data->fan_dir[data->fan_dir[0]+1] = '\0';
+        }
+        else {
+            data->fan_dir[ARRAY_SIZE(data->fan_dir)-1] = '\0';
+        }
 
-            /* Read mfr_id */
-            command = 0x99;
-            status = ym2651y_read_block(client, command, data->mfr_id,
-                                            ARRAY_SIZE(data->mfr_id)-1);
-            if (data->mfr_id[0] < ARRAY_SIZE(data->mfr_id)-2) {
-                data->mfr_id[data->mfr_id[0]+1] = '\0';
-            }
-            else {
-                data->mfr_id[ARRAY_SIZE(data->mfr_id)-1] = '\0';
-            }
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+            return status;
+        }
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+        /* Read mfr_id */
+        command = 0x99;
+        status = ym2651y_read_block(client, command, data->mfr_id,
+                                        ARRAY_SIZE(data->mfr_id)-1);
+        if (data->mfr_id[0] < ARRAY_SIZE(data->mfr_id)-2) {
+            data->mfr_id[data->mfr_id[0]+1] = '\0';
+        }
+        else {
+            data->mfr_id[ARRAY_SIZE(data->mfr_id)-1] = '\0';
+        }
 
-            /* Read mfr_model */
-            command = 0x9a;
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+            return status;
+        }
+
+        /* Read mfr_model */
+        command = 0x9a;
+        length  = 1;
+
+        /* Read first byte to determine the length of data */
+        status = ym2651y_read_block(client, command, &buf, length);
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+            return status;
+        }
+
+        status = ym2651y_read_block(client, command, data->mfr_model, buf+1);
+        data->mfr_model[buf+1] = '\0';
+
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+            return status;
+        }
+
+        if ((strncmp((data->mfr_model+1), "YM-2851J", strlen("YM-2851J")) == 0)||
+            (strncmp((data->mfr_model+1), "YM-2651Y", strlen("YM-2651Y")) == 0)||
+            (strncmp((data->mfr_model+1), "YPEB1200AM", strlen("YPEB1200AM")) == 0)) {
+        
+            /* Read mfr_model_opt */
+            command = 0xd0;
             length  = 1;
 
             /* Read first byte to determine the length of data */
             status = ym2651y_read_block(client, command, &buf, length);
             if (status < 0) {
                 dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
+                return status;
             }
 
-            status = ym2651y_read_block(client, command, data->mfr_model, buf+1);
-            data->mfr_model[buf+1] = '\0';
+            status = ym2651y_read_block(
+                        client, command, data->mfr_model_opt, buf+1);
+            
+            data->mfr_model_opt[buf+1] = '\0';
 
             if (status < 0) {
                 dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
+                return status;
             }
+        }
 
-            if ((strncmp((data->mfr_model+1), "YM-2851J", strlen("YM-2851J")) == 0)||
-                (strncmp((data->mfr_model+1), "YM-2651Y", strlen("YM-2651Y")) == 0)||
-                (strncmp((data->mfr_model+1), "YPEB1200AM", strlen("YPEB1200AM")) == 0)) {
-            
-                /* Read mfr_model_opt */
-                command = 0xd0;
-                length  = 1;
-
-                /* Read first byte to determine the length of data */
-                status = ym2651y_read_block(client, command, &buf, length);
-                if (status < 0) {
-                    dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                    goto exit;
-                }
-
-                status = ym2651y_read_block(
-                            client, command, data->mfr_model_opt, buf+1);
-                
-                data->mfr_model_opt[buf+1] = '\0';
-
-                if (status < 0) {
-                    dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                    goto exit;
-                }
-            }
+        /* Read mfr_revsion */
+        command = 0x9b;
+        status = ym2651y_read_block(client, command, data->mfr_revsion,
+                                        ARRAY_SIZE(data->mfr_revsion)-1);
+        if (data->mfr_revsion[0] < ARRAY_SIZE(data->mfr_revsion)-2) {
+            data->mfr_revsion[data->mfr_revsion[0] + 1] = '\0';
+        }
+        else{
+            data->mfr_revsion[ARRAY_SIZE(data->mfr_revsion)-1] = '\0';
+        }
 
-            /* Read mfr_revsion */
-            command = 0x9b;
-            status = ym2651y_read_block(client, command, data->mfr_revsion,
-                                            ARRAY_SIZE(data->mfr_revsion)-1);
-            if (data->mfr_revsion[0] < ARRAY_SIZE(data->mfr_revsion)-2) {
-                data->mfr_revsion[data->mfr_revsion[0] + 1] = '\0';
-            }
-            else{
-                data->mfr_revsion[ARRAY_SIZE(data->mfr_revsion)-1] = '\0';
-            }
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+            return status;
+        }
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+        /* Read mfr_serial */
+        command = 0x9e;
+        length  = 1;
 
-            /* Read mfr_serial */
-            command = 0x9e;
-            length  = 1;
+        /* Read first byte to determine the length of data */
+        status = ym2651y_read_block(client, command, &buf, length);
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+            return status;
+        }
 
-            /* Read first byte to determine the length of data */
-            status = ym2651y_read_block(client, command, &buf, length);
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+        status = ym2651y_read_block(client, command, data->mfr_serial, buf+1);
+        if (data->mfr_serial[0] < ARRAY_SIZE(data->mfr_serial)-2) {
+            data->mfr_serial[data->mfr_serial[0] + 1] = '\0';
+        }
+        else {
+            data->mfr_serial[ARRAY_SIZE(data->mfr_serial)-1] = '\0';
+        }
 
-            status = ym2651y_read_block(client, command, data->mfr_serial, buf+1);
-            if (data->mfr_serial[0] < ARRAY_SIZE(data->mfr_serial)-2) {
-                data->mfr_serial[data->mfr_serial[0] + 1] = '\0';
-            }
-            else {
-                data->mfr_serial[ARRAY_SIZE(data->mfr_serial)-1] = '\0';
-            }
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+            return status;
+        }
+    }
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+    return 0;
+}
+
+static struct ym2651y_data *ym2651y_update_device(struct device *dev,
+                                                  struct device_attribute *da)
+{
+    struct i2c_client *client = to_i2c_client(dev);
+    struct ym2651y_data *data = i2c_get_clientdata(client);
+    struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+    int groups[] = { UPDATE_STATUS, UPDATE_STATIC, ym2651y_attr_group(attr->index) };
+    int i, group, status;
+    char power_good;
+
+    mutex_lock(&data->update_lock);
+
+    data->valid = 0;
+
+    for (i = 0; i < ARRAY_SIZE(groups); i++) {
+        group = groups[i];
+
+        if (data->group_valid[group] && (group == UPDATE_STATIC ||
+            time_before(jiffies, data->group_updated[group] +
+                                 msecs_to_jiffies(update_interval)))) {
+            continue;
         }
 
-        data->last_updated = jiffies;
-        data->valid = 1;
+        dev_dbg(&client->dev, "Starting ym2651 update, group %d\n", group);
+        data->group_valid[group] = 0;
+
+        status = ym2651y_update_group(client, data, group);
+        if (status < 0) {
+            /* The PSU may have been replaced, re-read everything */
+            memset(data->group_valid, 0, sizeof(data->group_valid));
+            goto exit;
+        }
+
+        data->group_updated[group] = jiffies;
+        data->group_valid[group] = 1;
+
+        if (group == UPDATE_STATUS) {
+            /* Power good (high byte bit 3 of status_word, 0=>OK) drops when
+             * the PSU is pulled or loses input, re-read the static registers
+             * on either edge.
+             */
+            power_good = (data->status_word & 0x800) ? 0 : 1;
+            if (power_good != data->power_good) {
+                data->power_good = power_good;
+                data->group_valid[UPDATE_STATIC] = 0;
+            }
+        }
     }
 
+    data->valid = 1;
+
 exit:
     mutex_unlock(&data->update_lock);
 
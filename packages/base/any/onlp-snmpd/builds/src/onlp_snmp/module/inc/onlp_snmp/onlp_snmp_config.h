@@ -201,6 +201,46 @@
 #define ONLP_SNMP_CONFIG_RESOURCE_UPDATE_SECONDS 5
 #endif
 
+/**
+ * ONLP_SNMP_CONFIG_DISCOVERY_PERIOD
+ *
+ * Sensor rediscovery period in seconds. Presence changes trigger an earlier rediscovery. */
+
+
+#ifndef ONLP_SNMP_CONFIG_DISCOVERY_PERIOD
+#define ONLP_SNMP_CONFIG_DISCOVERY_PERIOD 60
+#endif
+
+/**
+ * ONLP_SNMP_CONFIG_TEMP_UPDATE_PERIOD
+ *
+ * Thermal table update period in seconds. */
+
+
+#ifndef ONLP_SNMP_CONFIG_TEMP_UPDATE_PERIOD
+#define ONLP_SNMP_CONFIG_TEMP_UPDATE_PERIOD ONLP_SNMP_CONFIG_UPDATE_PERIOD
+#endif
+
+/**
+ * ONLP_SNMP_CONFIG_FAN_UPDATE_PERIOD
+ *
+ * Fan table update period in seconds. */
+
+
+#ifndef ONLP_SNMP_CONFIG_FAN_UPDATE_PERIOD
+#define ONLP_SNMP_CONFIG_FAN_UPDATE_PERIOD ONLP_SNMP_CONFIG_UPDATE_PERIOD
+#endif
+
+/**
+ * ONLP_SNMP_CONFIG_PSU_UPDATE_PERIOD
+ *
+ * PSU table update period in seconds. */
+
+
+#ifndef ONLP_SNMP_CONFIG_PSU_UPDATE_PERIOD
+#define ONLP_SNMP_CONFIG_PSU_UPDATE_PERIOD ONLP_SNMP_CONFIG_UPDATE_PERIOD
+#endif
+
 
 
 /**
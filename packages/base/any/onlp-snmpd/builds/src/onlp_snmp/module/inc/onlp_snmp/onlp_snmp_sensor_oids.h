@@ -62,6 +62,9 @@
 #define ONLP_SNMP_SENSOR_LED_OID     ONLP_SNMP_SENSOR_OID_CREATE(LED)
 #define ONLP_SNMP_SENSOR_MISC_OID    ONLP_SNMP_SENSOR_OID_CREATE(MISC)
 
+/* Sensor update cycle statistics (scalars) */
+#define ONLP_SNMP_SENSOR_UPDATE_STATS_OID  ONLP_SNMP_SENSOR_OID,100
+
 /*
  * For legality check only, the sensor oid length from
  * ONLP-SENSOR-MIB file
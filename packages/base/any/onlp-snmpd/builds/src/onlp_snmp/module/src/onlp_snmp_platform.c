@@ -268,7 +268,6 @@ cpu_utilization_handler__(int fd, void* cookie)
     resources_t *curr = get_curr_resources();
     sprintf(svalue, "%d", curr->utilization_percent);
     write(fd, svalue, strlen(svalue));
-    close(fd);
     return 0;
 }
 
@@ -71,36 +71,25 @@ typedef struct onlp_snmp_sensor_s {
     sensor_info_t sensor_info[NUM_SENSOR_INFO];
 } onlp_snmp_sensor_t;
 
-static int curr_info;
-static int
-next_info(void)
-{
-    return (curr_info+1) % NUM_SENSOR_INFO;
-}
-static sensor_info_t *
-get_curr_info(onlp_snmp_sensor_t *ss)
-{
-    return &ss->sensor_info[curr_info];
-}
-static sensor_info_t *
-get_next_info(onlp_snmp_sensor_t *ss)
-{
-    return &ss->sensor_info[next_info()];
-}
-static void
-swap_curr_next_info(void)
-{
-    curr_info = next_info();
-}
+/* timestamp of the last sensor discovery */
+static uint64_t last_discovery_time;
 
-/* timestamp used to trigger sensor update */
-static uint64_t last_sensor_update_time;
+/* set when a presence change or update failure is seen;
+ * forces sensor discovery on the next update */
+static bool discovery_trigger;
 
 /* true if table restructuring is to happen;
  * set after all tables updated;
  * cleared after all tables restructured */
 static bool restructure_trigger;
 
+/* update cycle statistics, exported as scalars */
+static u_long update_cycles;
+static u_long discovery_cycles;
+static u_long last_update_usecs;
+static u_long max_update_usecs;
+static u_long last_discovery_usecs;
+
 /* updates happen in this pthread */
 static pthread_t update_thread_handle;
 
@@ -122,6 +111,14 @@ typedef int (*update_handler_fn)(onlp_snmp_sensor_t *ss);
 typedef struct onlp_snmp_sensor_ctrl_s {
     char name[20];
     list_head_t sensors;
+    /* front buffer index for this table */
+    int curr_info;
+    /* value update period in microseconds */
+    uint64_t period;
+    /* timestamp of the last value update */
+    uint64_t last_update_time;
+    /* buffers were swapped; rows need restructuring */
+    bool restructure;
 } onlp_snmp_sensor_ctrl_t;
 
 static onlp_snmp_sensor_ctrl_t sensor_ctrls__[ONLP_SNMP_SENSOR_TYPE_MAX+1];
@@ -133,6 +130,31 @@ get_sensor_ctrl__(int sensor_type)
     return &sensor_ctrls__[sensor_type];
 }
 
+/*
+ * Each table has its own front-back buffers
+ * so tables can be updated at different rates.
+ */
+static int
+next_info(onlp_snmp_sensor_ctrl_t *ctrl)
+{
+    return (ctrl->curr_info+1) % NUM_SENSOR_INFO;
+}
+static sensor_info_t *
+get_curr_info(onlp_snmp_sensor_t *ss)
+{
+    return &ss->sensor_info[get_sensor_ctrl__(ss->sensor_type)->curr_info];
+}
+static sensor_info_t *
+get_next_info(onlp_snmp_sensor_t *ss)
+{
+    return &ss->sensor_info[next_info(get_sensor_ctrl__(ss->sensor_type))];
+}
+static void
+swap_curr_next_info(onlp_snmp_sensor_ctrl_t *ctrl)
+{
+    ctrl->curr_info = next_info(ctrl);
+}
+
 
 /* for accessing netsnmp table info */
 static netsnmp_tdata *sensor_table__[ONLP_SNMP_SENSOR_TYPE_MAX+1];
@@ -918,12 +940,56 @@ add_sensor__(int sensor_type, onlp_snmp_sensor_t *new_sensor)
 }
 
 
+/*
+ * Mark an existing sensor valid in next info.
+ * Returns false if the sensor is not known yet.
+ */
+static bool
+find_sensor__(int sensor_type, onlp_oid_t oid)
+{
+    onlp_snmp_sensor_ctrl_t *ctrl = get_sensor_ctrl__(sensor_type);
+    list_links_t *curr;
+    onlp_snmp_sensor_t *ss;
+
+    LIST_FOREACH(&ctrl->sensors, curr) {
+        ss = container_of(curr, links, onlp_snmp_sensor_t);
+        if (oid == ss->sensor_id) {
+            get_next_info(ss)->valid = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+
 static int
 collect_sensors__(onlp_oid_t oid, void* cookie)
 {
     onlp_oid_hdr_t hdr;
     onlp_snmp_sensor_t s;
 
+    /* known sensors don't need their header again */
+    switch(ONLP_OID_TYPE_GET(oid))
+        {
+        case ONLP_OID_TYPE_THERMAL:
+            if (find_sensor__(ONLP_SNMP_SENSOR_TYPE_TEMP, oid)) {
+                return 0;
+            }
+            break;
+        case ONLP_OID_TYPE_FAN:
+            if (find_sensor__(ONLP_SNMP_SENSOR_TYPE_FAN, oid)) {
+                return 0;
+            }
+            break;
+        case ONLP_OID_TYPE_PSU:
+            if (find_sensor__(ONLP_SNMP_SENSOR_TYPE_PSU, oid)) {
+                return 0;
+            }
+            break;
+        default:
+            break;
+        }
+
     onlp_oid_hdr_get(oid, &hdr);
     AIM_LOG_MSG("collect: %{onlp_oid}", oid);
 
@@ -975,12 +1041,33 @@ collect_sensors__(onlp_oid_t oid, void* cookie)
 /*
  * sensor table is updated in two parts:
  * 1. sensor update, performed in separate thread by calling update_tables__.
- *    once update is complete, front-back buffers will be switched
- *    and flag set to indicate table restructuring can occur
+ *    sensor discovery (walking the platform OIDs) only happens
+ *    every ONLP_SNMP_CONFIG_DISCOVERY_PERIOD or after a presence change;
+ *    otherwise each table's values are refreshed at its own period.
+ *    once a table's update is complete, its front-back buffers are
+ *    switched and flag set to indicate table restructuring can occur
  * 2. sensor table restructuring, performed in snmp callback
  *    by calling restructure_tables__.
  */
 
+/*
+ * The present bit is bit 0 for thermals, fans and PSUs.
+ */
+static bool
+sensor_present__(sensor_info_t *si, int sensor_type)
+{
+    switch (sensor_type) {
+    case ONLP_SNMP_SENSOR_TYPE_TEMP:
+        return si->data.ti.status & ONLP_THERMAL_STATUS_PRESENT;
+    case ONLP_SNMP_SENSOR_TYPE_FAN:
+        return si->data.fi.status & ONLP_FAN_STATUS_PRESENT;
+    case ONLP_SNMP_SENSOR_TYPE_PSU:
+        return si->data.pi.status & ONLP_PSU_STATUS_PRESENT;
+    default:
+        return true;
+    }
+}
+
 static void
 update_tables__(void)
 {
@@ -988,36 +1075,88 @@ update_tables__(void)
     onlp_snmp_sensor_ctrl_t *ctrl;
     list_links_t *curr;
     onlp_snmp_sensor_t *ss;
+    bool update[ONLP_SNMP_SENSOR_TYPE_MAX+1] = { false };
+    bool any = false;
+    bool discover;
+    uint64_t end;
 
     uint64_t now = aim_time_monotonic();
-    if (now - last_sensor_update_time <
-        (ONLP_SNMP_CONFIG_UPDATE_PERIOD * 1000 * 1000)) {
-        return;
-    }
 
     if (restructure_trigger) {
         AIM_LOG_INFO("restructure has not happened, skip sensor update");
         return;
     }
 
-    last_sensor_update_time = now;
-    AIM_LOG_TRACE("update sensor objects");
+    /* requested rediscovery is limited to once per update period */
+    discover = last_discovery_time == 0 ||
+        (now - last_discovery_time >=
+         (ONLP_SNMP_CONFIG_DISCOVERY_PERIOD * 1000 * 1000)) ||
+        (discovery_trigger &&
+         now - last_discovery_time >=
+         (ONLP_SNMP_CONFIG_UPDATE_PERIOD * 1000 * 1000));
 
-    /* for each table: mark next_info invalid */
     for (i = ONLP_SNMP_SENSOR_TYPE_TEMP; i <= ONLP_SNMP_SENSOR_TYPE_MAX; i++) {
         ctrl = get_sensor_ctrl__(i);
-        LIST_FOREACH(&ctrl->sensors, curr) {
-            ss = container_of(curr, links, onlp_snmp_sensor_t);
-            get_next_info(ss)->valid = false;
+        if (i >= AIM_ARRAYSIZE(all_update_handler_fns__) ||
+            all_update_handler_fns__[i] == NULL || ctrl->period == 0) {
+            continue;
+        }
+        if (discover || now - ctrl->last_update_time >= ctrl->period) {
+            update[i] = true;
+            any = true;
         }
     }
+    if (!any) {
+        return;
+    }
+
+    AIM_LOG_TRACE("update sensor objects");
+
+    if (discover) {
+        AIM_LOG_TRACE("discover sensor objects");
+        if (discovery_trigger) {
+            /* topology may have changed; don't wait for the registry */
+            onlp_oid_registry_invalidate(0);
+        }
+        discovery_trigger = false;
+        last_discovery_time = now;
+
+        /* for each table: mark next_info invalid */
+        for (i = ONLP_SNMP_SENSOR_TYPE_TEMP; i <= ONLP_SNMP_SENSOR_TYPE_MAX; i++) {
+            ctrl = get_sensor_ctrl__(i);
+            LIST_FOREACH(&ctrl->sensors, curr) {
+                ss = container_of(curr, links, onlp_snmp_sensor_t);
+                get_next_info(ss)->valid = false;
+            }
+        }
 
-    /* discover new sensors for all tables,
-     * writing validity into next_info for all sensors */
-    onlp_oid_iterate(ONLP_OID_SYS, 0, collect_sensors__, NULL);
+        /* discover new sensors for all tables,
+         * writing validity into next_info for all sensors */
+        onlp_oid_iterate(ONLP_OID_SYS, 0, collect_sensors__, NULL);
 
-    /* for each table: update all sensor info */
+        end = aim_time_monotonic();
+        last_discovery_usecs = end - now;
+        discovery_cycles++;
+    }
+    else {
+        /* sensors keep their validity unless their update fails */
+        for (i = ONLP_SNMP_SENSOR_TYPE_TEMP; i <= ONLP_SNMP_SENSOR_TYPE_MAX; i++) {
+            if (!update[i]) {
+                continue;
+            }
+            ctrl = get_sensor_ctrl__(i);
+            LIST_FOREACH(&ctrl->sensors, curr) {
+                ss = container_of(curr, links, onlp_snmp_sensor_t);
+                get_next_info(ss)->valid = get_curr_info(ss)->valid;
+            }
+        }
+    }
+
+    /* for each table due: update all sensor info */
     for (i = ONLP_SNMP_SENSOR_TYPE_TEMP; i <= ONLP_SNMP_SENSOR_TYPE_MAX; i++) {
+        if (!update[i]) {
+            continue;
+        }
         ctrl = get_sensor_ctrl__(i);
         LIST_FOREACH(&ctrl->sensors, curr) {
             ss = container_of(curr, links, onlp_snmp_sensor_t);
@@ -1027,13 +1166,36 @@ update_tables__(void)
                 if ((*all_update_handler_fns__[i])(ss) != ONLP_STATUS_OK) {
                     AIM_LOG_ERROR("failed to update %s%s", ss->name, ss->desc);
                     get_next_info(ss)->valid = false;
+                    /*
+                     * Rediscover when a valid sensor starts failing, not
+                     * on every failure of one that keeps failing.
+                     */
+                    if (get_curr_info(ss)->valid) {
+                        discovery_trigger = true;
+                    }
+                }
+                else if (get_curr_info(ss)->valid &&
+                         sensor_present__(get_curr_info(ss), i) !=
+                         sensor_present__(get_next_info(ss), i)) {
+                    /* hotplug: children of this object may have changed */
+                    AIM_LOG_INFO("presence change for %s%s", ss->name, ss->desc);
+                    discovery_trigger = true;
                 }
             }
         }
+
+        /* swap front and back buffers */
+        swap_curr_next_info(ctrl);
+        ctrl->last_update_time = now;
+        ctrl->restructure = true;
     }
 
-    /* swap front and back buffers */
-    swap_curr_next_info();
+    end = aim_time_monotonic();
+    last_update_usecs = end - now;
+    if (last_update_usecs > max_update_usecs) {
+        max_update_usecs = last_update_usecs;
+    }
+    update_cycles++;
 
     /* trigger table restructuring */
     AIM_LOG_TRACE("trigger restructure");
@@ -1045,6 +1207,8 @@ update_tables__(void)
  * registered with snmp_alarm_register.
  * table restructuring then happens within alarm handler,
  * thus avoiding crashes when table is changed while handling snmp requests.
+ * only tables updated since the last restructure are visited,
+ * and only rows whose validity changed are touched.
  */
 static void
 restructure_tables__(unsigned int reg, void *clientarg)
@@ -1063,9 +1227,13 @@ restructure_tables__(unsigned int reg, void *clientarg)
 
     AIM_LOG_INFO("restructuring tables");
 
-    /* for each table: add or delete rows as necessary */
+    /* for each updated table: add or delete rows as necessary */
     for (i = ONLP_SNMP_SENSOR_TYPE_TEMP; i <= ONLP_SNMP_SENSOR_TYPE_MAX; i++) {
         ctrl = get_sensor_ctrl__(i);
+        if (!ctrl->restructure) {
+            continue;
+        }
+        ctrl->restructure = false;
         LIST_FOREACH_SAFE(&ctrl->sensors, curr, next) {
             ss = container_of(curr, links, onlp_snmp_sensor_t);
             previously_valid = get_next_info(ss)->valid;
@@ -1114,6 +1282,12 @@ init_all_tables__(void)
                     sizeof(ctrl->name));
         list_init(&ctrl->sensors);
     }
+    get_sensor_ctrl__(ONLP_SNMP_SENSOR_TYPE_TEMP)->period =
+        ONLP_SNMP_CONFIG_TEMP_UPDATE_PERIOD * 1000 * 1000;
+    get_sensor_ctrl__(ONLP_SNMP_SENSOR_TYPE_FAN)->period =
+        ONLP_SNMP_CONFIG_FAN_UPDATE_PERIOD * 1000 * 1000;
+    get_sensor_ctrl__(ONLP_SNMP_SENSOR_TYPE_PSU)->period =
+        ONLP_SNMP_CONFIG_PSU_UPDATE_PERIOD * 1000 * 1000;
 
     /* register oids with netsnmp */
     table_cfg_t cfgs[] = {
@@ -1151,6 +1325,26 @@ init_all_tables__(void)
 }
 
 
+static void
+stats_register__(int index, const char *name, u_long *value)
+{
+    oid o[] = { ONLP_SNMP_SENSOR_UPDATE_STATS_OID, index };
+    netsnmp_register_read_only_ulong_instance(name, o, OID_LENGTH(o),
+                                              value, NULL);
+}
+
+/* exports the update cycle statistics */
+static void
+init_stats__(void)
+{
+    stats_register__(1, "onlSensorUpdateCycles", &update_cycles);
+    stats_register__(2, "onlSensorUpdateLastUsecs", &last_update_usecs);
+    stats_register__(3, "onlSensorUpdateMaxUsecs", &max_update_usecs);
+    stats_register__(4, "onlSensorDiscoveryCycles", &discovery_cycles);
+    stats_register__(5, "onlSensorDiscoveryLastUsecs", &last_discovery_usecs);
+}
+
+
 /* populates initial stats and sets up periodic timer */
 static void
 setup_alarm__(void)
@@ -1167,17 +1361,46 @@ int
 onlp_snmp_sensors_init(void)
 {
     init_all_tables__();
+    init_stats__();
     setup_alarm__();
     return 0;
 }
 
 #define MIN(a,b) ((a)<(b)? (a): (b))
+static uint64_t
+us_remaining(uint64_t now, uint64_t last, uint64_t period)
+{
+    uint64_t deltat = now - last;
+    return (deltat >= period) ? 0 : period - deltat;
+}
+
 static unsigned int
 us_to_next_update(void)
 {
-    uint64_t deltat = aim_time_monotonic() - last_sensor_update_time;
-    uint64_t period = ONLP_SNMP_CONFIG_UPDATE_PERIOD * 1000 * 1000;
-    return MIN(period - deltat, period);
+    int i;
+    uint64_t now = aim_time_monotonic();
+    uint64_t rv = us_remaining(now, last_discovery_time,
+                               ONLP_SNMP_CONFIG_DISCOVERY_PERIOD * 1000 * 1000);
+
+    /* the earliest of discovery and each table's next update */
+    for (i = ONLP_SNMP_SENSOR_TYPE_TEMP; i <= ONLP_SNMP_SENSOR_TYPE_MAX; i++) {
+        onlp_snmp_sensor_ctrl_t *ctrl = get_sensor_ctrl__(i);
+        if (ctrl->period == 0) {
+            continue;
+        }
+        rv = MIN(rv, us_remaining(now, ctrl->last_update_time, ctrl->period));
+    }
+
+    if (discovery_trigger) {
+        rv = MIN(rv, us_remaining(now, last_discovery_time,
+                                  ONLP_SNMP_CONFIG_UPDATE_PERIOD * 1000 * 1000));
+    }
+
+    /* retry soon if a restructure is pending */
+    if (restructure_trigger) {
+        rv = MIN(rv, 1000 * 1000);
+    }
+    return rv;
 }
 
 static void *
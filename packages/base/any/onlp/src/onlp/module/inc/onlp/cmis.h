@@ -0,0 +1,185 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * CMIS (QSFP-DD, OSFP) module bring-up.
+ *
+ * The engine takes each enabled port from insertion through
+ * module power up, application selection and data path
+ * activation, then monitors it until it is removed.
+ *
+ * Every step is a short, non-blocking register access. Waits
+ * for the module are scheduled on a timer wheel, so many ports
+ * are brought up concurrently and a slow module does not hold
+ * up the others.
+ *
+ * The engine runs from the platform manager once started with
+ * onlp_cmis_start(). Applications which do not run the platform
+ * manager may call onlp_cmis_poll() directly.
+ *
+ ***********************************************************/
+#ifndef __ONLP_CMIS_H__
+#define __ONLP_CMIS_H__
+
+#include <onlp/onlp.h>
+#include <AIM/aim_pvs.h>
+
+/** Maximum port number + 1. */
+#define ONLP_CMIS_PORTS_MAX 256
+
+/** Maximum number of host lanes. */
+#define ONLP_CMIS_LANES_MAX 8
+
+/** Port state. */
+typedef enum onlp_cmis_state_e {
+    /** The port is not managed. */
+    ONLP_CMIS_STATE_DISABLED,
+    /** No module. */
+    ONLP_CMIS_STATE_ABSENT,
+    /** A module has been inserted. */
+    ONLP_CMIS_STATE_INSERTED,
+    /** The module is not a CMIS module. */
+    ONLP_CMIS_STATE_UNSUPPORTED,
+    /** Waiting for the module to leave low power. */
+    ONLP_CMIS_STATE_MODULE_PWRUP,
+    /** Waiting for the application configuration to be accepted. */
+    ONLP_CMIS_STATE_APP_CONFIG,
+    /** Waiting for the data paths to activate. */
+    ONLP_CMIS_STATE_DP_INIT,
+    /** The data paths are active. */
+    ONLP_CMIS_STATE_ACTIVE,
+    /** Bring-up failed. See the status error. */
+    ONLP_CMIS_STATE_FAULT,
+} onlp_cmis_state_t;
+
+/**
+ * Port configuration.
+ */
+typedef struct onlp_cmis_port_config_s {
+    /**
+     * The application to select (the AppSel code, 1-15).
+     * Zero selects the first application advertised by the module.
+     */
+    int appsel;
+    /**
+     * The host lanes to activate (bit 0 is lane 1).
+     * Zero activates every data path the application allows.
+     */
+    uint8_t host_lanes;
+} onlp_cmis_port_config_t;
+
+/**
+ * Port status.
+ */
+typedef struct onlp_cmis_port_status_s {
+    onlp_cmis_state_t state;
+
+    /** SFF-8024 identifier and CMIS revision. */
+    uint8_t identifier;
+    uint8_t revision;
+    /** The module has flat memory (no data path control). */
+    int flat;
+
+    /** The selected application and its interfaces. */
+    int appsel;
+    uint8_t host_interface;
+    uint8_t media_interface;
+    uint8_t host_lanes;
+
+    /** Monotonic time (usecs) of the last insertion. */
+    uint64_t inserted;
+    /** Monotonic time (usecs) at which the current state was entered. */
+    uint64_t state_time;
+
+    /** Duration (usecs) of each phase of the last bring-up. */
+    uint64_t pwrup_time;
+    uint64_t config_time;
+    uint64_t dpinit_time;
+    /** Insertion to ACTIVE (usecs). */
+    uint64_t total_time;
+
+    /** The number of completed bring-ups. */
+    int bringups;
+    /** The number of failed bring-ups. */
+    int faults;
+
+    /** The reason for the last fault. */
+    char error[64];
+} onlp_cmis_port_status_t;
+
+/**
+ * @brief Manage a port.
+ * @param port The port.
+ * @param config The port configuration. NULL selects the defaults.
+ * @note A port which is already managed is reconfigured and
+ * brought up again.
+ */
+int onlp_cmis_port_enable(int port, const onlp_cmis_port_config_t* config);
+
+/**
+ * @brief Stop managing a port.
+ * @param port The port.
+ * @note The module is left in its current state.
+ */
+int onlp_cmis_port_disable(int port);
+
+/**
+ * @brief Bring a managed port up again.
+ * @param port The port.
+ * @note Use this to recover from a fault without removing the module.
+ */
+int onlp_cmis_port_restart(int port);
+
+/**
+ * @brief Get the status of a port.
+ * @param port The port.
+ * @param [out] status Receives the status.
+ */
+int onlp_cmis_port_status_get(int port, onlp_cmis_port_status_t* status);
+
+/**
+ * @brief Run the steps which are due.
+ * @param [out] next Receives the time (usecs) until the next step. May be NULL.
+ * @returns The number of steps run.
+ */
+int onlp_cmis_poll(uint64_t* next);
+
+/**
+ * @brief Run the engine from the platform manager.
+ */
+int onlp_cmis_start(void);
+
+/**
+ * @brief Stop running the engine from the platform manager.
+ */
+int onlp_cmis_stop(void);
+
+/**
+ * @brief Show the state and bring-up timing of all managed ports.
+ * @param pvs The output pvs.
+ */
+void onlp_cmis_show(aim_pvs_t* pvs);
+
+/**
+ * @brief Get the name of a port state.
+ */
+const char* onlp_cmis_state_name(onlp_cmis_state_t state);
+
+#endif /* __ONLP_CMIS_H__ */
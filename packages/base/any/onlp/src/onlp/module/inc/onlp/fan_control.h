@@ -0,0 +1,308 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Policy driven thermal and fan control.
+ *
+ * A platform describes its fan policy (sensor groups, thresholds
+ * with hysteresis, optional PID control, airflow direction and
+ * failure overrides) and calls onlp_fan_control_manage() from its
+ * onlp_sysi_platform_manage_fans().
+ *
+ * Each cycle takes a single snapshot of the policy's thermals and
+ * fans, decides the duty cycle from the snapshot only, and applies
+ * it. The decision step does not touch the hardware, so recorded
+ * traces can be replayed through a policy offline.
+ *
+ ***********************************************************/
+#ifndef __ONLP_FAN_CONTROL_H__
+#define __ONLP_FAN_CONTROL_H__
+
+#include <onlp/onlp.h>
+#include <onlp/oids.h>
+#include <AIM/aim_pvs.h>
+
+/** Maximum number of groups in a policy. */
+#define ONLP_FAN_CONTROL_GROUPS_MAX 8
+/** Maximum number of thermals in a group. */
+#define ONLP_FAN_CONTROL_GROUP_THERMALS_MAX 16
+/** Maximum number of levels in a group. */
+#define ONLP_FAN_CONTROL_LEVELS_MAX 8
+/** Maximum number of fans in a policy. */
+#define ONLP_FAN_CONTROL_FANS_MAX 16
+/** Maximum number of distinct thermals in a policy. */
+#define ONLP_FAN_CONTROL_THERMALS_MAX 32
+
+/** How a group combines its thermals. */
+typedef enum onlp_fan_control_aggregate_e {
+    ONLP_FAN_CONTROL_AGGREGATE_MAX,
+    ONLP_FAN_CONTROL_AGGREGATE_AVG,
+} onlp_fan_control_aggregate_t;
+
+/** Airflow direction. */
+typedef enum onlp_fan_control_airflow_e {
+    ONLP_FAN_CONTROL_AIRFLOW_ANY,
+    ONLP_FAN_CONTROL_AIRFLOW_F2B,
+    ONLP_FAN_CONTROL_AIRFLOW_B2F,
+} onlp_fan_control_airflow_t;
+
+/** Alarm state. */
+typedef enum onlp_fan_control_alarm_e {
+    ONLP_FAN_CONTROL_ALARM_NONE,
+    ONLP_FAN_CONTROL_ALARM_WARNING,
+    ONLP_FAN_CONTROL_ALARM_CRITICAL,
+} onlp_fan_control_alarm_t;
+
+/** Why a duty cycle was chosen. */
+typedef enum onlp_fan_control_reason_e {
+    /** Thermal policy. */
+    ONLP_FAN_CONTROL_REASON_THERMAL,
+    /** A fan has failed or is missing. */
+    ONLP_FAN_CONTROL_REASON_FAN_FAILURE,
+    /** A thermal could not be read. */
+    ONLP_FAN_CONTROL_REASON_SENSOR_FAILURE,
+} onlp_fan_control_reason_t;
+
+/**
+ * A thermal level.
+ * The group moves up to this level when its temperature is above
+ * up_mc, and back down when it is at or below down_mc.
+ */
+typedef struct onlp_fan_control_level_s {
+    int up_mc;
+    int down_mc;
+    int duty;
+} onlp_fan_control_level_t;
+
+/**
+ * Optional PID control toward a setpoint.
+ * Gains are in thousandths of a duty percent per degree C
+ * (per degree C second for ki, per degree C per second for kd).
+ * The PID output never goes below the current level's duty.
+ */
+typedef struct onlp_fan_control_pid_s {
+    int setpoint_mc;
+    int kp;
+    int ki;
+    int kd;
+} onlp_fan_control_pid_t;
+
+/**
+ * A group of thermals sharing one set of levels.
+ */
+typedef struct onlp_fan_control_group_s {
+    /** Name (for logging and replay output). */
+    char name[32];
+    /** The airflow this group applies to. */
+    onlp_fan_control_airflow_t airflow;
+    /** The thermals in this group. Zero terminated. */
+    onlp_oid_t thermals[ONLP_FAN_CONTROL_GROUP_THERMALS_MAX];
+    onlp_fan_control_aggregate_t aggregate;
+    /** The levels, lowest first. Level 0 is the default. */
+    onlp_fan_control_level_t levels[ONLP_FAN_CONTROL_LEVELS_MAX];
+    int level_count;
+    /** Optional PID control. Disabled if all gains are zero. */
+    onlp_fan_control_pid_t pid;
+    /** Alarm thresholds. Zero disables. */
+    int warning_mc;
+    int critical_mc;
+    /** The warning clears below warning_mc - alarm_hysteresis_mc. */
+    int alarm_hysteresis_mc;
+} onlp_fan_control_group_t;
+
+/**
+ * Fan control policy.
+ */
+typedef struct onlp_fan_control_policy_s {
+    char name[32];
+    /** The fans monitored for failures. Zero terminated. */
+    onlp_oid_t fans[ONLP_FAN_CONTROL_FANS_MAX];
+    /**
+     * The fans whose duty cycle is set. Zero terminated.
+     * Platforms with a shared PWM list a single fan.
+     */
+    onlp_oid_t duty_fans[ONLP_FAN_CONTROL_FANS_MAX];
+    int duty_min;
+    int duty_max;
+    /** Duty cycle when a fan has failed or is missing. */
+    int fan_fail_duty;
+    /** Duty cycle when a thermal cannot be read. */
+    int sensor_fail_duty;
+    onlp_fan_control_group_t groups[ONLP_FAN_CONTROL_GROUPS_MAX];
+    int group_count;
+} onlp_fan_control_policy_t;
+
+/**
+ * One reading of all policy inputs.
+ */
+typedef struct onlp_fan_control_snapshot_s {
+    /** Monotonic time in microseconds. */
+    uint64_t time;
+    int thermal_count;
+    onlp_oid_t thermals[ONLP_FAN_CONTROL_THERMALS_MAX];
+    int mcelsius[ONLP_FAN_CONTROL_THERMALS_MAX];
+    /** Nonzero if the thermal was read successfully. */
+    int thermal_ok[ONLP_FAN_CONTROL_THERMALS_MAX];
+    int fan_count;
+    onlp_oid_t fans[ONLP_FAN_CONTROL_FANS_MAX];
+    /** ONLP_FAN_STATUS_* flags, or zero if the fan could not be read. */
+    uint32_t fan_status[ONLP_FAN_CONTROL_FANS_MAX];
+    /** The current duty cycle, or -1 if unknown. */
+    int duty;
+} onlp_fan_control_snapshot_t;
+
+/**
+ * A duty cycle decision.
+ */
+typedef struct onlp_fan_control_decision_s {
+    int duty;
+    onlp_fan_control_reason_t reason;
+    onlp_fan_control_airflow_t airflow;
+    onlp_fan_control_alarm_t alarm;
+    /** Nonzero if the alarm changed with this decision. */
+    int alarm_changed;
+    /** Per-group temperature, level and duty. */
+    int group_mc[ONLP_FAN_CONTROL_GROUPS_MAX];
+    int group_level[ONLP_FAN_CONTROL_GROUPS_MAX];
+    int group_duty[ONLP_FAN_CONTROL_GROUPS_MAX];
+} onlp_fan_control_decision_t;
+
+struct onlp_fan_control_s;
+
+/**
+ * Called when the critical alarm is raised.
+ */
+typedef void (*onlp_fan_control_critical_f)(struct onlp_fan_control_s* fc,
+                                            onlp_fan_control_decision_t* d);
+
+/**
+ * Fan controller state.
+ */
+typedef struct onlp_fan_control_s {
+    const onlp_fan_control_policy_t* policy;
+    /** Optional critical alarm handler. */
+    onlp_fan_control_critical_f critical;
+    /**
+     * Optional current duty cycle reader. By default the percentage
+     * reported by the first duty fan is used.
+     */
+    int (*duty_get)(struct onlp_fan_control_s* fc, int* duty);
+    /** The airflow. Detected from the fans if ANY. */
+    onlp_fan_control_airflow_t airflow;
+
+    /** The distinct thermals used by the policy. */
+    int thermal_count;
+    onlp_oid_t thermals[ONLP_FAN_CONTROL_THERMALS_MAX];
+
+    /** Decision state. */
+    int level[ONLP_FAN_CONTROL_GROUPS_MAX];
+    int64_t integral[ONLP_FAN_CONTROL_GROUPS_MAX];
+    int last_error[ONLP_FAN_CONTROL_GROUPS_MAX];
+    uint64_t last_time;
+    onlp_fan_control_alarm_t alarm;
+    int last_duty;
+    onlp_fan_control_reason_t last_reason;
+
+    /** Statistics. */
+    uint64_t cycles;
+    uint64_t duty_changes;
+    uint64_t read_errors;
+} onlp_fan_control_t;
+
+/**
+ * @brief Initialize a fan controller.
+ * @param fc The controller.
+ * @param policy The policy. Must remain valid while the controller is in use.
+ * @note The critical and duty_get hooks may be set after initialization.
+ */
+int onlp_fan_control_init(onlp_fan_control_t* fc,
+                          const onlp_fan_control_policy_t* policy);
+
+/**
+ * @brief Read all policy inputs through the platform interface.
+ * @param fc The controller.
+ * @param [out] snap Receives the snapshot.
+ * @note Each thermal and fan is read once, however many groups use it.
+ */
+int onlp_fan_control_snapshot(onlp_fan_control_t* fc,
+                              onlp_fan_control_snapshot_t* snap);
+
+/**
+ * @brief Decide the duty cycle for a snapshot.
+ * @param fc The controller.
+ * @param snap The snapshot.
+ * @param [out] d Receives the decision.
+ * @note This does not access the hardware.
+ */
+int onlp_fan_control_decide(onlp_fan_control_t* fc,
+                            const onlp_fan_control_snapshot_t* snap,
+                            onlp_fan_control_decision_t* d);
+
+/**
+ * @brief Apply a decision.
+ * @param fc The controller.
+ * @param snap The snapshot the decision was made from.
+ * @param d The decision.
+ * @note The duty cycle is only written when it differs from the
+ * snapshot. Alarm transitions are logged here.
+ */
+int onlp_fan_control_apply(onlp_fan_control_t* fc,
+                           const onlp_fan_control_snapshot_t* snap,
+                           onlp_fan_control_decision_t* d);
+
+/**
+ * @brief Run one control cycle (snapshot, decide and apply).
+ * @param fc The controller.
+ */
+int onlp_fan_control_manage(onlp_fan_control_t* fc);
+
+/**
+ * @brief Load a policy from a JSON file.
+ * @param fname The file name.
+ * @param [out] policy Receives the policy. Free with aim_free().
+ * @note OIDs are given as "<type>-<id>" (for example "thermal-4")
+ * or as numbers.
+ */
+int onlp_fan_control_policy_load(const char* fname,
+                                 onlp_fan_control_policy_t** policy);
+
+/**
+ * @brief Replay a recorded trace through a policy.
+ * @param policy The policy.
+ * @param fname The trace file.
+ * @param pvs Receives one decision per trace row.
+ * @note The trace is CSV. The header row is "time" followed by the
+ * OID of each column, in the policy file format. Each row is the time in milliseconds followed
+ * by the thermal mcelsius, or the fan status flags, for each column.
+ * An empty or "x" value is a failed read. The column "duty" may be
+ * used for the current duty cycle; otherwise the previous decision
+ * is assumed to have been applied.
+ */
+int onlp_fan_control_replay(const onlp_fan_control_policy_t* policy,
+                            const char* fname, aim_pvs_t* pvs);
+
+/**
+ * @brief Show the controller state and statistics.
+ * @param fc The controller.
+ * @param pvs The output pvs.
+ */
+void onlp_fan_control_show(onlp_fan_control_t* fc, aim_pvs_t* pvs);
+
+#endif /* __ONLP_FAN_CONTROL_H__ */
@@ -105,7 +105,11 @@ typedef enum onlp_oid_type_e {
 
 typedef char onlp_oid_desc_t[ONLP_OID_DESC_SIZE];
 
-/* fixme */
+/**
+ * The size of the child table in each OID header.
+ * This limits the children reported by a single header only.
+ * Use the OID iterators below to walk the platform without limit.
+ */
 #define ONLP_OID_TABLE_SIZE 128
 
 typedef onlp_oid_t onlp_oid_table_t[ONLP_OID_TABLE_SIZE];
@@ -193,6 +197,87 @@ int onlp_oid_iterate(onlp_oid_t oid, onlp_oid_type_t type,
  */
 int onlp_oid_hdr_get(onlp_oid_t oid, onlp_oid_hdr_t* hdr);
 
+/**
+ * OID child iterator.
+ *
+ * Children are served from the OID registry, which indexes the child
+ * OIDs of each object by OID and refreshes them from the platform
+ * every ONLP_CONFIG_OID_REGISTRY_TTL_MS. No headers are copied
+ * while iterating.
+ */
+typedef struct onlp_oid_iter_s {
+    /** The parent OID. */
+    onlp_oid_t parent;
+    /** The OID type filter (optional). */
+    onlp_oid_type_t type;
+    /** The next child position. */
+    int index;
+} onlp_oid_iter_t;
+
+/**
+ * @brief Start iterating over the children of an OID.
+ * @param iter The iterator.
+ * @param parent The parent OID. Zero means ONLP_OID_SYS.
+ * @param type The OID type filter (optional)
+ */
+int onlp_oid_iter_init(onlp_oid_iter_t* iter, onlp_oid_t parent,
+                       onlp_oid_type_t type);
+
+/**
+ * @brief Get the next child OID.
+ * @param iter The iterator.
+ * @param [out] oid Receives the next child.
+ * @returns 1 if a child was returned, 0 when done.
+ */
+int onlp_oid_iter_next(onlp_oid_iter_t* iter, onlp_oid_t* oid);
+
+/**
+ * @brief Iterate over the children of the given OID.
+ * @param _parent The parent OID.
+ * @param _iter   onlp_oid_iter_t iterator state.
+ * @param _oid    onlp_oid_t which receives each child.
+ */
+#define ONLP_OID_CHILD_ITER(_parent, _iter, _oid)                       \
+    for(onlp_oid_iter_init(&(_iter), _parent, 0);                       \
+        onlp_oid_iter_next(&(_iter), &(_oid)) == 1; )
+
+/**
+ * @brief Iterate over the children of the given OID of the given type.
+ * @param _parent The parent OID.
+ * @param _iter   onlp_oid_iter_t iterator state.
+ * @param _oid    onlp_oid_t which receives each child.
+ * @param _type   The OID Type
+ */
+#define ONLP_OID_CHILD_ITER_TYPE(_parent, _iter, _oid, _type)           \
+    for(onlp_oid_iter_init(&(_iter), _parent, ONLP_OID_TYPE_##_type);   \
+        onlp_oid_iter_next(&(_iter), &(_oid)) == 1; )
+
+/**
+ * @brief Get the number of children of an OID.
+ * @param oid The OID. Zero means ONLP_OID_SYS.
+ * @param type The OID type filter (optional)
+ */
+int onlp_oid_children_count(onlp_oid_t oid, onlp_oid_type_t type);
+
+/**
+ * @brief Get the parent of an OID.
+ * @param oid The OID.
+ * @param [out] poid Receives the parent OID.
+ */
+int onlp_oid_parent_get(onlp_oid_t oid, onlp_oid_t* poid);
+
+/**
+ * @brief Force the OID registry to refresh from the platform.
+ * @param oid The OID to refresh, or zero for all.
+ */
+void onlp_oid_registry_invalidate(onlp_oid_t oid);
+
+/**
+ * @brief Show the OID registry statistics.
+ * @param pvs The output pvs.
+ */
+void onlp_oid_registry_show(aim_pvs_t* pvs);
+
 
 
 
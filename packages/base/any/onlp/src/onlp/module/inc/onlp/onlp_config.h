@@ -254,6 +254,206 @@
 #define ONLP_CONFIG_INCLUDE_API_PROFILING 0
 #endif
 
+/**
+ * ONLP_CONFIG_INCLUDE_API_CACHE
+ *
+ * Include the OID information snapshot cache. */
+
+
+#ifndef ONLP_CONFIG_INCLUDE_API_CACHE
+#define ONLP_CONFIG_INCLUDE_API_CACHE 1
+#endif
+
+/**
+ * ONLP_CONFIG_API_CACHE_SHARED
+ *
+ * If 1, the OID information cache is kept in shared memory and used by all ONLP processes. */
+
+
+#ifndef ONLP_CONFIG_API_CACHE_SHARED
+#define ONLP_CONFIG_API_CACHE_SHARED ONLP_CONFIG_API_LOCK_GLOBAL_SHARED
+#endif
+
+/**
+ * ONLP_CONFIG_API_CACHE_SIZE
+ *
+ * The maximum number of cached entries per OID type. */
+
+
+#ifndef ONLP_CONFIG_API_CACHE_SIZE
+#define ONLP_CONFIG_API_CACHE_SIZE 128
+#endif
+
+/**
+ * ONLP_CONFIG_API_LOCK_DOMAINS
+ *
+ * If 1, the API lock is split into per-subsystem lock domains (sys, thermal, fan, psu, led, sfp). The platform drivers must tolerate concurrent calls into different subsystems. */
+
+
+#ifndef ONLP_CONFIG_API_LOCK_DOMAINS
+#define ONLP_CONFIG_API_LOCK_DOMAINS 0
+#endif
+
+/**
+ * ONLP_CONFIG_API_LOCK_SHARED_READERS
+ *
+ * If 1 (and lock domains are enabled), query APIs take their lock domain in shared (read) mode. */
+
+
+#ifndef ONLP_CONFIG_API_LOCK_SHARED_READERS
+#define ONLP_CONFIG_API_LOCK_SHARED_READERS 0
+#endif
+
+/**
+ * ONLP_CONFIG_API_LOCK_INDEXED
+ *
+ * If 1 (and lock domains are enabled), per-port SFP APIs lock only the given port within the SFP domain. With shared readers, domain-wide queries take every port lock shared. */
+
+
+#ifndef ONLP_CONFIG_API_LOCK_INDEXED
+#define ONLP_CONFIG_API_LOCK_INDEXED 0
+#endif
+
+/**
+ * ONLP_CONFIG_API_LOCK_INDEX_MAX
+ *
+ * The maximum number of per-port locks within a lock domain. */
+
+
+#ifndef ONLP_CONFIG_API_LOCK_INDEX_MAX
+#define ONLP_CONFIG_API_LOCK_INDEX_MAX 256
+#endif
+
+/**
+ * ONLP_CONFIG_API_LOCK_FILENAME
+ *
+ * The lock file used for cross-process lock domains when the global shared API lock is enabled. */
+
+
+#ifndef ONLP_CONFIG_API_LOCK_FILENAME
+#define ONLP_CONFIG_API_LOCK_FILENAME "/var/run/onlp-api.lock"
+#endif
+
+/**
+ * ONLP_CONFIG_INCLUDE_API_LOCK_STATS
+ *
+ * Include API lock contention statistics. */
+
+
+#ifndef ONLP_CONFIG_INCLUDE_API_LOCK_STATS
+#define ONLP_CONFIG_INCLUDE_API_LOCK_STATS 1
+#endif
+
+/**
+ * ONLP_CONFIG_SFP_NOTIFY_SUBSCRIBERS_MAX
+ *
+ * Maximum number of SFP change notification subscribers. */
+
+
+#ifndef ONLP_CONFIG_SFP_NOTIFY_SUBSCRIBERS_MAX
+#define ONLP_CONFIG_SFP_NOTIFY_SUBSCRIBERS_MAX 16
+#endif
+
+/**
+ * ONLP_CONFIG_SFP_NOTIFY_POLL_MS
+ *
+ * SFP presence and RX_LOS polling interval used by the platform manager (milliseconds). */
+
+
+#ifndef ONLP_CONFIG_SFP_NOTIFY_POLL_MS
+#define ONLP_CONFIG_SFP_NOTIFY_POLL_MS 1000
+#endif
+
+/**
+ * ONLP_CONFIG_SFP_DOM_BATCH_THREADS_MAX
+ *
+ * Maximum number of threads used for parallel batched SFP DOM reads. */
+
+
+#ifndef ONLP_CONFIG_SFP_DOM_BATCH_THREADS_MAX
+#define ONLP_CONFIG_SFP_DOM_BATCH_THREADS_MAX 4
+#endif
+
+/**
+ * ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MIN_MS
+ *
+ * Fastest fan management interval, used when a thermal is near its warning threshold. */
+
+
+#ifndef ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MIN_MS
+#define ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MIN_MS 2000
+#endif
+
+/**
+ * ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MAX_MS
+ *
+ * Slowest fan management interval. The interval doubles up to this value while all thermals have headroom. The default matches the previous fixed fan management rate. */
+
+
+#ifndef ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MAX_MS
+#define ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MAX_MS 10000
+#endif
+
+/**
+ * ONLP_CONFIG_PLATFORM_MANAGE_FANS_HEADROOM_MC
+ *
+ * Thermal headroom to the warning threshold (milli-celsius) below which fans are managed at the fastest interval. */
+
+
+#ifndef ONLP_CONFIG_PLATFORM_MANAGE_FANS_HEADROOM_MC
+#define ONLP_CONFIG_PLATFORM_MANAGE_FANS_HEADROOM_MC 10000
+#endif
+
+/**
+ * ONLP_CONFIG_OID_REGISTRY_TTL_MS
+ *
+ * How long the OID registry serves child OIDs before refreshing them from the platform. Zero refreshes on every iteration. */
+
+
+#ifndef ONLP_CONFIG_OID_REGISTRY_TTL_MS
+#define ONLP_CONFIG_OID_REGISTRY_TTL_MS 1000
+#endif
+
+/**
+ * ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE
+ *
+ * Keep a decoded snapshot of the system information (ONIE EEPROM and platform info). It is only refreshed when explicitly invalidated. */
+
+
+#ifndef ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE
+#define ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE 1
+#endif
+
+/**
+ * ONLP_CONFIG_SYS_INFO_CACHE_SHARED
+ *
+ * If 1, the raw ONIE EEPROM image is also kept in shared memory and used by all ONLP processes. */
+
+
+#ifndef ONLP_CONFIG_SYS_INFO_CACHE_SHARED
+#define ONLP_CONFIG_SYS_INFO_CACHE_SHARED ONLP_CONFIG_API_CACHE_SHARED
+#endif
+
+/**
+ * ONLP_CONFIG_CMIS_POLL_MS
+ *
+ * How often a CMIS module is checked while it is changing state (milliseconds). */
+
+
+#ifndef ONLP_CONFIG_CMIS_POLL_MS
+#define ONLP_CONFIG_CMIS_POLL_MS 50
+#endif
+
+/**
+ * ONLP_CONFIG_CMIS_MONITOR_MS
+ *
+ * How often absent, active and failed CMIS ports are checked (milliseconds). */
+
+
+#ifndef ONLP_CONFIG_CMIS_MONITOR_MS
+#define ONLP_CONFIG_CMIS_MONITOR_MS 1000
+#endif
+
 
 
 /**
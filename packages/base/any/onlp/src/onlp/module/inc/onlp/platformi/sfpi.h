@@ -64,6 +64,14 @@ int onlp_sfpi_presence_bitmap_get(onlp_sfp_bitmap_t* dst);
  */
 int onlp_sfpi_rx_los_bitmap_get(onlp_sfp_bitmap_t* dst);
 
+/**
+ * @brief Return the presence and control status of all SFP ports.
+ * @param dst Receives the status. It is initialized by the caller.
+ * @notes Optional. Controls that are not reported for a port (not set
+ * in dst->valid) are read through onlp_sfpi_control_get().
+ */
+int onlp_sfpi_status_bitmaps_get(onlp_sfp_status_bitmaps_t* dst);
+
 /**
  * @brief Read the SFP EEPROM.
  * @param port The port number.
@@ -119,6 +127,21 @@ int onlp_sfpi_dev_write(int port, uint8_t devaddr, uint8_t addr, uint8_t* data,
  */
 int onlp_sfpi_dom_read(int port, uint8_t data[256]);
 
+/**
+ * @brief Read a range of transceiver memory.
+ * @param port The port number.
+ * @param devaddr The device address (0x50 or 0x51).
+ * @param page The upper memory page. Ignored for offsets below 128.
+ * @param offset The offset within the 256 byte device address space.
+ * @param size The byte count. offset + size must not exceed 256.
+ * @param rdata Receives the data.
+ * @returns ONLP_STATUS_OK if successful, error otherwise.
+ * @notes Optional. If unsupported, the core will use onlp_sfpi_dev_read()
+ * (selecting the page through byte 127 when required).
+ */
+int onlp_sfpi_memory_read(int port, uint8_t devaddr, int page, int offset,
+                          int size, uint8_t* rdata);
+
 /**
  * @brief Perform any actions required after an SFP is inserted.
  * @param port The port number.
@@ -165,6 +188,16 @@ int onlp_sfpi_control_get(int port, onlp_sfp_control_t control, int* value);
  */
 int onlp_sfpi_port_map(int port, int* rport);
 
+/**
+ * @brief Get the i2c bus used to access a port.
+ * @param port The port number.
+ * @param [out] bus Receives the i2c bus number.
+ * @notes Optional. Used to order and parallelize batched reads.
+ * This must not access the hardware and may be called without the
+ * API lock held.
+ */
+int onlp_sfpi_port_bus_get(int port, int* bus);
+
 /**
  * @brief Deinitialize the SFP driver.
  */
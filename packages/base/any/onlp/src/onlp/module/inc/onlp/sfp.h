@@ -107,6 +107,8 @@ int onlp_sfp_is_present(int port);
  * @note This function can return Unsupported.
  * It will not be emulated if the SFPI driver does not support
  * batch collection of the SFP presence.
+ * @note If the SFPI driver provides the status vector
+ * (onlp_sfpi_status_bitmaps_get()) the presence is taken from it.
  */
 int onlp_sfp_presence_bitmap_get(onlp_sfp_bitmap_t* dst);
 
@@ -133,6 +135,39 @@ int onlp_sfp_eeprom_read(int port, uint8_t** rv);
  */
 int onlp_sfp_dom_read(int port, uint8_t** rv);
 
+/**
+ * @brief Read a range of transceiver memory into a caller-supplied buffer.
+ * @param port The SFP Port
+ * @param devaddr The device address (0x50 or 0x51).
+ * @param page The upper memory page. Ignored for offsets below 128.
+ * @param offset The offset within the 256 byte device address space.
+ * @param size The byte count. offset + size must not exceed 256.
+ * @param rdata Receives the data.
+ * @returns The number of bytes read, if successful.
+ * @returns <0 on error.
+ * @note Only the requested bytes are transferred where the platform
+ * supports it. Platforms which only support full EEPROM/DOM reads
+ * can return page 0 data only.
+ */
+int onlp_sfp_memory_read(int port, uint8_t devaddr, int page, int offset,
+                         int size, uint8_t* rdata);
+
+/**
+ * @brief Write a range of transceiver memory.
+ * @param port The SFP Port
+ * @param devaddr The device address (0x50 or 0x51).
+ * @param page The upper memory page. Ignored for offsets below 128.
+ * @param offset The offset within the 256 byte device address space.
+ * @param size The byte count. offset + size must not exceed 256.
+ * @param data The data.
+ * @returns The number of bytes written, if successful.
+ * @returns <0 on error.
+ * @note The page is selected, written and restored to page 0 while
+ * holding the port, so concurrent readers never see the wrong page.
+ */
+int onlp_sfp_memory_write(int port, uint8_t devaddr, int page, int offset,
+                          int size, uint8_t* data);
+
 /**
  * @brief Deinitialize the SFP subsystem.
  */
@@ -144,6 +179,9 @@ int onlp_sfp_denit(void);
  * @note This function can return Unsupported.
  * It will not be emulated if the SFPI driver does not support
  * batch collection of the rx_los status.
+ * @note If the SFPI driver provides the status vector and it reports
+ * RX_LOS for any port, the bitmap is taken from it. Ports it does
+ * not report RX_LOS for are clear.
  */
 int onlp_sfp_rx_los_bitmap_get(onlp_sfp_bitmap_t* dst);
 
@@ -174,6 +212,23 @@ int onlp_sfp_dev_readw(int port, uint8_t devaddr, uint8_t addr);
  */
 int onlp_sfp_dev_writew(int port, uint8_t devaddr, uint8_t addr, uint16_t value);
 
+/**
+ * @brief Read bytes from an address on the given SFP port's bus.
+ * @param port The port number.
+ * @param devaddr The device address.
+ * @param addr The address.
+ * @param rdata Receives the data.
+ * @param size The byte count.
+ */
+int onlp_sfp_dev_read(int port, uint8_t devaddr, uint8_t addr,
+                      uint8_t* rdata, int size);
+
+/**
+ * @brief Write bytes to an address on the given SFP port's bus.
+ */
+int onlp_sfp_dev_write(int port, uint8_t devaddr, uint8_t addr,
+                       uint8_t* data, int size);
+
 
 
 
@@ -226,6 +281,223 @@ int onlp_sfp_control_get(int port, onlp_sfp_control_t control, int* value);
  */
 int onlp_sfp_control_flags_get(int port, uint32_t* flags);
 
+/**
+ * The status of all ports, collected in a single operation.
+ */
+typedef struct onlp_sfp_status_bitmaps_s {
+    /** Present ports. */
+    onlp_sfp_bitmap_t present;
+    /** Control values, indexed by onlp_sfp_control_t. */
+    onlp_sfp_bitmap_t value[ONLP_SFP_CONTROL_COUNT];
+    /** The ports for which each control value is reported. */
+    onlp_sfp_bitmap_t valid[ONLP_SFP_CONTROL_COUNT];
+} onlp_sfp_status_bitmaps_t;
+
+/**
+ * @brief Initialize a status bitmap structure.
+ * @param status The structure.
+ */
+void onlp_sfp_status_bitmaps_t_init(onlp_sfp_status_bitmaps_t* status);
+
+/**
+ * @brief Get the presence and control status of all ports.
+ * @param dst Receives the status.
+ * @note If the SFPI driver does not support batch collection the
+ * status is emulated from the presence bitmap and the control API
+ * (RESET_STATE, RX_LOS, TX_FAULT, TX_DISABLE and LP_MODE of the
+ * present ports).
+ */
+int onlp_sfp_status_bitmaps_get(onlp_sfp_status_bitmaps_t* dst);
+
+/**
+ * @brief Get the value of all SFP controls as part of a port sweep.
+ * @param port The port.
+ * @param status The status vector, collected once for the sweep
+ * with onlp_sfp_status_bitmaps_get(). May be NULL.
+ * @param flags Receives the control flag values. See onlp_sfp_control_flags_t
+ * @note Controls reported in the vector are taken from it. The
+ * rest are queried from the port.
+ */
+int onlp_sfp_control_flags_status_get(int port,
+                                      const onlp_sfp_status_bitmaps_t* status,
+                                      uint32_t* flags);
+
+
+/******************************************************************************
+ *
+ * SFP Change Notifications.
+ *
+ * Presence and RX_LOS transitions are collected by a single poller
+ * (run by the platform manager, or by calling onlp_sfp_notify_poll())
+ * and delivered to each subscriber as bitmap differences.
+ *
+ * The first delivery to a new subscriber reports the current state
+ * as changes from an empty state (all ports absent, no RX_LOS).
+ *
+ * Subscriptions are per process. A subscriber only sees the changes
+ * found by a poller in its own process, so a process which is not
+ * running the platform manager must call onlp_sfp_notify_poll()
+ * itself.
+ *
+ *****************************************************************************/
+
+/**
+ * SFP presence and RX_LOS changes.
+ */
+typedef struct onlp_sfp_notify_s {
+    /** Ports whose presence has changed. */
+    onlp_sfp_bitmap_t presence_changed;
+    /** Current presence bitmap. */
+    onlp_sfp_bitmap_t present;
+    /** Ports whose RX_LOS state has changed. */
+    onlp_sfp_bitmap_t rx_los_changed;
+    /** Current RX_LOS bitmap (present ports only). */
+    onlp_sfp_bitmap_t rx_los;
+} onlp_sfp_notify_t;
+
+/**
+ * SFP change notification handler.
+ * @param notify The changes.
+ * @param cookie The cookie given at registration.
+ * @note Handlers are called from the polling thread without
+ * any ONLP locks held.
+ */
+typedef void (*onlp_sfp_notify_handler_f)(onlp_sfp_notify_t* notify,
+                                          void* cookie);
+
+/**
+ * @brief Register an SFP change notification handler.
+ * @param handler The handler.
+ * @param cookie Passed to the handler.
+ */
+int onlp_sfp_notify_register(onlp_sfp_notify_handler_f handler, void* cookie);
+
+/**
+ * @brief Unregister an SFP change notification handler.
+ * @param handler The handler.
+ * @param cookie The cookie given at registration.
+ */
+int onlp_sfp_notify_unregister(onlp_sfp_notify_handler_f handler, void* cookie);
+
+/**
+ * @brief Subscribe to SFP changes through a file descriptor.
+ * @returns A nonblocking descriptor which becomes readable when
+ * changes are pending, or <0 on error.
+ * @note Use onlp_sfp_notify_fd_read() to retrieve the changes.
+ */
+int onlp_sfp_notify_fd_open(void);
+
+/**
+ * @brief Retrieve pending changes for a descriptor subscription.
+ * @param fd The descriptor returned by onlp_sfp_notify_fd_open().
+ * @param [out] notify Receives the changes accumulated since the last read.
+ * @returns 1 if changes were pending, 0 if not, <0 on error.
+ */
+int onlp_sfp_notify_fd_read(int fd, onlp_sfp_notify_t* notify);
+
+/**
+ * @brief Close a descriptor subscription.
+ * @param fd The descriptor returned by onlp_sfp_notify_fd_open().
+ */
+int onlp_sfp_notify_fd_close(int fd);
+
+/**
+ * @brief Poll presence and RX_LOS and notify subscribers of changes.
+ * @note This is called periodically by the platform manager.
+ * Applications which do not run the platform manager may call it directly.
+ * Nothing is polled while there are no subscribers.
+ */
+int onlp_sfp_notify_poll(void);
+
+/******************************************************************************
+ *
+ * Batched DOM Collection.
+ *
+ * Reads the diagnostic monitors of many ports in one call. Only the
+ * monitor bytes for the requested fields are transferred.
+ *
+ * Ports are visited in order of their root i2c adapter and bus (mux
+ * channel), so accesses to the same channel are consecutive. Each
+ * read still goes through the platform driver, which selects and
+ * deselects the mux channel as it always does. Only mux drivers which
+ * skip re-selecting the current channel save transactions.
+ *
+ * With ONLP_SFP_DOM_BATCH_F_PARALLEL the ports of independent root
+ * adapters are read from separate threads. Each port read takes the
+ * port's API lock, so this only runs concurrently when ports have
+ * their own locks: ONLP_CONFIG_API_LOCK_DOMAINS and
+ * ONLP_CONFIG_API_LOCK_INDEXED are enabled, or the API lock is not
+ * included. Otherwise the flag is ignored and the ports are read
+ * from the caller's thread.
+ *
+ *****************************************************************************/
+
+/** Module temperature. */
+#define ONLP_SFP_DOM_F_TEMP      0x1
+/** Supply voltage. */
+#define ONLP_SFP_DOM_F_VCC       0x2
+/** Per-lane TX bias current. */
+#define ONLP_SFP_DOM_F_BIAS      0x4
+/** Per-lane TX output power. */
+#define ONLP_SFP_DOM_F_TX_POWER  0x8
+/** Per-lane RX input power. */
+#define ONLP_SFP_DOM_F_RX_POWER  0x10
+/** All fields. */
+#define ONLP_SFP_DOM_F_ALL       0x1F
+
+/** Read independent i2c adapters from parallel threads (see above). */
+#define ONLP_SFP_DOM_BATCH_F_PARALLEL 0x1
+
+/** Maximum number of ports in a batch result. */
+#define ONLP_SFP_DOM_BATCH_PORTS_MAX 256
+/** Maximum number of lanes per port. */
+#define ONLP_SFP_DOM_LANES_MAX 8
+
+/**
+ * Batched DOM results.
+ *
+ * All arrays are dense and indexed 0..count-1, in ascending port order.
+ */
+typedef struct onlp_sfp_dom_batch_s {
+    /** Number of ports in the result. */
+    int count;
+    /** Port number. */
+    int port[ONLP_SFP_DOM_BATCH_PORTS_MAX];
+    /**
+     * Port status. ONLP_STATUS_OK, ONLP_STATUS_E_MISSING if the port
+     * is empty, ONLP_STATUS_E_UNSUPPORTED if the module has no
+     * diagnostic monitors, or any other error from the read.
+     */
+    int status[ONLP_SFP_DOM_BATCH_PORTS_MAX];
+    /** The ONLP_SFP_DOM_F_* fields which are valid for this port. */
+    uint32_t fields[ONLP_SFP_DOM_BATCH_PORTS_MAX];
+    /** Number of valid lanes in the per-lane arrays. */
+    int lanes[ONLP_SFP_DOM_BATCH_PORTS_MAX];
+    /** Temperature in milli-degrees C. */
+    int32_t temp[ONLP_SFP_DOM_BATCH_PORTS_MAX];
+    /** Supply voltage in microvolts. */
+    int32_t vcc[ONLP_SFP_DOM_BATCH_PORTS_MAX];
+    /** TX bias current in microamps. */
+    int32_t bias[ONLP_SFP_DOM_BATCH_PORTS_MAX][ONLP_SFP_DOM_LANES_MAX];
+    /** TX output power in nanowatts. */
+    int32_t tx_power[ONLP_SFP_DOM_BATCH_PORTS_MAX][ONLP_SFP_DOM_LANES_MAX];
+    /** RX input power in nanowatts. */
+    int32_t rx_power[ONLP_SFP_DOM_BATCH_PORTS_MAX][ONLP_SFP_DOM_LANES_MAX];
+} onlp_sfp_dom_batch_t;
+
+/**
+ * @brief Read the diagnostic monitors for a set of ports.
+ * @param ports The ports to read. Invalid ports are ignored.
+ * @param fields The ONLP_SFP_DOM_F_* fields to read.
+ * @param flags ONLP_SFP_DOM_BATCH_F_* flags.
+ * @param [out] result Receives the results.
+ * @returns The number of ports read successfully, or <0 on error.
+ * @note Per-port failures are reported in result->status and do not
+ * fail the call.
+ */
+int onlp_sfp_dom_batch_read(onlp_sfp_bitmap_t* ports, uint32_t fields,
+                            uint32_t flags, onlp_sfp_dom_batch_t* result);
+
 /******************************************************************************
  *
  * Enumeration Support Definitions.
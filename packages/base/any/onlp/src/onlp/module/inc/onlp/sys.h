@@ -54,6 +54,8 @@ int onlp_sys_init(void);
 /**
  * @brief Get the system information structure.
  * @param rv [out] Receives the system information.
+ * @note The ONIE and platform information are served from a snapshot
+ * which is only refreshed by onlp_sys_info_invalidate().
  */
 int onlp_sys_info_get(onlp_sys_info_t* rv);
 
@@ -62,6 +64,19 @@ int onlp_sys_info_get(onlp_sys_info_t* rv);
  */
 void onlp_sys_info_free(onlp_sys_info_t* info);
 
+/**
+ * @brief Discard the system information snapshot.
+ * @note This must be called after the ONIE EEPROM has been written.
+ * The snapshots of all ONLP processes are discarded.
+ */
+void onlp_sys_info_invalidate(void);
+
+/**
+ * @brief Show the system information snapshot statistics.
+ * @param pvs The output pvs.
+ */
+void onlp_sys_info_cache_show(aim_pvs_t* pvs);
+
 /**
  * @brief Get the system header.
  */
@@ -84,6 +99,15 @@ void onlp_sys_dump(onlp_oid_t id, aim_pvs_t* pvs, uint32_t flags);
  */
 void onlp_sys_show(onlp_oid_t id, aim_pvs_t* pvs, uint32_t flags);
 
+/**
+ * @brief Get the system OIDs.
+ * @param table Receives the system OIDs. Unused entries are zero.
+ * @param max The number of entries in table.
+ * @note Unlike onlp_sys_info_get(), the table size is not limited
+ * to ONLP_OID_TABLE_SIZE.
+ */
+int onlp_sys_oids_get(onlp_oid_t* table, int max);
+
 /**
  * @brief SYS Ioctl
  * @param code The ioctl code.
@@ -122,6 +146,62 @@ int onlp_sys_platform_manage_join(void);
 
 void onlp_sys_platform_manage_now(void);
 
+/**
+ * @brief Platform management callback.
+ * @param cookie The cookie given at registration.
+ * @param [in,out] rate The current callback interval in microseconds.
+ * The callback may change it to set the interval until its next call.
+ * @returns <0 on error. Errors are counted in the statistics.
+ * @note Callbacks are called from the platform management thread
+ * without any ONLP locks held.
+ */
+typedef int (*onlp_sys_platform_manage_f)(void* cookie, uint64_t* rate);
+
+/**
+ * @brief Register a platform management callback.
+ * @param name The callback name (for statistics and debugging).
+ * @param handler The callback.
+ * @param cookie Passed to the callback.
+ * @param rate The initial callback interval in microseconds.
+ */
+int onlp_sys_platform_manage_register(const char* name,
+                                      onlp_sys_platform_manage_f handler,
+                                      void* cookie, uint64_t rate);
+
+/**
+ * @brief Unregister a platform management callback.
+ * @param handler The callback.
+ * @param cookie The cookie given at registration.
+ * @note This may be called from the callback itself.
+ */
+int onlp_sys_platform_manage_unregister(onlp_sys_platform_manage_f handler,
+                                        void* cookie);
+
+/**
+ * @brief Change the interval of a platform management callback.
+ * @param handler The callback.
+ * @param cookie The cookie given at registration.
+ * @param rate The new callback interval in microseconds.
+ * @note The new interval takes effect after the next call.
+ */
+int onlp_sys_platform_manage_rate_set(onlp_sys_platform_manage_f handler,
+                                      void* cookie, uint64_t rate);
+
+/**
+ * @brief Show the platform management callback statistics.
+ * @param pvs The output pvs.
+ */
+void onlp_sys_platform_manage_stats_show(aim_pvs_t* pvs);
+
 int onlp_sys_debug(aim_pvs_t* pvs, int argc, char** argv);
 
+/**
+ * @brief Run a file of platform debug commands.
+ * @param pvs The output pvs.
+ * @param path The script. One command per line, plus 'sleep <ms>'.
+ * Blank lines and lines starting with '#' are ignored.
+ * @note The API lock is taken for each command, not for the whole script.
+ */
+int onlp_sys_debug_script(aim_pvs_t* pvs, const char* path);
+
 #endif /* __ONLP_SYS_H_ */
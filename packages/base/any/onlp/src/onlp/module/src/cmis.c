@@ -0,0 +1,752 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * CMIS module bring-up engine.
+ *
+ ***********************************************************/
+#include <onlp/cmis.h>
+#include <onlp/sfp.h>
+#include <onlp/sys.h>
+#include <timer_wheel/timer_wheel.h>
+#include <OS/os_time.h>
+#include <AIM/aim.h>
+#include "onlp_log.h"
+#include "onlp_int.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+/*
+ * Lower page (00h).
+ */
+#define CMIS_ID                         0
+#define CMIS_REVISION                   1
+#define CMIS_MEMORY_MODEL               2
+#define CMIS_MEMORY_MODEL_FLAT          0x80
+#define CMIS_MODULE_STATE               3
+#define CMIS_GLOBAL_CONTROL             26
+#define CMIS_LOW_PWR_ALLOW_REQUEST_HW   0x40
+#define CMIS_LOW_PWR_REQUEST_SW         0x10
+#define CMIS_APP_ADVERTISING            86
+#define CMIS_APP_COUNT                  8
+#define CMIS_APP_END                    0xFF
+
+/*
+ * Page 01h. Advertised maximum durations (CMIS 5.0 and later).
+ */
+#define CMIS_PAGE_ADVERTISING           0x01
+#define CMIS_DP_DURATIONS               144
+#define CMIS_MODULE_DURATIONS           167
+
+/*
+ * Page 10h. Lane control (bank 0).
+ */
+#define CMIS_PAGE_CONTROL               0x10
+/* DataPathDeinit (CMIS 4.0 and later) or DataPathPwrUp (CMIS 3.0). */
+#define CMIS_DP_DEINIT                  128
+#define CMIS_OUTPUT_DISABLE_TX          130
+#define CMIS_APPLY_DP_INIT              143
+#define CMIS_DP_CONFIG                  145
+
+/*
+ * Page 11h. Lane status (bank 0). Four bits per lane, lane 1 first.
+ */
+#define CMIS_PAGE_STATUS                0x11
+#define CMIS_DP_STATE                   128
+#define CMIS_CONFIG_STATUS              202
+
+#define CMIS_MODULE_STATE_READY         3
+#define CMIS_MODULE_STATE_FAULT         5
+
+#define CMIS_DP_STATE_ACTIVATED         4
+
+#define CMIS_CONFIG_STATUS_UNDEFINED    0x0
+#define CMIS_CONFIG_STATUS_SUCCESS      0x1
+#define CMIS_CONFIG_STATUS_IN_PROGRESS  0xC
+
+#define CMIS_LANE_NIBBLE(_data, _lane) \
+    (((_data)[(_lane) / 2] >> (((_lane) & 1) * 4)) & 0xF)
+
+/** Wait limits (usecs) used when the module does not advertise its own. */
+#define CMIS_PWRUP_LIMIT_DEFAULT        (60*1000*1000ULL)
+#define CMIS_DPINIT_LIMIT_DEFAULT       (60*1000*1000ULL)
+#define CMIS_CONFIG_LIMIT               (2*1000*1000ULL)
+/** Advertised limits are never shorter than this. */
+#define CMIS_LIMIT_MIN                  (1*1000*1000ULL)
+
+/** Settle time after insertion before the module is accessed. */
+#define CMIS_INSERT_DELAY               (200*1000ULL)
+
+/** Consecutive access errors before a port is faulted. */
+#define CMIS_ERRORS_MAX                 3
+
+#define CMIS_POLL_US    (ONLP_CONFIG_CMIS_POLL_MS*1000ULL)
+#define CMIS_MONITOR_US (ONLP_CONFIG_CMIS_MONITOR_MS*1000ULL)
+
+typedef struct cmis_port_s {
+    /** Must be first. Timer wheel entries are cast back to ports. */
+    timer_wheel_entry_t twe;
+
+    int port;
+    onlp_cmis_port_config_t config;
+    onlp_cmis_port_status_t status;
+
+    /** The deadline (usecs) of the current wait. */
+    uint64_t timeout;
+
+    /** The module's power up and data path init limits (usecs). */
+    uint64_t pwrup_limit;
+    uint64_t dpinit_limit;
+
+    /** Consecutive access errors. */
+    int errors;
+} cmis_port_t;
+
+static struct {
+    /** Protects the timer wheel and the ports. Held while a step runs. */
+    pthread_mutex_t lock;
+    timer_wheel_t* tw;
+    cmis_port_t* ports[ONLP_CMIS_PORTS_MAX];
+} control__ = { PTHREAD_MUTEX_INITIALIZER };
+
+const char*
+onlp_cmis_state_name(onlp_cmis_state_t state)
+{
+    switch(state)
+        {
+        case ONLP_CMIS_STATE_DISABLED: return "disabled";
+        case ONLP_CMIS_STATE_ABSENT: return "absent";
+        case ONLP_CMIS_STATE_INSERTED: return "inserted";
+        case ONLP_CMIS_STATE_UNSUPPORTED: return "unsupported";
+        case ONLP_CMIS_STATE_MODULE_PWRUP: return "module-pwrup";
+        case ONLP_CMIS_STATE_APP_CONFIG: return "app-config";
+        case ONLP_CMIS_STATE_DP_INIT: return "dp-init";
+        case ONLP_CMIS_STATE_ACTIVE: return "active";
+        case ONLP_CMIS_STATE_FAULT: return "fault";
+        default: return "unknown";
+        }
+}
+
+static void
+cmis_state_set__(cmis_port_t* p, onlp_cmis_state_t state)
+{
+    AIM_LOG_VERBOSE("port %d: %s -> %s", p->port,
+                    onlp_cmis_state_name(p->status.state),
+                    onlp_cmis_state_name(state));
+    p->status.state = state;
+    p->status.state_time = os_time_monotonic();
+}
+
+static void
+cmis_fault__(cmis_port_t* p, const char* fmt, ...)
+{
+    va_list vargs;
+    va_start(vargs, fmt);
+    vsnprintf(p->status.error, sizeof(p->status.error), fmt, vargs);
+    va_end(vargs);
+
+    AIM_LOG_ERROR("port %d: CMIS bring-up failed: %s", p->port, p->status.error);
+    p->status.faults++;
+    cmis_state_set__(p, ONLP_CMIS_STATE_FAULT);
+}
+
+static int
+cmis_read__(cmis_port_t* p, int page, int offset, uint8_t* data, int size)
+{
+    int rv = onlp_sfp_memory_read(p->port, 0x50, page, offset, size, data);
+    return (rv < 0) ? rv : 0;
+}
+
+static int
+cmis_write__(cmis_port_t* p, int page, int offset, uint8_t* data, int size)
+{
+    int rv = onlp_sfp_memory_write(p->port, 0x50, page, offset, size, data);
+    return (rv < 0) ? rv : 0;
+}
+
+static int
+cmis_writeb__(cmis_port_t* p, int page, int offset, uint8_t value)
+{
+    return cmis_write__(p, page, offset, &value, 1);
+}
+
+static int
+cmis_identifier__(uint8_t id)
+{
+    switch(id)
+        {
+        case 0x18: /* QSFP-DD */
+        case 0x19: /* OSFP */
+        case 0x1E: /* QSFP+ or later with CMIS */
+            return 1;
+        default:
+            return 0;
+        }
+}
+
+/**
+ * Decode an advertised maximum duration (CMIS 5.0 Table 8-29).
+ */
+static uint64_t
+cmis_duration__(uint8_t code)
+{
+    static const uint32_t ms[] = {
+        1, 5, 10, 50, 100, 500, 1000, 5000, 10000, 60000,
+        300000, 600000, 3000000,
+    };
+    uint64_t us = (code < AIM_ARRAYSIZE(ms)) ? ms[code] * 1000ULL : 3600000000ULL;
+    return (us < CMIS_LIMIT_MIN) ? CMIS_LIMIT_MIN : us;
+}
+
+/**
+ * The DataPathDeinit value which keeps every lane except
+ * the given ones down. CMIS 3.0 has DataPathPwrUp instead.
+ */
+static uint8_t
+cmis_dp_deinit__(cmis_port_t* p, uint8_t lanes)
+{
+    return (p->status.revision >= 0x40) ? (uint8_t)~lanes : lanes;
+}
+
+static int
+cmis_inserted__(cmis_port_t* p, uint64_t now)
+{
+    int rv;
+    uint8_t id[4];
+    uint8_t control;
+    onlp_cmis_port_status_t* s = &p->status;
+
+    if( (rv = cmis_read__(p, 0, CMIS_ID, id, sizeof(id))) < 0) {
+        return rv;
+    }
+
+    s->identifier = id[CMIS_ID];
+    s->revision = id[CMIS_REVISION];
+    s->flat = !!(id[CMIS_MEMORY_MODEL] & CMIS_MEMORY_MODEL_FLAT);
+    s->appsel = 0;
+    s->host_lanes = 0;
+    s->host_interface = 0;
+    s->media_interface = 0;
+    s->error[0] = 0;
+
+    if(!cmis_identifier__(s->identifier) || s->revision < 0x30) {
+        cmis_state_set__(p, ONLP_CMIS_STATE_UNSUPPORTED);
+        return 0;
+    }
+
+    if(s->flat) {
+        /* Passive copper. There are no data paths to bring up. */
+        s->pwrup_time = s->config_time = s->dpinit_time = 0;
+        s->total_time = now - s->inserted;
+        s->bringups++;
+        cmis_state_set__(p, ONLP_CMIS_STATE_ACTIVE);
+        return 0;
+    }
+
+    p->pwrup_limit = CMIS_PWRUP_LIMIT_DEFAULT;
+    p->dpinit_limit = CMIS_DPINIT_LIMIT_DEFAULT;
+    if(s->revision >= 0x50) {
+        uint8_t d;
+        if(cmis_read__(p, CMIS_PAGE_ADVERTISING, CMIS_MODULE_DURATIONS, &d, 1) == 0) {
+            p->pwrup_limit = cmis_duration__(d & 0xF);
+        }
+        if(cmis_read__(p, CMIS_PAGE_ADVERTISING, CMIS_DP_DURATIONS, &d, 1) == 0) {
+            p->dpinit_limit = cmis_duration__(d & 0xF);
+        }
+    }
+
+    /* Keep every data path down until the application has been selected. */
+    if( (rv = cmis_writeb__(p, CMIS_PAGE_CONTROL, CMIS_DP_DEINIT,
+                            cmis_dp_deinit__(p, 0))) < 0) {
+        return rv;
+    }
+
+    /* Leave low power. */
+    if( (rv = cmis_read__(p, 0, CMIS_GLOBAL_CONTROL, &control, 1)) < 0) {
+        return rv;
+    }
+    control &= ~(CMIS_LOW_PWR_ALLOW_REQUEST_HW | CMIS_LOW_PWR_REQUEST_SW);
+    if( (rv = cmis_writeb__(p, 0, CMIS_GLOBAL_CONTROL, control)) < 0) {
+        return rv;
+    }
+    /* Not all platforms control the LPMode signal. */
+    onlp_sfp_control_set(p->port, ONLP_SFP_CONTROL_LP_MODE, 0);
+
+    p->timeout = now + p->pwrup_limit;
+    cmis_state_set__(p, ONLP_CMIS_STATE_MODULE_PWRUP);
+    return 0;
+}
+
+/**
+ * Stage the application in control set 0 and apply it.
+ */
+static int
+cmis_app_select__(cmis_port_t* p, uint64_t now)
+{
+    int rv;
+    int lane;
+    int count;
+    uint8_t* app;
+    uint8_t lanes = 0;
+    uint8_t apps[CMIS_APP_COUNT*4];
+    uint8_t dpconfig[ONLP_CMIS_LANES_MAX] = { 0 };
+    int appsel = (p->config.appsel) ? p->config.appsel : 1;
+
+    if( (rv = cmis_read__(p, 0, CMIS_APP_ADVERTISING, apps, sizeof(apps))) < 0) {
+        return rv;
+    }
+
+    app = apps + (appsel - 1) * 4;
+    if(appsel < 1 || appsel > CMIS_APP_COUNT ||
+       app[0] == CMIS_APP_END || app[0] == 0) {
+        cmis_fault__(p, "application %d is not advertised", appsel);
+        return 0;
+    }
+
+    /*
+     * One data path per allowed start lane, each using the
+     * application's host lane count.
+     */
+    count = app[2] >> 4;
+    if(count == 0 || count > ONLP_CMIS_LANES_MAX) {
+        cmis_fault__(p, "application %d has %d host lanes", appsel, count);
+        return 0;
+    }
+    for(lane = 0; lane + count <= ONLP_CMIS_LANES_MAX; lane += count) {
+        int i;
+        uint8_t group = ((1 << count) - 1) << lane;
+        if(!(app[3] & (1 << lane))) {
+            continue;
+        }
+        if(p->config.host_lanes && (p->config.host_lanes & group) != group) {
+            continue;
+        }
+        lanes |= group;
+        for(i = lane; i < lane + count; i++) {
+            dpconfig[i] = (appsel << 4) | (lane << 1);
+        }
+    }
+    if(lanes == 0) {
+        cmis_fault__(p, "no host lanes for application %d", appsel);
+        return 0;
+    }
+
+    if( (rv = cmis_write__(p, CMIS_PAGE_CONTROL, CMIS_DP_CONFIG,
+                           dpconfig, sizeof(dpconfig))) < 0) {
+        return rv;
+    }
+    if( (rv = cmis_writeb__(p, CMIS_PAGE_CONTROL, CMIS_APPLY_DP_INIT, lanes)) < 0) {
+        return rv;
+    }
+
+    p->status.appsel = appsel;
+    p->status.host_interface = app[0];
+    p->status.media_interface = app[1];
+    p->status.host_lanes = lanes;
+    p->timeout = now + CMIS_CONFIG_LIMIT;
+    cmis_state_set__(p, ONLP_CMIS_STATE_APP_CONFIG);
+    return 0;
+}
+
+static int
+cmis_module_pwrup__(cmis_port_t* p, uint64_t now)
+{
+    int rv;
+    uint8_t state;
+
+    if( (rv = cmis_read__(p, 0, CMIS_MODULE_STATE, &state, 1)) < 0) {
+        return rv;
+    }
+
+    switch((state >> 1) & 0x7)
+        {
+        case CMIS_MODULE_STATE_READY:
+            p->status.pwrup_time = now - p->status.state_time;
+            return cmis_app_select__(p, now);
+        case CMIS_MODULE_STATE_FAULT:
+            cmis_fault__(p, "module fault");
+            return 0;
+        default:
+            if(now > p->timeout) {
+                cmis_fault__(p, "module power up timed out");
+            }
+            return 0;
+        }
+}
+
+static int
+cmis_app_config__(cmis_port_t* p, uint64_t now)
+{
+    int rv;
+    int lane;
+    int done = 1;
+    uint8_t status[ONLP_CMIS_LANES_MAX/2];
+    uint8_t lanes = p->status.host_lanes;
+
+    if( (rv = cmis_read__(p, CMIS_PAGE_STATUS, CMIS_CONFIG_STATUS,
+                          status, sizeof(status))) < 0) {
+        return rv;
+    }
+
+    for(lane = 0; lane < ONLP_CMIS_LANES_MAX; lane++) {
+        int cs = CMIS_LANE_NIBBLE(status, lane);
+        if(!(lanes & (1 << lane)) || cs == CMIS_CONFIG_STATUS_SUCCESS) {
+            continue;
+        }
+        if(cs == CMIS_CONFIG_STATUS_UNDEFINED ||
+           cs == CMIS_CONFIG_STATUS_IN_PROGRESS) {
+            done = 0;
+            continue;
+        }
+        cmis_fault__(p, "lane %d configuration rejected (0x%x)", lane + 1, cs);
+        return 0;
+    }
+
+    if(!done) {
+        if(now > p->timeout) {
+            cmis_fault__(p, "application configuration timed out");
+        }
+        return 0;
+    }
+
+    p->status.config_time = now - p->status.state_time;
+
+    /* Activate the data paths with the transmitters off. */
+    if( (rv = cmis_writeb__(p, CMIS_PAGE_CONTROL, CMIS_OUTPUT_DISABLE_TX, 0xFF)) < 0 ||
+        (rv = cmis_writeb__(p, CMIS_PAGE_CONTROL, CMIS_DP_DEINIT,
+                            cmis_dp_deinit__(p, lanes))) < 0) {
+        return rv;
+    }
+
+    p->timeout = now + p->dpinit_limit;
+    cmis_state_set__(p, ONLP_CMIS_STATE_DP_INIT);
+    return 0;
+}
+
+static int
+cmis_dp_init__(cmis_port_t* p, uint64_t now)
+{
+    int rv;
+    int lane;
+    uint8_t state[ONLP_CMIS_LANES_MAX/2];
+    uint8_t lanes = p->status.host_lanes;
+    onlp_cmis_port_status_t* s = &p->status;
+
+    if( (rv = cmis_read__(p, CMIS_PAGE_STATUS, CMIS_DP_STATE,
+                          state, sizeof(state))) < 0) {
+        return rv;
+    }
+
+    for(lane = 0; lane < ONLP_CMIS_LANES_MAX; lane++) {
+        if((lanes & (1 << lane)) &&
+           CMIS_LANE_NIBBLE(state, lane) != CMIS_DP_STATE_ACTIVATED) {
+            if(now > p->timeout) {
+                cmis_fault__(p, "data path activation timed out (lane %d)", lane + 1);
+            }
+            return 0;
+        }
+    }
+
+    if( (rv = cmis_writeb__(p, CMIS_PAGE_CONTROL, CMIS_OUTPUT_DISABLE_TX,
+                            (uint8_t)~lanes)) < 0) {
+        return rv;
+    }
+
+    s->dpinit_time = now - s->state_time;
+    s->total_time = now - s->inserted;
+    s->bringups++;
+    AIM_LOG_INFO("port %d: CMIS application %d active on lanes 0x%.2x in %llu ms",
+                 p->port, s->appsel, lanes,
+                 (unsigned long long)(s->total_time / 1000));
+    cmis_state_set__(p, ONLP_CMIS_STATE_ACTIVE);
+    return 0;
+}
+
+static int
+cmis_active__(cmis_port_t* p, uint64_t now)
+{
+    int rv;
+    uint8_t state;
+
+    if( (rv = cmis_read__(p, 0, CMIS_MODULE_STATE, &state, 1)) < 0) {
+        return rv;
+    }
+
+    switch((state >> 1) & 0x7)
+        {
+        case CMIS_MODULE_STATE_READY:
+            break;
+        case CMIS_MODULE_STATE_FAULT:
+            cmis_fault__(p, "module fault");
+            break;
+        default:
+            /* The module was reset or returned to low power. */
+            AIM_LOG_INFO("port %d: CMIS module left the ready state.", p->port);
+            p->status.inserted = now;
+            cmis_state_set__(p, ONLP_CMIS_STATE_INSERTED);
+            break;
+        }
+    return 0;
+}
+
+/**
+ * Run one step for the port.
+ * Returns the delay (usecs) until the next step.
+ */
+static uint64_t
+cmis_step__(cmis_port_t* p)
+{
+    int rv = 0;
+    uint64_t now = os_time_monotonic();
+
+    switch(p->status.state)
+        {
+        case ONLP_CMIS_STATE_ABSENT:
+            if(onlp_sfp_is_present(p->port) == 1) {
+                p->status.inserted = now;
+                p->errors = 0;
+                cmis_state_set__(p, ONLP_CMIS_STATE_INSERTED);
+                return CMIS_INSERT_DELAY;
+            }
+            return CMIS_MONITOR_US;
+
+        case ONLP_CMIS_STATE_UNSUPPORTED:
+        case ONLP_CMIS_STATE_FAULT:
+            if(onlp_sfp_is_present(p->port) == 0) {
+                cmis_state_set__(p, ONLP_CMIS_STATE_ABSENT);
+            }
+            return CMIS_MONITOR_US;
+
+        case ONLP_CMIS_STATE_INSERTED: rv = cmis_inserted__(p, now); break;
+        case ONLP_CMIS_STATE_MODULE_PWRUP: rv = cmis_module_pwrup__(p, now); break;
+        case ONLP_CMIS_STATE_APP_CONFIG: rv = cmis_app_config__(p, now); break;
+        case ONLP_CMIS_STATE_DP_INIT: rv = cmis_dp_init__(p, now); break;
+        case ONLP_CMIS_STATE_ACTIVE: rv = cmis_active__(p, now); break;
+        default: return CMIS_MONITOR_US;
+        }
+
+    if(rv < 0) {
+        if(onlp_sfp_is_present(p->port) == 0) {
+            cmis_state_set__(p, ONLP_CMIS_STATE_ABSENT);
+        }
+        else if(++p->errors >= CMIS_ERRORS_MAX) {
+            cmis_fault__(p, "module access failed: %s", onlp_status_name(rv));
+        }
+    }
+    else {
+        p->errors = 0;
+    }
+
+    switch(p->status.state)
+        {
+        case ONLP_CMIS_STATE_ABSENT:
+        case ONLP_CMIS_STATE_UNSUPPORTED:
+        case ONLP_CMIS_STATE_FAULT:
+        case ONLP_CMIS_STATE_ACTIVE:
+            return CMIS_MONITOR_US;
+        default:
+            return CMIS_POLL_US;
+        }
+}
+
+/**
+ * Reschedule a port from the absent state.
+ */
+static void
+cmis_port_reset__(cmis_port_t* p)
+{
+    timer_wheel_remove(control__.tw, &p->twe);
+    p->errors = 0;
+    p->status.error[0] = 0;
+    cmis_state_set__(p, ONLP_CMIS_STATE_ABSENT);
+    timer_wheel_insert(control__.tw, &p->twe, os_time_monotonic());
+}
+
+int
+onlp_cmis_port_enable(int port, const onlp_cmis_port_config_t* config)
+{
+    cmis_port_t* p;
+
+    if(port < 0 || port >= ONLP_CMIS_PORTS_MAX || !onlp_sfp_port_valid(port)) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&control__.lock);
+    if(control__.tw == NULL) {
+        control__.tw = timer_wheel_create(4, 512, os_time_monotonic());
+    }
+    if( (p = control__.ports[port]) == NULL) {
+        p = aim_zmalloc(sizeof(*p));
+        p->port = port;
+        control__.ports[port] = p;
+        /* cmis_port_reset__() expects the port to be on the wheel. */
+        timer_wheel_insert(control__.tw, &p->twe, os_time_monotonic());
+    }
+
+    if(config) {
+        p->config = *config;
+    }
+    else {
+        memset(&p->config, 0, sizeof(p->config));
+    }
+    cmis_port_reset__(p);
+    pthread_mutex_unlock(&control__.lock);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_cmis_port_disable(int port)
+{
+    cmis_port_t* p;
+
+    if(port < 0 || port >= ONLP_CMIS_PORTS_MAX) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&control__.lock);
+    if( (p = control__.ports[port]) ) {
+        timer_wheel_remove(control__.tw, &p->twe);
+        control__.ports[port] = NULL;
+        aim_free(p);
+    }
+    pthread_mutex_unlock(&control__.lock);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_cmis_port_restart(int port)
+{
+    int rv = ONLP_STATUS_E_PARAM;
+
+    if(port < 0 || port >= ONLP_CMIS_PORTS_MAX) {
+        return rv;
+    }
+
+    pthread_mutex_lock(&control__.lock);
+    if(control__.ports[port]) {
+        cmis_port_reset__(control__.ports[port]);
+        rv = ONLP_STATUS_OK;
+    }
+    pthread_mutex_unlock(&control__.lock);
+    return rv;
+}
+
+int
+onlp_cmis_port_status_get(int port, onlp_cmis_port_status_t* status)
+{
+    if(port < 0 || port >= ONLP_CMIS_PORTS_MAX || status == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&control__.lock);
+    if(control__.ports[port]) {
+        *status = control__.ports[port]->status;
+    }
+    else {
+        memset(status, 0, sizeof(*status));
+        status->state = ONLP_CMIS_STATE_DISABLED;
+    }
+    pthread_mutex_unlock(&control__.lock);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_cmis_poll(uint64_t* next)
+{
+    int steps = 0;
+    uint64_t now = os_time_monotonic();
+    timer_wheel_entry_t* twe;
+
+    pthread_mutex_lock(&control__.lock);
+    while(control__.tw && (twe = timer_wheel_next(control__.tw, now))) {
+        cmis_port_t* p = (cmis_port_t*)twe;
+        uint64_t delay = cmis_step__(p);
+        timer_wheel_insert(control__.tw, &p->twe, os_time_monotonic() + delay);
+        steps++;
+
+        /* Let status readers in between steps. */
+        pthread_mutex_unlock(&control__.lock);
+        pthread_mutex_lock(&control__.lock);
+    }
+
+    if(next) {
+        *next = CMIS_MONITOR_US;
+        if(control__.tw) {
+            now = os_time_monotonic();
+            twe = timer_wheel_peek(control__.tw, now + CMIS_MONITOR_US);
+            if(twe) {
+                *next = (twe->deadline > now) ? twe->deadline - now : 0;
+            }
+        }
+    }
+    pthread_mutex_unlock(&control__.lock);
+    return steps;
+}
+
+static int
+cmis_manage__(void* cookie, uint64_t* rate)
+{
+    onlp_cmis_poll(rate);
+    return 0;
+}
+
+int
+onlp_cmis_start(void)
+{
+    return onlp_sys_platform_manage_register("CMIS", cmis_manage__, NULL,
+                                             CMIS_POLL_US);
+}
+
+int
+onlp_cmis_stop(void)
+{
+    return onlp_sys_platform_manage_unregister(cmis_manage__, NULL);
+}
+
+void
+onlp_cmis_show(aim_pvs_t* pvs)
+{
+    int port;
+
+    aim_printf(pvs, "%-5s %-13s %4s %4s %4s %6s %10s %10s %10s %10s %8s %6s %s\n",
+               "Port", "State", "Id", "Rev", "App", "Lanes",
+               "PwrUp(ms)", "Config(ms)", "DPInit(ms)", "Total(ms)",
+               "Bringups", "Faults", "Error");
+
+    pthread_mutex_lock(&control__.lock);
+    for(port = 0; port < ONLP_CMIS_PORTS_MAX; port++) {
+        onlp_cmis_port_status_t* s;
+        if(control__.ports[port] == NULL) {
+            continue;
+        }
+        s = &control__.ports[port]->status;
+        aim_printf(pvs, "%-5d %-13s 0x%.2x %d.%d %4d   0x%.2x %10llu %10llu %10llu %10llu %8d %6d %s\n",
+                   port, onlp_cmis_state_name(s->state),
+                   s->identifier, s->revision >> 4, s->revision & 0xF,
+                   s->appsel, s->host_lanes,
+                   (unsigned long long)(s->pwrup_time / 1000),
+                   (unsigned long long)(s->config_time / 1000),
+                   (unsigned long long)(s->dpinit_time / 1000),
+                   (unsigned long long)(s->total_time / 1000),
+                   s->bringups, s->faults, s->error);
+    }
+    pthread_mutex_unlock(&control__.lock);
+}
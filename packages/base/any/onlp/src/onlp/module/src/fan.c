@@ -26,9 +26,11 @@
 #include <onlp/platformi/fani.h>
 #include <onlp/oids.h>
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_FAN
 #include "onlp_locks.h"
 #include "onlp_log.h"
 #include "onlp_json.h"
+#include "onlp_cache.h"
 
 #define VALIDATE(_id)                           \
     do {                                        \
@@ -52,6 +54,21 @@ onlp_fan_init_locked__(void)
 }
 ONLP_LOCKED_API0(onlp_fan_init)
 
+static int
+onlp_fani_info_get_cached__(onlp_oid_t oid, onlp_fan_info_t* fip)
+{
+    int rv;
+
+    if(ONLP_CACHE_GET(oid, fip)) {
+        return ONLP_STATUS_OK;
+    }
+    rv = onlp_fani_info_get(oid, fip);
+    if(ONLP_SUCCESS(rv)) {
+        ONLP_CACHE_SET(oid, fip);
+    }
+    return rv;
+}
+
 
 #if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
 
@@ -92,7 +109,7 @@ onlp_fan_info_get_locked__(onlp_oid_t oid, onlp_fan_info_t* fip)
     VALIDATE(oid);
 
     /* Get the information struct from the platform */
-    rv = onlp_fani_info_get(oid, fip);
+    rv = onlp_fani_info_get_cached__(oid, fip);
 
     if(rv >= 0) {
 
@@ -117,7 +134,7 @@ onlp_fan_info_get_locked__(onlp_oid_t oid, onlp_fan_info_t* fip)
 
     return rv;
 }
-ONLP_LOCKED_API2(onlp_fan_info_get, onlp_oid_t, oid, onlp_fan_info_t*, fip);
+ONLP_LOCKED_RAPI2(onlp_fan_info_get, onlp_oid_t, oid, onlp_fan_info_t*, fip);
 
 static int
 onlp_fan_status_get_locked__(onlp_oid_t oid, uint32_t* status)
@@ -128,12 +145,12 @@ onlp_fan_status_get_locked__(onlp_oid_t oid, uint32_t* status)
     }
     if(ONLP_UNSUPPORTED(rv)) {
         onlp_fan_info_t fi;
-        rv = onlp_fani_info_get(oid, &fi);
+        rv = onlp_fani_info_get_cached__(oid, &fi);
         *status = fi.status;
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_fan_status_get, onlp_oid_t, oid, uint32_t*, status);
+ONLP_LOCKED_RAPI2(onlp_fan_status_get, onlp_oid_t, oid, uint32_t*, status);
 
 static int
 onlp_fan_hdr_get_locked__(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
@@ -144,12 +161,12 @@ onlp_fan_hdr_get_locked__(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
     }
     if(ONLP_UNSUPPORTED(rv)) {
         onlp_fan_info_t fi;
-        rv = onlp_fani_info_get(oid, &fi);
+        rv = onlp_fani_info_get_cached__(oid, &fi);
         memcpy(hdr, &fi.hdr, sizeof(fi.hdr));
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_fan_hdr_get, onlp_oid_t, oid, onlp_oid_hdr_t*, hdr);
+ONLP_LOCKED_RAPI2(onlp_fan_hdr_get, onlp_oid_t, oid, onlp_oid_hdr_t*, hdr);
 
 static int
 onlp_fan_present__(onlp_oid_t id, onlp_fan_info_t* info)
@@ -158,7 +175,7 @@ onlp_fan_present__(onlp_oid_t id, onlp_fan_info_t* info)
     VALIDATE(id);
 
     /* Info retrieval required. */
-    rv = onlp_fani_info_get(id, info);
+    rv = onlp_fani_info_get_cached__(id, info);
     if(rv < 0) {
         return rv;
     }
@@ -183,6 +200,7 @@ onlp_fan_rpm_set_locked__(onlp_oid_t id, int rpm)
     onlp_fan_info_t info;
     ONLP_FAN_PRESENT_OR_RETURN(id, &info);
     if(info.caps & ONLP_FAN_CAPS_SET_RPM) {
+        ONLP_CACHE_INVALIDATE(id);
         return onlp_fani_rpm_set(id, rpm);
     }
     else {
@@ -197,6 +215,7 @@ onlp_fan_percentage_set_locked__(onlp_oid_t id, int p)
     onlp_fan_info_t info;
     ONLP_FAN_PRESENT_OR_RETURN(id, &info);
     if(info.caps & ONLP_FAN_CAPS_SET_PERCENTAGE) {
+        ONLP_CACHE_INVALIDATE(id);
         return onlp_fani_percentage_set(id, p);
     }
     else {
@@ -210,6 +229,7 @@ onlp_fan_mode_set_locked__(onlp_oid_t id, onlp_fan_mode_t mode)
 {
     onlp_fan_info_t info;
     ONLP_FAN_PRESENT_OR_RETURN(id, &info);
+    ONLP_CACHE_INVALIDATE(id);
     return onlp_fani_mode_set(id, mode);
 }
 ONLP_LOCKED_API2(onlp_fan_mode_set, onlp_oid_t, id, onlp_fan_mode_t, mode);
@@ -221,6 +241,7 @@ onlp_fan_dir_set_locked__(onlp_oid_t id, onlp_fan_dir_t dir)
     ONLP_FAN_PRESENT_OR_RETURN(id, &info);
     if( (info.caps & ONLP_FAN_CAPS_B2F) &&
         (info.caps & ONLP_FAN_CAPS_F2B) ) {
+        ONLP_CACHE_INVALIDATE(id);
         return onlp_fani_dir_set(id, dir);
     }
     else {
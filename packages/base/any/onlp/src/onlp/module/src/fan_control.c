@@ -0,0 +1,870 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Policy driven thermal and fan control.
+ *
+ ***********************************************************/
+#include <onlp/fan_control.h>
+#include <onlp/fan.h>
+#include <onlp/thermal.h>
+#include <onlp/platformi/fani.h>
+#include <onlp/platformi/thermali.h>
+#include <cjson_util/cjson_util.h>
+#include <OS/os_time.h>
+#include <AIM/aim.h>
+#include "onlp_log.h"
+#include "onlp_int.h"
+#include <ctype.h>
+#include <limits.h>
+
+static const char*
+airflow_name__(onlp_fan_control_airflow_t airflow)
+{
+    switch(airflow)
+        {
+        case ONLP_FAN_CONTROL_AIRFLOW_F2B: return "f2b";
+        case ONLP_FAN_CONTROL_AIRFLOW_B2F: return "b2f";
+        default: return "any";
+        }
+}
+
+static const char*
+alarm_name__(onlp_fan_control_alarm_t alarm)
+{
+    switch(alarm)
+        {
+        case ONLP_FAN_CONTROL_ALARM_WARNING: return "warning";
+        case ONLP_FAN_CONTROL_ALARM_CRITICAL: return "critical";
+        default: return "none";
+        }
+}
+
+static const char*
+reason_name__(onlp_fan_control_reason_t reason)
+{
+    switch(reason)
+        {
+        case ONLP_FAN_CONTROL_REASON_FAN_FAILURE: return "fan-failure";
+        case ONLP_FAN_CONTROL_REASON_SENSOR_FAILURE: return "sensor-failure";
+        default: return "thermal";
+        }
+}
+
+static int
+thermal_index__(onlp_oid_t* table, int count, onlp_oid_t oid)
+{
+    int i;
+    for(i = 0; i < count; i++) {
+        if(table[i] == oid) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int
+onlp_fan_control_init(onlp_fan_control_t* fc,
+                      const onlp_fan_control_policy_t* policy)
+{
+    int g, t;
+
+    memset(fc, 0, sizeof(*fc));
+    fc->policy = policy;
+    fc->last_duty = -1;
+
+    if(policy->group_count > ONLP_FAN_CONTROL_GROUPS_MAX) {
+        AIM_LOG_ERROR("fan control policy %s: too many groups (%d)",
+                      policy->name, policy->group_count);
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    /* Each thermal is read once per cycle, however many groups use it. */
+    for(g = 0; g < policy->group_count; g++) {
+        const onlp_fan_control_group_t* grp = policy->groups + g;
+        if(grp->level_count <= 0 || grp->level_count > ONLP_FAN_CONTROL_LEVELS_MAX) {
+            AIM_LOG_ERROR("fan control policy %s: group %s has %d levels",
+                          policy->name, grp->name, grp->level_count);
+            return ONLP_STATUS_E_PARAM;
+        }
+        for(t = 0; t < ONLP_FAN_CONTROL_GROUP_THERMALS_MAX && grp->thermals[t]; t++) {
+            if(thermal_index__(fc->thermals, fc->thermal_count, grp->thermals[t]) >= 0) {
+                continue;
+            }
+            if(fc->thermal_count >= ONLP_FAN_CONTROL_THERMALS_MAX) {
+                AIM_LOG_ERROR("fan control policy %s: too many thermals",
+                              policy->name);
+                return ONLP_STATUS_E_PARAM;
+            }
+            fc->thermals[fc->thermal_count++] = grp->thermals[t];
+        }
+    }
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_fan_control_snapshot(onlp_fan_control_t* fc,
+                          onlp_fan_control_snapshot_t* snap)
+{
+    int i;
+    const onlp_fan_control_policy_t* policy = fc->policy;
+
+    memset(snap, 0, sizeof(*snap));
+    snap->time = os_time_monotonic();
+    snap->duty = -1;
+
+    snap->thermal_count = fc->thermal_count;
+    for(i = 0; i < fc->thermal_count; i++) {
+        onlp_thermal_info_t ti;
+        snap->thermals[i] = fc->thermals[i];
+        if(onlp_thermali_info_get(fc->thermals[i], &ti) == ONLP_STATUS_OK) {
+            snap->mcelsius[i] = ti.mcelsius;
+            snap->thermal_ok[i] = 1;
+        }
+        else {
+            fc->read_errors++;
+        }
+    }
+
+    for(i = 0; i < ONLP_FAN_CONTROL_FANS_MAX && policy->fans[i]; i++) {
+        onlp_fan_info_t fi;
+        snap->fans[i] = policy->fans[i];
+        if(onlp_fani_info_get(policy->fans[i], &fi) == ONLP_STATUS_OK) {
+            snap->fan_status[i] = fi.status;
+            if(snap->duty < 0 && policy->fans[i] == policy->duty_fans[0] &&
+               fc->duty_get == NULL) {
+                snap->duty = fi.percentage;
+            }
+        }
+        else {
+            fc->read_errors++;
+        }
+        snap->fan_count++;
+    }
+
+    if(fc->duty_get) {
+        if(fc->duty_get(fc, &snap->duty) < 0) {
+            snap->duty = -1;
+            fc->read_errors++;
+        }
+    }
+    else if(snap->duty < 0 && policy->duty_fans[0]) {
+        onlp_fan_info_t fi;
+        if(onlp_fani_info_get(policy->duty_fans[0], &fi) == ONLP_STATUS_OK) {
+            snap->duty = fi.percentage;
+        }
+    }
+
+    return ONLP_STATUS_OK;
+}
+
+/**
+ * Aggregate a group's thermals.
+ * Returns 0 if any of them could not be read.
+ */
+static int
+group_mcelsius__(const onlp_fan_control_group_t* grp,
+                 const onlp_fan_control_snapshot_t* snap, int* mc)
+{
+    int t, idx;
+    int count = 0;
+    int64_t sum = 0;
+    int max = INT_MIN;
+
+    for(t = 0; t < ONLP_FAN_CONTROL_GROUP_THERMALS_MAX && grp->thermals[t]; t++) {
+        idx = thermal_index__((onlp_oid_t*)snap->thermals, snap->thermal_count,
+                              grp->thermals[t]);
+        if(idx < 0 || !snap->thermal_ok[idx]) {
+            return 0;
+        }
+        sum += snap->mcelsius[idx];
+        if(snap->mcelsius[idx] > max) {
+            max = snap->mcelsius[idx];
+        }
+        count++;
+    }
+
+    if(count == 0) {
+        return 0;
+    }
+
+    *mc = (grp->aggregate == ONLP_FAN_CONTROL_AGGREGATE_AVG) ? (int)(sum / count) : max;
+    return 1;
+}
+
+static int
+group_pid__(onlp_fan_control_t* fc, int g, const onlp_fan_control_group_t* grp,
+            int mc, int base, int duty_max, uint64_t now)
+{
+    const onlp_fan_control_pid_t* pid = &grp->pid;
+    int64_t dt_ms = 0;
+    int64_t integral;
+    int64_t out;
+    int err;
+
+    if(pid->kp == 0 && pid->ki == 0 && pid->kd == 0) {
+        return base;
+    }
+
+    if(fc->last_time && now > fc->last_time) {
+        dt_ms = (now - fc->last_time) / 1000;
+    }
+
+    err = mc - pid->setpoint_mc;
+    integral = fc->integral[g] + (int64_t)err * dt_ms;
+
+    out = base;
+    out += (int64_t)pid->kp * err / 1000000;
+    out += (int64_t)pid->ki * integral / 1000000000;
+    if(dt_ms) {
+        out += (int64_t)pid->kd * (err - fc->last_error[g]) / (dt_ms * 1000);
+    }
+
+    /* Anti-windup: stop integrating while the output is saturated. */
+    if(!((out > duty_max && err > 0) || (out < base && err < 0))) {
+        fc->integral[g] = integral;
+    }
+    fc->last_error[g] = err;
+
+    if(out > duty_max) {
+        out = duty_max;
+    }
+    if(out < base) {
+        out = base;
+    }
+    return (int)out;
+}
+
+static onlp_fan_control_alarm_t
+group_alarm__(onlp_fan_control_t* fc, const onlp_fan_control_group_t* grp, int mc)
+{
+    int hyst = grp->alarm_hysteresis_mc;
+
+    if(grp->critical_mc) {
+        if(mc > grp->critical_mc) {
+            return ONLP_FAN_CONTROL_ALARM_CRITICAL;
+        }
+        if(fc->alarm == ONLP_FAN_CONTROL_ALARM_CRITICAL && mc >= grp->critical_mc - hyst) {
+            return ONLP_FAN_CONTROL_ALARM_CRITICAL;
+        }
+    }
+    if(grp->warning_mc) {
+        if(mc > grp->warning_mc) {
+            return ONLP_FAN_CONTROL_ALARM_WARNING;
+        }
+        if(fc->alarm != ONLP_FAN_CONTROL_ALARM_NONE && mc >= grp->warning_mc - hyst) {
+            return ONLP_FAN_CONTROL_ALARM_WARNING;
+        }
+    }
+    return ONLP_FAN_CONTROL_ALARM_NONE;
+}
+
+int
+onlp_fan_control_decide(onlp_fan_control_t* fc,
+                        const onlp_fan_control_snapshot_t* snap,
+                        onlp_fan_control_decision_t* d)
+{
+    int i, g;
+    const onlp_fan_control_policy_t* policy = fc->policy;
+    int duty_max = policy->duty_max ? policy->duty_max : 100;
+    int fan_failed = 0;
+    int sensor_failed = 0;
+    onlp_fan_control_alarm_t alarm = ONLP_FAN_CONTROL_ALARM_NONE;
+
+    memset(d, 0, sizeof(*d));
+    d->reason = ONLP_FAN_CONTROL_REASON_THERMAL;
+
+    /* Airflow: configured, or detected from the first fan reporting it. */
+    d->airflow = fc->airflow;
+    for(i = 0; i < snap->fan_count; i++) {
+        uint32_t status = snap->fan_status[i];
+        if(d->airflow == ONLP_FAN_CONTROL_AIRFLOW_ANY) {
+            if(status & ONLP_FAN_STATUS_F2B) {
+                d->airflow = ONLP_FAN_CONTROL_AIRFLOW_F2B;
+            }
+            else if(status & ONLP_FAN_STATUS_B2F) {
+                d->airflow = ONLP_FAN_CONTROL_AIRFLOW_B2F;
+            }
+        }
+        if(!(status & ONLP_FAN_STATUS_PRESENT) || (status & ONLP_FAN_STATUS_FAILED)) {
+            fan_failed = 1;
+        }
+    }
+
+    for(g = 0; g < policy->group_count; g++) {
+        const onlp_fan_control_group_t* grp = policy->groups + g;
+        int mc = 0;
+        int level;
+        onlp_fan_control_alarm_t ga;
+
+        d->group_level[g] = -1;
+
+        /*
+         * Groups for the other airflow do not apply. If the airflow
+         * is unknown every group applies and the highest duty wins.
+         */
+        if(grp->airflow != ONLP_FAN_CONTROL_AIRFLOW_ANY &&
+           d->airflow != ONLP_FAN_CONTROL_AIRFLOW_ANY &&
+           grp->airflow != d->airflow) {
+            continue;
+        }
+
+        if(!group_mcelsius__(grp, snap, &mc)) {
+            /* Keep the level and alarm state until the sensors return. */
+            sensor_failed = 1;
+            d->group_level[g] = fc->level[g];
+            d->group_duty[g] = policy->sensor_fail_duty;
+            if(fc->alarm > alarm) {
+                alarm = fc->alarm;
+            }
+            continue;
+        }
+
+        level = fc->level[g];
+        if(level >= grp->level_count) {
+            level = grp->level_count - 1;
+        }
+        while(level + 1 < grp->level_count && mc > grp->levels[level + 1].up_mc) {
+            level++;
+        }
+        while(level > 0 && mc <= grp->levels[level].down_mc) {
+            level--;
+        }
+        fc->level[g] = level;
+
+        d->group_mc[g] = mc;
+        d->group_level[g] = level;
+        d->group_duty[g] = group_pid__(fc, g, grp, mc, grp->levels[level].duty,
+                                       duty_max, snap->time);
+
+        ga = group_alarm__(fc, grp, mc);
+        if(ga > alarm) {
+            alarm = ga;
+        }
+    }
+
+    for(g = 0; g < policy->group_count; g++) {
+        if(d->group_level[g] >= 0 && d->group_duty[g] > d->duty) {
+            d->duty = d->group_duty[g];
+        }
+    }
+
+    if(sensor_failed) {
+        d->reason = ONLP_FAN_CONTROL_REASON_SENSOR_FAILURE;
+        if(policy->sensor_fail_duty > d->duty) {
+            d->duty = policy->sensor_fail_duty;
+        }
+    }
+    if(fan_failed) {
+        d->reason = ONLP_FAN_CONTROL_REASON_FAN_FAILURE;
+        if(policy->fan_fail_duty > d->duty) {
+            d->duty = policy->fan_fail_duty;
+        }
+    }
+
+    if(d->duty < policy->duty_min) {
+        d->duty = policy->duty_min;
+    }
+    if(d->duty > duty_max) {
+        d->duty = duty_max;
+    }
+
+    d->alarm = alarm;
+    d->alarm_changed = (alarm != fc->alarm);
+    fc->alarm = alarm;
+    fc->last_time = snap->time;
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_fan_control_apply(onlp_fan_control_t* fc,
+                       const onlp_fan_control_snapshot_t* snap,
+                       onlp_fan_control_decision_t* d)
+{
+    int i;
+    int rv = ONLP_STATUS_OK;
+    const onlp_fan_control_policy_t* policy = fc->policy;
+
+    if(d->reason != fc->last_reason) {
+        if(d->reason == ONLP_FAN_CONTROL_REASON_FAN_FAILURE) {
+            AIM_LOG_ERROR("A fan is not working, setting the fans to %d%%.", d->duty);
+        }
+        else if(d->reason == ONLP_FAN_CONTROL_REASON_SENSOR_FAILURE) {
+            AIM_LOG_ERROR("Unable to read thermal status, setting the fans to %d%%.", d->duty);
+        }
+        fc->last_reason = d->reason;
+    }
+
+    if(d->duty != snap->duty) {
+        for(i = 0; i < ONLP_FAN_CONTROL_FANS_MAX && policy->duty_fans[i]; i++) {
+            int r = onlp_fani_percentage_set(policy->duty_fans[i], d->duty);
+            if(r < 0) {
+                AIM_LOG_ERROR("Unable to set %{onlp_oid} to %d%%: %{onlp_status}",
+                              policy->duty_fans[i], d->duty, r);
+                rv = r;
+            }
+        }
+        fc->duty_changes++;
+    }
+    fc->last_duty = d->duty;
+
+    if(d->alarm_changed) {
+        switch(d->alarm)
+            {
+            case ONLP_FAN_CONTROL_ALARM_WARNING:
+                AIM_SYSLOG_WARN("Temperature high", "Temperature high",
+                                "Alarm for temperature high is detected");
+                break;
+            case ONLP_FAN_CONTROL_ALARM_CRITICAL:
+                AIM_SYSLOG_CRIT("Temperature critical", "Temperature critical",
+                                "Alarm for temperature critical is detected");
+                if(fc->critical) {
+                    fc->critical(fc, d);
+                }
+                break;
+            default:
+                AIM_SYSLOG_INFO("Temperature high is clear", "Temperature high is clear",
+                                "Alarm for temperature high is cleared");
+                break;
+            }
+    }
+
+    return rv;
+}
+
+int
+onlp_fan_control_manage(onlp_fan_control_t* fc)
+{
+    int rv;
+    onlp_fan_control_snapshot_t snap;
+    onlp_fan_control_decision_t d;
+
+    fc->cycles++;
+
+    if(ONLP_FAILURE(rv = onlp_fan_control_snapshot(fc, &snap))) {
+        return rv;
+    }
+    if(ONLP_FAILURE(rv = onlp_fan_control_decide(fc, &snap, &d))) {
+        return rv;
+    }
+    return onlp_fan_control_apply(fc, &snap, &d);
+}
+
+
+/**
+ * Parse an OID as "<type>-<id>" or as a number.
+ */
+static int
+oid_parse__(const char* str, onlp_oid_t* oid)
+{
+    char type[16];
+    char* end;
+    int id, i;
+    onlp_oid_type_t t;
+
+    while(isspace((unsigned char)*str)) {
+        str++;
+    }
+
+    if(isdigit((unsigned char)*str)) {
+        *oid = strtoul(str, &end, 0);
+        return (end != str) ? 0 : -1;
+    }
+
+    if(sscanf(str, "%15[a-zA-Z]-%d", type, &id) != 2) {
+        return -1;
+    }
+    for(i = 0; type[i]; i++) {
+        type[i] = toupper((unsigned char)type[i]);
+    }
+    if(onlp_oid_type_value(type, &t, 0) < 0) {
+        return -1;
+    }
+    *oid = ONLP_OID_TYPE_CREATE(t, id);
+    return 0;
+}
+
+static int
+oid_list_load__(cJSON* root, const char* key, onlp_oid_t* table, int max)
+{
+    cJSON* array;
+    int i, count;
+
+    if(cjson_util_lookup(root, &array, "%s", key) < 0) {
+        return 0;
+    }
+    count = cJSON_GetArraySize(array);
+    if(count >= max) {
+        AIM_LOG_ERROR("fan control policy: too many entries in %s", key);
+        return -1;
+    }
+    for(i = 0; i < count; i++) {
+        cJSON* e = cJSON_GetArrayItem(array, i);
+        if(e->type == cJSON_Number) {
+            table[i] = e->valueint;
+        }
+        else if(e->type != cJSON_String || oid_parse__(e->valuestring, table + i) < 0) {
+            AIM_LOG_ERROR("fan control policy: invalid OID in %s", key);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int
+group_load__(cJSON* root, onlp_fan_control_group_t* grp)
+{
+    char* str;
+    cJSON* levels;
+    int i;
+
+    if(cjson_util_lookup_string(root, &str, "name") == 0) {
+        aim_strlcpy(grp->name, str, sizeof(grp->name));
+    }
+
+    if(cjson_util_lookup_string(root, &str, "airflow") == 0) {
+        if(!strcasecmp(str, "f2b")) {
+            grp->airflow = ONLP_FAN_CONTROL_AIRFLOW_F2B;
+        }
+        else if(!strcasecmp(str, "b2f")) {
+            grp->airflow = ONLP_FAN_CONTROL_AIRFLOW_B2F;
+        }
+        else if(strcasecmp(str, "any")) {
+            AIM_LOG_ERROR("fan control policy: group %s: invalid airflow '%s'",
+                          grp->name, str);
+            return -1;
+        }
+    }
+
+    if(cjson_util_lookup_string(root, &str, "aggregate") == 0) {
+        if(!strcasecmp(str, "avg")) {
+            grp->aggregate = ONLP_FAN_CONTROL_AGGREGATE_AVG;
+        }
+        else if(strcasecmp(str, "max")) {
+            AIM_LOG_ERROR("fan control policy: group %s: invalid aggregate '%s'",
+                          grp->name, str);
+            return -1;
+        }
+    }
+
+    if(oid_list_load__(root, "thermals", grp->thermals,
+                       ONLP_FAN_CONTROL_GROUP_THERMALS_MAX) < 0) {
+        return -1;
+    }
+
+    if(cjson_util_lookup(root, &levels, "levels") < 0 ||
+       (grp->level_count = cJSON_GetArraySize(levels)) == 0 ||
+       grp->level_count > ONLP_FAN_CONTROL_LEVELS_MAX) {
+        AIM_LOG_ERROR("fan control policy: group %s: missing or invalid levels",
+                      grp->name);
+        return -1;
+    }
+    for(i = 0; i < grp->level_count; i++) {
+        cJSON* e = cJSON_GetArrayItem(levels, i);
+        onlp_fan_control_level_t* l = grp->levels + i;
+        if(cjson_util_lookup_int(e, &l->duty, "duty") < 0) {
+            AIM_LOG_ERROR("fan control policy: group %s: level %d has no duty",
+                          grp->name, i);
+            return -1;
+        }
+        cjson_util_lookup_int(e, &l->up_mc, "up_mc");
+        l->down_mc = l->up_mc;
+        cjson_util_lookup_int(e, &l->down_mc, "down_mc");
+    }
+
+    cjson_util_lookup_int(root, &grp->pid.setpoint_mc, "pid.setpoint_mc");
+    cjson_util_lookup_int(root, &grp->pid.kp, "pid.kp");
+    cjson_util_lookup_int(root, &grp->pid.ki, "pid.ki");
+    cjson_util_lookup_int(root, &grp->pid.kd, "pid.kd");
+    cjson_util_lookup_int(root, &grp->warning_mc, "warning_mc");
+    cjson_util_lookup_int(root, &grp->critical_mc, "critical_mc");
+    cjson_util_lookup_int(root, &grp->alarm_hysteresis_mc, "alarm_hysteresis_mc");
+    return 0;
+}
+
+int
+onlp_fan_control_policy_load(const char* fname,
+                             onlp_fan_control_policy_t** rpolicy)
+{
+    cJSON* root = NULL;
+    cJSON* groups;
+    char* str;
+    int i;
+    int rv = ONLP_STATUS_E_PARAM;
+    onlp_fan_control_policy_t* policy;
+
+    if(cjson_util_parse_file(fname, &root) < 0) {
+        AIM_LOG_ERROR("Could not parse fan control policy %s", fname);
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    policy = aim_zmalloc(sizeof(*policy));
+    policy->duty_max = 100;
+
+    if(cjson_util_lookup_string(root, &str, "name") == 0) {
+        aim_strlcpy(policy->name, str, sizeof(policy->name));
+    }
+    if(oid_list_load__(root, "fans", policy->fans, ONLP_FAN_CONTROL_FANS_MAX) < 0 ||
+       oid_list_load__(root, "duty_fans", policy->duty_fans, ONLP_FAN_CONTROL_FANS_MAX) < 0) {
+        goto done;
+    }
+    cjson_util_lookup_int(root, &policy->duty_min, "duty_min");
+    cjson_util_lookup_int(root, &policy->duty_max, "duty_max");
+    cjson_util_lookup_int(root, &policy->fan_fail_duty, "fan_fail_duty");
+    cjson_util_lookup_int(root, &policy->sensor_fail_duty, "sensor_fail_duty");
+
+    if(cjson_util_lookup(root, &groups, "groups") < 0 ||
+       (policy->group_count = cJSON_GetArraySize(groups)) > ONLP_FAN_CONTROL_GROUPS_MAX) {
+        AIM_LOG_ERROR("fan control policy %s: missing or invalid groups", fname);
+        goto done;
+    }
+    for(i = 0; i < policy->group_count; i++) {
+        if(group_load__(cJSON_GetArrayItem(groups, i), policy->groups + i) < 0) {
+            goto done;
+        }
+    }
+    rv = ONLP_STATUS_OK;
+
+ done:
+    cJSON_Delete(root);
+    if(rv < 0) {
+        aim_free(policy);
+    }
+    else {
+        *rpolicy = policy;
+    }
+    return rv;
+}
+
+
+/**
+ * Replay column kinds.
+ */
+enum {
+    REPLAY_COLUMN_IGNORE,
+    REPLAY_COLUMN_TIME,
+    REPLAY_COLUMN_DUTY,
+    REPLAY_COLUMN_THERMAL,
+    REPLAY_COLUMN_FAN,
+};
+
+#define REPLAY_COLUMNS_MAX (ONLP_FAN_CONTROL_THERMALS_MAX + ONLP_FAN_CONTROL_FANS_MAX + 2)
+
+typedef struct replay_column_s {
+    int kind;
+    int index;
+} replay_column_t;
+
+static char*
+csv_next__(char** sp)
+{
+    char* s = *sp;
+    char* e;
+
+    if(s == NULL) {
+        return NULL;
+    }
+    if((e = strchr(s, ','))) {
+        *e = 0;
+        *sp = e + 1;
+    }
+    else {
+        s[strcspn(s, "\r\n")] = 0;
+        *sp = NULL;
+    }
+    while(isspace((unsigned char)*s)) {
+        s++;
+    }
+    return s;
+}
+
+/** Returns 0 for an empty or "x" value. */
+static int
+csv_value__(const char* s, long* value)
+{
+    char* end;
+    if(*s == 0 || *s == 'x' || *s == 'X') {
+        return 0;
+    }
+    *value = strtol(s, &end, 0);
+    return end != s;
+}
+
+static void
+decision_show__(onlp_fan_control_t* fc, uint64_t ms,
+                onlp_fan_control_decision_t* d, aim_pvs_t* pvs)
+{
+    int g;
+    const onlp_fan_control_policy_t* policy = fc->policy;
+
+    aim_printf(pvs, "%8" PRIu64 " duty %3d %-14s %-3s alarm %-8s%s",
+               ms, d->duty, reason_name__(d->reason), airflow_name__(d->airflow),
+               alarm_name__(d->alarm), d->alarm_changed ? "*" : " ");
+    for(g = 0; g < policy->group_count; g++) {
+        if(d->group_level[g] < 0) {
+            continue;
+        }
+        aim_printf(pvs, " %s=%d.%03d/L%d/%d", policy->groups[g].name,
+                   d->group_mc[g] / 1000, abs(d->group_mc[g] % 1000),
+                   d->group_level[g], d->group_duty[g]);
+    }
+    aim_printf(pvs, "\n");
+}
+
+int
+onlp_fan_control_replay(const onlp_fan_control_policy_t* policy,
+                        const char* fname, aim_pvs_t* pvs)
+{
+    FILE* fp;
+    char line[4096];
+    char* sp;
+    char* s;
+    int i, c, columns = 0;
+    int rv;
+    int duty = -1;
+    int fan_count = 0;
+    int lineno = 1;
+    replay_column_t column[REPLAY_COLUMNS_MAX];
+    onlp_fan_control_t fc;
+    onlp_fan_control_snapshot_t snap;
+    onlp_fan_control_decision_t d;
+
+    if(ONLP_FAILURE(rv = onlp_fan_control_init(&fc, policy))) {
+        return rv;
+    }
+
+    if((fp = fopen(fname, "r")) == NULL) {
+        AIM_LOG_ERROR("Could not open trace %s: %{errno}", fname, errno);
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if(fgets(line, sizeof(line), fp) == NULL) {
+        AIM_LOG_ERROR("Trace %s is empty.", fname);
+        fclose(fp);
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    while(policy->fans[fan_count] && fan_count < ONLP_FAN_CONTROL_FANS_MAX) {
+        fan_count++;
+    }
+
+    sp = line;
+    while((s = csv_next__(&sp)) && columns < REPLAY_COLUMNS_MAX) {
+        replay_column_t* col = column + columns++;
+        onlp_oid_t oid;
+
+        col->kind = REPLAY_COLUMN_IGNORE;
+        if(!strcasecmp(s, "time")) {
+            col->kind = REPLAY_COLUMN_TIME;
+        }
+        else if(!strcasecmp(s, "duty")) {
+            col->kind = REPLAY_COLUMN_DUTY;
+        }
+        else if(oid_parse__(s, &oid) == 0) {
+            if((col->index = thermal_index__(fc.thermals, fc.thermal_count, oid)) >= 0) {
+                col->kind = REPLAY_COLUMN_THERMAL;
+            }
+            else if((col->index = thermal_index__((onlp_oid_t*)policy->fans,
+                                                  fan_count, oid)) >= 0) {
+                col->kind = REPLAY_COLUMN_FAN;
+            }
+        }
+        if(col->kind == REPLAY_COLUMN_IGNORE) {
+            aim_printf(pvs, "# column '%s' is not used by policy %s\n", s, policy->name);
+        }
+    }
+
+    while(fgets(line, sizeof(line), fp)) {
+        uint64_t ms = 0;
+        lineno++;
+
+        if(line[0] == '#' || line[strspn(line, " \t\r\n")] == 0) {
+            continue;
+        }
+
+        memset(&snap, 0, sizeof(snap));
+        snap.thermal_count = fc.thermal_count;
+        memcpy(snap.thermals, fc.thermals, sizeof(snap.thermals));
+        snap.fan_count = fan_count;
+        memcpy(snap.fans, policy->fans, sizeof(snap.fans));
+        /* Fans not in the trace are assumed to be working. */
+        for(i = 0; i < fan_count; i++) {
+            snap.fan_status[i] = ONLP_FAN_STATUS_PRESENT;
+        }
+        /* Without a duty column the previous decision was applied. */
+        snap.duty = duty;
+
+        sp = line;
+        for(c = 0; c < columns && (s = csv_next__(&sp)); c++) {
+            long value;
+            int ok = csv_value__(s, &value);
+
+            switch(column[c].kind)
+                {
+                case REPLAY_COLUMN_TIME:
+                    ms = ok ? value : 0;
+                    break;
+                case REPLAY_COLUMN_DUTY:
+                    snap.duty = ok ? value : -1;
+                    break;
+                case REPLAY_COLUMN_THERMAL:
+                    snap.thermal_ok[column[c].index] = ok;
+                    snap.mcelsius[column[c].index] = ok ? value : 0;
+                    break;
+                case REPLAY_COLUMN_FAN:
+                    snap.fan_status[column[c].index] = ok ? value : 0;
+                    break;
+                default:
+                    break;
+                }
+        }
+        snap.time = ms * 1000;
+
+        onlp_fan_control_decide(&fc, &snap, &d);
+        if(d.duty != snap.duty) {
+            fc.duty_changes++;
+        }
+        fc.cycles++;
+        duty = d.duty;
+        decision_show__(&fc, ms, &d, pvs);
+    }
+
+    fclose(fp);
+    aim_printf(pvs, "# %" PRIu64 " decisions, %" PRIu64 " duty changes\n",
+               fc.cycles, fc.duty_changes);
+    return ONLP_STATUS_OK;
+}
+
+void
+onlp_fan_control_show(onlp_fan_control_t* fc, aim_pvs_t* pvs)
+{
+    int g;
+    const onlp_fan_control_policy_t* policy = fc->policy;
+
+    aim_printf(pvs, "Fan control policy %s:\n", policy->name);
+    aim_printf(pvs, "  duty %d (%s), alarm %s\n", fc->last_duty,
+               reason_name__(fc->last_reason), alarm_name__(fc->alarm));
+    for(g = 0; g < policy->group_count; g++) {
+        aim_printf(pvs, "  group %s (%s): level %d\n", policy->groups[g].name,
+                   airflow_name__(policy->groups[g].airflow), fc->level[g]);
+    }
+    aim_printf(pvs, "  cycles %" PRIu64 ", duty changes %" PRIu64 ", read errors %" PRIu64 "\n",
+               fc->cycles, fc->duty_changes, fc->read_errors);
+}
@@ -27,6 +27,7 @@
 #include <onlp/led.h>
 #include <onlp/platformi/ledi.h>
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_LED
 #include "onlp_locks.h"
 
 #define VALIDATE(_id)                           \
@@ -82,7 +83,7 @@ onlp_led_info_get_locked__(onlp_oid_t id, onlp_led_info_t* info)
     VALIDATE(id);
     return onlp_ledi_info_get(id, info);
 }
-ONLP_LOCKED_API2(onlp_led_info_get, onlp_oid_t, id, onlp_led_info_t*, info);
+ONLP_LOCKED_RAPI2(onlp_led_info_get, onlp_oid_t, id, onlp_led_info_t*, info);
 
 static int
 onlp_led_status_get_locked__(onlp_oid_t id, uint32_t* status)
@@ -98,7 +99,7 @@ onlp_led_status_get_locked__(onlp_oid_t id, uint32_t* status)
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_led_status_get, onlp_oid_t, id, uint32_t*, status);
+ONLP_LOCKED_RAPI2(onlp_led_status_get, onlp_oid_t, id, uint32_t*, status);
 
 static int
 onlp_led_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr)
@@ -114,7 +115,7 @@ onlp_led_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr)
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_led_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
+ONLP_LOCKED_RAPI2(onlp_led_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
 
 static int
 onlp_led_set_locked__(onlp_oid_t id, int on_or_off)
@@ -28,6 +28,9 @@
 #include "onlp_int.h"
 #include <AIM/aim.h>
 #include <AIM/aim_printf.h>
+#include <AIM/aim_time.h>
+#include <pthread.h>
+#include <inttypes.h>
 
 #include <onlp/thermal.h>
 #include <onlp/fan.h>
@@ -203,29 +206,312 @@ onlp_oid_iterate(onlp_oid_t oid, onlp_oid_type_t type,
                  onlp_oid_iterate_f itf, void* cookie)
 {
     int rv;
-    onlp_oid_hdr_t hdr;
-    onlp_oid_t* oidp;
+    onlp_oid_t c;
+    onlp_oid_iter_t iter;
 
-    if(oid == 0) {
-        oid = ONLP_OID_SYS;
-    }
-
-    rv = onlp_oid_hdr_get(oid, &hdr);
+    rv = onlp_oid_iter_init(&iter, oid, type);
     if(rv < 0) {
         return rv;
     }
 
-    ONLP_OID_TABLE_ITER(hdr.coids, oidp) {
-        if(type == 0 || ONLP_OID_IS_TYPE(type, *oidp)) {
-            int rv = itf(*oidp, cookie);
-            if(rv < 0) {
-                return rv;
+    while(onlp_oid_iter_next(&iter, &c) == 1) {
+        int rv = itf(c, cookie);
+        if(rv < 0) {
+            return rv;
+        }
+        rv = onlp_oid_iterate(c, type, itf, cookie);
+        if(rv < 0) {
+            return rv;
+        }
+    }
+    return ONLP_STATUS_OK;
+}
+
+/******************************************************************************
+ *
+ * OID Registry
+ *
+ * The child OIDs of each object are indexed by OID in an open-addressed
+ * hash table. Iterators walk the stored children by position, so no
+ * headers are copied while iterating and the system OID table is not
+ * limited to ONLP_OID_TABLE_SIZE entries.
+ *
+ *****************************************************************************/
+
+/*
+ * Upper bound for the system OID table.
+ */
+#define OID_REGISTRY_SYS_MAX 8192
+
+typedef struct oid_registry_entry_s {
+    /** The OID. Zero if this slot is empty. */
+    onlp_oid_t oid;
+    /** The parent OID. */
+    onlp_oid_t poid;
+    /** The child OIDs. */
+    onlp_oid_t* coids;
+    int count;
+    /** Monotonic time (usecs) of the last refresh. Zero if stale. */
+    uint64_t timestamp;
+} oid_registry_entry_t;
+
+static struct {
+    pthread_mutex_t lock;
+    oid_registry_entry_t* entries;
+    /** Slots in entries (a power of 2). */
+    uint32_t size;
+    /** Used slots. */
+    uint32_t count;
+    uint64_t lookups;
+    uint64_t refreshes;
+} registry__ = { PTHREAD_MUTEX_INITIALIZER };
+
+static uint32_t
+oid_registry_hash__(onlp_oid_t oid)
+{
+    return oid * 2654435761U;
+}
+
+static oid_registry_entry_t*
+oid_registry_slot__(oid_registry_entry_t* entries, uint32_t size, onlp_oid_t oid)
+{
+    uint32_t i = oid_registry_hash__(oid) & (size - 1);
+    while(entries[i].oid && entries[i].oid != oid) {
+        i = (i + 1) & (size - 1);
+    }
+    return entries + i;
+}
+
+static oid_registry_entry_t*
+oid_registry_find__(onlp_oid_t oid)
+{
+    oid_registry_entry_t* e;
+    if(registry__.entries == NULL) {
+        return NULL;
+    }
+    e = oid_registry_slot__(registry__.entries, registry__.size, oid);
+    return (e->oid) ? e : NULL;
+}
+
+static oid_registry_entry_t*
+oid_registry_insert__(onlp_oid_t oid)
+{
+    oid_registry_entry_t* e;
+
+    if(registry__.count*2 >= registry__.size) {
+        /* Keep the load factor under 1/2. */
+        uint32_t i;
+        uint32_t size = (registry__.size) ? registry__.size*2 : 64;
+        oid_registry_entry_t* entries = aim_zmalloc(size*sizeof(*entries));
+        for(i = 0; i < registry__.size; i++) {
+            if(registry__.entries[i].oid) {
+                *oid_registry_slot__(entries, size, registry__.entries[i].oid) =
+                    registry__.entries[i];
             }
-            rv = onlp_oid_iterate(*oidp, type, itf, cookie);
-            if(rv < 0) {
+        }
+        aim_free(registry__.entries);
+        registry__.entries = entries;
+        registry__.size = size;
+    }
+
+    e = oid_registry_slot__(registry__.entries, registry__.size, oid);
+    if(e->oid == 0) {
+        e->oid = oid;
+        registry__.count++;
+    }
+    return e;
+}
+
+/*
+ * Read the parent and children of an OID from the platform.
+ */
+static int
+oid_registry_fetch__(onlp_oid_t oid, onlp_oid_t* poid,
+                     onlp_oid_t** coids, int* count)
+{
+    int i, rv;
+    int max = ONLP_OID_TABLE_SIZE;
+    onlp_oid_t* table;
+
+    if(ONLP_OID_TYPE_GET(oid) == ONLP_OID_TYPE_SYS) {
+        *poid = 0;
+        for(;;) {
+            table = aim_zmalloc(max*sizeof(*table));
+            if( (rv = onlp_sys_oids_get(table, max)) < 0) {
+                aim_free(table);
                 return rv;
             }
+            if(table[max-1] == 0 || max >= OID_REGISTRY_SYS_MAX) {
+                break;
+            }
+            /* The table may have been truncated. */
+            aim_free(table);
+            max *= 2;
+        }
+    }
+    else {
+        onlp_oid_hdr_t hdr;
+        if( (rv = onlp_oid_hdr_get(oid, &hdr)) < 0) {
+            return rv;
+        }
+        *poid = hdr.poid;
+        table = aim_zmalloc(max*sizeof(*table));
+        memcpy(table, hdr.coids, max*sizeof(*table));
+    }
+
+    *count = 0;
+    for(i = 0; i < max; i++) {
+        if(table[i]) {
+            table[(*count)++] = table[i];
         }
     }
+    *coids = table;
     return ONLP_STATUS_OK;
 }
+
+/*
+ * Make sure the registry entry for the given OID is current.
+ */
+static int
+oid_registry_refresh__(onlp_oid_t oid)
+{
+    int rv, count;
+    onlp_oid_t poid;
+    onlp_oid_t* coids;
+    oid_registry_entry_t* e;
+    uint64_t now = aim_time_monotonic();
+    uint64_t ttl = ONLP_CONFIG_OID_REGISTRY_TTL_MS*1000ULL;
+
+    pthread_mutex_lock(&registry__.lock);
+    registry__.lookups++;
+    e = oid_registry_find__(oid);
+    if(e && e->timestamp && now - e->timestamp < ttl) {
+        pthread_mutex_unlock(&registry__.lock);
+        return ONLP_STATUS_OK;
+    }
+    pthread_mutex_unlock(&registry__.lock);
+
+    /* The platform is not called with the registry lock held. */
+    if( (rv = oid_registry_fetch__(oid, &poid, &coids, &count)) < 0) {
+        return rv;
+    }
+
+    pthread_mutex_lock(&registry__.lock);
+    e = oid_registry_insert__(oid);
+    aim_free(e->coids);
+    e->poid = poid;
+    e->coids = coids;
+    e->count = count;
+    e->timestamp = aim_time_monotonic();
+    registry__.refreshes++;
+    pthread_mutex_unlock(&registry__.lock);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_oid_iter_init(onlp_oid_iter_t* iter, onlp_oid_t parent,
+                   onlp_oid_type_t type)
+{
+    if(parent == 0) {
+        parent = ONLP_OID_SYS;
+    }
+    iter->parent = parent;
+    iter->type = type;
+    iter->index = 0;
+    return oid_registry_refresh__(parent);
+}
+
+int
+onlp_oid_iter_next(onlp_oid_iter_t* iter, onlp_oid_t* oid)
+{
+    int rv = 0;
+    oid_registry_entry_t* e;
+
+    pthread_mutex_lock(&registry__.lock);
+    if( (e = oid_registry_find__(iter->parent)) ) {
+        while(iter->index < e->count) {
+            onlp_oid_t c = e->coids[iter->index++];
+            if(iter->type == 0 || ONLP_OID_IS_TYPE(iter->type, c)) {
+                *oid = c;
+                rv = 1;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&registry__.lock);
+    return rv;
+}
+
+int
+onlp_oid_children_count(onlp_oid_t oid, onlp_oid_type_t type)
+{
+    int rv;
+    int count = 0;
+    onlp_oid_t c;
+    onlp_oid_iter_t iter;
+
+    if( (rv = onlp_oid_iter_init(&iter, oid, type)) < 0) {
+        return rv;
+    }
+    while(onlp_oid_iter_next(&iter, &c) == 1) {
+        count++;
+    }
+    return count;
+}
+
+int
+onlp_oid_parent_get(onlp_oid_t oid, onlp_oid_t* poid)
+{
+    int rv;
+    oid_registry_entry_t* e;
+
+    if( (rv = oid_registry_refresh__(oid)) < 0) {
+        return rv;
+    }
+
+    rv = ONLP_STATUS_E_INVALID;
+    pthread_mutex_lock(&registry__.lock);
+    if( (e = oid_registry_find__(oid)) ) {
+        *poid = e->poid;
+        rv = ONLP_STATUS_OK;
+    }
+    pthread_mutex_unlock(&registry__.lock);
+    return rv;
+}
+
+void
+onlp_oid_registry_invalidate(onlp_oid_t oid)
+{
+    uint32_t i;
+    oid_registry_entry_t* e;
+
+    pthread_mutex_lock(&registry__.lock);
+    if(oid) {
+        if( (e = oid_registry_find__(oid)) ) {
+            e->timestamp = 0;
+        }
+    }
+    else {
+        for(i = 0; i < registry__.size; i++) {
+            registry__.entries[i].timestamp = 0;
+        }
+    }
+    pthread_mutex_unlock(&registry__.lock);
+}
+
+void
+onlp_oid_registry_show(aim_pvs_t* pvs)
+{
+    uint32_t i;
+    int children = 0;
+
+    pthread_mutex_lock(&registry__.lock);
+    for(i = 0; i < registry__.size; i++) {
+        children += registry__.entries[i].count;
+    }
+    aim_printf(pvs, "OID Registry: objects=%u slots=%u children=%d ttl=%dms lookups=%"PRIu64" refreshes=%"PRIu64"\n",
+               registry__.count, registry__.size, children,
+               ONLP_CONFIG_OID_REGISTRY_TTL_MS,
+               registry__.lookups, registry__.refreshes);
+    pthread_mutex_unlock(&registry__.lock);
+}
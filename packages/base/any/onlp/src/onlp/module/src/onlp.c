@@ -35,6 +35,7 @@
 #include "onlp_int.h"
 #include "onlp_json.h"
 #include "onlp_locks.h"
+#include "onlp_cache.h"
 
 int
 onlp_init(void)
@@ -54,6 +55,7 @@ onlp_init(void)
 
 
     onlp_json_init(cfile);
+    ONLP_CACHE_INIT();
     onlp_sys_init();
     onlp_sfp_init();
     onlp_led_init();
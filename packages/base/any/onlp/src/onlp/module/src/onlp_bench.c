@@ -0,0 +1,466 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlp/onlp.h>
+#include <onlp/oids.h>
+#include <onlp/sys.h>
+#include <onlp/thermal.h>
+#include <onlp/fan.h>
+#include <onlp/psu.h>
+#include <onlp/led.h>
+#include <onlp/sfp.h>
+#include <AIM/aim.h>
+#include <AIM/aim_time.h>
+#include <cjson/cJSON.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "onlp_bench.h"
+#include "onlp_log.h"
+
+typedef enum bench_op_e {
+    BENCH_OP_SYS_INFO,
+    BENCH_OP_THERMAL_INFO,
+    BENCH_OP_FAN_INFO,
+    BENCH_OP_PSU_INFO,
+    BENCH_OP_LED_INFO,
+    BENCH_OP_SFP_PRESENCE_BITMAP,
+    BENCH_OP_SFP_RX_LOS_BITMAP,
+    BENCH_OP_SFP_STATUS_BITMAPS,
+    BENCH_OP_SFP_IS_PRESENT,
+    BENCH_OP_SFP_EEPROM,
+    BENCH_OP_SFP_CONTROL_FLAGS,
+} bench_op_t;
+
+static const char* bench_op_names__[] = {
+    "onlp_sys_info_get",
+    "onlp_thermal_info_get",
+    "onlp_fan_info_get",
+    "onlp_psu_info_get",
+    "onlp_led_info_get",
+    "onlp_sfp_presence_bitmap_get",
+    "onlp_sfp_rx_los_bitmap_get",
+    "onlp_sfp_status_bitmaps_get",
+    "onlp_sfp_is_present",
+    "onlp_sfp_eeprom_read",
+    "onlp_sfp_control_flags_get",
+};
+
+typedef struct bench_test_s {
+    bench_op_t op;
+    /** The OID, or zero. */
+    onlp_oid_t oid;
+    /** The SFP port, or -1. */
+    int port;
+} bench_test_t;
+
+/**
+ * Per-test, per-worker counters. These and the latency samples
+ * live in a shared mapping so worker processes can report them.
+ */
+typedef struct bench_counters_s {
+    uint64_t errors;
+    uint64_t unsupported;
+    uint64_t bytes;
+} bench_counters_t;
+
+typedef struct bench_s {
+    bench_test_t* tests;
+    int count;
+    int size;
+
+    int iterations;
+    int workers;
+
+    /** [test][worker] */
+    bench_counters_t* counters;
+    /** [test][worker][iteration], in microseconds */
+    uint32_t* samples;
+    size_t mapping_size;
+} bench_t;
+
+typedef struct bench_worker_s {
+    bench_t* bench;
+    int index;
+} bench_worker_t;
+
+static void
+bench_test_add__(bench_t* b, bench_op_t op, onlp_oid_t oid, int port)
+{
+    if(b->count == b->size) {
+        b->size = (b->size) ? b->size*2 : 64;
+        b->tests = aim_realloc(b->tests, b->size*sizeof(*b->tests));
+    }
+    b->tests[b->count].op = op;
+    b->tests[b->count].oid = oid;
+    b->tests[b->count].port = port;
+    b->count++;
+}
+
+static int
+bench_oid_add__(onlp_oid_t oid, void* cookie)
+{
+    bench_t* b = (bench_t*)cookie;
+
+    switch(ONLP_OID_TYPE_GET(oid))
+        {
+        case ONLP_OID_TYPE_THERMAL:
+            bench_test_add__(b, BENCH_OP_THERMAL_INFO, oid, -1);
+            break;
+        case ONLP_OID_TYPE_FAN:
+            bench_test_add__(b, BENCH_OP_FAN_INFO, oid, -1);
+            break;
+        case ONLP_OID_TYPE_PSU:
+            bench_test_add__(b, BENCH_OP_PSU_INFO, oid, -1);
+            break;
+        case ONLP_OID_TYPE_LED:
+            bench_test_add__(b, BENCH_OP_LED_INFO, oid, -1);
+            break;
+        default:
+            break;
+        }
+    return 0;
+}
+
+static void
+bench_tests_build__(bench_t* b)
+{
+    onlp_sfp_bitmap_t bitmap;
+    int port;
+
+    bench_test_add__(b, BENCH_OP_SYS_INFO, ONLP_OID_SYS, -1);
+    onlp_oid_iterate(ONLP_OID_SYS, 0, bench_oid_add__, b);
+
+    onlp_sfp_bitmap_t_init(&bitmap);
+    onlp_sfp_bitmap_get(&bitmap);
+    if(AIM_BITMAP_COUNT(&bitmap) == 0) {
+        return;
+    }
+
+    bench_test_add__(b, BENCH_OP_SFP_PRESENCE_BITMAP, 0, -1);
+    bench_test_add__(b, BENCH_OP_SFP_RX_LOS_BITMAP, 0, -1);
+    bench_test_add__(b, BENCH_OP_SFP_STATUS_BITMAPS, 0, -1);
+
+    AIM_BITMAP_ITER(&bitmap, port) {
+        bench_test_add__(b, BENCH_OP_SFP_IS_PRESENT, 0, port);
+        /* Only populated ports have an EEPROM and controls to read. */
+        if(onlp_sfp_is_present(port) == 1) {
+            bench_test_add__(b, BENCH_OP_SFP_EEPROM, 0, port);
+            bench_test_add__(b, BENCH_OP_SFP_CONTROL_FLAGS, 0, port);
+        }
+    }
+}
+
+/**
+ * Run one API call. Returns the ONLP status and
+ * the number of bytes returned.
+ */
+static int
+bench_test_run__(bench_test_t* t, uint64_t* bytes)
+{
+    int rv;
+
+    switch(t->op)
+        {
+        case BENCH_OP_SYS_INFO:
+            {
+                onlp_sys_info_t si;
+                rv = onlp_sys_info_get(&si);
+                if(rv >= 0) {
+                    onlp_sys_info_free(&si);
+                }
+                return rv;
+            }
+        case BENCH_OP_THERMAL_INFO:
+            {
+                onlp_thermal_info_t ti;
+                return onlp_thermal_info_get(t->oid, &ti);
+            }
+        case BENCH_OP_FAN_INFO:
+            {
+                onlp_fan_info_t fi;
+                return onlp_fan_info_get(t->oid, &fi);
+            }
+        case BENCH_OP_PSU_INFO:
+            {
+                onlp_psu_info_t pi;
+                return onlp_psu_info_get(t->oid, &pi);
+            }
+        case BENCH_OP_LED_INFO:
+            {
+                onlp_led_info_t li;
+                return onlp_led_info_get(t->oid, &li);
+            }
+        case BENCH_OP_SFP_PRESENCE_BITMAP:
+            {
+                onlp_sfp_bitmap_t bitmap;
+                onlp_sfp_bitmap_t_init(&bitmap);
+                return onlp_sfp_presence_bitmap_get(&bitmap);
+            }
+        case BENCH_OP_SFP_RX_LOS_BITMAP:
+            {
+                onlp_sfp_bitmap_t bitmap;
+                onlp_sfp_bitmap_t_init(&bitmap);
+                return onlp_sfp_rx_los_bitmap_get(&bitmap);
+            }
+        case BENCH_OP_SFP_STATUS_BITMAPS:
+            {
+                onlp_sfp_status_bitmaps_t status;
+                return onlp_sfp_status_bitmaps_get(&status);
+            }
+        case BENCH_OP_SFP_IS_PRESENT:
+            return onlp_sfp_is_present(t->port);
+        case BENCH_OP_SFP_EEPROM:
+            {
+                uint8_t* data = NULL;
+                rv = onlp_sfp_eeprom_read(t->port, &data);
+                if(rv >= 0) {
+                    /* The EEPROM is always returned as a 256 byte buffer. */
+                    *bytes += 256;
+                }
+                aim_free(data);
+                return rv;
+            }
+        case BENCH_OP_SFP_CONTROL_FLAGS:
+            {
+                uint32_t flags;
+                return onlp_sfp_control_flags_get(t->port, &flags);
+            }
+        }
+
+    return ONLP_STATUS_E_PARAM;
+}
+
+static void*
+bench_worker__(void* arg)
+{
+    bench_worker_t* w = (bench_worker_t*)arg;
+    bench_t* b = w->bench;
+    int i, t;
+
+    for(i = 0; i < b->iterations; i++) {
+        for(t = 0; t < b->count; t++) {
+            bench_counters_t* c = b->counters + (t*b->workers + w->index);
+            uint64_t start = aim_time_monotonic();
+            int rv = bench_test_run__(b->tests + t, &c->bytes);
+            uint64_t elapsed = aim_time_monotonic() - start;
+
+            b->samples[((size_t)t*b->workers + w->index)*b->iterations + i] =
+                (elapsed > UINT32_MAX) ? UINT32_MAX : elapsed;
+
+            if(rv == ONLP_STATUS_E_UNSUPPORTED) {
+                c->unsupported++;
+            }
+            else if(rv < 0) {
+                c->errors++;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Run the threads of one process.
+ */
+static void
+bench_process_run__(bench_t* b, int first, int threads)
+{
+    bench_worker_t* workers = aim_zmalloc(threads*sizeof(*workers));
+    pthread_t* tids = aim_zmalloc(threads*sizeof(*tids));
+    int i;
+
+    for(i = 0; i < threads; i++) {
+        workers[i].bench = b;
+        workers[i].index = first + i;
+    }
+
+    for(i = 1; i < threads; i++) {
+        if(pthread_create(tids + i, NULL, bench_worker__, workers + i) != 0) {
+            AIM_LOG_ERROR("benchmark: pthread_create() failed.");
+            tids[i] = 0;
+            /* Run it inline instead. */
+            bench_worker__(workers + i);
+        }
+    }
+
+    bench_worker__(workers + 0);
+
+    for(i = 1; i < threads; i++) {
+        if(tids[i]) {
+            pthread_join(tids[i], NULL);
+        }
+    }
+
+    aim_free(tids);
+    aim_free(workers);
+}
+
+static int
+bench_sample_compare__(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static cJSON*
+bench_report__(bench_t* b, int threads, int processes, uint64_t elapsed)
+{
+    cJSON* cj = cJSON_CreateObject();
+    cJSON* tests = cJSON_CreateArray();
+    int n = b->workers*b->iterations;
+    uint32_t* sorted = aim_zmalloc(n*sizeof(*sorted));
+    int t, w;
+
+    cJSON_AddNumberToObject(cj, "iterations", b->iterations);
+    cJSON_AddNumberToObject(cj, "threads", threads);
+    cJSON_AddNumberToObject(cj, "processes", processes);
+    cJSON_AddNumberToObject(cj, "elapsed_us", elapsed);
+
+    for(t = 0; t < b->count; t++) {
+        bench_test_t* test = b->tests + t;
+        cJSON* e = cJSON_CreateObject();
+        uint64_t errors = 0, unsupported = 0, bytes = 0, total = 0;
+        int i;
+
+        for(w = 0; w < b->workers; w++) {
+            bench_counters_t* c = b->counters + (t*b->workers + w);
+            errors += c->errors;
+            unsupported += c->unsupported;
+            bytes += c->bytes;
+        }
+
+        memcpy(sorted, b->samples + (size_t)t*n, n*sizeof(*sorted));
+        qsort(sorted, n, sizeof(*sorted), bench_sample_compare__);
+        for(i = 0; i < n; i++) {
+            total += sorted[i];
+        }
+
+        cJSON_AddStringToObject(e, "api", bench_op_names__[test->op]);
+        if(test->oid) {
+            char* oid = aim_fstrdup("0x%x", test->oid);
+            cJSON_AddStringToObject(e, "oid", oid);
+            aim_free(oid);
+        }
+        if(test->port >= 0) {
+            cJSON_AddNumberToObject(e, "port", test->port);
+        }
+        cJSON_AddNumberToObject(e, "calls", n);
+        cJSON_AddNumberToObject(e, "errors", errors);
+        cJSON_AddNumberToObject(e, "unsupported", unsupported);
+        cJSON_AddNumberToObject(e, "error_rate", n ? (double)errors / n : 0);
+        cJSON_AddNumberToObject(e, "bytes", bytes);
+        cJSON_AddNumberToObject(e, "mean_us", n ? (double)total / n : 0);
+        cJSON_AddNumberToObject(e, "p50_us", n ? sorted[(n-1)*50/100] : 0);
+        cJSON_AddNumberToObject(e, "p99_us", n ? sorted[(n-1)*99/100] : 0);
+        cJSON_AddNumberToObject(e, "max_us", n ? sorted[n-1] : 0);
+        cJSON_AddItemToArray(tests, e);
+    }
+
+    cJSON_AddItemToObject(cj, "tests", tests);
+    aim_free(sorted);
+    return cj;
+}
+
+int
+onlp_bench_run(int iterations, int threads, int processes, aim_pvs_t* pvs)
+{
+    bench_t b;
+    uint64_t start;
+    int p, rv = ONLP_STATUS_OK;
+    pid_t* pids;
+    size_t counters_size;
+    char* out;
+    cJSON* cj;
+
+    if(iterations <= 0 || threads <= 0 || processes <= 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    memset(&b, 0, sizeof(b));
+    b.iterations = iterations;
+    b.workers = threads*processes;
+    bench_tests_build__(&b);
+
+    /*
+     * Counters and samples are written by every worker process,
+     * so they are kept in a shared anonymous mapping.
+     */
+    counters_size = (size_t)b.count*b.workers*sizeof(bench_counters_t);
+    b.mapping_size = counters_size +
+        (size_t)b.count*b.workers*b.iterations*sizeof(uint32_t);
+    if(b.mapping_size == 0) {
+        b.mapping_size = 1;
+    }
+    b.counters = mmap(NULL, b.mapping_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(b.counters == MAP_FAILED) {
+        AIM_LOG_ERROR("benchmark: unable to map %zu bytes of sample memory.",
+                      b.mapping_size);
+        aim_free(b.tests);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    b.samples = (uint32_t*)((uint8_t*)b.counters + counters_size);
+
+    pids = aim_zmalloc(processes*sizeof(*pids));
+    start = aim_time_monotonic();
+
+    for(p = 1; p < processes; p++) {
+        pids[p] = fork();
+        if(pids[p] == 0) {
+            bench_process_run__(&b, p*threads, threads);
+            _exit(0);
+        }
+        if(pids[p] < 0) {
+            AIM_LOG_ERROR("benchmark: fork() failed.");
+            rv = ONLP_STATUS_E_INTERNAL;
+            break;
+        }
+    }
+
+    if(rv == ONLP_STATUS_OK) {
+        bench_process_run__(&b, 0, threads);
+    }
+
+    for(p = 1; p < processes; p++) {
+        if(pids[p] > 0) {
+            waitpid(pids[p], NULL, 0);
+        }
+    }
+
+    if(rv == ONLP_STATUS_OK) {
+        cj = bench_report__(&b, threads, processes,
+                            aim_time_monotonic() - start);
+        out = cJSON_Print(cj);
+        aim_printf(pvs, "%s\n", out);
+        free(out);
+        cJSON_Delete(cj);
+    }
+
+    aim_free(pids);
+    munmap(b.counters, b.mapping_size);
+    aim_free(b.tests);
+    return rv;
+}
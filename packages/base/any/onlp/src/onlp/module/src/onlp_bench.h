@@ -0,0 +1,53 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#ifndef __ONLP_BENCH_H__
+#define __ONLP_BENCH_H__
+
+#include <onlp/onlp_config.h>
+#include <AIM/aim_pvs.h>
+
+/**
+ * ONLP API Latency Benchmark
+ *
+ * Every OID under the system OID and every SFP port is exercised
+ * through the public ONLP API. Each API is called a number of times
+ * from each worker, where the workers are a number of threads in
+ * each of a number of processes. The p50/p99/max latency, the
+ * number of bytes returned and the error counts of each API are
+ * reported as JSON.
+ */
+
+/**
+ * @brief Run the benchmark.
+ * @param iterations The number of calls per API per worker.
+ * @param threads The number of threads per process.
+ * @param processes The number of processes.
+ * @param pvs Receives the JSON report.
+ * @returns ONLP_STATUS_OK if the benchmark was run.
+ * @notes onlp_init() must have been called.
+ */
+int onlp_bench_run(int iterations, int threads, int processes, aim_pvs_t* pvs);
+
+#endif /* __ONLP_BENCH_H__ */
@@ -0,0 +1,292 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * OID Information Snapshot Cache.
+ *
+ ***********************************************************/
+#include <onlp/onlp_config.h>
+#include <onlp/onlp.h>
+#include <onlp/thermal.h>
+#include <onlp/fan.h>
+#include <onlp/psu.h>
+#include <AIM/aim_time.h>
+#include "onlp_cache.h"
+#include "onlp_json.h"
+#include "onlp_log.h"
+
+#if ONLP_CONFIG_INCLUDE_API_CACHE == 1
+
+#if ONLP_CONFIG_API_CACHE_SHARED == 1
+#include <onlplib/shlocks.h>
+/** The shared memory keys for the cache table and its lock. */
+#define ONLP_CACHE_SHMEM_KEY 0xF00DCAC4
+#define ONLP_CACHE_SHLOCK_KEY 0xF00DCAC5
+static onlp_shlock_t* lock__ = NULL;
+#define ONLP_CACHE_LOCK() onlp_shlock_take(lock__)
+#define ONLP_CACHE_UNLOCK() onlp_shlock_give(lock__)
+#else
+#include <pthread.h>
+static pthread_mutex_t lock__ = PTHREAD_MUTEX_INITIALIZER;
+#define ONLP_CACHE_LOCK() pthread_mutex_lock(&lock__)
+#define ONLP_CACHE_UNLOCK() pthread_mutex_unlock(&lock__)
+#endif
+
+/**
+ * Cached OID types.
+ */
+typedef enum onlp_cache_type_e {
+    ONLP_CACHE_TYPE_THERMAL,
+    ONLP_CACHE_TYPE_FAN,
+    ONLP_CACHE_TYPE_PSU,
+    ONLP_CACHE_TYPE_COUNT,
+} onlp_cache_type_t;
+
+/**
+ * Cached information. All members must be position-independent
+ * as they may live in shared memory.
+ */
+typedef union onlp_cache_data_u {
+    onlp_thermal_info_t thermal;
+    onlp_fan_info_t fan;
+    onlp_psu_info_t psu;
+} onlp_cache_data_t;
+
+typedef struct onlp_cache_entry_s {
+    /** Monotonic time (usecs) at which this entry was filled. Zero if empty. */
+    uint64_t timestamp;
+    /** The cached information. */
+    onlp_cache_data_t data;
+} onlp_cache_entry_t;
+
+typedef struct onlp_cache_stats_s {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t invalidations;
+} onlp_cache_stats_t;
+
+typedef struct onlp_cache_table_s {
+    uint32_t magic;
+    uint32_t size;
+    onlp_cache_stats_t stats[ONLP_CACHE_TYPE_COUNT];
+    onlp_cache_entry_t entries[ONLP_CACHE_TYPE_COUNT][ONLP_CONFIG_API_CACHE_SIZE];
+} onlp_cache_table_t;
+
+#define ONLP_CACHE_MAGIC 0xCAC4E001
+
+static onlp_cache_table_t* table__ = NULL;
+static int shared__ = 0;
+
+/**
+ * Per-type configuration (local to this process).
+ */
+static struct {
+    onlp_oid_type_t type;
+    const char* name;
+    const char* key;
+    /** Time-to-live in microseconds. Zero disables the cache for this type. */
+    uint64_t ttl;
+} types__[ONLP_CACHE_TYPE_COUNT] = {
+    { ONLP_OID_TYPE_THERMAL, "thermal", "cache.thermal" },
+    { ONLP_OID_TYPE_FAN,     "fan",     "cache.fan" },
+    { ONLP_OID_TYPE_PSU,     "psu",     "cache.psu" },
+};
+
+static void
+onlp_cache_table_init__(void)
+{
+#if ONLP_CONFIG_API_CACHE_SHARED == 1
+    onlp_cache_table_t* t = NULL;
+
+    onlp_shlock_create(ONLP_CACHE_SHLOCK_KEY, &lock__, "onlp-cache-lock");
+    if(onlp_shmem_create(ONLP_CACHE_SHMEM_KEY, sizeof(*t), (void**)&t) >= 0) {
+        ONLP_CACHE_LOCK();
+        if(t->magic != ONLP_CACHE_MAGIC) {
+            memset(t, 0, sizeof(*t));
+            t->magic = ONLP_CACHE_MAGIC;
+            t->size = sizeof(*t);
+        }
+        ONLP_CACHE_UNLOCK();
+        if(t->size == sizeof(*t)) {
+            table__ = t;
+            shared__ = 1;
+        }
+        else {
+            AIM_LOG_WARN("The shared cache table does not match this build. Using a private cache.");
+        }
+    }
+#endif
+    if(table__ == NULL) {
+        table__ = aim_zmalloc(sizeof(*table__));
+        table__->magic = ONLP_CACHE_MAGIC;
+        table__->size = sizeof(*table__);
+    }
+}
+
+void
+onlp_cache_init(void)
+{
+    int i;
+    for(i = 0; i < ONLP_CACHE_TYPE_COUNT; i++) {
+        int ms = 0;
+        if(cjson_util_lookup_int(onlp_json_get(0), &ms, types__[i].key) < 0 ||
+           ms < 0) {
+            ms = 0;
+        }
+        types__[i].ttl = (uint64_t)ms * 1000;
+    }
+
+    if(table__ == NULL) {
+        onlp_cache_table_init__();
+    }
+}
+
+static int
+onlp_cache_type__(onlp_oid_t oid)
+{
+    int i;
+    for(i = 0; i < ONLP_CACHE_TYPE_COUNT; i++) {
+        if(ONLP_OID_IS_TYPE(types__[i].type, oid)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static onlp_cache_entry_t*
+onlp_cache_entry__(onlp_oid_t oid, int* type)
+{
+    int id = ONLP_OID_ID_GET(oid);
+
+    *type = onlp_cache_type__(oid);
+    if(table__ == NULL || *type < 0 || types__[*type].ttl == 0 ||
+       id >= ONLP_CONFIG_API_CACHE_SIZE) {
+        return NULL;
+    }
+    return &table__->entries[*type][id];
+}
+
+int
+onlp_cache_get(onlp_oid_t oid, void* info, int size)
+{
+    int type;
+    onlp_cache_entry_t* e = onlp_cache_entry__(oid, &type);
+
+    if(e == NULL || size > sizeof(e->data)) {
+        return 0;
+    }
+
+    ONLP_CACHE_LOCK();
+    if(e->timestamp &&
+       aim_time_monotonic() - e->timestamp < types__[type].ttl) {
+        ONLP_MEMCPY(info, &e->data, size);
+        table__->stats[type].hits++;
+        ONLP_CACHE_UNLOCK();
+        return 1;
+    }
+
+    table__->stats[type].misses++;
+    ONLP_CACHE_UNLOCK();
+    return 0;
+}
+
+void
+onlp_cache_set(onlp_oid_t oid, const void* info, int size)
+{
+    int type;
+    onlp_cache_entry_t* e = onlp_cache_entry__(oid, &type);
+
+    if(e == NULL || size > sizeof(e->data)) {
+        return;
+    }
+    ONLP_CACHE_LOCK();
+    ONLP_MEMCPY(&e->data, info, size);
+    e->timestamp = aim_time_monotonic();
+    ONLP_CACHE_UNLOCK();
+}
+
+void
+onlp_cache_invalidate(onlp_oid_t oid)
+{
+    int type;
+    onlp_cache_entry_t* e = onlp_cache_entry__(oid, &type);
+
+    if(e) {
+        ONLP_CACHE_LOCK();
+        if(e->timestamp) {
+            e->timestamp = 0;
+            table__->stats[type].invalidations++;
+        }
+        ONLP_CACHE_UNLOCK();
+    }
+}
+
+void
+onlp_cache_show(aim_pvs_t* pvs)
+{
+    int i, stats;
+    onlp_cache_table_t* t = table__;
+
+    if(t == NULL) {
+        aim_printf(pvs, "OID cache not initialized.\n");
+        return;
+    }
+
+    /*
+     * A private cache only counts this process's lookups. A fresh process
+     * such as onlpdump -C has none, so don't present zeros as statistics.
+     */
+    stats = shared__;
+    for(i = 0; i < ONLP_CACHE_TYPE_COUNT; i++) {
+        if(t->stats[i].hits || t->stats[i].misses) {
+            stats = 1;
+        }
+    }
+
+    aim_printf(pvs, "OID Cache (%s, %d entries per type):\n",
+               shared__ ? "shared, statistics cover all processes" :
+               "private, statistics cover this process only",
+               ONLP_CONFIG_API_CACHE_SIZE);
+    for(i = 0; i < ONLP_CACHE_TYPE_COUNT; i++) {
+        if(stats) {
+            aim_printf(pvs, "  %-8s ttl=%"PRIu64"ms hits=%"PRIu64" misses=%"PRIu64" invalidations=%"PRIu64"\n",
+                       types__[i].name, types__[i].ttl / 1000,
+                       t->stats[i].hits, t->stats[i].misses,
+                       t->stats[i].invalidations);
+        }
+        else {
+            aim_printf(pvs, "  %-8s ttl=%"PRIu64"ms\n",
+                       types__[i].name, types__[i].ttl / 1000);
+        }
+    }
+    if(!stats) {
+        aim_printf(pvs, "  Statistics are not available: this process has made no cache lookups.\n");
+    }
+}
+
+#else
+
+void
+onlp_cache_show(aim_pvs_t* pvs)
+{
+    aim_printf(pvs, "OID cache support not available in this build.\n");
+}
+
+#endif /* ONLP_CONFIG_INCLUDE_API_CACHE */
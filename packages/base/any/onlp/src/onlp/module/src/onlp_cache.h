@@ -0,0 +1,103 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#ifndef __ONLP_CACHE_H__
+#define __ONLP_CACHE_H__
+
+#include <onlp/onlp_config.h>
+#include <onlp/oids.h>
+#include <AIM/aim_pvs.h>
+
+/**
+ * OID Information Snapshot Cache
+ *
+ * The results of the thermal, fan, and psu info_get() platform
+ * calls are cached for a configurable time-to-live so that multiple
+ * consumers polling the same sensors only cost one hardware read
+ * per interval.
+ *
+ * The TTLs are specified in milliseconds in the ONLP configuration
+ * file. A TTL of zero (the default) disables caching for that type:
+ *
+ *    { "cache" : { "thermal" : 2000, "fan" : 2000, "psu" : 1000 } }
+ *
+ * The cache is protected by its own lock (shared between processes
+ * when the cache table is in shared memory) so it may be used by
+ * concurrent readers within a lock domain.
+ */
+
+#if ONLP_CONFIG_INCLUDE_API_CACHE == 1
+
+/**
+ * @brief Initialize the cache TTLs from the ONLP configuration.
+ */
+void onlp_cache_init(void);
+
+/**
+ * @brief Retrieve a cached information structure.
+ * @param oid The OID.
+ * @param info [out] Receives the cached information.
+ * @param size The size of the information structure.
+ * @returns 1 on a cache hit, 0 otherwise.
+ */
+int onlp_cache_get(onlp_oid_t oid, void* info, int size);
+
+/**
+ * @brief Store an information structure in the cache.
+ * @param oid The OID.
+ * @param info The information to cache.
+ * @param size The size of the information structure.
+ */
+void onlp_cache_set(onlp_oid_t oid, const void* info, int size);
+
+/**
+ * @brief Invalidate the cached information for an OID.
+ * @param oid The OID.
+ */
+void onlp_cache_invalidate(onlp_oid_t oid);
+
+#define ONLP_CACHE_INIT() onlp_cache_init()
+#define ONLP_CACHE_GET(_oid, _info) onlp_cache_get(_oid, _info, sizeof(*(_info)))
+#define ONLP_CACHE_SET(_oid, _info) onlp_cache_set(_oid, _info, sizeof(*(_info)))
+#define ONLP_CACHE_INVALIDATE(_oid) onlp_cache_invalidate(_oid)
+
+#else
+
+#define ONLP_CACHE_INIT()
+#define ONLP_CACHE_GET(_oid, _info) 0
+#define ONLP_CACHE_SET(_oid, _info)
+#define ONLP_CACHE_INVALIDATE(_oid)
+
+#endif /* ONLP_CONFIG_INCLUDE_API_CACHE */
+
+/**
+ * @brief Show the cache configuration and hit/miss statistics.
+ * @param pvs The output pvs.
+ * @note The statistics live with the cache table. They cover every
+ * process when the table is shared (ONLP_CONFIG_API_CACHE_SHARED),
+ * and only the calling process when the table is private.
+ */
+void onlp_cache_show(aim_pvs_t* pvs);
+
+#endif /* __ONLP_CACHE_H__ */
@@ -134,6 +134,106 @@ onlp_config_settings_t onlp_config_settings[] =
     { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_API_PROFILING), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_API_PROFILING) },
 #else
 { ONLP_CONFIG_INCLUDE_API_PROFILING(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_INCLUDE_API_CACHE
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_API_CACHE), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_API_CACHE) },
+#else
+{ ONLP_CONFIG_INCLUDE_API_CACHE(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_API_CACHE_SHARED
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_API_CACHE_SHARED), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_API_CACHE_SHARED) },
+#else
+{ ONLP_CONFIG_API_CACHE_SHARED(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_API_CACHE_SIZE
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_API_CACHE_SIZE), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_API_CACHE_SIZE) },
+#else
+{ ONLP_CONFIG_API_CACHE_SIZE(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_API_LOCK_DOMAINS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_API_LOCK_DOMAINS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_API_LOCK_DOMAINS) },
+#else
+{ ONLP_CONFIG_API_LOCK_DOMAINS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_API_LOCK_SHARED_READERS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_API_LOCK_SHARED_READERS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_API_LOCK_SHARED_READERS) },
+#else
+{ ONLP_CONFIG_API_LOCK_SHARED_READERS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_API_LOCK_INDEXED
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_API_LOCK_INDEXED), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_API_LOCK_INDEXED) },
+#else
+{ ONLP_CONFIG_API_LOCK_INDEXED(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_API_LOCK_INDEX_MAX
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_API_LOCK_INDEX_MAX), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_API_LOCK_INDEX_MAX) },
+#else
+{ ONLP_CONFIG_API_LOCK_INDEX_MAX(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_API_LOCK_FILENAME
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_API_LOCK_FILENAME), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_API_LOCK_FILENAME) },
+#else
+{ ONLP_CONFIG_API_LOCK_FILENAME(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_INCLUDE_API_LOCK_STATS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_API_LOCK_STATS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_API_LOCK_STATS) },
+#else
+{ ONLP_CONFIG_INCLUDE_API_LOCK_STATS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_SFP_NOTIFY_SUBSCRIBERS_MAX
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_SFP_NOTIFY_SUBSCRIBERS_MAX), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_SFP_NOTIFY_SUBSCRIBERS_MAX) },
+#else
+{ ONLP_CONFIG_SFP_NOTIFY_SUBSCRIBERS_MAX(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_SFP_NOTIFY_POLL_MS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_SFP_NOTIFY_POLL_MS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_SFP_NOTIFY_POLL_MS) },
+#else
+{ ONLP_CONFIG_SFP_NOTIFY_POLL_MS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_SFP_DOM_BATCH_THREADS_MAX
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_SFP_DOM_BATCH_THREADS_MAX), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_SFP_DOM_BATCH_THREADS_MAX) },
+#else
+{ ONLP_CONFIG_SFP_DOM_BATCH_THREADS_MAX(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MIN_MS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MIN_MS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MIN_MS) },
+#else
+{ ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MIN_MS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MAX_MS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MAX_MS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MAX_MS) },
+#else
+{ ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MAX_MS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_PLATFORM_MANAGE_FANS_HEADROOM_MC
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_PLATFORM_MANAGE_FANS_HEADROOM_MC), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_PLATFORM_MANAGE_FANS_HEADROOM_MC) },
+#else
+{ ONLP_CONFIG_PLATFORM_MANAGE_FANS_HEADROOM_MC(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_OID_REGISTRY_TTL_MS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_OID_REGISTRY_TTL_MS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_OID_REGISTRY_TTL_MS) },
+#else
+{ ONLP_CONFIG_OID_REGISTRY_TTL_MS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE) },
+#else
+{ ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_SYS_INFO_CACHE_SHARED
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_SYS_INFO_CACHE_SHARED), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_SYS_INFO_CACHE_SHARED) },
+#else
+{ ONLP_CONFIG_SYS_INFO_CACHE_SHARED(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_CMIS_POLL_MS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_CMIS_POLL_MS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_CMIS_POLL_MS) },
+#else
+{ ONLP_CONFIG_CMIS_POLL_MS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_CMIS_MONITOR_MS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_CMIS_MONITOR_MS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_CMIS_MONITOR_MS) },
+#else
+{ ONLP_CONFIG_CMIS_MONITOR_MS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
@@ -22,12 +22,211 @@
  *
  *
  ***********************************************************/
+#ifndef _GNU_SOURCE
+/* pthread_rwlockattr_setkind_np() */
+#define _GNU_SOURCE
+#endif
 #include <onlp/onlp_config.h>
 #include <onlp/onlp.h>
 #include "onlp_locks.h"
 
 #if ONLP_CONFIG_INCLUDE_API_LOCK == 1
 
+#include <AIM/aim_time.h>
+#include <pthread.h>
+
+/************************************************************
+ *
+ * Lock Contention Statistics
+ *
+ * These are kept in shared memory when the API lock is shared
+ * between processes so the statistics cover all ONLP clients.
+ * Counters are updated atomically. The maximums are best-effort.
+ *
+ ***********************************************************/
+#if ONLP_CONFIG_INCLUDE_API_LOCK_STATS == 1
+
+#if ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 1
+#include <onlplib/shlocks.h>
+#define ONLP_API_LOCK_STATS_SHMEM_KEY 0xF00DF00E
+#endif
+
+typedef struct onlp_api_lock_stats_s {
+    uint64_t acquisitions;
+    uint64_t shared;
+    uint64_t contended;
+    /** Wait and hold times in microseconds. */
+    uint64_t wait_total;
+    uint64_t wait_max;
+    uint64_t hold_total;
+    uint64_t hold_max;
+    /** The last exclusive owner. */
+    char owner[64];
+    char wait_max_api[64];
+    char hold_max_api[64];
+} onlp_api_lock_stats_t;
+
+typedef struct onlp_api_lock_stats_table_s {
+    uint32_t magic;
+    uint32_t size;
+    onlp_api_lock_stats_t domains[ONLP_API_LOCK_DOMAIN_COUNT];
+} onlp_api_lock_stats_table_t;
+
+#define ONLP_API_LOCK_STATS_MAGIC 0x10C55747
+
+static onlp_api_lock_stats_table_t* stats__ = NULL;
+
+/** The current thread's lock acquisition time and owner. */
+static __thread uint64_t held_time__;
+static __thread const char* held_api__;
+
+static const char* domain_names__[ONLP_API_LOCK_DOMAIN_COUNT] = {
+    "global", "thermal", "fan", "psu", "led", "sfp",
+};
+
+static void
+onlp_api_lock_stats_init__(void)
+{
+    if(stats__) {
+        return;
+    }
+#if ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 1
+    onlp_api_lock_stats_table_t* t = NULL;
+    if(onlp_shmem_create(ONLP_API_LOCK_STATS_SHMEM_KEY, sizeof(*t), (void**)&t) >= 0) {
+        if(t->magic != ONLP_API_LOCK_STATS_MAGIC) {
+            memset(t, 0, sizeof(*t));
+            t->magic = ONLP_API_LOCK_STATS_MAGIC;
+            t->size = sizeof(*t);
+        }
+        if(t->size == sizeof(*t)) {
+            stats__ = t;
+            return;
+        }
+    }
+#endif
+    stats__ = aim_zmalloc(sizeof(*stats__));
+    stats__->magic = ONLP_API_LOCK_STATS_MAGIC;
+    stats__->size = sizeof(*stats__);
+}
+
+static void
+onlp_api_lock_stats_acquired__(int domain, int shared, int contended,
+                               uint64_t t0, const char* api)
+{
+    onlp_api_lock_stats_t* s = stats__->domains + domain;
+    uint64_t now = aim_time_monotonic();
+    uint64_t wait = now - t0;
+
+    __sync_fetch_and_add(&s->acquisitions, 1);
+    if(shared) {
+        __sync_fetch_and_add(&s->shared, 1);
+    }
+    else {
+        aim_strlcpy(s->owner, api, sizeof(s->owner));
+    }
+    if(contended) {
+        /* Only waits for a lock which was found held are counted. */
+        __sync_fetch_and_add(&s->contended, 1);
+        __sync_fetch_and_add(&s->wait_total, wait);
+        if(wait > s->wait_max) {
+            s->wait_max = wait;
+            aim_strlcpy(s->wait_max_api, api, sizeof(s->wait_max_api));
+        }
+    }
+    held_time__ = now;
+    held_api__ = api;
+}
+
+static void
+onlp_api_lock_stats_released__(int domain)
+{
+    onlp_api_lock_stats_t* s = stats__->domains + domain;
+    uint64_t hold = aim_time_monotonic() - held_time__;
+
+    __sync_fetch_and_add(&s->hold_total, hold);
+    if(hold > s->hold_max) {
+        s->hold_max = hold;
+        aim_strlcpy(s->hold_max_api, held_api__, sizeof(s->hold_max_api));
+    }
+}
+
+#define ONLP_API_LOCK_STATS_INIT() onlp_api_lock_stats_init__()
+#define ONLP_API_LOCK_STATS_T0(_t0) uint64_t _t0 = aim_time_monotonic()
+#define ONLP_API_LOCK_STATS_ACQUIRED(_domain, _shared, _contended, _t0, _api) \
+    onlp_api_lock_stats_acquired__(_domain, _shared, _contended, _t0, _api)
+#define ONLP_API_LOCK_STATS_RELEASED(_domain)   \
+    onlp_api_lock_stats_released__(_domain)
+
+void
+onlp_api_lock_stats_show(aim_pvs_t* pvs)
+{
+    int i;
+
+    onlp_api_lock_stats_init__();
+
+    aim_printf(pvs, "%-8s %12s %12s %12s %10s %10s %10s %10s  %s\n",
+               "Domain", "Acquired", "Shared", "Contended",
+               "WaitAvg", "WaitMax", "HoldAvg", "HoldMax", "Owner");
+    for(i = 0; i < ONLP_API_LOCK_DOMAIN_COUNT; i++) {
+        onlp_api_lock_stats_t* s = stats__->domains + i;
+        if(s->acquisitions == 0) {
+            continue;
+        }
+        aim_printf(pvs, "%-8s %12"PRIu64" %12"PRIu64" %12"PRIu64" %10"PRIu64" %10"PRIu64" %10"PRIu64" %10"PRIu64"  %s\n",
+                   domain_names__[i], s->acquisitions, s->shared, s->contended,
+                   s->contended ? s->wait_total / s->contended : 0, s->wait_max,
+                   s->hold_total / s->acquisitions, s->hold_max,
+                   s->owner[0] ? s->owner : "-");
+    }
+    aim_printf(pvs, "\nTimes are in microseconds.\n");
+    for(i = 0; i < ONLP_API_LOCK_DOMAIN_COUNT; i++) {
+        onlp_api_lock_stats_t* s = stats__->domains + i;
+        if(s->wait_max_api[0] || s->hold_max_api[0]) {
+            aim_printf(pvs, "%-8s max wait: %s, max hold: %s\n", domain_names__[i],
+                       s->wait_max_api[0] ? s->wait_max_api : "-",
+                       s->hold_max_api[0] ? s->hold_max_api : "-");
+        }
+    }
+}
+
+void
+onlp_api_lock_stats_clear(void)
+{
+    onlp_api_lock_stats_init__();
+    memset(stats__->domains, 0, sizeof(stats__->domains));
+}
+
+#else
+
+#define ONLP_API_LOCK_STATS_INIT()
+#define ONLP_API_LOCK_STATS_T0(_t0)
+#define ONLP_API_LOCK_STATS_ACQUIRED(_domain, _shared, _contended, _t0, _api)
+#define ONLP_API_LOCK_STATS_RELEASED(_domain)
+
+void
+onlp_api_lock_stats_show(aim_pvs_t* pvs)
+{
+    aim_printf(pvs, "API lock statistics are not available in this build.\n");
+}
+
+void
+onlp_api_lock_stats_clear(void)
+{
+}
+
+#endif /* ONLP_CONFIG_INCLUDE_API_LOCK_STATS */
+
+
+#if ONLP_CONFIG_API_LOCK_DOMAINS == 0
+
+/************************************************************
+ *
+ * Single API lock.
+ *
+ * All lock domains map to the same lock.
+ *
+ ***********************************************************/
+
 #if ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 0
 
 #include <OS/os_sem.h>
@@ -43,6 +242,7 @@ void
 onlp_api_lock_init(void)
 {
     api_sem__ = os_sem_create_flags(1, OS_SEM_CREATE_F_TRUE_RELATIVE_TIMEOUTS);
+    ONLP_API_LOCK_STATS_INIT();
 }
 
 void
@@ -51,19 +251,32 @@ onlp_api_lock_denit(void)
     os_sem_destroy(api_sem__);
 }
 
-void
-onlp_api_lock(const char* api)
+/**
+ * Returns 1 if the lock was found held.
+ */
+static int
+onlp_api_lock__(const char* api)
 {
+    int contended = (owner__ != NULL);
+
     if(os_sem_take_timeout(api_sem__, ONLP_CONFIG_API_LOCK_TIMEOUT) != 0) {
         AIM_DIE("The ONLP API lock in %s could not be acquired after %d microseconds. It appears to be currently owned by call to %s. This is considered fatal.",
                 api, ONLP_CONFIG_API_LOCK_TIMEOUT, owner__ ? owner__ : "(none)");
     }
     owner__ = api;
+    return contended;
+}
+
+void
+onlp_api_lock(const char* api)
+{
+    onlp_api_lock__(api);
 }
 
 void
 onlp_api_unlock(void)
 {
+    owner__ = NULL;
     os_sem_give(api_sem__);
 }
 
@@ -75,6 +288,7 @@ void
 onlp_api_lock_init(void)
 {
     onlp_shlock_global_init();
+    ONLP_API_LOCK_STATS_INIT();
 }
 
 void
@@ -83,10 +297,23 @@ onlp_api_lock_denit(void)
     /* TODO */
 }
 
+/**
+ * Returns 1 if the lock was found held.
+ */
+static int
+onlp_api_lock__(const char* api)
+{
+    if(onlp_shlock_global_trytake() == 0) {
+        return 0;
+    }
+    onlp_shlock_global_take();
+    return 1;
+}
+
 void
 onlp_api_lock(const char* api)
 {
-    onlp_shlock_global_take();
+    onlp_api_lock__(api);
 }
 void
 onlp_api_unlock(void)
@@ -96,6 +323,422 @@ onlp_api_unlock(void)
 
 #endif
 
+void
+onlp_api_lock_domain(int domain, int index, int shared, const char* api)
+{
+    int contended;
+    ONLP_API_LOCK_STATS_T0(t0);
+    contended = onlp_api_lock__(api);
+    ONLP_API_LOCK_STATS_ACQUIRED(ONLP_API_LOCK_DOMAIN_GLOBAL, 0, contended, t0, api);
+    (void)contended;
+}
+
+void
+onlp_api_unlock_domain(int domain, int index, int shared)
+{
+    ONLP_API_LOCK_STATS_RELEASED(ONLP_API_LOCK_DOMAIN_GLOBAL);
+    onlp_api_unlock();
+}
+
+#else
+
+/************************************************************
+ *
+ * API Lock Domains.
+ *
+ * Each domain (and each port index within a domain) is a lock unit.
+ * Threads within the process are serialized by a reader/writer lock
+ * per unit. When the API lock is shared between processes each unit
+ * also owns a byte range in the API lock file which is locked with
+ * fcntl(). Record locks are released by the kernel if the owning
+ * process dies, so no recovery is required.
+ *
+ * Lock order is always GLOBAL -> domain -> index. The GLOBAL unit
+ * is taken shared by every other domain. A domain-wide shared lock
+ * also takes every index shared, so it excludes a per-port exclusive
+ * holder just as a per-port lock on that port would.
+ *
+ ***********************************************************/
+
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+
+#if ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 1
+static int lockfd__ = -1;
+#endif
+
+typedef struct onlp_api_lock_unit_s {
+    pthread_rwlock_t rwlock;
+    /** The current exclusive owner (for timeout diagnostics). */
+    const char* owner;
+#if ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 1
+    /** Process-local reference count for the shared record lock. */
+    pthread_mutex_t mutex;
+    int readers;
+    off_t start;
+    off_t len;
+#endif
+} onlp_api_lock_unit_t;
+
+typedef struct onlp_api_lock_domain_ctrl_s {
+    onlp_api_lock_unit_t unit;
+    onlp_api_lock_unit_t* indices;
+    /**
+     * Covers the record locks of all indices at once, so a domain-wide
+     * shared lock takes them with one fcntl() call.
+     */
+    onlp_api_lock_unit_t all;
+} onlp_api_lock_domain_ctrl_t;
+
+static onlp_api_lock_domain_ctrl_t domains__[ONLP_API_LOCK_DOMAIN_COUNT];
+static int initialized__ = 0;
+
+/**
+ * Each domain owns one byte in the lock file for itself followed by
+ * one byte per index. Index locks always hold their domain byte shared.
+ */
+#define ONLP_API_LOCK_DOMAIN_RANGE (ONLP_CONFIG_API_LOCK_INDEX_MAX + 1)
+
+static void
+onlp_api_lock_unit_init__(onlp_api_lock_unit_t* u, off_t start, off_t len)
+{
+    pthread_rwlockattr_t attr;
+
+    pthread_rwlockattr_init(&attr);
+    /* Writers must not be starved by a steady stream of queries. */
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    pthread_rwlock_init(&u->rwlock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+    u->owner = NULL;
+
+#if ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 1
+    pthread_mutex_init(&u->mutex, NULL);
+    u->readers = 0;
+    u->start = start;
+    u->len = len;
+#endif
+}
+
+#if ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 1
+/** The longest backoff after EDEADLK (usecs). */
+#define ONLP_API_LOCK_DEADLK_BACKOFF_MAX 100000
+
+/**
+ * Take or release a unit's record lock.
+ * Returns 1 if the record was found locked by another process.
+ */
+static int
+onlp_api_lock_record__(onlp_api_lock_unit_t* u, short type, const char* api)
+{
+    struct flock fl;
+    uint64_t deadline;
+    uint32_t backoff = 1000;
+
+    memset(&fl, 0, sizeof(fl));
+    fl.l_type = type;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = u->start;
+    fl.l_len = u->len;
+
+    if(fcntl(lockfd__, F_SETLK, &fl) == 0) {
+        return 0;
+    }
+    if(type == F_UNLCK || (errno != EAGAIN && errno != EACCES)) {
+        AIM_DIE("fcntl() on the ONLP API lock file failed: %{errno}", errno);
+    }
+
+    /* Held by another process. */
+    deadline = aim_time_monotonic() + ONLP_CONFIG_API_LOCK_TIMEOUT;
+    while(fcntl(lockfd__, F_SETLKW, &fl) < 0) {
+        if(errno == EINTR) {
+            continue;
+        }
+        if(errno != EDEADLK) {
+            AIM_DIE("fcntl() on the ONLP API lock file failed: %{errno}", errno);
+        }
+
+        /*
+         * The kernel found a cycle among the record locks of the
+         * processes involved. The other side may back off, so retry,
+         * but not for longer than the API lock timeout.
+         */
+        if(ONLP_CONFIG_API_LOCK_TIMEOUT > 0 && aim_time_monotonic() >= deadline) {
+            AIM_DIE("The ONLP API lock in %s could not be acquired after %d microseconds. It appears to be deadlocked with another process. This is considered fatal.",
+                    api, ONLP_CONFIG_API_LOCK_TIMEOUT);
+        }
+        usleep(backoff);
+        if(backoff < ONLP_API_LOCK_DEADLK_BACKOFF_MAX) {
+            backoff *= 2;
+        }
+    }
+    return 1;
+}
+#endif
+
+/**
+ * Take a unit's in-process lock only.
+ * Returns 1 if the unit was found held.
+ */
+static int
+onlp_api_lock_rwlock_take__(onlp_api_lock_unit_t* u, int shared, const char* api)
+{
+    int rv;
+    int contended = 0;
+
+    rv = (shared) ? pthread_rwlock_tryrdlock(&u->rwlock) :
+        pthread_rwlock_trywrlock(&u->rwlock);
+    if(rv == 0) {
+        goto locked;
+    }
+    contended = 1;
+
+#if ONLP_CONFIG_API_LOCK_TIMEOUT > 0
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ONLP_CONFIG_API_LOCK_TIMEOUT / 1000000;
+    ts.tv_nsec += (ONLP_CONFIG_API_LOCK_TIMEOUT % 1000000) * 1000;
+    if(ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    rv = (shared) ? pthread_rwlock_timedrdlock(&u->rwlock, &ts) :
+        pthread_rwlock_timedwrlock(&u->rwlock, &ts);
+#else
+    rv = (shared) ? pthread_rwlock_rdlock(&u->rwlock) :
+        pthread_rwlock_wrlock(&u->rwlock);
+#endif
+
+    if(rv != 0) {
+        AIM_DIE("The ONLP API lock in %s could not be acquired after %d microseconds. It appears to be currently owned by call to %s. This is considered fatal.",
+                api, ONLP_CONFIG_API_LOCK_TIMEOUT, u->owner ? u->owner : "(none)");
+    }
+
+ locked:
+    return contended;
+}
+
+/**
+ * Returns 1 if the unit was found held, by this process or another.
+ */
+static int
+onlp_api_lock_unit_take__(onlp_api_lock_unit_t* u, int shared, const char* api)
+{
+    int contended = onlp_api_lock_rwlock_take__(u, shared, api);
+
+#if ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 1
+    if(shared) {
+        pthread_mutex_lock(&u->mutex);
+        if(u->readers++ == 0) {
+            contended |= onlp_api_lock_record__(u, F_RDLCK, api);
+        }
+        pthread_mutex_unlock(&u->mutex);
+    }
+    else {
+        contended |= onlp_api_lock_record__(u, F_WRLCK, api);
+    }
+#endif
+
+    if(!shared) {
+        u->owner = api;
+    }
+    return contended;
+}
+
+static void
+onlp_api_lock_unit_give__(onlp_api_lock_unit_t* u, int shared)
+{
+#if ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 1
+    if(shared) {
+        pthread_mutex_lock(&u->mutex);
+        if(--u->readers == 0) {
+            onlp_api_lock_record__(u, F_UNLCK, NULL);
+        }
+        pthread_mutex_unlock(&u->mutex);
+    }
+    else {
+        onlp_api_lock_record__(u, F_UNLCK, NULL);
+    }
+#endif
+
+    if(!shared) {
+        u->owner = NULL;
+    }
+    pthread_rwlock_unlock(&u->rwlock);
+}
+
+void
+onlp_api_lock_init(void)
+{
+    int d, i;
+
+    if(initialized__) {
+        return;
+    }
+
+#if ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 1
+    lockfd__ = open(ONLP_CONFIG_API_LOCK_FILENAME, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if(lockfd__ < 0) {
+        AIM_DIE("Could not open the ONLP API lock file %s: %{errno}",
+                ONLP_CONFIG_API_LOCK_FILENAME, errno);
+    }
+#endif
+
+    for(d = 0; d < ONLP_API_LOCK_DOMAIN_COUNT; d++) {
+        off_t start = (off_t)d * ONLP_API_LOCK_DOMAIN_RANGE;
+        onlp_api_lock_unit_init__(&domains__[d].unit, start, 1);
+#if ONLP_CONFIG_API_LOCK_INDEXED == 1
+        if(d != ONLP_API_LOCK_DOMAIN_GLOBAL) {
+            domains__[d].indices = aim_zmalloc(sizeof(onlp_api_lock_unit_t) *
+                                               ONLP_CONFIG_API_LOCK_INDEX_MAX);
+            for(i = 0; i < ONLP_CONFIG_API_LOCK_INDEX_MAX; i++) {
+                onlp_api_lock_unit_init__(domains__[d].indices + i,
+                                          start + 1 + i, 1);
+            }
+            onlp_api_lock_unit_init__(&domains__[d].all, start + 1,
+                                      ONLP_CONFIG_API_LOCK_INDEX_MAX);
+        }
+#else
+        (void)i;
+#endif
+    }
+
+    ONLP_API_LOCK_STATS_INIT();
+    initialized__ = 1;
+}
+
+void
+onlp_api_lock_denit(void)
+{
+    int d;
+
+    for(d = 0; d < ONLP_API_LOCK_DOMAIN_COUNT; d++) {
+        aim_free(domains__[d].indices);
+        domains__[d].indices = NULL;
+    }
+#if ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 1
+    close(lockfd__);
+    lockfd__ = -1;
+#endif
+    initialized__ = 0;
+}
+
+static onlp_api_lock_unit_t*
+onlp_api_lock_index__(int domain, int index)
+{
+#if ONLP_CONFIG_API_LOCK_INDEXED == 1
+    if(index >= 0 && index < ONLP_CONFIG_API_LOCK_INDEX_MAX &&
+       domains__[domain].indices) {
+        return domains__[domain].indices + index;
+    }
+#endif
+    return NULL;
+}
+
+/**
+ * Take or release every index of a domain shared, for a domain-wide
+ * shared lock. The indices' in-process locks are taken one by one, in
+ * order, and their record locks with one range lock.
+ */
+static int
+onlp_api_lock_indices_take__(onlp_api_lock_domain_ctrl_t* dc, const char* api)
+{
+    int i;
+    int contended = 0;
+
+    for(i = 0; i < ONLP_CONFIG_API_LOCK_INDEX_MAX; i++) {
+        contended |= onlp_api_lock_rwlock_take__(dc->indices + i, 1, api);
+    }
+    contended |= onlp_api_lock_unit_take__(&dc->all, 1, api);
+    return contended;
+}
+
+static void
+onlp_api_lock_indices_give__(onlp_api_lock_domain_ctrl_t* dc)
+{
+    int i;
+
+    onlp_api_lock_unit_give__(&dc->all, 1);
+    for(i = ONLP_CONFIG_API_LOCK_INDEX_MAX - 1; i >= 0; i--) {
+        pthread_rwlock_unlock(&dc->indices[i].rwlock);
+    }
+}
+
+void
+onlp_api_lock_domain(int domain, int index, int shared, const char* api)
+{
+    onlp_api_lock_unit_t* iu = onlp_api_lock_index__(domain, index);
+    int contended;
+    ONLP_API_LOCK_STATS_T0(t0);
+
+#if ONLP_CONFIG_API_LOCK_SHARED_READERS == 0
+    shared = 0;
+#endif
+
+    if(domain == ONLP_API_LOCK_DOMAIN_GLOBAL) {
+        contended = onlp_api_lock_unit_take__(&domains__[domain].unit, shared, api);
+    }
+    else {
+        contended = onlp_api_lock_unit_take__(&domains__[ONLP_API_LOCK_DOMAIN_GLOBAL].unit, 1, api);
+        if(iu) {
+            contended |= onlp_api_lock_unit_take__(&domains__[domain].unit, 1, api);
+            contended |= onlp_api_lock_unit_take__(iu, shared, api);
+        }
+        else {
+            contended |= onlp_api_lock_unit_take__(&domains__[domain].unit, shared, api);
+            if(shared && domains__[domain].indices) {
+                contended |= onlp_api_lock_indices_take__(&domains__[domain], api);
+            }
+        }
+    }
+
+    ONLP_API_LOCK_STATS_ACQUIRED(domain, shared, contended, t0, api);
+    (void)contended;
+}
+
+void
+onlp_api_unlock_domain(int domain, int index, int shared)
+{
+    onlp_api_lock_unit_t* iu = onlp_api_lock_index__(domain, index);
+
+#if ONLP_CONFIG_API_LOCK_SHARED_READERS == 0
+    shared = 0;
+#endif
+
+    ONLP_API_LOCK_STATS_RELEASED(domain);
+
+    if(domain == ONLP_API_LOCK_DOMAIN_GLOBAL) {
+        onlp_api_lock_unit_give__(&domains__[domain].unit, shared);
+    }
+    else {
+        if(iu) {
+            onlp_api_lock_unit_give__(iu, shared);
+            onlp_api_lock_unit_give__(&domains__[domain].unit, 1);
+        }
+        else {
+            if(shared && domains__[domain].indices) {
+                onlp_api_lock_indices_give__(&domains__[domain]);
+            }
+            onlp_api_lock_unit_give__(&domains__[domain].unit, shared);
+        }
+        onlp_api_lock_unit_give__(&domains__[ONLP_API_LOCK_DOMAIN_GLOBAL].unit, 1);
+    }
+}
+
+void
+onlp_api_lock(const char* api)
+{
+    onlp_api_lock_domain(ONLP_API_LOCK_DOMAIN_GLOBAL, -1, 0, api);
+}
+
+void
+onlp_api_unlock(void)
+{
+    onlp_api_unlock_domain(ONLP_API_LOCK_DOMAIN_GLOBAL, -1, 0);
+}
+
+#endif /* ONLP_CONFIG_API_LOCK_DOMAINS */
 
 /*
  * This function will perform a sanity test on the API locking implementation.
@@ -123,6 +766,17 @@ ONLP_LOCKED_API0(onlp_api_lock_test);
 
 #else
 
+void
+onlp_api_lock_stats_show(aim_pvs_t* pvs)
+{
+    aim_printf(pvs, "API Locking support not available in this build.\n");
+}
+
+void
+onlp_api_lock_stats_clear(void)
+{
+}
+
 int
 onlp_api_lock_test(void)
 {
@@ -26,6 +26,44 @@
 #define __ONLP_LOCKS_H__
 
 #include <onlp/onlp_config.h>
+#include <AIM/aim_pvs.h>
+
+/**
+ * API Lock Domains
+ *
+ * By default all API calls are serialized behind a single lock.
+ * When ONLP_CONFIG_API_LOCK_DOMAINS is enabled each subsystem has its
+ * own lock domain. The GLOBAL domain is always taken (shared) by the
+ * other domains, so an exclusive GLOBAL operation still excludes
+ * everything.
+ *
+ * Each source file selects its domain by defining ONLP_API_LOCK_DOMAIN
+ * before including this header.
+ */
+typedef enum onlp_api_lock_domain_e {
+    ONLP_API_LOCK_DOMAIN_GLOBAL,
+    ONLP_API_LOCK_DOMAIN_THERMAL,
+    ONLP_API_LOCK_DOMAIN_FAN,
+    ONLP_API_LOCK_DOMAIN_PSU,
+    ONLP_API_LOCK_DOMAIN_LED,
+    ONLP_API_LOCK_DOMAIN_SFP,
+    ONLP_API_LOCK_DOMAIN_COUNT,
+} onlp_api_lock_domain_t;
+
+#ifndef ONLP_API_LOCK_DOMAIN
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_GLOBAL
+#endif
+
+/**
+ * @brief Show the API lock contention statistics.
+ * @param pvs The output pvs.
+ */
+void onlp_api_lock_stats_show(aim_pvs_t* pvs);
+
+/**
+ * @brief Clear the API lock contention statistics.
+ */
+void onlp_api_lock_stats_clear(void);
 
 #if ONLP_CONFIG_INCLUDE_API_LOCK == 1
 
@@ -45,16 +83,37 @@ void onlp_api_lock(const char* api);
  */
 void onlp_api_unlock(void);
 
+/**
+ * @brief Take an ONLP API lock domain.
+ * @param domain The lock domain.
+ * @param index The port index within the domain, or -1 for the entire domain.
+ * @param shared Take the lock in shared (read) mode.
+ * @param api The name of the API taking the lock.
+ */
+void onlp_api_lock_domain(int domain, int index, int shared, const char* api);
+
+/**
+ * @brief Give an ONLP API lock domain.
+ * @param domain The lock domain.
+ * @param index The port index within the domain, or -1 for the entire domain.
+ * @param shared The lock was taken in shared (read) mode.
+ */
+void onlp_api_unlock_domain(int domain, int index, int shared);
+
 
 #define ONLP_API_LOCK_INIT() onlp_api_lock_init()
-#define ONLP_API_LOCK(_api)      onlp_api_lock(_api)
-#define ONLP_API_UNLOCK()    onlp_api_unlock()
+#define ONLP_API_LOCK(_api)      onlp_api_lock_domain(ONLP_API_LOCK_DOMAIN, -1, 0, _api)
+#define ONLP_API_UNLOCK()    onlp_api_unlock_domain(ONLP_API_LOCK_DOMAIN, -1, 0)
+#define ONLP_API_LOCK_EX(_index, _shared, _api) onlp_api_lock_domain(ONLP_API_LOCK_DOMAIN, _index, _shared, _api)
+#define ONLP_API_UNLOCK_EX(_index, _shared) onlp_api_unlock_domain(ONLP_API_LOCK_DOMAIN, _index, _shared)
 
 #else
 
 #define ONLP_API_LOCK_INIT()
 #define ONLP_API_LOCK(_api)
 #define ONLP_API_UNLOCK()
+#define ONLP_API_LOCK_EX(_index, _shared, _api)
+#define ONLP_API_UNLOCK_EX(_index, _shared)
 
 #endif /** ONLP_CONFIG_INCLUDE_API_LOCK */
 
@@ -64,6 +123,11 @@ void onlp_api_unlock(void);
  * These macros are used the instantiate the public (and potentially locked)
  * ONLP API entry points.
  *
+ * ONLP_LOCKED_API*      Exclusive access to the domain.
+ * ONLP_LOCKED_RAPI*     Shared access to the domain (pure queries).
+ * ONLP_LOCKED_PORT_API* Exclusive access to the port given by the first argument.
+ * ONLP_LOCKED_PORT_RAPI* Shared access to the port given by the first argument.
+ *
  ***************************************************************************/
 #include <inttypes.h>
 #include <AIM/aim_time.h>
@@ -93,86 +157,128 @@ void onlp_api_unlock(void);
 
 #endif
 
-#define ONLP_LOCKED_API0(_name)                            \
+#define ONLP_LOCKED_API0_EX__(_name, _index, _shared)      \
     int _name (void)                                       \
     {                                                      \
         ONLP_API_T0(_name);                                \
-        ONLP_API_LOCK(#_name);                             \
+        ONLP_API_LOCK_EX(_index, _shared, #_name);         \
         ONLP_API_T1(_name);                                \
         int _rv = ONLP_LOCKED_API_NAME(_name)();           \
-        ONLP_API_UNLOCK();                                 \
+        ONLP_API_UNLOCK_EX(_index, _shared);               \
         ONLP_API_T2(_name);                                \
         return _rv;                                        \
     }
 
-#define ONLP_LOCKED_API1(_name, _t, _v)                         \
+#define ONLP_LOCKED_API1_EX__(_name, _index, _shared, _t, _v)   \
     int _name (_t _v)                                           \
     {                                                           \
         ONLP_API_T0(_name);                                     \
-        ONLP_API_LOCK(#_name);                                  \
+        ONLP_API_LOCK_EX(_index, _shared, #_name);              \
         ONLP_API_T1(_name);                                     \
         int _rv = ONLP_LOCKED_API_NAME(_name)(_v);              \
-        ONLP_API_UNLOCK();                                      \
+        ONLP_API_UNLOCK_EX(_index, _shared);                    \
         ONLP_API_T2(_name);                                     \
         return _rv;                                             \
     }
 
-#define ONLP_LOCKED_API2(_name, _t1, _v1, _t2, _v2)                     \
+#define ONLP_LOCKED_API2_EX__(_name, _index, _shared, _t1, _v1, _t2, _v2) \
     int _name (_t1 _v1, _t2 _v2)                                        \
     {                                                                   \
         ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
+        ONLP_API_LOCK_EX(_index, _shared, #_name);                      \
         ONLP_API_T1(_name);                                             \
         int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2);               \
-        ONLP_API_UNLOCK();                                              \
+        ONLP_API_UNLOCK_EX(_index, _shared);                            \
         ONLP_API_T2(_name);                                             \
         return _rv;                                                     \
     }
 
-#define ONLP_LOCKED_API3(_name, _t1, _v1, _t2, _v2, _t3, _v3)           \
+#define ONLP_LOCKED_API3_EX__(_name, _index, _shared, _t1, _v1, _t2, _v2, _t3, _v3) \
     int _name (_t1 _v1, _t2 _v2, _t3 _v3)                               \
     {                                                                   \
         ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
+        ONLP_API_LOCK_EX(_index, _shared, #_name);                      \
         ONLP_API_T1(_name);                                             \
         int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3);          \
-        ONLP_API_UNLOCK();                                              \
+        ONLP_API_UNLOCK_EX(_index, _shared);                            \
         ONLP_API_T2(_name);                                             \
         return _rv;                                                     \
     }
 
-#define ONLP_LOCKED_API4(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4) \
+#define ONLP_LOCKED_API4_EX__(_name, _index, _shared, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4) \
     int _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4)                      \
     {                                                                   \
         ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
+        ONLP_API_LOCK_EX(_index, _shared, #_name);                      \
         ONLP_API_T1(_name);                                             \
         int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4);     \
-        ONLP_API_UNLOCK();                                              \
+        ONLP_API_UNLOCK_EX(_index, _shared);                            \
         ONLP_API_T2(_name);                                             \
         return _rv;                                                     \
     }
 
-#define ONLP_LOCKED_API5(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5) \
+#define ONLP_LOCKED_API5_EX__(_name, _index, _shared, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5) \
     int _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4, _t5 _v5)             \
     {                                                                   \
         ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
+        ONLP_API_LOCK_EX(_index, _shared, #_name);                      \
         ONLP_API_T1(_name);                                             \
         int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4, _v5); \
-        ONLP_API_UNLOCK();                                              \
+        ONLP_API_UNLOCK_EX(_index, _shared);                            \
+        ONLP_API_T2(_name);                                             \
+        return _rv;                                                     \
+    }
+
+#define ONLP_LOCKED_API6_EX__(_name, _index, _shared, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5, _t6, _v6) \
+    int _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4, _t5 _v5, _t6 _v6)    \
+    {                                                                   \
+        ONLP_API_T0(_name);                                             \
+        ONLP_API_LOCK_EX(_index, _shared, #_name);                      \
+        ONLP_API_T1(_name);                                             \
+        int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4, _v5, _v6); \
+        ONLP_API_UNLOCK_EX(_index, _shared);                            \
         ONLP_API_T2(_name);                                             \
         return _rv;                                                     \
     }
 
+#define ONLP_LOCKED_API0(_name) ONLP_LOCKED_API0_EX__(_name, -1, 0)
+#define ONLP_LOCKED_API1(_name, ...) ONLP_LOCKED_API1_EX__(_name, -1, 0, __VA_ARGS__)
+#define ONLP_LOCKED_API2(_name, ...) ONLP_LOCKED_API2_EX__(_name, -1, 0, __VA_ARGS__)
+#define ONLP_LOCKED_API3(_name, ...) ONLP_LOCKED_API3_EX__(_name, -1, 0, __VA_ARGS__)
+#define ONLP_LOCKED_API4(_name, ...) ONLP_LOCKED_API4_EX__(_name, -1, 0, __VA_ARGS__)
+#define ONLP_LOCKED_API5(_name, ...) ONLP_LOCKED_API5_EX__(_name, -1, 0, __VA_ARGS__)
+#define ONLP_LOCKED_API6(_name, ...) ONLP_LOCKED_API6_EX__(_name, -1, 0, __VA_ARGS__)
+
+#define ONLP_LOCKED_RAPI0(_name) ONLP_LOCKED_API0_EX__(_name, -1, 1)
+#define ONLP_LOCKED_RAPI1(_name, ...) ONLP_LOCKED_API1_EX__(_name, -1, 1, __VA_ARGS__)
+#define ONLP_LOCKED_RAPI2(_name, ...) ONLP_LOCKED_API2_EX__(_name, -1, 1, __VA_ARGS__)
+#define ONLP_LOCKED_RAPI3(_name, ...) ONLP_LOCKED_API3_EX__(_name, -1, 1, __VA_ARGS__)
+#define ONLP_LOCKED_RAPI4(_name, ...) ONLP_LOCKED_API4_EX__(_name, -1, 1, __VA_ARGS__)
+#define ONLP_LOCKED_RAPI5(_name, ...) ONLP_LOCKED_API5_EX__(_name, -1, 1, __VA_ARGS__)
+#define ONLP_LOCKED_RAPI6(_name, ...) ONLP_LOCKED_API6_EX__(_name, -1, 1, __VA_ARGS__)
+
+#define ONLP_LOCKED_PORT_API1(_name, _t1, _v1) ONLP_LOCKED_API1_EX__(_name, _v1, 0, _t1, _v1)
+#define ONLP_LOCKED_PORT_API2(_name, _t1, _v1, ...) ONLP_LOCKED_API2_EX__(_name, _v1, 0, _t1, _v1, __VA_ARGS__)
+#define ONLP_LOCKED_PORT_API3(_name, _t1, _v1, ...) ONLP_LOCKED_API3_EX__(_name, _v1, 0, _t1, _v1, __VA_ARGS__)
+#define ONLP_LOCKED_PORT_API4(_name, _t1, _v1, ...) ONLP_LOCKED_API4_EX__(_name, _v1, 0, _t1, _v1, __VA_ARGS__)
+#define ONLP_LOCKED_PORT_API5(_name, _t1, _v1, ...) ONLP_LOCKED_API5_EX__(_name, _v1, 0, _t1, _v1, __VA_ARGS__)
+#define ONLP_LOCKED_PORT_API6(_name, _t1, _v1, ...) ONLP_LOCKED_API6_EX__(_name, _v1, 0, _t1, _v1, __VA_ARGS__)
+
+#define ONLP_LOCKED_PORT_RAPI1(_name, _t1, _v1) ONLP_LOCKED_API1_EX__(_name, _v1, 1, _t1, _v1)
+#define ONLP_LOCKED_PORT_RAPI2(_name, _t1, _v1, ...) ONLP_LOCKED_API2_EX__(_name, _v1, 1, _t1, _v1, __VA_ARGS__)
+#define ONLP_LOCKED_PORT_RAPI3(_name, _t1, _v1, ...) ONLP_LOCKED_API3_EX__(_name, _v1, 1, _t1, _v1, __VA_ARGS__)
+#define ONLP_LOCKED_PORT_RAPI4(_name, _t1, _v1, ...) ONLP_LOCKED_API4_EX__(_name, _v1, 1, _t1, _v1, __VA_ARGS__)
+#define ONLP_LOCKED_PORT_RAPI5(_name, _t1, _v1, ...) ONLP_LOCKED_API5_EX__(_name, _v1, 1, _t1, _v1, __VA_ARGS__)
+#define ONLP_LOCKED_PORT_RAPI6(_name, _t1, _v1, ...) ONLP_LOCKED_API6_EX__(_name, _v1, 1, _t1, _v1, __VA_ARGS__)
+
 #define ONLP_LOCKED_VAPI0(_name)                                 \
     void _name (void)                                            \
     {                                                            \
         ONLP_API_T0(_name);                                      \
-        ONLP_API_LOCK(#_name);                                   \
+        ONLP_API_LOCK_EX(-1, 0, #_name);                         \
         ONLP_API_T1(_name);                                      \
         ONLP_LOCKED_API_NAME(_name)();                           \
-        ONLP_API_UNLOCK();                                       \
+        ONLP_API_UNLOCK_EX(-1, 0);                               \
         ONLP_API_T2(_name);                                      \
     }
 
@@ -180,10 +286,10 @@ void onlp_api_unlock(void);
     void _name (_t _v)                                    \
     {                                                     \
         ONLP_API_T0(_name);                               \
-        ONLP_API_LOCK(#_name);                            \
+        ONLP_API_LOCK_EX(-1, 0, #_name);                  \
         ONLP_API_T1(_name);                               \
         ONLP_LOCKED_API_NAME(_name)(_v);                  \
-        ONLP_API_UNLOCK();                                \
+        ONLP_API_UNLOCK_EX(-1, 0);                        \
         ONLP_API_T2(_name);                               \
     }
 
@@ -191,10 +297,10 @@ void onlp_api_unlock(void);
     void _name (_t1 _v1, _t2 _v2)                                 \
     {                                                             \
         ONLP_API_T0(_name);                                       \
-        ONLP_API_LOCK(#_name);                                    \
+        ONLP_API_LOCK_EX(-1, 0, #_name);                          \
         ONLP_API_T1(_name);                                       \
         ONLP_LOCKED_API_NAME(_name) (_v1, _v2);                   \
-        ONLP_API_UNLOCK();                                        \
+        ONLP_API_UNLOCK_EX(-1, 0);                                \
         ONLP_API_T2(_name);                                       \
     }
 
@@ -202,21 +308,21 @@ void onlp_api_unlock(void);
     void _name (_t1 _v1, _t2 _v2, _t3 _v3)                              \
     {                                                                   \
         ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
+        ONLP_API_LOCK_EX(-1, 0, #_name);                                \
         ONLP_API_T1(_name);                                             \
         ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3);                    \
-        ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2(name);                                              \
+        ONLP_API_UNLOCK_EX(-1, 0);                                      \
+        ONLP_API_T2(_name);                                             \
     }
 
 #define ONLP_LOCKED_VAPI4(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4) \
     void _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4)                     \
     {                                                                   \
         ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
+        ONLP_API_LOCK_EX(-1, 0, #_name);                                \
         ONLP_API_T1(_name);                                             \
         ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4);               \
-        ONLP_API_UNLOCK();                                              \
+        ONLP_API_UNLOCK_EX(-1, 0);                                      \
         ONLP_API_T2(_name);                                             \
     }
 
@@ -224,10 +330,10 @@ void onlp_api_unlock(void);
     void _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4, _t5 _v5)            \
     {                                                                   \
         ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
+        ONLP_API_LOCK_EX(-1, 0, #_name);                                \
         ONLP_API_T1(_name);                                             \
         ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4, _v5);          \
-        ONLP_API_UNLOCK();                                              \
+        ONLP_API_UNLOCK_EX(-1, 0);                                      \
         ONLP_API_T2(_name);                                             \
     }
 
@@ -27,11 +27,17 @@
 #include <unistd.h>
 #include <onlp/sys.h>
 #include <onlp/sfp.h>
+#include <onlp/fan_control.h>
+#include <onlp/cmis.h>
 #include <sff/sff.h>
 #include <sff/sff_db.h>
 #include <AIM/aim_log_handler.h>
+#include <OS/os_time.h>
 #include <syslog.h>
 #include <onlp/platformi/sysi.h>
+#include "onlp_cache.h"
+#include "onlp_locks.h"
+#include "onlp_bench.h"
 
 static void platform_manager_daemon__(const char* pidfile, char** argv);
 
@@ -52,6 +58,13 @@ show_inventory__(aim_pvs_t* pvs, int database)
         aim_printf(pvs, "No SFPs on this platform.\n");
     }
     else {
+        /* One status vector read serves the whole table. */
+        onlp_sfp_status_bitmaps_t* sv = aim_zmalloc(sizeof(*sv));
+        if(onlp_sfp_status_bitmaps_get(sv) < 0) {
+            aim_free(sv);
+            sv = NULL;
+        }
+
         if(!database) {
             aim_printf(pvs, "Port  Type            Media   Status  Len    Vendor            Model             S/N             \n");
             aim_printf(pvs, "----  --------------  ------  ------  -----  ----------------  ----------------  ----------------\n");
@@ -100,7 +113,7 @@ show_inventory__(aim_pvs_t* pvs, int database)
 
             uint32_t status = 0;
             char* cp = status_str;
-            onlp_sfp_control_flags_get(port, &status);
+            onlp_sfp_control_flags_status_get(port, sv, &status);
             if(status & ONLP_SFP_CONTROL_FLAG_RX_LOS) {
                 *cp++ = 'R';
             }
@@ -126,6 +139,7 @@ show_inventory__(aim_pvs_t* pvs, int database)
                        sff.info.model,
                        sff.info.serial);
         }
+        aim_free(sv);
     }
 }
 
@@ -163,6 +177,65 @@ iterate_oids__(void)
                      iterate_oids_callback__, NULL);
 }
 
+/**
+ * Bring up CMIS modules and show the per-port timing.
+ */
+static int
+cmis_run__(int argc, char* argv[], int timeout)
+{
+    int i;
+    int port;
+    onlp_sfp_bitmap_t ports;
+    uint64_t deadline = os_time_monotonic() + timeout * 1000000ULL;
+
+    onlp_sfp_bitmap_t_init(&ports);
+    if(argc) {
+        for(i = 0; i < argc; i++) {
+            AIM_BITMAP_SET(&ports, atoi(argv[i]));
+        }
+    }
+    else {
+        onlp_sfp_bitmap_get(&ports);
+    }
+
+    AIM_BITMAP_ITER(&ports, port) {
+        if(onlp_cmis_port_enable(port, NULL) < 0) {
+            fprintf(stderr, "port %d is not a valid SFP port.\n", port);
+            return 1;
+        }
+    }
+
+    /* Run until every port has settled. */
+    while(os_time_monotonic() < deadline) {
+        uint64_t next;
+        int busy = 0;
+
+        onlp_cmis_poll(&next);
+        AIM_BITMAP_ITER(&ports, port) {
+            onlp_cmis_port_status_t status;
+            onlp_cmis_port_status_get(port, &status);
+            switch(status.state)
+                {
+                case ONLP_CMIS_STATE_INSERTED:
+                case ONLP_CMIS_STATE_MODULE_PWRUP:
+                case ONLP_CMIS_STATE_APP_CONFIG:
+                case ONLP_CMIS_STATE_DP_INIT:
+                    busy = 1;
+                    break;
+                default:
+                    break;
+                }
+        }
+        if(!busy) {
+            break;
+        }
+        os_sleep_usecs(next);
+    }
+
+    onlp_cmis_show(&aim_pvs_stdout);
+    return 0;
+}
+
 
 
 
@@ -184,6 +257,9 @@ onlpdump_main(int argc, char* argv[])
     int l = 0;
     int M = 0;
     int b = 0;
+    int C = 0;
+    int L = 0;
+    int I = 0;
     char* pidfile = NULL;
     const char* O = NULL;
     const char* t = NULL;
@@ -195,6 +271,9 @@ onlpdump_main(int argc, char* argv[])
     if(argc > 1 && (!strcmp(argv[1], "debug") || !strcmp(argv[1], "debugi"))) {
         if(!strcmp(argv[1], "debug")) {
             onlp_init();
+            if(argc == 4 && !strcmp(argv[2], "script")) {
+                return onlp_sys_debug_script(&aim_pvs_stdout, argv[3]);
+            }
             return onlp_sys_debug(&aim_pvs_stdout, argc-2, argv+2);
         }
         else {
@@ -202,7 +281,63 @@ onlpdump_main(int argc, char* argv[])
         }
     }
 
-    while( (c = getopt(argc, argv, "srehdojmyM:ipxlSt:O:bJ:")) != -1) {
+    /**
+     * fan control replay trap
+     */
+    if(argc > 1 && !strcmp(argv[1], "fanctl")) {
+        onlp_fan_control_policy_t* policy;
+        if(argc != 4) {
+            fprintf(stderr, "usage: %s fanctl <policy.json> <trace.csv>\n", argv[0]);
+            return 1;
+        }
+        if(ONLP_FAILURE(rv = onlp_fan_control_policy_load(argv[2], &policy))) {
+            return 1;
+        }
+        rv = onlp_fan_control_replay(policy, argv[3], &aim_pvs_stdout);
+        aim_free(policy);
+        return ONLP_FAILURE(rv) ? 1 : 0;
+    }
+
+    /**
+     * API latency benchmark trap
+     */
+    if(argc > 1 && !strcmp(argv[1], "bench")) {
+        int iterations = 100, threads = 1, processes = 1;
+        while( (c = getopt(argc-1, argv+1, "n:T:P:")) != -1) {
+            switch(c)
+                {
+                case 'n': iterations = atoi(optarg); break;
+                case 'T': threads = atoi(optarg); break;
+                case 'P': processes = atoi(optarg); break;
+                default:
+                    fprintf(stderr, "usage: %s bench [-n iterations] [-T threads] [-P processes]\n", argv[0]);
+                    return 1;
+                }
+        }
+        onlp_init();
+        rv = onlp_bench_run(iterations, threads, processes, &aim_pvs_stdout);
+        return ONLP_FAILURE(rv) ? 1 : 0;
+    }
+
+    /**
+     * CMIS bring-up trap
+     */
+    if(argc > 1 && !strcmp(argv[1], "cmis")) {
+        int timeout = 120;
+        while( (c = getopt(argc-1, argv+1, "t:")) != -1) {
+            switch(c)
+                {
+                case 't': timeout = atoi(optarg); break;
+                default:
+                    fprintf(stderr, "usage: %s cmis [-t seconds] [port ...]\n", argv[0]);
+                    return 1;
+                }
+        }
+        onlp_init();
+        return cmis_run__(argc - 1 - optind, argv + 1 + optind, timeout);
+    }
+
+    while( (c = getopt(argc, argv, "srehdojmyM:ipxlSt:O:bJ:CLI")) != -1) {
         switch(c)
             {
             case 's': show=1; break;
@@ -223,6 +358,9 @@ onlpdump_main(int argc, char* argv[])
             case 'l': l=1; break;
             case 'b': b=1; break;
             case 'J': J = optarg; break;
+            case 'C': C=1; break;
+            case 'L': L=1; break;
+            case 'I': I=1; break;
             case 'y': show=1; showflags |= ONLP_OID_SHOW_YAML; break;
             default: help=1; rv = 1; break;
             }
@@ -238,7 +376,7 @@ onlpdump_main(int argc, char* argv[])
         printf("  -o   Dump ONIE data only.\n");
         printf("  -x   Dump Platform Info only.\n");
         printf("  -j   Dump ONIE data in JSON format.\n");
-        printf("  -m   Run platform manager.\n");
+        printf("  -m   Run platform manager and show callback statistics.\n");
         printf("  -M   Run as platform manager daemon.\n");
         printf("  -i   Iterate OIDs.\n");
         printf("  -p   Show SFP presence.\n");
@@ -248,6 +386,12 @@ onlpdump_main(int argc, char* argv[])
         printf("  -b   Decode SFP Inventory into SFF database entries.\n");
         printf("  -l   API Lock test.\n");
         printf("  -J   Decode ONIE JSON data.\n");
+        printf("  -C   Show OID cache, OID registry and system inventory cache statistics.\n");
+        printf("  -I   Discard the system inventory snapshot (after writing the ONIE EEPROM).\n");
+        printf("  -L   Show API lock statistics.\n");
+        printf("  fanctl <policy.json> <trace.csv>  Replay a thermal trace through a fan control policy.\n");
+        printf("  bench [-n iterations] [-T threads] [-P processes]  Measure ONLP API latency (JSON).\n");
+        printf("  cmis [-t seconds] [port ...]  Bring up CMIS modules and show their bring-up timing.\n");
         return rv;
     }
 
@@ -299,6 +443,23 @@ onlpdump_main(int argc, char* argv[])
         }
     }
 
+    if(C) {
+        onlp_cache_show(&aim_pvs_stdout);
+        onlp_oid_registry_show(&aim_pvs_stdout);
+        onlp_sys_info_cache_show(&aim_pvs_stdout);
+        return 0;
+    }
+
+    if(L) {
+        onlp_api_lock_stats_show(&aim_pvs_stdout);
+        return 0;
+    }
+
+    if(I) {
+        onlp_sys_info_invalidate();
+        return 0;
+    }
+
     if(S) {
         show_inventory__(&aim_pvs_stdout, b);
         return 0;
@@ -367,6 +528,7 @@ onlpdump_main(int argc, char* argv[])
         sleep(600);
         printf("Stopping the platform manager.\n");
         onlp_sys_platform_manage_stop(1);
+        onlp_sys_platform_manage_stats_show(&aim_pvs_stdout);
     }
 
     if(p) {
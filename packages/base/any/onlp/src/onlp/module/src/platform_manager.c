@@ -25,6 +25,8 @@
 #include <onlp/sys.h>
 #include <onlp/psu.h>
 #include <onlp/fan.h>
+#include <onlp/sfp.h>
+#include <onlp/thermal.h>
 #include <onlp/platformi/sysi.h>
 #include <onlplib/mmap.h>
 #include <timer_wheel/timer_wheel.h>
@@ -36,6 +38,7 @@
 #include <sys/eventfd.h>
 #include <errno.h>
 #include <pthread.h>
+#include <limits.h>
 
 /**
  * Timer wheel callback entry.
@@ -44,18 +47,49 @@ typedef struct management_entry_s {
     /** Timer wheel for this entry */
     timer_wheel_entry_t twe;
 
-    /** This is the callback for this timer */
+    /** This is the callback for this timer (built-in entries) */
     int (*manage)(void);
 
+    /** This is the callback for this timer (registered entries) */
+    onlp_sys_platform_manage_f handler;
+
+    /** Passed to the handler */
+    void* cookie;
+
     /** This is the callback rate in microseconds */
     uint64_t rate;
 
     /** The name of this callback (for debugging) */
-    const char* name;
+    char name[32];
 
     /** The number of times this has been called. */
     int calls;
 
+    /** The number of calls which returned an error. */
+    int errors;
+
+    /** The number of calls which ran longer than the callback rate. */
+    int overruns;
+
+    /** Callback runtime in microseconds. */
+    uint64_t runtime_total;
+    uint64_t runtime_max;
+
+    /** Largest delay past the deadline in microseconds. */
+    uint64_t late_max;
+
+    /** The entry is being called outside of the management lock. */
+    int running;
+
+    /** The entry was unregistered while running. */
+    int removed;
+
+    /** The entry was allocated by onlp_sys_platform_manage_register() */
+    int dynamic;
+
+    /** All entries. */
+    struct management_entry_s* next;
+
 } management_entry_t;
 
 /**
@@ -67,10 +101,22 @@ typedef struct management_ctrl_s {
     int eventfd;
     pthread_t thread;
 
+    /** Protects the timer wheel and the entry list. */
+    pthread_mutex_t lock;
+    management_entry_t* entries;
+
+    /** The thread has been asked to exit (the eventfd also wakes it). */
+    int exit;
+
 } management_ctrl_t;
 
 /* This is the global control state */
-static management_ctrl_t control__ = { NULL };
+static management_ctrl_t control__ = { NULL, 0, 0, PTHREAD_MUTEX_INITIALIZER, NULL, 0 };
+
+/*
+ * Callbacks may not run more often than this (microseconds).
+ */
+#define MANAGEMENT_RATE_MIN 10000
 
 
 /*
@@ -86,25 +132,34 @@ static int platform_psus_notify__(void);
  */
 static int platform_fans_notify__(void);
 
+/*
+ * Platform fan management with adaptive rate.
+ */
+static int platform_fans_manage__(void* cookie, uint64_t* rate);
+
+static int platform_oids_get__(onlp_oid_type_t type, onlp_oid_t** table);
 
 
 /*
- * First Version : Static callback rates.
- * TODO: Allow individual platform callbacks to reregister
- * themselves at whatever rate they want.
+ * Built-in callbacks. Platforms and other modules can add their
+ * own with onlp_sys_platform_manage_register().
  */
 static management_entry_t management_entries[] =
     {
         {
             { },
-            onlp_sysi_platform_manage_fans,
-            /* Every 10 seconds */
+            NULL,
+            platform_fans_manage__,
+            NULL,
+            /* Every 10 seconds, adjusted by thermal headroom */
             10*1000*1000,
             "Fans",
         },
         {
             { },
             onlp_sysi_platform_manage_leds,
+            NULL,
+            NULL,
             /* Every 2 seconds */
             2*1000*1000,
             "LEDs",
@@ -113,16 +168,29 @@ static management_entry_t management_entries[] =
         {
             { },
             platform_psus_notify__,
+            NULL,
+            NULL,
             /* Every second */
             1*1000*1000,
-            "PSUs",
+            "PSU Status",
         },
         {
             { },
             platform_fans_notify__,
+            NULL,
+            NULL,
             /* Every second */
             1*1000*1000,
-            "Fans",
+            "Fan Status",
+        },
+        {
+            { },
+            onlp_sfp_notify_poll,
+            NULL,
+            NULL,
+            /* SFP presence and RX_LOS subscribers */
+            ONLP_CONFIG_SFP_NOTIFY_POLL_MS*1000,
+            "SFPs",
         }
     };
 
@@ -134,16 +202,158 @@ onlp_sys_platform_manage_init(void)
         int i;
         uint64_t now = os_time_monotonic();
 
-        onlp_sysi_platform_manage_init();
+        pthread_mutex_lock(&control__.lock);
         control__.tw = timer_wheel_create(4, 512, now);
-
         for(i = 0; i < AIM_ARRAYSIZE(management_entries); i++) {
             management_entry_t* e = management_entries+i;
+            e->next = control__.entries;
+            control__.entries = e;
             timer_wheel_insert(control__.tw,  &e->twe, now + e->rate);
         }
+        pthread_mutex_unlock(&control__.lock);
+
+        /* The platform may register its own callbacks here. */
+        onlp_sysi_platform_manage_init();
+    }
+}
+
+/*
+ * Wake the management thread so it recomputes its next deadline.
+ * Called with the lock held.
+ */
+static void
+management_wake_locked__(void)
+{
+    if(control__.eventfd > 0) {
+        uint64_t one = 1;
+        if(write(control__.eventfd, &one, sizeof(one)) < 0) {
+            AIM_LOG_ERROR("eventfd write failed: %{errno}", errno);
+        }
+    }
+}
+
+static management_entry_t*
+management_entry_find__(onlp_sys_platform_manage_f handler, void* cookie)
+{
+    management_entry_t* e;
+    for(e = control__.entries; e; e = e->next) {
+        if(e->handler == handler && e->cookie == cookie && !e->removed) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void
+management_entry_unlink__(management_entry_t* e)
+{
+    management_entry_t** ep;
+    for(ep = &control__.entries; *ep; ep = &(*ep)->next) {
+        if(*ep == e) {
+            *ep = e->next;
+            break;
+        }
+    }
+    if(e->dynamic) {
+        aim_free(e);
     }
 }
 
+int
+onlp_sys_platform_manage_register(const char* name,
+                                  onlp_sys_platform_manage_f handler,
+                                  void* cookie, uint64_t rate)
+{
+    management_entry_t* e;
+
+    if(handler == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    onlp_sys_platform_manage_init();
+
+    pthread_mutex_lock(&control__.lock);
+    if(management_entry_find__(handler, cookie)) {
+        pthread_mutex_unlock(&control__.lock);
+        return ONLP_STATUS_E_PARAM;
+    }
+    e = aim_zmalloc(sizeof(*e));
+    e->handler = handler;
+    e->cookie = cookie;
+    e->rate = (rate < MANAGEMENT_RATE_MIN) ? MANAGEMENT_RATE_MIN : rate;
+    aim_strlcpy(e->name, (name) ? name : "", sizeof(e->name));
+    e->dynamic = 1;
+    e->next = control__.entries;
+    control__.entries = e;
+    timer_wheel_insert(control__.tw, &e->twe, os_time_monotonic() + e->rate);
+    /* The thread may be sleeping past the new deadline. */
+    management_wake_locked__();
+    pthread_mutex_unlock(&control__.lock);
+
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sys_platform_manage_unregister(onlp_sys_platform_manage_f handler,
+                                    void* cookie)
+{
+    management_entry_t* e;
+    int rv = ONLP_STATUS_E_PARAM;
+
+    pthread_mutex_lock(&control__.lock);
+    if( (e = management_entry_find__(handler, cookie)) ) {
+        if(e->running) {
+            /* Released by the management thread when the call returns. */
+            e->removed = 1;
+        }
+        else {
+            timer_wheel_remove(control__.tw, &e->twe);
+            management_entry_unlink__(e);
+        }
+        rv = ONLP_STATUS_OK;
+    }
+    pthread_mutex_unlock(&control__.lock);
+    return rv;
+}
+
+int
+onlp_sys_platform_manage_rate_set(onlp_sys_platform_manage_f handler,
+                                  void* cookie, uint64_t rate)
+{
+    management_entry_t* e;
+    int rv = ONLP_STATUS_E_PARAM;
+
+    pthread_mutex_lock(&control__.lock);
+    if( (e = management_entry_find__(handler, cookie)) ) {
+        e->rate = (rate < MANAGEMENT_RATE_MIN) ? MANAGEMENT_RATE_MIN : rate;
+        rv = ONLP_STATUS_OK;
+    }
+    pthread_mutex_unlock(&control__.lock);
+    return rv;
+}
+
+void
+onlp_sys_platform_manage_stats_show(aim_pvs_t* pvs)
+{
+    management_entry_t* e;
+
+    aim_printf(pvs, "%-16s %10s %8s %8s %8s %12s %12s %12s %12s\n",
+               "Name", "Rate(ms)", "Calls", "Errors", "Overruns",
+               "Avg(us)", "Max(us)", "LateMax(us)", "Total(ms)");
+
+    pthread_mutex_lock(&control__.lock);
+    for(e = control__.entries; e; e = e->next) {
+        aim_printf(pvs, "%-16s %10llu %8d %8d %8d %12llu %12llu %12llu %12llu\n",
+                   e->name,
+                   (unsigned long long)(e->rate / 1000),
+                   e->calls, e->errors, e->overruns,
+                   (unsigned long long)((e->calls) ? e->runtime_total / e->calls : 0),
+                   (unsigned long long)e->runtime_max,
+                   (unsigned long long)e->late_max,
+                   (unsigned long long)(e->runtime_total / 1000));
+    }
+    pthread_mutex_unlock(&control__.lock);
+}
 
 void
 onlp_sys_platform_manage_now(void)
@@ -152,14 +362,60 @@ onlp_sys_platform_manage_now(void)
 
     onlp_sys_platform_manage_init();
 
+    pthread_mutex_lock(&control__.lock);
     while( (e = (management_entry_t*) timer_wheel_next(control__.tw,
                                                        os_time_monotonic())) ) {
-        if(e->manage) {
-            e->manage();
+        int rv;
+        uint64_t start, runtime;
+        uint64_t rate0 = e->rate;
+        uint64_t rate = rate0;
+        uint64_t deadline = e->twe.deadline;
+
+        e->running = 1;
+        pthread_mutex_unlock(&control__.lock);
+
+        start = os_time_monotonic();
+        if(e->handler) {
+            rv = e->handler(e->cookie, &rate);
         }
+        else {
+            rv = (e->manage) ? e->manage() : 0;
+        }
+        runtime = os_time_monotonic() - start;
+
+        pthread_mutex_lock(&control__.lock);
+        e->running = 0;
+
         e->calls++;
+        if(rv < 0) {
+            e->errors++;
+        }
+        if(runtime >= rate0) {
+            e->overruns++;
+        }
+        e->runtime_total += runtime;
+        if(runtime > e->runtime_max) {
+            e->runtime_max = runtime;
+        }
+        if(start > deadline && start - deadline > e->late_max) {
+            e->late_max = start - deadline;
+        }
+
+        if(e->removed) {
+            management_entry_unlink__(e);
+            continue;
+        }
+
+        /*
+         * A rate returned by the callback takes precedence over
+         * onlp_sys_platform_manage_rate_set() during the call.
+         */
+        if(e->handler && rate != rate0) {
+            e->rate = (rate < MANAGEMENT_RATE_MIN) ? MANAGEMENT_RATE_MIN : rate;
+        }
         timer_wheel_insert(control__.tw, &e->twe, os_time_monotonic() + e->rate);
     }
+    pthread_mutex_unlock(&control__.lock);
 }
 
 static void*
@@ -176,6 +432,7 @@ onlp_sys_platform_manage_thread__(void* vctrl)
 
         fd_set fds;
         uint64_t now;
+        uint64_t deadline = 0;
         struct timeval tv;
         timer_wheel_entry_t* twe;
 
@@ -184,9 +441,15 @@ onlp_sys_platform_manage_thread__(void* vctrl)
 
         /*
          * Ask the timer wheel if there is an expiration in the next 2 seconds.
+         * Callbacks may be registered from other threads at any time.
          */
         now = os_time_monotonic();
+        pthread_mutex_lock(&control__.lock);
         twe = timer_wheel_peek(ctrl->tw, now + 20000000);
+        if(twe) {
+            deadline = twe->deadline;
+        }
+        pthread_mutex_unlock(&control__.lock);
 
         if(twe == NULL) {
             /* Nothing in the next two seconds. */
@@ -194,10 +457,10 @@ onlp_sys_platform_manage_thread__(void* vctrl)
             tv.tv_usec = 0;
         }
         else {
-            if(twe->deadline > now) {
+            if(deadline > now) {
                 /* Sleep until next deadline */
-                tv.tv_sec = (twe->deadline - now) / 1000000;
-                tv.tv_usec = (twe->deadline - now) % 1000000;
+                tv.tv_sec = (deadline - now) / 1000000;
+                tv.tv_usec = (deadline - now) % 1000000;
             }
             else {
                 /* We have surpassed the current deadline */
@@ -208,12 +471,32 @@ onlp_sys_platform_manage_thread__(void* vctrl)
 
         int rv = select(ctrl->eventfd+1, &fds, NULL, NULL, &tv);
         if(rv == 1 && FD_ISSET(ctrl->eventfd, &fds)) {
-            /* We've been asked to terminate. */
-            AIM_LOG_MSG("Terminating.");
-            /* Also signifies that we have exit */
-            close(ctrl->eventfd);
-            ctrl->eventfd = -1;
-            return NULL;
+            uint64_t count;
+            int exit;
+
+            pthread_mutex_lock(&control__.lock);
+            exit = ctrl->exit;
+            if(exit) {
+                /*
+                 * Also signifies that we have exit. Closed under the lock
+                 * so a concurrent wake never writes to a stale descriptor.
+                 */
+                close(ctrl->eventfd);
+                ctrl->eventfd = -1;
+            }
+            pthread_mutex_unlock(&control__.lock);
+
+            if(exit) {
+                /* We've been asked to terminate. */
+                AIM_LOG_MSG("Terminating.");
+                return NULL;
+            }
+
+            /* A callback was registered. Recompute the next deadline. */
+            if(read(ctrl->eventfd, &count, sizeof(count)) < 0) {
+                AIM_LOG_ERROR("eventfd read failed: %{errno}", errno);
+            }
+            continue;
         }
         if(rv < 0) {
             AIM_LOG_ERROR("select() returned %d (%{errno})", rv, errno);
@@ -238,6 +521,7 @@ onlp_sys_platform_manage_start(int block)
         return 0;
     }
 
+    control__.exit = 0;
     if( (control__.eventfd = eventfd(0, EFD_SEMAPHORE)) < 0) {
         AIM_LOG_ERROR("eventfd create failed: %{errno}", errno);
         return -1;
@@ -262,9 +546,11 @@ int
 onlp_sys_platform_manage_stop(int block)
 {
     if(control__.eventfd > 0) {
-        uint64_t zero = 1;
         /* Tell the thread to exit */
-        write(control__.eventfd, &zero, sizeof(zero));
+        pthread_mutex_lock(&control__.lock);
+        control__.exit = 1;
+        management_wake_locked__();
+        pthread_mutex_unlock(&control__.lock);
 
         if(block) {
             onlp_sys_platform_manage_join();
@@ -286,38 +572,167 @@ onlp_sys_platform_manage_join(void)
 }
 
 
+/*
+ * The last reading of each thermal.
+ */
+typedef struct platform_thermal_s {
+    onlp_oid_t oid;
+    /** Headroom to the warning threshold, INT_MAX if there is none. */
+    int headroom;
+    /** When the thermal must be read again. */
+    uint64_t due;
+} platform_thermal_t;
+
+/*
+ * Returns the smallest headroom (milli-celsius) between a thermal
+ * and its warning threshold, or INT_MAX if no thermal reports one.
+ *
+ * Only the thermals which are due are read. A thermal near its
+ * threshold is read on every call. One with more headroom is read
+ * again after the fastest management interval for each
+ * ONLP_CONFIG_PLATFORM_MANAGE_FANS_HEADROOM_MC of headroom it has,
+ * up to the slowest interval. Until then its last reading is used.
+ */
+static int
+platform_thermal_headroom__(void)
+{
+    static platform_thermal_t* thermals = NULL;
+    static int count = 0;
+    uint64_t now = os_time_monotonic();
+    int headroom = INT_MAX;
+    int i;
+
+    if(thermals == NULL) {
+        onlp_oid_t* oids;
+        if( (count = platform_oids_get__(ONLP_OID_TYPE_THERMAL, &oids)) <= 0) {
+            return INT_MAX;
+        }
+        thermals = aim_zmalloc(count*sizeof(*thermals));
+        for(i = 0; i < count; i++) {
+            thermals[i].oid = oids[i];
+        }
+        aim_free(oids);
+    }
+
+    for(i = 0; i < count; i++) {
+        platform_thermal_t* t = thermals + i;
+
+        if(now >= t->due) {
+            onlp_thermal_info_t ti;
+            uint64_t interval;
+
+            t->headroom = INT_MAX;
+            if( (onlp_thermal_info_get(t->oid, &ti) >= 0) &&
+                (ti.status & ONLP_THERMAL_STATUS_PRESENT) &&
+                (ti.caps & ONLP_THERMAL_CAPS_GET_WARNING_THRESHOLD) &&
+                ti.thresholds.warning > 0 ) {
+                t->headroom = ti.thresholds.warning - ti.mcelsius;
+            }
+
+            if(t->headroom < ONLP_CONFIG_PLATFORM_MANAGE_FANS_HEADROOM_MC) {
+                interval = 0;
+            }
+            else if(t->headroom == INT_MAX) {
+                interval = ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MAX_MS*1000ULL;
+            }
+            else {
+                interval = ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MIN_MS*1000ULL *
+                    (t->headroom / ONLP_CONFIG_PLATFORM_MANAGE_FANS_HEADROOM_MC);
+                if(interval > ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MAX_MS*1000ULL) {
+                    interval = ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MAX_MS*1000ULL;
+                }
+            }
+            t->due = now + interval;
+        }
+
+        if(t->headroom < headroom) {
+            headroom = t->headroom;
+        }
+    }
+    return headroom;
+}
+
+/*
+ * Fan management runs at the fastest rate while any thermal is near
+ * its warning threshold and backs off while all have headroom.
+ */
+static int
+platform_fans_manage__(void* cookie, uint64_t* rate)
+{
+    int headroom;
+    int rv = onlp_sysi_platform_manage_fans();
+
+    if(rv == ONLP_STATUS_E_UNSUPPORTED) {
+        /* Nothing to manage on this platform. */
+        *rate = ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MAX_MS*1000ULL;
+        return 0;
+    }
+
+    headroom = platform_thermal_headroom__();
+    if(headroom == INT_MAX) {
+        /* No thresholds available. Keep the current rate. */
+    }
+    else if(headroom < ONLP_CONFIG_PLATFORM_MANAGE_FANS_HEADROOM_MC) {
+        *rate = ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MIN_MS*1000ULL;
+    }
+    else {
+        *rate *= 2;
+        if(*rate > ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MAX_MS*1000ULL) {
+            *rate = ONLP_CONFIG_PLATFORM_MANAGE_FANS_RATE_MAX_MS*1000ULL;
+        }
+    }
+    return rv;
+}
+
+/*
+ * Allocate a table of the system OIDs of the given type.
+ * Returns the number of OIDs.
+ */
+static int
+platform_oids_get__(onlp_oid_type_t type, onlp_oid_t** table)
+{
+    int i = 0;
+    int count;
+    onlp_oid_t oid;
+    onlp_oid_iter_t iter;
+
+    *table = NULL;
+    if( (count = onlp_oid_children_count(ONLP_OID_SYS, type)) <= 0) {
+        return count;
+    }
+    *table = aim_zmalloc(count*sizeof(**table));
+    onlp_oid_iter_init(&iter, ONLP_OID_SYS, type);
+    while(i < count && onlp_oid_iter_next(&iter, &oid) == 1) {
+        (*table)[i++] = oid;
+    }
+    return i;
+}
+
 static int
 platform_psus_notify__(void)
 {
-    static onlp_oid_t psu_oid_table[ONLP_OID_TABLE_SIZE] = {0};
-    static onlp_psu_info_t psu_info_table[ONLP_OID_TABLE_SIZE];
+    static onlp_oid_t* psu_oid_table = NULL;
+    static onlp_psu_info_t* psu_info_table = NULL;
+    static int* flag = NULL;
+    static int psu_count = 0;
     int i = 0;
-    static int flag[ONLP_OID_TABLE_SIZE] = {0};
 
-    if(psu_oid_table[0] == 0) {
+    if(psu_oid_table == NULL) {
         /* We haven't retreived the system PSU oids yet. */
-        onlp_sys_info_t si;
-        onlp_oid_t* oidp;
-
-        if(onlp_sys_info_get(&si) < 0) {
-            AIM_LOG_ERROR("onlp_sys_info_get() failed.");
+        if( (psu_count = platform_oids_get__(ONLP_OID_TYPE_PSU, &psu_oid_table)) < 0) {
+            AIM_LOG_ERROR("Failed to retrieve the system PSU oids.");
             return -1;
         }
-        ONLP_OID_TABLE_ITER_TYPE(si.hdr.coids, oidp, PSU) {
-            psu_oid_table[i++] = *oidp;
+        if(psu_oid_table) {
+            psu_info_table = aim_zmalloc(psu_count*sizeof(*psu_info_table));
+            flag = aim_zmalloc(psu_count*sizeof(*flag));
         }
-        /* free allocated memory */
-        onlp_sys_info_free(&si);
     }
 
-    for(i = 0; i < AIM_ARRAYSIZE(psu_oid_table); i++) {
+    for(i = 0; i < psu_count; i++) {
         onlp_psu_info_t pi;
         int pid = ONLP_OID_ID_GET(psu_oid_table[i]);
 
-        if(psu_oid_table[i] == 0) {
-            break;
-        }
-
         if(onlp_psu_info_get(psu_oid_table[i], &pi) < 0) {
             AIM_LOG_ERROR("Failure retreiving status of PSU ID %d",
                           pid);
@@ -402,35 +817,28 @@ platform_psus_notify__(void)
 static int
 platform_fans_notify__(void)
 {
-    static onlp_oid_t fan_oid_table[ONLP_OID_TABLE_SIZE] = {0};
-    static onlp_fan_info_t fan_info_table[ONLP_OID_TABLE_SIZE];
+    static onlp_oid_t* fan_oid_table = NULL;
+    static onlp_fan_info_t* fan_info_table = NULL;
+    static int* flag = NULL;
+    static int fan_count = 0;
     int i = 0;
-    static int flag[ONLP_OID_TABLE_SIZE] = {0};
 
-    if(fan_oid_table[0] == 0) {
+    if(fan_oid_table == NULL) {
         /* We haven't retreived the system FAN oids yet. */
-        onlp_sys_info_t si;
-        onlp_oid_t* oidp;
-
-        if(onlp_sys_info_get(&si) < 0) {
-            AIM_LOG_ERROR("onlp_sys_info_get() failed.");
+        if( (fan_count = platform_oids_get__(ONLP_OID_TYPE_FAN, &fan_oid_table)) < 0) {
+            AIM_LOG_ERROR("Failed to retrieve the system FAN oids.");
             return -1;
         }
-        ONLP_OID_TABLE_ITER_TYPE(si.hdr.coids, oidp, FAN) {
-            fan_oid_table[i++] = *oidp;
+        if(fan_oid_table) {
+            fan_info_table = aim_zmalloc(fan_count*sizeof(*fan_info_table));
+            flag = aim_zmalloc(fan_count*sizeof(*flag));
         }
-        /* free allocated memory */
-        onlp_sys_info_free(&si);
     }
 
-    for(i = 0; i < AIM_ARRAYSIZE(fan_oid_table); i++) {
+    for(i = 0; i < fan_count; i++) {
         onlp_fan_info_t fi;
         int fid = ONLP_OID_ID_GET(fan_oid_table[i]);
 
-        if(fan_oid_table[i] == 0) {
-            break;
-        }
-
         if(onlp_fan_info_get(fan_oid_table[i], &fi) < 0) {
             AIM_LOG_ERROR("Failure retreiving status of FAN ID %d",
                           fid);
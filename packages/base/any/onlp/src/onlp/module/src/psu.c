@@ -28,7 +28,9 @@
 #include <onlp/psu.h>
 #include <onlp/platformi/psui.h>
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_PSU
 #include "onlp_locks.h"
+#include "onlp_cache.h"
 
 #define VALIDATE(_id)                           \
     do {                                        \
@@ -52,13 +54,28 @@ onlp_psu_init_locked__(void)
 }
 ONLP_LOCKED_API0(onlp_psu_init);
 
+static int
+onlp_psui_info_get_cached__(onlp_oid_t id, onlp_psu_info_t* info)
+{
+    int rv;
+
+    if(ONLP_CACHE_GET(id, info)) {
+        return ONLP_STATUS_OK;
+    }
+    rv = onlp_psui_info_get(id, info);
+    if(ONLP_SUCCESS(rv)) {
+        ONLP_CACHE_SET(id, info);
+    }
+    return rv;
+}
+
 static int
 onlp_psu_info_get_locked__(onlp_oid_t id,  onlp_psu_info_t* info)
 {
     VALIDATE(id);
-    return onlp_psui_info_get(id, info);
+    return onlp_psui_info_get_cached__(id, info);
 }
-ONLP_LOCKED_API2(onlp_psu_info_get, onlp_oid_t, id, onlp_psu_info_t*, info);
+ONLP_LOCKED_RAPI2(onlp_psu_info_get, onlp_oid_t, id, onlp_psu_info_t*, info);
 
 static int
 onlp_psu_status_get_locked__(onlp_oid_t id, uint32_t* status)
@@ -69,12 +86,12 @@ onlp_psu_status_get_locked__(onlp_oid_t id, uint32_t* status)
     }
     if(ONLP_UNSUPPORTED(rv)) {
         onlp_psu_info_t pi;
-        rv = onlp_psui_info_get(id, &pi);
+        rv = onlp_psui_info_get_cached__(id, &pi);
         *status = pi.status;
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_psu_status_get, onlp_oid_t, id, uint32_t*, status);
+ONLP_LOCKED_RAPI2(onlp_psu_status_get, onlp_oid_t, id, uint32_t*, status);
 
 static int
 onlp_psu_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr)
@@ -85,15 +102,16 @@ onlp_psu_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr)
     }
     if(ONLP_UNSUPPORTED(rv)) {
         onlp_psu_info_t pi;
-        rv = onlp_psui_info_get(id, &pi);
+        rv = onlp_psui_info_get_cached__(id, &pi);
         memcpy(hdr, &pi.hdr, sizeof(pi.hdr));
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_psu_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
+ONLP_LOCKED_RAPI2(onlp_psu_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
 int
 onlp_psu_vioctl_locked__(onlp_oid_t id, va_list vargs)
 {
+    ONLP_CACHE_INVALIDATE(id);
     return onlp_psui_ioctl(id, vargs);
 }
 ONLP_LOCKED_API2(onlp_psu_vioctl, onlp_oid_t, id, va_list, vargs);
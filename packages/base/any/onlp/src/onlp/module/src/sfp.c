@@ -24,7 +24,15 @@
  ***********************************************************/
 #include <onlp/sfp.h>
 #include <onlp/platformi/sfpi.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <onlplib/i2c.h>
 #include "onlp_log.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_SFP
 #include "onlp_locks.h"
 
 /**
@@ -77,7 +85,7 @@ onlp_sfp_bitmap_get_locked__(onlp_sfp_bitmap_t* bmap)
     AIM_BITMAP_ASSIGN(bmap, &sfpi_bitmap__);
     return ONLP_STATUS_OK;
 }
-ONLP_LOCKED_API1(onlp_sfp_bitmap_get, onlp_sfp_bitmap_t*, bmap);
+ONLP_LOCKED_RAPI1(onlp_sfp_bitmap_get, onlp_sfp_bitmap_t*, bmap);
 
 
 static int
@@ -105,17 +113,58 @@ onlp_sfp_is_present_locked__(int port)
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_is_present(port);
 }
-ONLP_LOCKED_API1(onlp_sfp_is_present, int, port);
+ONLP_LOCKED_PORT_RAPI1(onlp_sfp_is_present, int, port);
+
+/*
+ * Cleared when the SFPI driver reports that it cannot collect the
+ * status vector, so the other paths stop asking for it.
+ */
+static int sfp_status_bitmaps_supported__ = 1;
+
+/**
+ * Collect the status vector from the SFPI driver.
+ * Returns ONLP_STATUS_E_UNSUPPORTED if the driver does not provide it.
+ */
+static int
+sfp_status_bitmaps_sfpi__(onlp_sfp_status_bitmaps_t* dst)
+{
+    int rv;
+
+    if(!sfp_status_bitmaps_supported__) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    onlp_sfp_status_bitmaps_t_init(dst);
+    rv = onlp_sfpi_status_bitmaps_get(dst);
+    if(rv == ONLP_STATUS_E_UNSUPPORTED) {
+        sfp_status_bitmaps_supported__ = 0;
+    }
+    return rv;
+}
 
 static int
 onlp_sfp_presence_bitmap_get_locked__(onlp_sfp_bitmap_t* dst)
 {
+    int rv, p;
+    onlp_sfp_status_bitmaps_t* status = aim_zmalloc(sizeof(*status));
+
     onlp_sfp_bitmap_t_init(dst);
-    int rv = onlp_sfpi_presence_bitmap_get(dst);
+
+    /* Use the status vector if the platform provides it. */
+    rv = sfp_status_bitmaps_sfpi__(status);
+    if(rv >= 0) {
+        AIM_BITMAP_ITER(&status->present, p) {
+            AIM_BITMAP_SET(dst, p);
+        }
+    }
+    aim_free(status);
+    if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+        return rv;
+    }
+
+    rv = onlp_sfpi_presence_bitmap_get(dst);
 
     if(rv == ONLP_STATUS_E_UNSUPPORTED) {
         /* Generate from single-port API */
-        int p;
         AIM_BITMAP_CLR_ALL(dst);
         AIM_BITMAP_ITER(&sfpi_bitmap__, p) {
             rv = onlp_sfp_is_present_locked__(p);
@@ -131,7 +180,7 @@ onlp_sfp_presence_bitmap_get_locked__(onlp_sfp_bitmap_t* dst)
 
     return rv;
 }
-ONLP_LOCKED_API1(onlp_sfp_presence_bitmap_get, onlp_sfp_bitmap_t*, dst);
+ONLP_LOCKED_RAPI1(onlp_sfp_presence_bitmap_get, onlp_sfp_bitmap_t*, dst);
 
 int
 onlp_sfp_port_valid(int port)
@@ -154,7 +203,7 @@ onlp_sfp_eeprom_read_locked__(int port, uint8_t** datap)
     *datap = data;
     return rv;
 }
-ONLP_LOCKED_API2(onlp_sfp_eeprom_read, int, port, uint8_t**, rv);
+ONLP_LOCKED_PORT_RAPI2(onlp_sfp_eeprom_read, int, port, uint8_t**, rv);
 
 static int
 onlp_sfp_dom_read_locked__(int port, uint8_t** datap)
@@ -171,7 +220,112 @@ onlp_sfp_dom_read_locked__(int port, uint8_t** datap)
     *datap = data;
     return rv;
 }
-ONLP_LOCKED_API2(onlp_sfp_dom_read, int, port, uint8_t**, rv);
+ONLP_LOCKED_PORT_RAPI2(onlp_sfp_dom_read, int, port, uint8_t**, rv);
+
+static int
+onlp_sfp_memory_read_locked__(int port, uint8_t devaddr, int page, int offset,
+                              int size, uint8_t* rdata)
+{
+    int rv;
+    int paged;
+    uint8_t data[256];
+
+    if(offset < 0 || size <= 0 || offset + size > 256 || page < 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
+
+    rv = onlp_sfpi_memory_read(port, devaddr, page, offset, size, rdata);
+    if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+        return (rv < 0) ? rv : size;
+    }
+
+    /*
+     * Emulate using the device access functions.
+     * Pages only apply to upper memory (offsets 128-255).
+     */
+    paged = (page != 0 && offset + size > 128);
+    if(paged) {
+        if( (rv = onlp_sfpi_dev_writeb(port, devaddr, 127, page)) < 0) {
+            return rv;
+        }
+    }
+
+    rv = onlp_sfpi_dev_read(port, devaddr, offset, rdata, size);
+
+    if(paged) {
+        /* Restore page 0. Report a failure, the module is left on another page. */
+        int prv = onlp_sfpi_dev_writeb(port, devaddr, 127, 0);
+        if(rv >= 0 && prv < 0) {
+            rv = prv;
+        }
+    }
+
+    if(rv != ONLP_STATUS_E_UNSUPPORTED || paged) {
+        return (rv < 0) ? rv : size;
+    }
+
+    /* Last resort -- a full page 0 read. */
+    switch(devaddr)
+        {
+        case 0x50: rv = onlp_sfpi_eeprom_read(port, data); break;
+        case 0x51: rv = onlp_sfpi_dom_read(port, data); break;
+        default: return ONLP_STATUS_E_PARAM;
+        }
+
+    if(rv < 0) {
+        return rv;
+    }
+    memcpy(rdata, data + offset, size);
+    return size;
+}
+ONLP_LOCKED_PORT_API6(onlp_sfp_memory_read, int, port, uint8_t, devaddr, int, page, int, offset, int, size, uint8_t*, rdata);
+
+static int
+onlp_sfp_memory_write_locked__(int port, uint8_t devaddr, int page, int offset,
+                               int size, uint8_t* data)
+{
+    int rv;
+    int i;
+    int paged;
+
+    if(offset < 0 || size <= 0 || offset + size > 256 || page < 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
+
+    /* Pages only apply to upper memory (offsets 128-255). */
+    paged = (page != 0 && offset + size > 128);
+    if(paged) {
+        if( (rv = onlp_sfpi_dev_writeb(port, devaddr, 127, page)) < 0) {
+            return rv;
+        }
+    }
+
+    rv = onlp_sfpi_dev_write(port, devaddr, offset, data, size);
+    if(rv == ONLP_STATUS_E_UNSUPPORTED) {
+        /* Emulate using byte writes. */
+        for(i = 0, rv = 0; i < size && rv >= 0; i++) {
+            rv = onlp_sfpi_dev_writeb(port, devaddr, offset + i, data[i]);
+        }
+    }
+
+    if(paged) {
+        /*
+         * Restore page 0. If this fails the module is left on another
+         * page, so report it even though the write itself succeeded.
+         */
+        int prv = onlp_sfpi_dev_writeb(port, devaddr, 127, 0);
+        if(rv >= 0 && prv < 0) {
+            rv = prv;
+        }
+    }
+
+    return (rv < 0) ? rv : size;
+}
+ONLP_LOCKED_PORT_API6(onlp_sfp_memory_write, int, port, uint8_t, devaddr, int, page, int, offset, int, size, uint8_t*, data);
 
 void
 onlp_sfp_dump(aim_pvs_t* pvs)
@@ -204,6 +358,13 @@ onlp_sfp_dump(aim_pvs_t* pvs)
     }
     aim_printf(pvs, "\n");
 
+    /* Collect the status vector once for the whole sweep. */
+    onlp_sfp_status_bitmaps_t* status = aim_zmalloc(sizeof(*status));
+    if(onlp_sfp_status_bitmaps_get(status) < 0) {
+        aim_free(status);
+        status = NULL;
+    }
+
     AIM_BITMAP_ITER(&sfpi_bitmap__, p) {
         rv = onlp_sfp_is_present(p);
         aim_printf(pvs, "Port %.2d: ", p);
@@ -215,7 +376,7 @@ onlp_sfp_dump(aim_pvs_t* pvs)
             /* Present, OK */
             int srv;
             uint32_t flags = 0;
-            srv = onlp_sfp_control_flags_get(p, &flags);
+            srv = onlp_sfp_control_flags_status_get(p, status, &flags);
             if(srv >= 0) {
                 aim_printf(pvs, "Present, Status = %{onlp_sfp_control_flags}\n", flags);
             }
@@ -239,6 +400,7 @@ onlp_sfp_dump(aim_pvs_t* pvs)
             }
         }
     }
+    aim_free(status);
     return;
 }
 
@@ -248,7 +410,7 @@ onlp_sfp_post_insert_locked__(int port, sff_info_t* info)
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_post_insert(port, info);
 }
-ONLP_LOCKED_API2(onlp_sfp_post_insert, int, port, sff_info_t*, info);
+ONLP_LOCKED_PORT_API2(onlp_sfp_post_insert, int, port, sff_info_t*, info);
 
 static int
 onlp_sfp_control_set_locked__(int port, onlp_sfp_control_t control, int value)
@@ -280,7 +442,7 @@ onlp_sfp_control_set_locked__(int port, onlp_sfp_control_t control, int value)
         }
     return onlp_sfpi_control_set(port, control, value);
 }
-ONLP_LOCKED_API3(onlp_sfp_control_set, int, port, onlp_sfp_control_t, control,
+ONLP_LOCKED_PORT_API3(onlp_sfp_control_set, int, port, onlp_sfp_control_t, control,
                  int, value);
 
 static int
@@ -311,7 +473,7 @@ onlp_sfp_control_get_locked__(int port, onlp_sfp_control_t control, int* value)
 
     return (value) ? onlp_sfpi_control_get(port, control, value) : ONLP_STATUS_E_PARAM;
 }
-ONLP_LOCKED_API3(onlp_sfp_control_get, int, port, onlp_sfp_control_t, control,
+ONLP_LOCKED_PORT_RAPI3(onlp_sfp_control_get, int, port, onlp_sfp_control_t, control,
                  int*, value);
 
 
@@ -319,11 +481,34 @@ ONLP_LOCKED_API3(onlp_sfp_control_get, int, port, onlp_sfp_control_t, control,
 static int
 onlp_sfp_rx_los_bitmap_get_locked__(onlp_sfp_bitmap_t* dst)
 {
-    int rv = onlp_sfpi_rx_los_bitmap_get(dst);
+    int rv, p;
+    onlp_sfp_status_bitmaps_t* status = aim_zmalloc(sizeof(*status));
+
+    /*
+     * Use the status vector if the platform provides it and reports
+     * RX_LOS for any port. Ports it does not report RX_LOS for are clear.
+     */
+    rv = sfp_status_bitmaps_sfpi__(status);
+    if(rv >= 0 && AIM_BITMAP_COUNT(&status->valid[ONLP_SFP_CONTROL_RX_LOS]) == 0) {
+        rv = ONLP_STATUS_E_UNSUPPORTED;
+    }
+    if(rv >= 0) {
+        AIM_BITMAP_CLR_ALL(dst);
+        AIM_BITMAP_ITER(&status->valid[ONLP_SFP_CONTROL_RX_LOS], p) {
+            if(AIM_BITMAP_GET(&status->value[ONLP_SFP_CONTROL_RX_LOS], p)) {
+                AIM_BITMAP_SET(dst, p);
+            }
+        }
+    }
+    aim_free(status);
+    if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+        return rv;
+    }
+
+    rv = onlp_sfpi_rx_los_bitmap_get(dst);
 
     if(rv == ONLP_STATUS_E_UNSUPPORTED) {
         /* Generate from control API */
-        int p;
         AIM_BITMAP_CLR_ALL(dst);
         AIM_BITMAP_ITER(&sfpi_bitmap__, p) {
             int v;
@@ -339,11 +524,71 @@ onlp_sfp_rx_los_bitmap_get_locked__(onlp_sfp_bitmap_t* dst)
 
     return rv;
 }
-ONLP_LOCKED_API1(onlp_sfp_rx_los_bitmap_get, onlp_sfp_bitmap_t*, dst);
+ONLP_LOCKED_RAPI1(onlp_sfp_rx_los_bitmap_get, onlp_sfp_bitmap_t*, dst);
 
 
-int
-onlp_sfp_control_flags_get(int port, uint32_t* flags)
+void
+onlp_sfp_status_bitmaps_t_init(onlp_sfp_status_bitmaps_t* status)
+{
+    int i;
+    onlp_sfp_bitmap_t_init(&status->present);
+    for(i = 0; i < ONLP_SFP_CONTROL_COUNT; i++) {
+        onlp_sfp_bitmap_t_init(&status->value[i]);
+        onlp_sfp_bitmap_t_init(&status->valid[i]);
+    }
+}
+
+static int
+onlp_sfp_status_bitmaps_get_locked__(onlp_sfp_status_bitmaps_t* dst)
+{
+    /**
+     * These are the controls emulated if the platform
+     * does not support batch collection.
+     */
+    onlp_sfp_control_t controls[] =
+        {
+            ONLP_SFP_CONTROL_RESET_STATE,
+            ONLP_SFP_CONTROL_RX_LOS,
+            ONLP_SFP_CONTROL_TX_FAULT,
+            ONLP_SFP_CONTROL_TX_DISABLE,
+            ONLP_SFP_CONTROL_LP_MODE,
+        };
+    int rv, i, p, v;
+
+    rv = sfp_status_bitmaps_sfpi__(dst);
+    if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+        return rv;
+    }
+    onlp_sfp_status_bitmaps_t_init(dst);
+
+    /* Generate from the presence bitmap and control API */
+    rv = onlp_sfp_presence_bitmap_get_locked__(&dst->present);
+    if(rv < 0) {
+        return rv;
+    }
+
+    AIM_BITMAP_ITER(&dst->present, p) {
+        for(i = 0; i < AIM_ARRAYSIZE(controls); i++) {
+            rv = onlp_sfp_control_get_locked__(p, controls[i], &v);
+            if(rv < 0) {
+                if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+                    return rv;
+                }
+                continue;
+            }
+            AIM_BITMAP_SET(&dst->valid[controls[i]], p);
+            AIM_BITMAP_MOD(&dst->value[controls[i]], p, !!v);
+        }
+    }
+
+    return 0;
+}
+ONLP_LOCKED_RAPI1(onlp_sfp_status_bitmaps_get, onlp_sfp_status_bitmaps_t*, dst);
+
+static int
+onlp_sfp_control_flags_status_get_locked__(int port,
+                                           const onlp_sfp_status_bitmaps_t* status,
+                                           uint32_t* flags)
 {
     /**
      * These are the control bits queried and returned.
@@ -356,7 +601,6 @@ onlp_sfp_control_flags_get(int port, uint32_t* flags)
             ONLP_SFP_CONTROL_LP_MODE,
             ONLP_SFP_CONTROL_SOFT_RATE_SELECT
         };
-
     if(flags) {
         *flags = 0;
     }
@@ -364,10 +608,20 @@ onlp_sfp_control_flags_get(int port, uint32_t* flags)
         return ONLP_STATUS_E_PARAM;
     }
 
+    if(port < 0 || !onlp_sfp_port_valid(port)) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
     int rv, i, v;
 
     for(i = 0; i < AIM_ARRAYSIZE(controls); i++) {
-        rv = onlp_sfp_control_get(port, controls[i], &v);
+        if(status && AIM_BITMAP_GET(&status->valid[controls[i]], port)) {
+            v = AIM_BITMAP_GET(&status->value[controls[i]], port);
+            rv = 0;
+        }
+        else {
+            rv = onlp_sfp_control_get_locked__(port, controls[i], &v);
+        }
         if(rv >= 0) {
             if(v) {
                 *flags |= (1 << controls[i]);
@@ -381,6 +635,15 @@ onlp_sfp_control_flags_get(int port, uint32_t* flags)
     }
     return 0;
 }
+ONLP_LOCKED_PORT_RAPI3(onlp_sfp_control_flags_status_get, int, port,
+                       const onlp_sfp_status_bitmaps_t*, status, uint32_t*, flags);
+
+static int
+onlp_sfp_control_flags_get_locked__(int port, uint32_t* flags)
+{
+    return onlp_sfp_control_flags_status_get_locked__(port, NULL, flags);
+}
+ONLP_LOCKED_PORT_RAPI2(onlp_sfp_control_flags_get, int, port, uint32_t*, flags);
 
 int
 onlp_sfp_ioctl(int port, ...)
@@ -398,7 +661,7 @@ onlp_sfp_vioctl_locked__(int port, va_list vargs)
 {
     return onlp_sfpi_ioctl(port, vargs);
 };
-ONLP_LOCKED_API2(onlp_sfp_vioctl, int, port, va_list, vargs);
+ONLP_LOCKED_PORT_API2(onlp_sfp_vioctl, int, port, va_list, vargs);
 
 
 int
@@ -407,7 +670,7 @@ onlp_sfp_dev_readb_locked__(int port, uint8_t devaddr, uint8_t addr)
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_dev_readb(port, devaddr, addr);
 }
-ONLP_LOCKED_API3(onlp_sfp_dev_readb, int, port, uint8_t, devaddr, uint8_t, addr);
+ONLP_LOCKED_PORT_RAPI3(onlp_sfp_dev_readb, int, port, uint8_t, devaddr, uint8_t, addr);
 
 int
 onlp_sfp_dev_writeb_locked__(int port, uint8_t devaddr, uint8_t addr, uint8_t value)
@@ -415,7 +678,7 @@ onlp_sfp_dev_writeb_locked__(int port, uint8_t devaddr, uint8_t addr, uint8_t va
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_dev_writeb(port, devaddr, addr, value);
 }
-ONLP_LOCKED_API4(onlp_sfp_dev_writeb, int, port, uint8_t, devaddr, uint8_t, addr, uint8_t, value);
+ONLP_LOCKED_PORT_API4(onlp_sfp_dev_writeb, int, port, uint8_t, devaddr, uint8_t, addr, uint8_t, value);
 
 int
 onlp_sfp_dev_readw_locked__(int port, uint8_t devaddr, uint8_t addr)
@@ -423,7 +686,7 @@ onlp_sfp_dev_readw_locked__(int port, uint8_t devaddr, uint8_t addr)
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_dev_readw(port, devaddr, addr);
 }
-ONLP_LOCKED_API3(onlp_sfp_dev_readw, int, port, uint8_t, devaddr, uint8_t, addr);
+ONLP_LOCKED_PORT_RAPI3(onlp_sfp_dev_readw, int, port, uint8_t, devaddr, uint8_t, addr);
 
 int
 onlp_sfp_dev_writew_locked__(int port, uint8_t devaddr, uint8_t addr, uint16_t value)
@@ -431,7 +694,7 @@ onlp_sfp_dev_writew_locked__(int port, uint8_t devaddr, uint8_t addr, uint16_t v
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_dev_writew(port, devaddr, addr, value);
 }
-ONLP_LOCKED_API4(onlp_sfp_dev_writew, int, port, uint8_t, devaddr, uint8_t, addr, uint16_t, value);
+ONLP_LOCKED_PORT_API4(onlp_sfp_dev_writew, int, port, uint8_t, devaddr, uint8_t, addr, uint16_t, value);
 
 int
 onlp_sfp_dev_read_locked__(int port, uint8_t devaddr, uint8_t addr, uint8_t* rdata, int size)
@@ -439,7 +702,7 @@ onlp_sfp_dev_read_locked__(int port, uint8_t devaddr, uint8_t addr, uint8_t* rda
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_dev_read(port, devaddr, addr, rdata, size);
 }
-ONLP_LOCKED_API5(onlp_sfp_dev_read, int, port, uint8_t, devaddr, uint8_t, addr, uint8_t*, rdata, int, size);
+ONLP_LOCKED_PORT_RAPI5(onlp_sfp_dev_read, int, port, uint8_t, devaddr, uint8_t, addr, uint8_t*, rdata, int, size);
 
 int
 onlp_sfp_dev_write_locked__(int port, uint8_t devaddr, uint8_t addr, uint8_t* data, int size)
@@ -447,4 +710,662 @@ onlp_sfp_dev_write_locked__(int port, uint8_t devaddr, uint8_t addr, uint8_t* da
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_dev_write(port, devaddr, addr, data, size);
 }
-ONLP_LOCKED_API5(onlp_sfp_dev_write, int, port, uint8_t, devaddr, uint8_t, addr, uint8_t*, data, int, size);
+ONLP_LOCKED_PORT_API5(onlp_sfp_dev_write, int, port, uint8_t, devaddr, uint8_t, addr, uint8_t*, data, int, size);
+
+
+/****************************************************************************
+ *
+ * SFP Change Notifications.
+ *
+ ***************************************************************************/
+
+typedef struct sfp_notify_subscriber_s {
+    int in_use;
+
+    /** Handler subscriptions. */
+    onlp_sfp_notify_handler_f handler;
+    void* cookie;
+
+    /** Descriptor subscriptions. */
+    int fd;
+    onlp_sfp_notify_t pending;
+
+    /** State last reported to this subscriber. */
+    onlp_sfp_bitmap_t present;
+    onlp_sfp_bitmap_t rx_los;
+} sfp_notify_subscriber_t;
+
+static sfp_notify_subscriber_t sfp_notify_subscribers__[ONLP_CONFIG_SFP_NOTIFY_SUBSCRIBERS_MAX];
+static pthread_mutex_t sfp_notify_lock__ = PTHREAD_MUTEX_INITIALIZER;
+static int sfp_notify_count__;
+
+/** Cleared if the platform cannot report RX_LOS. */
+static int sfp_notify_rx_los__ = 1;
+
+/** The last RX_LOS bitmap read successfully. */
+static onlp_sfp_bitmap_t sfp_notify_rx_los_last__;
+static int sfp_notify_rx_los_last_valid__;
+
+static void
+sfp_notify_t_init__(onlp_sfp_notify_t* n)
+{
+    onlp_sfp_bitmap_t_init(&n->presence_changed);
+    onlp_sfp_bitmap_t_init(&n->present);
+    onlp_sfp_bitmap_t_init(&n->rx_los_changed);
+    onlp_sfp_bitmap_t_init(&n->rx_los);
+}
+
+static sfp_notify_subscriber_t*
+sfp_notify_alloc__(void)
+{
+    int i;
+    for(i = 0; i < AIM_ARRAYSIZE(sfp_notify_subscribers__); i++) {
+        sfp_notify_subscriber_t* s = sfp_notify_subscribers__ + i;
+        if(!s->in_use) {
+            memset(s, 0, sizeof(*s));
+            s->in_use = 1;
+            s->fd = -1;
+            sfp_notify_t_init__(&s->pending);
+            onlp_sfp_bitmap_t_init(&s->present);
+            onlp_sfp_bitmap_t_init(&s->rx_los);
+            sfp_notify_count__++;
+            return s;
+        }
+    }
+    return NULL;
+}
+
+static void
+sfp_notify_free__(sfp_notify_subscriber_t* s)
+{
+    s->in_use = 0;
+    sfp_notify_count__--;
+}
+
+static sfp_notify_subscriber_t*
+sfp_notify_find_fd__(int fd)
+{
+    int i;
+    for(i = 0; i < AIM_ARRAYSIZE(sfp_notify_subscribers__); i++) {
+        sfp_notify_subscriber_t* s = sfp_notify_subscribers__ + i;
+        if(s->in_use && s->handler == NULL && s->fd == fd) {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+int
+onlp_sfp_notify_register(onlp_sfp_notify_handler_f handler, void* cookie)
+{
+    sfp_notify_subscriber_t* s;
+
+    if(handler == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&sfp_notify_lock__);
+    if( (s = sfp_notify_alloc__()) ) {
+        s->handler = handler;
+        s->cookie = cookie;
+    }
+    pthread_mutex_unlock(&sfp_notify_lock__);
+
+    if(s == NULL) {
+        AIM_LOG_ERROR("No more SFP notification subscribers available.");
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfp_notify_unregister(onlp_sfp_notify_handler_f handler, void* cookie)
+{
+    int i;
+    int rv = ONLP_STATUS_E_PARAM;
+
+    pthread_mutex_lock(&sfp_notify_lock__);
+    for(i = 0; i < AIM_ARRAYSIZE(sfp_notify_subscribers__); i++) {
+        sfp_notify_subscriber_t* s = sfp_notify_subscribers__ + i;
+        if(s->in_use && s->handler == handler && s->cookie == cookie) {
+            sfp_notify_free__(s);
+            rv = ONLP_STATUS_OK;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sfp_notify_lock__);
+    return rv;
+}
+
+int
+onlp_sfp_notify_fd_open(void)
+{
+    sfp_notify_subscriber_t* s;
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if(fd < 0) {
+        AIM_LOG_ERROR("eventfd create failed: %{errno}", errno);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    pthread_mutex_lock(&sfp_notify_lock__);
+    if( (s = sfp_notify_alloc__()) ) {
+        s->fd = fd;
+    }
+    pthread_mutex_unlock(&sfp_notify_lock__);
+
+    if(s == NULL) {
+        AIM_LOG_ERROR("No more SFP notification subscribers available.");
+        close(fd);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return fd;
+}
+
+int
+onlp_sfp_notify_fd_read(int fd, onlp_sfp_notify_t* notify)
+{
+    uint64_t count;
+    sfp_notify_subscriber_t* s;
+    int rv = 0;
+
+    pthread_mutex_lock(&sfp_notify_lock__);
+    if( (s = sfp_notify_find_fd__(fd)) == NULL) {
+        pthread_mutex_unlock(&sfp_notify_lock__);
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    /* Drain the descriptor. EAGAIN means nothing is pending. */
+    if(read(fd, &count, sizeof(count)) == sizeof(count)) {
+        rv = 1;
+    }
+
+    memcpy(notify, &s->pending, sizeof(*notify));
+    AIM_BITMAP_CLR_ALL(&s->pending.presence_changed);
+    AIM_BITMAP_CLR_ALL(&s->pending.rx_los_changed);
+    pthread_mutex_unlock(&sfp_notify_lock__);
+    return rv;
+}
+
+int
+onlp_sfp_notify_fd_close(int fd)
+{
+    sfp_notify_subscriber_t* s;
+
+    pthread_mutex_lock(&sfp_notify_lock__);
+    if( (s = sfp_notify_find_fd__(fd)) ) {
+        sfp_notify_free__(s);
+    }
+    pthread_mutex_unlock(&sfp_notify_lock__);
+
+    if(s == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    close(fd);
+    return ONLP_STATUS_OK;
+}
+
+/**
+ * Mark the ports which differ between last and current in changed.
+ * Returns the number of changed ports.
+ */
+static int
+sfp_notify_diff__(onlp_sfp_bitmap_t* changed, onlp_sfp_bitmap_t* last,
+                  onlp_sfp_bitmap_t* current)
+{
+    int p;
+    int count = 0;
+    AIM_BITMAP_ITER(&sfpi_bitmap__, p) {
+        if(AIM_BITMAP_GET(last, p) != AIM_BITMAP_GET(current, p)) {
+            AIM_BITMAP_SET(changed, p);
+            count++;
+        }
+    }
+    return count;
+}
+
+int
+onlp_sfp_notify_poll(void)
+{
+    int i, p, rv;
+    int count = 0;
+    onlp_sfp_bitmap_t present;
+    onlp_sfp_bitmap_t rx_los;
+    struct {
+        onlp_sfp_notify_handler_f handler;
+        void* cookie;
+        onlp_sfp_notify_t notify;
+    } calls[ONLP_CONFIG_SFP_NOTIFY_SUBSCRIBERS_MAX];
+
+    pthread_mutex_lock(&sfp_notify_lock__);
+    rv = sfp_notify_count__;
+    pthread_mutex_unlock(&sfp_notify_lock__);
+    if(rv == 0) {
+        return 0;
+    }
+
+    if( (rv = onlp_sfp_presence_bitmap_get(&present)) < 0) {
+        return rv;
+    }
+
+    onlp_sfp_bitmap_t_init(&rx_los);
+    if(sfp_notify_rx_los__) {
+        rv = onlp_sfp_rx_los_bitmap_get(&rx_los);
+        if(rv == ONLP_STATUS_E_UNSUPPORTED) {
+            sfp_notify_rx_los__ = 0;
+        }
+        pthread_mutex_lock(&sfp_notify_lock__);
+        if(rv >= 0) {
+            if(!sfp_notify_rx_los_last_valid__) {
+                onlp_sfp_bitmap_t_init(&sfp_notify_rx_los_last__);
+            }
+            AIM_BITMAP_ASSIGN(&sfp_notify_rx_los_last__, &rx_los);
+            sfp_notify_rx_los_last_valid__ = 1;
+        }
+        else if(rv != ONLP_STATUS_E_UNSUPPORTED && sfp_notify_rx_los_last_valid__) {
+            /*
+             * A failed read is not a change. Keep the last known
+             * state so subscribers don't see RX_LOS clear and return.
+             */
+            AIM_BITMAP_ASSIGN(&rx_los, &sfp_notify_rx_los_last__);
+        }
+        else {
+            AIM_BITMAP_CLR_ALL(&rx_los);
+        }
+        pthread_mutex_unlock(&sfp_notify_lock__);
+
+        AIM_BITMAP_ITER(&sfpi_bitmap__, p) {
+            if(!AIM_BITMAP_GET(&present, p)) {
+                AIM_BITMAP_CLR(&rx_los, p);
+            }
+        }
+    }
+
+    pthread_mutex_lock(&sfp_notify_lock__);
+    for(i = 0; i < AIM_ARRAYSIZE(sfp_notify_subscribers__); i++) {
+        sfp_notify_subscriber_t* s = sfp_notify_subscribers__ + i;
+        onlp_sfp_notify_t* n;
+        int changes;
+
+        if(!s->in_use) {
+            continue;
+        }
+
+        n = (s->handler) ? &calls[count].notify : &s->pending;
+        if(s->handler) {
+            sfp_notify_t_init__(n);
+        }
+
+        changes = sfp_notify_diff__(&n->presence_changed, &s->present, &present);
+        changes += sfp_notify_diff__(&n->rx_los_changed, &s->rx_los, &rx_los);
+
+        AIM_BITMAP_ASSIGN(&n->present, &present);
+        AIM_BITMAP_ASSIGN(&n->rx_los, &rx_los);
+        AIM_BITMAP_ASSIGN(&s->present, &present);
+        AIM_BITMAP_ASSIGN(&s->rx_los, &rx_los);
+
+        if(changes == 0) {
+            continue;
+        }
+
+        if(s->handler) {
+            calls[count].handler = s->handler;
+            calls[count].cookie = s->cookie;
+            count++;
+        }
+        else {
+            uint64_t one = 1;
+            if(write(s->fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+                AIM_LOG_ERROR("SFP notification eventfd write failed: %{errno}", errno);
+            }
+        }
+    }
+    pthread_mutex_unlock(&sfp_notify_lock__);
+
+    for(i = 0; i < count; i++) {
+        calls[i].handler(&calls[i].notify, calls[i].cookie);
+    }
+
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ * Batched DOM Collection.
+ *
+ *****************************************************************************/
+
+static int16_t
+sfp_dom_s16__(const uint8_t* p)
+{
+    return (int16_t)((p[0] << 8) | p[1]);
+}
+
+static uint16_t
+sfp_dom_u16__(const uint8_t* p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+/*
+ * Monitor units common to SFF-8472, SFF-8636 and CMIS:
+ * temperature 1/256 C, vcc 100uV, bias 2uA, power 0.1uW.
+ */
+static void
+sfp_dom_temp_vcc__(onlp_sfp_dom_batch_t* r, int i, uint32_t fields,
+                   const uint8_t* temp, const uint8_t* vcc)
+{
+    if(fields & ONLP_SFP_DOM_F_TEMP) {
+        r->temp[i] = (sfp_dom_s16__(temp) * 1000) / 256;
+        r->fields[i] |= ONLP_SFP_DOM_F_TEMP;
+    }
+    if(fields & ONLP_SFP_DOM_F_VCC) {
+        r->vcc[i] = sfp_dom_u16__(vcc) * 100;
+        r->fields[i] |= ONLP_SFP_DOM_F_VCC;
+    }
+}
+
+static void
+sfp_dom_lanes__(onlp_sfp_dom_batch_t* r, int i, uint32_t fields, int lanes,
+                const uint8_t* bias, const uint8_t* tx, const uint8_t* rx)
+{
+    int l;
+    for(l = 0; l < lanes; l++) {
+        if(fields & ONLP_SFP_DOM_F_BIAS) {
+            r->bias[i][l] = sfp_dom_u16__(bias + l*2) * 2;
+        }
+        if(fields & ONLP_SFP_DOM_F_TX_POWER) {
+            r->tx_power[i][l] = sfp_dom_u16__(tx + l*2) * 100;
+        }
+        if(fields & ONLP_SFP_DOM_F_RX_POWER) {
+            r->rx_power[i][l] = sfp_dom_u16__(rx + l*2) * 100;
+        }
+    }
+    r->lanes[i] = lanes;
+    r->fields[i] |= fields & (ONLP_SFP_DOM_F_BIAS | ONLP_SFP_DOM_F_TX_POWER |
+                              ONLP_SFP_DOM_F_RX_POWER);
+}
+
+#define SFP_DOM_LANE_FIELDS (ONLP_SFP_DOM_F_BIAS | ONLP_SFP_DOM_F_TX_POWER | \
+                             ONLP_SFP_DOM_F_RX_POWER)
+
+static int
+sfp_dom_read_sff8472__(onlp_sfp_dom_batch_t* r, int i, uint32_t fields)
+{
+    int rv;
+    uint8_t data[10];
+    int port = r->port[i];
+
+    /* Diagnostic monitoring type. */
+    if( (rv = onlp_sfp_memory_read_locked__(port, 0x50, 0, 92, 1, data)) < 0) {
+        return rv;
+    }
+    if( !(data[0] & 0x40) || (data[0] & 0x10) ) {
+        /* Not implemented, or externally calibrated. */
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    if( (rv = onlp_sfp_memory_read_locked__(port, 0x51, 0, 96, 10, data)) < 0) {
+        return rv;
+    }
+    sfp_dom_temp_vcc__(r, i, fields, data+0, data+2);
+    if(fields & SFP_DOM_LANE_FIELDS) {
+        sfp_dom_lanes__(r, i, fields, 1, data+4, data+6, data+8);
+    }
+    return ONLP_STATUS_OK;
+}
+
+static int
+sfp_dom_read_sff8636__(onlp_sfp_dom_batch_t* r, int i, uint32_t fields)
+{
+    int rv;
+    uint8_t data[36];
+    int size = (fields & SFP_DOM_LANE_FIELDS) ? 36 : 6;
+
+    /* Lower page bytes 22-57. */
+    if( (rv = onlp_sfp_memory_read_locked__(r->port[i], 0x50, 0, 22, size, data)) < 0) {
+        return rv;
+    }
+    sfp_dom_temp_vcc__(r, i, fields, data+0, data+4);
+    if(fields & SFP_DOM_LANE_FIELDS) {
+        sfp_dom_lanes__(r, i, fields, 4, data+20, data+28, data+12);
+    }
+    return ONLP_STATUS_OK;
+}
+
+static int
+sfp_dom_read_cmis__(onlp_sfp_dom_batch_t* r, int i, uint32_t fields)
+{
+    int rv;
+    uint8_t data[48];
+    int port = r->port[i];
+
+    if(fields & (ONLP_SFP_DOM_F_TEMP | ONLP_SFP_DOM_F_VCC)) {
+        /* Lower page bytes 14-17. */
+        if( (rv = onlp_sfp_memory_read_locked__(port, 0x50, 0, 14, 4, data)) < 0) {
+            return rv;
+        }
+        sfp_dom_temp_vcc__(r, i, fields, data+0, data+2);
+    }
+
+    if(fields & SFP_DOM_LANE_FIELDS) {
+        /* Flat memory modules have no lane monitors. */
+        if( (rv = onlp_sfp_memory_read_locked__(port, 0x50, 0, 2, 1, data)) < 0) {
+            return rv;
+        }
+        if(!(data[0] & 0x80)) {
+            /* Page 11h bytes 154-201. */
+            rv = onlp_sfp_memory_read_locked__(port, 0x50, 0x11, 154, 48, data);
+            if(rv < 0) {
+                return rv;
+            }
+            sfp_dom_lanes__(r, i, fields, 8, data+16, data+0, data+32);
+        }
+    }
+    return (r->fields[i]) ? ONLP_STATUS_OK : ONLP_STATUS_E_UNSUPPORTED;
+}
+
+static int
+sfp_dom_port_read_locked__(onlp_sfp_dom_batch_t* r, int i, uint32_t fields)
+{
+    int rv;
+    uint8_t id;
+
+    if( (rv = onlp_sfp_is_present_locked__(r->port[i])) < 0) {
+        return rv;
+    }
+    if(rv == 0) {
+        return ONLP_STATUS_E_MISSING;
+    }
+
+    if( (rv = onlp_sfp_memory_read_locked__(r->port[i], 0x50, 0, 0, 1, &id)) < 0) {
+        return rv;
+    }
+
+    switch(id)
+        {
+        case 0x03: /* SFP/SFP+/SFP28 */
+            return sfp_dom_read_sff8472__(r, i, fields);
+        case 0x0C: /* QSFP */
+        case 0x0D: /* QSFP+ */
+        case 0x11: /* QSFP28 */
+            return sfp_dom_read_sff8636__(r, i, fields);
+        case 0x18: /* QSFP-DD */
+        case 0x19: /* OSFP */
+        case 0x1E: /* QSFP+ or later with CMIS */
+            return sfp_dom_read_cmis__(r, i, fields);
+        default:
+            return ONLP_STATUS_E_UNSUPPORTED;
+        }
+}
+
+static void
+sfp_dom_port_read__(onlp_sfp_dom_batch_t* r, int i, uint32_t fields)
+{
+    int port = r->port[i];
+    ONLP_API_LOCK_EX(port, 0, "onlp_sfp_dom_batch_read");
+    r->status[i] = sfp_dom_port_read_locked__(r, i, fields);
+    ONLP_API_UNLOCK_EX(port, 0);
+    if(r->status[i] < 0) {
+        r->fields[i] = 0;
+        r->lanes[i] = 0;
+    }
+}
+
+typedef struct sfp_dom_order_s {
+    int root;
+    int bus;
+    int index;
+} sfp_dom_order_t;
+
+static int
+sfp_dom_order_compare__(const void* a, const void* b)
+{
+    const sfp_dom_order_t* oa = a;
+    const sfp_dom_order_t* ob = b;
+    if(oa->root != ob->root) {
+        return (oa->root < ob->root) ? -1 : 1;
+    }
+    if(oa->bus != ob->bus) {
+        return (oa->bus < ob->bus) ? -1 : 1;
+    }
+    return oa->index - ob->index;
+}
+
+/**
+ * Parallel reads only help when each port has its own lock.
+ * Otherwise every thread would serialize on the SFP domain lock.
+ */
+#if ONLP_CONFIG_INCLUDE_API_LOCK == 0 || \
+    (ONLP_CONFIG_API_LOCK_DOMAINS == 1 && ONLP_CONFIG_API_LOCK_INDEXED == 1)
+#define SFP_DOM_BATCH_PARALLEL__ 1
+#else
+#define SFP_DOM_BATCH_PARALLEL__ 0
+#endif
+
+typedef struct sfp_dom_job_s {
+    onlp_sfp_dom_batch_t* result;
+    uint32_t fields;
+    sfp_dom_order_t* order;
+    int count;
+    /* Read the root adapter groups g where g % stride == start. */
+    int* group;
+    int start;
+    int stride;
+    pthread_t thread;
+    int started;
+} sfp_dom_job_t;
+
+static void*
+sfp_dom_job__(void* arg)
+{
+    int i;
+    sfp_dom_job_t* job = arg;
+    for(i = 0; i < job->count; i++) {
+        if(job->group[i] % job->stride == job->start) {
+            sfp_dom_port_read__(job->result, job->order[i].index, job->fields);
+        }
+    }
+    return NULL;
+}
+
+int
+onlp_sfp_dom_batch_read(onlp_sfp_bitmap_t* ports, uint32_t fields,
+                        uint32_t flags, onlp_sfp_dom_batch_t* result)
+{
+    int i, p, rv;
+    int count = 0;
+    int groups = 0;
+    int threads = 1;
+    sfp_dom_order_t order[ONLP_SFP_DOM_BATCH_PORTS_MAX];
+    int group[ONLP_SFP_DOM_BATCH_PORTS_MAX];
+    sfp_dom_job_t jobs[ONLP_CONFIG_SFP_DOM_BATCH_THREADS_MAX > 0 ?
+                       ONLP_CONFIG_SFP_DOM_BATCH_THREADS_MAX : 1];
+
+    if(ports == NULL || result == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    memset(result, 0, sizeof(*result));
+    fields &= ONLP_SFP_DOM_F_ALL;
+
+    AIM_BITMAP_ITER(ports, p) {
+        if(count < ONLP_SFP_DOM_BATCH_PORTS_MAX &&
+           AIM_BITMAP_GET(&sfpi_bitmap__, p)) {
+            int rport = p;
+            int bus = -1;
+            if(onlp_sfpi_port_map(p, &rport) < 0) {
+                rport = p;
+            }
+            result->port[count] = p;
+            order[count].index = count;
+            order[count].bus = (onlp_sfpi_port_bus_get(rport, &bus) >= 0) ? bus : -1;
+#if ONLPLIB_CONFIG_INCLUDE_I2C == 1
+            order[count].root = (bus >= 0) ? onlp_i2c_bus_root(bus) : -1;
+#else
+            order[count].root = bus;
+#endif
+            count++;
+        }
+    }
+    result->count = count;
+
+    /*
+     * Visit ports grouped by root adapter, then by bus (mux channel),
+     * so accesses to the same channel are consecutive.
+     */
+    qsort(order, count, sizeof(order[0]), sfp_dom_order_compare__);
+    for(i = 0; i < count; i++) {
+        if(i > 0 && order[i].root != order[i-1].root) {
+            groups++;
+        }
+        group[i] = groups;
+    }
+    if(count) {
+        groups++;
+    }
+
+    if((flags & ONLP_SFP_DOM_BATCH_F_PARALLEL) && SFP_DOM_BATCH_PARALLEL__) {
+        threads = (groups < AIM_ARRAYSIZE(jobs)) ? groups : AIM_ARRAYSIZE(jobs);
+        if(threads < 1) {
+            threads = 1;
+        }
+    }
+
+    for(i = 0; i < threads; i++) {
+        jobs[i].result = result;
+        jobs[i].fields = fields;
+        jobs[i].order = order;
+        jobs[i].count = count;
+        jobs[i].group = group;
+        jobs[i].start = i;
+        jobs[i].stride = threads;
+        jobs[i].started = 0;
+    }
+
+    /* Thread 0 runs in the caller. Fall back to it if a thread can't start. */
+    for(i = 1; i < threads; i++) {
+        if(pthread_create(&jobs[i].thread, NULL, sfp_dom_job__, jobs + i) == 0) {
+            jobs[i].started = 1;
+        }
+        else {
+            AIM_LOG_ERROR("Failed to start SFP DOM thread.");
+            sfp_dom_job__(jobs + i);
+        }
+    }
+    sfp_dom_job__(jobs + 0);
+    for(i = 1; i < threads; i++) {
+        if(jobs[i].started) {
+            pthread_join(jobs[i].thread, NULL);
+        }
+    }
+
+    rv = 0;
+    for(i = 0; i < count; i++) {
+        if(result->status[i] >= 0) {
+            rv++;
+        }
+    }
+    return rv;
+}
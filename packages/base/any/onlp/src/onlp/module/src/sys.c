@@ -26,8 +26,11 @@
 #include <onlp/platformi/sysi.h>
 #include <onlplib/mmap.h>
 #include <AIM/aim.h>
+#include <errno.h>
+#include <unistd.h>
 #include "onlp_log.h"
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_GLOBAL
 #include "onlp_locks.h"
 
 static char*
@@ -121,52 +124,325 @@ onie_data_get__(int* free)
 }
 
 static int
-onlp_sys_info_get_locked__(onlp_sys_info_t* rv)
+onie_info_read__(onlp_onie_info_t* info);
+
+#if ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE == 1
+
+/**
+ * System Inventory Snapshot
+ *
+ * The ONIE and platform information are read and decoded once and
+ * then served from memory, so OID iteration does not touch the
+ * EEPROM. The snapshot is only discarded by onlp_sys_info_invalidate(),
+ * which must be called after the ONIE EEPROM has been written.
+ *
+ * When shared, the raw EEPROM image is also kept in shared memory so
+ * that only the first ONLP process reads the EEPROM. Invalidation
+ * bumps the shared generation number, which tells the other processes
+ * to drop their decoded snapshots.
+ *
+ * The API may be called by concurrent readers, so the snapshot has
+ * its own lock.
+ */
+#include <pthread.h>
+
+static pthread_mutex_t inventory_lock__ = PTHREAD_MUTEX_INITIALIZER;
+
+static struct {
+    int valid;
+    uint32_t generation;
+    onlp_onie_info_t onie_info;
+    onlp_platform_info_t platform_info;
+    uint64_t hits;
+    uint64_t loads;
+} inventory__;
+
+#if ONLP_CONFIG_SYS_INFO_CACHE_SHARED == 1
+#include <onlplib/shlocks.h>
+
+/** The shared memory keys for the EEPROM image and its lock. */
+#define ONLP_SYS_INVENTORY_SHMEM_KEY 0xF00DCAC6
+#define ONLP_SYS_INVENTORY_SHLOCK_KEY 0xF00DCAC7
+
+/** The maximum size of a TlvInfo EEPROM image. */
+#define ONLP_SYS_INVENTORY_IMAGE_MAX 2048
+
+/** TlvInfo header: "TlvInfo\0", version, total length (big-endian). */
+#define ONLP_SYS_INVENTORY_TLV_HDR_SIZE 11
+
+typedef struct onlp_sys_inventory_shared_s {
+    uint32_t magic;
+    uint32_t generation;
+    /** The size of the image. Zero if it has not been read. */
+    uint32_t size;
+    uint8_t image[ONLP_SYS_INVENTORY_IMAGE_MAX];
+} onlp_sys_inventory_shared_t;
+
+#define ONLP_SYS_INVENTORY_MAGIC 0x1D7E0001
+
+static onlp_sys_inventory_shared_t* shared__ = NULL;
+static onlp_shlock_t* shlock__ = NULL;
+
+static onlp_sys_inventory_shared_t*
+inventory_shared__(void)
 {
-    if(rv == NULL) {
+    if(shared__ == NULL && shlock__ == NULL) {
+        onlp_sys_inventory_shared_t* s = NULL;
+        if(onlp_shlock_create(ONLP_SYS_INVENTORY_SHLOCK_KEY, &shlock__,
+                              "onlp-sys-inventory-lock") < 0) {
+            shlock__ = NULL;
+            return NULL;
+        }
+        if(onlp_shmem_create(ONLP_SYS_INVENTORY_SHMEM_KEY, sizeof(*s),
+                             (void**)&s) >= 0) {
+            onlp_shlock_take(shlock__);
+            if(s->magic != ONLP_SYS_INVENTORY_MAGIC) {
+                memset(s, 0, sizeof(*s));
+                s->magic = ONLP_SYS_INVENTORY_MAGIC;
+            }
+            onlp_shlock_give(shlock__);
+            shared__ = s;
+        }
+    }
+    return shared__;
+}
+
+static uint32_t
+inventory_shared_generation__(void)
+{
+    uint32_t generation = 0;
+    onlp_sys_inventory_shared_t* s = inventory_shared__();
+    if(s) {
+        onlp_shlock_take(shlock__);
+        generation = s->generation;
+        onlp_shlock_give(shlock__);
+    }
+    return generation;
+}
+
+/**
+ * Decode the shared EEPROM image, if there is one.
+ */
+static int
+inventory_shared_decode__(onlp_onie_info_t* info)
+{
+    uint8_t image[ONLP_SYS_INVENTORY_IMAGE_MAX];
+    uint32_t size = 0;
+    onlp_sys_inventory_shared_t* s = inventory_shared__();
+
+    if(s == NULL) {
         return -1;
     }
+    onlp_shlock_take(shlock__);
+    if(s->size && s->size <= sizeof(image)) {
+        size = s->size;
+        ONLP_MEMCPY(image, s->image, size);
+    }
+    onlp_shlock_give(shlock__);
 
-    memset(rv, 0, sizeof(*rv));
+    if(size == 0) {
+        return -1;
+    }
+    if(onlp_onie_decode(info, image, size) < 0) {
+        onlp_onie_info_free(info);
+        return -1;
+    }
+    return 0;
+}
 
-    /**
-     * Get the system ONIE information.
+/**
+ * Publish a valid EEPROM image.
+ */
+static void
+inventory_shared_store__(const uint8_t* data)
+{
+    uint32_t size;
+    onlp_sys_inventory_shared_t* s = inventory_shared__();
+
+    if(s == NULL || memcmp(data, "TlvInfo", 8)) {
+        return;
+    }
+    size = ONLP_SYS_INVENTORY_TLV_HDR_SIZE + ((data[9] << 8) | data[10]);
+    if(size > sizeof(s->image)) {
+        return;
+    }
+    onlp_shlock_take(shlock__);
+    ONLP_MEMCPY(s->image, data, size);
+    s->size = size;
+    onlp_shlock_give(shlock__);
+}
+
+#else
+
+#define inventory_shared_generation__() 0
+#define inventory_shared_decode__(_info) -1
+#define inventory_shared_store__(_data)
+
+#endif /* ONLP_CONFIG_SYS_INFO_CACHE_SHARED */
+
+static void
+inventory_clear__(void)
+{
+    if(inventory__.valid) {
+        onlp_onie_info_free(&inventory__.onie_info);
+        onlp_sysi_platform_info_free(&inventory__.platform_info);
+        inventory__.valid = 0;
+    }
+}
+
+static void
+inventory_get__(onlp_onie_info_t* onie_info, onlp_platform_info_t* platform_info)
+{
+    int rv = 0;
+    uint32_t generation = inventory_shared_generation__();
+
+    pthread_mutex_lock(&inventory_lock__);
+
+    if(inventory__.valid && inventory__.generation != generation) {
+        inventory_clear__();
+    }
+
+    if(inventory__.valid) {
+        inventory__.hits++;
+    }
+    else {
+        memset(&inventory__.onie_info, 0, sizeof(inventory__.onie_info));
+        memset(&inventory__.platform_info, 0, sizeof(inventory__.platform_info));
+        if(inventory_shared_decode__(&inventory__.onie_info) < 0) {
+            rv = onie_info_read__(&inventory__.onie_info);
+        }
+        onlp_sysi_platform_info_get(&inventory__.platform_info);
+        inventory__.generation = generation;
+        inventory__.valid = 1;
+        inventory__.loads++;
+    }
+
+    onlp_onie_info_copy(onie_info, &inventory__.onie_info);
+    platform_info->cpld_versions = inventory__.platform_info.cpld_versions ?
+        aim_strdup(inventory__.platform_info.cpld_versions) : NULL;
+    platform_info->other_versions = inventory__.platform_info.other_versions ?
+        aim_strdup(inventory__.platform_info.other_versions) : NULL;
+
+    /*
+     * Only a successful read is kept. After a failure this call
+     * gets what could be read and the next call reads again.
      */
+    if(rv < 0) {
+        inventory_clear__();
+    }
+
+    pthread_mutex_unlock(&inventory_lock__);
+}
+
+void
+onlp_sys_info_invalidate(void)
+{
+#if ONLP_CONFIG_SYS_INFO_CACHE_SHARED == 1
+    onlp_sys_inventory_shared_t* s = inventory_shared__();
+    if(s) {
+        onlp_shlock_take(shlock__);
+        s->size = 0;
+        s->generation++;
+        onlp_shlock_give(shlock__);
+    }
+#endif
+    pthread_mutex_lock(&inventory_lock__);
+    inventory_clear__();
+    pthread_mutex_unlock(&inventory_lock__);
+}
+
+void
+onlp_sys_info_cache_show(aim_pvs_t* pvs)
+{
+    pthread_mutex_lock(&inventory_lock__);
+    aim_printf(pvs, "System inventory (%s): %s generation=%u hits=%"PRIu64" loads=%"PRIu64"\n",
+               ONLP_CONFIG_SYS_INFO_CACHE_SHARED ? "shared" : "private",
+               inventory__.valid ? "valid" : "empty",
+               inventory__.generation, inventory__.hits, inventory__.loads);
+    pthread_mutex_unlock(&inventory_lock__);
+}
+
+#else
+
+#define inventory_shared_store__(_data)
+
+void
+onlp_sys_info_invalidate(void)
+{
+}
+
+void
+onlp_sys_info_cache_show(aim_pvs_t* pvs)
+{
+    aim_printf(pvs, "System inventory cache support not available in this build.\n");
+}
+
+#endif /* ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE */
+
+static int
+onie_info_read__(onlp_onie_info_t* info)
+{
+    int rv;
     int free;
     uint8_t* onie_data = onie_data_get__(&free);
 
     if(onie_data) {
-        onlp_onie_decode(&rv->onie_info, onie_data, -1);
+        if( (rv = onlp_onie_decode(info, onie_data, -1)) == 0) {
+            inventory_shared_store__(onie_data);
+        }
         if(free) {
             onlp_sysi_onie_data_free(onie_data);
         }
     }
     else {
-        if(onlp_sysi_onie_info_get(&rv->onie_info) != 0) {
-            memset(&rv->onie_info, 0, sizeof(rv->onie_info));
-            list_init(&rv->onie_info.vx_list);
+        if( (rv = onlp_sysi_onie_info_get(info)) != 0) {
+            memset(info, 0, sizeof(*info));
+            list_init(&info->vx_list);
         }
     }
+    /* A platform without ONIE information will not get one later. */
+    return (rv < 0 && rv != ONLP_STATUS_E_UNSUPPORTED) ? rv : 0;
+}
 
-    /*
-     * Query the sys oids
+static int
+onlp_sys_info_get_locked__(onlp_sys_info_t* rv)
+{
+    if(rv == NULL) {
+        return -1;
+    }
+
+    memset(rv, 0, sizeof(*rv));
+
+    /**
+     * Get the system ONIE and Platform Information.
      */
-    onlp_sysi_oids_get(rv->hdr.coids, AIM_ARRAYSIZE(rv->hdr.coids));
+#if ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE == 1
+    inventory_get__(&rv->onie_info, &rv->platform_info);
+#else
+    onie_info_read__(&rv->onie_info);
+    onlp_sysi_platform_info_get(&rv->platform_info);
+#endif
 
     /*
-     * Platform Information
+     * Query the sys oids
      */
-    onlp_sysi_platform_info_get(&rv->platform_info);
+    onlp_sysi_oids_get(rv->hdr.coids, AIM_ARRAYSIZE(rv->hdr.coids));
 
     return 0;
 }
-ONLP_LOCKED_API1(onlp_sys_info_get,onlp_sys_info_t*,rv);
+ONLP_LOCKED_RAPI1(onlp_sys_info_get,onlp_sys_info_t*,rv);
 
 void
 onlp_sys_info_free(onlp_sys_info_t* info)
 {
     onlp_onie_info_free(&info->onie_info);
+#if ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE == 1
+    /* The platform information is a copy of the snapshot. */
+    aim_free(info->platform_info.cpld_versions);
+    aim_free(info->platform_info.other_versions);
+#else
     onlp_sysi_platform_info_free(&info->platform_info);
+#endif
 }
 
 static int
@@ -175,7 +451,15 @@ onlp_sys_hdr_get_locked__(onlp_oid_hdr_t* hdr)
     memset(hdr, 0, sizeof(*hdr));
     return onlp_sysi_oids_get(hdr->coids, AIM_ARRAYSIZE(hdr->coids));
 }
-ONLP_LOCKED_API1(onlp_sys_hdr_get, onlp_oid_hdr_t*, hdr);
+ONLP_LOCKED_RAPI1(onlp_sys_hdr_get, onlp_oid_hdr_t*, hdr);
+
+static int
+onlp_sys_oids_get_locked__(onlp_oid_t* table, int max)
+{
+    memset(table, 0, max*sizeof(*table));
+    return onlp_sysi_oids_get(table, max);
+}
+ONLP_LOCKED_RAPI2(onlp_sys_oids_get, onlp_oid_t*, table, int, max);
 
 
 void
@@ -184,6 +468,8 @@ onlp_sys_dump(onlp_oid_t id, aim_pvs_t* pvs, uint32_t flags)
     int rv;
     iof_t iof;
     onlp_sys_info_t si;
+    onlp_oid_t oid;
+    onlp_oid_iter_t iter;
 
     onlp_oid_dump_iof_init_default(&iof, pvs);
 
@@ -202,8 +488,11 @@ onlp_sys_dump(onlp_oid_t id, aim_pvs_t* pvs, uint32_t flags)
         onlp_onie_show(&si.onie_info, &iof.inherit);
         iof_pop(&iof);
     }
-    onlp_oid_table_dump(si.hdr.coids, pvs, flags);
     onlp_sys_info_free(&si);
+
+    ONLP_OID_CHILD_ITER(ONLP_OID_SYS, iter, oid) {
+        onlp_oid_dump(oid, pvs, flags);
+    }
 }
 
 void
@@ -244,34 +533,35 @@ onlp_sys_show(onlp_oid_t id, aim_pvs_t* pvs, uint32_t flags)
 
     if(flags & ONLP_OID_SHOW_RECURSE) {
 
-        onlp_oid_t* oidp;
+        onlp_oid_t oid;
+        onlp_oid_iter_t iter;
 
         /** Show all Chassis Fans */
         YPUSH("Fans:");
-        ONLP_OID_TABLE_ITER_TYPE(si.hdr.coids, oidp, FAN) {
-            onlp_oid_show(*oidp, &iof.inherit, flags);
+        ONLP_OID_CHILD_ITER_TYPE(ONLP_OID_SYS, iter, oid, FAN) {
+            onlp_oid_show(oid, &iof.inherit, flags);
         }
         YPOP();
 
         /** Show all System Thermals */
         YPUSH("Thermals:");
-        ONLP_OID_TABLE_ITER_TYPE(si.hdr.coids, oidp, THERMAL) {
-            onlp_oid_show(*oidp, &iof.inherit, flags);
+        ONLP_OID_CHILD_ITER_TYPE(ONLP_OID_SYS, iter, oid, THERMAL) {
+            onlp_oid_show(oid, &iof.inherit, flags);
         }
         YPOP();
 
         /** Show all PSUs */
         YPUSH("PSUs:");
-        ONLP_OID_TABLE_ITER_TYPE(si.hdr.coids, oidp, PSU) {
-            onlp_oid_show(*oidp, &iof.inherit, flags);
+        ONLP_OID_CHILD_ITER_TYPE(ONLP_OID_SYS, iter, oid, PSU) {
+            onlp_oid_show(oid, &iof.inherit, flags);
         }
         YPOP();
 
         if(flags & ONLP_OID_SHOW_EXTENDED) {
             /** Show all LEDs */
             YPUSH("LEDs:");
-            ONLP_OID_TABLE_ITER_TYPE(si.hdr.coids, oidp, LED) {
-                onlp_oid_show(*oidp, &iof.inherit, flags);
+            ONLP_OID_CHILD_ITER_TYPE(ONLP_OID_SYS, iter, oid, LED) {
+                onlp_oid_show(oid, &iof.inherit, flags);
             }
             YPOP();
         }
@@ -303,3 +593,59 @@ onlp_sys_debug_locked__(aim_pvs_t* pvs, int argc, char* argv[])
     return onlp_sysi_debug(pvs, argc, argv);
 }
 ONLP_LOCKED_API3(onlp_sys_debug, aim_pvs_t*, pvs, int, argc, char**, argv);
+
+int
+onlp_sys_debug_script(aim_pvs_t* pvs, const char* path)
+{
+    char line[512];
+    int lineno = 0;
+    FILE* fp;
+
+    if((fp = fopen(path, "r")) == NULL) {
+        aim_printf(pvs, "%s: %s\n", path, strerror(errno));
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    while(fgets(line, sizeof(line), fp)) {
+        char* argv[16];
+        char* save = NULL;
+        char* tok;
+        int argc = 0, rv;
+
+        lineno++;
+        for(tok = strtok_r(line, " \t\r\n", &save);
+            tok && argc < AIM_ARRAYSIZE(argv);
+            tok = strtok_r(NULL, " \t\r\n", &save)) {
+            argv[argc++] = tok;
+        }
+        if(argc == 0 || argv[0][0] == '#') {
+            continue;
+        }
+
+        /*
+         * Each command takes the API lock on its own. Sleeps run
+         * without it so other clients keep running meanwhile.
+         */
+        if(!strcmp(argv[0], "sleep")) {
+            if(argc < 2) {
+                rv = ONLP_STATUS_E_PARAM;
+            }
+            else {
+                usleep(atoi(argv[1])*1000);
+                rv = ONLP_STATUS_OK;
+            }
+        }
+        else {
+            rv = onlp_sys_debug(pvs, argc, argv);
+        }
+
+        if(rv < 0) {
+            aim_printf(pvs, "%s:%d: failed: %{onlp_status}\n", path, lineno, rv);
+            fclose(fp);
+            return rv;
+        }
+    }
+
+    fclose(fp);
+    return ONLP_STATUS_OK;
+}
@@ -26,7 +26,9 @@
 #include <onlp/platformi/thermali.h>
 #include <onlp/oids.h>
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_THERMAL
 #include "onlp_locks.h"
+#include "onlp_cache.h"
 
 #define VALIDATE(_id)                           \
     do {                                        \
@@ -50,6 +52,21 @@ onlp_thermal_init_locked__(void)
 }
 ONLP_LOCKED_API0(onlp_thermal_init);
 
+static int
+onlp_thermali_info_get_cached__(onlp_oid_t oid, onlp_thermal_info_t* info)
+{
+    int rv;
+
+    if(ONLP_CACHE_GET(oid, info)) {
+        return ONLP_STATUS_OK;
+    }
+    rv = onlp_thermali_info_get(oid, info);
+    if(ONLP_SUCCESS(rv)) {
+        ONLP_CACHE_SET(oid, info);
+    }
+    return rv;
+}
+
 #if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
 
 static int
@@ -80,7 +97,7 @@ onlp_thermal_info_get_locked__(onlp_oid_t oid, onlp_thermal_info_t* info)
     int rv;
     VALIDATE(oid);
 
-    rv = onlp_thermali_info_get(oid, info);
+    rv = onlp_thermali_info_get_cached__(oid, info);
     if(rv >= 0) {
 
 #if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
@@ -94,7 +111,7 @@ onlp_thermal_info_get_locked__(onlp_oid_t oid, onlp_thermal_info_t* info)
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_thermal_info_get, onlp_oid_t, oid, onlp_thermal_info_t*, info);
+ONLP_LOCKED_RAPI2(onlp_thermal_info_get, onlp_oid_t, oid, onlp_thermal_info_t*, info);
 
 static int
 onlp_thermal_status_get_locked__(onlp_oid_t id, uint32_t* status)
@@ -105,12 +122,12 @@ onlp_thermal_status_get_locked__(onlp_oid_t id, uint32_t* status)
     }
     if(ONLP_UNSUPPORTED(rv)) {
         onlp_thermal_info_t ti;
-        rv = onlp_thermali_info_get(id, &ti);
+        rv = onlp_thermali_info_get_cached__(id, &ti);
         *status = ti.status;
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_thermal_status_get, onlp_oid_t, id, uint32_t*, status);
+ONLP_LOCKED_RAPI2(onlp_thermal_status_get, onlp_oid_t, id, uint32_t*, status);
 
 static int
 onlp_thermal_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr)
@@ -121,12 +138,12 @@ onlp_thermal_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr)
     }
     if(ONLP_UNSUPPORTED(rv)) {
         onlp_thermal_info_t ti;
-        rv = onlp_thermali_info_get(id, &ti);
+        rv = onlp_thermali_info_get_cached__(id, &ti);
         memcpy(hdr, &ti.hdr, sizeof(ti.hdr));
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_thermal_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
+ONLP_LOCKED_RAPI2(onlp_thermal_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
 int
 onlp_thermal_ioctl(int code, ...)
 {
@@ -32,7 +32,11 @@
 
 #include <AIM/aim.h>
 #include <onlp/onlp.h>
+#include <onlp/cmis.h>
+#include <onlp/sfp.h>
+#include <onlp/platformi/sfpi.h>
 #include <onlplib/shlocks.h>
+#include <OS/os_time.h>
 
 /**
  * Base functionality unit tests.
@@ -63,6 +67,14 @@
 #define TRYNR(_expr) ___TRYNR("  ", _expr, "\r")
 #define TEST(_expr) __TRYNR("", _expr, "\n");
 
+#define CHECK(_expr)                                            \
+    do {                                                        \
+        if(!(_expr)) {                                          \
+            AIM_DIE("%s:%d: check failed: %s",                  \
+                    __FILE__, __LINE__, #_expr);                \
+        }                                                       \
+    } while(0)
+
 /**
  * Test Shared Locks
  */
@@ -94,6 +106,293 @@ onie_test(void)
     /* TODO */
 }
 
+/**
+ * A stand-in CMIS module for the bring-up engine.
+ *
+ * It replaces the platform's SFP interface with a single port.
+ * The module answers paged memory reads and writes, and steps
+ * through power up, configuration and data path activation a
+ * few reads after the engine asks it to.
+ */
+#define FAKE_CMIS_PORT 1
+#define FAKE_CMIS_PAGES 0x12
+
+static struct {
+    int present;
+    uint8_t lower[128];
+    uint8_t upper[FAKE_CMIS_PAGES][128];
+    /** Reads of the module state until power up completes. */
+    int pwrup_reads;
+    /** Reads of the config status until the result is reported. */
+    int config_reads;
+    /** The config status reported for the applied lanes. */
+    uint8_t config_result;
+    /** Reads of the data path state until activation completes. */
+    int dp_reads;
+    /** Fail the write which restores page 0. */
+    int fail_page_restore;
+} fake_cmis__;
+
+static uint8_t*
+fake_cmis_byte__(int page, int addr)
+{
+    if(addr < 128) {
+        return fake_cmis__.lower + addr;
+    }
+    AIM_TRUE_OR_DIE(page < FAKE_CMIS_PAGES, "fake CMIS page 0x%x", page);
+    return fake_cmis__.upper[page] + addr - 128;
+}
+
+static void
+fake_cmis_lanes_set__(int page, int addr, uint8_t lanes, int nibble, int other)
+{
+    int lane;
+    uint8_t* p = fake_cmis_byte__(page, addr);
+    memset(p, 0, 4);
+    for(lane = 0; lane < 8; lane++) {
+        p[lane / 2] |= ((lanes & (1 << lane)) ? nibble : other) << ((lane & 1) * 4);
+    }
+}
+
+static uint8_t
+fake_cmis_read__(int page, int addr)
+{
+    if(addr == 3 && fake_cmis__.pwrup_reads > 0 && --fake_cmis__.pwrup_reads == 0) {
+        /* ModuleReady */
+        fake_cmis__.lower[3] = 3 << 1;
+    }
+    if(page == 0x11 && addr == 202 && fake_cmis__.config_reads > 0 &&
+       --fake_cmis__.config_reads == 0) {
+        fake_cmis_lanes_set__(0x11, 202, *fake_cmis_byte__(0x10, 143),
+                              fake_cmis__.config_result, 0);
+    }
+    if(page == 0x11 && addr == 128 && fake_cmis__.dp_reads > 0 &&
+       --fake_cmis__.dp_reads == 0) {
+        /* DataPathActivated on every lane which is not held in deinit. */
+        fake_cmis_lanes_set__(0x11, 128, ~*fake_cmis_byte__(0x10, 128), 4, 1);
+    }
+    return *fake_cmis_byte__(page, addr);
+}
+
+static void
+fake_cmis_write__(int page, int addr, uint8_t value)
+{
+    *fake_cmis_byte__(page, addr) = value;
+
+    if(addr == 26 && !(value & 0x10) && fake_cmis__.lower[3] == (1 << 1)) {
+        /* Leave ModuleLowPwr through ModulePwrUp. */
+        fake_cmis__.lower[3] = 2 << 1;
+        fake_cmis__.pwrup_reads = 2;
+    }
+    if(page == 0x10 && addr == 143) {
+        /* ApplyDPInit: ConfigInProgress, then the result. */
+        fake_cmis_lanes_set__(0x11, 202, value, 0xC, 0);
+        fake_cmis__.config_reads = 2;
+    }
+    if(page == 0x10 && addr == 128) {
+        fake_cmis__.dp_reads = 2;
+    }
+}
+
+static void
+fake_cmis_insert__(uint8_t identifier, uint8_t revision)
+{
+    static const uint8_t apps[] = {
+        /* 200GAUI-4 on 4 host and 4 media lanes, starting on lane 1 or 5. */
+        0x0F, 0x11, 0x44, 0x11,
+        0xFF,
+    };
+
+    memset(&fake_cmis__, 0, sizeof(fake_cmis__));
+    fake_cmis__.lower[0] = identifier;
+    fake_cmis__.lower[1] = revision;
+    /* ModuleLowPwr, with LowPwrRequestSW set. */
+    fake_cmis__.lower[3] = 1 << 1;
+    fake_cmis__.lower[26] = 0x10;
+    memcpy(fake_cmis__.lower + 86, apps, sizeof(apps));
+    /* DataPathDeactivated on every lane. */
+    fake_cmis_lanes_set__(0x11, 128, 0, 0, 1);
+    fake_cmis__.config_result = 0x1;
+    fake_cmis__.present = 1;
+}
+
+int
+onlp_sfpi_init(void)
+{
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_bitmap_get(onlp_sfp_bitmap_t* bmap)
+{
+    AIM_BITMAP_SET(bmap, FAKE_CMIS_PORT);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_is_present(int port)
+{
+    return fake_cmis__.present;
+}
+
+int
+onlp_sfpi_memory_read(int port, uint8_t devaddr, int page, int offset,
+                      int size, uint8_t* rdata)
+{
+    int i;
+    if(!fake_cmis__.present) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    for(i = 0; i < size; i++) {
+        rdata[i] = fake_cmis_read__(page, offset + i);
+    }
+    return size;
+}
+
+int
+onlp_sfpi_dev_writeb(int port, uint8_t devaddr, uint8_t addr, uint8_t value)
+{
+    if(!fake_cmis__.present) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    if(addr == 127 && value == 0 && fake_cmis__.fail_page_restore) {
+        return ONLP_STATUS_E_I2C;
+    }
+    fake_cmis_write__(fake_cmis__.lower[127], addr, value);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_dev_write(int port, uint8_t devaddr, uint8_t addr, uint8_t* data, int size)
+{
+    int i;
+    if(!fake_cmis__.present) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    for(i = 0; i < size; i++) {
+        fake_cmis_write__(fake_cmis__.lower[127], addr + i, data[i]);
+    }
+    return ONLP_STATUS_OK;
+}
+
+/**
+ * Run the engine until the port reaches the given state.
+ */
+static void
+cmis_wait__(onlp_cmis_state_t state, int timeout_ms)
+{
+    onlp_cmis_port_status_t s;
+    uint64_t deadline = os_time_monotonic() + timeout_ms * 1000ULL;
+
+    for(;;) {
+        uint64_t next;
+        onlp_cmis_poll(&next);
+        CHECK(onlp_cmis_port_status_get(FAKE_CMIS_PORT, &s) == ONLP_STATUS_OK);
+        if(s.state == state) {
+            return;
+        }
+        if(os_time_monotonic() > deadline) {
+            AIM_DIE("CMIS port %d is %s, expected %s (%s)", FAKE_CMIS_PORT,
+                    onlp_cmis_state_name(s.state), onlp_cmis_state_name(state),
+                    s.error);
+        }
+        usleep((next < 10000) ? next : 10000);
+    }
+}
+
+/**
+ * Test the CMIS bring-up engine against the stand-in module.
+ */
+void
+cmis_test(void)
+{
+    uint8_t value = 0;
+    onlp_cmis_port_status_t s;
+    onlp_cmis_port_config_t config = { 0 };
+
+    TRY(onlp_cmis_port_status_get(FAKE_CMIS_PORT, &s));
+    CHECK(s.state == ONLP_CMIS_STATE_DISABLED);
+    CHECK(!strcmp(onlp_cmis_state_name(ONLP_CMIS_STATE_DP_INIT), "dp-init"));
+    CHECK(onlp_cmis_port_enable(FAKE_CMIS_PORT + 1, NULL) == ONLP_STATUS_E_PARAM);
+
+    /* No module. */
+    TRY(onlp_cmis_port_enable(FAKE_CMIS_PORT, NULL));
+    cmis_wait__(ONLP_CMIS_STATE_ABSENT, 1000);
+
+    /* Insertion through every state to ACTIVE, on both data paths. */
+    fake_cmis_insert__(0x18, 0x50);
+    cmis_wait__(ONLP_CMIS_STATE_ACTIVE, 5000);
+    TRY(onlp_cmis_port_status_get(FAKE_CMIS_PORT, &s));
+    CHECK(s.identifier == 0x18 && s.revision == 0x50 && !s.flat);
+    CHECK(s.appsel == 1 && s.host_interface == 0x0F && s.host_lanes == 0xFF);
+    CHECK(s.bringups == 1 && s.faults == 0);
+    CHECK(s.total_time >= s.pwrup_time + s.config_time + s.dpinit_time);
+    /* Low power released, every data path up, transmitters on, page 0 selected. */
+    CHECK((fake_cmis__.lower[26] & 0x50) == 0);
+    CHECK(*fake_cmis_byte__(0x10, 128) == 0x00);
+    CHECK(*fake_cmis_byte__(0x10, 130) == 0x00);
+    CHECK(fake_cmis__.lower[127] == 0);
+
+    /* Removal. */
+    fake_cmis__.present = 0;
+    cmis_wait__(ONLP_CMIS_STATE_ABSENT, 3000);
+
+    /* A rejected configuration faults until the port is restarted. */
+    fake_cmis_insert__(0x18, 0x50);
+    fake_cmis__.config_result = 0x2;
+    cmis_wait__(ONLP_CMIS_STATE_FAULT, 5000);
+    TRY(onlp_cmis_port_status_get(FAKE_CMIS_PORT, &s));
+    CHECK(s.faults == 1 && s.error[0]);
+    fake_cmis_insert__(0x18, 0x50);
+    TRY(onlp_cmis_port_restart(FAKE_CMIS_PORT));
+    cmis_wait__(ONLP_CMIS_STATE_ACTIVE, 5000);
+    TRY(onlp_cmis_port_status_get(FAKE_CMIS_PORT, &s));
+    CHECK(s.bringups == 2 && s.error[0] == 0);
+
+    /* Host lane selection keeps the other data path down. */
+    config.appsel = 1;
+    config.host_lanes = 0x0F;
+    TRY(onlp_cmis_port_enable(FAKE_CMIS_PORT, &config));
+    fake_cmis_insert__(0x18, 0x50);
+    cmis_wait__(ONLP_CMIS_STATE_ACTIVE, 5000);
+    TRY(onlp_cmis_port_status_get(FAKE_CMIS_PORT, &s));
+    CHECK(s.host_lanes == 0x0F && s.bringups == 3);
+    CHECK(*fake_cmis_byte__(0x10, 128) == 0xF0);
+    CHECK(*fake_cmis_byte__(0x10, 130) == 0xF0);
+
+    /* A module which returns to low power is brought up again. */
+    fake_cmis__.lower[3] = 1 << 1;
+    fake_cmis__.lower[26] = 0x10;
+    cmis_wait__(ONLP_CMIS_STATE_INSERTED, 3000);
+    cmis_wait__(ONLP_CMIS_STATE_ACTIVE, 5000);
+    TRY(onlp_cmis_port_status_get(FAKE_CMIS_PORT, &s));
+    CHECK(s.bringups == 4);
+
+    /* An unadvertised application faults. */
+    config.appsel = 2;
+    TRY(onlp_cmis_port_enable(FAKE_CMIS_PORT, &config));
+    fake_cmis_insert__(0x18, 0x50);
+    cmis_wait__(ONLP_CMIS_STATE_FAULT, 5000);
+
+    /* Not a CMIS module. */
+    TRY(onlp_cmis_port_enable(FAKE_CMIS_PORT, NULL));
+    fake_cmis_insert__(0x11, 0x08);
+    cmis_wait__(ONLP_CMIS_STATE_UNSUPPORTED, 3000);
+
+    /* A paged write fails if page 0 cannot be restored. */
+    fake_cmis_insert__(0x18, 0x50);
+    CHECK(onlp_sfp_memory_write(FAKE_CMIS_PORT, 0x50, 0x10, 130, 1, &value) == 1);
+    fake_cmis__.fail_page_restore = 1;
+    CHECK(onlp_sfp_memory_write(FAKE_CMIS_PORT, 0x50, 0x10, 130, 1, &value) < 0);
+    fake_cmis__.fail_page_restore = 0;
+
+    onlp_cmis_show(&aim_pvs_stdout);
+    TRY(onlp_cmis_port_disable(FAKE_CMIS_PORT));
+    TRY(onlp_cmis_port_status_get(FAKE_CMIS_PORT, &s));
+    CHECK(s.state == ONLP_CMIS_STATE_DISABLED);
+    fake_cmis__.present = 0;
+}
+
 int
 iter__(onlp_oid_t oid, void* cookie)
 {
@@ -115,16 +414,17 @@ aim_main(int argc, char* argv[])
 
     /* Example Platform Dump */
     onlp_init();
+    TEST(cmis_test());
     onlp_platform_dump(&aim_pvs_stdout, ONLP_OID_DUMP_RECURSE);
     onlp_oid_iterate(0, 0, iter__, NULL);
     onlp_platform_show(&aim_pvs_stdout, ONLP_OID_SHOW_RECURSE|ONLP_OID_SHOW_EXTENDED);
 
     if(argv[1] && !strcmp("manage", argv[1])) {
-        onlp_sys_platform_manage_start();
+        onlp_sys_platform_manage_start(0);
         printf("Sleeping...\n");
         sleep(10);
         printf("Stopping...\n");
-        onlp_sys_platform_manage_stop();
+        onlp_sys_platform_manage_stop(1);
         printf("Stopped.\n");
     }
     return 0;
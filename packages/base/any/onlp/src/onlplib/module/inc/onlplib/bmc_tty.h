@@ -0,0 +1,131 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * BMC console transport.
+ *
+ * Some platforms can only reach their sensors through a shell on
+ * the BMC's serial console. Commands are framed with markers so
+ * that they complete as soon as their output and the shell prompt
+ * have arrived, instead of after a fixed delay.
+ *
+ * The console is shared by all ONLP processes. A shared memory lock
+ * makes the holder the only user of the console for the duration of
+ * a command, and file values read from the BMC are kept in a shared
+ * cache for config.cache_ms milliseconds so that concurrent or
+ * back-to-back pollers do not repeat the same reads.
+ *
+ ***********************************************************/
+#ifndef __ONLPLIB_BMC_TTY_H__
+#define __ONLPLIB_BMC_TTY_H__
+
+#include <onlplib/onlplib_config.h>
+#include <sys/types.h>
+#include <stdint.h>
+
+/**
+ * BMC console configuration.
+ */
+typedef struct onlp_bmc_tty_config_s {
+    /** The console device. The ONLP_BMC_TTY_DEVICE environment variable overrides it. */
+    const char* device;
+    /** The console baudrate (termios Bxxx value). */
+    int baudrate;
+    /** A string which identifies the shell prompt. */
+    const char* prompt;
+    /** Login credentials. */
+    const char* user;
+    const char* password;
+    /**
+     * Optional login function, called instead of sending the
+     * credentials when the console shows a login prompt.
+     */
+    int (*login)(void);
+    /** The shared memory key for the console lock and cache. */
+    key_t key;
+    /** File value cache lifetime in milliseconds. 0 disables the cache. */
+    int cache_ms;
+} onlp_bmc_tty_config_t;
+
+/**
+ * @brief Initialize the BMC console.
+ * @param config The configuration. It must remain valid.
+ * @notes The console is opened and logged in on first use.
+ */
+int onlp_bmc_tty_init(const onlp_bmc_tty_config_t* config);
+
+/**
+ * @brief Close this process' console descriptor.
+ */
+void onlp_bmc_tty_deinit(void);
+
+/**
+ * @brief Run a shell command on the BMC.
+ * @param cmd The command.
+ * @param [out] rsp Receives the command output. May be NULL.
+ * @param max The size of rsp.
+ * @param [out] exit_status Receives the command exit status. May be NULL.
+ * @returns The output length, or an error.
+ * @note The command may change BMC state, so the shared file value
+ * cache is discarded. Use onlp_bmc_tty_query() for read-only commands.
+ */
+int onlp_bmc_tty_exec(const char* cmd, char* rsp, int max, int* exit_status);
+
+/**
+ * @brief Run a read-only shell command on the BMC.
+ * @note As onlp_bmc_tty_exec(), but the file value cache is kept.
+ */
+int onlp_bmc_tty_query(const char* cmd, char* rsp, int max, int* exit_status);
+
+/**
+ * @brief Read several BMC files with a single command.
+ * @param files The file paths.
+ * @param count The number of files.
+ * @param [out] values Receives each file's contents, without
+ * trailing whitespace. Each buffer must hold vmax bytes.
+ * @param vmax The size of each value buffer.
+ * @param [out] status Receives the status of each read. May be NULL.
+ * @returns ONLP_STATUS_OK if every file was read.
+ */
+int onlp_bmc_tty_file_read_batch(const char** files, int count,
+                                 char** values, int vmax, int* status);
+
+/**
+ * @brief Read a BMC file.
+ * @param file The file path.
+ * @param [out] value Receives the contents, without trailing whitespace.
+ * @param max The size of value.
+ */
+int onlp_bmc_tty_file_read_str(const char* file, char* value, int max);
+
+/**
+ * @brief Read an integer from a BMC file.
+ * @param [out] value Receives the value.
+ * @param file The file path.
+ * @param base The number base (0 to accept any prefix).
+ */
+int onlp_bmc_tty_file_read_int(int* value, const char* file, int base);
+
+/**
+ * @brief Discard all cached file values.
+ */
+void onlp_bmc_tty_cache_invalidate(void);
+
+#endif /* __ONLPLIB_BMC_TTY_H__ */
@@ -0,0 +1,64 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Transceiver module EEPROM access through a network interface.
+ *
+ * Some platforms only expose their transceiver EEPROMs through
+ * the NIC driver (ethtool -m). These routines read the module
+ * EEPROM in-process, using the ethtool netlink interface when
+ * available (per page, bank and device address) and the
+ * ETHTOOL_GMODULEEEPROM ioctl otherwise.
+ *
+ ***********************************************************/
+#ifndef __ONLPLIB_ETHTOOL_H__
+#define __ONLPLIB_ETHTOOL_H__
+
+#include <onlplib/onlplib_config.h>
+#include <stdint.h>
+
+/**
+ * @brief Get a network interface's module EEPROM type and length.
+ * @param ifname The interface name.
+ * @param [out] type Receives the ETH_MODULE_SFF_* type. May be NULL.
+ * @param [out] len Receives the EEPROM length exported by the ioctl. May be NULL.
+ * @returns ONLP_STATUS_OK, ONLP_STATUS_E_MISSING if no module is
+ * present, or an error.
+ */
+int onlp_ethtool_module_info_get(const char* ifname, int* type, int* len);
+
+/**
+ * @brief Read a network interface's module EEPROM.
+ * @param ifname The interface name.
+ * @param devaddr The device address (0x50 or 0x51).
+ * @param page The upper memory page. Ignored for offsets below 128.
+ * @param bank The bank (CMIS). Use 0 otherwise.
+ * @param offset The offset within the 256 byte device address space.
+ * @param size The byte count. offset + size must not exceed 256.
+ * @param [out] data Receives the data.
+ * @notes The ioctl fallback only reaches the pages exported in its
+ * linear layout (SFF-8472 A0h/A2h, SFF-8636 pages 0-3, CMIS page 0)
+ * and does not support banks.
+ */
+int onlp_ethtool_module_eeprom_read(const char* ifname, uint8_t devaddr,
+                                    int page, int bank, int offset, int size,
+                                    uint8_t* data);
+
+#endif /* __ONLPLIB_ETHTOOL_H__ */
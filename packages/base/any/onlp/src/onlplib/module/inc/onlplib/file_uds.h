@@ -54,6 +54,16 @@
  * Standardizing on this method allows all system ONLP clients to access
  * all data, even if that data is present only in seperate processes.
  *
+ * Each service also listens on a session path (the service path
+ * with a ".session" suffix). The onlp_file_read and onlp_file_write
+ * functions keep their session connections open and reuse them for
+ * subsequent requests. Each request is passed to the service handler
+ * on a descriptor which holds the client's data (writes) or receives
+ * the handler's response (reads), so handlers are written exactly as
+ * for a one-shot connection. Connections to the service path itself,
+ * such as those opened with onlp_file_open(), are still one-shot: the
+ * handler is called on the socket itself.
+ *
  *
  ***********************************************************/
 #ifndef __ONLPLIB_FILE_UDS_H__
@@ -75,9 +85,12 @@ int onlp_file_uds_create(onlp_file_uds_t** fuds);
 
 /**
  * @brief This is the prototype for your service handler function.
- * @param fd The client file descriptor. This is the descriptor accepted
- * on your behalf by the service manager when someone attempts to open your domain socket.
+ * @param fd The client file descriptor. Read the client's data from it
+ * or write your response to it.
  * @param cookie Private callback pointer.
+ * @notes The descriptor is closed by the service manager. Handlers are
+ * called from a pool of ONLPLIB_CONFIG_FILE_UDS_WORKER_THREADS threads
+ * and may run concurrently.
  */
 typedef int (*onlp_file_uds_handler_t)(int fd, void* cookie);
 
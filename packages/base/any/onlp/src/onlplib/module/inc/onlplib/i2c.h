@@ -77,6 +77,14 @@
  */
 #define ONLP_I2C_F_DISABLE_READ_RETRIES 0x80
 
+/**
+ * Read using combined I2C_RDWR transactions (offset write followed
+ * by a repeated-start read of up to ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE
+ * bytes) if the adapter supports plain I2C transfers.
+ * Falls back to SMBus transfers if it does not.
+ */
+#define ONLP_I2C_F_USE_RDWR_READ 0x100
+
 /**
  * @brief Open and prepare for reading or writing.
  * @param bus The i2c bus number.
@@ -182,6 +190,74 @@ int onlp_i2c_writew(int bus, uint8_t addr, uint8_t offset, uint16_t word,
                     uint32_t flags);
 
 
+/****************************************************************************
+ *
+ * I2C Descriptor Cache.
+ *
+ * The onlp_i2c_* and onlp_i2c_dev_* transfer functions can keep up to
+ * ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE prepared descriptors open, keyed
+ * by (bus, addr, flags). The cache is disabled by default (size 0).
+ *
+ * An open descriptor holds a reference on its adapter: deleting a
+ * mux channel or unloading its driver waits until the descriptor is
+ * closed. Cached descriptors are therefore closed once they have been
+ * unused for ONLPLIB_CONFIG_I2C_FD_CACHE_IDLE_MS. Idle descriptors are
+ * reaped on the next cached access, so a process which stops
+ * accessing i2c devices keeps its last descriptors open. Use
+ * onlp_i2c_fd_cache_invalidate() before removing an adapter.
+ *
+ * A descriptor is discarded after any failed transfer and reopened
+ * on the next access. When a transfer or open fails with ENODEV or
+ * ENXIO every descriptor on that bus is closed.
+ *
+ * The cache and its statistics are per process.
+ *
+ ***************************************************************************/
+
+/**
+ * I2C descriptor cache statistics.
+ */
+typedef struct onlp_i2c_fd_cache_stats_s {
+    /** Number of descriptors opened and prepared. */
+    uint64_t opens;
+    /** Number of opens avoided by reusing a cached descriptor. */
+    uint64_t opens_avoided;
+    /** Number of cached descriptors discarded after a transfer error. */
+    uint64_t errors;
+    /** Number of cached descriptors closed by eviction or invalidation. */
+    uint64_t evictions;
+} onlp_i2c_fd_cache_stats_t;
+
+/**
+ * @brief Close all cached descriptors for the given bus.
+ * @param bus The i2c bus number, or -1 for all busses.
+ * @note Call this when a bus is removed or renumbered (for example
+ * after loading or unloading an i2c mux driver).
+ */
+void onlp_i2c_fd_cache_invalidate(int bus);
+
+/**
+ * @brief Get the descriptor cache statistics.
+ * @param stats [out] Receives the statistics of the calling process.
+ */
+void onlp_i2c_fd_cache_stats_get(onlp_i2c_fd_cache_stats_t* stats);
+
+/**
+ * @brief Show the descriptor cache statistics.
+ * @param pvs The output pvs.
+ */
+void onlp_i2c_fd_cache_show(aim_pvs_t* pvs);
+
+/**
+ * @brief Get the root adapter of an i2c bus.
+ * @param bus The bus number.
+ * @returns The bus number of the adapter at the top of the mux tree
+ * containing bus, or bus itself if it cannot be determined.
+ * @note Buses sharing a root adapter contend for the same physical bus.
+ */
+int onlp_i2c_bus_root(int bus);
+
+
 
 /****************************************************************************
  *
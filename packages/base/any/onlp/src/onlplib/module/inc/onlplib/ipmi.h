@@ -0,0 +1,215 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * In-process IPMI client.
+ *
+ * Requests are sent to the BMC through the kernel IPMI device
+ * interface (ONLPLIB_CONFIG_IPMI_DEVICE) instead of running
+ * ipmitool. Several requests may be in flight at once; their
+ * responses are matched by message id.
+ *
+ * Sensors are located by name through a cache of the BMC's
+ * Sensor Data Repository, which is read once per process.
+ *
+ * Another transport (a BMC reached some other way, or a stand-in
+ * for testing) may be installed with onlp_ipmi_transport_set().
+ *
+ ***********************************************************/
+#ifndef __ONLPLIB_IPMI_H__
+#define __ONLPLIB_IPMI_H__
+
+#include <onlplib/onlplib_config.h>
+#include <stdint.h>
+
+#define ONLP_IPMI_NETFN_CHASSIS 0x00
+#define ONLP_IPMI_NETFN_SENSOR  0x04
+#define ONLP_IPMI_NETFN_APP     0x06
+#define ONLP_IPMI_NETFN_STORAGE 0x0A
+
+/** Maximum request or response data length. */
+#define ONLP_IPMI_DATA_MAX 255
+
+/**
+ * A raw IPMI request.
+ */
+typedef struct onlp_ipmi_request_s {
+    uint8_t netfn;
+    uint8_t cmd;
+    /** The target LUN. */
+    uint8_t lun;
+    const uint8_t* data;
+    int data_len;
+
+    /** Receives the response data, without the completion code. */
+    uint8_t* rsp;
+    int rsp_max;
+    int rsp_len;
+
+    /** The completion code. */
+    uint8_t ccode;
+    /** The request status. */
+    int status;
+} onlp_ipmi_request_t;
+
+/**
+ * @brief Send a raw request and wait for its response.
+ * @param netfn The network function.
+ * @param cmd The command.
+ * @param data The request data.
+ * @param data_len The request data length.
+ * @param [out] rsp Receives the response data (without the completion code).
+ * @param rsp_max The size of rsp.
+ * @param [out] rsp_len Receives the response data length. May be NULL.
+ * @returns ONLP_STATUS_OK, ONLP_STATUS_E_MISSING if there is no IPMI
+ * device, or an error (including a nonzero completion code).
+ */
+int onlp_ipmi_raw(uint8_t netfn, uint8_t cmd,
+                  const uint8_t* data, int data_len,
+                  uint8_t* rsp, int rsp_max, int* rsp_len);
+
+/**
+ * @brief Send a batch of raw requests.
+ * @param requests The requests.
+ * @param count The number of requests.
+ * @returns ONLP_STATUS_OK if every request completed successfully.
+ * @notes Up to ONLPLIB_CONFIG_IPMI_OUTSTANDING_MAX requests are kept
+ * in flight. The status of each request is reported in its status field.
+ */
+int onlp_ipmi_raw_batch(onlp_ipmi_request_t* requests, int count);
+
+/**
+ * A sensor, as described by its SDR record.
+ */
+typedef struct onlp_ipmi_sensor_s {
+    char name[17];
+    uint8_t number;
+    uint8_t lun;
+    /** The SDR record type (full or compact). */
+    uint8_t record_type;
+    uint8_t sensor_type;
+    uint8_t unit;
+
+    /** Reading conversion (full sensor records only). */
+    uint8_t analog_format;
+    uint8_t linearization;
+    int m;
+    int b;
+    int b_exp;
+    int r_exp;
+} onlp_ipmi_sensor_t;
+
+/**
+ * @brief Look up a sensor by name.
+ * @param name The SDR ID string.
+ * @param [out] sensor Receives the sensor.
+ * @returns ONLP_STATUS_OK or ONLP_STATUS_E_MISSING.
+ */
+int onlp_ipmi_sensor_find(const char* name, onlp_ipmi_sensor_t* sensor);
+
+/**
+ * @brief Read a sensor.
+ * @param sensor The sensor.
+ * @param [out] value Receives the converted reading.
+ * @returns ONLP_STATUS_OK, ONLP_STATUS_E_MISSING if the reading is
+ * unavailable, or an error.
+ */
+int onlp_ipmi_sensor_read(const onlp_ipmi_sensor_t* sensor, double* value);
+
+/**
+ * @brief Read a sensor by name.
+ * @param name The SDR ID string.
+ * @param [out] value Receives the converted reading.
+ */
+int onlp_ipmi_sensor_read_name(const char* name, double* value);
+
+/**
+ * @brief Read several sensors by name in a single batch.
+ * @param names The SDR ID strings.
+ * @param count The number of sensors.
+ * @param [out] values Receives the converted readings.
+ * @param [out] status Receives the status of each reading. May be NULL.
+ * @returns ONLP_STATUS_OK if every sensor was read.
+ */
+int onlp_ipmi_sensors_read(const char** names, int count,
+                           double* values, int* status);
+
+/**
+ * FRU product info area fields, in area order.
+ */
+typedef enum onlp_ipmi_fru_product_field_e {
+    ONLP_IPMI_FRU_PRODUCT_MANUFACTURER,
+    ONLP_IPMI_FRU_PRODUCT_NAME,
+    ONLP_IPMI_FRU_PRODUCT_PART_NUMBER,
+    ONLP_IPMI_FRU_PRODUCT_VERSION,
+    ONLP_IPMI_FRU_PRODUCT_SERIAL,
+    ONLP_IPMI_FRU_PRODUCT_ASSET_TAG,
+} onlp_ipmi_fru_product_field_t;
+
+/**
+ * @brief Read a field of a FRU's product info area.
+ * @param fru The FRU device id.
+ * @param field The field.
+ * @param [out] value Receives the field as a string.
+ * @param size The size of value.
+ * @returns ONLP_STATUS_OK, ONLP_STATUS_E_MISSING if the FRU has no
+ * such field, ONLP_STATUS_E_UNSUPPORTED if the field is not 8-bit
+ * ASCII, or an error.
+ */
+int onlp_ipmi_fru_product_get(uint8_t fru, onlp_ipmi_fru_product_field_t field,
+                              char* value, int size);
+
+/**
+ * @brief Discard the SDR cache.
+ * @notes The cache is reloaded on the next sensor lookup.
+ */
+void onlp_ipmi_sdr_invalidate(void);
+
+/**
+ * A request transport.
+ */
+typedef struct onlp_ipmi_transport_s {
+    /**
+     * Send a request. The response must carry the same msgid.
+     * Returns 0 or an error.
+     */
+    int (*send)(void* cookie, const onlp_ipmi_request_t* r, long msgid);
+
+    /**
+     * Wait up to timeout_ms for one response.
+     * Stores the completion code followed by the response data in
+     * data (at least ONLP_IPMI_DATA_MAX + 1 bytes) and returns 1,
+     * returns 0 on timeout, or < 0 on error. A msgid of -1 marks
+     * a message which is not a response and is ignored.
+     */
+    int (*recv)(void* cookie, uint8_t* data, int* len, long* msgid,
+                int timeout_ms);
+
+    void* cookie;
+} onlp_ipmi_transport_t;
+
+/**
+ * @brief Replace the kernel IPMI device with another transport.
+ * @param transport The transport. NULL restores the kernel device.
+ * @notes The SDR cache is discarded.
+ */
+void onlp_ipmi_transport_set(const onlp_ipmi_transport_t* transport);
+
+#endif /* __ONLPLIB_IPMI_H__ */
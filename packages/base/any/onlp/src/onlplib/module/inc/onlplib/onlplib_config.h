@@ -165,6 +165,146 @@
 #define ONLPLIB_CONFIG_INCLUDE_I2C_SMBUS 0
 #endif
 
+/**
+ * ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE
+ *
+ * Maximum number of i2c file descriptors kept open for reuse. 0 disables the descriptor cache. */
+
+
+#ifndef ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE
+#define ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE 0
+#endif
+
+/**
+ * ONLPLIB_CONFIG_I2C_FD_CACHE_IDLE_MS
+ *
+ * Milliseconds a cached i2c file descriptor may stay unused before it is closed. */
+
+
+#ifndef ONLPLIB_CONFIG_I2C_FD_CACHE_IDLE_MS
+#define ONLPLIB_CONFIG_I2C_FD_CACHE_IDLE_MS 1000
+#endif
+
+/**
+ * ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE
+ *
+ * Maximum read size of a single combined I2C_RDWR transaction. */
+
+
+#ifndef ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE
+#define ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE 256
+#endif
+
+/**
+ * ONLPLIB_CONFIG_INCLUDE_ETHTOOL_NETLINK
+ *
+ * Use the ethtool netlink interface (Linux 5.13 and later) for paged module EEPROM reads before falling back to the ETHTOOL_GMODULEEEPROM ioctl. */
+
+
+#ifndef ONLPLIB_CONFIG_INCLUDE_ETHTOOL_NETLINK
+#define ONLPLIB_CONFIG_INCLUDE_ETHTOOL_NETLINK 1
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_DEVICE
+ *
+ * IPMI device used by the in-process IPMI client. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_DEVICE
+#define ONLPLIB_CONFIG_IPMI_DEVICE "/dev/ipmi0"
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_TIMEOUT_MS
+ *
+ * IPMI response timeout in milliseconds. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_TIMEOUT_MS
+#define ONLPLIB_CONFIG_IPMI_TIMEOUT_MS 5000
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_OUTSTANDING_MAX
+ *
+ * Maximum number of IPMI requests in flight at once. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_OUTSTANDING_MAX
+#define ONLPLIB_CONFIG_IPMI_OUTSTANDING_MAX 8
+#endif
+
+/**
+ * ONLPLIB_CONFIG_FILE_UDS_WORKER_THREADS
+ *
+ * Number of handler threads per domain socket service manager. */
+
+
+#ifndef ONLPLIB_CONFIG_FILE_UDS_WORKER_THREADS
+#define ONLPLIB_CONFIG_FILE_UDS_WORKER_THREADS 4
+#endif
+
+/**
+ * ONLPLIB_CONFIG_FILE_UDS_CLIENT_IDLE_MAX
+ *
+ * Maximum number of idle domain socket client connections kept open for reuse. 0 disables connection reuse. */
+
+
+#ifndef ONLPLIB_CONFIG_FILE_UDS_CLIENT_IDLE_MAX
+#define ONLPLIB_CONFIG_FILE_UDS_CLIENT_IDLE_MAX 8
+#endif
+
+/**
+ * ONLPLIB_CONFIG_FILE_UDS_DATA_MAX
+ *
+ * Maximum domain socket request or response payload size. */
+
+
+#ifndef ONLPLIB_CONFIG_FILE_UDS_DATA_MAX
+#define ONLPLIB_CONFIG_FILE_UDS_DATA_MAX 65536
+#endif
+
+/**
+ * ONLPLIB_CONFIG_BMC_TTY_TIMEOUT_MS
+ *
+ * Maximum time in milliseconds to wait for the completion of a BMC console command. */
+
+
+#ifndef ONLPLIB_CONFIG_BMC_TTY_TIMEOUT_MS
+#define ONLPLIB_CONFIG_BMC_TTY_TIMEOUT_MS 3000
+#endif
+
+/**
+ * ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE
+ *
+ * BMC console response buffer size. */
+
+
+#ifndef ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE
+#define ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE 16384
+#endif
+
+/**
+ * ONLPLIB_CONFIG_BMC_TTY_BATCH_CMD_MAX
+ *
+ * Maximum length of a batched BMC console file read command. */
+
+
+#ifndef ONLPLIB_CONFIG_BMC_TTY_BATCH_CMD_MAX
+#define ONLPLIB_CONFIG_BMC_TTY_BATCH_CMD_MAX 512
+#endif
+
+/**
+ * ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES
+ *
+ * Number of BMC file values kept in the shared BMC console cache. */
+
+
+#ifndef ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES
+#define ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES 128
+#endif
+
 
 
 /**
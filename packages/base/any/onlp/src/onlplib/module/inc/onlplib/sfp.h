@@ -62,4 +62,22 @@ int onlplib_sfp_reset_file(const char* file, const char* first, int delay_ms,
  * to implement your onlp_sfpi_eeprom_read() interface. */
 int onlplib_sfp_eeprom_read_file(const char* fname, uint8_t data[256]);
 
+/**
+ * @brief Read a range of transceiver memory from an optoe eeprom file.
+ * @param fname The optoe eeprom filename.
+ * @param optoe2 Nonzero if the device is an optoe2 (SFP, 0x50 and 0x51)
+ * device, zero for optoe1/optoe3 (QSFP/CMIS, 0x50 only) devices.
+ * @param devaddr The device address (0x50 or 0x51).
+ * @param page The upper memory page. Ignored for offsets below 128.
+ * @param offset The offset within the 256 byte device address space.
+ * @param size The byte count.
+ * @param data Receives the data.
+ * @notes The optoe driver selects the page itself, so only
+ * the requested bytes are transferred. You can use this function
+ * to implement your onlp_sfpi_memory_read() interface.
+ */
+int onlplib_sfp_memory_read_optoe(const char* fname, int optoe2,
+                                  uint8_t devaddr, int page, int offset,
+                                  int size, uint8_t* data);
+
 #endif /* __ONLPLIB_SFP_H__ */
@@ -63,6 +63,13 @@ int onlp_shlock_destroy(onlp_shlock_t* shlock);
  */
 int onlp_shlock_take(onlp_shlock_t* shlock);
 
+/**
+ * @brief Take a shared memory lock if it is free.
+ * @param shlock The shared lock.
+ * @returns 0 if the lock was taken, 1 if it is held elsewhere.
+ */
+int onlp_shlock_trytake(onlp_shlock_t* shlock);
+
 /**
  * @brief Give a shared memory lock.
  * @param shlock The shared lock.
@@ -94,6 +101,12 @@ void onlp_shlock_global_init(void);
  */
 int onlp_shlock_global_take(void);
 
+/**
+ * @brief Take the global lock if it is free.
+ * @returns 0 if the lock was taken, 1 if it is held elsewhere.
+ */
+int onlp_shlock_global_trytake(void);
+
 /**
  * @brief Give the global lock.
  */
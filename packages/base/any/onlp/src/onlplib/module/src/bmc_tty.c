@@ -0,0 +1,617 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * BMC console transport.
+ *
+ ***********************************************************/
+#include <onlplib/bmc_tty.h>
+#include <onlplib/shlocks.h>
+#include <onlp/onlp.h>
+#include "onlplib_log.h"
+
+#include <AIM/aim.h>
+#include <termios.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Command output is framed by these markers. They are typed with an
+ * embedded empty quote ('@@B""@@') so that the console's echo of the
+ * command line never matches them.
+ */
+#define MARK_BEGIN      "@@B@@\n"
+#define MARK_END        "@@E@@"
+#define MARK_FILE       "@@F@@\n"
+#define MARK_FAIL       "@@X@@"
+#define TYPED_BEGIN     "echo @@B\"\"@@"
+#define TYPED_END       "echo @@E\"\"@@$?"
+#define TYPED_FILE      "echo @@F\"\"@@"
+#define TYPED_FAIL      "echo @@X\"\"@@"
+
+#define LOGIN_TIMEOUT_MS 1000
+#define EXEC_RETRIES     2
+
+typedef struct bmc_tty_cache_entry_s {
+    char file[96];
+    char value[64];
+    uint64_t stamp;
+} bmc_tty_cache_entry_t;
+
+#define BMC_TTY_CACHE_MAGIC 0x424D4354
+
+typedef struct bmc_tty_shared_s {
+    uint32_t magic;
+    /** Replacement cursor */
+    uint32_t next;
+    bmc_tty_cache_entry_t entries[ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES];
+} bmc_tty_shared_t;
+
+static const onlp_bmc_tty_config_t* config__ = NULL;
+static onlp_shlock_t* lock__ = NULL;
+static bmc_tty_shared_t* shared__ = NULL;
+static int fd__ = -1;
+static char* buffer__ = NULL;
+
+
+/************************************************************
+ *
+ * Console Access
+ *
+ ***********************************************************/
+
+static int
+tty_open__(void)
+{
+    struct termios attr;
+    const char* device;
+
+    if(fd__ >= 0) {
+        return 0;
+    }
+
+    device = getenv("ONLP_BMC_TTY_DEVICE");
+    if(device == NULL || *device == 0) {
+        device = config__->device;
+    }
+
+    if((fd__ = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC)) < 0) {
+        AIM_LOG_ERROR("Cannot open BMC console %s: %{errno}", device, errno);
+        return ONLP_STATUS_E_MISSING;
+    }
+
+    if(tcgetattr(fd__, &attr) == 0) {
+        cfmakeraw(&attr);
+        attr.c_cflag |= CLOCAL | CREAD;
+        attr.c_iflag |= IGNPAR | IGNCR;
+        attr.c_cc[VMIN] = 0;
+        attr.c_cc[VTIME] = 0;
+        cfsetospeed(&attr, config__->baudrate);
+        cfsetispeed(&attr, config__->baudrate);
+        tcsetattr(fd__, TCSANOW, &attr);
+    }
+    return 0;
+}
+
+static void
+tty_close__(void)
+{
+    if(fd__ >= 0) {
+        close(fd__);
+        fd__ = -1;
+    }
+}
+
+static int
+tty_write__(const char* s)
+{
+    int len = strlen(s);
+    while(len > 0) {
+        int rv = write(fd__, s, len);
+        if(rv < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            if(errno == EAGAIN) {
+                struct pollfd pfd = { fd__, POLLOUT, 0 };
+                poll(&pfd, 1, 100);
+                continue;
+            }
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        s += rv;
+        len -= rv;
+    }
+    return 0;
+}
+
+/**
+ * Read console output into buffer__ until str (or alt, if not NULL)
+ * appears at or after offset 'from', or the timeout expires.
+ * Returns the offset of the match or -1.
+ */
+static int
+tty_read_until_any__(int* len, int from, const char* str, const char* alt,
+                     int timeout_ms)
+{
+    uint64_t deadline = aim_time_monotonic() + timeout_ms*1000ULL;
+
+    for(;;) {
+        struct pollfd pfd = { fd__, POLLIN, 0 };
+        char* p;
+        int rv;
+        int64_t remaining;
+
+        buffer__[*len] = 0;
+        if(from <= *len) {
+            if((p = strstr(buffer__ + from, str)) != NULL ||
+               (alt && (p = strstr(buffer__ + from, alt)) != NULL)) {
+                return p - buffer__;
+            }
+        }
+
+        remaining = (int64_t)(deadline - aim_time_monotonic());
+        if(remaining <= 0 || *len >= ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE - 1) {
+            return -1;
+        }
+
+        rv = poll(&pfd, 1, (int)(remaining/1000) + 1);
+        if(rv < 0 && errno != EINTR) {
+            return -1;
+        }
+        if(rv > 0) {
+            rv = read(fd__, buffer__ + *len, ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE - 1 - *len);
+            if(rv > 0) {
+                /* NUL bytes from the console would hide the rest of the buffer. */
+                int i;
+                for(i = 0; i < rv; i++) {
+                    if(buffer__[*len + i] == 0) {
+                        buffer__[*len + i] = ' ';
+                    }
+                }
+                *len += rv;
+            }
+        }
+    }
+}
+
+static int
+tty_read_until__(int* len, int from, const char* str, int timeout_ms)
+{
+    return tty_read_until_any__(len, from, str, NULL, timeout_ms);
+}
+
+/**
+ * Get to a shell prompt, logging in if necessary.
+ */
+static int
+tty_login__(void)
+{
+    int len = 0, i;
+
+    for(i = 0; i < 2; i++) {
+        tcflush(fd__, TCIFLUSH);
+        tty_write__("\r");
+        if(tty_read_until_any__(&len, 0, config__->prompt, "login:",
+                                LOGIN_TIMEOUT_MS) >= 0) {
+            break;
+        }
+    }
+    if(strstr(buffer__, "login:") == NULL) {
+        return (strstr(buffer__, config__->prompt)) ? 0 : ONLP_STATUS_E_INTERNAL;
+    }
+
+    if(config__->login) {
+        if(config__->login() < 0) {
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        len = 0;
+        tty_write__("\r");
+    }
+    else {
+        len = 0;
+        tty_write__(config__->user);
+        tty_write__("\r");
+        if(tty_read_until__(&len, 0, "assword:", LOGIN_TIMEOUT_MS) < 0) {
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        len = 0;
+        tty_write__(config__->password);
+        tty_write__("\r");
+    }
+
+    if(tty_read_until__(&len, 0, config__->prompt, LOGIN_TIMEOUT_MS*3) < 0) {
+        AIM_LOG_ERROR("BMC console login failed.");
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return 0;
+}
+
+/**
+ * Run a command and locate its framed output in buffer__.
+ * Called with the console lock held.
+ */
+static int
+tty_exec_locked__(const char* cmd, char** output, int* exit_status)
+{
+    int attempt, rv;
+    int opened = (fd__ < 0);
+
+    if( (rv = tty_open__()) < 0) {
+        return rv;
+    }
+
+    for(attempt = 0; attempt <= EXEC_RETRIES; attempt++) {
+        int len = 0, begin, end;
+        char* line;
+
+        if(attempt > 0 || opened) {
+            opened = 0;
+            /* Resynchronize with the shell. */
+            if(tty_login__() < 0) {
+                continue;
+            }
+        }
+
+        tcflush(fd__, TCIFLUSH);
+        line = aim_fstrdup("%s; %s; %s\r", TYPED_BEGIN, cmd, TYPED_END);
+        rv = tty_write__(line);
+        aim_free(line);
+        if(rv < 0) {
+            break;
+        }
+
+        if((begin = tty_read_until__(&len, 0, MARK_BEGIN,
+                                     ONLPLIB_CONFIG_BMC_TTY_TIMEOUT_MS)) < 0) {
+            continue;
+        }
+        begin += strlen(MARK_BEGIN);
+        if((end = tty_read_until__(&len, begin, MARK_END,
+                                   ONLPLIB_CONFIG_BMC_TTY_TIMEOUT_MS)) < 0) {
+            continue;
+        }
+        /* Wait for the prompt so the next command starts on a clean line. */
+        tty_read_until__(&len, end, config__->prompt, ONLPLIB_CONFIG_BMC_TTY_TIMEOUT_MS);
+
+        if(exit_status) {
+            *exit_status = atoi(buffer__ + end + strlen(MARK_END));
+        }
+        buffer__[end] = 0;
+        *output = buffer__ + begin;
+        return end - begin;
+    }
+
+    AIM_LOG_ERROR("BMC console command failed: %s", cmd);
+    tty_close__();
+    return ONLP_STATUS_E_INTERNAL;
+}
+
+
+/************************************************************
+ *
+ * Shared File Cache
+ *
+ ***********************************************************/
+
+static bmc_tty_cache_entry_t*
+cache_find_locked__(const char* file)
+{
+    int i;
+    if(shared__ == NULL) {
+        return NULL;
+    }
+    for(i = 0; i < ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES; i++) {
+        if(!strcmp(shared__->entries[i].file, file)) {
+            return shared__->entries + i;
+        }
+    }
+    return NULL;
+}
+
+static int
+cache_get_locked__(const char* file, char* value, int max)
+{
+    bmc_tty_cache_entry_t* e;
+
+    if(config__->cache_ms <= 0 || (e = cache_find_locked__(file)) == NULL) {
+        return 0;
+    }
+    if(aim_time_monotonic() - e->stamp > config__->cache_ms*1000ULL) {
+        return 0;
+    }
+    aim_strlcpy(value, e->value, max);
+    return 1;
+}
+
+static void
+cache_set_locked__(const char* file, const char* value)
+{
+    bmc_tty_cache_entry_t* e;
+
+    if(shared__ == NULL || config__->cache_ms <= 0 ||
+       strlen(file) >= sizeof(e->file) || strlen(value) >= sizeof(e->value)) {
+        return;
+    }
+
+    if((e = cache_find_locked__(file)) == NULL) {
+        e = shared__->entries + (shared__->next++ % ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES);
+        aim_strlcpy(e->file, file, sizeof(e->file));
+    }
+    aim_strlcpy(e->value, value, sizeof(e->value));
+    e->stamp = aim_time_monotonic();
+}
+
+static void
+cache_invalidate_locked__(void)
+{
+    int i;
+
+    if(shared__ == NULL) {
+        return;
+    }
+    for(i = 0; i < ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES; i++) {
+        shared__->entries[i].stamp = 0;
+    }
+}
+
+void
+onlp_bmc_tty_cache_invalidate(void)
+{
+    if(lock__ == NULL) {
+        return;
+    }
+    onlp_shlock_take(lock__);
+    cache_invalidate_locked__();
+    onlp_shlock_give(lock__);
+}
+
+
+/************************************************************
+ *
+ * Public Interfaces
+ *
+ ***********************************************************/
+
+int
+onlp_bmc_tty_init(const onlp_bmc_tty_config_t* config)
+{
+    if(config__) {
+        return 0;
+    }
+
+    if(onlp_shlock_create(config->key, &lock__, "bmc-tty-lock") < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    /* The cache is an optimization only. */
+    if(onlp_shmem_create(config->key + 1, sizeof(bmc_tty_shared_t),
+                         (void**)&shared__) < 0) {
+        shared__ = NULL;
+    }
+    else if(shared__->magic != BMC_TTY_CACHE_MAGIC) {
+        onlp_shlock_take(lock__);
+        if(shared__->magic != BMC_TTY_CACHE_MAGIC) {
+            memset(shared__, 0, sizeof(*shared__));
+            shared__->magic = BMC_TTY_CACHE_MAGIC;
+        }
+        onlp_shlock_give(lock__);
+    }
+
+    buffer__ = aim_zmalloc(ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE);
+    config__ = config;
+    return 0;
+}
+
+void
+onlp_bmc_tty_deinit(void)
+{
+    if(lock__) {
+        onlp_shlock_take(lock__);
+        tty_close__();
+        onlp_shlock_give(lock__);
+    }
+}
+
+static int
+exec__(const char* cmd, char* rsp, int max, int* exit_status, int invalidate)
+{
+    char* output;
+    int rv;
+
+    if(config__ == NULL) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    onlp_shlock_take(lock__);
+    rv = tty_exec_locked__(cmd, &output, exit_status);
+    if(rv >= 0 && rsp) {
+        aim_strlcpy(rsp, output, max);
+    }
+    if(invalidate) {
+        /*
+         * The command may have changed what the cached files report,
+         * even if it failed part way.
+         */
+        cache_invalidate_locked__();
+    }
+    onlp_shlock_give(lock__);
+    return rv;
+}
+
+int
+onlp_bmc_tty_exec(const char* cmd, char* rsp, int max, int* exit_status)
+{
+    return exec__(cmd, rsp, max, exit_status, 1);
+}
+
+int
+onlp_bmc_tty_query(const char* cmd, char* rsp, int max, int* exit_status)
+{
+    return exec__(cmd, rsp, max, exit_status, 0);
+}
+
+/**
+ * Strip trailing whitespace in place.
+ */
+static void
+rstrip__(char* s)
+{
+    int len = strlen(s);
+    while(len > 0 && (s[len-1] == '\n' || s[len-1] == '\r' ||
+                      s[len-1] == ' ' || s[len-1] == '\t')) {
+        s[--len] = 0;
+    }
+}
+
+/**
+ * Read files [first, last) with one command and store their values.
+ * Called with the console lock held.
+ */
+static int
+file_read_chunk_locked__(const char** files, int first, int last,
+                         char** values, int vmax, int* status)
+{
+    char* cmd = aim_zmalloc(ONLPLIB_CONFIG_BMC_TTY_BATCH_CMD_MAX + 128);
+    char* output;
+    char* p;
+    int i, len = 0, rv;
+
+    for(i = first; i < last; i++) {
+        if(status[i] != ONLP_STATUS_E_MISSING) {
+            continue;
+        }
+        len += snprintf(cmd + len, ONLPLIB_CONFIG_BMC_TTY_BATCH_CMD_MAX + 128 - len,
+                        "%s%s; cat %s 2>/dev/null || %s",
+                        (len) ? "; " : "", TYPED_FILE, files[i], TYPED_FAIL);
+    }
+
+    rv = tty_exec_locked__(cmd, &output, NULL);
+    aim_free(cmd);
+    if(rv < 0) {
+        return rv;
+    }
+
+    /* One MARK_FILE section per requested file, in order. */
+    p = output;
+    for(i = first; i < last; i++) {
+        char* next;
+
+        if(status[i] != ONLP_STATUS_E_MISSING) {
+            continue;
+        }
+        if((p = strstr(p, MARK_FILE)) == NULL) {
+            break;
+        }
+        p += strlen(MARK_FILE);
+        if((next = strstr(p, MARK_FILE)) != NULL) {
+            *next = 0;
+        }
+
+        if(strstr(p, MARK_FAIL) == NULL) {
+            aim_strlcpy(values[i], p, vmax);
+            rstrip__(values[i]);
+            cache_set_locked__(files[i], values[i]);
+            status[i] = ONLP_STATUS_OK;
+        }
+
+        if(next == NULL) {
+            break;
+        }
+        *next = '@';
+        p = next;
+    }
+    return 0;
+}
+
+int
+onlp_bmc_tty_file_read_batch(const char** files, int count,
+                             char** values, int vmax, int* status)
+{
+    int* st = status ? status : aim_zmalloc(sizeof(int)*count);
+    int i, first, len, rv = ONLP_STATUS_OK;
+
+    if(config__ == NULL) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    onlp_shlock_take(lock__);
+
+    for(i = 0; i < count; i++) {
+        st[i] = cache_get_locked__(files[i], values[i], vmax) ?
+            ONLP_STATUS_OK : ONLP_STATUS_E_MISSING;
+    }
+
+    /* Group the remaining files into commands of bounded length. */
+    for(first = 0, i = 0, len = 0; i <= count; i++) {
+        int flen = (i < count && st[i] == ONLP_STATUS_E_MISSING) ?
+            strlen(files[i]) + 48 : 0;
+        if(i == count || (len && len + flen > ONLPLIB_CONFIG_BMC_TTY_BATCH_CMD_MAX)) {
+            if(len && file_read_chunk_locked__(files, first, i, values, vmax, st) < 0) {
+                break;
+            }
+            first = i;
+            len = 0;
+        }
+        len += flen;
+    }
+
+    onlp_shlock_give(lock__);
+
+    for(i = 0; i < count; i++) {
+        if(st[i] < 0) {
+            rv = st[i];
+        }
+    }
+    if(st != status) {
+        aim_free(st);
+    }
+    return rv;
+}
+
+int
+onlp_bmc_tty_file_read_str(const char* file, char* value, int max)
+{
+    return onlp_bmc_tty_file_read_batch(&file, 1, &value, max, NULL);
+}
+
+int
+onlp_bmc_tty_file_read_int(int* value, const char* file, int base)
+{
+    char data[32];
+    char* dp = data;
+    char* end;
+    long v;
+    int rv;
+
+    if( (rv = onlp_bmc_tty_file_read_batch(&file, 1, &dp, sizeof(data), NULL)) < 0) {
+        return rv;
+    }
+
+    v = strtol(data, &end, base);
+    if(end == data) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    *value = v;
+    return ONLP_STATUS_OK;
+}
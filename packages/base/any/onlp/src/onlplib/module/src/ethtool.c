@@ -0,0 +1,460 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlp/onlp.h>
+#include <onlplib/ethtool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/ethtool.h>
+#include <linux/sockios.h>
+#include <linux/netlink.h>
+#include <linux/genetlink.h>
+#include "onlplib_log.h"
+
+#define MODULE_EEPROM_PAGE_LEN 128
+
+static int
+ethtool_ioctl__(const char* ifname, void* cmd)
+{
+    int fd, rv;
+    struct ifreq ifr;
+
+    if(strlen(ifname) >= IFNAMSIZ) {
+        return -EINVAL;
+    }
+
+    if((fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+        return -errno;
+    }
+
+    memset(&ifr, 0, sizeof(ifr));
+    strcpy(ifr.ifr_name, ifname);
+    ifr.ifr_data = cmd;
+    rv = ioctl(fd, SIOCETHTOOL, &ifr) < 0 ? -errno : 0;
+    close(fd);
+    return rv;
+}
+
+static int
+errno_status__(int err)
+{
+    switch(err)
+        {
+        case -ENODEV:
+        case -EIO:
+            return ONLP_STATUS_E_MISSING;
+        case -EOPNOTSUPP:
+            return ONLP_STATUS_E_UNSUPPORTED;
+        case -EINVAL:
+        case -ERANGE:
+            return ONLP_STATUS_E_PARAM;
+        default:
+            return ONLP_STATUS_E_INTERNAL;
+        }
+}
+
+int
+onlp_ethtool_module_info_get(const char* ifname, int* type, int* len)
+{
+    int rv;
+    struct ethtool_modinfo modinfo;
+
+    memset(&modinfo, 0, sizeof(modinfo));
+    modinfo.cmd = ETHTOOL_GMODULEINFO;
+
+    if((rv = ethtool_ioctl__(ifname, &modinfo)) < 0) {
+        return errno_status__(rv);
+    }
+
+    if(type) {
+        *type = modinfo.type;
+    }
+    if(len) {
+        *len = modinfo.eeprom_len;
+    }
+    return ONLP_STATUS_OK;
+}
+
+/**
+ * Map a module memory address onto the linear layout
+ * used by ETHTOOL_GMODULEEEPROM.
+ */
+static int
+ethtool_linear_offset__(int type, uint8_t devaddr, int page, int offset)
+{
+    switch(type)
+        {
+        case ETH_MODULE_SFF_8079:
+        case ETH_MODULE_SFF_8472:
+            /* A0h is 0-255, A2h is 256-511. */
+            if(offset >= MODULE_EEPROM_PAGE_LEN && page != 0) {
+                return -1;
+            }
+            return (devaddr == 0x51) ? 256 + offset : offset;
+        default:
+            /* Lower memory, then upper page N at N * 128 + offset. */
+            if(devaddr != 0x50) {
+                return -1;
+            }
+            return (offset < MODULE_EEPROM_PAGE_LEN) ? offset : page * MODULE_EEPROM_PAGE_LEN + offset;
+        }
+}
+
+static int
+ethtool_ioctl_eeprom_read__(const char* ifname, uint8_t devaddr, int page,
+                            int bank, int offset, int size, uint8_t* data)
+{
+    int rv, type, len, linear;
+    union {
+        struct ethtool_eeprom eeprom;
+        uint8_t buf[sizeof(struct ethtool_eeprom) + MODULE_EEPROM_PAGE_LEN];
+    } req;
+
+    if(bank != 0) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    if(ONLP_FAILURE(rv = onlp_ethtool_module_info_get(ifname, &type, &len))) {
+        return rv;
+    }
+
+    linear = ethtool_linear_offset__(type, devaddr, page, offset);
+    if(linear < 0 || linear + size > len) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.eeprom.cmd = ETHTOOL_GMODULEEEPROM;
+    req.eeprom.offset = linear;
+    req.eeprom.len = size;
+
+    if((rv = ethtool_ioctl__(ifname, &req)) < 0) {
+        return errno_status__(rv);
+    }
+    memcpy(data, req.eeprom.data, size);
+    return ONLP_STATUS_OK;
+}
+
+
+#if ONLPLIB_CONFIG_INCLUDE_ETHTOOL_NETLINK == 1
+
+/*
+ * The ethtool generic netlink ABI. These are defined here
+ * rather than taken from <linux/ethtool_netlink.h> so the library
+ * still builds against kernel headers older than 5.13.
+ */
+#define ETHTOOL_GENL_NAME__ "ethtool"
+#define ETHTOOL_GENL_VERSION__ 1
+#define ETHTOOL_MSG_MODULE_EEPROM_GET__ 31
+#define ETHTOOL_A_HEADER_DEV_NAME__ 2
+#define ETHTOOL_A_MODULE_EEPROM_HEADER__ 1
+#define ETHTOOL_A_MODULE_EEPROM_OFFSET__ 2
+#define ETHTOOL_A_MODULE_EEPROM_LENGTH__ 3
+#define ETHTOOL_A_MODULE_EEPROM_PAGE__ 4
+#define ETHTOOL_A_MODULE_EEPROM_BANK__ 5
+#define ETHTOOL_A_MODULE_EEPROM_I2C_ADDRESS__ 6
+#define ETHTOOL_A_MODULE_EEPROM_DATA__ 7
+
+#define NL_BUFFER_SIZE 1024
+
+/*
+ * The netlink socket and the ethtool family are shared by all
+ * callers so an inventory scan does not reopen them per read.
+ * The socket is only used by the process which opened it.
+ */
+static pthread_mutex_t nl_lock__ = PTHREAD_MUTEX_INITIALIZER;
+static int nl_fd__ = -1;
+static pid_t nl_pid__ = 0;
+static int nl_family__ = 0;
+static uint32_t nl_seq__ = 0;
+/* Set when the kernel has no ethtool netlink support. */
+static int nl_unavailable__ = 0;
+
+typedef struct nl_msg_s {
+    union {
+        struct nlmsghdr hdr;
+        uint8_t buf[NL_BUFFER_SIZE];
+    };
+} nl_msg_t;
+
+static struct nlattr*
+nl_attr_put__(nl_msg_t* msg, int type, const void* data, int len)
+{
+    struct nlattr* nla = (struct nlattr*)(msg->buf + NLMSG_ALIGN(msg->hdr.nlmsg_len));
+    nla->nla_type = type;
+    nla->nla_len = NLA_HDRLEN + len;
+    if(len) {
+        memcpy((uint8_t*)nla + NLA_HDRLEN, data, len);
+    }
+    msg->hdr.nlmsg_len = NLMSG_ALIGN(msg->hdr.nlmsg_len) + NLA_ALIGN(nla->nla_len);
+    return nla;
+}
+
+static void
+nl_attr_nest_end__(nl_msg_t* msg, struct nlattr* nest)
+{
+    nest->nla_len = (msg->buf + msg->hdr.nlmsg_len) - (uint8_t*)nest;
+}
+
+static void
+nl_msg_init__(nl_msg_t* msg, int family, int cmd, int version)
+{
+    struct genlmsghdr* genl;
+
+    memset(msg, 0, sizeof(*msg));
+    msg->hdr.nlmsg_len = NLMSG_LENGTH(GENL_HDRLEN);
+    msg->hdr.nlmsg_type = family;
+    msg->hdr.nlmsg_flags = NLM_F_REQUEST;
+    msg->hdr.nlmsg_seq = ++nl_seq__;
+    genl = NLMSG_DATA(&msg->hdr);
+    genl->cmd = cmd;
+    genl->version = version;
+}
+
+/**
+ * Send a request and receive its reply.
+ * Returns the reply length, or -errno.
+ */
+static int
+nl_transact__(nl_msg_t* req, nl_msg_t* reply)
+{
+    int len;
+    struct sockaddr_nl addr;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+
+    if(sendto(nl_fd__, req->buf, req->hdr.nlmsg_len, 0,
+              (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        return -errno;
+    }
+
+    for(;;) {
+        len = recv(nl_fd__, reply->buf, sizeof(reply->buf), 0);
+        if(len < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        if(!NLMSG_OK(&reply->hdr, len)) {
+            return -EPROTO;
+        }
+        /* Discard replies to earlier requests that timed out. */
+        if(reply->hdr.nlmsg_seq != req->hdr.nlmsg_seq) {
+            continue;
+        }
+        if(reply->hdr.nlmsg_type == NLMSG_ERROR) {
+            struct nlmsgerr* err = NLMSG_DATA(&reply->hdr);
+            return err->error ? err->error : -ENOMSG;
+        }
+        return len;
+    }
+}
+
+static struct nlattr*
+nl_attr_find__(nl_msg_t* reply, int type)
+{
+    struct nlattr* nla = (struct nlattr*)((uint8_t*)NLMSG_DATA(&reply->hdr) + GENL_HDRLEN);
+    int remaining = reply->hdr.nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN);
+
+    while(remaining >= (int)NLA_HDRLEN && nla->nla_len >= NLA_HDRLEN &&
+          nla->nla_len <= remaining) {
+        if((nla->nla_type & NLA_TYPE_MASK) == type) {
+            return nla;
+        }
+        remaining -= NLA_ALIGN(nla->nla_len);
+        nla = (struct nlattr*)((uint8_t*)nla + NLA_ALIGN(nla->nla_len));
+    }
+    return NULL;
+}
+
+static int
+nl_open_locked__(void)
+{
+    int rv;
+    struct nlattr* nla;
+    struct sockaddr_nl addr;
+    struct timeval tv = { 1, 0 };
+    nl_msg_t req, reply;
+
+    if(nl_fd__ >= 0) {
+        if(nl_pid__ == getpid()) {
+            return 0;
+        }
+        /*
+         * Inherited across fork(). Replies to requests from either
+         * process could be read by the other, so open our own.
+         */
+        close(nl_fd__);
+        nl_fd__ = -1;
+    }
+
+    if((nl_fd__ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC)) < 0) {
+        nl_unavailable__ = 1;
+        return -errno;
+    }
+    setsockopt(nl_fd__, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    if(bind(nl_fd__, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        rv = -errno;
+        goto error;
+    }
+
+    nl_msg_init__(&req, GENL_ID_CTRL, CTRL_CMD_GETFAMILY, 1);
+    nl_attr_put__(&req, CTRL_ATTR_FAMILY_NAME, ETHTOOL_GENL_NAME__,
+                  sizeof(ETHTOOL_GENL_NAME__));
+
+    if((rv = nl_transact__(&req, &reply)) < 0) {
+        if(rv == -ENOENT) {
+            nl_unavailable__ = 1;
+        }
+        goto error;
+    }
+
+    if((nla = nl_attr_find__(&reply, CTRL_ATTR_FAMILY_ID)) == NULL) {
+        rv = -EPROTO;
+        goto error;
+    }
+    nl_family__ = *(uint16_t*)((uint8_t*)nla + NLA_HDRLEN);
+    nl_pid__ = getpid();
+    return 0;
+
+ error:
+    close(nl_fd__);
+    nl_fd__ = -1;
+    return rv;
+}
+
+static int
+ethtool_nl_eeprom_read__(const char* ifname, uint8_t devaddr, int page,
+                         int bank, int offset, int size, uint8_t* data)
+{
+    int rv;
+    uint32_t u32;
+    uint8_t u8;
+    struct nlattr* nest;
+    struct nlattr* nla;
+    nl_msg_t req, reply;
+
+    pthread_mutex_lock(&nl_lock__);
+
+    if(nl_unavailable__) {
+        rv = -EOPNOTSUPP;
+        goto done;
+    }
+
+    if(nl_open_locked__() < 0) {
+        /* Use the ioctl until netlink can be opened. */
+        rv = -EOPNOTSUPP;
+        goto done;
+    }
+
+    nl_msg_init__(&req, nl_family__, ETHTOOL_MSG_MODULE_EEPROM_GET__,
+                  ETHTOOL_GENL_VERSION__);
+    nest = nl_attr_put__(&req, ETHTOOL_A_MODULE_EEPROM_HEADER__ | NLA_F_NESTED, NULL, 0);
+    nl_attr_put__(&req, ETHTOOL_A_HEADER_DEV_NAME__, ifname, strlen(ifname) + 1);
+    nl_attr_nest_end__(&req, nest);
+    u32 = offset;
+    nl_attr_put__(&req, ETHTOOL_A_MODULE_EEPROM_OFFSET__, &u32, sizeof(u32));
+    u32 = size;
+    nl_attr_put__(&req, ETHTOOL_A_MODULE_EEPROM_LENGTH__, &u32, sizeof(u32));
+    u8 = (offset < MODULE_EEPROM_PAGE_LEN) ? 0 : page;
+    nl_attr_put__(&req, ETHTOOL_A_MODULE_EEPROM_PAGE__, &u8, sizeof(u8));
+    u8 = bank;
+    nl_attr_put__(&req, ETHTOOL_A_MODULE_EEPROM_BANK__, &u8, sizeof(u8));
+    u8 = devaddr;
+    nl_attr_put__(&req, ETHTOOL_A_MODULE_EEPROM_I2C_ADDRESS__, &u8, sizeof(u8));
+
+    if((rv = nl_transact__(&req, &reply)) < 0) {
+        if(rv == -EAGAIN || rv == -EPROTO) {
+            /* Resynchronize on the next request. */
+            close(nl_fd__);
+            nl_fd__ = -1;
+        }
+        goto done;
+    }
+
+    if((nla = nl_attr_find__(&reply, ETHTOOL_A_MODULE_EEPROM_DATA__)) == NULL ||
+       nla->nla_len - NLA_HDRLEN < size) {
+        rv = -EPROTO;
+        goto done;
+    }
+    memcpy(data, (uint8_t*)nla + NLA_HDRLEN, size);
+    rv = 0;
+
+ done:
+    pthread_mutex_unlock(&nl_lock__);
+    return rv;
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_ETHTOOL_NETLINK */
+
+int
+onlp_ethtool_module_eeprom_read(const char* ifname, uint8_t devaddr,
+                                int page, int bank, int offset, int size,
+                                uint8_t* data)
+{
+    int rv = ONLP_STATUS_OK;
+
+    if(devaddr != 0x50 && devaddr != 0x51) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if(offset < 0 || size <= 0 || offset + size > 256 || page < 0 || bank < 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    while(size > 0) {
+        /* Neither interface reads across the lower/upper memory boundary. */
+        int chunk = (offset < MODULE_EEPROM_PAGE_LEN && offset + size > MODULE_EEPROM_PAGE_LEN) ?
+            MODULE_EEPROM_PAGE_LEN - offset : size;
+
+#if ONLPLIB_CONFIG_INCLUDE_ETHTOOL_NETLINK == 1
+        rv = ethtool_nl_eeprom_read__(ifname, devaddr, page, bank, offset, chunk, data);
+        if(rv == -EOPNOTSUPP) {
+            rv = ethtool_ioctl_eeprom_read__(ifname, devaddr, page, bank, offset, chunk, data);
+        }
+        else if(rv < 0) {
+            rv = errno_status__(rv);
+        }
+#else
+        rv = ethtool_ioctl_eeprom_read__(ifname, devaddr, page, bank, offset, chunk, data);
+#endif
+        if(ONLP_FAILURE(rv)) {
+            break;
+        }
+        data += chunk;
+        offset += chunk;
+        size -= chunk;
+    }
+
+    return rv;
+}
@@ -30,7 +30,9 @@
 #include <fcntl.h>
 #include "onlplib_log.h"
 #include <onlp/onlp.h>
+#include "onlplib_int.h"
 #include <errno.h>
+#include <pthread.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <sys/stat.h>
@@ -45,7 +47,7 @@ ds_connect__(const char* path)
     int fd;
     struct sockaddr_un addr;
 
-    if( (fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+    if( (fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0) {
         AIM_LOG_ERROR("socket: %{errno}", errno);
         return -1;
     }
@@ -70,29 +72,225 @@ ds_connect__(const char* path)
         tv.tv_sec = 5;
         tv.tv_usec = 0;
         setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof tv);
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, (const char*)&tv, sizeof tv);
         return fd;
     }
     else {
+        close(fd);
         return ONLP_STATUS_E_MISSING;
     }
 }
 
+#if ONLPLIB_CONFIG_FILE_UDS_CLIENT_IDLE_MAX > 0
+
 /**
- * @brief Open a file or domain socket.
- * @param dst Receives the full filename (for logging purposes).
- * @param flags The open flags.
+ * Idle domain socket connections, kept open for reuse.
+ * Connections are only reused by the process which opened them.
+ */
+typedef struct ds_idle_s {
+    char* path;
+    int fd;
+    pid_t pid;
+} ds_idle_t;
+
+static ds_idle_t ds_idle__[ONLPLIB_CONFIG_FILE_UDS_CLIENT_IDLE_MAX];
+static pthread_mutex_t ds_idle_lock__ = PTHREAD_MUTEX_INITIALIZER;
+
+static int
+ds_idle_get__(const char* path)
+{
+    int i, fd = -1;
+    pid_t pid = getpid();
+
+    pthread_mutex_lock(&ds_idle_lock__);
+    for(i = 0; i < AIM_ARRAYSIZE(ds_idle__); i++) {
+        ds_idle_t* e = ds_idle__ + i;
+        if(e->path == NULL) {
+            continue;
+        }
+        if(e->pid != pid) {
+            /* Inherited across fork(). */
+            close(e->fd);
+            aim_free(e->path);
+            e->path = NULL;
+        }
+        else if(fd < 0 && !strcmp(e->path, path)) {
+            fd = e->fd;
+            aim_free(e->path);
+            e->path = NULL;
+        }
+    }
+    pthread_mutex_unlock(&ds_idle_lock__);
+    return fd;
+}
+
+static void
+ds_idle_put__(const char* path, int fd)
+{
+    int i;
+
+    pthread_mutex_lock(&ds_idle_lock__);
+    for(i = 0; i < AIM_ARRAYSIZE(ds_idle__); i++) {
+        ds_idle_t* e = ds_idle__ + i;
+        if(e->path == NULL) {
+            e->path = aim_strdup(path);
+            e->fd = fd;
+            e->pid = getpid();
+            fd = -1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&ds_idle_lock__);
+
+    if(fd >= 0) {
+        close(fd);
+    }
+}
+
+#else
+
+#define ds_idle_get__(_path) (-1)
+#define ds_idle_put__(_path, _fd) close(_fd)
+
+#endif
+
+/**
+ * @brief Perform a single request on a domain socket connection.
+ * @param fd The connection.
+ * @param op The request type.
+ * @param data The write data, or receives the read data.
+ * @param size The write length or maximum read length.
+ * @param [out] rlen Receives the read length.
+ * @param [out] status Receives the request status.
+ * @returns 0 if the connection can be reused, or -1 on a transport error.
+ */
+static int
+ds_transact__(int fd, uint32_t op, uint8_t* data, int size, int* rlen, int* status)
+{
+    onlp_file_uds_request_t req = { ONLP_FILE_UDS_MAGIC, op, size };
+    onlp_file_uds_response_t rsp;
+
+    if(onlp_file_uds_send_all(fd, &req, sizeof(req)) < 0 ||
+       (op == ONLP_FILE_UDS_OP_WRITE &&
+        onlp_file_uds_send_all(fd, data, size) < 0)) {
+        return -1;
+    }
+
+    if(onlp_file_uds_recv_all(fd, &rsp, sizeof(rsp)) < 0 ||
+       rsp.magic != ONLP_FILE_UDS_MAGIC) {
+        return -1;
+    }
+
+    if(rsp.length > size ||
+       onlp_file_uds_recv_all(fd, data, rsp.length) < 0) {
+        return -1;
+    }
+    *rlen = rsp.length;
+    *status = rsp.status;
+    return 0;
+}
+
+/**
+ * @brief Perform a request on a one-shot domain socket connection.
+ * @param path The socket path.
+ * @param op The request type.
+ * @param data The write data, or receives the read data.
+ * @param size The write length or maximum read length.
+ * @param [out] rlen Receives the read length. May be NULL.
+ */
+static int
+ds_oneshot__(const char* path, uint32_t op, uint8_t* data, int size, int* rlen)
+{
+    int fd, rv, len = 0;
+
+    if( (fd = ds_connect__(path)) < 0) {
+        return ONLP_STATUS_E_MISSING;
+    }
+
+    if(op == ONLP_FILE_UDS_OP_WRITE) {
+        rv = (onlp_file_uds_send_all(fd, data, size) < 0) ?
+            ONLP_STATUS_E_INTERNAL : ONLP_STATUS_OK;
+    }
+    else {
+        while(len < size && (rv = read(fd, data + len, size - len)) > 0) {
+            len += rv;
+        }
+        rv = ONLP_STATUS_OK;
+    }
+    close(fd);
+
+    if(rlen) {
+        *rlen = len;
+    }
+    return rv;
+}
+
+/**
+ * @brief Perform a request on a domain socket service.
+ * @param path The socket path.
+ * @param op The request type.
+ * @param data The write data, or receives the read data.
+ * @param size The write length or maximum read length.
+ * @param [out] rlen Receives the read length. May be NULL.
+ */
+static int
+ds_request__(const char* path, uint32_t op, uint8_t* data, int size, int* rlen)
+{
+    int fd, status, len = 0;
+    int reused;
+    char spath[PATH_MAX];
+
+    if(size > ONLPLIB_CONFIG_FILE_UDS_DATA_MAX) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    ONLPLIB_SNPRINTF(spath, sizeof(spath), "%s%s", path, ONLP_FILE_UDS_SESSION_SUFFIX);
+
+    for(;;) {
+        reused = 1;
+        if( (fd = ds_idle_get__(path)) < 0) {
+            reused = 0;
+            if( (fd = ds_connect__(spath)) < 0) {
+                /* The service does not accept requests (older service manager). */
+                return ds_oneshot__(path, op, data, size, rlen);
+            }
+        }
+
+        if(ds_transact__(fd, op, data, size, &len, &status) == 0) {
+            ds_idle_put__(path, fd);
+            break;
+        }
+        close(fd);
+        if(!reused) {
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        /*
+         * An idle connection may have been closed by the service
+         * (restart or removal). Retry on a new connection.
+         */
+    }
+
+    if(rlen) {
+        *rlen = len;
+    }
+    return status;
+}
+
+/**
+ * @brief Resolve a filename.
+ * @param fname Receives the full filename.
+ * @param size The size of fname.
+ * @param [out] sock Receives whether the file is a domain socket. May be NULL.
  * @param fmt Format specifier.
  * @param vargs Format specifier arguments.
  */
 static int
-vopen__(char** dst, int flags, const char* fmt, va_list vargs)
+vpath__(char* fname, int size, int* sock, const char* fmt, va_list vargs)
 {
-    int fd;
     struct stat sb;
-    char fname[PATH_MAX];
     char* asterisk;
 
-    ONLPLIB_VSNPRINTF(fname, sizeof(fname)-1, fmt, vargs);
+    ONLPLIB_VSNPRINTF(fname, size-1, fmt, vargs);
 
     /**
      * An asterisk in the filename separates a search root
@@ -109,15 +307,28 @@ vopen__(char** dst, int flags, const char* fmt, va_list vargs)
         aim_free(rpath);
     }
 
-    if(dst) {
-        *dst = aim_strdup(fname);
-    }
-
     if(stat(fname, &sb) == -1) {
         return ONLP_STATUS_E_MISSING;
     }
 
-    if(S_ISSOCK(sb.st_mode)) {
+    if(sock) {
+        *sock = S_ISSOCK(sb.st_mode);
+    }
+    return ONLP_STATUS_OK;
+}
+
+/**
+ * @brief Open a resolved file or domain socket.
+ * @param fname The full filename.
+ * @param sock Whether the file is a domain socket.
+ * @param flags The open flags.
+ */
+static int
+open__(const char* fname, int sock, int flags)
+{
+    int fd;
+
+    if(sock) {
         fd = ds_connect__(fname);
     }
     else {
@@ -127,6 +338,28 @@ vopen__(char** dst, int flags, const char* fmt, va_list vargs)
     return (fd > 0) ? fd : ONLP_STATUS_E_MISSING;
 }
 
+/**
+ * @brief Open a file or domain socket.
+ * @param dst Receives the full filename (for logging purposes).
+ * @param flags The open flags.
+ * @param fmt Format specifier.
+ * @param vargs Format specifier arguments.
+ */
+static int
+vopen__(char** dst, int flags, const char* fmt, va_list vargs)
+{
+    int sock, rv;
+    char fname[PATH_MAX];
+
+    rv = vpath__(fname, sizeof(fname), &sock, fmt, vargs);
+
+    if(dst) {
+        *dst = aim_strdup(fname);
+    }
+
+    return (rv < 0) ? rv : open__(fname, sock, flags);
+}
+
 int
 onlp_file_vsize(const char* fmt, va_list vargs)
 {
@@ -160,10 +393,24 @@ int
 onlp_file_vread(uint8_t* data, int max, int* len, const char* fmt, va_list vargs)
 {
     int fd;
-    char* fname = NULL;
+    char fname[PATH_MAX];
+    int sock;
     int rv;
 
-    if ((fd = vopen__(&fname, O_RDONLY, fmt, vargs)) < 0) {
+    if ((rv = vpath__(fname, sizeof(fname), &sock, fmt, vargs)) < 0) {
+        return rv;
+    }
+
+    if(sock) {
+        /* Domain socket services are read over a reusable connection. */
+        memset(data, 0, max);
+        rv = ds_request__(fname, ONLP_FILE_UDS_OP_READ, data, max, len);
+        if(rv >= 0 && *len <= 0) {
+            AIM_LOG_ERROR("Failed to read input file '%s'", fname);
+            rv = ONLP_STATUS_E_INTERNAL;
+        }
+    }
+    else if ((fd = open__(fname, sock, O_RDONLY)) < 0) {
         rv = fd;
     }
     else {
@@ -177,7 +424,6 @@ onlp_file_vread(uint8_t* data, int max, int* len, const char* fmt, va_list vargs
         }
         close(fd);
     }
-    aim_free(fname);
     return rv;
 }
 
@@ -315,11 +561,22 @@ int
 onlp_file_vwrite(uint8_t* data, int len, const char* fmt, va_list vargs)
 {
     int fd;
-    char* fname = NULL;
+    char fname[PATH_MAX];
+    int sock;
     int rv;
     int wlen;
 
-    if ((fd = vopen__(&fname, O_WRONLY, fmt, vargs)) < 0) {
+    if ((rv = vpath__(fname, sizeof(fname), &sock, fmt, vargs)) < 0) {
+        return rv;
+    }
+
+    if(sock) {
+        /* Domain socket services are written over a reusable connection. */
+        if ((rv = ds_request__(fname, ONLP_FILE_UDS_OP_WRITE, data, len, NULL)) < 0) {
+            AIM_LOG_ERROR("Failed to write output file '%s'", fname);
+        }
+    }
+    else if ((fd = open__(fname, sock, O_WRONLY)) < 0) {
         rv = fd;
     }
     else {
@@ -332,7 +589,6 @@ onlp_file_vwrite(uint8_t* data, int len, const char* fmt, va_list vargs)
         }
         close(fd);
     }
-    aim_free(fname);
     return rv;
 }
 
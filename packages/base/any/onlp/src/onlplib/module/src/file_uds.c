@@ -22,7 +22,12 @@
  *
  *
  ***********************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 #include <onlplib/file_uds.h>
+#include <onlp/onlp.h>
+#include "onlplib_int.h"
 #include "onlplib_log.h"
 
 #include <BigList/biglist.h>
@@ -33,6 +38,7 @@
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/un.h>
+#include <sys/syscall.h>
 #include <fcntl.h>
 #include <netinet/in.h>
 #include <netinet/ip.h>
@@ -43,6 +49,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <errno.h>
+#include <limits.h>
 #include <pthread.h>
 #include <sys/eventfd.h>
 #include <sys/epoll.h>
@@ -63,26 +70,118 @@ eventfd_read__(int fd)
     read(fd, &val, sizeof(val));
 }
 
+int
+onlp_file_uds_recv_all(int fd, void* data, int len)
+{
+    uint8_t* p = data;
+    while(len > 0) {
+        int rv = recv(fd, p, len, 0);
+        if(rv < 0 && errno == EINTR) {
+            continue;
+        }
+        if(rv <= 0) {
+            return -1;
+        }
+        p += rv;
+        len -= rv;
+    }
+    return 0;
+}
+
+int
+onlp_file_uds_send_all(int fd, const void* data, int len)
+{
+    const uint8_t* p = data;
+    while(len > 0) {
+        int rv = send(fd, p, len, MSG_NOSIGNAL);
+        if(rv < 0 && errno == EINTR) {
+            continue;
+        }
+        if(rv <= 0) {
+            return -1;
+        }
+        p += rv;
+        len -= rv;
+    }
+    return 0;
+}
+
+/**
+ * Epoll cookies are tagged with their object type.
+ * The eventfd uses a NULL cookie.
+ */
+#define UDS_EPOLL_SERVICE 1
+#define UDS_EPOLL_CONNECTION 2
+
+/**
+ * A listening socket.
+ */
+typedef struct onlp_file_uds_listener_s {
+    /** UDS_EPOLL_SERVICE */
+    int type;
+
+    /** Listening descriptor */
+    int fd;
+
+    /** Connections carry framed requests. */
+    int session;
+
+    struct onlp_file_uds_service_s* service;
+
+} onlp_file_uds_listener_t;
 
 /**
  * This represents a single domain socket service.
+ *
+ * The service listens on its path for one-shot connections and on
+ * the session path (path + ONLP_FILE_UDS_SESSION_SUFFIX) for
+ * connections which carry framed requests.
  */
 typedef struct onlp_file_uds_service_s {
     /** domain socket file path */
     const char* path;
 
-    /** Listening descriptor */
-    int lfd;
+    /** Listening sockets */
+    onlp_file_uds_listener_t oneshot;
+    onlp_file_uds_listener_t session;
 
     /** client handler */
     onlp_file_uds_handler_t handler;
     void* cookie;
 
-    /** service is active. */
+    /** 1 if the service is active, -1 if its removal was requested. */
     int active;
 
+    /**
+     * Connections referencing this service. Protected by the control lock.
+     * A removed service is cleared once its last connection is closed.
+     */
+    int refs;
+
 } onlp_file_uds_service_t;
 
+/**
+ * This represents a client connection.
+ *
+ * A connection is owned by the service thread while it is idle
+ * (armed in the epoll set) and by a handler thread while a request
+ * is being processed.
+ */
+typedef struct onlp_file_uds_conn_s {
+    /** UDS_EPOLL_CONNECTION */
+    int type;
+
+    int fd;
+    onlp_file_uds_service_t* service;
+
+    /** One-shot connection: the handler is called on the socket itself. */
+    int oneshot;
+
+    /** Owned by a handler thread. */
+    int busy;
+
+} onlp_file_uds_conn_t;
+
 /**
  * Destroy a file service.
  */
@@ -90,8 +189,11 @@ static void
 onlp_file_uds_service_clear__(onlp_file_uds_service_t* p)
 {
     if(p) {
-        if(p->lfd > 0) {
-            close(p->lfd);
+        if(p->oneshot.fd > 0) {
+            close(p->oneshot.fd);
+        }
+        if(p->session.fd > 0) {
+            close(p->session.fd);
         }
         if(p->path) {
             aim_free((char*)p->path);
@@ -108,6 +210,41 @@ onlp_file_uds_service_destroy__(onlp_file_uds_service_t* p)
     }
 }
 
+/**
+ * Create a listening socket.
+ */
+static int
+listener_create__(onlp_file_uds_listener_t* l, onlp_file_uds_service_t* service,
+                  const char* path, int session)
+{
+    struct sockaddr_un addr;
+
+    l->type = UDS_EPOLL_SERVICE;
+    l->session = session;
+    l->service = service;
+
+    if ((l->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) == -1) {
+        AIM_LOG_ERROR("socket: %{errno}", errno);
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path)-1);
+    unlink(path);
+
+    if(bind(l->fd, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+        AIM_LOG_ERROR("bind: %{errno}", errno);
+        return -1;
+    }
+
+    if (listen(l->fd, SOMAXCONN) == -1) {
+        AIM_LOG_ERROR("listen: %{errno}", errno);
+        return -1;
+    }
+    return 0;
+}
+
 /**
  * Create a file service.
  */
@@ -116,7 +253,7 @@ onlp_file_uds_service_create__(onlp_file_uds_service_t** rvp,
                                const char* path,
                                onlp_file_uds_handler_t handler, void* cookie)
 {
-    struct sockaddr_un addr;
+    char spath[PATH_MAX];
 
     onlp_file_uds_service_t* rv = aim_zmalloc(sizeof(*rv));
 
@@ -129,23 +266,9 @@ onlp_file_uds_service_create__(onlp_file_uds_service_t** rvp,
     }
     aim_free(cmd);
 
-    if ((rv->lfd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0)) == -1) {
-        AIM_LOG_ERROR("socket: %{errno}", errno);
-        goto failed;
-    }
-
-    memset(&addr, 0, sizeof(addr));
-    addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, path, sizeof(addr.sun_path)-1);
-    unlink(path);
-
-    if(bind(rv->lfd, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
-        AIM_LOG_ERROR("bind: %{errno}", errno);
-        goto failed;
-    }
-
-    if (listen(rv->lfd, 1) == -1) {
-        AIM_LOG_ERROR("listen: %{errno}", errno);
+    ONLPLIB_SNPRINTF(spath, sizeof(spath), "%s%s", path, ONLP_FILE_UDS_SESSION_SUFFIX);
+    if(listener_create__(&rv->oneshot, rv, path, 0) < 0 ||
+       listener_create__(&rv->session, rv, spath, 1) < 0) {
         goto failed;
     }
 
@@ -168,6 +291,9 @@ struct onlp_file_uds_s {
     /** Thread signal. Used to wake up the service thread when required. */
     int eventfd;
 
+    /** The epoll set. Services and idle connections stay registered. */
+    int epollfd;
+
     /** Service worker thread */
     pthread_t thread;
     volatile int running;
@@ -175,6 +301,21 @@ struct onlp_file_uds_s {
 
     /** Service client list */
     biglist_locked_t* list;
+
+    /** Handler threads */
+    pthread_t handlers[ONLPLIB_CONFIG_FILE_UDS_WORKER_THREADS];
+    int handler_count;
+    int handlers_terminate;
+
+    /** Protects the connection lists and the ready queue. */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    /** All client connections. */
+    biglist_t* connections;
+
+    /** Connections waiting for a handler thread. */
+    biglist_t* ready;
 };
 
 
@@ -183,7 +324,7 @@ struct onlp_file_uds_s {
  */
 static int
 epoll_add__(int epoll_fd, int add_fd, uint32_t events, void* data,
-            int* counter, const char* name)
+            const char* name)
 {
     struct epoll_event ev = {0};
     ev.data.ptr = data;
@@ -194,94 +335,140 @@ epoll_add__(int epoll_fd, int add_fd, uint32_t events, void* data,
             return -1;
         }
     }
+    return 0;
+}
 
-    if(counter) {
-        (*counter)++;
+/**
+ * Re-arm an idle connection.
+ */
+static void
+conn_arm__(onlp_file_uds_t* control, onlp_file_uds_conn_t* conn)
+{
+    struct epoll_event ev = {0};
+    ev.data.ptr = conn;
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    epoll_ctl(control->epollfd, EPOLL_CTL_MOD, conn->fd, &ev);
+}
+
+/**
+ * Close a connection. Called with the control lock held.
+ */
+static void
+conn_close_locked__(onlp_file_uds_t* control, onlp_file_uds_conn_t* conn)
+{
+    onlp_file_uds_service_t* ufp = conn->service;
+
+    control->connections = biglist_remove(control->connections, conn);
+    close(conn->fd);
+    aim_free(conn);
+
+    if(--ufp->refs == 0 && ufp->active != 1) {
+        /* The service thread finishes removing the service. */
+        eventfd_write__(control->eventfd);
     }
+}
 
-    return 0;
+/**
+ * Hand a connection to the handler threads. Called with the control lock held.
+ */
+static void
+conn_dispatch_locked__(onlp_file_uds_t* control, onlp_file_uds_conn_t* conn)
+{
+    conn->busy = 1;
+    control->ready = biglist_append(control->ready, conn);
+    pthread_cond_signal(&control->cond);
 }
 
 /**
- * Service a connection.
+ * Accept all pending connections on a listening socket.
+ *
+ * One-shot connections are passed to the handler threads at once.
+ * Session connections are idle until the client sends a request.
  */
 static void
-accept__(onlp_file_uds_service_t* ufp)
+accept__(onlp_file_uds_t* control, onlp_file_uds_listener_t* l)
 {
     int fd;
-
-    if((fd = accept(ufp->lfd, NULL, 0)) > 0) {
-        ufp->handler(fd, ufp->cookie);
+    onlp_file_uds_service_t* ufp = l->service;
+
+    while((fd = accept4(l->fd, NULL, 0, SOCK_CLOEXEC)) >= 0) {
+        struct timeval tv = { 5, 0 };
+        onlp_file_uds_conn_t* conn = aim_zmalloc(sizeof(*conn));
+
+        /* Handler threads use blocking I/O with a timeout. */
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+        conn->type = UDS_EPOLL_CONNECTION;
+        conn->fd = fd;
+        conn->service = ufp;
+        conn->oneshot = !l->session;
+
+        pthread_mutex_lock(&control->lock);
+        ufp->refs++;
+        control->connections = biglist_append(control->connections, conn);
+        if(conn->oneshot) {
+            conn_dispatch_locked__(control, conn);
+        }
+        else if(epoll_add__(control->epollfd, fd, EPOLLIN | EPOLLONESHOT,
+                            conn, ufp->path) < 0) {
+            conn_close_locked__(control, conn);
+        }
+        pthread_mutex_unlock(&control->lock);
     }
-    close(fd);
 }
 
 /**
- * This is the service list entry.
+ * Close the idle connections of services which have been removed.
+ * Busy connections are closed by their handler thread.
+ * Returns the number of connections still referencing the service.
  */
+static int
+service_connections_close__(onlp_file_uds_t* control, onlp_file_uds_service_t* ufp)
+{
+    biglist_t* ble;
+    biglist_t* next;
+    int refs;
+
+    pthread_mutex_lock(&control->lock);
+    for(ble = control->connections; ble; ble = next) {
+        onlp_file_uds_conn_t* conn = (onlp_file_uds_conn_t*)ble->data;
+        next = ble->next;
+        if(conn->service == ufp && !conn->busy) {
+            conn_close_locked__(control, conn);
+        }
+    }
+    refs = ufp->refs;
+    pthread_mutex_unlock(&control->lock);
+    return refs;
+}
 
 /**
  * The service worker thread.
  *
- * All registered services are polled for incoming connections
- * and handled in series.
- *
- * These are designed for simple transactions and not
- * long-lived connections.
+ * All registered services and idle client connections stay in
+ * a single epoll set. New connections are accepted here and
+ * connections with pending requests are passed to the handler
+ * threads.
  */
 static void*
 uds_thread_worker__(void* p)
 {
-    volatile onlp_file_uds_t* control = (onlp_file_uds_t*)p;
-
-    int epollfd;
-    if((epollfd = epoll_create(256)) == -1) {
-        AIM_LOG_ERROR("epoll_create(): %{errno}", errno);
-        return NULL;
-    }
+    onlp_file_uds_t* control = (onlp_file_uds_t*)p;
+    struct epoll_event events[64];
 
     control->running = 1;
     for(;;) {
 
         biglist_t* ble;
         onlp_file_uds_service_t* ufp;
-        int nfd = 0;
 
         if(control->terminate) {
             /** Request for termination. */
             break;
         }
 
-        /** control->eventfd wakes us up */
-        if(epoll_add__(epollfd, control->eventfd, EPOLLIN, NULL, &nfd, "eventfd") < 0) {
-            return NULL;
-        }
-
-        /** Add all active descriptors. */
-        biglist_lock(control->list);
-        BIGLIST_FOREACH_DATA(ble, control->list->list, onlp_file_uds_service_t*, ufp) {
-            switch(ufp->active)
-                {
-                case 1:
-                    /* Service is active. Wait on it. */
-                    epoll_add__(epollfd, ufp->lfd, EPOLLIN, ufp, &nfd, ufp->path);
-                    break;
-                case -1:
-                    /* Service deletion request. */
-                    AIM_LOG_MSG("Removing %s...", ufp->path);
-                    epoll_ctl(epollfd, EPOLL_CTL_DEL, ufp->lfd, NULL);
-                    onlp_file_uds_service_clear__(ufp);
-                    break;
-                case 0:
-                    /* Service is inactive. */
-                    break;
-                }
-        }
-
-        biglist_unlock(control->list);
-
-        struct epoll_event* events = aim_zmalloc(sizeof(*events)*nfd);
-        int rv = epoll_wait(epollfd, events, nfd, -1);
+        int rv = epoll_wait(control->epollfd, events, AIM_ARRAYSIZE(events), -1);
 
         if(rv < 0) {
             if(errno != EINTR) {
@@ -289,49 +476,284 @@ uds_thread_worker__(void* p)
                 break;
             }
         }
-        else if(rv == 0) {
-            /** Shouldn't happen with infinite timeout */
-        }
         else {
             int i;
+            int changed = 0;
             for(i = 0; i < rv; i++) {
-                if(events[i].events & EPOLLIN) {
-                    onlp_file_uds_service_t* ufp = (onlp_file_uds_service_t*)events[i].data.ptr;
-                    if(ufp == NULL) {
-                        eventfd_read__(control->eventfd);
+                int* type = (int*)events[i].data.ptr;
+
+                if(type == NULL) {
+                    /*
+                     * Service list changes. Handled after the rest of the
+                     * batch, which may refer to connections and listeners
+                     * the changes close.
+                     */
+                    changed = 1;
+                }
+                else if(*type == UDS_EPOLL_SERVICE) {
+                    onlp_file_uds_listener_t* l = (onlp_file_uds_listener_t*)type;
+                    if(l->service->active == 1) {
+                        accept__(control, l);
+                    }
+                }
+                else {
+                    /* The connection is disarmed (EPOLLONESHOT) until the handler re-arms it. */
+                    pthread_mutex_lock(&control->lock);
+                    conn_dispatch_locked__(control, (onlp_file_uds_conn_t*)type);
+                    pthread_mutex_unlock(&control->lock);
+                }
+            }
+
+            if(changed) {
+                eventfd_read__(control->eventfd);
+                biglist_lock(control->list);
+                BIGLIST_FOREACH_DATA(ble, control->list->list, onlp_file_uds_service_t*, ufp) {
+                    if(ufp->active == 1 && ufp->oneshot.fd > 0) {
+                        epoll_add__(control->epollfd, ufp->oneshot.fd, EPOLLIN,
+                                    &ufp->oneshot, ufp->path);
+                        epoll_add__(control->epollfd, ufp->session.fd, EPOLLIN,
+                                    &ufp->session, ufp->path);
                     }
-                    else {
-                        if(ufp->active == 1) {
-                            accept__(ufp);
+                    else if(ufp->active == -1) {
+                        /*
+                         * Service deletion request. The service is cleared
+                         * once the handler threads have closed its busy
+                         * connections.
+                         */
+                        epoll_ctl(control->epollfd, EPOLL_CTL_DEL, ufp->oneshot.fd, NULL);
+                        epoll_ctl(control->epollfd, EPOLL_CTL_DEL, ufp->session.fd, NULL);
+                        if(service_connections_close__(control, ufp) == 0) {
+                            AIM_LOG_MSG("Removing %s...", ufp->path);
+                            onlp_file_uds_service_clear__(ufp);
                         }
                     }
                 }
+                biglist_unlock(control->list);
             }
         }
-        aim_free(events);
     }
     control->running = 0;
     return NULL;
 }
 
+/**
+ * Create an anonymous memory file.
+ */
+static int
+memfd__(void)
+{
+    return syscall(SYS_memfd_create, "onlp-file-uds", 1 /* MFD_CLOEXEC */);
+}
+
+/**
+ * Run a service handler against a memory file.
+ *
+ * The handler sees a descriptor it can read the request data from
+ * or write the response data to, as it would with a one-shot
+ * connection. Returns the handler status.
+ */
+static int
+handler_call__(int mfd, onlp_file_uds_handler_t handler, void* cookie)
+{
+    int fd, rv;
+
+    if( (fd = dup(mfd)) < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    rv = handler(fd, cookie);
+    close(fd);
+    return rv;
+}
+
+/**
+ * Process one request on a session connection.
+ * Returns 0 if the connection can be reused.
+ */
+static int
+session_request__(onlp_file_uds_t* control, onlp_file_uds_conn_t* conn, int mfd,
+                  uint8_t* buffer)
+{
+    onlp_file_uds_request_t req;
+    onlp_file_uds_response_t rsp = { ONLP_FILE_UDS_MAGIC, ONLP_STATUS_OK, 0 };
+    onlp_file_uds_handler_t handler;
+    void* cookie;
+    struct stat sb;
+    int rv;
+
+    if(onlp_file_uds_recv_all(conn->fd, &req, sizeof(req)) < 0) {
+        /* Client disconnected. */
+        return -1;
+    }
+
+    if(req.magic != ONLP_FILE_UDS_MAGIC ||
+       req.length > ONLPLIB_CONFIG_FILE_UDS_DATA_MAX ||
+       (req.op != ONLP_FILE_UDS_OP_READ && req.op != ONLP_FILE_UDS_OP_WRITE)) {
+        AIM_LOG_ERROR("%s: invalid request.", conn->service->path);
+        return -1;
+    }
+
+    if(req.op == ONLP_FILE_UDS_OP_WRITE) {
+        if(onlp_file_uds_recv_all(conn->fd, buffer, req.length) < 0) {
+            return -1;
+        }
+    }
+
+    biglist_lock(control->list);
+    handler = (conn->service->active == 1) ? conn->service->handler : NULL;
+    cookie = conn->service->cookie;
+    biglist_unlock(control->list);
+
+    if(handler == NULL) {
+        rsp.status = ONLP_STATUS_E_MISSING;
+    }
+    else if(ftruncate(mfd, 0) < 0 || lseek(mfd, 0, SEEK_SET) < 0 ||
+            (req.op == ONLP_FILE_UDS_OP_WRITE &&
+             (write(mfd, buffer, req.length) != req.length ||
+              lseek(mfd, 0, SEEK_SET) < 0))) {
+        rsp.status = ONLP_STATUS_E_INTERNAL;
+    }
+    else {
+        rv = handler_call__(mfd, handler, cookie);
+        rsp.status = (rv < 0) ? rv : ONLP_STATUS_OK;
+
+        if(req.op == ONLP_FILE_UDS_OP_READ && fstat(mfd, &sb) == 0) {
+            rsp.length = (sb.st_size < req.length) ? sb.st_size : req.length;
+            if(pread(mfd, buffer, rsp.length, 0) != rsp.length) {
+                rsp.status = ONLP_STATUS_E_INTERNAL;
+                rsp.length = 0;
+            }
+        }
+    }
+
+    if(onlp_file_uds_send_all(conn->fd, &rsp, sizeof(rsp)) < 0 ||
+       onlp_file_uds_send_all(conn->fd, buffer, rsp.length) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Handle a one-shot connection. The handler reads the client's data
+ * from, or writes its response to, the socket itself.
+ */
+static void
+oneshot_request__(onlp_file_uds_t* control, onlp_file_uds_conn_t* conn)
+{
+    onlp_file_uds_handler_t handler;
+    void* cookie;
+
+    biglist_lock(control->list);
+    handler = (conn->service->active == 1) ? conn->service->handler : NULL;
+    cookie = conn->service->cookie;
+    biglist_unlock(control->list);
+
+    if(handler) {
+        int fd = dup(conn->fd);
+        if(fd >= 0) {
+            handler(fd, cookie);
+            close(fd);
+        }
+    }
+}
+
+/**
+ * The handler threads.
+ */
+static void*
+uds_handler_worker__(void* p)
+{
+    onlp_file_uds_t* control = (onlp_file_uds_t*)p;
+    uint8_t* buffer = aim_zmalloc(ONLPLIB_CONFIG_FILE_UDS_DATA_MAX);
+    int mfd = memfd__();
+
+    if(mfd < 0) {
+        AIM_LOG_ERROR("memfd_create(): %{errno}", errno);
+    }
+
+    for(;;) {
+        onlp_file_uds_conn_t* conn;
+        int rv;
+
+        pthread_mutex_lock(&control->lock);
+        while(control->ready == NULL && !control->handlers_terminate) {
+            pthread_cond_wait(&control->cond, &control->lock);
+        }
+        if(control->handlers_terminate) {
+            pthread_mutex_unlock(&control->lock);
+            break;
+        }
+        conn = (onlp_file_uds_conn_t*)control->ready->data;
+        control->ready = biglist_remove_link_free(control->ready, control->ready);
+        pthread_mutex_unlock(&control->lock);
+
+        if(conn->oneshot) {
+            oneshot_request__(control, conn);
+            rv = -1;
+        }
+        else {
+            rv = (mfd >= 0) ? session_request__(control, conn, mfd, buffer) : -1;
+        }
+
+        pthread_mutex_lock(&control->lock);
+        if(rv < 0 || conn->service->active != 1) {
+            conn_close_locked__(control, conn);
+        }
+        else {
+            conn->busy = 0;
+            conn_arm__(control, conn);
+        }
+        pthread_mutex_unlock(&control->lock);
+    }
+
+    if(mfd >= 0) {
+        close(mfd);
+    }
+    aim_free(buffer);
+    return NULL;
+}
+
 int
 onlp_file_uds_create(onlp_file_uds_t** rvp)
 {
+    int i;
     onlp_file_uds_t* rv = aim_zmalloc(sizeof(*rv));
-    if((rv->eventfd = eventfd(0, 0)) == -1) {
+
+    rv->eventfd = -1;
+    rv->epollfd = -1;
+    pthread_mutex_init(&rv->lock, NULL);
+    pthread_cond_init(&rv->cond, NULL);
+
+    if((rv->eventfd = eventfd(0, EFD_CLOEXEC)) == -1) {
         AIM_LOG_ERROR("eventfd: %{errno}", errno);
         goto failed;
     }
+    if((rv->epollfd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+        AIM_LOG_ERROR("epoll_create(): %{errno}", errno);
+        goto failed;
+    }
+    /** rv->eventfd wakes up the service thread */
+    if(epoll_add__(rv->epollfd, rv->eventfd, EPOLLIN, NULL, "eventfd") < 0) {
+        goto failed;
+    }
     if((rv->list = biglist_locked_create()) == NULL) {
         goto failed;
     }
 
     rv->running = 0;
 
+    for(i = 0; i < ONLPLIB_CONFIG_FILE_UDS_WORKER_THREADS; i++) {
+        if(pthread_create(rv->handlers + i, NULL, uds_handler_worker__, rv) != 0) {
+            AIM_LOG_ERROR("pthread_create failed: %{errno}", errno);
+            goto failed;
+        }
+        rv->handler_count++;
+    }
+
     if(pthread_create(&rv->thread, NULL, uds_thread_worker__, rv) != 0) {
         AIM_LOG_ERROR("pthread_create failed: %{errno}", errno);
         goto failed;
     }
+    rv->running = 1;
 
     *rvp = rv;
     return 0;
@@ -345,12 +767,42 @@ void
 onlp_file_uds_destroy(onlp_file_uds_t* p)
 {
     if(p) {
+        biglist_t* ble;
+        int i;
+
         if(p->running == 1) {
             p->terminate = 1;
             eventfd_write__(p->eventfd);
             pthread_join(p->thread, NULL);
         }
-        biglist_locked_free_all(p->list, (biglist_free_f)onlp_file_uds_service_destroy__);
+
+        pthread_mutex_lock(&p->lock);
+        p->handlers_terminate = 1;
+        pthread_cond_broadcast(&p->cond);
+        pthread_mutex_unlock(&p->lock);
+        for(i = 0; i < p->handler_count; i++) {
+            pthread_join(p->handlers[i], NULL);
+        }
+
+        for(ble = p->connections; ble; ble = ble->next) {
+            onlp_file_uds_conn_t* conn = (onlp_file_uds_conn_t*)ble->data;
+            close(conn->fd);
+            aim_free(conn);
+        }
+        biglist_free(p->connections);
+        biglist_free(p->ready);
+
+        if(p->list) {
+            biglist_locked_free_all(p->list, (biglist_free_f)onlp_file_uds_service_destroy__);
+        }
+        if(p->epollfd >= 0) {
+            close(p->epollfd);
+        }
+        if(p->eventfd >= 0) {
+            close(p->eventfd);
+        }
+        pthread_cond_destroy(&p->cond);
+        pthread_mutex_destroy(&p->lock);
         aim_free(p);
     }
 }
@@ -402,4 +854,5 @@ onlp_file_uds_remove(onlp_file_uds_t* fuds, const char* path)
         ufp->active = -1;
     }
     biglist_unlock(fuds->list);
+    eventfd_write__(fuds->eventfd);
 }
@@ -33,6 +33,12 @@
 #include <sys/types.h>
 #include <sys/ioctl.h>
 #include <errno.h>
+#include <pthread.h>
+#include <limits.h>
+#include <stdlib.h>
+#if ONLPLIB_CONFIG_I2C_USE_CUSTOM_HEADER == 0
+#include <linux/i2c.h>
+#endif
 #include <onlp/onlp.h>
 #include "onlplib_log.h"
 
@@ -84,18 +90,418 @@ onlp_i2c_open(int bus, uint8_t addr, uint32_t flags)
     return ONLP_STATUS_E_I2C;
 }
 
+/****************************************************************************
+ *
+ * Descriptor Cache.
+ *
+ ***************************************************************************/
+
+/** Only these flags change the state of the descriptor itself. */
+#define I2C_FD_FLAGS__ (ONLP_I2C_F_TENBIT | ONLP_I2C_F_FORCE | ONLP_I2C_F_PEC)
+
+/**
+ * The adapter has gone away (e.g. its mux driver was unloaded).
+ * Descriptors held open on it keep the removed adapter referenced.
+ */
+#define I2C_BUS_GONE__(_errno) ((_errno) == ENODEV || (_errno) == ENXIO)
+
+/** The errno of a failed transfer, never 0. */
+#define I2C_ERRNO__() ((errno) ? errno : EIO)
+
+static pthread_mutex_t i2c_fd_cache_lock__ = PTHREAD_MUTEX_INITIALIZER;
+static onlp_i2c_fd_cache_stats_t i2c_fd_cache_stats__;
+
+#if ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE > 0
+
+typedef struct i2c_fd_cache_entry_s {
+    int valid;
+    int fd;
+    int bus;
+    uint8_t addr;
+    uint32_t flags;
+
+    /** Adapter functionality (I2C_FUNCS), probed on first use. */
+    int funcs_valid;
+    unsigned long funcs;
+
+    /** Currently handed out to a caller. */
+    int busy;
+    /** Invalidated while busy. Closed when released. */
+    int stale;
+    /** LRU timestamp. */
+    uint64_t used;
+    /** Monotonic time (usecs) of the last release. */
+    uint64_t released;
+} i2c_fd_cache_entry_t;
+
+static i2c_fd_cache_entry_t i2c_fd_cache__[ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE];
+static uint64_t i2c_fd_cache_clock__;
+
+static void
+i2c_fd_cache_invalidate_locked__(int bus)
+{
+    int i;
+
+    for(i = 0; i < AIM_ARRAYSIZE(i2c_fd_cache__); i++) {
+        i2c_fd_cache_entry_t* e = i2c_fd_cache__ + i;
+        if(e->valid && (bus < 0 || e->bus == bus)) {
+            if(e->busy) {
+                e->stale = 1;
+            }
+            else {
+                close(e->fd);
+                e->valid = 0;
+                i2c_fd_cache_stats__.evictions++;
+            }
+        }
+    }
+}
+
+/**
+ * Close descriptors which have been idle for longer than
+ * ONLPLIB_CONFIG_I2C_FD_CACHE_IDLE_MS so their adapters can be removed.
+ */
+static void
+i2c_fd_cache_expire_locked__(uint64_t now)
+{
+    int i;
+
+    for(i = 0; i < AIM_ARRAYSIZE(i2c_fd_cache__); i++) {
+        i2c_fd_cache_entry_t* e = i2c_fd_cache__ + i;
+        if(e->valid && !e->busy &&
+           now - e->released >= ONLPLIB_CONFIG_I2C_FD_CACHE_IDLE_MS*1000ULL) {
+            close(e->fd);
+            e->valid = 0;
+            i2c_fd_cache_stats__.evictions++;
+        }
+    }
+}
+
+static int
+i2c_fd_get__(int bus, uint8_t addr, uint32_t flags)
+{
+    int i, fd;
+    i2c_fd_cache_entry_t* e;
+    i2c_fd_cache_entry_t* victim = NULL;
+
+    flags &= I2C_FD_FLAGS__;
+
+    pthread_mutex_lock(&i2c_fd_cache_lock__);
+    i2c_fd_cache_expire_locked__(aim_time_monotonic());
+    for(i = 0; i < AIM_ARRAYSIZE(i2c_fd_cache__); i++) {
+        e = i2c_fd_cache__ + i;
+        if(e->valid && !e->busy &&
+           e->bus == bus && e->addr == addr && e->flags == flags) {
+            e->busy = 1;
+            e->used = ++i2c_fd_cache_clock__;
+            i2c_fd_cache_stats__.opens_avoided++;
+            fd = e->fd;
+            pthread_mutex_unlock(&i2c_fd_cache_lock__);
+            return fd;
+        }
+    }
+    pthread_mutex_unlock(&i2c_fd_cache_lock__);
+
+    fd = onlp_i2c_open(bus, addr, flags);
+    if(fd < 0) {
+        if(I2C_BUS_GONE__(errno)) {
+            pthread_mutex_lock(&i2c_fd_cache_lock__);
+            i2c_fd_cache_invalidate_locked__(bus);
+            pthread_mutex_unlock(&i2c_fd_cache_lock__);
+        }
+        return fd;
+    }
+
+    pthread_mutex_lock(&i2c_fd_cache_lock__);
+    i2c_fd_cache_stats__.opens++;
+
+    /* Take a free slot, or evict the least recently used idle one. */
+    for(i = 0; i < AIM_ARRAYSIZE(i2c_fd_cache__); i++) {
+        e = i2c_fd_cache__ + i;
+        if(!e->valid) {
+            victim = e;
+            break;
+        }
+        if(!e->busy && (victim == NULL || e->used < victim->used)) {
+            victim = e;
+        }
+    }
+
+    if(victim) {
+        if(victim->valid) {
+            close(victim->fd);
+            i2c_fd_cache_stats__.evictions++;
+        }
+        victim->valid = 1;
+        victim->fd = fd;
+        victim->bus = bus;
+        victim->addr = addr;
+        victim->flags = flags;
+        victim->funcs_valid = 0;
+        victim->busy = 1;
+        victim->stale = 0;
+        victim->used = ++i2c_fd_cache_clock__;
+    }
+    /* Otherwise every slot is in use and this descriptor is closed on release. */
+
+    pthread_mutex_unlock(&i2c_fd_cache_lock__);
+    return fd;
+}
+
+/**
+ * Release a descriptor. 'error' is the errno of a failed
+ * transfer, or 0.
+ */
+static void
+i2c_fd_put__(int fd, int error)
+{
+    int i;
+
+    pthread_mutex_lock(&i2c_fd_cache_lock__);
+    for(i = 0; i < AIM_ARRAYSIZE(i2c_fd_cache__); i++) {
+        i2c_fd_cache_entry_t* e = i2c_fd_cache__ + i;
+        if(e->valid && e->busy && e->fd == fd) {
+            e->busy = 0;
+            e->released = aim_time_monotonic();
+            if(error || e->stale) {
+                /* Reopened lazily on the next access. */
+                close(e->fd);
+                e->valid = 0;
+                if(error) {
+                    i2c_fd_cache_stats__.errors++;
+                }
+                else {
+                    i2c_fd_cache_stats__.evictions++;
+                }
+            }
+            if(I2C_BUS_GONE__(error)) {
+                /* Don't keep the other descriptors on this bus open either. */
+                i2c_fd_cache_invalidate_locked__(e->bus);
+            }
+            pthread_mutex_unlock(&i2c_fd_cache_lock__);
+            return;
+        }
+    }
+    pthread_mutex_unlock(&i2c_fd_cache_lock__);
+    close(fd);
+}
+
+static unsigned long
+i2c_fd_funcs__(int fd)
+{
+    int i;
+    unsigned long funcs = 0;
+    i2c_fd_cache_entry_t* e = NULL;
+
+    pthread_mutex_lock(&i2c_fd_cache_lock__);
+    for(i = 0; i < AIM_ARRAYSIZE(i2c_fd_cache__); i++) {
+        if(i2c_fd_cache__[i].valid && i2c_fd_cache__[i].busy &&
+           i2c_fd_cache__[i].fd == fd) {
+            e = i2c_fd_cache__ + i;
+            break;
+        }
+    }
+    if(e && e->funcs_valid) {
+        funcs = e->funcs;
+        pthread_mutex_unlock(&i2c_fd_cache_lock__);
+        return funcs;
+    }
+    pthread_mutex_unlock(&i2c_fd_cache_lock__);
+
+    if(ioctl(fd, I2C_FUNCS, &funcs) < 0) {
+        funcs = 0;
+    }
+
+    if(e) {
+        /* The entry is busy and therefore owned by this caller. */
+        pthread_mutex_lock(&i2c_fd_cache_lock__);
+        e->funcs = funcs;
+        e->funcs_valid = 1;
+        pthread_mutex_unlock(&i2c_fd_cache_lock__);
+    }
+    return funcs;
+}
+
+void
+onlp_i2c_fd_cache_invalidate(int bus)
+{
+    pthread_mutex_lock(&i2c_fd_cache_lock__);
+    i2c_fd_cache_invalidate_locked__(bus);
+    pthread_mutex_unlock(&i2c_fd_cache_lock__);
+}
+
+#else
+
+static int
+i2c_fd_get__(int bus, uint8_t addr, uint32_t flags)
+{
+    int fd = onlp_i2c_open(bus, addr, flags);
+    if(fd >= 0) {
+        pthread_mutex_lock(&i2c_fd_cache_lock__);
+        i2c_fd_cache_stats__.opens++;
+        pthread_mutex_unlock(&i2c_fd_cache_lock__);
+    }
+    return fd;
+}
+
+static void
+i2c_fd_put__(int fd, int error)
+{
+    close(fd);
+}
+
+static unsigned long
+i2c_fd_funcs__(int fd)
+{
+    unsigned long funcs = 0;
+    if(ioctl(fd, I2C_FUNCS, &funcs) < 0) {
+        funcs = 0;
+    }
+    return funcs;
+}
+
+void
+onlp_i2c_fd_cache_invalidate(int bus)
+{
+}
+
+#endif /* ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE */
+
+void
+onlp_i2c_fd_cache_stats_get(onlp_i2c_fd_cache_stats_t* stats)
+{
+    pthread_mutex_lock(&i2c_fd_cache_lock__);
+    *stats = i2c_fd_cache_stats__;
+    pthread_mutex_unlock(&i2c_fd_cache_lock__);
+}
+
+void
+onlp_i2c_fd_cache_show(aim_pvs_t* pvs)
+{
+    onlp_i2c_fd_cache_stats_t stats;
+    onlp_i2c_fd_cache_stats_get(&stats);
+
+    aim_printf(pvs, "i2c descriptor cache (this process): size=%d\n",
+               ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE);
+    aim_printf(pvs, "  opens          %llu\n", (unsigned long long)stats.opens);
+    aim_printf(pvs, "  opens avoided  %llu\n", (unsigned long long)stats.opens_avoided);
+    aim_printf(pvs, "  errors         %llu\n", (unsigned long long)stats.errors);
+    aim_printf(pvs, "  evictions      %llu\n", (unsigned long long)stats.evictions);
+}
+
+/**
+ * Read using combined (offset write, repeated start, read) I2C_RDWR
+ * transactions.
+ *
+ * Returns 0 on success, ONLP_STATUS_E_UNSUPPORTED if the adapter
+ * cannot perform the transfer (the caller should fall back to SMBus),
+ * or ONLP_STATUS_E_I2C on a transfer error.
+ */
+static int
+i2c_rdwr_read__(int fd, int bus, uint8_t addr, uint8_t offset, int size,
+                uint8_t* rdata, uint32_t flags)
+{
+    struct i2c_msg msgs[2];
+    struct i2c_rdwr_ioctl_data xfer;
+    uint16_t mflags = (flags & ONLP_I2C_F_TENBIT) ? I2C_M_TEN : 0;
+    int count = size;
+    uint8_t* p = rdata;
+
+    /* PEC is only defined for SMBus transfers. */
+    if(flags & ONLP_I2C_F_PEC) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    if(!(i2c_fd_funcs__(fd) & I2C_FUNC_I2C)) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    while(count > 0) {
+        int rsize = (count >= ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE) ? ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE : count;
+        int retries = (flags & ONLP_I2C_F_DISABLE_READ_RETRIES) ? 1 : ONLPLIB_CONFIG_I2C_READ_RETRY_COUNT;
+        int rv = -1;
+
+        msgs[0].addr = addr;
+        msgs[0].flags = mflags;
+        msgs[0].len = 1;
+        msgs[0].buf = &offset;
+
+        msgs[1].addr = addr;
+        msgs[1].flags = mflags | I2C_M_RD;
+        msgs[1].len = rsize;
+        msgs[1].buf = p;
+
+        xfer.msgs = msgs;
+        xfer.nmsgs = 2;
+
+        while(retries-- && rv < 0) {
+            rv = ioctl(fd, I2C_RDWR, &xfer);
+            if(rv < 0 && (errno == EOPNOTSUPP || errno == EINVAL)) {
+                /* Adapter quirks (e.g. maximum read length) reject the transfer. */
+                return ONLP_STATUS_E_UNSUPPORTED;
+            }
+        }
+
+        if(rv < 0) {
+            int err = errno;
+            AIM_LOG_ERROR("i2c-%d: combined read address 0x%x, offset %d, size=%d failed: %{errno}",
+                          bus, addr, (int)(p - rdata), rsize, err);
+            errno = err;
+            return ONLP_STATUS_E_I2C;
+        }
+
+        offset += rsize;
+        p += rsize;
+        count -= rsize;
+    }
+
+    return 0;
+}
+
+int
+onlp_i2c_bus_root(int bus)
+{
+    char link[64];
+    char path[PATH_MAX];
+    char* s;
+    int root;
+
+    /*
+     * Mux channel adapters are children of their parent adapter in sysfs,
+     * e.g. /sys/devices/pci0000:00/0000:00:1f.3/i2c-0/i2c-17.
+     * The first adapter in the resolved path is the root.
+     */
+    snprintf(link, sizeof(link), "/sys/bus/i2c/devices/i2c-%d", bus);
+    if(realpath(link, path) == NULL) {
+        return bus;
+    }
+    if( (s = strstr(path, "/i2c-")) && sscanf(s, "/i2c-%d", &root) == 1) {
+        return root;
+    }
+    return bus;
+}
+
 int
 onlp_i2c_block_read(int bus, uint8_t addr, uint8_t offset, int size,
                     uint8_t* rdata, uint32_t flags)
 {
     int fd;
+    int err;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    fd = i2c_fd_get__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
     }
 
+    if(flags & ONLP_I2C_F_USE_RDWR_READ) {
+        int rv = i2c_rdwr_read__(fd, bus, addr, offset, size, rdata, flags);
+        if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+            i2c_fd_put__(fd, (rv < 0) ? I2C_ERRNO__() : 0);
+            return rv;
+        }
+    }
+
     int count = size;
     uint8_t* p = rdata;
     while(count > 0) {
@@ -118,8 +524,9 @@ onlp_i2c_block_read(int bus, uint8_t addr, uint8_t offset, int size,
         }
 
         if(rv != rsize) {
+            err = (rv < 0) ? I2C_ERRNO__() : EIO;
             AIM_LOG_ERROR("i2c-%d: reading address 0x%x, offset %d, size=%d failed: %{errno}",
-                          bus, addr, p - rdata, rsize, errno);
+                          bus, addr, (int)(p - rdata), rsize, err);
             goto error;
         }
 
@@ -127,11 +534,11 @@ onlp_i2c_block_read(int bus, uint8_t addr, uint8_t offset, int size,
         count -= rsize;
     }
 
-    close(fd);
+    i2c_fd_put__(fd, 0);
     return 0;
 
  error:
-    close(fd);
+    i2c_fd_put__(fd, err);
     return ONLP_STATUS_E_I2C;
 }
 
@@ -141,13 +548,22 @@ onlp_i2c_read(int bus, uint8_t addr, uint8_t offset, int size,
 {
     int i;
     int fd;
+    int err;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    fd = i2c_fd_get__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
     }
 
+    if(flags & ONLP_I2C_F_USE_RDWR_READ) {
+        int rv = i2c_rdwr_read__(fd, bus, addr, offset, size, rdata, flags);
+        if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+            i2c_fd_put__(fd, (rv < 0) ? I2C_ERRNO__() : 0);
+            return rv;
+        }
+    }
+
     for(i = 0; i < size; i++) {
         int rv = -1;
         int retries = (flags & ONLP_I2C_F_DISABLE_READ_RETRIES) ? 1: ONLPLIB_CONFIG_I2C_READ_RETRY_COUNT;
@@ -157,19 +573,20 @@ onlp_i2c_read(int bus, uint8_t addr, uint8_t offset, int size,
         }
 
         if(rv < 0) {
+            err = I2C_ERRNO__();
             AIM_LOG_ERROR("i2c-%d: reading address 0x%x, offset %d failed: %{errno}",
-                          bus, addr, offset+i, errno);
+                          bus, addr, offset+i, err);
             goto error;
         }
         else {
             rdata[i] = rv;
         }
     }
-    close(fd);
+    i2c_fd_put__(fd, 0);
     return 0;
 
  error:
-    close(fd);
+    i2c_fd_put__(fd, err);
     return ONLP_STATUS_E_I2C;
 }
 
@@ -180,8 +597,9 @@ onlp_i2c_write(int bus, uint8_t addr, uint8_t offset, int size,
 {
     int i;
     int fd;
+    int err;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    fd = i2c_fd_get__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
@@ -190,16 +608,17 @@ onlp_i2c_write(int bus, uint8_t addr, uint8_t offset, int size,
     for(i = 0; i < size; i++) {
         int rv = i2c_smbus_write_byte_data(fd, offset+i, data[i]);
         if(rv < 0) {
+            err = I2C_ERRNO__();
             AIM_LOG_ERROR("i2c-%d: writing address 0x%x, offset %d failed: %{errno}",
-                          bus, addr, offset+i, errno);
+                          bus, addr, offset+i, err);
             goto error;
         }
     }
-    close(fd);
+    i2c_fd_put__(fd, 0);
     return 0;
 
  error:
-    close(fd);
+    i2c_fd_put__(fd, err);
     return ONLP_STATUS_E_I2C;
 }
 
@@ -236,7 +655,7 @@ onlp_i2c_readw(int bus, uint8_t addr, uint8_t offset, uint32_t flags)
     int fd;
     int rv;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    fd = i2c_fd_get__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
@@ -244,7 +663,7 @@ onlp_i2c_readw(int bus, uint8_t addr, uint8_t offset, uint32_t flags)
 
     rv = i2c_smbus_read_word_data(fd, offset);
 
-    close(fd);
+    i2c_fd_put__(fd, (rv < 0) ? I2C_ERRNO__() : 0);
     return rv;
 }
 
@@ -255,7 +674,7 @@ onlp_i2c_writew(int bus, uint8_t addr, uint8_t offset, uint16_t word,
     int fd;
     int rv;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    fd = i2c_fd_get__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
@@ -263,7 +682,7 @@ onlp_i2c_writew(int bus, uint8_t addr, uint8_t offset, uint16_t word,
 
     rv = i2c_smbus_write_word_data(fd, offset, word);
 
-    close(fd);
+    i2c_fd_put__(fd, (rv < 0) ? I2C_ERRNO__() : 0);
     return rv;
 
 }
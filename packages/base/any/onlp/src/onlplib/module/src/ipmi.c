@@ -0,0 +1,795 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlp/onlp.h>
+#include <onlplib/ipmi.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <linux/ipmi.h>
+#include <OS/os_time.h>
+#include "onlplib_log.h"
+
+#define IPMI_CMD_GET_SENSOR_READING 0x2D
+#define IPMI_CMD_RESERVE_SDR_REPOSITORY 0x22
+#define IPMI_CMD_GET_SDR 0x23
+#define IPMI_CMD_READ_FRU_DATA 0x11
+
+#define IPMI_CC_RESERVATION_CANCELLED 0xC5
+
+#define SDR_RECORD_TYPE_FULL 0x01
+#define SDR_RECORD_TYPE_COMPACT 0x02
+#define SDR_HEADER_SIZE 5
+#define SDR_RECORD_SIZE_MAX (SDR_HEADER_SIZE + 255)
+#define SDR_READ_CHUNK 16
+#define SDR_LAST_RECORD 0xFFFF
+
+#define FRU_READ_CHUNK 16
+#define FRU_PRODUCT_SIZE_MAX (255 * 8)
+
+/* Request status while its response is outstanding. */
+#define REQUEST_PENDING 1
+
+/*
+ * The device is shared by all threads. Message ids increase
+ * monotonically so late responses to requests that timed out
+ * are recognized and dropped.
+ */
+static pthread_mutex_t ipmi_lock__ = PTHREAD_MUTEX_INITIALIZER;
+static int ipmi_fd__ = -1;
+static long ipmi_msgid__ = 0;
+static onlp_ipmi_transport_t transport__;
+
+static onlp_ipmi_sensor_t* sdr_cache__ = NULL;
+static int sdr_count__ = 0;
+static int sdr_loaded__ = 0;
+
+static int
+ipmi_open_locked__(void)
+{
+    if(transport__.send || ipmi_fd__ >= 0) {
+        return 0;
+    }
+    if((ipmi_fd__ = open(ONLPLIB_CONFIG_IPMI_DEVICE, O_RDWR | O_CLOEXEC)) < 0) {
+        AIM_LOG_ERROR("Could not open %s: %{errno}", ONLPLIB_CONFIG_IPMI_DEVICE, errno);
+        return ONLP_STATUS_E_MISSING;
+    }
+    return 0;
+}
+
+static int
+ipmi_send_locked__(onlp_ipmi_request_t* r, long msgid)
+{
+    struct ipmi_system_interface_addr addr;
+    struct ipmi_req req;
+
+    if(transport__.send) {
+        return transport__.send(transport__.cookie, r, msgid);
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.addr_type = IPMI_SYSTEM_INTERFACE_ADDR_TYPE;
+    addr.channel = IPMI_BMC_CHANNEL;
+    addr.lun = r->lun;
+
+    memset(&req, 0, sizeof(req));
+    req.addr = (unsigned char*)&addr;
+    req.addr_len = sizeof(addr);
+    req.msgid = msgid;
+    req.msg.netfn = r->netfn;
+    req.msg.cmd = r->cmd;
+    req.msg.data = (unsigned char*)r->data;
+    req.msg.data_len = r->data_len;
+
+    if(ioctl(ipmi_fd__, IPMICTL_SEND_COMMAND, &req) < 0) {
+        AIM_LOG_ERROR("IPMI netfn 0x%x cmd 0x%x send failed: %{errno}",
+                      r->netfn, r->cmd, errno);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return 0;
+}
+
+/**
+ * Receive one response.
+ * Returns 1 and the msgid if a response was received, 0 on timeout.
+ */
+static int
+ipmi_recv_locked__(uint8_t* data, int* len, long* msgid, int timeout_ms)
+{
+    struct pollfd pfd;
+    struct ipmi_addr addr;
+    struct ipmi_recv recv;
+    int rv;
+
+    if(transport__.recv) {
+        return transport__.recv(transport__.cookie, data, len, msgid, timeout_ms);
+    }
+
+    pfd.fd = ipmi_fd__;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    rv = poll(&pfd, 1, timeout_ms);
+    if(rv < 0 && errno == EINTR) {
+        return 0;
+    }
+    if(rv <= 0) {
+        return rv;
+    }
+
+    memset(&recv, 0, sizeof(recv));
+    recv.addr = (unsigned char*)&addr;
+    recv.addr_len = sizeof(addr);
+    recv.msg.data = data;
+    recv.msg.data_len = ONLP_IPMI_DATA_MAX + 1;
+
+    if(ioctl(ipmi_fd__, IPMICTL_RECEIVE_MSG_TRUNC, &recv) < 0 && errno != EMSGSIZE) {
+        return (errno == EAGAIN) ? 0 : -1;
+    }
+
+    if(recv.recv_type != IPMI_RESPONSE_RECV_TYPE) {
+        /* Events and commands are not ours. */
+        *msgid = -1;
+        *len = 0;
+        return 1;
+    }
+
+    *msgid = recv.msgid;
+    *len = recv.msg.data_len;
+    return 1;
+}
+
+static void
+ipmi_complete__(onlp_ipmi_request_t* r, uint8_t* data, int len)
+{
+    if(len < 1) {
+        r->status = ONLP_STATUS_E_INTERNAL;
+        return;
+    }
+
+    r->ccode = data[0];
+    r->rsp_len = len - 1;
+    if(r->rsp_len > r->rsp_max) {
+        r->rsp_len = r->rsp_max;
+    }
+    if(r->rsp_len && r->rsp) {
+        memcpy(r->rsp, data + 1, r->rsp_len);
+    }
+    r->status = r->ccode ? ONLP_STATUS_E_INTERNAL : ONLP_STATUS_OK;
+}
+
+static int
+ipmi_batch_locked__(onlp_ipmi_request_t* requests, int count)
+{
+    int i, rv;
+    int next = 0;
+    int inflight = 0;
+    int done = 0;
+    long base;
+    uint64_t deadline;
+    uint8_t data[ONLP_IPMI_DATA_MAX + 1];
+
+    if((rv = ipmi_open_locked__()) < 0) {
+        for(i = 0; i < count; i++) {
+            requests[i].status = rv;
+        }
+        return rv;
+    }
+
+    for(i = 0; i < count; i++) {
+        requests[i].status = REQUEST_PENDING;
+        requests[i].ccode = 0;
+        requests[i].rsp_len = 0;
+    }
+
+    /* Request i is sent with msgid base + i. */
+    base = ipmi_msgid__ + 1;
+    ipmi_msgid__ += count;
+
+    deadline = os_time_monotonic() + ONLPLIB_CONFIG_IPMI_TIMEOUT_MS * 1000ULL;
+
+    while(done < count) {
+        long msgid;
+        int len;
+        uint64_t now;
+
+        while(next < count && inflight < ONLPLIB_CONFIG_IPMI_OUTSTANDING_MAX) {
+            if((rv = ipmi_send_locked__(requests + next, base + next)) < 0) {
+                requests[next].status = rv;
+                done++;
+            }
+            else {
+                inflight++;
+            }
+            next++;
+        }
+
+        if(inflight == 0) {
+            continue;
+        }
+
+        now = os_time_monotonic();
+        if(now >= deadline) {
+            AIM_LOG_ERROR("IPMI: %d request(s) timed out.", inflight);
+            break;
+        }
+
+        rv = ipmi_recv_locked__(data, &len, &msgid, (deadline - now + 999) / 1000);
+        if(rv < 0) {
+            AIM_LOG_ERROR("IPMI receive failed: %{errno}", errno);
+            break;
+        }
+        if(rv == 0 || msgid < base || msgid >= base + next) {
+            continue;
+        }
+
+        i = msgid - base;
+        if(requests[i].status == REQUEST_PENDING) {
+            ipmi_complete__(requests + i, data, len);
+            inflight--;
+            done++;
+        }
+    }
+
+    rv = ONLP_STATUS_OK;
+    for(i = 0; i < count; i++) {
+        if(requests[i].status == REQUEST_PENDING) {
+            requests[i].status = ONLP_STATUS_E_INTERNAL;
+        }
+        if(requests[i].status < 0) {
+            rv = requests[i].status;
+        }
+    }
+    return rv;
+}
+
+int
+onlp_ipmi_raw_batch(onlp_ipmi_request_t* requests, int count)
+{
+    int rv;
+
+    if(count <= 0) {
+        return ONLP_STATUS_OK;
+    }
+
+    pthread_mutex_lock(&ipmi_lock__);
+    rv = ipmi_batch_locked__(requests, count);
+    pthread_mutex_unlock(&ipmi_lock__);
+    return rv;
+}
+
+int
+onlp_ipmi_raw(uint8_t netfn, uint8_t cmd,
+              const uint8_t* data, int data_len,
+              uint8_t* rsp, int rsp_max, int* rsp_len)
+{
+    int rv;
+    onlp_ipmi_request_t r;
+
+    memset(&r, 0, sizeof(r));
+    r.netfn = netfn;
+    r.cmd = cmd;
+    r.data = data;
+    r.data_len = data_len;
+    r.rsp = rsp;
+    r.rsp_max = rsp_max;
+
+    rv = onlp_ipmi_raw_batch(&r, 1);
+    if(rv < 0 && r.ccode) {
+        AIM_LOG_ERROR("IPMI netfn 0x%x cmd 0x%x failed: completion code 0x%x",
+                      netfn, cmd, r.ccode);
+    }
+    if(rsp_len) {
+        *rsp_len = r.rsp_len;
+    }
+    return rv;
+}
+
+static void
+sdr_clear_locked__(void)
+{
+    aim_free(sdr_cache__);
+    sdr_cache__ = NULL;
+    sdr_count__ = 0;
+    sdr_loaded__ = 0;
+}
+
+void
+onlp_ipmi_transport_set(const onlp_ipmi_transport_t* transport)
+{
+    pthread_mutex_lock(&ipmi_lock__);
+    if(ipmi_fd__ >= 0) {
+        close(ipmi_fd__);
+        ipmi_fd__ = -1;
+    }
+    if(transport) {
+        transport__ = *transport;
+    }
+    else {
+        memset(&transport__, 0, sizeof(transport__));
+    }
+    /* The repository belongs to the previous BMC. */
+    sdr_clear_locked__();
+    pthread_mutex_unlock(&ipmi_lock__);
+}
+
+
+/**
+ * Sign extend an n bit value.
+ */
+static int
+sign_extend__(int value, int bits)
+{
+    int m = 1 << (bits - 1);
+    value &= (1 << bits) - 1;
+    return (value ^ m) - m;
+}
+
+static void
+sdr_record_parse__(const uint8_t* rec, int len, onlp_ipmi_sensor_t* s)
+{
+    int idlen, idoff;
+
+    memset(s, 0, sizeof(*s));
+    s->record_type = rec[3];
+    s->lun = rec[6] & 0x3;
+    s->number = rec[7];
+    s->sensor_type = rec[12];
+    s->unit = rec[21];
+
+    if(s->record_type == SDR_RECORD_TYPE_FULL) {
+        s->analog_format = rec[20] >> 6;
+        s->linearization = rec[23] & 0x7F;
+        s->m = sign_extend__(rec[24] | ((rec[25] & 0xC0) << 2), 10);
+        s->b = sign_extend__(rec[26] | ((rec[27] & 0xC0) << 2), 10);
+        s->r_exp = sign_extend__(rec[29] >> 4, 4);
+        s->b_exp = sign_extend__(rec[29] & 0xF, 4);
+        idoff = 47;
+    }
+    else {
+        idoff = 31;
+    }
+
+    idlen = (idoff < len) ? (rec[idoff] & 0x1F) : 0;
+    if(idoff + 1 + idlen > len) {
+        idlen = len - idoff - 1;
+    }
+    if(idlen > (int)sizeof(s->name) - 1) {
+        idlen = sizeof(s->name) - 1;
+    }
+    if(idlen > 0) {
+        memcpy(s->name, rec + idoff + 1, idlen);
+    }
+}
+
+static int
+sdr_reserve_locked__(uint16_t* reservation)
+{
+    uint8_t rsp[2];
+    onlp_ipmi_request_t r;
+
+    memset(&r, 0, sizeof(r));
+    r.netfn = ONLP_IPMI_NETFN_STORAGE;
+    r.cmd = IPMI_CMD_RESERVE_SDR_REPOSITORY;
+    r.rsp = rsp;
+    r.rsp_max = sizeof(rsp);
+
+    if(ipmi_batch_locked__(&r, 1) < 0 || r.rsp_len < 2) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    *reservation = rsp[0] | (rsp[1] << 8);
+    return 0;
+}
+
+/**
+ * Read part of an SDR record.
+ */
+static int
+sdr_get_locked__(uint16_t* reservation, uint16_t id, int offset, int size,
+                 uint8_t* data, uint16_t* next)
+{
+    int retry;
+    uint8_t req[6];
+    uint8_t rsp[2 + SDR_READ_CHUNK];
+    onlp_ipmi_request_t r;
+
+    for(retry = 0; retry < 3; retry++) {
+        req[0] = *reservation & 0xFF;
+        req[1] = *reservation >> 8;
+        req[2] = id & 0xFF;
+        req[3] = id >> 8;
+        req[4] = offset;
+        req[5] = size;
+
+        memset(&r, 0, sizeof(r));
+        r.netfn = ONLP_IPMI_NETFN_STORAGE;
+        r.cmd = IPMI_CMD_GET_SDR;
+        r.data = req;
+        r.data_len = sizeof(req);
+        r.rsp = rsp;
+        r.rsp_max = sizeof(rsp);
+
+        ipmi_batch_locked__(&r, 1);
+        if(r.status == ONLP_STATUS_OK && r.rsp_len >= 2 + size) {
+            *next = rsp[0] | (rsp[1] << 8);
+            memcpy(data, rsp + 2, size);
+            return 0;
+        }
+        if(r.ccode != IPMI_CC_RESERVATION_CANCELLED ||
+           sdr_reserve_locked__(reservation) < 0) {
+            break;
+        }
+    }
+    return ONLP_STATUS_E_INTERNAL;
+}
+
+/**
+ * Read the repository.
+ *
+ * Records are collected in a private array which only replaces
+ * the cache once the whole repository has been read, so a load
+ * which fails part way leaves nothing behind and the next lookup
+ * starts again from the first record.
+ */
+static int
+sdr_load_locked__(void)
+{
+    uint16_t reservation;
+    uint16_t id = 0;
+    uint16_t next;
+    uint8_t rec[SDR_RECORD_SIZE_MAX];
+    int offset, len, chunk;
+    onlp_ipmi_sensor_t* cache = NULL;
+    int count = 0;
+    int max = 0;
+
+    if(sdr_loaded__) {
+        return 0;
+    }
+
+    if(ipmi_open_locked__() < 0 || sdr_reserve_locked__(&reservation) < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    while(id != SDR_LAST_RECORD) {
+        if(sdr_get_locked__(&reservation, id, 0, SDR_HEADER_SIZE, rec, &next) < 0) {
+            goto error;
+        }
+        len = SDR_HEADER_SIZE + rec[4];
+
+        if(rec[3] == SDR_RECORD_TYPE_FULL || rec[3] == SDR_RECORD_TYPE_COMPACT) {
+            for(offset = SDR_HEADER_SIZE; offset < len; offset += chunk) {
+                chunk = (len - offset > SDR_READ_CHUNK) ? SDR_READ_CHUNK : len - offset;
+                if(sdr_get_locked__(&reservation, id, offset, chunk, rec + offset, &next) < 0) {
+                    goto error;
+                }
+            }
+            if(count == max) {
+                max = max ? max * 2 : 64;
+                cache = aim_realloc(cache, max * sizeof(*cache));
+            }
+            sdr_record_parse__(rec, len, cache + count++);
+        }
+
+        if(next == id) {
+            break;
+        }
+        id = next;
+    }
+
+    sdr_clear_locked__();
+    sdr_cache__ = cache;
+    sdr_count__ = count;
+    sdr_loaded__ = 1;
+    return 0;
+
+ error:
+    AIM_LOG_ERROR("IPMI: could not read SDR record 0x%x", id);
+    aim_free(cache);
+    return ONLP_STATUS_E_INTERNAL;
+}
+
+void
+onlp_ipmi_sdr_invalidate(void)
+{
+    pthread_mutex_lock(&ipmi_lock__);
+    sdr_clear_locked__();
+    pthread_mutex_unlock(&ipmi_lock__);
+}
+
+int
+onlp_ipmi_sensor_find(const char* name, onlp_ipmi_sensor_t* sensor)
+{
+    int i;
+    int rv = ONLP_STATUS_E_MISSING;
+
+    pthread_mutex_lock(&ipmi_lock__);
+    if(sdr_load_locked__() < 0) {
+        rv = ONLP_STATUS_E_INTERNAL;
+    }
+    else {
+        for(i = 0; i < sdr_count__; i++) {
+            if(!strcmp(sdr_cache__[i].name, name)) {
+                *sensor = sdr_cache__[i];
+                rv = ONLP_STATUS_OK;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&ipmi_lock__);
+    return rv;
+}
+
+static double
+pow10__(int e)
+{
+    double v = 1.0;
+    for(; e > 0; e--) {
+        v *= 10.0;
+    }
+    for(; e < 0; e++) {
+        v /= 10.0;
+    }
+    return v;
+}
+
+/**
+ * Convert a Get Sensor Reading response.
+ */
+static int
+sensor_convert__(const onlp_ipmi_sensor_t* s, const uint8_t* rsp, int len,
+                 double* value)
+{
+    int x;
+
+    /* Byte 1 bit 5: reading unavailable. */
+    if(len < 2 || (rsp[1] & 0x20)) {
+        return ONLP_STATUS_E_MISSING;
+    }
+
+    if(s->record_type != SDR_RECORD_TYPE_FULL) {
+        *value = rsp[0];
+        return ONLP_STATUS_OK;
+    }
+
+    switch(s->analog_format)
+        {
+        case 1: x = (rsp[0] & 0x80) ? -(int)(~rsp[0] & 0x7F) : rsp[0]; break;
+        case 2: x = (int8_t)rsp[0]; break;
+        default: x = rsp[0]; break;
+        }
+
+    /* Only linear sensors are supported. */
+    if(s->linearization != 0) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    *value = ((double)s->m * x + (double)s->b * pow10__(s->b_exp)) * pow10__(s->r_exp);
+    return ONLP_STATUS_OK;
+}
+
+/**
+ * Read a set of sensors with one batch of Get Sensor Reading requests.
+ */
+static int
+sensors_read__(const onlp_ipmi_sensor_t* sensors, int count, double* values,
+               int* status)
+{
+    int i, rv;
+    onlp_ipmi_request_t* requests = aim_zmalloc(count * sizeof(*requests));
+    uint8_t (*rsp)[4] = aim_zmalloc(count * sizeof(*rsp));
+
+    for(i = 0; i < count; i++) {
+        requests[i].netfn = ONLP_IPMI_NETFN_SENSOR;
+        requests[i].cmd = IPMI_CMD_GET_SENSOR_READING;
+        requests[i].lun = sensors[i].lun;
+        requests[i].data = &sensors[i].number;
+        requests[i].data_len = 1;
+        requests[i].rsp = rsp[i];
+        requests[i].rsp_max = sizeof(rsp[i]);
+    }
+
+    onlp_ipmi_raw_batch(requests, count);
+
+    rv = ONLP_STATUS_OK;
+    for(i = 0; i < count; i++) {
+        int r = requests[i].status;
+        if(r == ONLP_STATUS_OK) {
+            r = sensor_convert__(sensors + i, requests[i].rsp, requests[i].rsp_len,
+                                 values + i);
+        }
+        status[i] = r;
+        if(r < 0) {
+            rv = r;
+        }
+    }
+
+    aim_free(rsp);
+    aim_free(requests);
+    return rv;
+}
+
+int
+onlp_ipmi_sensor_read(const onlp_ipmi_sensor_t* sensor, double* value)
+{
+    int status;
+    sensors_read__(sensor, 1, value, &status);
+    return status;
+}
+
+int
+onlp_ipmi_sensor_read_name(const char* name, double* value)
+{
+    return onlp_ipmi_sensors_read(&name, 1, value, NULL);
+}
+
+int
+onlp_ipmi_sensors_read(const char** names, int count,
+                       double* values, int* status)
+{
+    int i, n = 0;
+    int rv = ONLP_STATUS_OK;
+    onlp_ipmi_sensor_t* sensors = aim_zmalloc(count * sizeof(*sensors));
+    double* v = aim_zmalloc(count * sizeof(*v));
+    int* st = aim_zmalloc(count * sizeof(*st));
+    int* index = aim_zmalloc(count * sizeof(*index));
+
+    for(i = 0; i < count; i++) {
+        int r = onlp_ipmi_sensor_find(names[i], sensors + n);
+        if(status) {
+            status[i] = r;
+        }
+        if(r < 0) {
+            AIM_LOG_ERROR("IPMI sensor '%s' not found.", names[i]);
+            rv = r;
+            continue;
+        }
+        index[n++] = i;
+    }
+
+    if(n) {
+        sensors_read__(sensors, n, v, st);
+    }
+
+    for(i = 0; i < n; i++) {
+        values[index[i]] = v[i];
+        if(status) {
+            status[index[i]] = st[i];
+        }
+        if(st[i] < 0) {
+            rv = st[i];
+        }
+    }
+
+    aim_free(index);
+    aim_free(st);
+    aim_free(v);
+    aim_free(sensors);
+    return rv;
+}
+
+
+/**
+ * Read part of a FRU device.
+ */
+static int
+fru_read__(uint8_t fru, int offset, uint8_t* data, int size)
+{
+    int chunk, len;
+    uint8_t req[4];
+    uint8_t rsp[1 + FRU_READ_CHUNK];
+
+    while(size > 0) {
+        chunk = (size > FRU_READ_CHUNK) ? FRU_READ_CHUNK : size;
+        req[0] = fru;
+        req[1] = offset & 0xFF;
+        req[2] = offset >> 8;
+        req[3] = chunk;
+        if(onlp_ipmi_raw(ONLP_IPMI_NETFN_STORAGE, IPMI_CMD_READ_FRU_DATA,
+                         req, sizeof(req), rsp, sizeof(rsp), &len) < 0) {
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        /* The first byte is the number of bytes returned. */
+        if(len < 2 || rsp[0] == 0 || rsp[0] > chunk || rsp[0] > len - 1) {
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        memcpy(data, rsp + 1, rsp[0]);
+        data += rsp[0];
+        offset += rsp[0];
+        size -= rsp[0];
+    }
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_ipmi_fru_product_get(uint8_t fru, onlp_ipmi_fru_product_field_t field,
+                          char* value, int size)
+{
+    int i, rv;
+    int offset, len, tl;
+    int n = 0;
+    uint8_t header[8];
+    uint8_t* area;
+
+    if(size <= 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    value[0] = 0;
+
+    /* Common header: byte 4 is the product info area offset (in 8 byte units). */
+    if((rv = fru_read__(fru, 0, header, sizeof(header))) < 0) {
+        return rv;
+    }
+    if(header[0] != 0x01 || header[4] == 0) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    offset = header[4] * 8;
+
+    /* Area header: version, length (in 8 byte units), language. */
+    if((rv = fru_read__(fru, offset, header, 3)) < 0) {
+        return rv;
+    }
+    len = header[1] * 8;
+    if(len < 3 || len > FRU_PRODUCT_SIZE_MAX) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    area = aim_zmalloc(len);
+    if((rv = fru_read__(fru, offset, area, len)) < 0) {
+        aim_free(area);
+        return rv;
+    }
+
+    /* Skip the type/length fields which precede this one. */
+    rv = ONLP_STATUS_E_MISSING;
+    for(i = 3; i < len && area[i] != 0xC1; i += 1 + (tl & 0x3F)) {
+        tl = area[i];
+        if(i + 1 + (tl & 0x3F) > len) {
+            rv = ONLP_STATUS_E_INTERNAL;
+            break;
+        }
+        if(n++ != field) {
+            continue;
+        }
+        /* Only 8-bit ASCII (type 11b) is supported. */
+        if((tl >> 6) != 0x3) {
+            rv = ONLP_STATUS_E_UNSUPPORTED;
+            break;
+        }
+        tl &= 0x3F;
+        if(tl > size - 1) {
+            tl = size - 1;
+        }
+        memcpy(value, area + i + 1, tl);
+        value[tl] = 0;
+        rv = ONLP_STATUS_OK;
+        break;
+    }
+
+    aim_free(area);
+    return rv;
+}
@@ -343,6 +343,44 @@ onlp_onie_info_free(onlp_onie_info_t* info)
     }
 }
 
+void
+onlp_onie_info_copy(onlp_onie_info_t* dst, const onlp_onie_info_t* src)
+{
+    list_links_t* cur;
+
+    *dst = *src;
+
+#define COPY_STRING(_member)                                    \
+    do {                                                        \
+        dst->_member = src->_member ? aim_strdup(src->_member) : NULL; \
+    } while(0)
+
+    COPY_STRING(product_name);
+    COPY_STRING(part_number);
+    COPY_STRING(serial_number);
+    COPY_STRING(manufacture_date);
+    COPY_STRING(label_revision);
+    COPY_STRING(platform_name);
+    COPY_STRING(onie_version);
+    COPY_STRING(manufacturer);
+    COPY_STRING(country_code);
+    COPY_STRING(vendor);
+    COPY_STRING(diag_version);
+    COPY_STRING(service_tag);
+    COPY_STRING(_hdr_id_string);
+
+#undef COPY_STRING
+
+    list_init(&dst->vx_list);
+    LIST_FOREACH((list_head_t*)&src->vx_list, cur) {
+        onlp_onie_vx_t* vx = container_of(cur, links, onlp_onie_vx_t);
+        onlp_onie_vx_t* copy = aim_zmalloc(sizeof(*copy));
+        memcpy(copy->data, vx->data, vx->size);
+        copy->size = vx->size;
+        list_push(&dst->vx_list, &copy->links);
+    }
+}
+
 void
 onlp_onie_show(onlp_onie_info_t* info, aim_pvs_t* pvs)
 {
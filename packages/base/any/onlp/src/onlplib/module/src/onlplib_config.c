@@ -89,6 +89,76 @@ onlplib_config_settings_t onlplib_config_settings[] =
     { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_INCLUDE_I2C_SMBUS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_INCLUDE_I2C_SMBUS) },
 #else
 { ONLPLIB_CONFIG_INCLUDE_I2C_SMBUS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE) },
+#else
+{ ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_I2C_FD_CACHE_IDLE_MS
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_FD_CACHE_IDLE_MS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_FD_CACHE_IDLE_MS) },
+#else
+{ ONLPLIB_CONFIG_I2C_FD_CACHE_IDLE_MS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE) },
+#else
+{ ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_INCLUDE_ETHTOOL_NETLINK
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_INCLUDE_ETHTOOL_NETLINK), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_INCLUDE_ETHTOOL_NETLINK) },
+#else
+{ ONLPLIB_CONFIG_INCLUDE_ETHTOOL_NETLINK(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_DEVICE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_DEVICE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_DEVICE) },
+#else
+{ ONLPLIB_CONFIG_IPMI_DEVICE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_TIMEOUT_MS
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_TIMEOUT_MS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_TIMEOUT_MS) },
+#else
+{ ONLPLIB_CONFIG_IPMI_TIMEOUT_MS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_OUTSTANDING_MAX
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_OUTSTANDING_MAX), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_OUTSTANDING_MAX) },
+#else
+{ ONLPLIB_CONFIG_IPMI_OUTSTANDING_MAX(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_FILE_UDS_WORKER_THREADS
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_FILE_UDS_WORKER_THREADS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_FILE_UDS_WORKER_THREADS) },
+#else
+{ ONLPLIB_CONFIG_FILE_UDS_WORKER_THREADS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_FILE_UDS_CLIENT_IDLE_MAX
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_FILE_UDS_CLIENT_IDLE_MAX), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_FILE_UDS_CLIENT_IDLE_MAX) },
+#else
+{ ONLPLIB_CONFIG_FILE_UDS_CLIENT_IDLE_MAX(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_FILE_UDS_DATA_MAX
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_FILE_UDS_DATA_MAX), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_FILE_UDS_DATA_MAX) },
+#else
+{ ONLPLIB_CONFIG_FILE_UDS_DATA_MAX(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_BMC_TTY_TIMEOUT_MS
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_BMC_TTY_TIMEOUT_MS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_BMC_TTY_TIMEOUT_MS) },
+#else
+{ ONLPLIB_CONFIG_BMC_TTY_TIMEOUT_MS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE) },
+#else
+{ ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_BMC_TTY_BATCH_CMD_MAX
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_BMC_TTY_BATCH_CMD_MAX), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_BMC_TTY_BATCH_CMD_MAX) },
+#else
+{ ONLPLIB_CONFIG_BMC_TTY_BATCH_CMD_MAX(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES) },
+#else
+{ ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
@@ -32,6 +32,46 @@
 #define __ONLPLIB_INT_H__
 
 #include <onlplib/onlplib_config.h>
+#include <stdint.h>
+
+/**
+ * Domain socket request/response protocol.
+ *
+ * Clients of onlp_file_uds services connect to the session path,
+ * keep their connections open and exchange framed requests and
+ * responses. Connections to the service path itself are handled
+ * as one-shot connections (the handler is called on the socket).
+ */
+#define ONLP_FILE_UDS_MAGIC 0x4F4E4C46
+
+/** The session path is the service path with this suffix. */
+#define ONLP_FILE_UDS_SESSION_SUFFIX ".session"
+
+typedef enum onlp_file_uds_op_e {
+    ONLP_FILE_UDS_OP_READ = 1,
+    ONLP_FILE_UDS_OP_WRITE = 2,
+} onlp_file_uds_op_t;
+
+typedef struct onlp_file_uds_request_s {
+    uint32_t magic;
+    uint32_t op;
+    /** READ: maximum response length. WRITE: payload length. */
+    uint32_t length;
+} onlp_file_uds_request_t;
+
+typedef struct onlp_file_uds_response_s {
+    uint32_t magic;
+    int32_t status;
+    /** Payload length */
+    uint32_t length;
+} onlp_file_uds_response_t;
+
+/**
+ * Read or write exactly len bytes, retrying on EINTR.
+ * Returns 0 or -1.
+ */
+int onlp_file_uds_recv_all(int fd, void* data, int len);
+int onlp_file_uds_send_all(int fd, const void* data, int len);
 
 
 #endif /* __ONLPLIB_INT_H__ */
@@ -81,6 +81,63 @@ onlplib_sfp_eeprom_read_file(const char* fname, uint8_t data[256])
     return ONLP_STATUS_OK;
 }
 
+/**
+ * Linear optoe file offset for the given address/page/offset.
+ * Lower memory is at 0-127, upper page N is at 128 + N*128.
+ * optoe2 devices place 0x51 after the unpaged 0x50 space.
+ */
+static off_t
+optoe_file_offset__(int optoe2, uint8_t devaddr, int page, int offset)
+{
+    off_t base = (optoe2 && devaddr == 0x51) ? 256 : 0;
+
+    if(offset < 128 || (optoe2 && devaddr == 0x50)) {
+        return base + offset;
+    }
+    return base + (off_t)page*128 + offset;
+}
+
+int
+onlplib_sfp_memory_read_optoe(const char* fname, int optoe2,
+                              uint8_t devaddr, int page, int offset,
+                              int size, uint8_t* data)
+{
+    int fd;
+    int rv = ONLP_STATUS_OK;
+
+    if(devaddr != 0x50 && !(optoe2 && devaddr == 0x51)) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if(offset < 0 || size <= 0 || offset + size > 256 || page < 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    fd = open(fname, O_RDONLY);
+    if (fd < 0) {
+        return ONLP_STATUS_E_MISSING;
+    }
+
+    while(size > 0) {
+        /* Lower and upper memory are not contiguous for pages other than 0. */
+        int chunk = (offset < 128 && offset + size > 128) ? 128 - offset : size;
+        ssize_t nrd = pread(fd, data, chunk,
+                            optoe_file_offset__(optoe2, devaddr, page, offset));
+        if(nrd != chunk) {
+            AIM_LOG_INTERNAL("Failed to read %d bytes at offset %d page %d from EEPROM file '%s'",
+                             chunk, offset, page, fname);
+            rv = ONLP_STATUS_E_INTERNAL;
+            break;
+        }
+        data += chunk;
+        offset += chunk;
+        size -= chunk;
+    }
+
+    close(fd);
+    return rv;
+}
+
 int
 onlplib_sfp_reset_file(const char* fname,
                        const char* first, int delay_ms, const char* second)
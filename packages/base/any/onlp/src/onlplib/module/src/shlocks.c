@@ -185,6 +185,31 @@ onlp_shlock_take(onlp_shlock_t* shlock)
     return -1;
 }
 
+int
+onlp_shlock_trytake(onlp_shlock_t* shlock)
+{
+    int rv;
+
+    if(shlock == NULL) {
+        AIM_DIE("shlock_trytake(): lock is NULL");
+    }
+
+    rv = pthread_mutex_trylock(&shlock->mutex);
+    if(rv == 0) {
+        return 0;
+    }
+    if(rv == EBUSY) {
+        return 1;
+    }
+    if(rv == EOWNERDEAD) {
+        AIM_LOG_WARN("Detected EOWNERDEAD on trytake.");
+        pthread_mutex_consistent(&shlock->mutex);
+        return 0;
+    }
+
+    AIM_DIE("mutex_trylock failed: %{errno}", rv);
+    return -1;
+}
 
 /**
  * @brief Give a shared memory lock.
@@ -236,6 +261,16 @@ onlp_shlock_global_take(void)
     return onlp_shlock_take(global_lock__);
 }
 
+int
+onlp_shlock_global_trytake(void)
+{
+#if ONLP_CONFIG_INCLUDE_SHLOCK_GLOBAL_INIT == 0
+    onlp_shlock_global_init();
+#endif
+
+    return onlp_shlock_trytake(global_lock__);
+}
+
 int
 onlp_shlock_global_give(void)
 {
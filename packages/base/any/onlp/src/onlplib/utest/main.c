@@ -23,17 +23,509 @@
  *
  ***********************************************************/
 
+#define _GNU_SOURCE
 #include <onlplib/onlplib_config.h>
+#include <onlplib/ipmi.h>
+#include <onlplib/bmc_tty.h>
+#include <onlp/onlp.h>
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/shm.h>
 #include <AIM/aim.h>
 
+#define CHECK(_expr)                                            \
+    do {                                                        \
+        if(!(_expr)) {                                          \
+            AIM_DIE("%s:%d: check failed: %s",                  \
+                    __FILE__, __LINE__, #_expr);                \
+        }                                                       \
+    } while(0)
+
+/**
+ * A stand-in BMC for the IPMI client.
+ *
+ * It serves a Sensor Data Repository, sensor readings and one
+ * FRU device. Responses are returned newest first, after a stale
+ * response and an event, to exercise message id matching.
+ */
+#define BMC_RECORDS 70
+#define BMC_QUEUE 16
+
+typedef struct bmc_s {
+    /** Fail the Get SDR of this record once (-1 for none). */
+    int fail_record;
+    /** Cancel the next reservation once. */
+    int cancel;
+    uint16_t reservation;
+    int reservations;
+
+    uint8_t fru[64];
+
+    struct {
+        long msgid;
+        int len;
+        uint8_t data[32];
+    } queue[BMC_QUEUE];
+    int queued;
+    int stale;
+} bmc_t;
+
+/**
+ * Record i is a full record named "S<i>" if i is even and a compact
+ * record named "C<i>" if i is odd. Record 3 is not a sensor.
+ */
+static int
+bmc_record__(int i, uint8_t* rec)
+{
+    int idoff, len;
+
+    memset(rec, 0, 64);
+    rec[0] = i & 0xFF;
+    rec[1] = i >> 8;
+    rec[2] = 0x51;
+    if(i == 3) {
+        rec[3] = 0x12;
+        rec[4] = 11;
+        return 16;
+    }
+    rec[3] = (i & 1) ? 0x02 : 0x01;
+    rec[7] = i;
+    if(rec[3] == 0x01) {
+        /* M = 2, B = 0, R = 0, B exp = 0, unsigned, linear. */
+        rec[24] = 2;
+        idoff = 47;
+    }
+    else {
+        idoff = 31;
+    }
+    len = sprintf((char*)rec + idoff + 1, "%c%d", (i & 1) ? 'C' : 'S', i);
+    rec[idoff] = 0xC0 | len;
+    rec[4] = idoff + 1 + len - 5;
+    return idoff + 1 + len;
+}
+
+static void
+bmc_respond__(bmc_t* bmc, long msgid, const uint8_t* data, int len)
+{
+    CHECK(bmc->queued < BMC_QUEUE);
+    bmc->queue[bmc->queued].msgid = msgid;
+    bmc->queue[bmc->queued].len = len;
+    memcpy(bmc->queue[bmc->queued].data, data, len);
+    bmc->queued++;
+}
+
+static int
+bmc_send__(void* cookie, const onlp_ipmi_request_t* r, long msgid)
+{
+    bmc_t* bmc = cookie;
+    uint8_t rsp[32] = { 0 };
+    uint8_t rec[64];
+    int len = 1;
+
+    if(r->netfn == ONLP_IPMI_NETFN_STORAGE && r->cmd == 0x22) {
+        bmc->reservation++;
+        bmc->reservations++;
+        rsp[1] = bmc->reservation & 0xFF;
+        rsp[2] = bmc->reservation >> 8;
+        len = 3;
+    }
+    else if(r->netfn == ONLP_IPMI_NETFN_STORAGE && r->cmd == 0x23) {
+        int id = r->data[2] | (r->data[3] << 8);
+        int offset = r->data[4];
+        int size = r->data[5];
+        int next = (id + 1 < BMC_RECORDS) ? id + 1 : 0xFFFF;
+        uint16_t reservation = r->data[0] | (r->data[1] << 8);
+
+        if(bmc->cancel || reservation != bmc->reservation) {
+            bmc->cancel = 0;
+            bmc->reservation++;
+            rsp[0] = 0xC5;
+        }
+        else if(id == bmc->fail_record) {
+            bmc->fail_record = -1;
+            rsp[0] = 0xCB;
+        }
+        else {
+            bmc_record__(id, rec);
+            rsp[1] = next & 0xFF;
+            rsp[2] = next >> 8;
+            memcpy(rsp + 3, rec + offset, size);
+            len = 3 + size;
+        }
+    }
+    else if(r->netfn == ONLP_IPMI_NETFN_STORAGE && r->cmd == 0x11) {
+        int offset = r->data[1] | (r->data[2] << 8);
+        int count = r->data[3];
+        if(offset + count > (int)sizeof(bmc->fru)) {
+            count = sizeof(bmc->fru) - offset;
+        }
+        rsp[1] = count;
+        memcpy(rsp + 2, bmc->fru + offset, count);
+        len = 2 + count;
+    }
+    else if(r->netfn == ONLP_IPMI_NETFN_SENSOR && r->cmd == 0x2D) {
+        /* The reading is the sensor number + 10, scanning enabled. */
+        rsp[1] = r->data[0] + 10;
+        rsp[2] = 0x40;
+        len = 4;
+    }
+    else {
+        rsp[0] = 0xC1;
+    }
+
+    bmc_respond__(bmc, msgid, rsp, len);
+    return 0;
+}
+
+static int
+bmc_recv__(void* cookie, uint8_t* data, int* len, long* msgid, int timeout_ms)
+{
+    bmc_t* bmc = cookie;
+
+    if(bmc->queued == 0) {
+        return 0;
+    }
+
+    if(bmc->stale) {
+        /* A late response to a request which timed out, then an event. */
+        bmc->stale = (bmc->stale + 1) % 3;
+        *msgid = (bmc->stale == 2) ? 0 : -1;
+        data[0] = 0;
+        *len = 1;
+        return 1;
+    }
+
+    bmc->queued--;
+    *msgid = bmc->queue[bmc->queued].msgid;
+    *len = bmc->queue[bmc->queued].len;
+    memcpy(data, bmc->queue[bmc->queued].data, *len);
+    return 1;
+}
+
+static void
+bmc_fru_init__(bmc_t* bmc)
+{
+    static const char* fields[] = { "ACME", "PSU-1", "P1", "V1", "SN123", "" };
+    uint8_t* area = bmc->fru + 8;
+    int i, n = 3;
+
+    memset(bmc->fru, 0, sizeof(bmc->fru));
+    bmc->fru[0] = 0x01;
+    bmc->fru[4] = 1;
+
+    area[0] = 0x01;
+    area[2] = 0x00;
+    for(i = 0; i < AIM_ARRAYSIZE(fields); i++) {
+        area[n++] = 0xC0 | strlen(fields[i]);
+        memcpy(area + n, fields[i], strlen(fields[i]));
+        n += strlen(fields[i]);
+    }
+    area[n++] = 0xC1;
+    area[1] = (n + 1 + 7) / 8;
+}
+
+void
+ipmi_test(void)
+{
+    bmc_t bmc;
+    onlp_ipmi_transport_t transport;
+    onlp_ipmi_sensor_t sensor;
+    const char* names[] = { "S0", "C1", "S68", "C69", "X1" };
+    double values[AIM_ARRAYSIZE(names)];
+    int status[AIM_ARRAYSIZE(names)];
+    char buf[32];
+    double value;
+
+    memset(&bmc, 0, sizeof(bmc));
+    bmc.fail_record = 66;
+    bmc.cancel = 1;
+    bmc.stale = 1;
+    bmc_fru_init__(&bmc);
+
+    transport.send = bmc_send__;
+    transport.recv = bmc_recv__;
+    transport.cookie = &bmc;
+    onlp_ipmi_transport_set(&transport);
+
+    /* The first load fails part way and leaves nothing behind. */
+    CHECK(onlp_ipmi_sensor_find("S0", &sensor) == ONLP_STATUS_E_INTERNAL);
+
+    /* The second starts again and sees every record once. */
+    CHECK(onlp_ipmi_sensor_find("S68", &sensor) == ONLP_STATUS_OK);
+    CHECK(sensor.number == 68 && sensor.record_type == 0x01 && sensor.m == 2);
+    CHECK(onlp_ipmi_sensor_find("C69", &sensor) == ONLP_STATUS_OK);
+    CHECK(sensor.number == 69 && sensor.record_type == 0x02);
+    CHECK(onlp_ipmi_sensor_find("S3", &sensor) == ONLP_STATUS_E_MISSING);
+
+    /* Full records are converted, compact records are raw. */
+    CHECK(onlp_ipmi_sensor_read_name("S2", &value) == ONLP_STATUS_OK);
+    CHECK(value == 24.0);
+
+    CHECK(onlp_ipmi_sensors_read(names, AIM_ARRAYSIZE(names), values, status) < 0);
+    CHECK(status[0] == ONLP_STATUS_OK && values[0] == 20.0);
+    CHECK(status[1] == ONLP_STATUS_OK && values[1] == 11.0);
+    CHECK(status[2] == ONLP_STATUS_OK && values[2] == 156.0);
+    CHECK(status[3] == ONLP_STATUS_OK && values[3] == 79.0);
+    CHECK(status[4] == ONLP_STATUS_E_MISSING);
+
+    CHECK(onlp_ipmi_fru_product_get(1, ONLP_IPMI_FRU_PRODUCT_NAME, buf, sizeof(buf)) == 0);
+    CHECK(!strcmp(buf, "PSU-1"));
+    CHECK(onlp_ipmi_fru_product_get(1, ONLP_IPMI_FRU_PRODUCT_SERIAL, buf, sizeof(buf)) == 0);
+    CHECK(!strcmp(buf, "SN123"));
+
+    /* Invalidation reloads the repository. */
+    bmc.reservations = 0;
+    onlp_ipmi_sdr_invalidate();
+    CHECK(onlp_ipmi_sensor_find("C1", &sensor) == ONLP_STATUS_OK);
+    CHECK(bmc.reservations == 1);
+
+    onlp_ipmi_transport_set(NULL);
+    printf("ipmi: ok\n");
+}
+
+
+/**
+ * A fake BMC shell on the master side of a pty.
+ *
+ * It echoes each command line, runs the ';' separated parts the
+ * console transport sends (the framing echoes, 'cat', 'false',
+ * 'i2cget' and 'set_fan_speed.sh') and prints the prompt.
+ */
+#define TTY_PROMPT "root@bmc:~# "
+
+typedef struct tty_bmc_s {
+    int fd;
+    int exit;
+    /** Ignore the next this many command lines. */
+    int drop;
+    /** Command lines and file reads seen. */
+    int lines;
+    int cats;
+    char fan[16];
+    pthread_t thread;
+} tty_bmc_t;
+
+static void
+tty_bmc_puts__(tty_bmc_t* bmc, const char* s)
+{
+    int len = strlen(s);
+    while(len > 0) {
+        int rv = write(bmc->fd, s, len);
+        if(rv <= 0) {
+            return;
+        }
+        s += rv;
+        len -= rv;
+    }
+}
+
+static void
+tty_bmc_run__(tty_bmc_t* bmc, char* line)
+{
+    char out[512];
+    char* save = NULL;
+    char* part;
+    int st = 0;
+
+    out[0] = 0;
+    for(part = strtok_r(line, ";", &save); part; part = strtok_r(NULL, ";", &save)) {
+        char* o = out + strlen(out);
+        int left = sizeof(out) - (o - out);
+
+        while(*part == ' ') {
+            part++;
+        }
+        if(!strcmp(part, "echo @@B\"\"@@")) {
+            snprintf(o, left, "@@B@@\n");
+        }
+        else if(!strcmp(part, "echo @@E\"\"@@$?")) {
+            snprintf(o, left, "@@E@@%d\n", st);
+        }
+        else if(!strcmp(part, "echo @@F\"\"@@")) {
+            snprintf(o, left, "@@F@@\n");
+        }
+        else if(!strncmp(part, "cat ", 4)) {
+            bmc->cats++;
+            st = 0;
+            if(!strncmp(part + 4, "/fan1_pwm ", 10)) {
+                snprintf(o, left, "%s\n", bmc->fan);
+            }
+            else if(!strncmp(part + 4, "/temp1 ", 7)) {
+                snprintf(o, left, "41000\n");
+            }
+            else {
+                snprintf(o, left, "@@X@@\n");
+                st = 1;
+            }
+        }
+        else if(!strncmp(part, "set_fan_speed.sh ", 17)) {
+            aim_strlcpy(bmc->fan, part + 17, sizeof(bmc->fan));
+            st = 0;
+        }
+        else if(!strncmp(part, "i2cget ", 7)) {
+            snprintf(o, left, "0x42\n");
+            st = 0;
+        }
+        else if(!strncmp(part, "echo ", 5)) {
+            snprintf(o, left, "%s\n", part + 5);
+            st = 0;
+        }
+        else if(!strcmp(part, "false")) {
+            st = 1;
+        }
+        else {
+            snprintf(o, left, "sh: %s: not found\n", part);
+            st = 127;
+        }
+    }
+    tty_bmc_puts__(bmc, out);
+}
+
+static void*
+tty_bmc_thread__(void* cookie)
+{
+    tty_bmc_t* bmc = cookie;
+    char line[1024];
+    int len = 0;
+
+    while(!bmc->exit) {
+        struct pollfd pfd = { bmc->fd, POLLIN, 0 };
+        char c;
+
+        if(poll(&pfd, 1, 50) <= 0 || read(bmc->fd, &c, 1) != 1) {
+            continue;
+        }
+        if(c != '\r') {
+            if(len < sizeof(line) - 1) {
+                line[len++] = c;
+            }
+            continue;
+        }
+        line[len] = 0;
+        len = 0;
+
+        if(line[0] == 0) {
+            /* The transport resynchronizes with a bare return. */
+            tty_bmc_puts__(bmc, TTY_PROMPT);
+            continue;
+        }
+        bmc->lines++;
+        if(bmc->drop > 0) {
+            bmc->drop--;
+            continue;
+        }
+        /* The console echoes the command line first. */
+        tty_bmc_puts__(bmc, line);
+        tty_bmc_puts__(bmc, "\n");
+        tty_bmc_run__(bmc, line);
+        tty_bmc_puts__(bmc, TTY_PROMPT);
+    }
+    return NULL;
+}
+
+void
+bmc_tty_test(void)
+{
+    tty_bmc_t bmc;
+    onlp_bmc_tty_config_t config;
+    const char* files[] = { "/fan1_pwm", "/temp1", "/missing" };
+    char values[AIM_ARRAYSIZE(files)][16];
+    char* vp[AIM_ARRAYSIZE(files)];
+    int status[AIM_ARRAYSIZE(files)];
+    char rsp[64];
+    int i, slave, st, shmid;
+
+    memset(&bmc, 0, sizeof(bmc));
+    aim_strlcpy(bmc.fan, "50", sizeof(bmc.fan));
+    CHECK((bmc.fd = posix_openpt(O_RDWR | O_NOCTTY)) >= 0);
+    CHECK(grantpt(bmc.fd) == 0 && unlockpt(bmc.fd) == 0);
+    /* Hold the slave open so the master never sees a hangup. */
+    CHECK((slave = open(ptsname(bmc.fd), O_RDWR | O_NOCTTY)) >= 0);
+    setenv("ONLP_BMC_TTY_DEVICE", ptsname(bmc.fd), 1);
+    CHECK(pthread_create(&bmc.thread, NULL, tty_bmc_thread__, &bmc) == 0);
+
+    memset(&config, 0, sizeof(config));
+    config.device = "/dev/null";
+    config.baudrate = B57600;
+    config.prompt = TTY_PROMPT;
+    config.key = 0x42540000 | (getpid() & 0xFFFF);
+    config.cache_ms = 60000;
+    CHECK(onlp_bmc_tty_init(&config) == 0);
+
+    /* Framing: the echoed command line never matches the markers. */
+    CHECK(onlp_bmc_tty_exec("echo hello", rsp, sizeof(rsp), &st) == 6);
+    CHECK(!strcmp(rsp, "hello\n") && st == 0);
+
+    /* The exit status comes from the end marker. */
+    CHECK(onlp_bmc_tty_exec("false", rsp, sizeof(rsp), &st) == 0);
+    CHECK(st == 1);
+    CHECK(onlp_bmc_tty_exec("nosuchcmd", NULL, 0, &st) >= 0);
+    CHECK(st == 127);
+
+    /* Batched reads, one file section each. */
+    for(i = 0; i < AIM_ARRAYSIZE(files); i++) {
+        vp[i] = values[i];
+    }
+    bmc.cats = 0;
+    CHECK(onlp_bmc_tty_file_read_batch(files, AIM_ARRAYSIZE(files),
+                                       vp, sizeof(values[0]), status) < 0);
+    CHECK(status[0] == ONLP_STATUS_OK && !strcmp(values[0], "50"));
+    CHECK(status[1] == ONLP_STATUS_OK && !strcmp(values[1], "41000"));
+    CHECK(status[2] < 0);
+    CHECK(bmc.cats == 3);
+
+    /* Cached values are served without the console... */
+    CHECK(onlp_bmc_tty_file_read_int(&i, "/temp1", 0) == 0 && i == 41000);
+    CHECK(bmc.cats == 3);
+
+    /* ...and survive read-only commands... */
+    CHECK(onlp_bmc_tty_query("i2cget -f -y 1 0x20", rsp, sizeof(rsp), NULL) == 5);
+    CHECK(!strcmp(rsp, "0x42\n"));
+    CHECK(onlp_bmc_tty_file_read_int(&i, "/fan1_pwm", 0) == 0 && i == 50);
+    CHECK(bmc.cats == 3);
+
+    /* ...but not commands which change BMC state. */
+    CHECK(onlp_bmc_tty_exec("set_fan_speed.sh 70", NULL, 0, &st) == 0 && st == 0);
+    CHECK(onlp_bmc_tty_file_read_int(&i, "/fan1_pwm", 0) == 0 && i == 70);
+    CHECK(bmc.cats == 4);
+
+    /*
+     * A lost command times out. The transport resynchronizes with
+     * the prompt and sends it again.
+     */
+    bmc.lines = 0;
+    bmc.drop = 1;
+    CHECK(onlp_bmc_tty_exec("echo again", rsp, sizeof(rsp), &st) == 6);
+    CHECK(!strcmp(rsp, "again\n") && st == 0);
+    CHECK(bmc.lines == 2);
+
+    onlp_bmc_tty_deinit();
+    bmc.exit = 1;
+    pthread_join(bmc.thread, NULL);
+    close(slave);
+    close(bmc.fd);
+
+    /* Remove the lock and cache segments. */
+    for(i = 0; i < 2; i++) {
+        if((shmid = shmget(config.key + i, 0, 0)) >= 0) {
+            shmctl(shmid, IPC_RMID, NULL);
+        }
+    }
+    printf("bmc_tty: ok\n");
+}
+
 int aim_main(int argc, char* argv[])
 {
-    printf("onlplib Utest Is Empty\n");
     onlplib_config_show(&aim_pvs_stdout);
+    ipmi_test();
+    bmc_tty_test();
     return 0;
 }
 
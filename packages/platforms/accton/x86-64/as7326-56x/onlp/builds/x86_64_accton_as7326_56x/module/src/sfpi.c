@@ -26,6 +26,7 @@
 #include <onlp/platformi/sfpi.h>
 #include <onlplib/i2c.h>
 #include <onlplib/file.h>
+#include <onlplib/sfp.h>
 #include "x86_64_accton_as7326_56x_int.h"
 #include "x86_64_accton_as7326_56x_log.h"
 
@@ -290,6 +291,31 @@ onlp_sfpi_dev_writew(int port, uint8_t devaddr, uint8_t addr, uint16_t value)
     return onlp_i2c_writew(bus, devaddr, addr, value, ONLP_I2C_F_FORCE);
 }
 
+int
+onlp_sfpi_memory_read(int port, uint8_t devaddr, int page, int offset,
+                      int size, uint8_t* rdata)
+{
+    char file[64] = {0};
+
+    if(port < 0 || port >= 58)
+        return ONLP_STATUS_E_INTERNAL;
+
+    /* optoe selects the page; only the requested bytes are read. */
+    sprintf(file, PORT_EEPROM_FORMAT, PORT_BUS_INDEX(port));
+    return onlplib_sfp_memory_read_optoe(file, (port < 48 || port >= 56), devaddr, page,
+                                         offset, size, rdata);
+}
+
+int
+onlp_sfpi_port_bus_get(int port, int* bus)
+{
+    if(port < 0 || port >= 58)
+        return ONLP_STATUS_E_INTERNAL;
+
+    *bus = PORT_BUS_INDEX(port);
+    return ONLP_STATUS_OK;
+}
+
 int
 onlp_sfpi_control_set(int port, onlp_sfp_control_t control, int value)
 {
@@ -38,8 +38,6 @@ int init_ipmi_data(struct ipmi_data *ipmi, int iface, struct device *dev)
 	if (!ipmi || !dev)
 		return -EINVAL;
 
-	init_completion(&ipmi->read_complete);
-
 	// Initialize IPMI address
 	ipmi->address.addr_type = IPMI_SYSTEM_INTERFACE_ADDR_TYPE;
 	ipmi->address.channel = IPMI_BMC_CHANNEL;
@@ -47,9 +45,13 @@ int init_ipmi_data(struct ipmi_data *ipmi, int iface, struct device *dev)
 	ipmi->interface = iface;
 	ipmi->dev = dev;	// Storing the device for future reference
 
-	// Initialize message buffers
+	// Initialize the request list and the response cache
 	ipmi->tx_msgid = 0;
-	ipmi->tx_message.netfn = ACCTON_IPMI_NETFN;
+	spin_lock_init(&ipmi->lock);
+	INIT_LIST_HEAD(&ipmi->pending);
+	mutex_init(&ipmi->cache_lock);
+	memset(ipmi->cache_class, 0, sizeof(ipmi->cache_class));
+	memset(ipmi->cache, 0, sizeof(ipmi->cache));
 
 	// Assign the message handler
 	ipmi->ipmi_hndlrs.ipmi_recv_hndl = ipmi_msg_handler;
@@ -71,14 +73,27 @@ EXPORT_SYMBOL(init_ipmi_data);
 /* Handler function for receiving IPMI messages */
 static void ipmi_msg_handler(struct ipmi_recv_msg *msg, void *user_msg_data)
 {
+	unsigned long flags;
 	unsigned short rx_len;
 	struct ipmi_data *ipmi = user_msg_data;
+	struct ipmi_request *req = NULL, *pos;
+
+	spin_lock_irqsave(&ipmi->lock, flags);
+
+	// Find the pending request with the same message ID
+	list_for_each_entry(pos, &ipmi->pending, list) {
+		if (pos->msgid == msg->msgid) {
+			req = pos;
+			list_del_init(&req->list);
+			break;
+		}
+	}
 
-	// Check for message ID mismatch
-	if (msg->msgid != ipmi->tx_msgid) {
-		dev_err(ipmi->dev, "Mismatch between received msgid "
-			"(%02x) and transmitted msgid (%02x)!\n",
-			(int)msg->msgid, (int)ipmi->tx_msgid);
+	if (!req) {
+		// The request has timed out or was never sent
+		spin_unlock_irqrestore(&ipmi->lock, flags);
+		dev_err(ipmi->dev, "No pending request for received msgid "
+			"(%02x)!\n", (int)msg->msgid);
 		ipmi_free_recv_msg(msg);
 		return;
 	}
@@ -88,25 +103,29 @@ static void ipmi_msg_handler(struct ipmi_recv_msg *msg, void *user_msg_data)
 
 	// Parse message data
 	if (msg->msg.data_len > 0)
-		ipmi->rx_result = msg->msg.data[0];
+		req->rx_result = msg->msg.data[0];
 	else
-		ipmi->rx_result = IPMI_UNKNOWN_ERR_COMPLETION_CODE;
+		req->rx_result = IPMI_UNKNOWN_ERR_COMPLETION_CODE;
 
 	// Copy remaining message data if available
 	if (msg->msg.data_len > 1) {
 		rx_len = msg->msg.data_len - 1;
-		if (ipmi->rx_msg_len < rx_len)
-			rx_len = ipmi->rx_msg_len;
+		if (req->rx_len < rx_len)
+			rx_len = req->rx_len;
 
-		ipmi->rx_msg_len = rx_len;
-		memcpy(ipmi->rx_msg_data, msg->msg.data + 1, ipmi->rx_msg_len);
+		req->rx_len = rx_len;
+		memcpy(req->rx_data, msg->msg.data + 1, req->rx_len);
 	} else {
-		ipmi->rx_msg_len = 0;
+		req->rx_len = 0;
 	}
 
+	// The data is copied before the lock is released, so a waiter that
+	// timed out concurrently only has to wait for the completion below.
+	spin_unlock_irqrestore(&ipmi->lock, flags);
+
 	// Free the received message and signal completion
 	ipmi_free_recv_msg(msg);
-	complete(&ipmi->read_complete);
+	complete(&req->complete);
 }
 
 static void _ipmi_log_error(struct ipmi_data *ipmi, unsigned char cmd,
@@ -135,24 +154,289 @@ static void _ipmi_log_error(struct ipmi_data *ipmi, unsigned char cmd,
 	}
 }
 
-/* Send an IPMI command */
-static int _ipmi_send_message(struct ipmi_data *ipmi, unsigned char cmd,
-			      unsigned char *tx_data, unsigned short tx_len,
-			      unsigned char *rx_data, unsigned short rx_len)
+/* Find the cache lifetime of a command, 0 if it is not cached */
+static unsigned long _ipmi_cache_ttl(struct ipmi_data *ipmi, unsigned char cmd)
 {
-	int err;
+	int i;
 
-	// Validate the input parameters
-	if ((tx_len && !tx_data) || (rx_len && !rx_data)) {
-		return -EINVAL;
+	for (i = 0; i < IPMI_CACHE_CLASSES; i++) {
+		if (ipmi->cache_class[i].ttl && ipmi->cache_class[i].cmd == cmd)
+			return ipmi->cache_class[i].ttl;
+	}
+
+	return 0;
+}
+
+/* Find the cache entry of a request, NULL if there is none */
+static struct ipmi_cache_entry *
+_ipmi_cache_find(struct ipmi_data *ipmi, struct ipmi_request *req)
+{
+	int i;
+	struct ipmi_cache_entry *entry;
+
+	for (i = 0; i < IPMI_CACHE_ENTRIES; i++) {
+		entry = &ipmi->cache[i];
+
+		if (entry->valid && entry->cmd == req->cmd &&
+		    entry->tx_len == req->tx_len &&
+		    !memcmp(entry->tx_data, req->tx_data, req->tx_len))
+			return entry;
+	}
+
+	return NULL;
+}
+
+/* Complete a request from the cache. Returns true if it was cached. */
+static bool _ipmi_cache_lookup(struct ipmi_data *ipmi, struct ipmi_request *req)
+{
+	bool hit = false;
+	unsigned long ttl;
+	struct ipmi_cache_entry *entry;
+
+	if (req->tx_len > IPMI_CACHE_TX_MAX)
+		return false;
+
+	mutex_lock(&ipmi->cache_lock);
+
+	ttl = _ipmi_cache_ttl(ipmi, req->cmd);
+	if (!ttl)
+		goto exit;
+
+	entry = _ipmi_cache_find(ipmi, req);
+	if (!entry || time_after(jiffies, entry->last_updated + ttl))
+		goto exit;
+
+	if (req->rx_len > entry->rx_len)
+		req->rx_len = entry->rx_len;
+
+	memcpy(req->rx_data, entry->rx_data, req->rx_len);
+	req->rx_result = 0;
+	req->status = 0;
+	hit = true;
+
+exit:
+	mutex_unlock(&ipmi->cache_lock);
+	return hit;
+}
+
+/* Store the response of a successful request in the cache */
+static void _ipmi_cache_store(struct ipmi_data *ipmi, struct ipmi_request *req)
+{
+	int i;
+	struct ipmi_cache_entry *entry;
+
+	if (req->tx_len > IPMI_CACHE_TX_MAX)
+		return;
+
+	mutex_lock(&ipmi->cache_lock);
+
+	if (!_ipmi_cache_ttl(ipmi, req->cmd))
+		goto exit;
+
+	// Reuse the entry of the same request, a free entry or the oldest one
+	entry = _ipmi_cache_find(ipmi, req);
+	for (i = 0; !entry && i < IPMI_CACHE_ENTRIES; i++) {
+		if (!ipmi->cache[i].valid)
+			entry = &ipmi->cache[i];
+	}
+
+	if (!entry) {
+		entry = &ipmi->cache[0];
+		for (i = 1; i < IPMI_CACHE_ENTRIES; i++) {
+			if (time_before(ipmi->cache[i].last_updated,
+					entry->last_updated))
+				entry = &ipmi->cache[i];
+		}
+	}
+
+	entry->cmd = req->cmd;
+	entry->tx_len = req->tx_len;
+	memcpy(entry->tx_data, req->tx_data, req->tx_len);
+	entry->rx_len = req->rx_len;
+	memcpy(entry->rx_data, req->rx_data, req->rx_len);
+	entry->last_updated = jiffies;
+	entry->valid = 1;
+
+exit:
+	mutex_unlock(&ipmi->cache_lock);
+}
+
+/* Cache the responses of a command for a period of time */
+int ipmi_cache_set(struct ipmi_data *ipmi, unsigned char cmd, unsigned long ttl)
+{
+	int i, err = -ENOSPC;
+	struct ipmi_cache_class *class = NULL;
+
+	mutex_lock(&ipmi->cache_lock);
+
+	for (i = 0; i < IPMI_CACHE_CLASSES; i++) {
+		if (ipmi->cache_class[i].ttl && ipmi->cache_class[i].cmd == cmd) {
+			class = &ipmi->cache_class[i];
+			break;
+		}
+
+		if (!class && !ipmi->cache_class[i].ttl)
+			class = &ipmi->cache_class[i];
+	}
+
+	if (class) {
+		class->cmd = cmd;
+		class->ttl = ttl;
+		err = 0;
+	}
+
+	mutex_unlock(&ipmi->cache_lock);
+
+	if (!ttl)
+		ipmi_cache_invalidate(ipmi, cmd);
+
+	return err;
+}
+EXPORT_SYMBOL(ipmi_cache_set);
+
+/* Discard the cached responses of a command */
+void ipmi_cache_invalidate(struct ipmi_data *ipmi, unsigned char cmd)
+{
+	int i;
+
+	mutex_lock(&ipmi->cache_lock);
+
+	for (i = 0; i < IPMI_CACHE_ENTRIES; i++) {
+		if (ipmi->cache[i].cmd == cmd)
+			ipmi->cache[i].valid = 0;
+	}
+
+	mutex_unlock(&ipmi->cache_lock);
+}
+EXPORT_SYMBOL(ipmi_cache_invalidate);
+
+/* Discard the cached response of one request */
+void ipmi_cache_invalidate_request(struct ipmi_data *ipmi, unsigned char cmd,
+				   unsigned char *tx_data, unsigned short tx_len)
+{
+	int i;
+	struct ipmi_cache_entry *entry;
+
+	mutex_lock(&ipmi->cache_lock);
+
+	for (i = 0; i < IPMI_CACHE_ENTRIES; i++) {
+		entry = &ipmi->cache[i];
+
+		if (entry->cmd == cmd && entry->tx_len == tx_len &&
+		    !memcmp(entry->tx_data, tx_data, tx_len))
+			entry->valid = 0;
 	}
 
+	mutex_unlock(&ipmi->cache_lock);
+}
+EXPORT_SYMBOL(ipmi_cache_invalidate_request);
+
+/* Queue an IPMI request and send it to the BMC */
+static int _ipmi_submit(struct ipmi_data *ipmi, struct ipmi_request *req)
+{
+	int err;
+	unsigned long flags;
+
 	// Initialize IPMI message
-	ipmi->tx_message.cmd = cmd;
-	ipmi->tx_message.data = tx_len ? tx_data : NULL;
-	ipmi->tx_message.data_len = tx_len;
-	ipmi->rx_msg_data = rx_len ? rx_data : NULL;
-	ipmi->rx_msg_len = rx_len;
+	init_completion(&req->complete);
+	INIT_LIST_HEAD(&req->list);
+	req->tx_message.netfn = ACCTON_IPMI_NETFN;
+	req->tx_message.cmd = req->cmd;
+	req->tx_message.data = req->tx_len ? req->tx_data : NULL;
+	req->tx_message.data_len = req->tx_len;
+	req->rx_len = req->rx_size;
+	req->rx_result = IPMI_UNKNOWN_ERR_COMPLETION_CODE;
+	req->status = -EINPROGRESS;
+
+	// Assign a message ID and add the request to the pending list
+	// before sending, as the response may arrive at any time
+	spin_lock_irqsave(&ipmi->lock, flags);
+	req->msgid = ++ipmi->tx_msgid;
+	list_add_tail(&req->list, &ipmi->pending);
+	spin_unlock_irqrestore(&ipmi->lock, flags);
+
+	err = ipmi_request_settime(ipmi->user, &ipmi->address, req->msgid,
+				   &req->tx_message, ipmi, 0, 0, 0);
+	if (err) {
+		spin_lock_irqsave(&ipmi->lock, flags);
+		list_del_init(&req->list);
+		spin_unlock_irqrestore(&ipmi->lock, flags);
+
+		dev_err(ipmi->dev, "IPMI request_settime failed: %x\n", err);
+		req->status = err;
+		return err;
+	}
+
+	req->queued = 1;
+	return 0;
+}
+
+/* Wait for the response of a submitted request */
+static void _ipmi_wait(struct ipmi_data *ipmi, struct ipmi_request *req)
+{
+	unsigned long flags;
+	bool pending;
+
+	if (!req->queued)
+		return;
+
+	req->queued = 0;
+	req->status = 0;
+
+	if (wait_for_completion_timeout(&req->complete, IPMI_TIMEOUT))
+		return;
+
+	// Stop matching responses to the request
+	spin_lock_irqsave(&ipmi->lock, flags);
+	pending = !list_empty(&req->list);
+	list_del_init(&req->list);
+	spin_unlock_irqrestore(&ipmi->lock, flags);
+
+	if (pending) {
+		dev_err(ipmi->dev, "IPMI command timeout\n");
+		req->status = -ETIMEDOUT;
+	} else {
+		// The response raced with the timeout and is being completed
+		wait_for_completion(&req->complete);
+	}
+}
+
+/*
+ * Send the requests whose status is -EAGAIN, keeping up to
+ * IPMI_MAX_OUTSTANDING in flight, and wait for their responses.
+ */
+static void _ipmi_send_messages(struct ipmi_data *ipmi,
+				struct ipmi_request *reqs, int count)
+{
+	int i, next = 0;
+
+	for (i = 0; i < count; i++) {
+		// Keep the window full, then wait for the oldest request
+		for (; next < count && next - i < IPMI_MAX_OUTSTANDING; next++) {
+			if (reqs[next].status == -EAGAIN)
+				_ipmi_submit(ipmi, &reqs[next]);
+		}
+
+		_ipmi_wait(ipmi, &reqs[i]);
+	}
+}
+
+/* Send several IPMI commands and receive their responses */
+int ipmi_send_messages(struct ipmi_data *ipmi, struct ipmi_request *reqs,
+		       int count)
+{
+	int i, err, retry, status = 0;
+	struct ipmi_request *req;
+
+	if (!ipmi || count < 0 || (count && !reqs))
+		return -EINVAL;
+
+	// Validate the input parameters
+	for (i = 0; i < count; i++) {
+		if ((reqs[i].tx_len && !reqs[i].tx_data) ||
+		    (reqs[i].rx_len && !reqs[i].rx_data))
+			return -EINVAL;
+	}
 
 	// Validate the IPMI address
 	err = ipmi_validate_addr(&ipmi->address, sizeof(ipmi->address));
@@ -161,54 +445,69 @@ static int _ipmi_send_message(struct ipmi_data *ipmi, unsigned char cmd,
 		return err;
 	}
 
-	// Increment message ID and send the request
-	ipmi->tx_msgid++;
-	err = ipmi_request_settime(ipmi->user, &ipmi->address, ipmi->tx_msgid,
-				   &ipmi->tx_message, ipmi, 0, 0, 0);
-	if (err) {
-		dev_err(ipmi->dev, "IPMI request_settime failed: %x\n", err);
-		return err;
+	// Complete cached requests and mark the rest to be sent
+	for (i = 0; i < count; i++) {
+		reqs[i].rx_size = reqs[i].rx_len;
+		reqs[i].queued = 0;
+
+		if (!_ipmi_cache_lookup(ipmi, &reqs[i]))
+			reqs[i].status = -EAGAIN;
 	}
 
-	// Wait for the message to complete
-	err = wait_for_completion_timeout(&ipmi->read_complete, IPMI_TIMEOUT);
-	if (!err) {
-		dev_err(ipmi->dev, "IPMI command timeout\n");
-		return -ETIMEDOUT;
+	_ipmi_send_messages(ipmi, reqs, count);
+
+	for (i = 0; i < count; i++) {
+		req = &reqs[i];
+
+		// Retry failed requests one at a time
+		for (retry = 0; retry <= IPMI_ERR_RETRY_TIMES; retry++) {
+			if (likely(req->status == 0 && req->rx_result == 0))
+				break;
+
+			_ipmi_log_error(ipmi, req->cmd, req->tx_data,
+					req->tx_len, req->status, retry);
+			if (retry == IPMI_ERR_RETRY_TIMES)
+				break;
+
+			req->status = -EAGAIN;
+			_ipmi_send_messages(ipmi, req, 1);
+		}
+
+		if (req->status == 0 && req->rx_result == 0)
+			_ipmi_cache_store(ipmi, req);
+
+		if (!status && req->status)
+			status = req->status;
+		else if (!status && req->rx_result)
+			status = -EIO;
 	}
 
-	return 0;
+	return status;
 }
+EXPORT_SYMBOL(ipmi_send_messages);
 
 /* Send an IPMI command to the IPMI device and receive the response */
 int ipmi_send_message(struct ipmi_data *ipmi, unsigned char cmd,
 		      unsigned char *tx_data, unsigned short tx_len,
 		      unsigned char *rx_data, unsigned short rx_len)
 {
-	int status = 0, retry = 0;
+	struct ipmi_request req = {
+		.cmd = cmd,
+		.tx_data = tx_data,
+		.tx_len = tx_len,
+		.rx_data = rx_data,
+		.rx_len = rx_len,
+	};
 
 	// Validate the input parameters
 	if ((tx_len && !tx_data) || (rx_len && !rx_data)) {
 		return -EINVAL;
 	}
 
-	for (retry = 0; retry <= IPMI_ERR_RETRY_TIMES; retry++) {
-		status = _ipmi_send_message(ipmi, cmd, tx_data, tx_len, rx_data, rx_len);
-		if (unlikely(status != 0)) {
-			_ipmi_log_error(ipmi, cmd, tx_data, tx_len, status, retry);
-			continue;
-		}
-
-		if (unlikely(ipmi->rx_result != 0)) {
-			_ipmi_log_error(ipmi, cmd, tx_data, tx_len, status, retry);
-			continue;
-		}
-
-		// Success, exit the retry loop
-		break;
-	}
+	ipmi_send_messages(ipmi, &req, 1);
+	ipmi->rx_result = req.rx_result;
 
-	return status;
+	return req.status;
 }
 
 EXPORT_SYMBOL(ipmi_send_message);
@@ -25,12 +25,16 @@
  ***********************************************************/
 #include <onlp/onlp.h>
 #include <onlplib/file.h>
+#include <onlplib/ipmi.h>
 #include "platform_lib.h"
 
 #define WARM_RESET_FORMAT "/sys/devices/platform/as7535_28xb_sys/reset_%s"
 
 #define PSU_MODEL_NAME_LEN 10
 
+#define BMC_NETFN_OEM      0x34
+#define BMC_CMD_CPLD_READ  0x22
+
 enum onlp_fan_dir onlp_get_fan_dir(int fid)
 {
     int len = 0;
@@ -65,22 +69,19 @@ enum onlp_fan_dir onlp_get_fan_dir(int fid)
 
 int get_pcb_id()
 {
-    FILE *pf;
-    char command[32];
-    char data[8];
+    const uint8_t req[] = { 0x60, 0 };
+    uint8_t data[1];
+    int len = 0;
     int pcb_id = 0;
 
-    sprintf(command, "ipmitool raw 0x34 0x22 0x60 0");
-    pf = popen(command,"r");
-    fgets(data, 8 , pf);
-
-    if (pclose(pf) != 0)
+    if (onlp_ipmi_raw(BMC_NETFN_OEM, BMC_CMD_CPLD_READ, req, sizeof(req),
+                      data, sizeof(data), &len) < 0 || len < 1)
     {
-        fprintf(stderr," Error: Failed to close command stream \n");
+        AIM_LOG_ERROR("Unable to read the PCB id from the BMC");
         return ONLP_STATUS_E_INTERNAL;
     }
     /* get the pcb id to check the thermal number */
-    pcb_id = (atoi(data) >> 2) & 0xff;
+    pcb_id = (data[0] >> 2) & 0xff;
 
     return pcb_id;
 }
@@ -34,6 +34,8 @@
 #include <linux/hwmon-sysfs.h>
 #include <linux/delay.h>
 
+#include "x86-64-accton-as7726-32x-module-status.h"
+
 #define I2C_RW_RETRY_COUNT				10
 #define I2C_RW_RETRY_INTERVAL			60 /* ms */
 
@@ -56,6 +58,7 @@ struct as7726_32x_cpld_data {
     enum cpld_type   type;
     struct device   *hwmon_dev;
     struct mutex     update_lock;
+    struct bin_attribute status_all;	/* module_status_all (CPLD1 only) */
 };
 
 static const struct i2c_device_id as7726_32x_cpld_id[] = {
@@ -501,6 +504,82 @@ exit:
 	return status;
 }
 
+static ssize_t show_status_all(struct file *filp, struct kobject *kobj,
+		struct bin_attribute *attr,
+		char *buf, loff_t off, size_t count)
+{
+	struct i2c_client *client = to_i2c_client(container_of(kobj,
+				struct device, kobj));
+	struct as7726_32x_cpld_data *data = i2c_get_clientdata(client);
+	u8 regs[] = {0x30, 0x31, 0x32, 0x33, 0x50, 0x49};
+	u8 values[ARRAY_SIZE(regs)];
+	u8 vector[MODULE_STATUS_ALL_SIZE] = {0};
+	int i, status;
+
+	if (off >= MODULE_STATUS_ALL_SIZE) {
+		return 0;
+	}
+
+	if (count > MODULE_STATUS_ALL_SIZE - off) {
+		count = MODULE_STATUS_ALL_SIZE - off;
+	}
+
+	mutex_lock(&data->update_lock);
+
+	for (i = 0; i < ARRAY_SIZE(regs); i++) {
+		status = as7726_32x_cpld_read_internal(client, regs[i]);
+
+		if (status < 0) {
+			goto exit;
+		}
+
+		values[i] = (u8)status;
+	}
+
+	mutex_unlock(&data->update_lock);
+
+#define MODULE_STATUS_BYTE(bitmap, field, index) \
+	vector[MODULE_STATUS_##bitmap##_OFFSET(field) + (index)]
+
+	/* Ports 1 -> 32, present is active low */
+	for (i = 0; i < 4; i++) {
+		MODULE_STATUS_BYTE(VALUE, MODULE_STATUS_PRESENT, i) = ~values[i];
+		MODULE_STATUS_BYTE(VALID, MODULE_STATUS_PRESENT, i) = 0xFF;
+	}
+
+	/* Ports 33 -> 34, present (bit 0-1, active low) and rx_los (bit 2-3)
+	 * in 0x50, tx_disable (bit 0-1) in 0x49
+	 */
+	MODULE_STATUS_BYTE(VALUE, MODULE_STATUS_PRESENT, 4) = ~values[4] & 0x3;
+	MODULE_STATUS_BYTE(VALUE, MODULE_STATUS_RXLOS, 4) = (values[4] >> 2) & 0x3;
+	MODULE_STATUS_BYTE(VALUE, MODULE_STATUS_TXDISABLE, 4) = values[5] & 0x3;
+	MODULE_STATUS_BYTE(VALID, MODULE_STATUS_PRESENT, 4) = 0x3;
+	MODULE_STATUS_BYTE(VALID, MODULE_STATUS_RXLOS, 4) = 0x3;
+	MODULE_STATUS_BYTE(VALID, MODULE_STATUS_TXDISABLE, 4) = 0x3;
+
+#undef MODULE_STATUS_BYTE
+
+	memcpy(buf, vector + off, count);
+	return count;
+
+exit:
+	mutex_unlock(&data->update_lock);
+	return status;
+}
+
+static int as7726_32x_cpld_status_all_init(struct i2c_client *client)
+{
+	struct as7726_32x_cpld_data *data = i2c_get_clientdata(client);
+
+	sysfs_bin_attr_init(&data->status_all);
+	data->status_all.attr.name = MODULE_STATUS_ALL_NAME;
+	data->status_all.attr.mode = S_IRUGO;
+	data->status_all.read      = show_status_all;
+	data->status_all.size      = MODULE_STATUS_ALL_SIZE;
+
+	return sysfs_create_bin_file(&client->dev.kobj, &data->status_all);
+}
+
 static void as7726_32x_cpld_add_client(struct i2c_client *client)
 {
     struct cpld_client_node *node = kzalloc(sizeof(struct cpld_client_node), GFP_KERNEL);
@@ -616,9 +695,18 @@ static int as7726_32x_cpld_probe(struct i2c_client *client,
         }
     }
 
+    if (data->type == as7726_32x_cpld1) {
+        ret = as7726_32x_cpld_status_all_init(client);
+        if (ret) {
+            goto exit_remove;
+        }
+    }
+
     as7726_32x_cpld_add_client(client);
     return 0;
 
+exit_remove:
+    sysfs_remove_group(&client->dev.kobj, group);
 exit_free:
     kfree(data);
 exit:
@@ -654,6 +742,10 @@ static void as7726_32x_cpld_remove(struct i2c_client *client)
         sysfs_remove_group(&client->dev.kobj, group);
     }
 
+    if (data->type == as7726_32x_cpld1) {
+        sysfs_remove_bin_file(&client->dev.kobj, &data->status_all);
+    }
+
     kfree(data);
 }
 
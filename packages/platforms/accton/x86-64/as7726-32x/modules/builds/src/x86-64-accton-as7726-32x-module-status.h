@@ -0,0 +1,43 @@
+/*
+ * Layout of the as7726_32x CPLD1 module_status_all attribute.
+ *
+ * Shared by the CPLD driver and the ONLP platform library.
+ *
+ * This file is licensed under the terms of the GNU General Public
+ * License version 2. This program is licensed "as is" without any
+ * warranty of any kind, whether express or implied.
+ */
+#ifndef __X86_64_ACCTON_AS7726_32X_MODULE_STATUS_H__
+#define __X86_64_ACCTON_AS7726_32X_MODULE_STATUS_H__
+
+/* module_status_all is a binary port status vector. It holds one port
+ * bitmap per field (MODULE_STATUS_PORT_BYTES bytes, bit 0 of the first byte
+ * is port 1, a set bit means asserted/present), followed by one bitmap per
+ * field flagging the ports the field is reported for.
+ *
+ * The CPLDs wire presence for every port, and rx_los and tx_disable for the
+ * two SFP ports only. The board has no CPLD signals for tx_fault, lpmode or
+ * reset, so those fields are never flagged as reported.
+ */
+#define MODULE_STATUS_PORT_COUNT		34
+#define MODULE_STATUS_PORT_BYTES		((MODULE_STATUS_PORT_COUNT + 7) / 8)
+
+enum module_status_field {
+	MODULE_STATUS_PRESENT,
+	MODULE_STATUS_RXLOS,
+	MODULE_STATUS_TXFAULT,
+	MODULE_STATUS_TXDISABLE,
+	MODULE_STATUS_LPMODE,
+	MODULE_STATUS_RESET,
+	MODULE_STATUS_FIELD_COUNT
+};
+
+#define MODULE_STATUS_ALL_NAME			"module_status_all"
+#define MODULE_STATUS_ALL_SIZE			(2 * MODULE_STATUS_FIELD_COUNT * MODULE_STATUS_PORT_BYTES)
+
+/* Offset of a field's port bitmap, and of its reported-ports bitmap */
+#define MODULE_STATUS_VALUE_OFFSET(field)	((field) * MODULE_STATUS_PORT_BYTES)
+#define MODULE_STATUS_VALID_OFFSET(field)	\
+	((MODULE_STATUS_FIELD_COUNT + (field)) * MODULE_STATUS_PORT_BYTES)
+
+#endif /* __X86_64_ACCTON_AS7726_32X_MODULE_STATUS_H__ */
@@ -26,8 +26,10 @@
 #include <onlp/platformi/sfpi.h>
 #include <onlplib/i2c.h>
 #include <onlplib/file.h>
+#include <onlplib/sfp.h>
 #include "x86_64_accton_as7726_32x_int.h"
 #include "x86_64_accton_as7726_32x_log.h"
+#include "x86-64-accton-as7726-32x-module-status.h"
 
 #define PORT_BUS_INDEX(port) (port+18)
 
@@ -39,6 +41,7 @@
 #define MODULE_PRESENT_ALL_ATTR	        "/sys/bus/i2c/devices/%d-00%d/module_present_all"
 #define MODULE_RXLOS_ALL_ATTR_CPLD	    "/sys/bus/i2c/devices/11-0060/module_rx_los_all"
 #define MODULE_RXLOS_ALL_ATTR_CPLD3	    "/sys/bus/i2c/devices/6-0064/module_rx_los_all"
+#define MODULE_STATUS_ALL_ATTR          "/sys/bus/i2c/devices/11-0060/module_status_all"
 /* QSFP device address of eeprom */
 #define PORT_EEPROM_DEVADDR             0x50
 /* QSFP tx disable offset */
@@ -193,6 +196,51 @@ onlp_sfpi_rx_los_bitmap_get(onlp_sfp_bitmap_t* dst)
     return ONLP_STATUS_OK;
 }
 
+int
+onlp_sfpi_status_bitmaps_get(onlp_sfp_status_bitmaps_t* dst)
+{
+    int fields[MODULE_STATUS_FIELD_COUNT] = {
+        [MODULE_STATUS_PRESENT] = -1,
+        [MODULE_STATUS_RXLOS] = ONLP_SFP_CONTROL_RX_LOS,
+        [MODULE_STATUS_TXFAULT] = ONLP_SFP_CONTROL_TX_FAULT,
+        [MODULE_STATUS_TXDISABLE] = ONLP_SFP_CONTROL_TX_DISABLE,
+        [MODULE_STATUS_LPMODE] = ONLP_SFP_CONTROL_LP_MODE,
+        [MODULE_STATUS_RESET] = ONLP_SFP_CONTROL_RESET_STATE,
+    };
+    uint8_t vector[MODULE_STATUS_ALL_SIZE];
+    uint8_t *value, *valid;
+    int f, p, size = 0;
+
+    if(onlp_file_read(vector, sizeof(vector), &size, MODULE_STATUS_ALL_ATTR) != ONLP_STATUS_OK ||
+       size != sizeof(vector)) {
+        AIM_LOG_ERROR("Unable to read the module_status_all device file of CPLD(0x60)");
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    for(f = 0; f < MODULE_STATUS_FIELD_COUNT; f++) {
+        value = vector + MODULE_STATUS_VALUE_OFFSET(f);
+        valid = vector + MODULE_STATUS_VALID_OFFSET(f);
+
+        for(p = 0; p < MODULE_STATUS_PORT_COUNT; p++) {
+            int v = !!(value[p/8] & (1 << (p%8)));
+
+            if(!(valid[p/8] & (1 << (p%8)))) {
+                continue;
+            }
+
+            if(fields[f] < 0) {
+                AIM_BITMAP_MOD(&dst->present, p, v);
+            }
+            else {
+                AIM_BITMAP_SET(&dst->valid[fields[f]], p);
+                AIM_BITMAP_MOD(&dst->value[fields[f]], p, v);
+            }
+        }
+    }
+
+    return ONLP_STATUS_OK;
+}
+
 int
 onlp_sfpi_eeprom_read(int port, uint8_t data[256])
 {
@@ -277,6 +325,31 @@ onlp_sfpi_dev_writew(int port, uint8_t devaddr, uint8_t addr, uint16_t value)
     return onlp_i2c_writew(bus, devaddr, addr, value, ONLP_I2C_F_FORCE);
 }
 
+int
+onlp_sfpi_memory_read(int port, uint8_t devaddr, int page, int offset,
+                      int size, uint8_t* rdata)
+{
+    char file[64] = {0};
+
+    if(port < 0 || port >= 34)
+        return ONLP_STATUS_E_INTERNAL;
+
+    /* optoe selects the page; only the requested bytes are read. */
+    sprintf(file, PORT_EEPROM_FORMAT, onlp_sfpi_map_bus_index(port));
+    return onlplib_sfp_memory_read_optoe(file, (port >= 32), devaddr, page,
+                                         offset, size, rdata);
+}
+
+int
+onlp_sfpi_port_bus_get(int port, int* bus)
+{
+    if(port < 0 || port >= 34)
+        return ONLP_STATUS_E_INTERNAL;
+
+    *bus = onlp_sfpi_map_bus_index(port);
+    return ONLP_STATUS_OK;
+}
+
 int
 onlp_sfpi_control_set(int port, onlp_sfp_control_t control, int value)
 {
@@ -32,13 +32,13 @@
 #include <onlp/platformi/thermali.h>
 #include <onlp/platformi/fani.h>
 #include <onlp/platformi/psui.h>
+#include <onlp/fan_control.h>
 #include "platform_lib.h"
 #include "x86_64_accton_as7726_32x_int.h"
 #include "x86_64_accton_as7726_32x_log.h"
 #include <onlplib/i2c.h>
 
 #define BIOS_VER_PATH "/sys/devices/virtual/dmi/id/bios_version"
-#define NUM_OF_FAN_ON_MAIN_BROAD      6
 #define PREFIX_PATH_ON_CPLD_DEV          "/sys/bus/i2c/devices/"
 #define NUM_OF_CPLD                   5
 #define FAN_DUTY_CYCLE_MAX         (100)
@@ -166,60 +166,122 @@ onlp_sysi_platform_info_free(onlp_platform_info_t* pi)
  */
 
 
-typedef struct fan_ctrl_policy {
-   int duty_cycle;
-   int pwm;
-   int temp_down; /* The boundary temperature to down adjust fan speed */
-   int temp_up;   /* The boundary temperature to up adjust fan speed */
-   int state;
-} fan_ctrl_policy_t;
+#define FAN_SPEED_CTRL_PATH "/sys/bus/i2c/devices/54-0066/fan_duty_cycle_percentage"
 
-enum
-{
-   LEVEL_FAN_DEF=0,
-   LEVEL_FAN_MID,
-   LEVEL_FAN_MAX,
-   LEVEL_TEMP_HIGH,
-   LEVEL_TEMP_CRITICAL
+/* The shipped policy. The built-in policy below is used if it is missing or invalid. */
+#define FAN_POLICY_PATH "/lib/platform-config/current/onl/etc/fan_control/policy.json"
+
+#define FAN_POLICY_FANS                                                 \
+    { ONLP_FAN_ID_CREATE(1), ONLP_FAN_ID_CREATE(2), ONLP_FAN_ID_CREATE(3), \
+      ONLP_FAN_ID_CREATE(4), ONLP_FAN_ID_CREATE(5), ONLP_FAN_ID_CREATE(6) }
+
+#define FAN_POLICY_THERMALS                                             \
+    { ONLP_THERMAL_ID_CREATE(4), ONLP_THERMAL_ID_CREATE(5) }
+
+static const onlp_fan_control_policy_t fan_policy__ = {
+    .name = "as7726-32x",
+    .fans = FAN_POLICY_FANS,
+    /* The fan board has a single PWM. */
+    .duty_fans = { ONLP_FAN_ID_CREATE(1) },
+    .duty_min = FAN_DUTY_CYCLE_DEFAULT,
+    .duty_max = FAN_DUTY_CYCLE_MAX,
+    .fan_fail_duty = FAN_DUTY_CYCLE_MAX,
+    .sensor_fail_duty = 63,
+    .groups = {
+        {
+            .name = "f2b",
+            .airflow = ONLP_FAN_CONTROL_AIRFLOW_F2B,
+            .thermals = FAN_POLICY_THERMALS,
+            .aggregate = ONLP_FAN_CONTROL_AGGREGATE_AVG,
+            .levels = {
+                { 0,     0,     38 },
+                { 38000, 38000, 63 },
+                { 46000, 46000, 100 },
+            },
+            .level_count = 3,
+            .warning_mc = 58000,
+            .critical_mc = 66000,
+            .alarm_hysteresis_mc = 5000,
+        },
+        {
+            .name = "b2f",
+            .airflow = ONLP_FAN_CONTROL_AIRFLOW_B2F,
+            .thermals = FAN_POLICY_THERMALS,
+            .aggregate = ONLP_FAN_CONTROL_AGGREGATE_AVG,
+            .levels = {
+                { 0,     0,     38 },
+                { 34000, 34000, 63 },
+                { 44000, 44000, 100 },
+            },
+            .level_count = 3,
+            .warning_mc = 59000,
+            .critical_mc = 67000,
+            .alarm_hysteresis_mc = 5000,
+        },
+    },
+    .group_count = 2,
 };
 
-fan_ctrl_policy_t  fan_thermal_policy_f2b[] = {
-{38,  0x4, 0,     38000,   LEVEL_FAN_DEF},
-{63,  0x8, 38000, 46000,   LEVEL_FAN_MID},
-{100, 0xE, 46000, 58000,   LEVEL_FAN_MAX},
-{100, 0xE, 58000, 66000,   LEVEL_TEMP_HIGH},
-{100, 0xE, 66000, 200000,  LEVEL_TEMP_CRITICAL}
-};
+static onlp_fan_control_t fan_control__;
+static onlp_fan_control_policy_t* fan_policy_loaded__ = NULL;
+/* 0 until the first cycle, then 1 if a policy is in use or -1 if none is usable. */
+static int fan_control_state__ = 0;
 
-fan_ctrl_policy_t  fan_thermal_policy_b2f[] = {
-{38,  0x4, 0,     34000,   LEVEL_FAN_DEF},
-{63,  0x8, 34000, 44000,   LEVEL_FAN_MID},
-{100, 0xE, 44000, 59000,   LEVEL_FAN_MAX},
-{100, 0xE, 59000, 67000,   LEVEL_TEMP_HIGH},
-{100, 0xE, 67000, 200000,  LEVEL_TEMP_CRITICAL}
-};
+static int
+fan_duty_get__(onlp_fan_control_t* fc, int* duty)
+{
+    return onlp_file_read_int(duty, FAN_SPEED_CTRL_PATH);
+}
 
-#define FAN_SPEED_CTRL_PATH "/sys/bus/i2c/devices/54-0066/fan_duty_cycle_percentage"
-#define FAN_DIRECTION_PATH "/sys/bus/i2c/devices/54-0066/fan1_direction"
+static void
+fan_critical__(onlp_fan_control_t* fc, onlp_fan_control_decision_t* d)
+{
+    AIM_LOG_ERROR("Temperature critical, rebooting.");
+    system("sync;sync;sync");
+    system("reboot");
+}
 
-static int fan_state=LEVEL_FAN_DEF;
-static int alarm_state = 0; /* 0->default or clear, 1-->alarm detect */
-static int fan_fail = 0;
+static int
+fan_control_init__(void)
+{
+    int rv = ONLP_STATUS_E_MISSING;
+
+    if(access(FAN_POLICY_PATH, R_OK) == 0) {
+        rv = onlp_fan_control_policy_load(FAN_POLICY_PATH, &fan_policy_loaded__);
+        if(ONLP_SUCCESS(rv)) {
+            rv = onlp_fan_control_init(&fan_control__, fan_policy_loaded__);
+            if(ONLP_FAILURE(rv)) {
+                aim_free(fan_policy_loaded__);
+                fan_policy_loaded__ = NULL;
+            }
+        }
+        if(ONLP_FAILURE(rv)) {
+            AIM_LOG_ERROR("Fan control policy %s is not usable (%{onlp_status}), using the built-in policy.",
+                          FAN_POLICY_PATH, rv);
+        }
+    }
 
-int onlp_sysi_platform_manage_fans(void)
+    if(ONLP_FAILURE(rv)) {
+        rv = onlp_fan_control_init(&fan_control__, &fan_policy__);
+        if(ONLP_FAILURE(rv)) {
+            AIM_LOG_ERROR("The built-in fan control policy is not usable (%{onlp_status}).", rv);
+            return rv;
+        }
+    }
+
+    fan_control__.duty_get = fan_duty_get__;
+    fan_control__.critical = fan_critical__;
+    return ONLP_STATUS_OK;
+}
+
+static void
+fan_wdt_kick__(void)
 {
-    int i=0, ori_state=LEVEL_FAN_DEF, current_state=LEVEL_FAN_DEF;
-    int  fd, len, value=1;
-    int cur_duty_cycle, new_duty_cycle, temp=0;
-    onlp_thermal_info_t thermal_4, thermal_5;
-    char  buf[10] = {0};
-    fan_ctrl_policy_t *fan_thermal_policy;
     int wdt_status = 0;
-    int wdt_timer = 0;
+    /* set wdt timer 240s */
+    int wdt_timer = 0xf0;
     char wdt_status_path[64] = {0};
     char wdt_timer_path[64] = {0};
-    /* set wdt timer 240s */
-    wdt_timer = 0xf0;
     static int failed_cnt = 0;
     static int failed_first_log = 0;
 
@@ -269,179 +331,23 @@ int onlp_sysi_platform_manage_fans(void)
         failed_cnt = 0;
         AIM_LOG_ERROR("Unable to read status from file (%s) or (%s)\r\n", wdt_status_path, wdt_timer_path);
     }
-    /* Get fan direction
-     */
-    if (onlp_file_read_int(&value, FAN_DIRECTION_PATH) < 0) {
-        AIM_LOG_ERROR("Unable to read status from file (%s)\r\n", FAN_DIRECTION_PATH);
-    }
+}
 
-    if(value==1)
-        fan_thermal_policy=fan_thermal_policy_f2b;
-    else
-        fan_thermal_policy=fan_thermal_policy_b2f;
+int onlp_sysi_platform_manage_fans(void)
+{
+    fan_wdt_kick__();
 
-    /* Get current temperature
-     */
-    if (onlp_thermali_info_get(ONLP_THERMAL_ID_CREATE(4), &thermal_4) != ONLP_STATUS_OK  )
-    {
-        AIM_LOG_ERROR("Unable to read thermal status, set fans to 75 %% speed");
-        onlp_fani_percentage_set(ONLP_FAN_ID_CREATE(1), fan_thermal_policy[LEVEL_FAN_MID].duty_cycle);
-        return ONLP_STATUS_E_INTERNAL;
-    }
-    if(onlp_thermali_info_get(ONLP_THERMAL_ID_CREATE(5), &thermal_5) != ONLP_STATUS_OK)
-    {
-        AIM_LOG_ERROR("Unable to read thermal status, set fans to 75 %% speed");
-        onlp_fani_percentage_set(ONLP_FAN_ID_CREATE(1), fan_thermal_policy[LEVEL_FAN_MID].duty_cycle);
-        return ONLP_STATUS_E_INTERNAL;
+    if(fan_control_state__ == 0) {
+        fan_control_state__ = ONLP_SUCCESS(fan_control_init__()) ? 1 : -1;
     }
 
-    temp = (thermal_4.mcelsius + thermal_5.mcelsius)/2;
-    /* Get current fan pwm percent
-     */
-    fd = open(FAN_SPEED_CTRL_PATH, O_RDONLY);
-    if (fd == -1){
-        AIM_LOG_ERROR("Unable to open fan speed control node (%s)", FAN_SPEED_CTRL_PATH);
-        return ONLP_STATUS_E_INTERNAL;
-    }
-    len = read(fd, buf, sizeof(buf));
-    close(fd);
-    if (len <= 0) {
-        AIM_LOG_ERROR("Unable to read fan speed from (%s)", FAN_SPEED_CTRL_PATH);
+    if(fan_control_state__ < 0) {
+        /* No usable policy, keep the fans at full speed. */
+        onlp_fani_percentage_set(ONLP_FAN_ID_CREATE(1), FAN_DUTY_CYCLE_MAX);
         return ONLP_STATUS_E_INTERNAL;
     }
-    cur_duty_cycle = atoi(buf);
-    ori_state=fan_state;
-    /* Inpunt temp to get theraml_polyc state and new pwm percent. */
-    for(i=0; i < sizeof(fan_thermal_policy_f2b)/sizeof(fan_ctrl_policy_t); i++)
-    {
-        if (temp > fan_thermal_policy[i].temp_down)
-        {
-            if (temp <= fan_thermal_policy[i].temp_up)
-            {
-                current_state =i;
-            }
-        }
-    }
-    if(current_state > LEVEL_TEMP_CRITICAL || current_state < LEVEL_FAN_DEF)
-    {
-        AIM_LOG_ERROR("onlp_sysi_platform_manage_fans get error  current_state\n");
-        return 0;
-    }
-    /* Decision 3: Decide new fan pwm percent.
-     */
-    if (fan_fail==0 &&cur_duty_cycle!=fan_thermal_policy[current_state].duty_cycle)
-    {
-        new_duty_cycle = fan_thermal_policy[current_state].duty_cycle;
-        onlp_fani_percentage_set(ONLP_FAN_ID_CREATE(1), new_duty_cycle);
-    }
-
-    /* Get each fan status
-     */
-
-    for (i = 1; i <= NUM_OF_FAN_ON_MAIN_BROAD; i++)
-    {
-        onlp_fan_info_t fan_info;
-
-        if (onlp_fani_info_get(ONLP_FAN_ID_CREATE(i), &fan_info) != ONLP_STATUS_OK) {
-            AIM_LOG_ERROR("Unable to get fan(%d) status, try to set the other fans as full speed\r\n", i);
-            onlp_fani_percentage_set(ONLP_FAN_ID_CREATE(1), FAN_DUTY_CYCLE_MAX);
-            fan_fail=1;
-            break;
-        } else {
-	    fan_fail = 0;
-	}
-        /* Decision 1: Set fan as full speed if any fan is failed.
-         */
-        if (fan_info.status & ONLP_FAN_STATUS_FAILED || !(fan_info.status & ONLP_FAN_STATUS_PRESENT)) {
-            AIM_LOG_ERROR("Fan(%d) is not working, set the other fans as full speed\r\n", i);
-            onlp_fani_percentage_set(ONLP_FAN_ID_CREATE(1), FAN_DUTY_CYCLE_MAX);
-            fan_fail=1;
-            break;
-        } else {
-            fan_fail = 0;
-	}
-    }
 
-    if(current_state!=ori_state)
-    {
-         fan_state=current_state;
-
-         switch (ori_state)
-         {
-             case LEVEL_FAN_DEF:
-                 if(current_state==LEVEL_TEMP_HIGH)
-                 {
-                     if(alarm_state==0)
-                     {
-                        AIM_SYSLOG_WARN("Temperature high", "Temperature high","Alarm for temperature high is detected");
-                        alarm_state=1;
-                     }
-                 }
-                 if(current_state==LEVEL_TEMP_CRITICAL)
-                 {
-                     AIM_SYSLOG_CRIT("Temperature critical", "Temperature critical", "Alarm for temperature critical is detected, reboot DUT");
-                     system("sync;sync;sync");
-                     system("reboot");
-                 }
-                 break;
-             case LEVEL_FAN_MID:
-                 if(current_state==LEVEL_TEMP_HIGH)
-                 {
-                     if(alarm_state==0)
-                     {
-                        AIM_SYSLOG_WARN("Temperature high", "Temperature high","Alarm for temperature high is detected");
-                        alarm_state=1;
-                     }
-                 }
-                 if(current_state==LEVEL_TEMP_CRITICAL)
-                 {
-                     AIM_SYSLOG_CRIT("Temperature critical", "Temperature critical", "Alarm for temperature critical is detected, reboot DUT");
-                     system("sync;sync;sync");
-                     system("reboot");
-                 }
-                 break;
-             case LEVEL_FAN_MAX:
-                 if(current_state==LEVEL_TEMP_HIGH)
-                 {
-                     if(alarm_state==0)
-                     {
-                        AIM_SYSLOG_WARN("Temperature high", "Temperature high","Alarm for temperature high is detected");
-                        alarm_state=1;
-                     }
-                 }
-                 if(current_state==LEVEL_TEMP_CRITICAL)
-                 {
-                     AIM_SYSLOG_CRIT("Temperature critical", "Temperature critical ", "Alarm for temperature critical is detected, reboot DUT");
-                     system("sync;sync;sync");
-                     system("reboot");
-                 }
-                 break;
-             case LEVEL_TEMP_HIGH:
-                 if(current_state==LEVEL_TEMP_CRITICAL)
-                 {
-                     AIM_SYSLOG_CRIT("Temperature critical", "Temperature critical ", "Alarm for temperature critical is detected, reboot DUT");
-                     system("sync;sync;sync");
-                     system("reboot");
-                 }
-                 break;
-             case LEVEL_TEMP_CRITICAL:
-                 break;
-             default:
-                AIM_SYSLOG_WARN("onlp_sysi_platform_manage_fans abnormal state", "onlp_sysi_platform_manage_fans  abnormal state", "onlp_sysi_platform_manage_fans at abnormal state\n");
-                 break;
-         }
-
-    }
-    if(alarm_state==1 && current_state < LEVEL_TEMP_HIGH)
-    {
-       if (temp < (fan_thermal_policy[LEVEL_TEMP_HIGH].temp_down - 5000)) /*below 58 C, clear alarm*/
-       {
-           AIM_SYSLOG_INFO("Temperature high is clean", "Temperature high is clear", "Alarm for temperature high is cleared");
-           alarm_state=0;
-       }
-    }
-
-    return 0;
+    return onlp_fan_control_manage(&fan_control__);
 }
 
 int
@@ -23,20 +23,63 @@
 #include <linux/ipmi.h>
 #include <linux/ipmi_smi.h>
 
+#define IPMI_MAX_OUTSTANDING 8          // Maximum number of requests in flight per ipmi_data
+#define IPMI_CACHE_CLASSES 4            // Maximum number of cached command classes
+#define IPMI_CACHE_ENTRIES 16           // Number of cached responses per ipmi_data
+#define IPMI_CACHE_TX_MAX 4             // Maximum request payload length of a cached response
+
+/* A single IPMI request and its response */
+struct ipmi_request {
+    unsigned char cmd;                       // IPMI command byte
+    unsigned char *tx_data;                  // Pointer to the command payload
+    unsigned short tx_len;                   // Length of the command payload
+    void *rx_data;                           // Pointer to buffer for storing the response data
+    unsigned short rx_len;                   // Size of rx_data; set to the received length on completion
+    unsigned char rx_result;                 // Completion code of the response
+    int status;                              // 0 on success, or an error code
+
+    /* Private to accton_ipmi_intf */
+    struct list_head list;                   // Entry in the pending request list
+    struct completion complete;              // Signaled when the response is received
+    struct kernel_ipmi_msg tx_message;       // Message structure for sending the command
+    long msgid;                              // Message ID matching the response to this request
+    unsigned short rx_size;                  // Size of rx_data, kept for retries
+    char queued;                             // != 0 while a response may still be delivered
+};
+
+/* A cached response */
+struct ipmi_cache_entry {
+    unsigned char cmd;
+    unsigned char tx_data[IPMI_CACHE_TX_MAX];
+    unsigned short tx_len;
+    unsigned char rx_data[IPMI_MAX_MSG_LENGTH];
+    unsigned short rx_len;
+    unsigned long last_updated;              // In jiffies
+    char valid;
+};
+
+/* A command class whose responses are cached */
+struct ipmi_cache_class {
+    unsigned char cmd;
+    unsigned long ttl;                       // In jiffies, 0 if unused
+};
+
 /* Structure to hold IPMI (Intelligent Platform Management Interface) data */
 struct ipmi_data {
-    struct completion read_complete;         // Synchronization primitive for signaling message read completion
     struct ipmi_addr address;                // Structure to store the IPMI system interface address
     struct ipmi_user *user;                  // Pointer to IPMI user created by the kernel
     int interface;                           // Interface identifier for the IPMI system
 
-    struct kernel_ipmi_msg tx_message;       // Message structure for sending IPMI commands
-    long tx_msgid;                           // Message ID for tracking IPMI message transactions
+    long tx_msgid;                           // Last message ID used for tracking IPMI message transactions
+    spinlock_t lock;                         // Protects tx_msgid and the pending request list
+    struct list_head pending;                // Requests awaiting a response
 
-    void *rx_msg_data;                       // Pointer to buffer for storing received IPMI message data
-    unsigned short rx_msg_len;               // Length of the received IPMI message
-    unsigned char rx_result;                 // Result code from the received IPMI message
-    int rx_recv_type;                        // Type of the received message (e.g., system interface, LAN, etc.)
+    unsigned char rx_result;                 // Result code from the last ipmi_send_message() call
+    int rx_recv_type;                        // Type of the last received message (e.g., system interface, LAN, etc.)
+
+    struct mutex cache_lock;                 // Protects the response cache
+    struct ipmi_cache_class cache_class[IPMI_CACHE_CLASSES];
+    struct ipmi_cache_entry cache[IPMI_CACHE_ENTRIES];
 
     struct ipmi_user_hndl ipmi_hndlrs;       // IPMI handler structure for handling incoming IPMI messages
     struct device *dev;                      // Device structure for logging errors
@@ -56,6 +99,7 @@ extern int init_ipmi_data(struct ipmi_data *ipmi, int iface, struct device *dev)
 
 /* 
  * Send an IPMI command to the IPMI device and receive the response.
+ * The completion code is stored in ipmi->rx_result.
  * 
  * @param ipmi: Pointer to ipmi_data structure containing IPMI communication information.
  * @param cmd: IPMI command byte.
@@ -69,4 +113,54 @@ extern int ipmi_send_message(struct ipmi_data *ipmi, unsigned char cmd,
                              unsigned char *tx_data, unsigned short tx_len,
                              unsigned char *rx_data, unsigned short rx_len);
 
+/* 
+ * Send several IPMI commands, keeping up to IPMI_MAX_OUTSTANDING of them
+ * in flight, and receive their responses. Each request reports its own
+ * status and completion code.
+ * 
+ * @param ipmi: Pointer to ipmi_data structure containing IPMI communication information.
+ * @param reqs: Array of requests. Only the public fields need to be set.
+ * @param count: Number of requests.
+ * @return 0 if every request succeeded with a zero completion code,
+ *         or the first error otherwise.
+ */
+extern int ipmi_send_messages(struct ipmi_data *ipmi,
+                              struct ipmi_request *reqs, int count);
+
+/* 
+ * Cache the responses of a command for a period of time. Cached responses
+ * are matched on the command payload, so each sensor or port read through
+ * the command is cached separately.
+ * 
+ * @param ipmi: Pointer to ipmi_data structure.
+ * @param cmd: IPMI command byte.
+ * @param ttl: Cache lifetime in jiffies, or 0 to stop caching the command.
+ * @return 0 on success, or -ENOSPC if there are too many cached commands.
+ */
+extern int ipmi_cache_set(struct ipmi_data *ipmi, unsigned char cmd,
+                          unsigned long ttl);
+
+/* 
+ * Discard the cached responses of a command, e.g. after a write
+ * through a related command.
+ * 
+ * @param ipmi: Pointer to ipmi_data structure.
+ * @param cmd: IPMI command byte.
+ */
+extern void ipmi_cache_invalidate(struct ipmi_data *ipmi, unsigned char cmd);
+
+/* 
+ * Discard the cached response of one request, e.g. the reads of a port
+ * whose module has been replaced.
+ * 
+ * @param ipmi: Pointer to ipmi_data structure.
+ * @param cmd: IPMI command byte.
+ * @param tx_data: The command payload of the request.
+ * @param tx_len: Length of the command payload data.
+ */
+extern void ipmi_cache_invalidate_request(struct ipmi_data *ipmi,
+                                          unsigned char cmd,
+                                          unsigned char *tx_data,
+                                          unsigned short tx_len);
+
 #endif /* ACCTON_IPMI_INTF_H */
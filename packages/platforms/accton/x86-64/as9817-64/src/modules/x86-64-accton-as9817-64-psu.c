@@ -160,7 +160,6 @@ struct as9817_64_psu_data {
     unsigned long last_updated[2];    /* In jiffies, 0: PSU1, 1: PSU2 */
     struct ipmi_data ipmi;
     struct ipmi_psu_resp_data ipmi_resp[2]; /* 0: PSU1, 1: PSU2 */
-    unsigned char ipmi_tx_data[2];
 };
 
 struct as9817_64_psu_data *data = NULL;
@@ -400,6 +399,36 @@ static struct as9817_64_psu_data *as9817_64_psu_update_device(struct device_attr
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
     unsigned char pid = attr->index / NUM_OF_PER_PSU_ATTR;
+    /* PSU ID base id for ipmi start from 1 */
+    unsigned char tx_data[][2] = {
+        { pid + 1, 0 },
+        { pid + 1, IPMI_PSU_MODEL_NAME_CMD },
+        { pid + 1, IPMI_PSU_SERIAL_NUM_CMD },
+        { pid + 1, IPMI_PSU_FAN_DIR_CMD },
+        { pid + 1, IPMI_PSU_INFO_CMD },
+    };
+    struct ipmi_request reqs[] = {
+        /* Get status from ipmi */
+        { .cmd = IPMI_PSU_READ_CMD, .tx_data = tx_data[0], .tx_len = 1,
+          .rx_data = data->ipmi_resp[pid].status,
+          .rx_len = sizeof(data->ipmi_resp[pid].status) },
+        /* Get model name from ipmi */
+        { .cmd = IPMI_PSU_READ_CMD, .tx_data = tx_data[1], .tx_len = 2,
+          .rx_data = data->ipmi_resp[pid].model,
+          .rx_len = sizeof(data->ipmi_resp[pid].model) - 1 },
+        /* Get serial number from ipmi */
+        { .cmd = IPMI_PSU_READ_CMD, .tx_data = tx_data[2], .tx_len = 2,
+          .rx_data = data->ipmi_resp[pid].serial,
+          .rx_len = sizeof(data->ipmi_resp[pid].serial) - 1 },
+        /* Get fan direction from ipmi */
+        { .cmd = IPMI_PSU_READ_CMD, .tx_data = tx_data[3], .tx_len = 2,
+          .rx_data = data->ipmi_resp[pid].fandir,
+          .rx_len = sizeof(data->ipmi_resp[pid].fandir) - 1 },
+        /* Get capability from ipmi */
+        { .cmd = IPMI_PSU_READ_CMD, .tx_data = tx_data[4], .tx_len = 2,
+          .rx_data = data->ipmi_resp[pid].info,
+          .rx_len = sizeof(data->ipmi_resp[pid].info) },
+    };
     int status = 0;
 
     if (time_before(jiffies, data->last_updated[pid] + HZ * 5) && data->valid[pid])
@@ -409,76 +438,11 @@ static struct as9817_64_psu_data *as9817_64_psu_update_device(struct device_attr
     /* To be compatible for older BMC firmware */
     data->ipmi_resp[pid].status[PSU_VOUT_MODE] = 0xff;
 
-    /* Get status from ipmi */
-    data->ipmi_tx_data[0] = pid + 1; /* PSU ID base id for ipmi start from 1 */
-    status = ipmi_send_message(&data->ipmi, IPMI_PSU_READ_CMD,
-                                data->ipmi_tx_data, 1,
-                                data->ipmi_resp[pid].status,
-                                sizeof(data->ipmi_resp[pid].status));
+    /* Get all PSU data from ipmi in a single batch */
+    status = ipmi_send_messages(&data->ipmi, reqs, ARRAY_SIZE(reqs));
     if (unlikely(status != 0))
         goto exit;
 
-    if (unlikely(data->ipmi.rx_result != 0)) {
-        status = -EIO;
-        goto exit;
-    }
-
-    /* Get model name from ipmi */
-    data->ipmi_tx_data[1] = IPMI_PSU_MODEL_NAME_CMD;
-    status = ipmi_send_message(&data->ipmi, IPMI_PSU_READ_CMD,
-                                data->ipmi_tx_data, 2,
-                                data->ipmi_resp[pid].model,
-                                sizeof(data->ipmi_resp[pid].model) - 1);
-    if (unlikely(status != 0))
-        goto exit;
-
-    if (unlikely(data->ipmi.rx_result != 0)) {
-        status = -EIO;
-        goto exit;
-    }
-
-    /* Get serial number from ipmi */
-    data->ipmi_tx_data[1] = IPMI_PSU_SERIAL_NUM_CMD;
-    status = ipmi_send_message(&data->ipmi, IPMI_PSU_READ_CMD,
-                                data->ipmi_tx_data, 2,
-                                data->ipmi_resp[pid].serial,
-                                sizeof(data->ipmi_resp[pid].serial) - 1);
-    if (unlikely(status != 0))
-        goto exit;
-
-    if (unlikely(data->ipmi.rx_result != 0)) {
-        status = -EIO;
-        goto exit;
-    }
-
-    /* Get fan direction from ipmi */
-    data->ipmi_tx_data[1] = IPMI_PSU_FAN_DIR_CMD;
-    status = ipmi_send_message(&data->ipmi, IPMI_PSU_READ_CMD,
-                                data->ipmi_tx_data, 2,
-                                data->ipmi_resp[pid].fandir,
-                                sizeof(data->ipmi_resp[pid].fandir) - 1);
-    if (unlikely(status != 0))
-        goto exit;
-
-    if (unlikely(data->ipmi.rx_result != 0)) {
-        status = -EIO;
-        goto exit;
-    }
-
-    /* Get capability from ipmi */
-    data->ipmi_tx_data[1] = IPMI_PSU_INFO_CMD;
-    status = ipmi_send_message(&data->ipmi, IPMI_PSU_READ_CMD,
-                                data->ipmi_tx_data, 2,
-                                data->ipmi_resp[pid].info,
-                                sizeof(data->ipmi_resp[pid].info));
-    if (unlikely(status != 0))
-        goto exit;
-
-    if (unlikely(data->ipmi.rx_result != 0)) {
-        status = -EIO;
-        goto exit;
-    }
-
     data->last_updated[pid] = jiffies;
     data->valid[pid] = 1;
 
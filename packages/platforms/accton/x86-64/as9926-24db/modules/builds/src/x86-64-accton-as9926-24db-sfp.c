@@ -440,18 +440,38 @@ exit:
 	return data;
 }
 
+/* Drop the cached EEPROM pages of a QSFP port, the module has changed */
+static void as9926_24db_qsfp_cache_invalidate(int qsfp)
+{
+	unsigned char tx_data[2];
+	int page;
+
+	tx_data[0] = qsfp + 1; /* Port ID base id for ipmi start from 1 */
+	for (page = 0; page < QSFP_EEPROM_SIZE / IPMI_DATA_MAX_LEN; page++) {
+		tx_data[1] = page;
+		ipmi_cache_invalidate_request(&data->ipmi, IPMI_QSFP_READ_CMD,
+					      tx_data, sizeof(tx_data));
+	}
+}
+
 static struct as9926_24db_sfp_data *as9926_24db_qsfp_update_present(void)
 {
 	int status = 0;
+	int i;
+	unsigned char present[NUM_OF_QSFP];
 
 	if (time_before(jiffies, data->ipmi_resp.qsfp_last_updated[QSFP_PRESENT]
 			+ HZ) && data->ipmi_resp.qsfp_valid[QSFP_PRESENT])
 		return data;
 
 	data->ipmi_resp.qsfp_valid[QSFP_PRESENT] = 0;
+	memcpy(present, data->ipmi_resp.qsfp_resp[QSFP_PRESENT],
+	       sizeof(present));
 
-	/* Get status from ipmi */
+	/* Get status from ipmi, not from the response cache */
 	data->ipmi_tx_data[0] = 0x10;
+	ipmi_cache_invalidate_request(&data->ipmi, IPMI_QSFP_READ_CMD,
+				      data->ipmi_tx_data, 1);
 	status = ipmi_send_message(&data->ipmi, IPMI_QSFP_READ_CMD, 
 				   data->ipmi_tx_data, 1,
 				   data->ipmi_resp.qsfp_resp[QSFP_PRESENT], 
@@ -464,6 +484,13 @@ static struct as9926_24db_sfp_data *as9926_24db_qsfp_update_present(void)
 		goto exit;
 	}
 
+	/* A module inserted or removed since the last update must not be
+	   answered with the EEPROM of the previous one */
+	for (i = 0; i < NUM_OF_QSFP; i++) {
+		if ((present[i] ^ data->ipmi_resp.qsfp_resp[QSFP_PRESENT][i]) & 0x1)
+			as9926_24db_qsfp_cache_invalidate(i);
+	}
+
 	data->ipmi_resp.qsfp_last_updated[QSFP_PRESENT] = jiffies;
 	data->ipmi_resp.qsfp_valid[QSFP_PRESENT] = 1;
 
@@ -965,6 +992,7 @@ set_qsfp_txdisable(struct device *dev, struct device_attribute *da,
 	status = ipmi_send_message(&data->ipmi, IPMI_QSFP_WRITE_CMD,
 				data->ipmi_tx_data, sizeof(data->ipmi_tx_data),
 				NULL, 0);
+	ipmi_cache_invalidate(&data->ipmi, IPMI_QSFP_READ_CMD);
 
 	if (unlikely(status != 0))
 		goto exit;
@@ -1010,6 +1038,7 @@ static ssize_t set_qsfp_reset(struct device *dev, struct device_attribute *da,
 	status = ipmi_send_message(&data->ipmi, IPMI_QSFP_WRITE_CMD,
 				data->ipmi_tx_data, sizeof(data->ipmi_tx_data),
 				NULL, 0);
+	ipmi_cache_invalidate(&data->ipmi, IPMI_QSFP_READ_CMD);
 	
 	if (unlikely(status != 0))
 		goto exit;
@@ -1106,6 +1135,13 @@ static ssize_t sfp_eeprom_read(loff_t off, char *buf, size_t count, int port)
 	data->ipmi_resp.eeprom_valid = 0;
 	data->ipmi_tx_data[0] = ipmi_port_id;
 	data->ipmi_tx_data[1] = ipmi_page; 
+
+	/* The QSFP lower page holds the SFF-8636 clear-on-read flags
+	   (bytes 3~21); a cached copy would repeat or lose latched events */
+	if (cmd == IPMI_QSFP_READ_CMD && ipmi_page == 0)
+		ipmi_cache_invalidate_request(&data->ipmi, cmd,
+					      data->ipmi_tx_data, 2);
+
 	status = ipmi_send_message(&data->ipmi, cmd, data->ipmi_tx_data, 2,
 				data->ipmi_resp.eeprom, IPMI_DATA_MAX_LEN);
 
@@ -1210,6 +1246,7 @@ static ssize_t sfp_eeprom_write(loff_t off, char *buf, size_t count, int port)
 	status = ipmi_send_message(&data->ipmi, cmd, &wdata.ipmi_tx_data[0], 
 				   length + sizeof(wdata.ipmi_tx_data), 
 				   NULL, 0);
+	ipmi_cache_invalidate(&data->ipmi, IPMI_QSFP_READ_CMD);
 
 	if (unlikely(status != 0))
 		goto exit;
@@ -1601,6 +1638,11 @@ static int __init as9926_24db_sfp_init(void)
 	if (ret)
 		goto ipmi_err;
 
+	/* QSFP status and EEPROM pages are read in pieces by several
+	   attributes, so share recent responses between them. The lower
+	   EEPROM page is always read from the module, see sfp_eeprom_read */
+	ipmi_cache_set(&data->ipmi, IPMI_QSFP_READ_CMD, HZ);
+
 	return 0;
 
 ipmi_err:
@@ -106,6 +106,10 @@ enum onlp_thermal_id
 #define ONLP_PSUI_SHM_KEY   (0xF001100 | ONLP_OID_TYPE_PSU)
 #define ONLP_SFPI_SHM_KEY   (0xF001100 | ONLP_OID_TYPE_MODULE)
 #define ONLP_LEDI_SHM_KEY   (0xF001100 | ONLP_OID_TYPE_LED)
+#define ONLP_BMC_TTY_SHM_KEY 0xF001200
+
+/* BMC file values are reused for this long (one poll cycle). */
+#define BMC_CACHE_MS        1000
 
 #define PLATFOTM_NUM_OF_PIM  (8)
 
@@ -44,6 +44,12 @@
 
 #define IDPROM_PATH "/sys/class/i2c-adapter/i2c-40/40-0050/eeprom"
 
+/* BMC console lock and file cache */
+#define ONLP_BMC_TTY_SHM_KEY  0xF001200
+#define BMC_CACHE_MS          1000
+#define BMC_BATCH_MAX         16
+#define MAXIMUM_TTY_BUFFER_LENGTH 1024
+
 enum onlp_thermal_id
 {
     THERMAL_RESERVED = 0,
@@ -60,6 +66,8 @@ enum onlp_thermal_id
 int bmc_send_command(char *cmd);
 int bmc_file_read_str(char *file, char *result, int slen);
 int bmc_file_read_int(int* value, char *file, int base);
+int bmc_file_read_batch(const char **files, int count, int *values, int base,
+                        int *status);
 int bmc_i2c_readb(uint8_t bus, uint8_t devaddr, int16_t addr);
 int bmc_i2c_writeb(uint8_t bus, uint8_t devaddr, uint8_t addr, uint8_t value);
 int bmc_i2c_write_quick_mode(uint8_t bus, uint8_t devaddr, uint8_t value);
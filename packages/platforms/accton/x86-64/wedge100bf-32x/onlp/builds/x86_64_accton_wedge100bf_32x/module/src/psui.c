@@ -44,7 +44,7 @@
 #define PSU_PRESENT_FMT		"psu%d_present"
 #define PSU_PWROK_FMT		"psu%d_output_pwr_sts"
 
-#define PSU_PFE1100_PATH_FMT	"/sys/bus/i2c/devices/%d-00%02x/%s\r\n"
+#define PSU_PFE1100_PATH_FMT	"/sys/bus/i2c/devices/%d-00%02x/%s"
 #define PSU_PFE1100_MODEL	"mfr_model_label"
 #define PSU_PFE1100_SERIAL	"mfr_serial_label"
 
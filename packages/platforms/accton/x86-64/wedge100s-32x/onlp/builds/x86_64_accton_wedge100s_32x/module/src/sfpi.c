@@ -161,7 +161,7 @@ sfpi_eeprom_read(int port, uint8_t devaddr, uint8_t data[256])
 {
     memset(data, 0, 256);
     int bus = sfp_bus_index[port];
-    return onlp_i2c_read(bus, devaddr, 0, 256, data, ONLP_I2C_F_FORCE);
+    return onlp_i2c_read(bus, devaddr, 0, 256, data, ONLP_I2C_F_FORCE | ONLP_I2C_F_USE_RDWR_READ);
     return ONLP_STATUS_OK;
 }
 
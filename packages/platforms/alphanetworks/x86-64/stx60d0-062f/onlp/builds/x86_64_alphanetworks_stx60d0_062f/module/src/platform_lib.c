@@ -32,8 +32,17 @@
 #include <fcntl.h>
 #include <AIM/aim.h>
 #include <onlp/platformi/sfpi.h>
+#include <onlplib/ipmi.h>
 #include "platform_lib.h"
 
+#define BMC_NETFN_SENSOR             ONLP_IPMI_NETFN_SENSOR
+#define BMC_NETFN_APP                ONLP_IPMI_NETFN_APP
+#define BMC_NETFN_OEM                0x34
+#define BMC_CMD_GET_SENSOR_READING   0x2d
+#define BMC_CMD_MASTER_WRITE_READ    0x52
+#define BMC_CMD_PWM_GET              0x03
+#define BMC_CMD_PWM_SET              0x04
+
 #include <onlplib/i2c.h>
 
 #define DEBUG_FLAG 0
@@ -483,74 +492,42 @@ int bmc_get_raw_bus_id(int bus)
     return ipmi_bus_id;
 }
 
-int bmc_command_read(char *cmd, char *data)
+static int bmc_raw_read(uint8_t netfn, uint8_t cmd, const uint8_t *req, int req_len, char *data)
 {
-    int rc = 0;
-    FILE * fp;
-    char result_buf[80];
-    int result_buf_size;
-
-    memset(result_buf, 0, sizeof(result_buf));
-    result_buf_size = sizeof(result_buf);
-
-    fp = popen(cmd, "r");
-    if(NULL == fp)
-    {
-        printf("popen Fail! \n");
-        return -1/*FALSE*/;
-    }
-
-    rc = fread(result_buf, 1, result_buf_size, fp);
-    if(rc == result_buf_size)
-    {
-        printf("buffer too small\n");
-        return -1/*FALSE*/;
-    }
+    uint8_t rsp[ONLP_IPMI_DATA_MAX];
+    int rsp_len = 0;
 
-   rc = pclose(fp);
-   if(-1 == rc)
+    if (onlp_ipmi_raw(netfn, cmd, req, req_len, rsp, sizeof(rsp), &rsp_len) < 0 || rsp_len < 1)
     {
-        printf("pclose Fail! \n");
+        AIM_LOG_ERROR("BMC raw 0x%02x 0x%02x read failed", netfn, cmd);
         return -1/*FALSE*/;
     }
 
-//debug
-//printf("[%s(%d)]result_buf:%s\n", __func__, __LINE__,result_buf);
-
-    /* the return value of ipmitool is hex string, transfer to dec integer. ex:0x1f-> 31 */
-    int result_dec = (int)strtol(result_buf,NULL,16);
-
-//debug
-//printf("[%s(%d)] result_dec:%d \n", __func__, __LINE__, result_dec);
-
-    /* finally, return dec integer*/
-    *data = result_dec;
+    /* The first response byte is the value. */
+    *data = rsp[0];
 
     return 1/*TRUE*/;
-
 }
 
 int bmc_i2c_read_byte(int bus, int devaddr, int offset, char* data)
 {
     int ret = 0;
-    char cmd[128] = {0};
+    uint8_t req[4];
 
     int raw_bus_id=0;
 
     raw_bus_id = bmc_get_raw_bus_id(bus);
 
-    if (raw_bus_id)
-        snprintf(cmd, sizeof(cmd), "ipmitool raw 0x06 0x52 0x%02x 0x%x 1 0x%02x", raw_bus_id, devaddr, offset);
-    else
+    if (!raw_bus_id)
         return ret;
 
-//debug
-//printf("[%s(%d)] cmd:%s \n", __func__, __LINE__, cmd);
+    /* Master Write-Read: bus, address, read count, offset */
+    req[0] = raw_bus_id;
+    req[1] = devaddr;
+    req[2] = 1;
+    req[3] = offset;
 
-    ret = bmc_command_read(cmd, data);
-
-//debug
-//printf("[%s(%d)] data:%d, ret %d \n", __func__, __LINE__, *data, ret);
+    ret = bmc_raw_read(BMC_NETFN_APP, BMC_CMD_MASTER_WRITE_READ, req, sizeof(req), data);
 
     return ret;
 
@@ -558,41 +535,22 @@ int bmc_i2c_read_byte(int bus, int devaddr, int offset, char* data)
 
 int bmc_read_raw_fan_speed(int sensor_num, char* data)
 {
-    int ret = 0;
-    char cmd[128] = {0};
-
-    snprintf(cmd, sizeof(cmd), "ipmitool raw 0x04 0x2d 0x%02x", sensor_num);
-
-//debug
-//printf("[%s(%d)] cmd:%s \n", __func__, __LINE__, cmd);
-
-    ret = bmc_command_read(cmd, data);
+    uint8_t req[1];
 
-//debug
-//printf("[%s(%d)] data:%d, ret %d \n", __func__, __LINE__, *data, ret);
-
-    return ret;
+    /* Get Sensor Reading */
+    req[0] = sensor_num;
 
+    return bmc_raw_read(BMC_NETFN_SENSOR, BMC_CMD_GET_SENSOR_READING, req, sizeof(req), data);
 }
 
-/* Get PWM : ipmitool raw 0x34 0x03 <PWM number 0x01 ~ 0x04> */
+/* Get PWM : raw 0x34 0x03 <PWM number 0x01 ~ 0x04> */
 int bmc_read_raw_fan_pwm(int pwm_num, char* data)
 {
-    int ret = 0;
-    char cmd[128] = {0};
-
-    snprintf(cmd, sizeof(cmd), "ipmitool raw 0x34 0x03 0x%02x", pwm_num);
-
-//debug
-//printf("[%s(%d)] cmd:%s \n", __func__, __LINE__, cmd);
+    uint8_t req[1];
 
-    ret = bmc_command_read(cmd, data);
-
-//debug
-//printf("[%s(%d)] data:%d, ret %d \n", __func__, __LINE__, *data, ret);
-
-    return ret;
+    req[0] = pwm_num;
 
+    return bmc_raw_read(BMC_NETFN_OEM, BMC_CMD_PWM_GET, req, sizeof(req), data);
 }
 
 int i2c_read_word(int i2cbus, int addr, int offset)
@@ -813,69 +771,49 @@ int i2c_write_byte(int i2cbus, int addr, int offset, char val)
     return 0;
 }
 
-int bmc_command_write(char *cmd)
+static int bmc_raw_write(uint8_t netfn, uint8_t cmd, const uint8_t *req, int req_len)
 {
-    int rc = 0;
-    FILE * fp;
-
-    fp = popen(cmd, "w");
-    if(NULL == fp)
-    {
-        printf("Error:popen Fail! \n");
-        return -1/*FALSE*/;
-    }
-
-   rc = pclose(fp);
-   if(-1 == rc)
+    if (onlp_ipmi_raw(netfn, cmd, req, req_len, NULL, 0, NULL) < 0)
     {
-        printf("Error:pclose Fail! \n");
+        AIM_LOG_ERROR("BMC raw 0x%02x 0x%02x write failed", netfn, cmd);
         return -1/*FALSE*/;
     }
 
     return 1/*TRUE*/;
 }
 
-int bmc_i2c_write_byte(int bus, int devaddr, int offset, char value)
+int bmc_i2c_write_byte(int bus, int devaddr, int offset, char value)    
 {
     int ret = 0;
-    char cmd[128] = {0};
+    uint8_t req[5];
     int raw_bus_id=0;
 
     raw_bus_id = bmc_get_raw_bus_id(bus);
 
-    if (raw_bus_id)
-        snprintf(cmd, sizeof(cmd), "ipmitool raw 0x06 0x52 0x%02x 0x%x 0x00 0x%02x 0x%02X", raw_bus_id, devaddr, offset, (unsigned char)value);
-    else
+    if (!raw_bus_id)
         return ret;
 
-//debug
-//printf("[%s(%d)] cmd:%s \n", __func__, __LINE__, cmd);
-
-    ret = bmc_command_write(cmd);
+    /* Master Write-Read: bus, address, no read, offset, value */
+    req[0] = raw_bus_id;
+    req[1] = devaddr;
+    req[2] = 0;
+    req[3] = offset;
+    req[4] = (unsigned char)value;
 
-//debug
-//printf("[%s(%d)] ret:%d \n", __func__, __LINE__, ret);
+    ret = bmc_raw_write(BMC_NETFN_APP, BMC_CMD_MASTER_WRITE_READ, req, sizeof(req));
 
     return ret;
 }
 
-/* Set PWM : ipmitool raw 0x34 0x04 <PWM number 0x01 ~ 0x04> <Duty Cycle 0x00 ~ 0x64> */
-int bmc_write_raw_fan_pwm(int pwm_num, char value)
+/* Set PWM : raw 0x34 0x04 <PWM number 0x01 ~ 0x04> <Duty Cycle 0x00 ~ 0x64> */
+int bmc_write_raw_fan_pwm(int pwm_num, char value)    
 {
-    int ret = 0;
-    char cmd[128] = {0};
-
-    snprintf(cmd, sizeof(cmd), "ipmitool raw 0x34 0x04 0x%02x 0x%02X", pwm_num, (unsigned char)value);
-
-//debug
-//printf("[%s(%d)] cmd:%s \n", __func__, __LINE__, cmd);
+    uint8_t req[2];
 
-    ret = bmc_command_write(cmd);
+    req[0] = pwm_num;
+    req[1] = (unsigned char)value;
 
-//debug
-//printf("[%s(%d)] ret:%d \n", __func__, __LINE__, ret);
-
-    return ret;
+    return bmc_raw_write(BMC_NETFN_OEM, BMC_CMD_PWM_SET, req, sizeof(req));
 }
 
 int i2c_write_bit(int i2cbus, int addr, int offset, int bit, char val)
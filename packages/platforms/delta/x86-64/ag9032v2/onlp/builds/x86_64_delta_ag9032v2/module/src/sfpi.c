@@ -291,7 +291,7 @@ onlp_sfpi_eeprom_read(int port, uint8_t data[256])
     memset(data, 0, 256);
 
     /* Read qsfp eeprom information into data[] */
-    if (onlp_i2c_read(I2C_BUS_1, SFP_MODULE_EEPROM, 0, 256, data, ONLP_I2C_F_DISABLE_READ_RETRIES)) {
+    if (onlp_i2c_read(I2C_BUS_1, SFP_MODULE_EEPROM, 0, 256, data, ONLP_I2C_F_DISABLE_READ_RETRIES | ONLP_I2C_F_USE_RDWR_READ)) {
         AIM_LOG_INFO("Unable to read eeprom from port(%d)\r\n", port);
         return ONLP_STATUS_E_INTERNAL;
     }
@@ -30,176 +30,117 @@
 #include <fcntl.h>
 #include <AIM/aim.h>
 #include <onlp/onlp.h>
+#include <onlplib/ipmi.h>
 
 #include "platform_lib.h"
 
 
+#define BMC_NETFN_OEM          0x38
+#define BMC_CMD_I2C_READ       0x2
+#define BMC_CMD_I2C_WRITE_BYTE 0x3
+#define BMC_CMD_I2C_WRITE_WORD 0x4
+#define BMC_CMD_I2C_WRITE_LONG 0x5
+
 int ifnOS_LINUX_BmcI2CGet(uint8_t bus, uint8_t dev, uint32_t reg, uint32_t *rdata, uint8_t datalen)
 {
     int rv     = ONLP_STATUS_OK;
-    int dIndex = 1;
-    char *pch  = NULL;
-    FILE *pFd  = NULL;
-    int tmp_data[OS_MAX_MSG_SIZE]   = {0};
-    char ipmi_cmd[OS_MAX_MSG_SIZE]  = {0};
-    char cmd_rdata[OS_MAX_MSG_SIZE] = {0};
-        
-    sprintf(ipmi_cmd, "ipmitool raw 0x38 0x2 %d %d %d %d", bus, dev, reg, datalen);
-    
-    pFd = popen(ipmi_cmd, "r");
-    
-    if(pFd != NULL)
+    int dIndex = 0;
+    int rsp_len = 0;
+    uint8_t req[4];
+    uint8_t rsp[OS_MAX_MSG_SIZE] = {0};
+
+    if (datalen == 0 || datalen >= 64)
     {
-        if (fgets(cmd_rdata, OS_MAX_MSG_SIZE, pFd) != NULL)
-        {            
-            memset(tmp_data, 0x0, sizeof(tmp_data));
-            
-            for(dIndex = 1; dIndex <= datalen; dIndex++)
-            {
-                if(dIndex == 1)
-                {
-                    pch = strtok(cmd_rdata," ");
-                }
-                else
-                {
-                    pch = strtok(NULL," ");
-                }
-                
-                if(!pch)
-                {            
-                    AIM_LOG_ERROR("Command \"%s\": Extract Data Failed (ret: %d)", ipmi_cmd, ONLP_STATUS_E_INTERNAL);
-                    return ONLP_STATUS_E_INTERNAL;
-                }                    
-                else
-                {   /* cut newline char */
-                    if( pch[strlen(pch)-1] == '\n') 
-                    {
-                        pch[strlen(pch)-1] = 0x0;
-                    }
-                }
-
-                tmp_data[dIndex] = xtoi(pch);
-            }
-        
-            switch (datalen) 
-            {
-                case 1:
-                    *rdata = tmp_data[1];
-                    break;
-                case 2:
-                    *rdata = (tmp_data[1] << 8) | (tmp_data[2]);
-                    break;
-                default:
-                    if( (datalen > 2) && (datalen < 64) ) 
-                    {
-                        for(dIndex = 1; dIndex <= datalen; dIndex++) 
-                        { 
-                            rdata[dIndex - 1] = tmp_data[dIndex];
-                        }
-                    }
-                    else 
-                    {
-                        rv = ONLP_STATUS_E_INTERNAL;
-                        AIM_LOG_ERROR("Command \"%s\": data length out of range (ret: %d)", ipmi_cmd, rv);
-                    }
-            }
-        }
-        else
-        {
-            rv = ONLP_STATUS_E_INTERNAL;
-            AIM_LOG_ERROR("Command \"%s\": Get Data Failed (ret: %d)", ipmi_cmd, rv);
-        }
-        
-        pclose(pFd);
+        AIM_LOG_ERROR("BMC i2c read %d/0x%x/0x%x: data length %d out of range", bus, dev, reg, datalen);
+        return ONLP_STATUS_E_INTERNAL;
     }
-    else
+
+    req[0] = bus;
+    req[1] = dev;
+    req[2] = reg;
+    req[3] = datalen;
+
+    rv = onlp_ipmi_raw(BMC_NETFN_OEM, BMC_CMD_I2C_READ, req, sizeof(req), rsp, sizeof(rsp), &rsp_len);
+    if (rv < 0 || rsp_len < datalen)
     {
-        rv = ONLP_STATUS_E_INTERNAL;
-        AIM_LOG_ERROR("Execute command \"%s\" failed (ret: %d)", ipmi_cmd, rv);
+        AIM_LOG_ERROR("BMC i2c read %d/0x%x/0x%x: Get Data Failed (ret: %d)", bus, dev, reg, rv);
+        return ONLP_STATUS_E_INTERNAL;
     }
-    
+
+    switch (datalen)
+    {
+        case 1:
+            *rdata = rsp[0];
+            break;
+        case 2:
+            *rdata = (rsp[0] << 8) | (rsp[1]);
+            break;
+        default:
+            for(dIndex = 0; dIndex < datalen; dIndex++)
+            {
+                rdata[dIndex] = rsp[dIndex];
+            }
+    }
+
     return rv;
 }
 
 int ifnOS_LINUX_BmcI2CSet(uint8_t bus, uint8_t dev, uint32_t reg, uint32_t u4Data, uint8_t datalen)
 {
-    int rv    = ONLP_STATUS_OK;
-    FILE *pFd = NULL;
-    char ipmi_cmd[OS_MAX_MSG_SIZE] = {0};
-        
+    int rv = ONLP_STATUS_OK;
+    uint8_t cmd;
+    uint8_t req[7];
+
+    req[0] = bus;
+    req[1] = dev;
+    req[2] = reg;
+
     switch (datalen)
     {
         case 1:
-            sprintf(ipmi_cmd, "ipmitool raw 0x38 0x3 %d %d %d %d", bus, dev, reg, u4Data);
+            cmd = BMC_CMD_I2C_WRITE_BYTE;
+            req[3] = u4Data;
             break;
         case 2:
-            sprintf(ipmi_cmd, "ipmitool raw 0x38 0x4 %d %d %d %d %d", bus, dev, reg, 
-                                               ((u4Data & 0xFF00) >> 8), (u4Data & 0xFF));
+            cmd = BMC_CMD_I2C_WRITE_WORD;
+            req[3] = (u4Data & 0xFF00) >> 8;
+            req[4] = (u4Data & 0xFF);
             break;
-        case 4: 
-            sprintf(ipmi_cmd, "ipmitool raw 0x38 0x5 %d %d %d %d %d %d %d", bus, dev, reg, 
-            ((u4Data & 0xFF000000) >> 24), ((u4Data & 0xFF0000) >> 16), ((u4Data & 0xFF00) >> 8), (u4Data & 0xFF));
+        case 4:
+            cmd = BMC_CMD_I2C_WRITE_LONG;
+            req[3] = (u4Data & 0xFF000000) >> 24;
+            req[4] = (u4Data & 0xFF0000) >> 16;
+            req[5] = (u4Data & 0xFF00) >> 8;
+            req[6] = (u4Data & 0xFF);
             break;
         default:
             AIM_LOG_ERROR("ERR: Unsupported data length: %d", datalen);
+            return ONLP_STATUS_E_PARAM;
     }
-    
-    pFd = popen(ipmi_cmd, "r");
-    
-    if (pFd != NULL)
-    {
-        pclose(pFd);
-    }
-    else
+
+    rv = onlp_ipmi_raw(BMC_NETFN_OEM, cmd, req, 3 + datalen, NULL, 0, NULL);
+    if (rv < 0)
     {
+        AIM_LOG_ERROR("BMC i2c write %d/0x%x/0x%x failed (ret: %d)", bus, dev, reg, rv);
         rv = ONLP_STATUS_E_INTERNAL;
-        AIM_LOG_ERROR("Execute command \"%s\" failed (ret: %d)", ipmi_cmd, rv);
     }
-    
+
     return rv;
 }
 
 int ifnOS_LINUX_BmcGetDataByName(char *devname, uint32_t *rdata)
 {
-    int rv           = ONLP_STATUS_OK;
-    char *temp_data  = NULL;
-    FILE *pFd        = NULL;
-    uint32_t devdata = 0;
-    char ipmi_cmd [OS_MAX_MSG_SIZE] = {0};
-    char cmd_rdata[OS_MAX_MSG_SIZE] = {0};
-        
-    sprintf(ipmi_cmd, "ipmitool sdr get %s | grep 'Sensor Reading'", devname);
-    
-    pFd = popen(ipmi_cmd, "r");
-    
-    if(pFd != NULL)
-    {
-        if (fgets(cmd_rdata, OS_MAX_MSG_SIZE, pFd) != NULL)
-        {
-            temp_data = strchr(cmd_rdata, ':');
-            temp_data = strtok(temp_data, "(");
-            
-            do 
-            {
-                devdata += strtol(temp_data, &temp_data, 10); 
-            }while (*temp_data++);
-            
-            *rdata = devdata;
-        }
-        else
-        {
-            rv = ONLP_STATUS_E_INTERNAL;
-            AIM_LOG_ERROR("Command \"%s\": Get Data Failed (ret: %d)", ipmi_cmd, rv);
-        }
-        
-        pclose(pFd);
-    }
-    else
+    int rv       = ONLP_STATUS_OK;
+    double value = 0;
+
+    rv = onlp_ipmi_sensor_read_name(devname, &value);
+    if (rv < 0)
     {
-        rv = ONLP_STATUS_E_INTERNAL;
-        AIM_LOG_ERROR("Execute command \"%s\" failed (ret: %d)", ipmi_cmd, rv);
+        AIM_LOG_ERROR("BMC sensor %s: Get Data Failed (ret: %d)", devname, rv);
+        return ONLP_STATUS_E_INTERNAL;
     }
-        
+
+    *rdata = (uint32_t)value;
     return rv;
 }
 
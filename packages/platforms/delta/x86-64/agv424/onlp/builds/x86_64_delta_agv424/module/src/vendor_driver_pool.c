@@ -21,6 +21,7 @@
  ************************************************************/
 #include <onlp/onlp.h>
 #include <onlplib/file.h>
+#include <onlplib/ipmi.h>
 #include <sys/mman.h>
 #include <errno.h>
 #include <string.h>
@@ -775,28 +776,27 @@ int VENDOR_DRV_I2C_SMBUS_Probe(uint8_t bus, uint8_t dev)
     return 0;
 }
 
+#define IPMB_NETFN_OEM 0x3c
+#define IPMB_CMD_I2C_READ 0x01
+#define IPMB_CMD_I2C_WRITE 0x02
+
 static int ipmb_readb(int bus, uint8_t dev, uint16_t addr, uint8_t alen, uint16_t *data, uint8_t dlen)
 {
-    int rv = 0, idx = 0;
-    char ipmi_cmd[80], rv_char[256], *delim = " ", *tmp;
-    uint16_t rv_data[32] = {0};
+    int rv = 0, len = 0;
+    uint8_t req[4];
+    uint8_t rv_data[32] = {0};
 
-    sprintf(ipmi_cmd, "ipmitool raw 0x3c 0x01 %d %d %d %d", bus, dev, addr, dlen);
-    if (vendor_system_call_get(ipmi_cmd, rv_char) != 0)
+    req[0] = bus;
+    req[1] = dev;
+    req[2] = addr;
+    req[3] = dlen;
+    if (onlp_ipmi_raw(IPMB_NETFN_OEM, IPMB_CMD_I2C_READ, req, sizeof(req),
+                      rv_data, sizeof(rv_data), &len) < 0 || len < dlen)
     {
-        AIM_LOG_ERROR("IPMITOOL command: \"%s\": Get Data Failed (ret: %d)", ipmi_cmd);
+        AIM_LOG_ERROR("IPMB read %d/0x%x/0x%x: Get Data Failed", bus, dev, addr);
         return ONLP_STATUS_E_INTERNAL;
     }
 
-    tmp = strtok(rv_char, delim);
-
-    while (tmp != NULL)
-    {
-        rv_data[idx] = strtol(tmp, NULL, 16);
-        tmp = strtok(NULL, delim);
-        idx++;
-    }
-
     switch (dlen)
     {
     case 1:
@@ -819,12 +819,17 @@ static int ipmb_readb(int bus, uint8_t dev, uint16_t addr, uint8_t alen, uint16_
 static int ipmb_writeb(int bus, uint8_t dev, uint16_t addr, uint8_t alen, uint16_t data, uint8_t dlen)
 {
     int rv = 0;
-    char ipmi_cmd[80];
+    uint8_t req[5];
 
-    sprintf(ipmi_cmd, "ipmitool raw 0x3c 0x02 %d %d %d %d %d > /dev/null", bus, dev, addr, dlen, data);
-    if (vendor_system_call_set(ipmi_cmd) != 0)
+    req[0] = bus;
+    req[1] = dev;
+    req[2] = addr;
+    req[3] = dlen;
+    req[4] = data;
+    if (onlp_ipmi_raw(IPMB_NETFN_OEM, IPMB_CMD_I2C_WRITE, req, sizeof(req),
+                      NULL, 0, NULL) < 0)
     {
-        AIM_LOG_ERROR("IPMITOOL command: \"%s\": Set Data Failed.", ipmi_cmd);
+        AIM_LOG_ERROR("IPMB write %d/0x%x/0x%x: Set Data Failed.", bus, dev, addr);
         return ONLP_STATUS_E_INTERNAL;
     }
     /*else
@@ -838,9 +843,9 @@ static int ipmb_writeb(int bus, uint8_t dev, uint16_t addr, uint8_t alen, uint16
 
 static int ipmb_block_read(int bus, uint8_t dev, uint16_t addr, uint8_t *rdata, uint16_t size)
 {
-    int rv = 0, idx = 0;
-    char ipmi_cmd[80], rv_char[256], *delim = " ", *tmp;
-    uint8_t rv_data[32] = {0};
+    int rv = 0, idx = 0, len = 0;
+    uint8_t req[4];
+    uint8_t rv_data[65] = {0};
 
     if (size > 64)
     {
@@ -848,22 +853,17 @@ static int ipmb_block_read(int bus, uint8_t dev, uint16_t addr, uint8_t *rdata,
         return ONLP_STATUS_E_INTERNAL;
     }
 
-    sprintf(ipmi_cmd, "ipmitool raw 0x3c 0x01 %d %d %d %d", bus, dev, addr, size + 1);
-    if (vendor_system_call_get(ipmi_cmd, rv_char) != 0)
+    req[0] = bus;
+    req[1] = dev;
+    req[2] = addr;
+    req[3] = size + 1;
+    if (onlp_ipmi_raw(IPMB_NETFN_OEM, IPMB_CMD_I2C_READ, req, sizeof(req),
+                      rv_data, sizeof(rv_data), &len) < 0 || len < size + 1)
     {
-        AIM_LOG_ERROR("IPMITOOL command: \"%s\": Block read Failed.", ipmi_cmd);
+        AIM_LOG_ERROR("IPMB block read %d/0x%x/0x%x: Block read Failed.", bus, dev, addr);
         return ONLP_STATUS_E_INTERNAL;
     }
 
-    tmp = strtok(rv_char, delim);
-
-    while (tmp != NULL)
-    {
-        rv_data[idx] = strtol(tmp, NULL, 16);
-        tmp = strtok(NULL, delim);
-        idx++;
-    }
-
     for (idx = 0; idx < size; idx++)
         rdata[idx] = rv_data[idx + 1] & 0xff;
 
@@ -1210,6 +1210,75 @@ static int cypress_i2c_driver_init()
 /*
     IPMI BUS DRIVER START:
 */
+
+/*
+ * Serve the commands in bmc_ipmi_command_info through the onlplib
+ * IPMI client, producing the text ipmitool and the filter would have.
+ * Returns 1 if the command was handled.
+ */
+static int ipmi_get_inprocess(char *cmd, char *filter, char *data, uint32_t dlen)
+{
+    char name[32];
+    unsigned int fru;
+    double value;
+
+    data[0] = '\0';
+
+    if (!strncmp(cmd, "raw ", 4))
+    {
+        uint8_t req[16], rsp[32];
+        char *p = cmd + 4, *end;
+        int n = 0, i, len = 0;
+        unsigned long v;
+
+        /* netfn, cmd, then the request data. */
+        while (n < (int)sizeof(req))
+        {
+            v = strtoul(p, &end, 0);
+            if (end == p)
+                break;
+            req[n++] = v;
+            p = end;
+        }
+        if (n < 2)
+            return 0;
+
+        if (onlp_ipmi_raw(req[0], req[1], req + 2, n - 2, rsp, sizeof(rsp), &len) == 0)
+        {
+            for (i = 0; i < len && (uint32_t)(i + 1) * 3 < dlen; i++)
+                sprintf(data + i * 3, " %02x", rsp[i]);
+        }
+        return 1;
+    }
+
+    if (sscanf(cmd, "sensor get %31s", name) == 1 && strstr(filter, "Sensor Reading"))
+    {
+        if (onlp_ipmi_sensor_read_name(name, &value) == 0)
+            snprintf(data, dlen, "%d\n", (int)value);
+        return 1;
+    }
+
+    if (sscanf(cmd, "fru print %u", &fru) == 1)
+    {
+        onlp_ipmi_fru_product_field_t field;
+
+        if (strstr(filter, "Product Name"))
+            field = ONLP_IPMI_FRU_PRODUCT_NAME;
+        else if (strstr(filter, "Product Serial"))
+            field = ONLP_IPMI_FRU_PRODUCT_SERIAL;
+        else
+            return 0;
+
+        if (onlp_ipmi_fru_product_get(fru, field, data, dlen - 1) == 0)
+            strcat(data, "\n");
+        else
+            data[0] = '\0';
+        return 1;
+    }
+
+    return 0;
+}
+
 static int ipmi_get(int bus, char *cmd, char *filter, char *data, uint32_t dlen)
 {
     char sys_cmd[128];
@@ -1222,6 +1291,9 @@ static int ipmi_get(int bus, char *cmd, char *filter, char *data, uint32_t dlen)
     if (!cmd || !filter)
         return 0;
 
+    if (ipmi_get_inprocess(cmd, filter, data, dlen))
+        return 0;
+
     sprintf(sys_cmd, "ipmitool %s %s", cmd, filter);
     if (vendor_system_call_get(sys_cmd, rv_char) != 0)
         return 0;
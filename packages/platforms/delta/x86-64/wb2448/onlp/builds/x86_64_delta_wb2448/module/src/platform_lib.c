@@ -31,8 +31,18 @@
 #include <AIM/aim.h>
 #include <onlp/onlp.h>
 
+#include <onlplib/ipmi.h>
+
 #include "platform_lib.h"
 
+#define BMC_NETFN_OEM          0x38
+#define BMC_CMD_I2C_PROBE      0x1
+#define BMC_CMD_I2C_READ       0x2
+#define BMC_CMD_I2C_WRITE_BYTE 0x3
+#define BMC_CMD_I2C_WRITE_WORD 0x4
+#define BMC_CMD_I2C_WRITE_LONG 0x5
+#define BMC_CMD_FAN_SPEED_SET  0xB
+
 /****************************************************************************
  * FUNCTION    : ifnOS_LINUX_BmcI2CGet
  * DESCRIPTION : To read data through BMC I2C
@@ -46,52 +56,36 @@
  ****************************************************************************/
 INT4 ifnOS_LINUX_BmcI2CGet(UINT1 u1Bus, UINT1 u1Dev, UINT4 u4Addr, UINT1 u1AddrLen, UINT4 *pu4RetData, UINT1 u1DataLen)
 {
-    INT4  i      = 0;
-    INT4  i4Cnt  = 1;
-    INT4  i4Ret  = ONLP_STATUS_OK;
-    UINT4 u4Data = 0;
-    FILE  *pFd   = NULL;
-    UINT1 au1Temp[2]               = {0};
-    INT1  ai1Cmd [OS_MAX_MSG_SIZE] = {0};
-    INT1  ai1Data[OS_MAX_MSG_SIZE] = {0};
-    
-    sprintf(ai1Cmd, "ipmitool raw 0x38 0x2 %d %d %d %d", u1Bus, u1Dev, u4Addr, u1DataLen);
-    
-    pFd = popen(ai1Cmd, "r");
-    
-    if(pFd != NULL)
+    INT4  i       = 0;
+    INT4  i4Ret   = ONLP_STATUS_OK;
+    INT4  i4RspLen = 0;
+    UINT4 u4Data  = 0;
+    UINT1 au1Req[4];
+    UINT1 au1Rsp[OS_MAX_MSG_SIZE] = {0};
+
+    au1Req[0] = u1Bus;
+    au1Req[1] = u1Dev;
+    au1Req[2] = u4Addr;
+    au1Req[3] = u1DataLen;
+
+    i4Ret = onlp_ipmi_raw(BMC_NETFN_OEM, BMC_CMD_I2C_READ, au1Req, sizeof(au1Req),
+                          au1Rsp, sizeof(au1Rsp), &i4RspLen);
+
+    if ((i4Ret < 0) || (i4RspLen < u1DataLen))
     {
-        if (fgets(ai1Data, OS_MAX_MSG_SIZE, pFd) != NULL)
-        {
-            while (i < u1DataLen)
-            {
-                au1Temp[0] = ai1Data[i4Cnt++];
-                au1Temp[1] = ai1Data[i4Cnt++];
-        
-                i4Cnt++;
-        
-                u4Data <<= (i*8);
-                u4Data += (UINT1)MMI_XTOI(au1Temp);
-                
-                i++;
-            }
-        
-            *pu4RetData = u4Data;
-        }
-        else
-        {
-            i4Ret = ONLP_STATUS_E_INTERNAL;
-            AIM_LOG_ERROR("Command \"%s\": Get Data Failed (ret: %d)", ai1Cmd, i4Ret);
-        }
-        
-        pclose(pFd);
+        i4Ret = ONLP_STATUS_E_INTERNAL;
+        AIM_LOG_ERROR("BMC i2c read %d/0x%x/0x%x: Get Data Failed (ret: %d)", u1Bus, u1Dev, u4Addr, i4Ret);
+        return i4Ret;
     }
-    else
+
+    while (i < u1DataLen)
     {
-        i4Ret = ONLP_STATUS_E_INTERNAL;
-        AIM_LOG_ERROR("Execute command \"%s\" failed (ret: %d)", ai1Cmd, i4Ret);
+        u4Data = (u4Data << 8) | au1Rsp[i];
+        i++;
     }
-        
+
+    *pu4RetData = u4Data;
+
     return i4Ret;
 }
 
@@ -110,36 +104,44 @@ INT4 ifnOS_LINUX_BmcI2CGet(UINT1 u1Bus, UINT1 u1Dev, UINT4 u4Addr, UINT1 u1AddrL
 INT4 ifnOS_LINUX_BmcI2CSet(UINT1 u1Bus, UINT1 u1Dev, UINT4 u4Addr, UINT1 u1AddrLen, UINT4 u4Data, UINT1 u1DataLen)
 {
     INT4  i4Ret = ONLP_STATUS_OK;
-    FILE  *pFd  = NULL;
-    INT1  ai1Cmd[OS_MAX_MSG_SIZE] = {0};
-        
+    UINT1 u1Cmd = 0;
+    UINT1 au1Req[7];
+
+    au1Req[0] = u1Bus;
+    au1Req[1] = u1Dev;
+    au1Req[2] = u4Addr;
+
     switch (u1DataLen)
     {
         case 1:
-            sprintf(ai1Cmd, "ipmitool raw 0x38 0x3 %d %d %d %d", u1Bus, u1Dev, u4Addr, u4Data);
+            u1Cmd = BMC_CMD_I2C_WRITE_BYTE;
+            au1Req[3] = u4Data;
             break;
         case 2:
-            sprintf(ai1Cmd, "ipmitool raw 0x38 0x4 %d %d %d %d %d", u1Bus, u1Dev, u4Addr, ((u4Data&0xFF00)>>8), (u4Data&0xFF));
+            u1Cmd = BMC_CMD_I2C_WRITE_WORD;
+            au1Req[3] = (u4Data&0xFF00)>>8;
+            au1Req[4] = (u4Data&0xFF);
             break;
-        case 4: 
-            sprintf(ai1Cmd, "ipmitool raw 0x38 0x5 %d %d %d %d %d %d %d", u1Bus, u1Dev, u4Addr, ((u4Data&0xFF000000)>>24), ((u4Data&0xFF0000)>>16), ((u4Data&0xFF00)>>8), (u4Data&0xFF));
+        case 4:
+            u1Cmd = BMC_CMD_I2C_WRITE_LONG;
+            au1Req[3] = (u4Data&0xFF000000)>>24;
+            au1Req[4] = (u4Data&0xFF0000)>>16;
+            au1Req[5] = (u4Data&0xFF00)>>8;
+            au1Req[6] = (u4Data&0xFF);
             break;
         default:
             AIM_LOG_ERROR("ERR: Unsupported data length: %d", u1DataLen);
+            return ONLP_STATUS_E_PARAM;
     }
-    
-    pFd = popen(ai1Cmd, "r");
-    
-    if (pFd != NULL)
-    {
-        pclose(pFd);
-    }
-    else
+
+    i4Ret = onlp_ipmi_raw(BMC_NETFN_OEM, u1Cmd, au1Req, 3 + u1DataLen, NULL, 0, NULL);
+
+    if (i4Ret < 0)
     {
         i4Ret = ONLP_STATUS_E_INTERNAL;
-        AIM_LOG_ERROR("Execute command \"%s\" failed (ret: %d)", ai1Cmd, i4Ret);
+        AIM_LOG_ERROR("BMC i2c write %d/0x%x/0x%x failed (ret: %d)", u1Bus, u1Dev, u4Addr, i4Ret);
     }
-    
+
     return i4Ret;
 }
 
@@ -153,44 +155,27 @@ INT4 ifnOS_LINUX_BmcI2CSet(UINT1 u1Bus, UINT1 u1Dev, UINT4 u4Addr, UINT1 u1AddrL
  ****************************************************************************/
 INT4 ifnOS_LINUX_BmcI2CProbe(UINT1 u1Bus, UINT1 u1Dev)
 {
-    INT4  i4Ret  = ONLP_STATUS_OK;
-    INT4  i4Cnt  = 1; 
-    UINT4 u4Data = 0;
-    UINT1 au1Temp[2]               = {0};
-    INT1  ai1Cmd [OS_MAX_MSG_SIZE] = {0};
-    INT1  ai1Data[OS_MAX_MSG_SIZE] = {0};
-    FILE  *pFd = NULL;
-    
-    sprintf(ai1Cmd, "ipmitool raw 0x38 0x1 %d %d", u1Bus, u1Dev);
-    
-    pFd = popen(ai1Cmd, "r");
-    
-    if(pFd != NULL)
-    {
-        if (fgets(ai1Data, OS_MAX_MSG_SIZE, pFd) != NULL)
-        {        
-            au1Temp[0] = ai1Data[i4Cnt++];
-            au1Temp[1] = ai1Data[i4Cnt++];
-    
-            u4Data += (UINT1)MMI_XTOI(au1Temp);
-            
-            if (u4Data != 0x00)
-                AIM_LOG_ERROR("Probe failed (ret: %d)", i4Ret);
-        }
-        else
-        {
-            i4Ret = ONLP_STATUS_E_INTERNAL;     
-            AIM_LOG_ERROR("Command \"%s\": Get Data Failed (ret: %d)", ai1Cmd, i4Ret);
-        }
-        
-        pclose(pFd);
-    }
-    else
+    INT4  i4Ret    = ONLP_STATUS_OK;
+    INT4  i4RspLen = 0;
+    UINT1 au1Req[2];
+    UINT1 au1Rsp[OS_MAX_MSG_SIZE] = {0};
+
+    au1Req[0] = u1Bus;
+    au1Req[1] = u1Dev;
+
+    i4Ret = onlp_ipmi_raw(BMC_NETFN_OEM, BMC_CMD_I2C_PROBE, au1Req, sizeof(au1Req),
+                          au1Rsp, sizeof(au1Rsp), &i4RspLen);
+
+    if ((i4Ret < 0) || (i4RspLen < 1))
     {
         i4Ret = ONLP_STATUS_E_INTERNAL;
-        AIM_LOG_ERROR("Execute command \"%s\" failed (ret: %d)", ai1Cmd, i4Ret);
+        AIM_LOG_ERROR("BMC i2c probe %d/0x%x: Get Data Failed (ret: %d)", u1Bus, u1Dev, i4Ret);
+        return i4Ret;
     }
-    
+
+    if (au1Rsp[0] != 0x00)
+        AIM_LOG_ERROR("Probe failed (ret: %d)", i4Ret);
+
     return i4Ret;
 }
 
@@ -204,44 +189,20 @@ INT4 ifnOS_LINUX_BmcI2CProbe(UINT1 u1Bus, UINT1 u1Dev)
  ****************************************************************************/
 INT4 ifnBmcFanSpeedGet(INT1 *pi1FanName, UINT4 *pu4RetData)
 {
-    INT4  i4Ret  = ONLP_STATUS_OK;
-    UINT4 u4Data = 0;
-    INT1  ai1Cmd [OS_MAX_MSG_SIZE] = {0};
-    INT1  au1Data[OS_MAX_MSG_SIZE] = {0};
-    INT1  *pui1Temp = NULL;
-    FILE  *pFd      = NULL;
-    
-    sprintf(ai1Cmd, "ipmitool sdr | grep %s", pi1FanName);
-    
-    pFd = popen(ai1Cmd, "r");
-    
-    if(pFd != NULL)
-    {
-        if (fgets(au1Data, OS_MAX_MSG_SIZE, pFd) != NULL)
-        {
-            pui1Temp = strchr(au1Data, '|');
-        
-            do 
-            {
-                u4Data += strtol(pui1Temp, &pui1Temp, 10); 
-            }while (*pui1Temp++);
-            
-            *pu4RetData = u4Data;
-        }
-        else
-        {
-            i4Ret = ONLP_STATUS_E_INTERNAL;
-            AIM_LOG_ERROR("Command \"%s\": Get Data Failed (ret: %d)", ai1Cmd, i4Ret);
-        }
-        
-        pclose(pFd);
-    }
-    else
+    INT4   i4Ret = ONLP_STATUS_OK;
+    double dValue = 0;
+
+    i4Ret = onlp_ipmi_sensor_read_name((const char*)pi1FanName, &dValue);
+
+    if (i4Ret < 0)
     {
         i4Ret = ONLP_STATUS_E_INTERNAL;
-        AIM_LOG_ERROR("Execute command \"%s\" failed (ret: %d)", ai1Cmd, i4Ret);
+        AIM_LOG_ERROR("BMC sensor %s: Get Data Failed (ret: %d)", pi1FanName, i4Ret);
+        return i4Ret;
     }
-        
+
+    *pu4RetData = (UINT4)dValue;
+
     return i4Ret;
 }
 
@@ -255,24 +216,20 @@ INT4 ifnBmcFanSpeedGet(INT1 *pi1FanName, UINT4 *pu4RetData)
  ****************************************************************************/
 INT4 ifnBmcFanSpeedSet(UINT4 u4FanNumber, UINT4 u4Percentage)
 {
-    INT1  ai1Cmd[OS_MAX_MSG_SIZE] = {0};
     INT4  i4Ret = ONLP_STATUS_OK;
-    FILE  *pFd  = NULL;
-    
-    sprintf(ai1Cmd, "ipmitool raw 0x38 0xB %d %d", u4FanNumber, u4Percentage);
-    
-    pFd = popen(ai1Cmd, "r");
-    
-    if (pFd != NULL)
-    {
-        pclose(pFd);
-    }
-    else
+    UINT1 au1Req[2];
+
+    au1Req[0] = u4FanNumber;
+    au1Req[1] = u4Percentage;
+
+    i4Ret = onlp_ipmi_raw(BMC_NETFN_OEM, BMC_CMD_FAN_SPEED_SET, au1Req, sizeof(au1Req), NULL, 0, NULL);
+
+    if (i4Ret < 0)
     {
         i4Ret = ONLP_STATUS_E_INTERNAL;
-        AIM_LOG_ERROR("Execute command \"%s\" failed (ret: %d)", ai1Cmd, i4Ret);
+        AIM_LOG_ERROR("BMC fan %d speed set failed (ret: %d)", u4FanNumber, i4Ret);
     }
-    
+
     return i4Ret;
 }
 
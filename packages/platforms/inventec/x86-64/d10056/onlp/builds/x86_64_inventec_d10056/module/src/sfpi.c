@@ -230,7 +230,7 @@ onlp_sfpi_eeprom_read(int port, uint8_t data[256])
     int sts;
     int bus = onlp_sfpi_port2chan(port);
 
-    sts = onlp_i2c_read(bus, QSFP_DEV_ADDR, 0, 256, data, ONLP_I2C_F_FORCE);
+    sts = onlp_i2c_read(bus, QSFP_DEV_ADDR, 0, 256, data, ONLP_I2C_F_FORCE | ONLP_I2C_F_USE_RDWR_READ);
     if(sts < 0) {
         AIM_LOG_ERROR("Unable to read eeprom from port(%d)\r\n", port);
         return ONLP_STATUS_E_MISSING;
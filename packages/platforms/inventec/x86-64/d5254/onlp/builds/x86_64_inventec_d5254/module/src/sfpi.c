@@ -232,7 +232,7 @@ onlp_sfpi_eeprom_read(int port, uint8_t data[256])
     if(onlp_sfpi_port_type(port) < 0) { return ONLP_STATUS_E_INVALID; }
     int sts;
     int bus = FRONT_PORT_TO_MUX_INDEX(port);
-    sts = onlp_i2c_read(bus, QSFP_DEV_ADDR, 0, 256, data, ONLP_I2C_F_FORCE);
+    sts = onlp_i2c_read(bus, QSFP_DEV_ADDR, 0, 256, data, ONLP_I2C_F_FORCE | ONLP_I2C_F_USE_RDWR_READ);
     if(sts < 0) {
         AIM_LOG_ERROR("Unable to read eeprom from port(%d)\r\n", port);
         return ONLP_STATUS_E_MISSING;
@@ -184,7 +184,7 @@ onlp_sfpi_eeprom_read(int port, uint8_t data[256])
 
     memset(data, 0, 256);
     /* Read eeprom information into data[] */
-    if (onlp_i2c_read(bus, 0x50, 0x00, 256, data, 0) != 0)
+    if (onlp_i2c_read(bus, 0x50, 0x00, 256, data, ONLP_I2C_F_USE_RDWR_READ) != 0)
     {
         AIM_LOG_ERROR("Unable to read eeprom from port(%d)\r\n", port);
         return ONLP_STATUS_E_INTERNAL;
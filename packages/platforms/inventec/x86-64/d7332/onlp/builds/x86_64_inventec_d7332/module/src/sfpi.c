@@ -170,7 +170,7 @@ onlp_sfpi_eeprom_read(int port, uint8_t data[256])
     if( succeed&&(rv==ONLP_STATUS_OK) ) {
         rv=onlp_file_write_int(0,INV_SFP_PREFIX"port%d/page",port_id);
         if(rv==ONLP_STATUS_OK) {
-            rv = onlp_i2c_block_read(bus, QSFP_DEV_ADDR, 0, 256, data, ONLP_I2C_F_FORCE);
+            rv = onlp_i2c_block_read(bus, QSFP_DEV_ADDR, 0, 256, data, ONLP_I2C_F_FORCE | ONLP_I2C_F_USE_RDWR_READ);
         } else {
             AIM_LOG_ERROR("Unable to switch page from port(%d)\r\n", port_id);
         }
@@ -124,6 +124,16 @@
 #define ONLPSIM_CONFIG_SFP_COUNT 0
 #endif
 
+/**
+ * ONLPSIM_CONFIG_STATE_FILE
+ *
+ * Simulated platform state file. Overridden by the ONLPSIM_STATE environment variable. */
+
+
+#ifndef ONLPSIM_CONFIG_STATE_FILE
+#define ONLPSIM_CONFIG_STATE_FILE "/var/run/onlpsim.state"
+#endif
+
 
 
 /**
@@ -33,3 +33,56 @@ onlp_fani_init(void)
 {
     return ONLP_STATUS_OK;
 }
+
+int
+onlp_fani_info_get(onlp_oid_t id, onlp_fan_info_t* info)
+{
+    onlpsim_state_t* state;
+    onlpsim_fan_t* f;
+    int i, rv;
+
+    if((state = onlpsim_oid_state_get(id, &i)) == NULL) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_FAN)) < 0) {
+        return rv;
+    }
+
+    f = state->fans + i;
+    memset(info, 0, sizeof(*info));
+    info->hdr.id = id;
+    snprintf(info->hdr.description, sizeof(info->hdr.description),
+             "Simulated Fan %d", i+1);
+    info->status = f->status;
+    info->caps = ONLP_FAN_CAPS_F2B | ONLP_FAN_CAPS_GET_RPM |
+        ONLP_FAN_CAPS_GET_PERCENTAGE | ONLP_FAN_CAPS_SET_PERCENTAGE;
+    info->rpm = f->rpm;
+    info->percentage = f->percentage;
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_fani_percentage_set(onlp_oid_t id, int p)
+{
+    onlpsim_state_t* state;
+    onlpsim_fan_t* f;
+    int i, rv;
+
+    if((state = onlpsim_oid_state_get(id, &i)) == NULL) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    if(p < 0 || p > 100) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_FAN)) < 0) {
+        return rv;
+    }
+
+    f = state->fans + i;
+    f->percentage = p;
+    if(!(f->status & ONLP_FAN_STATUS_FAILED)) {
+        f->rpm = f->max_rpm * p / 100;
+    }
+    state->generation++;
+    return ONLP_STATUS_OK;
+}
@@ -29,3 +29,62 @@ onlp_ledi_init(void)
 {
     return ONLP_STATUS_OK;
 }
+
+int
+onlp_ledi_info_get(onlp_oid_t id, onlp_led_info_t* info)
+{
+    onlpsim_state_t* state;
+    onlpsim_led_t* l;
+    int i, rv;
+
+    if((state = onlpsim_oid_state_get(id, &i)) == NULL) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_LED)) < 0) {
+        return rv;
+    }
+
+    l = state->leds + i;
+    memset(info, 0, sizeof(*info));
+    info->hdr.id = id;
+    snprintf(info->hdr.description, sizeof(info->hdr.description),
+             "Simulated LED %d", i+1);
+    info->status = l->status;
+    info->caps = ONLP_LED_CAPS_ON_OFF | ONLP_LED_CAPS_GREEN |
+        ONLP_LED_CAPS_GREEN_BLINKING | ONLP_LED_CAPS_ORANGE |
+        ONLP_LED_CAPS_ORANGE_BLINKING;
+    info->mode = l->mode;
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_ledi_mode_set(onlp_oid_t id, onlp_led_mode_t mode)
+{
+    onlpsim_state_t* state;
+    onlpsim_led_t* l;
+    int i, rv;
+
+    if((state = onlpsim_oid_state_get(id, &i)) == NULL) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_LED)) < 0) {
+        return rv;
+    }
+
+    l = state->leds + i;
+    l->mode = mode;
+    if(mode == ONLP_LED_MODE_OFF) {
+        l->status &= ~ONLP_LED_STATUS_ON;
+    }
+    else {
+        l->status |= ONLP_LED_STATUS_ON;
+    }
+    state->generation++;
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_ledi_set(onlp_oid_t id, int on_or_off)
+{
+    return onlp_ledi_mode_set(id, on_or_off ? ONLP_LED_MODE_GREEN : ONLP_LED_MODE_OFF);
+}
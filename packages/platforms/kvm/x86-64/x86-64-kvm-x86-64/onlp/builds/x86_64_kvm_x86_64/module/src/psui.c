@@ -30,3 +30,42 @@ onlp_psui_init(void)
 {
     return ONLP_STATUS_OK;
 }
+
+int
+onlp_psui_info_get(onlp_oid_t id, onlp_psu_info_t* info)
+{
+    onlpsim_state_t* state;
+    onlpsim_psu_t* p;
+    int i, rv;
+
+    if((state = onlpsim_oid_state_get(id, &i)) == NULL) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_PSU)) < 0) {
+        return rv;
+    }
+
+    p = state->psus + i;
+    memset(info, 0, sizeof(*info));
+    info->hdr.id = id;
+    snprintf(info->hdr.description, sizeof(info->hdr.description),
+             "Simulated PSU %d", i+1);
+    info->status = p->status;
+    if(!(p->status & ONLP_PSU_STATUS_PRESENT)) {
+        return ONLP_STATUS_OK;
+    }
+
+    aim_strlcpy(info->model, p->model, sizeof(info->model));
+    aim_strlcpy(info->serial, p->serial, sizeof(info->serial));
+    info->caps = ONLP_PSU_CAPS_AC |
+        ONLP_PSU_CAPS_VIN | ONLP_PSU_CAPS_VOUT |
+        ONLP_PSU_CAPS_IIN | ONLP_PSU_CAPS_IOUT |
+        ONLP_PSU_CAPS_PIN | ONLP_PSU_CAPS_POUT;
+    info->mvin = p->mvin;
+    info->mvout = p->mvout;
+    info->miin = p->miin;
+    info->miout = p->miout;
+    info->mpin = p->mpin;
+    info->mpout = p->mpout;
+    return ONLP_STATUS_OK;
+}
@@ -23,10 +23,25 @@
  ***********************************************************/
 #include <onlp/platformi/sfpi.h>
 #include <x86_64_kvm_x86_64/x86_64_kvm_x86_64_config.h>
+#include "x86_64_kvm_x86_64_int.h"
 #include "x86_64_kvm_x86_64_log.h"
 
 static int sfp_count__ = ONLPSIM_CONFIG_SFP_COUNT;
 
+/*
+ * Returns the simulated state for the given port, or NULL if there
+ * is no state file or the port is not simulated.
+ */
+static onlpsim_state_t*
+sfp_state_get__(int port)
+{
+    onlpsim_state_t* state = onlpsim_state_get();
+    if(state == NULL || port < 0 || port >= state->sfp_count) {
+        return NULL;
+    }
+    return state;
+}
+
 int
 onlp_sfpi_init(void)
 {
@@ -36,8 +51,10 @@ onlp_sfpi_init(void)
 int
 onlp_sfpi_bitmap_get(onlp_sfp_bitmap_t* bmap)
 {
-    int p;
-    for(p = 0; p < sfp_count__; p++) {
+    onlpsim_state_t* state = onlpsim_state_get();
+    int p, count = state ? state->sfp_count : sfp_count__;
+
+    for(p = 0; p < count; p++) {
         AIM_BITMAP_SET(bmap, p);
     }
     return ONLP_STATUS_OK;
@@ -46,13 +63,91 @@ onlp_sfpi_bitmap_get(onlp_sfp_bitmap_t* bmap)
 int
 onlp_sfpi_is_present(int port)
 {
-    return 0;
+    onlpsim_state_t* state;
+    int rv;
+
+    if((state = sfp_state_get__(port)) == NULL) {
+        return 0;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_SFP_PRESENCE)) < 0) {
+        return rv;
+    }
+    return state->sfps[port].present;
 }
 
 int
 onlp_sfpi_presence_bitmap_get(onlp_sfp_bitmap_t* dst)
 {
+    onlpsim_state_t* state = onlpsim_state_get();
+    int p, rv;
+
     AIM_BITMAP_CLR_ALL(dst);
+    if(state == NULL) {
+        return ONLP_STATUS_OK;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_SFP_PRESENCE)) < 0) {
+        return rv;
+    }
+
+    for(p = 0; p < state->sfp_count; p++) {
+        AIM_BITMAP_MOD(dst, p, state->sfps[p].present);
+    }
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_rx_los_bitmap_get(onlp_sfp_bitmap_t* dst)
+{
+    onlpsim_state_t* state = onlpsim_state_get();
+    int p, rv;
+
+    AIM_BITMAP_CLR_ALL(dst);
+    if(state == NULL) {
+        return ONLP_STATUS_OK;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_SFP_PRESENCE)) < 0) {
+        return rv;
+    }
+
+    for(p = 0; p < state->sfp_count; p++) {
+        AIM_BITMAP_MOD(dst, p, state->sfps[p].present && state->sfps[p].rx_los);
+    }
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_status_bitmaps_get(onlp_sfp_status_bitmaps_t* dst)
+{
+    onlpsim_state_t* state = onlpsim_state_get();
+    int p, rv;
+
+    if(state == NULL) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_SFP_PRESENCE)) < 0) {
+        return rv;
+    }
+
+    for(p = 0; p < state->sfp_count; p++) {
+        onlpsim_sfp_t* sfp = state->sfps + p;
+        if(!sfp->present) {
+            continue;
+        }
+        AIM_BITMAP_SET(&dst->present, p);
+
+#define SFP_STATUS_SET(_control, _field)                                \
+        do {                                                            \
+            AIM_BITMAP_SET(&dst->valid[ONLP_SFP_CONTROL_##_control], p); \
+            AIM_BITMAP_MOD(&dst->value[ONLP_SFP_CONTROL_##_control], p, sfp->_field); \
+        } while(0)
+
+        SFP_STATUS_SET(RX_LOS, rx_los);
+        SFP_STATUS_SET(TX_FAULT, tx_fault);
+        SFP_STATUS_SET(TX_DISABLE, tx_disable);
+        SFP_STATUS_SET(LP_MODE, lp_mode);
+        SFP_STATUS_SET(RESET, reset);
+#undef SFP_STATUS_SET
+    }
     return ONLP_STATUS_OK;
 }
 
@@ -63,7 +158,133 @@ onlp_sfpi_presence_bitmap_get(onlp_sfp_bitmap_t* dst)
 int
 onlp_sfpi_eeprom_read(int port, uint8_t data[256])
 {
-    return ONLP_STATUS_E_MISSING;
+    onlpsim_state_t* state;
+    int rv;
+
+    if((state = sfp_state_get__(port)) == NULL || !state->sfps[port].present) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_SFP_EEPROM)) < 0) {
+        return rv;
+    }
+    memcpy(data, state->sfps[port].a0, 256);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_dom_read(int port, uint8_t data[256])
+{
+    onlpsim_state_t* state;
+    int rv;
+
+    if((state = sfp_state_get__(port)) == NULL || !state->sfps[port].present) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_SFP_EEPROM)) < 0) {
+        return rv;
+    }
+    memcpy(data, state->sfps[port].a2, 256);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_dev_read(int port, uint8_t devaddr, uint8_t addr, uint8_t* rdata, int size)
+{
+    onlpsim_state_t* state;
+    uint8_t* src;
+    int rv;
+
+    if((state = sfp_state_get__(port)) == NULL || !state->sfps[port].present) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    if(devaddr != 0x50 && devaddr != 0x51) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    if(size < 0 || addr + size > 256) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_SFP_EEPROM)) < 0) {
+        return rv;
+    }
+
+    src = (devaddr == 0x50) ? state->sfps[port].a0 : state->sfps[port].a2;
+    memcpy(rdata, src + addr, size);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_dev_readb(int port, uint8_t devaddr, uint8_t addr)
+{
+    uint8_t b;
+    int rv = onlp_sfpi_dev_read(port, devaddr, addr, &b, 1);
+    return (rv < 0) ? rv : b;
+}
+
+static uint8_t*
+sfp_control_field__(onlpsim_sfp_t* sfp, onlp_sfp_control_t control)
+{
+    switch(control)
+        {
+        case ONLP_SFP_CONTROL_RESET:
+        case ONLP_SFP_CONTROL_RESET_STATE: return &sfp->reset;
+        case ONLP_SFP_CONTROL_RX_LOS: return &sfp->rx_los;
+        case ONLP_SFP_CONTROL_TX_FAULT: return &sfp->tx_fault;
+        case ONLP_SFP_CONTROL_TX_DISABLE: return &sfp->tx_disable;
+        case ONLP_SFP_CONTROL_LP_MODE: return &sfp->lp_mode;
+        default: return NULL;
+        }
+}
+
+int
+onlp_sfpi_control_supported(int port, onlp_sfp_control_t control, int* rv)
+{
+    onlpsim_sfp_t dummy;
+    *rv = (sfp_state_get__(port) && sfp_control_field__(&dummy, control)) ? 1 : 0;
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_control_get(int port, onlp_sfp_control_t control, int* value)
+{
+    onlpsim_state_t* state;
+    uint8_t* field;
+    int rv;
+
+    if((state = sfp_state_get__(port)) == NULL) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    if((field = sfp_control_field__(state->sfps + port, control)) == NULL) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_SFP_CONTROL)) < 0) {
+        return rv;
+    }
+    *value = *field;
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_control_set(int port, onlp_sfp_control_t control, int value)
+{
+    onlpsim_state_t* state;
+    uint8_t* field;
+    int rv;
+
+    if((state = sfp_state_get__(port)) == NULL) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    /* Only the module outputs are read-only. */
+    if(control == ONLP_SFP_CONTROL_RX_LOS || control == ONLP_SFP_CONTROL_TX_FAULT ||
+       (field = sfp_control_field__(state->sfps + port, control)) == NULL) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_SFP_CONTROL)) < 0) {
+        return rv;
+    }
+    *field = !!value;
+    state->generation++;
+    return ONLP_STATUS_OK;
 }
 
 /*
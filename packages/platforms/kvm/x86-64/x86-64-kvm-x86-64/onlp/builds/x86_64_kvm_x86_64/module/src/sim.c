@@ -0,0 +1,577 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Simulated Platform State.
+ *
+ ***********************************************************/
+#include <onlp/onlp.h>
+#include <onlp/oids.h>
+#include <onlp/thermal.h>
+#include <onlp/fan.h>
+#include <onlp/psu.h>
+#include <onlp/led.h>
+#include <AIM/aim.h>
+#include <OS/os_time.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "x86_64_kvm_x86_64_int.h"
+#include "x86_64_kvm_x86_64_log.h"
+
+static pthread_mutex_t state_lock__ = PTHREAD_MUTEX_INITIALIZER;
+static onlpsim_state_t* state__ = NULL;
+static uint64_t state_retry__ = 0;
+
+/* How often to look for a missing state file (usecs). */
+#define ONLPSIM_STATE_RETRY_US 1000000
+
+static const char*
+onlpsim_state_file__(void)
+{
+    const char* path = getenv("ONLPSIM_STATE");
+    return (path && *path) ? path : ONLPSIM_CONFIG_STATE_FILE;
+}
+
+static onlpsim_state_t*
+onlpsim_state_map__(const char* path)
+{
+    onlpsim_state_t* state;
+    struct stat st;
+    int fd;
+
+    if((fd = open(path, O_RDWR)) < 0) {
+        return NULL;
+    }
+
+    if(fstat(fd, &st) < 0 || st.st_size != sizeof(onlpsim_state_t)) {
+        AIM_LOG_ERROR("%s: unexpected state file size.", path);
+        close(fd);
+        return NULL;
+    }
+
+    state = mmap(NULL, sizeof(*state), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if(state == MAP_FAILED) {
+        AIM_LOG_ERROR("%s: mmap(): %s", path, strerror(errno));
+        return NULL;
+    }
+
+    if(state->magic != ONLPSIM_STATE_MAGIC ||
+       state->version != ONLPSIM_STATE_VERSION ||
+       state->size != sizeof(*state)) {
+        AIM_LOG_ERROR("%s: not a version %d state file.", path, ONLPSIM_STATE_VERSION);
+        munmap(state, sizeof(*state));
+        return NULL;
+    }
+
+    return state;
+}
+
+onlpsim_state_t*
+onlpsim_state_get(void)
+{
+    onlpsim_state_t* state;
+
+    pthread_mutex_lock(&state_lock__);
+
+    /*
+     * 'init' replaces the state file and clears the magic of the
+     * old one, so a cleared magic means our mapping is stale.
+     */
+    if(state__ && state__->magic != ONLPSIM_STATE_MAGIC) {
+        munmap(state__, sizeof(*state__));
+        state__ = NULL;
+        state_retry__ = 0;
+    }
+
+    /* A missing state file is looked for again periodically. */
+    if(state__ == NULL && os_time_monotonic() >= state_retry__) {
+        state__ = onlpsim_state_map__(onlpsim_state_file__());
+        state_retry__ = os_time_monotonic() + ONLPSIM_STATE_RETRY_US;
+    }
+
+    state = state__;
+    pthread_mutex_unlock(&state_lock__);
+    return state;
+}
+
+int
+onlpsim_op(onlpsim_state_t* state, onlpsim_op_t op)
+{
+    static __thread unsigned int seed = 0;
+    onlpsim_op_config_t* c = state->ops + op;
+    uint32_t delay = c->latency_us;
+
+    if(seed == 0) {
+        seed = (unsigned int)time(NULL) ^ (unsigned int)(uintptr_t)&seed;
+    }
+
+    if(c->jitter_us) {
+        delay += rand_r(&seed) % (c->jitter_us + 1);
+    }
+    if(delay) {
+        usleep(delay);
+    }
+
+    if(c->error_ppm && (uint32_t)(rand_r(&seed) % 1000000) < c->error_ppm) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return ONLP_STATUS_OK;
+}
+
+onlpsim_state_t*
+onlpsim_oid_state_get(onlp_oid_t id, int* index)
+{
+    onlpsim_state_t* state = onlpsim_state_get();
+    int i = ONLP_OID_ID_GET(id) - 1;
+    uint32_t count;
+
+    if(state == NULL) {
+        return NULL;
+    }
+
+    switch(ONLP_OID_TYPE_GET(id))
+        {
+        case ONLP_OID_TYPE_THERMAL: count = state->thermal_count; break;
+        case ONLP_OID_TYPE_FAN: count = state->fan_count; break;
+        case ONLP_OID_TYPE_PSU: count = state->psu_count; break;
+        case ONLP_OID_TYPE_LED: count = state->led_count; break;
+        default: return NULL;
+        }
+
+    if(i < 0 || i >= count) {
+        return NULL;
+    }
+
+    *index = i;
+    return state;
+}
+
+
+/************************************************************
+ *
+ * State Creation and Scripting
+ *
+ ***********************************************************/
+
+static void
+onlpsim_sfp_image__(onlpsim_sfp_t* sfp, int port)
+{
+    uint8_t* a0 = sfp->a0;
+    uint8_t sum;
+    int i;
+
+    /* SFF-8472 10GBASE-SR module */
+    memset(a0, 0, sizeof(sfp->a0));
+    a0[0] = 0x03;    /* SFP/SFP+ */
+    a0[1] = 0x04;
+    a0[2] = 0x07;    /* LC */
+    a0[3] = 0x10;    /* 10GBASE-SR */
+    a0[11] = 0x06;   /* 64B/66B */
+    a0[12] = 0x67;   /* 10.3 Gbps */
+    a0[17] = 0x08;   /* 80m OM2 */
+    a0[18] = 0x03;   /* 30m OM1 */
+    memset(a0 + 20, ' ', 16);
+    memcpy(a0 + 20, "ONLPSIM", 7);
+    memset(a0 + 40, ' ', 16);
+    memcpy(a0 + 40, "SIM-SFP-10G-SR", 14);
+    memset(a0 + 56, ' ', 4);
+    a0[60] = 0x03;   /* 850 nm */
+    a0[61] = 0x52;
+    for(sum = 0, i = 0; i < 63; i++) {
+        sum += a0[i];
+    }
+    a0[63] = sum;
+
+    memset(a0 + 68, ' ', 16);
+    snprintf((char*)a0 + 68, 16, "SIM%05d", port);
+    a0[68 + strlen((char*)a0 + 68)] = ' ';
+    memcpy(a0 + 84, "20240101  ", 8);
+    a0[92] = 0x68;   /* DOM, internally calibrated */
+    a0[94] = 0x08;   /* SFF-8472 rev 12.0 */
+    for(sum = 0, i = 64; i < 95; i++) {
+        sum += a0[i];
+    }
+    a0[95] = sum;
+
+    memset(sfp->a2, 0, sizeof(sfp->a2));
+}
+
+static int
+onlpsim_state_create__(const char* path, int thermals, int fans,
+                       int psus, int leds, int sfps)
+{
+    onlpsim_state_t* state;
+    onlpsim_state_t* old;
+    char tmp[PATH_MAX];
+    int fd, i;
+
+    if(thermals < 0 || thermals > ONLPSIM_THERMAL_MAX ||
+       fans < 0 || fans > ONLPSIM_FAN_MAX ||
+       psus < 0 || psus > ONLPSIM_PSU_MAX ||
+       leds < 0 || leds > ONLPSIM_LED_MAX ||
+       sfps < 0 || sfps > ONLPSIM_SFP_MAX) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    state = aim_zmalloc(sizeof(*state));
+    state->magic = ONLPSIM_STATE_MAGIC;
+    state->version = ONLPSIM_STATE_VERSION;
+    state->size = sizeof(*state);
+    state->thermal_count = thermals;
+    state->fan_count = fans;
+    state->psu_count = psus;
+    state->led_count = leds;
+    state->sfp_count = sfps;
+
+    for(i = 0; i < thermals; i++) {
+        state->thermals[i].status = ONLP_THERMAL_STATUS_PRESENT;
+        state->thermals[i].mcelsius = 35000 + i*1000;
+        state->thermals[i].warning = 80000;
+        state->thermals[i].error = 90000;
+        state->thermals[i].shutdown = 100000;
+    }
+    for(i = 0; i < fans; i++) {
+        state->fans[i].status = ONLP_FAN_STATUS_PRESENT | ONLP_FAN_STATUS_F2B;
+        state->fans[i].max_rpm = 18000;
+        state->fans[i].percentage = 50;
+        state->fans[i].rpm = 9000;
+    }
+    for(i = 0; i < psus; i++) {
+        state->psus[i].status = ONLP_PSU_STATUS_PRESENT;
+        snprintf(state->psus[i].model, sizeof(state->psus[i].model), "SIM-PSU-650");
+        snprintf(state->psus[i].serial, sizeof(state->psus[i].serial), "SIMPSU%02d", i+1);
+        state->psus[i].mvin = 230000;
+        state->psus[i].mvout = 12000;
+        state->psus[i].miin = 1000;
+        state->psus[i].miout = 18000;
+        state->psus[i].mpin = 230000;
+        state->psus[i].mpout = 216000;
+    }
+    for(i = 0; i < leds; i++) {
+        state->leds[i].status = ONLP_LED_STATUS_PRESENT | ONLP_LED_STATUS_ON;
+        state->leds[i].mode = ONLP_LED_MODE_GREEN;
+    }
+
+    /*
+     * Other processes may have the current file mapped, so it is
+     * never truncated. The new state is written to a temporary
+     * file and renamed into place.
+     */
+    snprintf(tmp, sizeof(tmp), "%s.%d", path, (int)getpid());
+    fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) {
+        AIM_LOG_ERROR("%s: open(): %s", tmp, strerror(errno));
+        aim_free(state);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    i = write(fd, state, sizeof(*state));
+    close(fd);
+    aim_free(state);
+
+    if(i != sizeof(*state)) {
+        AIM_LOG_ERROR("%s: write failed.", tmp);
+        unlink(tmp);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    pthread_mutex_lock(&state_lock__);
+
+    old = onlpsim_state_map__(path);
+    if(rename(tmp, path) < 0) {
+        AIM_LOG_ERROR("%s: rename(): %s", path, strerror(errno));
+        unlink(tmp);
+        if(old) {
+            munmap(old, sizeof(*old));
+        }
+        pthread_mutex_unlock(&state_lock__);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    /* Tell the processes still mapping the old file to remap. */
+    if(old) {
+        old->magic = 0;
+        munmap(old, sizeof(*old));
+    }
+    if(state__) {
+        munmap(state__, sizeof(*state__));
+    }
+    state__ = onlpsim_state_map__(path);
+    state_retry__ = os_time_monotonic() + ONLPSIM_STATE_RETRY_US;
+    i = state__ ? ONLP_STATUS_OK : ONLP_STATUS_E_INTERNAL;
+
+    pthread_mutex_unlock(&state_lock__);
+    return i;
+}
+
+static int
+onlpsim_file_read__(const char* path, uint8_t* data, int size)
+{
+    int fd, rv;
+
+    if((fd = open(path, O_RDONLY)) < 0) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    memset(data, 0, size);
+    rv = read(fd, data, size);
+    close(fd);
+    return (rv < 0) ? ONLP_STATUS_E_INTERNAL : ONLP_STATUS_OK;
+}
+
+static const char* onlpsim_op_names__[ONLPSIM_OP_COUNT] = {
+    "sys", "thermal", "fan", "psu", "led",
+    "sfp-presence", "sfp-eeprom", "sfp-control",
+};
+
+static int
+onlpsim_op_lookup__(const char* name)
+{
+    int i;
+    for(i = 0; i < ONLPSIM_OP_COUNT; i++) {
+        if(!strcmp(name, onlpsim_op_names__[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void
+onlpsim_show__(aim_pvs_t* pvs, onlpsim_state_t* state)
+{
+    int i;
+
+    aim_printf(pvs, "state: %s (generation %u)\n",
+               onlpsim_state_file__(), state->generation);
+    aim_printf(pvs, "thermals %u fans %u psus %u leds %u sfps %u\n",
+               state->thermal_count, state->fan_count, state->psu_count,
+               state->led_count, state->sfp_count);
+    for(i = 0; i < ONLPSIM_OP_COUNT; i++) {
+        onlpsim_op_config_t* c = state->ops + i;
+        aim_printf(pvs, "  %-12s latency %uus jitter %uus errors %uppm\n",
+                   onlpsim_op_names__[i], c->latency_us, c->jitter_us, c->error_ppm);
+    }
+    for(i = 0; i < state->thermal_count; i++) {
+        aim_printf(pvs, "  thermal %d: %d mC status 0x%x\n", i+1,
+                   state->thermals[i].mcelsius, state->thermals[i].status);
+    }
+    for(i = 0; i < state->fan_count; i++) {
+        aim_printf(pvs, "  fan %d: %d rpm %d%% status 0x%x\n", i+1,
+                   state->fans[i].rpm, state->fans[i].percentage, state->fans[i].status);
+    }
+    for(i = 0; i < state->psu_count; i++) {
+        aim_printf(pvs, "  psu %d: %d mW status 0x%x\n", i+1,
+                   state->psus[i].mpout, state->psus[i].status);
+    }
+    for(i = 0; i < state->led_count; i++) {
+        aim_printf(pvs, "  led %d: %{onlp_led_mode} status 0x%x\n", i+1,
+                   state->leds[i].mode, state->leds[i].status);
+    }
+    for(i = 0; i < state->sfp_count; i++) {
+        if(state->sfps[i].present) {
+            aim_printf(pvs, "  sfp %d: present rx_los %d tx_fault %d tx_disable %d lp_mode %d\n",
+                       i, state->sfps[i].rx_los, state->sfps[i].tx_fault,
+                       state->sfps[i].tx_disable, state->sfps[i].lp_mode);
+        }
+    }
+}
+
+#define ARGC_CHECK(_n)                                          \
+    do {                                                        \
+        if(argc < (_n)) {                                       \
+            return ONLP_STATUS_E_PARAM;                         \
+        }                                                       \
+    } while(0)
+
+#define INDEX_CHECK(_i, _count)                                 \
+    do {                                                        \
+        if((_i) < 0 || (_i) >= (_count)) {                      \
+            aim_printf(pvs, "index %d out of range.\n", _i);    \
+            return ONLP_STATUS_E_PARAM;                         \
+        }                                                       \
+    } while(0)
+
+static int
+onlpsim_command__(aim_pvs_t* pvs, int argc, char** argv)
+{
+    onlpsim_state_t* state;
+    const char* cmd = argv[0];
+
+    if(!strcmp(cmd, "init")) {
+        return onlpsim_state_create__(onlpsim_state_file__(),
+                                      (argc > 1) ? atoi(argv[1]) : 4,
+                                      (argc > 2) ? atoi(argv[2]) : 4,
+                                      (argc > 3) ? atoi(argv[3]) : 2,
+                                      (argc > 4) ? atoi(argv[4]) : 4,
+                                      (argc > 5) ? atoi(argv[5]) : 32);
+    }
+
+    if((state = onlpsim_state_get()) == NULL) {
+        aim_printf(pvs, "No state file (%s). Use 'init' first.\n",
+                   onlpsim_state_file__());
+        return ONLP_STATUS_E_MISSING;
+    }
+
+    if(!strcmp(cmd, "show")) {
+        onlpsim_show__(pvs, state);
+        return ONLP_STATUS_OK;
+    }
+
+    if(!strcmp(cmd, "latency") || !strcmp(cmd, "error")) {
+        int op;
+        ARGC_CHECK(3);
+        if((op = onlpsim_op_lookup__(argv[1])) < 0) {
+            aim_printf(pvs, "unknown operation '%s'\n", argv[1]);
+            return ONLP_STATUS_E_PARAM;
+        }
+        if(!strcmp(cmd, "latency")) {
+            state->ops[op].latency_us = atoi(argv[2]);
+            state->ops[op].jitter_us = (argc > 3) ? atoi(argv[3]) : 0;
+        }
+        else {
+            state->ops[op].error_ppm = atoi(argv[2]);
+        }
+    }
+    else if(!strcmp(cmd, "thermal")) {
+        int i;
+        ARGC_CHECK(3);
+        i = atoi(argv[1]) - 1;
+        INDEX_CHECK(i, state->thermal_count);
+        state->thermals[i].mcelsius = atoi(argv[2]);
+    }
+    else if(!strcmp(cmd, "fan")) {
+        int i;
+        ARGC_CHECK(3);
+        i = atoi(argv[1]) - 1;
+        INDEX_CHECK(i, state->fan_count);
+        if(!strcmp(argv[2], "fail")) {
+            state->fans[i].status |= ONLP_FAN_STATUS_FAILED;
+            state->fans[i].rpm = 0;
+        }
+        else {
+            state->fans[i].status &= ~ONLP_FAN_STATUS_FAILED;
+            state->fans[i].rpm = atoi(argv[2]);
+        }
+    }
+    else if(!strcmp(cmd, "psu")) {
+        int i;
+        ARGC_CHECK(3);
+        i = atoi(argv[1]) - 1;
+        INDEX_CHECK(i, state->psu_count);
+        if(!strcmp(argv[2], "remove")) {
+            state->psus[i].status &= ~ONLP_PSU_STATUS_PRESENT;
+        }
+        else if(!strcmp(argv[2], "insert")) {
+            state->psus[i].status |= ONLP_PSU_STATUS_PRESENT;
+            state->psus[i].status &= ~(ONLP_PSU_STATUS_FAILED | ONLP_PSU_STATUS_UNPLUGGED);
+        }
+        else if(!strcmp(argv[2], "fail")) {
+            state->psus[i].status |= ONLP_PSU_STATUS_FAILED;
+        }
+        else if(!strcmp(argv[2], "unplug")) {
+            state->psus[i].status |= ONLP_PSU_STATUS_UNPLUGGED;
+        }
+        else {
+            state->psus[i].mpout = atoi(argv[2]);
+        }
+    }
+    else if(!strcmp(cmd, "sfp")) {
+        onlpsim_sfp_t* sfp;
+        int port, v;
+        ARGC_CHECK(3);
+        port = atoi(argv[1]);
+        INDEX_CHECK(port, state->sfp_count);
+        sfp = state->sfps + port;
+        v = (argc > 3) ? atoi(argv[3]) : 1;
+
+        if(!strcmp(argv[2], "insert")) {
+            if(argc > 3) {
+                int rv = onlpsim_file_read__(argv[3], sfp->a0, sizeof(sfp->a0));
+                if(rv < 0) {
+                    aim_printf(pvs, "%s: unable to read eeprom image.\n", argv[3]);
+                    return rv;
+                }
+                if(argc > 4) {
+                    rv = onlpsim_file_read__(argv[4], sfp->a2, sizeof(sfp->a2));
+                    if(rv < 0) {
+                        aim_printf(pvs, "%s: unable to read dom image.\n", argv[4]);
+                        return rv;
+                    }
+                }
+            }
+            else {
+                onlpsim_sfp_image__(sfp, port);
+            }
+            sfp->rx_los = sfp->tx_fault = sfp->tx_disable = 0;
+            sfp->lp_mode = sfp->reset = 0;
+            sfp->present = 1;
+        }
+        else if(!strcmp(argv[2], "remove")) {
+            sfp->present = 0;
+        }
+        else if(!strcmp(argv[2], "rx_los")) {
+            sfp->rx_los = !!v;
+        }
+        else if(!strcmp(argv[2], "tx_fault")) {
+            sfp->tx_fault = !!v;
+        }
+        else {
+            aim_printf(pvs, "unknown sfp command '%s'\n", argv[2]);
+            return ONLP_STATUS_E_PARAM;
+        }
+    }
+    else {
+        aim_printf(pvs, "unknown command '%s'\n", cmd);
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    state->generation++;
+    return ONLP_STATUS_OK;
+}
+
+int
+onlpsim_debug(aim_pvs_t* pvs, int argc, char** argv)
+{
+    if(argc == 0 || !strcmp(argv[0], "help")) {
+        aim_printf(pvs, "state file: %s (ONLPSIM_STATE)\n", onlpsim_state_file__());
+        aim_printf(pvs, "  init [thermals] [fans] [psus] [leds] [sfps]\n");
+        aim_printf(pvs, "  show\n");
+        aim_printf(pvs, "  latency <op> <us> [jitter-us]\n");
+        aim_printf(pvs, "  error <op> <ppm>\n");
+        aim_printf(pvs, "  thermal <n> <mC>\n");
+        aim_printf(pvs, "  fan <n> <rpm|fail>\n");
+        aim_printf(pvs, "  psu <n> <mW|insert|remove|fail|unplug>\n");
+        aim_printf(pvs, "  sfp <port> insert [eeprom-image] [dom-image]\n");
+        aim_printf(pvs, "  sfp <port> remove\n");
+        aim_printf(pvs, "  sfp <port> <rx_los|tx_fault> <0|1>\n");
+        aim_printf(pvs, "  scripts: onlpdump debug script <file>  (one command per line, plus 'sleep <ms>')\n");
+        aim_printf(pvs, "  ops: sys thermal fan psu led sfp-presence sfp-eeprom sfp-control\n");
+        return ONLP_STATUS_OK;
+    }
+
+    return onlpsim_command__(pvs, argc, argv);
+}
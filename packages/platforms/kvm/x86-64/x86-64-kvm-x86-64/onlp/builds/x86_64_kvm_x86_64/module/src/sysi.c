@@ -24,6 +24,7 @@
  ***********************************************************/
 #include <onlp/platformi/sysi.h>
 #include <onlplib/crc32.h>
+#include "x86_64_kvm_x86_64_int.h"
 #include "x86_64_kvm_x86_64_log.h"
 
 const char*
@@ -77,6 +78,34 @@ onlp_sysi_platform_manage(void)
 int
 onlp_sysi_oids_get(onlp_oid_t* table, int max)
 {
+    onlpsim_state_t* state = onlpsim_state_get();
+    onlp_oid_t* e = table;
+    int i;
+
     memset(table, 0, max*sizeof(onlp_oid_t));
+    if(state == NULL) {
+        return 0;
+    }
+    if( (i = onlpsim_op(state, ONLPSIM_OP_SYS)) < 0) {
+        return i;
+    }
+
+#define OIDS_ADD(_count, _create)                               \
+    for(i = 1; i <= (_count) && e < table + max; i++) {         \
+        *e++ = _create(i);                                      \
+    }
+
+    OIDS_ADD(state->thermal_count, ONLP_THERMAL_ID_CREATE);
+    OIDS_ADD(state->fan_count, ONLP_FAN_ID_CREATE);
+    OIDS_ADD(state->psu_count, ONLP_PSU_ID_CREATE);
+    OIDS_ADD(state->led_count, ONLP_LED_ID_CREATE);
+#undef OIDS_ADD
+
     return 0;
 }
+
+int
+onlp_sysi_debug(aim_pvs_t* pvs, int argc, char** argv)
+{
+    return onlpsim_debug(pvs, argc, argv);
+}
@@ -23,6 +23,7 @@
  *
  ***********************************************************/
 #include <onlp/platformi/thermali.h>
+#include "x86_64_kvm_x86_64_int.h"
 #include "x86_64_kvm_x86_64_log.h"
 
 int
@@ -30,3 +31,31 @@ onlp_thermali_init(void)
 {
     return ONLP_STATUS_OK;
 }
+
+int
+onlp_thermali_info_get(onlp_oid_t id, onlp_thermal_info_t* info)
+{
+    onlpsim_state_t* state;
+    onlpsim_thermal_t* t;
+    int i, rv;
+
+    if((state = onlpsim_oid_state_get(id, &i)) == NULL) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    if( (rv = onlpsim_op(state, ONLPSIM_OP_THERMAL)) < 0) {
+        return rv;
+    }
+
+    t = state->thermals + i;
+    memset(info, 0, sizeof(*info));
+    info->hdr.id = id;
+    snprintf(info->hdr.description, sizeof(info->hdr.description),
+             "Simulated Thermal %d", i+1);
+    info->status = t->status;
+    info->caps = ONLP_THERMAL_CAPS_ALL;
+    info->mcelsius = t->mcelsius;
+    info->thresholds.warning = t->warning;
+    info->thresholds.error = t->error;
+    info->thresholds.shutdown = t->shutdown;
+    return ONLP_STATUS_OK;
+}
@@ -69,6 +69,11 @@ x86_64_kvm_x86_64_config_settings_t x86_64_kvm_x86_64_config_settings[] =
     { __x86_64_kvm_x86_64_config_STRINGIFY_NAME(ONLPSIM_CONFIG_SFP_COUNT), __x86_64_kvm_x86_64_config_STRINGIFY_VALUE(ONLPSIM_CONFIG_SFP_COUNT) },
 #else
 { ONLPSIM_CONFIG_SFP_COUNT(__x86_64_kvm_x86_64_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPSIM_CONFIG_STATE_FILE
+    { __x86_64_kvm_x86_64_config_STRINGIFY_NAME(ONLPSIM_CONFIG_STATE_FILE), __x86_64_kvm_x86_64_config_STRINGIFY_VALUE(ONLPSIM_CONFIG_STATE_FILE) },
+#else
+{ ONLPSIM_CONFIG_STATE_FILE(__x86_64_kvm_x86_64_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
@@ -27,6 +27,149 @@
 #define __ONLPSIM_INT_H__
 
 #include <x86_64_kvm_x86_64/x86_64_kvm_x86_64_config.h>
+#include <onlp/oids.h>
+#include <AIM/aim_pvs.h>
+
+/**
+ * Simulated platform state.
+ *
+ * When the state file (ONLPSIM_CONFIG_STATE_FILE, or the ONLPSIM_STATE
+ * environment variable) exists, the thermals, fans, PSUs, LEDs and SFP
+ * ports of this platform are backed by it. The file is memory mapped
+ * shared, so changes made by one process (see onlpsim_debug()) are seen
+ * immediately by all ONLP clients. Each operation class has a
+ * configurable latency, jitter and error injection rate.
+ *
+ * Without a state file the platform reports no devices, as before.
+ */
+
+#define ONLPSIM_STATE_MAGIC   0x4F4E5349 /* ONSI */
+#define ONLPSIM_STATE_VERSION 1
+
+#define ONLPSIM_THERMAL_MAX 32
+#define ONLPSIM_FAN_MAX     16
+#define ONLPSIM_PSU_MAX     8
+#define ONLPSIM_LED_MAX     16
+#define ONLPSIM_SFP_MAX     256
+
+typedef enum onlpsim_op_e {
+    ONLPSIM_OP_SYS,
+    ONLPSIM_OP_THERMAL,
+    ONLPSIM_OP_FAN,
+    ONLPSIM_OP_PSU,
+    ONLPSIM_OP_LED,
+    ONLPSIM_OP_SFP_PRESENCE,
+    ONLPSIM_OP_SFP_EEPROM,
+    ONLPSIM_OP_SFP_CONTROL,
+    ONLPSIM_OP_COUNT,
+} onlpsim_op_t;
+
+typedef struct onlpsim_op_config_s {
+    /** Added to every operation, in microseconds. */
+    uint32_t latency_us;
+    /** Random additional latency, up to this many microseconds. */
+    uint32_t jitter_us;
+    /** Injected error rate, in parts per million. */
+    uint32_t error_ppm;
+} onlpsim_op_config_t;
+
+typedef struct onlpsim_thermal_s {
+    uint32_t status;
+    int32_t mcelsius;
+    int32_t warning;
+    int32_t error;
+    int32_t shutdown;
+} onlpsim_thermal_t;
+
+typedef struct onlpsim_fan_s {
+    uint32_t status;
+    int32_t rpm;
+    int32_t percentage;
+    int32_t max_rpm;
+} onlpsim_fan_t;
+
+typedef struct onlpsim_psu_s {
+    uint32_t status;
+    char model[32];
+    char serial[32];
+    int32_t mvin;
+    int32_t mvout;
+    int32_t miin;
+    int32_t miout;
+    int32_t mpin;
+    int32_t mpout;
+} onlpsim_psu_t;
+
+typedef struct onlpsim_led_s {
+    uint32_t status;
+    uint32_t mode;
+} onlpsim_led_t;
+
+typedef struct onlpsim_sfp_s {
+    uint8_t present;
+    uint8_t rx_los;
+    uint8_t tx_fault;
+    uint8_t tx_disable;
+    uint8_t lp_mode;
+    uint8_t reset;
+    uint8_t reserved[2];
+    /** Device address 0x50 and 0x51 images. */
+    uint8_t a0[256];
+    uint8_t a2[256];
+} onlpsim_sfp_t;
+
+typedef struct onlpsim_state_s {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    /** Incremented on every change made through onlpsim_debug(). */
+    uint32_t generation;
+
+    uint32_t thermal_count;
+    uint32_t fan_count;
+    uint32_t psu_count;
+    uint32_t led_count;
+    uint32_t sfp_count;
+
+    onlpsim_op_config_t ops[ONLPSIM_OP_COUNT];
+
+    onlpsim_thermal_t thermals[ONLPSIM_THERMAL_MAX];
+    onlpsim_fan_t fans[ONLPSIM_FAN_MAX];
+    onlpsim_psu_t psus[ONLPSIM_PSU_MAX];
+    onlpsim_led_t leds[ONLPSIM_LED_MAX];
+    onlpsim_sfp_t sfps[ONLPSIM_SFP_MAX];
+} onlpsim_state_t;
+
+/**
+ * @brief Get the simulated platform state.
+ * @returns The mapped state, or NULL if there is no state file.
+ */
+onlpsim_state_t* onlpsim_state_get(void);
+
+/**
+ * @brief Apply the latency and error injection of an operation.
+ * @param state The state.
+ * @param op The operation.
+ * @returns ONLP_STATUS_OK, or the injected error.
+ */
+int onlpsim_op(onlpsim_state_t* state, onlpsim_op_t op);
+
+/**
+ * @brief Get the state of a thermal, fan, PSU or LED OID.
+ * @param id The OID.
+ * @param [out] index Receives the object index in the state tables.
+ * @returns The state, or NULL if the OID is not simulated.
+ */
+onlpsim_state_t* onlpsim_oid_state_get(onlp_oid_t id, int* index);
+
+/**
+ * @brief Create, modify or script the simulated state.
+ * @param pvs The output pvs.
+ * @param argc The argument count.
+ * @param argv The arguments.
+ * @notes This implements "onlpdump debugi ...".
+ */
+int onlpsim_debug(aim_pvs_t* pvs, int argc, char** argv);
 
 
 #endif /* __ONLPSIM_INT_H__ */
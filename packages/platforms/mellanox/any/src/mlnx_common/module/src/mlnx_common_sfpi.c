@@ -30,6 +30,7 @@
 #include <onlplib/file.h>
 #include <onlplib/i2c.h>
 #include <onlplib/sfp.h>
+#include <onlplib/ethtool.h>
 #include <sys/ioctl.h>
 #include "mlnx_common_log.h"
 #include "mlnx_common_int.h"
@@ -89,25 +90,16 @@ mc_sfp_get_port_path(int port, char *node_name)
     return sfp_node_path;
 }
 
-static char*
-mc_sfp_convert_i2c_path(int port, int devaddr)
-{
-    sprintf(sfp_node_path, "%s/sfp%d", SFP_PATH, port);
-    return sfp_node_path;
-}
-
 static int
-mc_sfp_prepare_eeprom_dump(int port, const char* path)
+mc_sfp_module_read(int port, uint8_t devaddr, int page, int offset,
+                   int size, uint8_t* data)
 {
-    char* cmd = aim_fstrdup("ethtool -m sfp%d raw on length 256 > %s", port, path);
+    char ifname[16];
 
-    if(system(cmd) != 0) {
-        aim_free(cmd);
-        return ONLP_STATUS_E_INTERNAL;
-    }
-    aim_free(cmd);
-
-	return ONLP_STATUS_OK;
+    /* The module EEPROM is read through the sfp<port> netdev. */
+    snprintf(ifname, sizeof(ifname), "sfp%d", port);
+    return onlp_ethtool_module_eeprom_read(ifname, devaddr, page, 0,
+                                           offset, size, data);
 }
 
 /************************************************************
@@ -174,12 +166,8 @@ onlp_sfpi_presence_bitmap_get(onlp_sfp_bitmap_t* dst)
 int
 onlp_sfpi_eeprom_read(int port, uint8_t data[256])
 {
-    char* path = mc_sfp_get_port_path(port, NULL);
+    int rv;
 
-	if (mc_sfp_prepare_eeprom_dump(port, path) != ONLP_STATUS_OK) {
-            AIM_LOG_ERROR("Unable to prepare sfp%d eeprom dump\r\n", port);
-            return ONLP_STATUS_E_INTERNAL;
-	}
     /*
      * Read the SFP eeprom into data[]
      *
@@ -188,7 +176,11 @@ onlp_sfpi_eeprom_read(int port, uint8_t data[256])
      */
     memset(data, 0, 256);
 
-    if (onlplib_sfp_eeprom_read_file(path, data) != 0) {
+    rv = mc_sfp_module_read(port, 0x50, 0, 0, 256, data);
+    if (rv == ONLP_STATUS_E_MISSING) {
+        return rv;
+    }
+    if (rv < 0) {
         AIM_LOG_ERROR("Unable to read eeprom from port(%d)\r\n", port);
         return ONLP_STATUS_E_INTERNAL;
     }
@@ -196,28 +188,22 @@ onlp_sfpi_eeprom_read(int port, uint8_t data[256])
     return ONLP_STATUS_OK;
 }
 
+int
+onlp_sfpi_memory_read(int port, uint8_t devaddr, int page, int offset,
+                      int size, uint8_t* rdata)
+{
+    return mc_sfp_module_read(port, devaddr, page, offset, size, rdata);
+}
+
 int
 onlp_sfpi_dev_readb(int port, uint8_t devaddr, uint8_t addr)
 {
-    char* path = mc_sfp_convert_i2c_path(port, devaddr);
     uint8_t data;
-    int fd;
-    int nrd;
-
-    if (!path)
-		return ONLP_STATUS_E_MISSING;
-
-    fd = open(path, O_RDONLY);
-    if (fd < 0)
-		return ONLP_STATUS_E_MISSING;
-
-    lseek(fd, addr, SEEK_SET);
-    nrd = read(fd, &data, 1);
-    close(fd);
+    int rv;
 
-    if (nrd != 1) {
-		AIM_LOG_INTERNAL("Failed to read EEPROM file '%s'", path);
-		return ONLP_STATUS_E_INTERNAL;
+    rv = mc_sfp_module_read(port, devaddr, 0, addr, 1, &data);
+    if (rv < 0) {
+        return rv;
     }
     return data;
 }
@@ -225,27 +211,12 @@ onlp_sfpi_dev_readb(int port, uint8_t devaddr, uint8_t addr)
 int
 onlp_sfpi_dev_readw(int port, uint8_t devaddr, uint8_t addr)
 {
-    char* path = mc_sfp_convert_i2c_path(port, devaddr);
     uint16_t data;
-    int fd;
-    int nrd;
-
-    if (!path){
-		return ONLP_STATUS_E_MISSING;
-    }
-
-    fd = open(path, O_RDONLY);
-    if (fd < 0) {
-		return ONLP_STATUS_E_MISSING;
-    }
-
-    lseek(fd, addr, SEEK_SET);
-    nrd = read(fd, &data, 2);
-    close(fd);
+    int rv;
 
-    if (nrd != 2) {
-		AIM_LOG_INTERNAL("Failed to read EEPROM file '%s'", path);
-		return ONLP_STATUS_E_INTERNAL;
+    rv = mc_sfp_module_read(port, devaddr, 0, addr, 2, (uint8_t*)&data);
+    if (rv < 0) {
+        return rv;
     }
     return data;
 }
@@ -8,6 +8,7 @@
 #include <linux/hwmon-sysfs.h>
 #include <linux/err.h>
 #include <linux/mutex.h>
+#include <linux/seqlock.h>
 #include <linux/delay.h>
 #include <linux/log2.h>
 #include <linux/kthread.h>
@@ -360,6 +361,32 @@ char SFPPortTxDisable[QSFP_COUNT];
 
 static struct i2c_client cpld_client_bus1;
 
+/*
+ * Sensor values of the bus 0 update thread. The thread reads them into
+ * a private copy and publishes it under snapshot_lock, so readers never
+ * wait for the bus.
+ */
+struct i2c_bus0_hardware_monitor_sensors {
+    unsigned int remoteTempIsPositive[W83795ADG_TEMP_COUNT];
+    unsigned int remoteTempInt[W83795ADG_TEMP_COUNT];
+    unsigned int remoteTempDecimal[W83795ADG_TEMP_COUNT];
+    unsigned int fanSpeed[W83795ADG_FAN_COUNT];
+    unsigned int vSen[W83795ADG_VSEN_COUNT];
+    unsigned int vSenLsb[W83795ADG_VSEN_COUNT];
+
+    char psuPG;
+    char psuABS;
+};
+
+enum i2c_bus0_hardware_monitor_group {
+    BUS0_GROUP_FAN = 0,
+    BUS0_GROUP_TEMP,
+    BUS0_GROUP_VOLTAGE,
+    BUS0_GROUP_PSU,
+    BUS0_GROUP_PORT,
+    BUS0_GROUP_COUNT
+};
+
 struct i2c_bus0_hardware_monitor_data {
     struct device *hwmon_dev;
     struct attribute_group hwmon_group;
@@ -367,6 +394,8 @@ struct i2c_bus0_hardware_monitor_data {
     struct task_struct *auto_update;
     struct completion auto_update_stop;
 
+    seqlock_t snapshot_lock;
+    struct i2c_bus0_hardware_monitor_sensors sensors;
     char hardware_monitor_data_valid;
     unsigned long hardware_monitor_last_updated; /* In jiffies */
 
@@ -382,16 +411,7 @@ struct i2c_bus0_hardware_monitor_data {
 
     unsigned int macTemp;
 
-    unsigned int remoteTempIsPositive[W83795ADG_TEMP_COUNT];
-    unsigned int remoteTempInt[W83795ADG_TEMP_COUNT];
-    unsigned int remoteTempDecimal[W83795ADG_TEMP_COUNT];
     unsigned int fanDuty;
-    unsigned int fanSpeed[W83795ADG_FAN_COUNT];
-    unsigned int vSen[W83795ADG_VSEN_COUNT];
-    unsigned int vSenLsb[W83795ADG_VSEN_COUNT];
-
-    char psuPG;
-    char psuABS;
 
     char wdReg;
     unsigned int wdEnable;
@@ -405,6 +425,28 @@ struct i2c_bus0_hardware_monitor_data {
     unsigned int rov;
  };
 
+/*
+ * Port and fan state of the bus 1 update thread. The thread updates a
+ * private copy (work) and publishes it to ports under snapshot_lock
+ * after each step.
+ */
+struct i2c_bus1_hardware_monitor_ports {
+    unsigned short qsfpPortAbsStatus[4];
+    char qsfpPortDataA0[QSFP_COUNT][QSFP_DATA_SIZE];
+    char qsfpPortDataA2[QSFP_COUNT][QSFP_DATA_SIZE];
+    char SfpCopperPortData[QSFP_COUNT][SFP_COPPER_DATA_SIZE];
+    unsigned short qsfpPortDataValid[4];
+    unsigned short sfpPortRxLosStatus[4];
+    unsigned short sfpPortTxFaultStatus[4];
+
+    unsigned short fanAbs[2];
+    unsigned short fanDir[2];
+
+    unsigned char sfpPortDataValidAst[64];
+    unsigned char sfpPortAbsRxLosStatus[24];
+    unsigned char qsfpPortAbsStatusAst[16];
+};
+
 struct i2c_bus1_hardware_monitor_data {
     struct device *hwmon_dev;
     struct attribute_group hwmon_group;
@@ -412,27 +454,17 @@ struct i2c_bus1_hardware_monitor_data {
     struct task_struct *auto_update;
     struct completion auto_update_stop;
 
+    seqlock_t snapshot_lock;
+    struct i2c_bus1_hardware_monitor_ports ports;
+    struct i2c_bus1_hardware_monitor_ports work;
     char hardware_monitor_data_valid;
     unsigned long hardware_monitor_last_updated; /* In jiffies */
 
-    unsigned short qsfpPortAbsStatus[4];
-    char qsfpPortDataA0[QSFP_COUNT][QSFP_DATA_SIZE];
-    char qsfpPortDataA2[QSFP_COUNT][QSFP_DATA_SIZE];
-    char SfpCopperPortData[QSFP_COUNT][SFP_COPPER_DATA_SIZE];
-    unsigned short qsfpPortDataValid[4];
     unsigned short sfpPortTxDisable[3];
     unsigned short sfpPortRateSelect[3];
-    unsigned short sfpPortRxLosStatus[4];
-    unsigned short sfpPortTxFaultStatus[4];
-
-    unsigned short fanAbs[2];
-    unsigned short fanDir[2];
 
     unsigned short systemLedStatus;
     unsigned short frontLedStatus;
-    unsigned char sfpPortDataValidAst[64];
-    unsigned char sfpPortAbsRxLosStatus[24];
-    unsigned char qsfpPortAbsStatusAst[16];
     unsigned char sfpPortRateSelectAst[12];
     unsigned char sfpPortTxDisableAst[6];
 
@@ -629,6 +661,15 @@ static int i2c_device_byte_write(const struct i2c_client *client, unsigned char
 #define I2C_RW_RETRY_COUNT          3
 #define I2C_RW_RETRY_INTERVAL       100 /* ms */
 
+/* Update thread periods, in ms */
+#define HW_MONITOR_TICK             200
+#define HW_MONITOR_WATCHDOG_PERIOD  1000
+#define HW_MONITOR_FAN_PERIOD       1000
+#define HW_MONITOR_TEMP_PERIOD      1000
+#define HW_MONITOR_VOLTAGE_PERIOD   5000
+#define HW_MONITOR_PSU_PERIOD       1000
+#define HW_MONITOR_PORT_PERIOD      1000
+
 enum port_sysfs_attributes {
   PRESENT,
   RX_LOS,
@@ -764,337 +805,478 @@ int eepromDataRead(struct i2c_client *client, char *buf)
     return 0;
 }
 
-static int i2c_bus0_hardware_monitor_update_thread(void *p)
+/* Returns 1 if any fan has stopped. Called with data->lock held. */
+static int i2c_bus0_hardware_monitor_fan_update(struct i2c_client *client,
+        struct i2c_bus0_hardware_monitor_data *data, struct i2c_bus0_hardware_monitor_sensors *sensors)
 {
-    struct i2c_client *client = p;
-    struct i2c_bus0_hardware_monitor_data *data = i2c_get_clientdata(client);
     int MNTFANM, MNTFANL, TEMP;
-    int MNTRTD, MNTTD;
-    int i, fanErr;
-    unsigned int cTemp, fanDuty, maxTemp, LastTemp = 0;
-    const ControlTable_t  *cTable;
-    unsigned int fanCtrlDelay = 5;
+    int i, fanErr = 0;
     unsigned int fanSpeed;
-    unsigned short port_status;
-    int j, port;
-    unsigned int configByte;
 
-    while (!kthread_should_stop())
+    /* Get Fan Speed and display status */
+    for (i=0; i<W83795ADG_FAN_COUNT; i++)
     {
-        if (isBMCSupport == 0)
+        /* Only ASTERION support 10 FAN */
+        if ((i >= W83795ADG_NUM8) && (data->modelId != ASTERION_WITH_BMC) && (data->modelId != ASTERION_WITHOUT_BMC))
         {
-            mutex_lock(&data->lock);
+            FanErr[i] = 0;
+            continue;
+        }
 
-            /* Get Fan Speed and display status */
-            fanErr = 0;
-            for (i=0; i<W83795ADG_FAN_COUNT; i++)
-            {
-                /* Only ASTERION support 10 FAN */
-                if ((i >= W83795ADG_NUM8) && (data->modelId != ASTERION_WITH_BMC) && (data->modelId != ASTERION_WITHOUT_BMC))
-                {
-                    FanErr[i] = 0;
-                    continue;
-                }
+        fanSpeed = 0;
+        /* Choose W83795ADG bank 0 */
+        i2c_smbus_write_byte_data(client, W83795ADG_REG_BANK, 0x00);
+        MNTFANM = (int) i2c_smbus_read_byte_data(client, (W83795ADG_REG_FANIN1_COUNT+i));
+        MNTFANL = (int) i2c_smbus_read_byte_data(client, W83795ADG_REG_VR_LSB);
+        if ( !((MNTFANM == 0xFF) && (MNTFANL == 0xF0)) )
+        {
+            /* FanSpeed (RPM) = 1.35 x 10^6 / ( (12-bitCountValue) x (FanPoles/4) ) */
+            TEMP = (((MNTFANM << 4) + ((MNTFANL & 0xF0) >> 4)) * (W83795ADG_FAN_POLES_NUMBER / 4));
+            if (TEMP != 0)
+                fanSpeed = W83795ADG_FAN_SPEED_FACTOR / TEMP;
+        }
+        if (fanSpeed == 0)
+            fanErr = FanErr[i] = 1;
+        else
+            FanErr[i] = 0;
+        sensors->fanSpeed[i] = fanSpeed;
+    }
 
-                fanSpeed = 0;
-                /* Choose W83795ADG bank 0 */
-                i2c_smbus_write_byte_data(client, W83795ADG_REG_BANK, 0x00);
-                MNTFANM = (int) i2c_smbus_read_byte_data(client, (W83795ADG_REG_FANIN1_COUNT+i));
-                MNTFANL = (int) i2c_smbus_read_byte_data(client, W83795ADG_REG_VR_LSB);
-                if ( !((MNTFANM == 0xFF) && (MNTFANL == 0xF0)) )
-                {
-                    /* FanSpeed (RPM) = 1.35 x 10^6 / ( (12-bitCountValue) x (FanPoles/4) ) */
-                    TEMP = (((MNTFANM << 4) + ((MNTFANL & 0xF0) >> 4)) * (W83795ADG_FAN_POLES_NUMBER / 4));
-                    if (TEMP != 0)
-                        fanSpeed = W83795ADG_FAN_SPEED_FACTOR / TEMP;
-                }
-                if (fanSpeed == 0)
-                    fanErr = FanErr[i] = 1;
-                else
-                    FanErr[i] = 0;
-                data->fanSpeed[i] = fanSpeed;
-            }
+    if ((data->modelId==HURACAN_WITH_BMC)||(data->modelId==HURACAN_WITHOUT_BMC))
+    {
+        if (data->hwRev == 0x00) /* Proto */
+        {
+            if (fanErr == 1)
+                i2c_smbus_write_byte_data(&pca9535pwr_client_bus0, PCA9553_COMMAND_BYTE_REG_OUTPUT_PORT_0, 0x80);
+            else
+                i2c_smbus_write_byte_data(&pca9535pwr_client_bus0, PCA9553_COMMAND_BYTE_REG_OUTPUT_PORT_0, 0x00);
+        }
+        else if (data->hwRev == 0x02) /* Beta */
+        {
+            if (fanErr == 1)
+                i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_LED_0x44, 0x01);
+            else
+                i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_LED_0x44, 0x00);
+        }
+    }
+    return fanErr;
+}
+
+/* Called with data->lock held. */
+static void i2c_bus0_hardware_monitor_voltage_update(struct i2c_client *client,
+        struct i2c_bus0_hardware_monitor_data *data, struct i2c_bus0_hardware_monitor_sensors *sensors)
+{
+    int i;
+
+    /* Get Voltage */
+    for (i=0; i<W83795ADG_VSEN_COUNT; i++)
+    {
+        sensors->vSen[i] = (unsigned int) i2c_smbus_read_byte_data(client, (W83795ADG_REG_VSEN1+i));
+        sensors->vSenLsb[i] = (unsigned int) i2c_smbus_read_byte_data(client, W83795ADG_REG_VR_LSB);
+    }
+}
 
-            if ((data->modelId==HURACAN_WITH_BMC)||(data->modelId==HURACAN_WITHOUT_BMC))
+/* Called with data->lock held. */
+static void i2c_bus0_hardware_monitor_temp_update(struct i2c_client *client,
+        struct i2c_bus0_hardware_monitor_data *data, struct i2c_bus0_hardware_monitor_sensors *sensors)
+{
+    int MNTRTD, MNTTD;
+    int i;
+    unsigned int cTemp;
+
+    /* Get Remote Temp */
+    for (i=0; i<W83795ADG_TEMP_COUNT; i++)
+    {
+        /* Only ASTERION support 4 remote temperature */
+        if ((i >= W83795ADG_NUM2) && (data->modelId != ASTERION_WITH_BMC) && (data->modelId != ASTERION_WITHOUT_BMC))
+            break;
+
+        MNTRTD = (int) i2c_smbus_read_byte_data(client, (W83795ADG_REG_TR1+i));
+        MNTTD = (int) i2c_smbus_read_byte_data(client, W83795ADG_REG_VR_LSB);
+        /* temperature is negative */
+        if ( MNTRTD & 0x80 )
+        {
+            sensors->remoteTempIsPositive[i] = 0;
+            cTemp = (((MNTRTD << 2) + ((MNTTD & 0xC0) >> 6)) ^ 0x1FF) + 1; /* calculate 2's complement */
+            sensors->remoteTempDecimal[i] = (cTemp & 0x3) * TEMP_DECIMAL_BASE;
+            sensors->remoteTempInt[i] = cTemp >> 2;
+        }
+        else
+        {
+            sensors->remoteTempIsPositive[i] = 1;
+            sensors->remoteTempDecimal[i] = ((MNTTD & 0xC0) >> 6) * TEMP_DECIMAL_BASE;
+            sensors->remoteTempInt[i] = MNTRTD;
+        }
+    }
+}
+
+/* Called with data->lock held. */
+static void i2c_bus0_hardware_monitor_psu_update(struct i2c_client *client,
+        struct i2c_bus0_hardware_monitor_data *data, struct i2c_bus0_hardware_monitor_sensors *sensors)
+{
+    sensors->psuPG = platformPsuPG = i2c_smbus_read_byte_data(&cpld_client, CPLD_REG_GENERAL_0x02);
+    sensors->psuABS = platformPsuABS = i2c_smbus_read_byte_data(&cpld_client, CPLD_REG_GENERAL_0x03);
+}
+
+/* Called with data->lock held. */
+static void i2c_bus0_hardware_monitor_port_update(struct i2c_client *client,
+        struct i2c_bus0_hardware_monitor_data *data, struct i2c_bus0_hardware_monitor_sensors *sensors)
+{
+    unsigned short port_status;
+    int i, j, port;
+
+    switch(platformModelId)
+    {
+        case NCIIX_WITH_BMC:
+        case NCIIX_WITHOUT_BMC:
+            for (i=0; i<5 ; i++)
             {
-                if (data->hwRev == 0x00) /* Proto */
+                /* Turn on PCA9548#0 channel 3~7 on I2C-bus0 */
+                i2c_smbus_write_byte_data(&pca9548_client_bus0, 0, (1<<(PCA9548_CH03+i)));
+                for (j=0; j<4; j++)
                 {
-                    if (fanErr == 1)
-                        i2c_smbus_write_byte_data(&pca9535pwr_client_bus0, PCA9553_COMMAND_BYTE_REG_OUTPUT_PORT_0, 0x80);
-                    else
-                        i2c_smbus_write_byte_data(&pca9535pwr_client_bus0, PCA9553_COMMAND_BYTE_REG_OUTPUT_PORT_0, 0x00);
-                }
-                else if (data->hwRev == 0x02) /* Beta */
-                {
-                    if (fanErr == 1)
-                        i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_LED_0x44, 0x01);
-                    else
-                        i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_LED_0x44, 0x00);
+                    port_status = i2c_smbus_read_word_data(&(pca9535_client_bus0[j]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
+                    port = ((j*2)+(i*8));
+                    SFPPortTxFaultStatus[port] = (PCA9553_TEST_BIT(port_status, 0)==0);
+                    SFPPortAbsStatus[port] = (PCA9553_TEST_BIT(port_status, 1)==0);
+                    SFPPortRxLosStatus[port] = (PCA9553_TEST_BIT(port_status, 2)==0);
+                    port++;
+                    SFPPortTxFaultStatus[port] = (PCA9553_TEST_BIT(port_status, 6)==0);
+                    SFPPortAbsStatus[port] = (PCA9553_TEST_BIT(port_status, 7)==0);
+                    SFPPortRxLosStatus[port] = (PCA9553_TEST_BIT(port_status, 8)==0);
                 }
+                i2c_smbus_write_byte_data(&pca9548_client_bus0, 0, 0x00);
             }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static const unsigned int i2c_bus0_hardware_monitor_group_period[BUS0_GROUP_COUNT] =
+{
+    [BUS0_GROUP_FAN] = HW_MONITOR_FAN_PERIOD,
+    [BUS0_GROUP_TEMP] = HW_MONITOR_TEMP_PERIOD,
+    [BUS0_GROUP_VOLTAGE] = HW_MONITOR_VOLTAGE_PERIOD,
+    [BUS0_GROUP_PSU] = HW_MONITOR_PSU_PERIOD,
+    [BUS0_GROUP_PORT] = HW_MONITOR_PORT_PERIOD,
+};
+
+/* Called with data->lock held. */
+static void i2c_bus0_hardware_monitor_fan_control(struct i2c_client *client,
+        struct i2c_bus0_hardware_monitor_data *data, const struct i2c_bus0_hardware_monitor_sensors *sensors,
+        int fanErr, unsigned int *LastTemp)
+{
+    int i;
+    unsigned int fanDuty, maxTemp;
+    const ControlTable_t  *cTable;
+    unsigned int configByte;
+
+    /* Get Max. Temp */
+    maxTemp = data->macTemp;
+    for (i=0; i<W83795ADG_TEMP_COUNT; i++)
+    {
+        if ((i >= W83795ADG_NUM2) && (data->modelId != ASTERION_WITH_BMC) && (data->modelId != ASTERION_WITHOUT_BMC))
+            break;
 
-            /* Get Voltage */
-            for (i=0; i<W83795ADG_VSEN_COUNT; i++)
+        if (sensors->remoteTempInt[i] > maxTemp)
+            maxTemp = sensors->remoteTempInt[i];
+    }
+
+    /* FAN Control */
+    cTable = get_platform_control_table();
+
+    if (fanErr)
+    {
+        fanDuty = cTable->fanDutySet[2];
+        *LastTemp = 0;
+    }
+    else
+    {
+        fanDuty = 0;
+        if (maxTemp > *LastTemp) /* temp is going to up */
+        {
+            if (maxTemp < cTable->tempLow2HighThreshold[0])
             {
-                data->vSen[i] = (unsigned int) i2c_smbus_read_byte_data(client, (W83795ADG_REG_VSEN1+i));
-                data->vSenLsb[i] = (unsigned int) i2c_smbus_read_byte_data(client, W83795ADG_REG_VR_LSB);
+                fanDuty = cTable->fanDutySet[0];
             }
-
-            /* Get Remote Temp */
-            for (i=0; i<W83795ADG_TEMP_COUNT; i++)
+            else if (maxTemp < cTable->tempLow2HighThreshold[1])
             {
-                /* Only ASTERION support 4 remote temperature */
-                if ((i >= W83795ADG_NUM2) && (data->modelId != ASTERION_WITH_BMC) && (data->modelId != ASTERION_WITHOUT_BMC))
-                    break;
+                fanDuty = cTable->fanDutySet[1];
+            }
+            else if (maxTemp < cTable->tempLow2HighThreshold[2])
+            {
+                fanDuty = cTable->fanDutySet[2];
+            }
+            else /* shutdown system */
+            {
+                i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_RESET_0x30, 0xff);
+            }
+        }
+        else if (maxTemp < *LastTemp)/* temp is going to down */
+        {
+            if (maxTemp <= cTable->tempHigh2LowThreshold[0])
+            {
+                fanDuty = cTable->fanDutySet[0];
+            }
+            else if (maxTemp <= cTable->tempHigh2LowThreshold[1])
+            {
+                fanDuty = cTable->fanDutySet[1];
+            }
+            else
+            {
+                fanDuty = cTable->fanDutySet[2];
+            }
+        }
+        *LastTemp = maxTemp;
+    }
 
-                MNTRTD = (int) i2c_smbus_read_byte_data(client, (W83795ADG_REG_TR1+i));
-                MNTTD = (int) i2c_smbus_read_byte_data(client, W83795ADG_REG_VR_LSB);
-                /* temperature is negative */
-                if ( MNTRTD & 0x80 )
-                {
-                    data->remoteTempIsPositive[i] = 0;
-                    cTemp = (((MNTRTD << 2) + ((MNTTD & 0xC0) >> 6)) ^ 0x1FF) + 1; /* calculate 2's complement */
-                    data->remoteTempDecimal[i] = (cTemp & 0x3) * TEMP_DECIMAL_BASE;
-                    data->remoteTempInt[i] = cTemp >> 2;
-                }
-                else
-                {
-                    data->remoteTempIsPositive[i] = 1;
-                    data->remoteTempDecimal[i] = ((MNTTD & 0xC0) >> 6) * TEMP_DECIMAL_BASE;
-                    data->remoteTempInt[i] = MNTRTD;
-                }
+    if ((fanDuty!=0)&&(data->fanDuty!=fanDuty))
+    {
+        data->fanDuty = fanDuty;
+
+        /* Choose W83795ADG bank 0 */
+        i2c_smbus_write_byte_data(client, W83795ADG_REG_BANK, 0x00);
+        /* Disable monitoring operations */
+        configByte = i2c_smbus_read_byte_data(client, W83795ADG_REG_CONFIG);
+        configByte &= 0xfe;
+        i2c_smbus_write_byte_data(client, W83795ADG_REG_CONFIG, configByte);
+
+        /* Choose W83795ADG bank 2 */
+        i2c_smbus_write_byte_data(client, W83795ADG_REG_BANK, 0x02);
+        i2c_smbus_write_byte_data(client, W83795ADG_REG_F1OV, fanDuty);
+        i2c_smbus_write_byte_data(client, W83795ADG_REG_F2OV, fanDuty);
+
+        /* Choose W83795ADG bank 0 */
+        i2c_smbus_write_byte_data(client, W83795ADG_REG_BANK, 0x00);
+        /* Enable monitoring operations */
+        configByte |= 0x01;
+        i2c_smbus_write_byte_data(client, W83795ADG_REG_CONFIG, configByte);
+    }
+}
+
+/*
+ * Watchdog Control Register Support. Requests from the application are
+ * served on the next tick, the hardware refresh once per period.
+ * Called with data->lock held.
+ */
+static void i2c_bus0_hardware_monitor_watchdog(struct i2c_bus0_hardware_monitor_data *data, int due)
+{
+    if (data->cpldRev == 0)
+        return;
+
+    if (data->wdEnable == 1) /* Watchdog Timer is enabled */
+    {
+        if (data->wdRefreshControl == 0) /* Refresh Watchdog by Hardware Monitor */
+        {
+            if (due)
+            {
+                data->wdReg = i2c_smbus_read_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06);
+                data->wdReg |= 0x01; /* clear timer */
+                i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06, data->wdReg);
             }
+        }
+        else if (data->wdRefreshControl == 1) /* Refresh Watchdog by application */
+        {
+            if (data->wdRefreshControlFlag == 1)
+            {
+                data->wdReg = i2c_smbus_read_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06);
+                data->wdReg |= 0x01; /* clear timer */
+                i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06, data->wdReg);
+                data->wdRefreshControlFlag = 0;
+            }
+        }
 
-            if (fanCtrlDelay == 0)
+        /* Watchdog Timer timeout setting */
+        if (data->wdRefreshTimeSelectFlag == 1)
+        {
+            data->wdReg = i2c_smbus_read_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06);
+            data->wdReg |= 0x01; /* clear timer */
+            data->wdReg &= (~0x38);
+            switch(data->wdRefreshTimeSelect)
             {
-                /* Get Max. Temp */
-                maxTemp = data->macTemp;
-                for (i=0; i<W83795ADG_TEMP_COUNT; i++)
-                {
-                    if ((i >= W83795ADG_NUM2) && (data->modelId != ASTERION_WITH_BMC) && (data->modelId != ASTERION_WITHOUT_BMC))
-                        break;
+                case 1: /* 8 second delay */
+                    data->wdReg |= 0x20;
+                    break;
 
-                    if (data->remoteTempInt[i] > maxTemp)
-                        maxTemp = data->remoteTempInt[i];
-                }
+                case 2: /* 16 second delay */
+                    data->wdReg |= 0x10;
+                    break;
 
-                /* FAN Control */
-                cTable = get_platform_control_table();
+                case 3: /* 24 second delay */
+                    data->wdReg |= 0x30;
+                    break;
 
-                if (fanErr)
-                {
-                    fanDuty = cTable->fanDutySet[2];
-                    LastTemp = 0;
-                }
-                else
-                {
-                    fanDuty = 0;
-                    if (maxTemp > LastTemp) /* temp is going to up */
-                    {
-                        if (maxTemp < cTable->tempLow2HighThreshold[0])
-                        {
-                            fanDuty = cTable->fanDutySet[0];
-                        }
-                        else if (maxTemp < cTable->tempLow2HighThreshold[1])
-                        {
-                            fanDuty = cTable->fanDutySet[1];
-                        }
-                        else if (maxTemp < cTable->tempLow2HighThreshold[2])
-                        {
-                            fanDuty = cTable->fanDutySet[2];
-                        }
-                        else /* shutdown system */
-                        {
-                            i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_RESET_0x30, 0xff);
-                        }
-                    }
-                    else if (maxTemp < LastTemp)/* temp is going to down */
-                    {
-                        if (maxTemp <= cTable->tempHigh2LowThreshold[0])
-                        {
-                            fanDuty = cTable->fanDutySet[0];
-                        }
-                        else if (maxTemp <= cTable->tempHigh2LowThreshold[1])
-                        {
-                            fanDuty = cTable->fanDutySet[1];
-                        }
-                        else
-                        {
-                            fanDuty = cTable->fanDutySet[2];
-                        }
-                    }
-                    LastTemp = maxTemp;
-                }
+                case 4: /* 32 second delay */
+                    data->wdReg |= 0x08;
+                    break;
 
-                if ((fanDuty!=0)&&(data->fanDuty!=fanDuty))
-                {
-                    data->fanDuty = fanDuty;
-
-                    /* Choose W83795ADG bank 0 */
-                    i2c_smbus_write_byte_data(client, W83795ADG_REG_BANK, 0x00);
-                    /* Disable monitoring operations */
-                    configByte = i2c_smbus_read_byte_data(client, W83795ADG_REG_CONFIG);
-                    configByte &= 0xfe;
-                    i2c_smbus_write_byte_data(client, W83795ADG_REG_CONFIG, configByte);
-
-                    /* Choose W83795ADG bank 2 */
-                    i2c_smbus_write_byte_data(client, W83795ADG_REG_BANK, 0x02);
-                    i2c_smbus_write_byte_data(client, W83795ADG_REG_F1OV, fanDuty);
-                    i2c_smbus_write_byte_data(client, W83795ADG_REG_F2OV, fanDuty);
-
-                    /* Choose W83795ADG bank 0 */
-                    i2c_smbus_write_byte_data(client, W83795ADG_REG_BANK, 0x00);
-                    /* Enable monitoring operations */
-                    configByte |= 0x01;
-                    i2c_smbus_write_byte_data(client, W83795ADG_REG_CONFIG, configByte);
-                }
-            }
+                case 5: /* 40 second delay */
+                    data->wdReg |= 0x28;
+                    break;
 
-            if (fanCtrlDelay > 0)
-                fanCtrlDelay --;
+                case 6: /* 48 second delay */
+                    data->wdReg |= 0x18;
+                    break;
 
-            data->psuPG =  platformPsuPG = i2c_smbus_read_byte_data(&cpld_client, CPLD_REG_GENERAL_0x02);
-            data->psuABS =  platformPsuABS = i2c_smbus_read_byte_data(&cpld_client, CPLD_REG_GENERAL_0x03);
-            switch(platformModelId)
-            {
-                case NCIIX_WITH_BMC:
-                case NCIIX_WITHOUT_BMC:
-                    for (i=0; i<5 ; i++)
-                    {
-                        /* Turn on PCA9548#0 channel 3~7 on I2C-bus0 */
-                        i2c_smbus_write_byte_data(&pca9548_client_bus0, 0, (1<<(PCA9548_CH03+i)));
-                        for (j=0; j<4; j++)
-                        {
-                            port_status = i2c_smbus_read_word_data(&(pca9535_client_bus0[j]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
-                            port = ((j*2)+(i*8));
-                            SFPPortTxFaultStatus[port] = (PCA9553_TEST_BIT(port_status, 0)==0);
-                            SFPPortAbsStatus[port] = (PCA9553_TEST_BIT(port_status, 1)==0);
-                            SFPPortRxLosStatus[port] = (PCA9553_TEST_BIT(port_status, 2)==0);
-                            port++;
-                            SFPPortTxFaultStatus[port] = (PCA9553_TEST_BIT(port_status, 6)==0);
-                            SFPPortAbsStatus[port] = (PCA9553_TEST_BIT(port_status, 7)==0);
-                            SFPPortRxLosStatus[port] = (PCA9553_TEST_BIT(port_status, 8)==0);
-                        }
-                        i2c_smbus_write_byte_data(&pca9548_client_bus0, 0, 0x00);
-                    }
+                case 7: /* 56 second delay */
+                    data->wdReg |= 0x38;
                     break;
 
-                default:
+                default: /* 8 second delay */
+                    data->wdReg |= 0x20;
                     break;
             }
+            i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06, data->wdReg);
+            data->wdRefreshTimeSelectFlag = 0;
+        }
 
-            /* Watchdog Control Register Support */
-            if (data->cpldRev != 0)
-            {
-                if (data->wdEnable == 1) /* Watchdog Timer is enabled */
-                {
-                    if (data->wdRefreshControl == 0) /* Refresh Watchdog by Hardware Monitor */
-                    {
-                        data->wdReg = i2c_smbus_read_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06);
-                        data->wdReg |= 0x01; /* clear timer */
-                        i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06, data->wdReg);
-                    }
-                    else if (data->wdRefreshControl == 1) /* Refresh Watchdog by application */
-                    {
-                        if (data->wdRefreshControlFlag == 1)
-                        {
-                            data->wdReg = i2c_smbus_read_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06);
-                            data->wdReg |= 0x01; /* clear timer */
-                            i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06, data->wdReg);
-                            data->wdRefreshControlFlag = 0;
-                        }
-                    }
+        /* Watchdog Timeout occurrence */
+        if (data->wdTimeoutSelectFlag == 1)
+        {
+            data->wdReg = i2c_smbus_read_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06);
+            data->wdReg |= 0x01; /* clear timer */
+            if (data->wdTimeoutSelect == 0) /* System reset */
+                data->wdReg &= (~0x02);
+            else /* Power cycle */
+                data->wdReg |= 0x02;
+            i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06, data->wdReg);
+            data->wdTimeoutSelectFlag = 0;
+        }
+    }
+    else /* Watchdog Timer is disabled */
+    {
+        data->wdReg = i2c_smbus_read_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06);
+        data->wdReg |= 0x01; /* Enable WD function */
+#if 0
+        data->wdReg &= (~0x02); /* default select System reset */
+#else
+        data->wdReg |= 0x02; /* default select Power cycle */
+        data->wdTimeoutSelect = 1;
+#endif
+        data->wdReg &= (~0x38);
+        data->wdReg |= 0x20; /* default select 8 second delay */
+        data->wdRefreshTimeSelect = 1;
+        i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06, data->wdReg);
+        data->wdEnable = 1;
+    }
+}
 
-                    /* Watchdog Timer timeout setting */
-                    if (data->wdRefreshTimeSelectFlag == 1)
-                    {
-                        data->wdReg = i2c_smbus_read_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06);
-                        data->wdReg |= 0x01; /* clear timer */
-                        data->wdReg &= (~0x38);
-                        switch(data->wdRefreshTimeSelect)
-                        {
-                            case 1: /* 8 second delay */
-                                data->wdReg |= 0x20;
-                                break;
+static void i2c_bus0_hardware_monitor_sensors_get(struct i2c_bus0_hardware_monitor_data *data,
+        struct i2c_bus0_hardware_monitor_sensors *sensors)
+{
+    unsigned int seq;
 
-                            case 2: /* 16 second delay */
-                                data->wdReg |= 0x10;
-                                break;
+    do {
+        seq = read_seqbegin(&data->snapshot_lock);
+        *sensors = data->sensors;
+    } while (read_seqretry(&data->snapshot_lock, seq));
+}
 
-                            case 3: /* 24 second delay */
-                                data->wdReg |= 0x30;
-                                break;
+/*
+ * Each tick services the watchdog first, then reads the sensor groups
+ * which are due into a private copy. data->lock is only held for one
+ * group at a time. The copy is published once the tick is done.
+ */
+static int i2c_bus0_hardware_monitor_update_thread(void *p)
+{
+    struct i2c_client *client = p;
+    struct i2c_bus0_hardware_monitor_data *data = i2c_get_clientdata(client);
+    struct i2c_bus0_hardware_monitor_sensors sensors;
+    unsigned long next[BUS0_GROUP_COUNT];
+    unsigned long nextWatchdog;
+    int g, fanErr = 0, updated;
+    unsigned int LastTemp = 0;
+    unsigned int fanCtrlDelay = 5;
 
-                            case 4: /* 32 second delay */
-                                data->wdReg |= 0x08;
-                                break;
+    memset(&sensors, 0, sizeof(sensors));
+    nextWatchdog = jiffies;
+    for (g=0; g<BUS0_GROUP_COUNT; g++)
+        next[g] = jiffies;
 
-                            case 5: /* 40 second delay */
-                                data->wdReg |= 0x28;
-                                break;
+    while (!kthread_should_stop())
+    {
+        if (isBMCSupport == 0)
+        {
+            mutex_lock(&data->lock);
+            i2c_bus0_hardware_monitor_watchdog(data, time_after_eq(jiffies, nextWatchdog));
+            mutex_unlock(&data->lock);
+            if (time_after_eq(jiffies, nextWatchdog))
+                nextWatchdog = jiffies + msecs_to_jiffies(HW_MONITOR_WATCHDOG_PERIOD);
 
-                            case 6: /* 48 second delay */
-                                data->wdReg |= 0x18;
-                                break;
+            updated = 0;
+            for (g=0; g<BUS0_GROUP_COUNT; g++)
+            {
+                if (!time_after_eq(jiffies, next[g]))
+                    continue;
+                next[g] = jiffies + msecs_to_jiffies(i2c_bus0_hardware_monitor_group_period[g]);
 
-                            case 7: /* 56 second delay */
-                                data->wdReg |= 0x38;
-                                break;
+                mutex_lock(&data->lock);
+                switch (g)
+                {
+                    case BUS0_GROUP_FAN:
+                        fanErr = i2c_bus0_hardware_monitor_fan_update(client, data, &sensors);
+                        break;
 
-                            default: /* 8 second delay */
-                                data->wdReg |= 0x20;
-                                break;
-                        }
-                        i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06, data->wdReg);
-                        data->wdRefreshTimeSelectFlag = 0;
-                    }
+                    case BUS0_GROUP_TEMP:
+                        i2c_bus0_hardware_monitor_temp_update(client, data, &sensors);
+                        if (fanCtrlDelay == 0)
+                            i2c_bus0_hardware_monitor_fan_control(client, data, &sensors, fanErr, &LastTemp);
+                        else
+                            fanCtrlDelay --;
+                        break;
 
-                    /* Watchdog Timeout occurrence */
-                    if (data->wdTimeoutSelectFlag == 1)
-                    {
-                        data->wdReg = i2c_smbus_read_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06);
-                        data->wdReg |= 0x01; /* clear timer */
-                        if (data->wdTimeoutSelect == 0) /* System reset */
-                            data->wdReg &= (~0x02);
-                        else /* Power cycle */
-                            data->wdReg |= 0x02;
-                        i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06, data->wdReg);
-                        data->wdTimeoutSelectFlag = 0;
-                    }
-                }
-                else /* Watchdog Timer is disabled */
-                {
-                    data->wdReg = i2c_smbus_read_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06);
-                    data->wdReg |= 0x01; /* Enable WD function */
-#if 0
-                    data->wdReg &= (~0x02); /* default select System reset */
-#else
-                    data->wdReg |= 0x02; /* default select Power cycle */
-                    data->wdTimeoutSelect = 1;
-#endif
-                    data->wdReg &= (~0x38);
-                    data->wdReg |= 0x20; /* default select 8 second delay */
-                    data->wdRefreshTimeSelect = 1;
-                    i2c_smbus_write_byte_data(&cpld_client, CPLD_REG_GENERAL_0x06, data->wdReg);
-                    data->wdEnable = 1;
+                    case BUS0_GROUP_VOLTAGE:
+                        i2c_bus0_hardware_monitor_voltage_update(client, data, &sensors);
+                        break;
+
+                    case BUS0_GROUP_PSU:
+                        i2c_bus0_hardware_monitor_psu_update(client, data, &sensors);
+                        break;
+
+                    case BUS0_GROUP_PORT:
+                        i2c_bus0_hardware_monitor_port_update(client, data, &sensors);
+                        break;
+
+                    default:
+                        break;
                 }
+                mutex_unlock(&data->lock);
+                updated = 1;
+
+                if (kthread_should_stop())
+                    break;
+            }
+
+            if (updated)
+            {
+                write_seqlock(&data->snapshot_lock);
+                data->sensors = sensors;
+                data->hardware_monitor_last_updated = jiffies;
+                data->hardware_monitor_data_valid = 1;
+                write_sequnlock(&data->snapshot_lock);
             }
-            mutex_unlock(&data->lock);
         }
 
         if (kthread_should_stop())
             break;
-        msleep_interruptible(1000);
+        msleep_interruptible(HW_MONITOR_TICK);
     }
 
     complete_all(&data->auto_update_stop);
     return 0;
 }
 
+/*
+ * Each iteration runs one step of the port/fan sweep on data->work and
+ * then publishes it, so readers of data->ports never wait for the bus.
+ */
 static int i2c_bus1_hardware_monitor_update_thread(void *p)
 {
     struct i2c_client *client = p;
     struct i2c_bus1_hardware_monitor_data *data = i2c_get_clientdata(client);
+    struct i2c_bus1_hardware_monitor_ports *work = &data->work;
     int i, ret;
     unsigned short value, value2, fanErr, fanErr2;
     unsigned int step = 0;
@@ -1122,13 +1304,13 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                         /* QSFP Port */
                         for (i=0; i<2; i++)
-                            data->qsfpPortAbsStatus[i] = i2c_smbus_read_word_data(&(pca9535pwr_client[i]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
+                            work->qsfpPortAbsStatus[i] = i2c_smbus_read_word_data(&(pca9535pwr_client[i]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
 
                         step = 1;
                         break;
 
                     case 1:
-                        if ((data->qsfpPortAbsStatus[0]&0x00ff)!=0x00ff)  /* QSFP 0~7 ABS */
+                        if ((work->qsfpPortAbsStatus[0]&0x00ff)!=0x00ff)  /* QSFP 0~7 ABS */
                         {
                             /* Turn on PCA9548 channel 0 on I2C-bus1 */
                             ret = i2c_smbus_write_byte(client, (1<<PCA9548_CH00));
@@ -1137,7 +1319,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                             for (i=0; i<8; i++)
                             {
-                                if (PCA9553_TEST_BIT(data->qsfpPortAbsStatus[0], i) == 0) /* present */
+                                if (PCA9553_TEST_BIT(work->qsfpPortAbsStatus[0], i) == 0) /* present */
                                 {
                                     ret = i2c_smbus_write_byte(&(pca9548_client[0]), (1<<i));
                                     if (ret>=0)
@@ -1150,16 +1332,16 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                                         ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                         if (ret>=0)
                                         {
-                                            memcpy(&(data->qsfpPortDataA0[i][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                            PCA9553_SET_BIT(data->qsfpPortDataValid[0], i);
+                                            memcpy(&(work->qsfpPortDataA0[i][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                            PCA9553_SET_BIT(work->qsfpPortDataValid[0], i);
                                         }
                                     }
                                     i2c_smbus_write_byte(&(pca9548_client[0]), 0x00);
                                 }
                                 else
                                 {
-                                    memset(&(data->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
-                                    PCA9553_CLEAR_BIT(data->qsfpPortDataValid[0], i);
+                                    memset(&(work->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
+                                    PCA9553_CLEAR_BIT(work->qsfpPortDataValid[0], i);
                                     data->qsfpPortTxDisableDataUpdate[i] = 1;
                                 }
                             }
@@ -1168,8 +1350,8 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         {
                             for (i=0; i<8; i++)
                             {
-                                memset(&(data->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
-                                PCA9553_CLEAR_BIT(data->qsfpPortDataValid[0], i);
+                                memset(&(work->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
+                                PCA9553_CLEAR_BIT(work->qsfpPortDataValid[0], i);
                                 data->qsfpPortTxDisableDataUpdate[i] = 1;
                             }
                         }
@@ -1178,7 +1360,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         break;
 
                     case 2:
-                        if ((data->qsfpPortAbsStatus[0]&0xff00)!=0xff00)  /* QSFP 8~15 ABS */
+                        if ((work->qsfpPortAbsStatus[0]&0xff00)!=0xff00)  /* QSFP 8~15 ABS */
                         {
                             /* Turn on PCA9548 channel 1 on I2C-bus1 */
                             ret = i2c_smbus_write_byte(client, (1<<PCA9548_CH01));
@@ -1187,7 +1369,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                             for (i=8; i<16; i++)
                             {
-                                if (PCA9553_TEST_BIT(data->qsfpPortAbsStatus[0], i) == 0) /* present */
+                                if (PCA9553_TEST_BIT(work->qsfpPortAbsStatus[0], i) == 0) /* present */
                                 {
                                     ret = i2c_smbus_write_byte(&(pca9548_client[1]), (1<<(i-8)));
                                     if (ret>=0)
@@ -1200,16 +1382,16 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                                         ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                         if (ret>=0)
                                         {
-                                            memcpy(&(data->qsfpPortDataA0[i][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                            PCA9553_SET_BIT(data->qsfpPortDataValid[0], i);
+                                            memcpy(&(work->qsfpPortDataA0[i][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                            PCA9553_SET_BIT(work->qsfpPortDataValid[0], i);
                                         }
                                     }
                                     i2c_smbus_write_byte(&(pca9548_client[1]), 0x00);
                                 }
                                 else
                                 {
-                                    memset(&(data->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
-                                    PCA9553_CLEAR_BIT(data->qsfpPortDataValid[0], i);
+                                    memset(&(work->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
+                                    PCA9553_CLEAR_BIT(work->qsfpPortDataValid[0], i);
                                     data->qsfpPortTxDisableDataUpdate[i] = 1;
                                 }
                             }
@@ -1218,8 +1400,8 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         {
                             for (i=8; i<16; i++)
                             {
-                                memset(&(data->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
-                                PCA9553_CLEAR_BIT(data->qsfpPortDataValid[0], i);
+                                memset(&(work->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
+                                PCA9553_CLEAR_BIT(work->qsfpPortDataValid[0], i);
                                 data->qsfpPortTxDisableDataUpdate[i] = 1;
                             }
                         }
@@ -1228,7 +1410,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         break;
 
                     case 3:
-                        if ((data->qsfpPortAbsStatus[1]&0x00ff)!=0x00ff)  /* QSFP 16~23 ABS */
+                        if ((work->qsfpPortAbsStatus[1]&0x00ff)!=0x00ff)  /* QSFP 16~23 ABS */
                         {
                             /* Turn on PCA9548 channel 2 on I2C-bus1 */
                             ret = i2c_smbus_write_byte(client, (1<<PCA9548_CH02));
@@ -1237,7 +1419,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                             for (i=0; i<8; i++)
                             {
-                                if (PCA9553_TEST_BIT(data->qsfpPortAbsStatus[1], i) == 0) /* present */
+                                if (PCA9553_TEST_BIT(work->qsfpPortAbsStatus[1], i) == 0) /* present */
                                 {
                                     ret = i2c_smbus_write_byte(&(pca9548_client[2]), (1<<i));
                                     if (ret>=0)
@@ -1250,16 +1432,16 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                                         ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                         if (ret>=0)
                                         {
-                                            memcpy(&(data->qsfpPortDataA0[i+16][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                            PCA9553_SET_BIT(data->qsfpPortDataValid[1], i);
+                                            memcpy(&(work->qsfpPortDataA0[i+16][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                            PCA9553_SET_BIT(work->qsfpPortDataValid[1], i);
                                         }
                                     }
                                     i2c_smbus_write_byte(&(pca9548_client[2]), 0x00);
                                 }
                                 else
                                 {
-                                    memset(&(data->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
-                                    PCA9553_CLEAR_BIT(data->qsfpPortDataValid[1], i);
+                                    memset(&(work->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
+                                    PCA9553_CLEAR_BIT(work->qsfpPortDataValid[1], i);
                                     data->qsfpPortTxDisableDataUpdate[i+16] = 1;
                                 }
                             }
@@ -1268,8 +1450,8 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         {
                             for (i=0; i<8; i++)
                             {
-                                memset(&(data->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
-                                PCA9553_CLEAR_BIT(data->qsfpPortDataValid[1], i);
+                                memset(&(work->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
+                                PCA9553_CLEAR_BIT(work->qsfpPortDataValid[1], i);
                                 data->qsfpPortTxDisableDataUpdate[i+16] = 1;
                             }
                         }
@@ -1278,7 +1460,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         break;
 
                     case 4:
-                        if ((data->qsfpPortAbsStatus[1]&0xff00)!=0xff00)  /* QSFP 24~31 ABS */
+                        if ((work->qsfpPortAbsStatus[1]&0xff00)!=0xff00)  /* QSFP 24~31 ABS */
                         {
                             /* Turn on PCA9548 channel 3 on I2C-bus1 */
                             ret = i2c_smbus_write_byte(client, (1<<PCA9548_CH03));
@@ -1287,7 +1469,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                             for (i=8; i<16; i++)
                             {
-                                if (PCA9553_TEST_BIT(data->qsfpPortAbsStatus[1], i) == 0) /* present */
+                                if (PCA9553_TEST_BIT(work->qsfpPortAbsStatus[1], i) == 0) /* present */
                                 {
                                     ret = i2c_smbus_write_byte(&(pca9548_client[3]), (1<<(i-8)));
                                     if (ret>=0)
@@ -1300,16 +1482,16 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                                         ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                         if (ret>=0)
                                         {
-                                            memcpy(&(data->qsfpPortDataA0[i+16][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                            PCA9553_SET_BIT(data->qsfpPortDataValid[1], i);
+                                            memcpy(&(work->qsfpPortDataA0[i+16][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                            PCA9553_SET_BIT(work->qsfpPortDataValid[1], i);
                                         }
                                     }
                                     i2c_smbus_write_byte(&(pca9548_client[3]),  0x00);
                                 }
                                 else
                                 {
-                                    memset(&(data->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
-                                    PCA9553_CLEAR_BIT(data->qsfpPortDataValid[1], i);
+                                    memset(&(work->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
+                                    PCA9553_CLEAR_BIT(work->qsfpPortDataValid[1], i);
                                     data->qsfpPortTxDisableDataUpdate[i+16] = 1;
                                 }
                             }
@@ -1318,8 +1500,8 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         {
                             for (i=8; i<16; i++)
                             {
-                                memset(&(data->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
-                                PCA9553_CLEAR_BIT(data->qsfpPortDataValid[1], i);
+                                memset(&(work->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
+                                PCA9553_CLEAR_BIT(work->qsfpPortDataValid[1], i);
                                 data->qsfpPortTxDisableDataUpdate[i+16] = 1;
                             }
                         }
@@ -1412,9 +1594,9 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                         /* FAN Status */
                         value =  i2c_smbus_read_word_data(&(pca9535pwr_client[0]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
-                        data->fanAbs[0] = (value&0x4444);
-                        data->fanDir[0] = (value&0x8888);
-                        FanDir = data->fanDir[0];
+                        work->fanAbs[0] = (value&0x4444);
+                        work->fanDir[0] = (value&0x8888);
+                        FanDir = work->fanDir[0];
 
                         step = 0;
                         break;
@@ -1443,7 +1625,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                         /* SFP Port */
                         for (i=0; i<4; i++)
-                            data->qsfpPortAbsStatus[i] = i2c_smbus_read_word_data(&(pca9535pwr_client[i]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
+                            work->qsfpPortAbsStatus[i] = i2c_smbus_read_word_data(&(pca9535pwr_client[i]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
 
                         /* Turn on PCA9548#1 channel 1 on I2C-bus1 */
                         ret = i2c_smbus_write_byte(&(pca9548_client[1]), (1<<PCA9548_CH01));
@@ -1452,7 +1634,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                         /* SFP Port - RXLOS */
                         for (i=0; i<3; i++)
-                            data->sfpPortRxLosStatus[i] = i2c_smbus_read_word_data(&(pca9535pwr_client[i]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
+                            work->sfpPortRxLosStatus[i] = i2c_smbus_read_word_data(&(pca9535pwr_client[i]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
 
                         /* Turn on PCA9548#1 channel 2 on I2C-bus1 */
                         ret = i2c_smbus_write_byte(&(pca9548_client[1]), (1<<PCA9548_CH02));
@@ -1461,13 +1643,13 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                         /* SFP Port - TX_FAULT */
                         for (i=0; i<3; i++)
-                            data->sfpPortTxFaultStatus[i] = i2c_smbus_read_word_data(&(pca9535pwr_client[i]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
+                            work->sfpPortTxFaultStatus[i] = i2c_smbus_read_word_data(&(pca9535pwr_client[i]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
 
                         step = 1;
                         break;
 
                     case 1:
-                        if ((data->qsfpPortAbsStatus[0]&0x00ff)!=0x00ff)  /* SFP 0~7 ABS */
+                        if ((work->qsfpPortAbsStatus[0]&0x00ff)!=0x00ff)  /* SFP 0~7 ABS */
                         {
                             /* Turn on PCA9548#0 channel 0 on I2C-bus1 */
                             ret = i2c_smbus_write_byte(client, (1<<PCA9548_CH00));
@@ -1476,35 +1658,35 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                             for (i=0; i<8; i++)
                             {
-                                if (PCA9553_TEST_BIT(data->qsfpPortAbsStatus[0], i) == 0) /* present */
+                                if (PCA9553_TEST_BIT(work->qsfpPortAbsStatus[0], i) == 0) /* present */
                                 {
                                     ret = i2c_smbus_write_byte(&(pca9548_client[0]), (1<<i));
                                     if (ret>=0)
                                     {
-                                        if (PCA9553_TEST_BIT(data->qsfpPortDataValid[0], i) == 0)
+                                        if (PCA9553_TEST_BIT(work->qsfpPortDataValid[0], i) == 0)
                                         {
                                             ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                             if (ret>=0)
                                             {
-                                                memcpy(&(data->qsfpPortDataA0[i][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                                PCA9553_SET_BIT(data->qsfpPortDataValid[0], i);
+                                                memcpy(&(work->qsfpPortDataA0[i][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                                PCA9553_SET_BIT(work->qsfpPortDataValid[0], i);
                                             }
                                         }
                                         ret = eepromDataBlockRead(&qsfpDataA2_client,qsfpPortData);
                                         if (ret>=0)
-                                            memcpy(&(data->qsfpPortDataA2[i][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                            memcpy(&(work->qsfpPortDataA2[i][0]), qsfpPortData, QSFP_DATA_SIZE);
                                         ret = eepromDataWordRead(&SfpCopperData_client,SfpCopperPortData);
                                         if (ret>=0)
-                                            memcpy(&(data->SfpCopperPortData[i][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
+                                            memcpy(&(work->SfpCopperPortData[i][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
                                     }
                                     i2c_smbus_write_byte(&(pca9548_client[0]), 0x00);
                                 }
                                 else
                                 {
-                                    memset(&(data->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
-                                    memset(&(data->qsfpPortDataA2[i][0]), 0, QSFP_DATA_SIZE);
-                                    memset(&(data->SfpCopperPortData[i][0]), 0, SFP_COPPER_DATA_SIZE);
-                                    PCA9553_CLEAR_BIT(data->qsfpPortDataValid[0], i);
+                                    memset(&(work->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
+                                    memset(&(work->qsfpPortDataA2[i][0]), 0, QSFP_DATA_SIZE);
+                                    memset(&(work->SfpCopperPortData[i][0]), 0, SFP_COPPER_DATA_SIZE);
+                                    PCA9553_CLEAR_BIT(work->qsfpPortDataValid[0], i);
                                 }
                             }
                         }
@@ -1512,10 +1694,10 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         {
                             for (i=0; i<8; i++)
                             {
-                                memset(&(data->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->qsfpPortDataA2[i][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->SfpCopperPortData[i][0]), 0, SFP_COPPER_DATA_SIZE);
-                                PCA9553_CLEAR_BIT(data->qsfpPortDataValid[0], i);
+                                memset(&(work->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->qsfpPortDataA2[i][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->SfpCopperPortData[i][0]), 0, SFP_COPPER_DATA_SIZE);
+                                PCA9553_CLEAR_BIT(work->qsfpPortDataValid[0], i);
                             }
                         }
 
@@ -1523,7 +1705,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         break;
 
                     case 2:
-                        if ((data->qsfpPortAbsStatus[0]&0xff00)!=0xff00)  /* SFP 8~15 ABS */
+                        if ((work->qsfpPortAbsStatus[0]&0xff00)!=0xff00)  /* SFP 8~15 ABS */
                         {
                             /* Turn on PCA9548#0 channel 1 on I2C-bus1 */
                             ret = i2c_smbus_write_byte(client, (1<<PCA9548_CH01));
@@ -1532,35 +1714,35 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                             for (i=8; i<16; i++)
                             {
-                                if (PCA9553_TEST_BIT(data->qsfpPortAbsStatus[0], i) == 0) /* present */
+                                if (PCA9553_TEST_BIT(work->qsfpPortAbsStatus[0], i) == 0) /* present */
                                 {
                                     ret = i2c_smbus_write_byte(&(pca9548_client[0]), (1<<(i-8)));
                                     if (ret>=0)
                                     {
-                                        if (PCA9553_TEST_BIT(data->qsfpPortDataValid[0], i) == 0)
+                                        if (PCA9553_TEST_BIT(work->qsfpPortDataValid[0], i) == 0)
                                         {
                                             ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                             if (ret>=0)
                                             {
-                                                memcpy(&(data->qsfpPortDataA0[i][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                                PCA9553_SET_BIT(data->qsfpPortDataValid[0], i);
+                                                memcpy(&(work->qsfpPortDataA0[i][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                                PCA9553_SET_BIT(work->qsfpPortDataValid[0], i);
                                             }
                                         }
                                         ret = eepromDataBlockRead(&qsfpDataA2_client,qsfpPortData);
                                         if (ret>=0)
-                                            memcpy(&(data->qsfpPortDataA2[i][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                            memcpy(&(work->qsfpPortDataA2[i][0]), qsfpPortData, QSFP_DATA_SIZE);
                                         ret = eepromDataWordRead(&SfpCopperData_client,SfpCopperPortData);
                                         if (ret>=0)
-                                            memcpy(&(data->SfpCopperPortData[i][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
+                                            memcpy(&(work->SfpCopperPortData[i][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
                                     }
                                     i2c_smbus_write_byte(&(pca9548_client[0]), 0x00);
                                 }
                                 else
                                 {
-                                    memset(&(data->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
-                                    memset(&(data->qsfpPortDataA2[i][0]), 0, QSFP_DATA_SIZE);
-                                    memset(&(data->SfpCopperPortData[i][0]), 0, SFP_COPPER_DATA_SIZE);
-                                    PCA9553_CLEAR_BIT(data->qsfpPortDataValid[0], i);
+                                    memset(&(work->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
+                                    memset(&(work->qsfpPortDataA2[i][0]), 0, QSFP_DATA_SIZE);
+                                    memset(&(work->SfpCopperPortData[i][0]), 0, SFP_COPPER_DATA_SIZE);
+                                    PCA9553_CLEAR_BIT(work->qsfpPortDataValid[0], i);
                                 }
                             }
                         }
@@ -1568,10 +1750,10 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         {
                             for (i=8; i<16; i++)
                             {
-                                memset(&(data->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->qsfpPortDataA2[i][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->SfpCopperPortData[i][0]), 0, SFP_COPPER_DATA_SIZE);
-                                PCA9553_CLEAR_BIT(data->qsfpPortDataValid[0], i);
+                                memset(&(work->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->qsfpPortDataA2[i][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->SfpCopperPortData[i][0]), 0, SFP_COPPER_DATA_SIZE);
+                                PCA9553_CLEAR_BIT(work->qsfpPortDataValid[0], i);
                             }
                         }
 
@@ -1579,7 +1761,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         break;
 
                     case 3:
-                        if ((data->qsfpPortAbsStatus[1]&0x00ff)!=0x00ff)  /* SFP 16~23 ABS */
+                        if ((work->qsfpPortAbsStatus[1]&0x00ff)!=0x00ff)  /* SFP 16~23 ABS */
                         {
                             /* Turn on PCA9548#0 channel 2 on I2C-bus1 */
                             ret = i2c_smbus_write_byte(client, (1<<PCA9548_CH02));
@@ -1588,35 +1770,35 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                             for (i=0; i<8; i++)
                             {
-                                if (PCA9553_TEST_BIT(data->qsfpPortAbsStatus[1], i) == 0) /* present */
+                                if (PCA9553_TEST_BIT(work->qsfpPortAbsStatus[1], i) == 0) /* present */
                                 {
                                     ret = i2c_smbus_write_byte(&(pca9548_client[0]), (1<<i));
                                     if (ret>=0)
                                     {
-                                        if (PCA9553_TEST_BIT(data->qsfpPortDataValid[1], i) == 0)
+                                        if (PCA9553_TEST_BIT(work->qsfpPortDataValid[1], i) == 0)
                                         {
                                             ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                             if (ret>=0)
                                             {
-                                                memcpy(&(data->qsfpPortDataA0[i+16][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                                PCA9553_SET_BIT(data->qsfpPortDataValid[1], i);
+                                                memcpy(&(work->qsfpPortDataA0[i+16][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                                PCA9553_SET_BIT(work->qsfpPortDataValid[1], i);
                                             }
                                         }
                                         ret = eepromDataBlockRead(&qsfpDataA2_client,qsfpPortData);
                                         if (ret>=0)
-                                            memcpy(&(data->qsfpPortDataA2[i+16][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                            memcpy(&(work->qsfpPortDataA2[i+16][0]), qsfpPortData, QSFP_DATA_SIZE);
                                         ret = eepromDataWordRead(&SfpCopperData_client,SfpCopperPortData);
                                         if (ret>=0)
-                                            memcpy(&(data->SfpCopperPortData[i+16][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
+                                            memcpy(&(work->SfpCopperPortData[i+16][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
                                     }
                                     i2c_smbus_write_byte(&(pca9548_client[0]), 0x00);
                                 }
                                 else
                                 {
-                                    memset(&(data->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
-                                    memset(&(data->qsfpPortDataA2[i+16][0]), 0, QSFP_DATA_SIZE);
-                                    memset(&(data->SfpCopperPortData[i+16][0]), 0, SFP_COPPER_DATA_SIZE);
-                                    PCA9553_CLEAR_BIT(data->qsfpPortDataValid[1], i);
+                                    memset(&(work->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
+                                    memset(&(work->qsfpPortDataA2[i+16][0]), 0, QSFP_DATA_SIZE);
+                                    memset(&(work->SfpCopperPortData[i+16][0]), 0, SFP_COPPER_DATA_SIZE);
+                                    PCA9553_CLEAR_BIT(work->qsfpPortDataValid[1], i);
                                 }
                             }
                         }
@@ -1624,10 +1806,10 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         {
                             for (i=0; i<8; i++)
                             {
-                                memset(&(data->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->qsfpPortDataA2[i+16][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->SfpCopperPortData[i+16][0]), 0, SFP_COPPER_DATA_SIZE);
-                                PCA9553_CLEAR_BIT(data->qsfpPortDataValid[1], i);
+                                memset(&(work->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->qsfpPortDataA2[i+16][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->SfpCopperPortData[i+16][0]), 0, SFP_COPPER_DATA_SIZE);
+                                PCA9553_CLEAR_BIT(work->qsfpPortDataValid[1], i);
                             }
                         }
 
@@ -1635,7 +1817,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         break;
 
                     case 4:
-                        if ((data->qsfpPortAbsStatus[1]&0xff00)!=0xff00)  /* SFP 24~31 ABS */
+                        if ((work->qsfpPortAbsStatus[1]&0xff00)!=0xff00)  /* SFP 24~31 ABS */
                         {
                             /* Turn on PCA9548#0 channel 3 on I2C-bus1 */
                             ret = i2c_smbus_write_byte(client, (1<<PCA9548_CH03));
@@ -1644,35 +1826,35 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                             for (i=8; i<16; i++)
                             {
-                                if (PCA9553_TEST_BIT(data->qsfpPortAbsStatus[1], i) == 0) /* present */
+                                if (PCA9553_TEST_BIT(work->qsfpPortAbsStatus[1], i) == 0) /* present */
                                 {
                                     ret = i2c_smbus_write_byte(&(pca9548_client[0]), (1<<(i-8)));
                                     if (ret>=0)
                                     {
-                                        if (PCA9553_TEST_BIT(data->qsfpPortDataValid[1], i) == 0)
+                                        if (PCA9553_TEST_BIT(work->qsfpPortDataValid[1], i) == 0)
                                         {
                                             ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                             if (ret>=0)
                                             {
-                                                memcpy(&(data->qsfpPortDataA0[i+16][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                                PCA9553_SET_BIT(data->qsfpPortDataValid[1], i);
+                                                memcpy(&(work->qsfpPortDataA0[i+16][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                                PCA9553_SET_BIT(work->qsfpPortDataValid[1], i);
                                             }
                                         }
                                         ret = eepromDataBlockRead(&qsfpDataA2_client,qsfpPortData);
                                         if (ret>=0)
-                                            memcpy(&(data->qsfpPortDataA2[i+16][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                            memcpy(&(work->qsfpPortDataA2[i+16][0]), qsfpPortData, QSFP_DATA_SIZE);
                                         ret = eepromDataWordRead(&SfpCopperData_client,SfpCopperPortData);
                                         if (ret>=0)
-                                            memcpy(&(data->SfpCopperPortData[i+16][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
+                                            memcpy(&(work->SfpCopperPortData[i+16][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
                                     }
                                     i2c_smbus_write_byte(&(pca9548_client[0]),  0x00);
                                 }
                                 else
                                 {
-                                    memset(&(data->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
-                                    memset(&(data->qsfpPortDataA2[i+16][0]), 0, QSFP_DATA_SIZE);
-                                    memset(&(data->SfpCopperPortData[i+16][0]), 0, SFP_COPPER_DATA_SIZE);
-                                    PCA9553_CLEAR_BIT(data->qsfpPortDataValid[1], i);
+                                    memset(&(work->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
+                                    memset(&(work->qsfpPortDataA2[i+16][0]), 0, QSFP_DATA_SIZE);
+                                    memset(&(work->SfpCopperPortData[i+16][0]), 0, SFP_COPPER_DATA_SIZE);
+                                    PCA9553_CLEAR_BIT(work->qsfpPortDataValid[1], i);
                                 }
                             }
                         }
@@ -1680,10 +1862,10 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         {
                             for (i=8; i<16; i++)
                             {
-                                memset(&(data->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->qsfpPortDataA2[i+16][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->SfpCopperPortData[i+16][0]), 0, SFP_COPPER_DATA_SIZE);
-                                PCA9553_CLEAR_BIT(data->qsfpPortDataValid[1], i);
+                                memset(&(work->qsfpPortDataA0[i+16][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->qsfpPortDataA2[i+16][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->SfpCopperPortData[i+16][0]), 0, SFP_COPPER_DATA_SIZE);
+                                PCA9553_CLEAR_BIT(work->qsfpPortDataValid[1], i);
                             }
                         }
 
@@ -1691,7 +1873,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         break;
 
                     case 5:
-                        if ((data->qsfpPortAbsStatus[2]&0x00ff)!=0x00ff)  /* SFP 32~39 ABS */
+                        if ((work->qsfpPortAbsStatus[2]&0x00ff)!=0x00ff)  /* SFP 32~39 ABS */
                         {
                             /* Turn on PCA9548#0 channel 4 on I2C-bus1 */
                             ret = i2c_smbus_write_byte(client, (1<<PCA9548_CH04));
@@ -1700,35 +1882,35 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                             for (i=0; i<8; i++)
                             {
-                                if (PCA9553_TEST_BIT(data->qsfpPortAbsStatus[2], i) == 0) /* present */
+                                if (PCA9553_TEST_BIT(work->qsfpPortAbsStatus[2], i) == 0) /* present */
                                 {
                                     ret = i2c_smbus_write_byte(&(pca9548_client[0]), (1<<i));
                                     if (ret>=0)
                                     {
-                                        if (PCA9553_TEST_BIT(data->qsfpPortDataValid[2], i) == 0)
+                                        if (PCA9553_TEST_BIT(work->qsfpPortDataValid[2], i) == 0)
                                         {
                                             ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                             if (ret>=0)
                                             {
-                                                memcpy(&(data->qsfpPortDataA0[i+32][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                                PCA9553_SET_BIT(data->qsfpPortDataValid[2], i);
+                                                memcpy(&(work->qsfpPortDataA0[i+32][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                                PCA9553_SET_BIT(work->qsfpPortDataValid[2], i);
                                             }
                                         }
                                         ret = eepromDataBlockRead(&qsfpDataA2_client,qsfpPortData);
                                         if (ret>=0)
-                                            memcpy(&(data->qsfpPortDataA2[i+32][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                            memcpy(&(work->qsfpPortDataA2[i+32][0]), qsfpPortData, QSFP_DATA_SIZE);
                                         ret = eepromDataWordRead(&SfpCopperData_client,SfpCopperPortData);
                                         if (ret>=0)
-                                            memcpy(&(data->SfpCopperPortData[i+32][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
+                                            memcpy(&(work->SfpCopperPortData[i+32][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
                                     }
                                     i2c_smbus_write_byte(&(pca9548_client[0]), 0x00);
                                 }
                                 else
                                 {
-                                    memset(&(data->qsfpPortDataA0[i+32][0]), 0, QSFP_DATA_SIZE);
-                                    memset(&(data->qsfpPortDataA2[i+32][0]), 0, QSFP_DATA_SIZE);
-                                    memset(&(data->SfpCopperPortData[i+32][0]), 0, SFP_COPPER_DATA_SIZE);
-                                    PCA9553_CLEAR_BIT(data->qsfpPortDataValid[2], i);
+                                    memset(&(work->qsfpPortDataA0[i+32][0]), 0, QSFP_DATA_SIZE);
+                                    memset(&(work->qsfpPortDataA2[i+32][0]), 0, QSFP_DATA_SIZE);
+                                    memset(&(work->SfpCopperPortData[i+32][0]), 0, SFP_COPPER_DATA_SIZE);
+                                    PCA9553_CLEAR_BIT(work->qsfpPortDataValid[2], i);
                                 }
                             }
                         }
@@ -1736,10 +1918,10 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         {
                             for (i=0; i<8; i++)
                             {
-                                memset(&(data->qsfpPortDataA0[i+32][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->qsfpPortDataA2[i+32][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->SfpCopperPortData[i+32][0]), 0, SFP_COPPER_DATA_SIZE);
-                                PCA9553_CLEAR_BIT(data->qsfpPortDataValid[2], i);
+                                memset(&(work->qsfpPortDataA0[i+32][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->qsfpPortDataA2[i+32][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->SfpCopperPortData[i+32][0]), 0, SFP_COPPER_DATA_SIZE);
+                                PCA9553_CLEAR_BIT(work->qsfpPortDataValid[2], i);
                             }
                         }
 
@@ -1747,7 +1929,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         break;
 
                     case 6:
-                        if ((data->qsfpPortAbsStatus[2]&0xff00)!=0xff00)  /* SFP 40~47 ABS */
+                        if ((work->qsfpPortAbsStatus[2]&0xff00)!=0xff00)  /* SFP 40~47 ABS */
                         {
                             /* Turn on PCA9548#0 channel 5 on I2C-bus1 */
                             ret = i2c_smbus_write_byte(client, (1<<PCA9548_CH05));
@@ -1756,35 +1938,35 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                             for (i=8; i<16; i++)
                             {
-                                if (PCA9553_TEST_BIT(data->qsfpPortAbsStatus[2], i) == 0) /* present */
+                                if (PCA9553_TEST_BIT(work->qsfpPortAbsStatus[2], i) == 0) /* present */
                                 {
                                     ret = i2c_smbus_write_byte(&(pca9548_client[0]), (1<<(i-8)));
                                     if (ret>=0)
                                     {
-                                        if (PCA9553_TEST_BIT(data->qsfpPortDataValid[2], i) == 0)
+                                        if (PCA9553_TEST_BIT(work->qsfpPortDataValid[2], i) == 0)
                                         {
                                             ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                             if (ret>=0)
                                             {
-                                                memcpy(&(data->qsfpPortDataA0[i+32][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                                PCA9553_SET_BIT(data->qsfpPortDataValid[2], i);
+                                                memcpy(&(work->qsfpPortDataA0[i+32][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                                PCA9553_SET_BIT(work->qsfpPortDataValid[2], i);
                                             }
                                         }
                                         ret = eepromDataBlockRead(&qsfpDataA2_client,qsfpPortData);
                                         if (ret>=0)
-                                            memcpy(&(data->qsfpPortDataA2[i+32][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                            memcpy(&(work->qsfpPortDataA2[i+32][0]), qsfpPortData, QSFP_DATA_SIZE);
                                         ret = eepromDataWordRead(&SfpCopperData_client,SfpCopperPortData);
                                         if (ret>=0)
-                                            memcpy(&(data->SfpCopperPortData[i+32][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
+                                            memcpy(&(work->SfpCopperPortData[i+32][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
                                     }
                                     i2c_smbus_write_byte(&(pca9548_client[0]),  0x00);
                                 }
                                 else
                                 {
-                                    memset(&(data->qsfpPortDataA0[i+32][0]), 0, QSFP_DATA_SIZE);
-                                    memset(&(data->qsfpPortDataA2[i+32][0]), 0, QSFP_DATA_SIZE);
-                                    memset(&(data->SfpCopperPortData[i+32][0]), 0, SFP_COPPER_DATA_SIZE);
-                                    PCA9553_CLEAR_BIT(data->qsfpPortDataValid[2], i);
+                                    memset(&(work->qsfpPortDataA0[i+32][0]), 0, QSFP_DATA_SIZE);
+                                    memset(&(work->qsfpPortDataA2[i+32][0]), 0, QSFP_DATA_SIZE);
+                                    memset(&(work->SfpCopperPortData[i+32][0]), 0, SFP_COPPER_DATA_SIZE);
+                                    PCA9553_CLEAR_BIT(work->qsfpPortDataValid[2], i);
                                 }
                             }
                         }
@@ -1792,10 +1974,10 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         {
                             for (i=8; i<16; i++)
                             {
-                                memset(&(data->qsfpPortDataA0[i+32][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->qsfpPortDataA2[i+32][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->SfpCopperPortData[i+32][0]), 0, SFP_COPPER_DATA_SIZE);
-                                PCA9553_CLEAR_BIT(data->qsfpPortDataValid[2], i);
+                                memset(&(work->qsfpPortDataA0[i+32][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->qsfpPortDataA2[i+32][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->SfpCopperPortData[i+32][0]), 0, SFP_COPPER_DATA_SIZE);
+                                PCA9553_CLEAR_BIT(work->qsfpPortDataValid[2], i);
                             }
                         }
 
@@ -1803,7 +1985,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         break;
 
                     case 7:
-                        if ((data->qsfpPortAbsStatus[3]&0x00ff)!=0x00ff)  /* QSFP 0~5 ABS */
+                        if ((work->qsfpPortAbsStatus[3]&0x00ff)!=0x00ff)  /* QSFP 0~5 ABS */
                         {
                             /* Turn on PCA9548#0 channel 6 on I2C-bus1 */
                             ret = i2c_smbus_write_byte(client, (1<<PCA9548_CH06));
@@ -1812,7 +1994,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                             for (i=0; i<6; i++)
                             {
-                                if (PCA9553_TEST_BIT(data->qsfpPortAbsStatus[3], i) == 0) /* present */
+                                if (PCA9553_TEST_BIT(work->qsfpPortAbsStatus[3], i) == 0) /* present */
                                 {
                                     ret = i2c_smbus_write_byte(&(pca9548_client[0]), (1<<i));
                                     if (ret>=0)
@@ -1825,16 +2007,16 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                                         ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                         if (ret>=0)
                                         {
-                                            memcpy(&(data->qsfpPortDataA0[i+48][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                            PCA9553_SET_BIT(data->qsfpPortDataValid[3], i);
+                                            memcpy(&(work->qsfpPortDataA0[i+48][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                            PCA9553_SET_BIT(work->qsfpPortDataValid[3], i);
                                         }
                                     }
                                     i2c_smbus_write_byte(&(pca9548_client[0]), 0x00);
                                 }
                                 else
                                 {
-                                    memset(&(data->qsfpPortDataA0[i+48][0]), 0, QSFP_DATA_SIZE);
-                                    PCA9553_CLEAR_BIT(data->qsfpPortDataValid[3], i);
+                                    memset(&(work->qsfpPortDataA0[i+48][0]), 0, QSFP_DATA_SIZE);
+                                    PCA9553_CLEAR_BIT(work->qsfpPortDataValid[3], i);
                                     data->qsfpPortTxDisableDataUpdate[i+48] = 1;
                                 }
                             }
@@ -1843,8 +2025,8 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         {
                             for (i=0; i<6; i++)
                             {
-                                memset(&(data->qsfpPortDataA0[i+48][0]), 0, QSFP_DATA_SIZE);
-                                PCA9553_CLEAR_BIT(data->qsfpPortDataValid[3], i);
+                                memset(&(work->qsfpPortDataA0[i+48][0]), 0, QSFP_DATA_SIZE);
+                                PCA9553_CLEAR_BIT(work->qsfpPortDataValid[3], i);
                                 data->qsfpPortTxDisableDataUpdate[i+48] = 1;
                             }
                         }
@@ -1937,9 +2119,9 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                         /* FAN Status */
                         value =  i2c_smbus_read_word_data(&(pca9535pwr_client[0]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
-                        data->fanAbs[0] = (value&0x4444);
-                        data->fanDir[0] = (value&0x8888);
-                        FanDir = data->fanDir[0];
+                        work->fanAbs[0] = (value&0x4444);
+                        work->fanDir[0] = (value&0x8888);
+                        FanDir = work->fanDir[0];
 
                         step = 0;
                         break;
@@ -2090,9 +2272,9 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                             break;
 
                         value = i2c_smbus_read_word_data(&(pca9535pwr_client[0]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
-                        data->fanAbs[0] = (value&0x4444);
-                        data->fanDir[0] = (value&0x8888);
-                        FanDir = data->fanDir[0];
+                        work->fanAbs[0] = (value&0x4444);
+                        work->fanDir[0] = (value&0x8888);
+                        FanDir = work->fanDir[0];
 
 
                         i2c_smbus_write_byte_data(client, 0, 0x00);
@@ -2116,7 +2298,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                                     ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                     if (ret>=0)
                                     {
-                                        memcpy(&(data->qsfpPortDataA0[i][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                        memcpy(&(work->qsfpPortDataA0[i][0]), qsfpPortData, QSFP_DATA_SIZE);
                                         SFPPortDataValid[i] = 1;
                                     }
                                 }
@@ -2124,19 +2306,19 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                                 {
                                     ret = eepromDataBlockRead(&qsfpDataA2_client,qsfpPortData);
                                     if (ret>=0)
-                                        memcpy(&(data->qsfpPortDataA2[i][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                        memcpy(&(work->qsfpPortDataA2[i][0]), qsfpPortData, QSFP_DATA_SIZE);
                                     ret = eepromDataWordRead(&SfpCopperData_client,SfpCopperPortData);
                                     if (ret>=0)
-                                        memcpy(&(data->SfpCopperPortData[i][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
+                                        memcpy(&(work->SfpCopperPortData[i][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
                                 }
                                 i2c_smbus_write_byte_data(&(pca9548_client[0]), 0, 0x00);
                                 i2c_smbus_write_byte_data(&(pca9548_client[1]), 0, 0x00);
                             }
                             else
                             {
-                                 memset(&(data->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
-                                 memset(&(data->qsfpPortDataA2[i][0]), 0, QSFP_DATA_SIZE);
-                                 memset(&(data->SfpCopperPortData[i][0]), 0, SFP_COPPER_DATA_SIZE);
+                                 memset(&(work->qsfpPortDataA0[i][0]), 0, QSFP_DATA_SIZE);
+                                 memset(&(work->qsfpPortDataA2[i][0]), 0, QSFP_DATA_SIZE);
+                                 memset(&(work->SfpCopperPortData[i][0]), 0, SFP_COPPER_DATA_SIZE);
                                  data->qsfpPortTxDisableDataUpdate[i] = 1;
                                  SFPPortDataValid[i] = 0;
                              }
@@ -2162,10 +2344,10 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                         /* SFP Port 0~23, SFP Port - RXLOS */
                         for (i = 0; i < 10; i++)
-                            data->sfpPortAbsRxLosStatus[i] = i2c_smbus_read_byte_data(&(cpld_client_bus1), (0x20 + i));
+                            work->sfpPortAbsRxLosStatus[i] = i2c_smbus_read_byte_data(&(cpld_client_bus1), (0x20 + i));
 
-                        data->sfpPortAbsRxLosStatus[10] = i2c_smbus_read_byte_data(&(cpld_client_bus1), 0x30);
-                        data->sfpPortAbsRxLosStatus[11] = i2c_smbus_read_byte_data(&(cpld_client_bus1), 0x31);
+                        work->sfpPortAbsRxLosStatus[10] = i2c_smbus_read_byte_data(&(cpld_client_bus1), 0x30);
+                        work->sfpPortAbsRxLosStatus[11] = i2c_smbus_read_byte_data(&(cpld_client_bus1), 0x31);
 
                         /* Turn on PCA9548#0 channel 1 on I2C-bus1 */
                         ret = i2c_smbus_write_byte(client, (1 << PCA9548_CH01));
@@ -2174,10 +2356,10 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                         /* SFP Port 24~47, SFP Port - RXLOS */
                         for (i = 0; i < 10; i++)
-                            data->sfpPortAbsRxLosStatus[i + 12] = i2c_smbus_read_byte_data(&(cpld_client_bus1), 0x20 + i);
+                            work->sfpPortAbsRxLosStatus[i + 12] = i2c_smbus_read_byte_data(&(cpld_client_bus1), 0x20 + i);
 
-                        data->sfpPortAbsRxLosStatus[22] = i2c_smbus_read_byte_data(&(cpld_client_bus1), 0x30);
-                        data->sfpPortAbsRxLosStatus[23] = i2c_smbus_read_byte_data(&(cpld_client_bus1), 0x31);
+                        work->sfpPortAbsRxLosStatus[22] = i2c_smbus_read_byte_data(&(cpld_client_bus1), 0x30);
+                        work->sfpPortAbsRxLosStatus[23] = i2c_smbus_read_byte_data(&(cpld_client_bus1), 0x31);
 
                         /* Turn on PCA9548#0 channel 2 on I2C-bus1 */
                         ret = i2c_smbus_write_byte(client, (1 << PCA9548_CH02));
@@ -2186,7 +2368,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                         /* QSFP Port 48~63 */
                         for (i = 0; i < 16; i++)
-                            data->qsfpPortAbsStatusAst[i] = i2c_smbus_read_byte_data(&(cpld_client_bus1), (0x20 + i));
+                            work->qsfpPortAbsStatusAst[i] = i2c_smbus_read_byte_data(&(cpld_client_bus1), (0x20 + i));
 
                         step = 1;
                         break;
@@ -2199,7 +2381,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                         for (i = 0; i < 12; i++)  /* SFP 0,2,4 ... 22 */
                         {
-                            if ((data->sfpPortAbsRxLosStatus[i] & 0x02) == 0)  /* present */
+                            if ((work->sfpPortAbsRxLosStatus[i] & 0x02) == 0)  /* present */
                             {
                                 ret = i2c_smbus_write_byte_data(&(cpld_client_bus1), CPLD_REG_MUX, (0x01 + (i * 2)));
 
@@ -2209,29 +2391,29 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                                     if (ret >= 0)
                                     {
-                                        memcpy(&(data->qsfpPortDataA0[i * 2][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                        data->sfpPortDataValidAst[i * 2] = 1;
+                                        memcpy(&(work->qsfpPortDataA0[i * 2][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                        work->sfpPortDataValidAst[i * 2] = 1;
                                     }
                                     ret = eepromDataBlockRead(&qsfpDataA2_client,qsfpPortData);
-                                    memcpy(&(data->qsfpPortDataA2[i * 2][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                    memcpy(&(work->qsfpPortDataA2[i * 2][0]), qsfpPortData, QSFP_DATA_SIZE);
                                     ret = eepromDataWordRead(&SfpCopperData_client,SfpCopperPortData);
                                     if (ret>=0)
-                                        memcpy(&(data->SfpCopperPortData[i * 2][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
+                                        memcpy(&(work->SfpCopperPortData[i * 2][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
                                 }
                                 i2c_smbus_write_byte_data(&(cpld_client_bus1), CPLD_REG_MUX, 0x00);
                             }
                             else
                             {
-                                memset(&(data->qsfpPortDataA0[i * 2][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->qsfpPortDataA2[i * 2][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->SfpCopperPortData[i * 2][0]), 0, SFP_COPPER_DATA_SIZE);
-                                data->sfpPortDataValidAst[i * 2] = 0;
+                                memset(&(work->qsfpPortDataA0[i * 2][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->qsfpPortDataA2[i * 2][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->SfpCopperPortData[i * 2][0]), 0, SFP_COPPER_DATA_SIZE);
+                                work->sfpPortDataValidAst[i * 2] = 0;
                             }
                         }
 
                         for (i = 0; i < 12; i++)  /* SFP 1,3,5 ... 23 */
                         {
-                            if ((data->sfpPortAbsRxLosStatus[i] & 0x20) == 0)  /* present */
+                            if ((work->sfpPortAbsRxLosStatus[i] & 0x20) == 0)  /* present */
                             {
                                 ret = i2c_smbus_write_byte_data(&(cpld_client_bus1), CPLD_REG_MUX, (0x02 + (i * 2)));
                                 if (ret >= 0)
@@ -2239,24 +2421,24 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                                     ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                     if (ret >= 0)
                                     {
-                                        memcpy(&(data->qsfpPortDataA0[1 + (i * 2)][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                        data->sfpPortDataValidAst[1 + (i * 2)] = 1;
+                                        memcpy(&(work->qsfpPortDataA0[1 + (i * 2)][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                        work->sfpPortDataValidAst[1 + (i * 2)] = 1;
                                     }
                                     ret = eepromDataBlockRead(&qsfpDataA2_client,qsfpPortData);
                                     if (ret >= 0)
-                                        memcpy(&(data->qsfpPortDataA2[1 + (i * 2)][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                        memcpy(&(work->qsfpPortDataA2[1 + (i * 2)][0]), qsfpPortData, QSFP_DATA_SIZE);
                                     ret = eepromDataWordRead(&SfpCopperData_client,SfpCopperPortData);
                                     if (ret>=0)
-                                        memcpy(&(data->SfpCopperPortData[1 + (i * 2)][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
+                                        memcpy(&(work->SfpCopperPortData[1 + (i * 2)][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
                                 }
                                 i2c_smbus_write_byte_data(&(cpld_client_bus1), CPLD_REG_MUX, 0x00);
                             }
                             else
                             {
-                                memset(&(data->qsfpPortDataA0[1 + (i * 2)][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->qsfpPortDataA2[1 + (i * 2)][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->SfpCopperPortData[1 + (i * 2)][0]), 0, SFP_COPPER_DATA_SIZE);
-                                data->sfpPortDataValidAst[1 + (i * 2)] = 0;
+                                memset(&(work->qsfpPortDataA0[1 + (i * 2)][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->qsfpPortDataA2[1 + (i * 2)][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->SfpCopperPortData[1 + (i * 2)][0]), 0, SFP_COPPER_DATA_SIZE);
+                                work->sfpPortDataValidAst[1 + (i * 2)] = 0;
                             }
                          }
 
@@ -2271,7 +2453,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                         for (i = 0; i < 12; i++)  /* SFP 24,26,28 ... 46 */
                         {
-                            if ((data->sfpPortAbsRxLosStatus[i + 12] & 0x02) == 0)  /* present */
+                            if ((work->sfpPortAbsRxLosStatus[i + 12] & 0x02) == 0)  /* present */
                             {
                                 ret = i2c_smbus_write_byte_data(&(cpld_client_bus1), CPLD_REG_MUX, (0x01 + (i * 2)));
                                 if (ret >= 0)
@@ -2279,30 +2461,30 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                                     ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                     if (ret >= 0)
                                     {
-                                        memcpy(&(data->qsfpPortDataA0[(i +12) * 2][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                        data->sfpPortDataValidAst[(i + 12) * 2] = 1;
+                                        memcpy(&(work->qsfpPortDataA0[(i +12) * 2][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                        work->sfpPortDataValidAst[(i + 12) * 2] = 1;
                                     }
                                     ret = eepromDataBlockRead(&qsfpDataA2_client,qsfpPortData);
                                     if (ret >= 0)
-                                        memcpy(&(data->qsfpPortDataA2[(i + 12) * 2][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                        memcpy(&(work->qsfpPortDataA2[(i + 12) * 2][0]), qsfpPortData, QSFP_DATA_SIZE);
                                     ret = eepromDataWordRead(&SfpCopperData_client,SfpCopperPortData);
                                     if (ret>=0)
-                                        memcpy(&(data->SfpCopperPortData[(i + 12) * 2][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
+                                        memcpy(&(work->SfpCopperPortData[(i + 12) * 2][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
                                 }
                                 i2c_smbus_write_byte_data(&(cpld_client_bus1), CPLD_REG_MUX, 0x00);
                             }
                             else
                             {
-                                memset(&(data->qsfpPortDataA0[(i + 12) * 2][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->qsfpPortDataA2[(i + 12) * 2][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->SfpCopperPortData[(i + 12) * 2][0]), 0, SFP_COPPER_DATA_SIZE);
-                                data->sfpPortDataValidAst[(i + 12) * 2] = 0;
+                                memset(&(work->qsfpPortDataA0[(i + 12) * 2][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->qsfpPortDataA2[(i + 12) * 2][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->SfpCopperPortData[(i + 12) * 2][0]), 0, SFP_COPPER_DATA_SIZE);
+                                work->sfpPortDataValidAst[(i + 12) * 2] = 0;
                             }
                         }
 
                         for (i = 0; i < 12; i++)  /* SFP 25,27,29 ... 47 */
                         {
-                            if ((data->sfpPortAbsRxLosStatus[i + 12] & 0x20) == 0)  /* present */
+                            if ((work->sfpPortAbsRxLosStatus[i + 12] & 0x20) == 0)  /* present */
                             {
                                 ret = i2c_smbus_write_byte_data(&(cpld_client_bus1), CPLD_REG_MUX, (0x02 + (i * 2)));
                                 if (ret >= 0)
@@ -2310,24 +2492,24 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                                     ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                     if (ret >= 0)
                                     {
-                                        memcpy(&(data->qsfpPortDataA0[1 + ((i + 12) * 2)][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                        data->sfpPortDataValidAst[1 + ((i + 12) * 2)] = 1;
+                                        memcpy(&(work->qsfpPortDataA0[1 + ((i + 12) * 2)][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                        work->sfpPortDataValidAst[1 + ((i + 12) * 2)] = 1;
                                     }
                                     ret = eepromDataBlockRead(&qsfpDataA2_client,qsfpPortData);
                                     if (ret >= 0)
-                                        memcpy(&(data->qsfpPortDataA2[1 + ((i + 12) * 2)][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                        memcpy(&(work->qsfpPortDataA2[1 + ((i + 12) * 2)][0]), qsfpPortData, QSFP_DATA_SIZE);
                                     ret = eepromDataWordRead(&SfpCopperData_client,SfpCopperPortData);
                                     if (ret>=0)
-                                        memcpy(&(data->SfpCopperPortData[1 + ((i + 12) * 2)][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
+                                        memcpy(&(work->SfpCopperPortData[1 + ((i + 12) * 2)][0]), SfpCopperPortData, SFP_COPPER_DATA_SIZE);
                                 }
                                 i2c_smbus_write_byte_data(&(cpld_client_bus1), CPLD_REG_MUX, 0x00);
                             }
                             else
                             {
-                                memset(&(data->qsfpPortDataA0[1 + ((i + 12) * 2)][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->qsfpPortDataA2[1 + ((i + 12) * 2)][0]), 0, QSFP_DATA_SIZE);
-                                memset(&(data->SfpCopperPortData[1 + ((i + 12) * 2)][0]), 0, SFP_COPPER_DATA_SIZE);
-                                data->sfpPortDataValidAst[1 + ((i + 12) * 2)] = 0;
+                                memset(&(work->qsfpPortDataA0[1 + ((i + 12) * 2)][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->qsfpPortDataA2[1 + ((i + 12) * 2)][0]), 0, QSFP_DATA_SIZE);
+                                memset(&(work->SfpCopperPortData[1 + ((i + 12) * 2)][0]), 0, SFP_COPPER_DATA_SIZE);
+                                work->sfpPortDataValidAst[1 + ((i + 12) * 2)] = 0;
                             }
                         }
 
@@ -2342,7 +2524,7 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                         for (i = 0; i < 16; i++)  /* QSFP 48~63 */
                         {
-                            if ((data->qsfpPortAbsStatusAst[i] & 0x02) == 0)  /* present */
+                            if ((work->qsfpPortAbsStatusAst[i] & 0x02) == 0)  /* present */
                             {
                                 ret = i2c_smbus_write_byte_data(&(cpld_client_bus1), CPLD_REG_MUX, (0x01 + i));
                                 if (ret >= 0)
@@ -2355,16 +2537,16 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                                     ret = eepromDataBlockRead(&qsfpDataA0_client,qsfpPortData);
                                     if (ret >= 0)
                                     {
-                                        memcpy(&(data->qsfpPortDataA0[48 + i][0]), qsfpPortData, QSFP_DATA_SIZE);
-                                        data->sfpPortDataValidAst[48 + i] = 1;
+                                        memcpy(&(work->qsfpPortDataA0[48 + i][0]), qsfpPortData, QSFP_DATA_SIZE);
+                                        work->sfpPortDataValidAst[48 + i] = 1;
                                     }
                                 }
                                 i2c_smbus_write_byte_data(&(cpld_client_bus1), CPLD_REG_MUX, 0x00);
                              }
                              else
                              {
-                                 memset(&(data->qsfpPortDataA0[48 + i][0]), 0, QSFP_DATA_SIZE);
-                                 data->sfpPortDataValidAst[48 + i] = 0;
+                                 memset(&(work->qsfpPortDataA0[48 + i][0]), 0, QSFP_DATA_SIZE);
+                                 work->sfpPortDataValidAst[48 + i] = 0;
                                  data->qsfpPortTxDisableDataUpdate[48 + i] = 1;
                              }
                         }
@@ -2412,9 +2594,9 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
 
                         /* FAN Status */
                         value = i2c_smbus_read_word_data(&(pca9535pwr_client[0]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
-                        data->fanAbs[0] = (value & 0x4444);
-                        data->fanDir[0] = (value & 0x8888);
-                        FanDir = data->fanDir[0];
+                        work->fanAbs[0] = (value & 0x4444);
+                        work->fanDir[0] = (value & 0x8888);
+                        FanDir = work->fanDir[0];
 
                         fanErr2 = 0;
                         for (i = W83795ADG_NUM8; i < W83795ADG_FAN_COUNT; i++)
@@ -2435,9 +2617,9 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
                         /* FAN Status */
                         value2 = i2c_smbus_read_word_data(&(pca9535pwr_client[1]), PCA9553_COMMAND_BYTE_REG_INPUT_PORT_0);
 
-                        data->fanAbs[1] = (value2 & 0x0040);
-                        data->fanDir[1] = (value2 & 0x0080);
-                        FanDir2 = data->fanDir[1];
+                        work->fanAbs[1] = (value2 & 0x0040);
+                        work->fanDir[1] = (value2 & 0x0080);
+                        FanDir2 = work->fanDir[1];
 
                         /* Turn on PCA9548#0 channel 4 on I2C-bus1 : System LED */
                         ret = i2c_smbus_write_byte(client, (1 << PCA9548_CH04));
@@ -2498,9 +2680,15 @@ static int i2c_bus1_hardware_monitor_update_thread(void *p)
         }
         mutex_unlock(&data->lock);
 
+        write_seqlock(&data->snapshot_lock);
+        memcpy(&data->ports, work, sizeof(data->ports));
+        data->hardware_monitor_last_updated = jiffies;
+        data->hardware_monitor_data_valid = 1;
+        write_sequnlock(&data->snapshot_lock);
+
         if (kthread_should_stop())
             break;
-        msleep_interruptible(200);
+        msleep_interruptible(HW_MONITOR_TICK);
     } /* End of while (!kthread_should_stop()) */
 
     complete_all(&data->auto_update_stop);
@@ -2547,11 +2735,11 @@ static ssize_t show_psu_pg_sen(struct device *dev, struct device_attribute *deva
     struct sensor_device_attribute *attr = to_sensor_dev_attr(devattr);
     struct i2c_client *client = to_i2c_client(dev);
     struct i2c_bus0_hardware_monitor_data *data = i2c_get_clientdata(client);
+    struct i2c_bus0_hardware_monitor_sensors sensors;
     unsigned int value;
 
-    mutex_lock(&data->lock);
-    value = data->psuPG;
-    mutex_unlock(&data->lock);
+    i2c_bus0_hardware_monitor_sensors_get(data, &sensors);
+    value = sensors.psuPG;
 
     switch(platformModelId)
     {
@@ -2582,11 +2770,11 @@ static ssize_t show_psu_abs_sen(struct device *dev, struct device_attribute *dev
     struct sensor_device_attribute *attr = to_sensor_dev_attr(devattr);
     struct i2c_client *client = to_i2c_client(dev);
     struct i2c_bus0_hardware_monitor_data *data = i2c_get_clientdata(client);
+    struct i2c_bus0_hardware_monitor_sensors sensors;
     unsigned int value;
 
-    mutex_lock(&data->lock);
-    value = data->psuABS;
-    mutex_unlock(&data->lock);
+    i2c_bus0_hardware_monitor_sensors_get(data, &sensors);
+    value = sensors.psuABS;
 
     if (attr->index == 0)
         value &= 0x01;
@@ -2600,10 +2788,12 @@ static ssize_t show_fan_rpm(struct device *dev, struct device_attribute *devattr
     struct sensor_device_attribute *attr = to_sensor_dev_attr(devattr);
     struct i2c_client *client = to_i2c_client(dev);
     struct i2c_bus0_hardware_monitor_data *data = i2c_get_clientdata(client);
+    struct i2c_bus0_hardware_monitor_sensors sensors;
     unsigned int fanSpeed = 0;
 
+    i2c_bus0_hardware_monitor_sensors_get(data, &sensors);
     if (attr->index < W83795ADG_FAN_COUNT)
-        fanSpeed = data->fanSpeed[attr->index];
+        fanSpeed = sensors.fanSpeed[attr->index];
     return sprintf(buf, "%d\n", fanSpeed);
 }
 
@@ -2624,11 +2814,13 @@ static ssize_t show_remote_temp(struct device *dev, struct device_attribute *dev
     struct sensor_device_attribute *attr = to_sensor_dev_attr(devattr);
     struct i2c_client *client = to_i2c_client(dev);
     struct i2c_bus0_hardware_monitor_data *data = i2c_get_clientdata(client);
+    struct i2c_bus0_hardware_monitor_sensors sensors;
 
-    if (data->remoteTempIsPositive[attr->index]==1)
-        return sprintf(buf, "%d.%d\n", data->remoteTempInt[attr->index], data->remoteTempDecimal[attr->index]);
+    i2c_bus0_hardware_monitor_sensors_get(data, &sensors);
+    if (sensors.remoteTempIsPositive[attr->index]==1)
+        return sprintf(buf, "%d.%d\n", sensors.remoteTempInt[attr->index], sensors.remoteTempDecimal[attr->index]);
     else
-        return sprintf(buf, "-%d.%d\n", data->remoteTempInt[attr->index], data->remoteTempDecimal[attr->index]);
+        return sprintf(buf, "-%d.%d\n", sensors.remoteTempInt[attr->index], sensors.remoteTempDecimal[attr->index]);
 }
 
 static ssize_t show_mac_temp(struct device *dev, struct device_attribute *devattr, char *buf)
@@ -2918,13 +3110,13 @@ static ssize_t show_voltage_sen(struct device *dev, struct device_attribute *dev
     struct sensor_device_attribute *attr = to_sensor_dev_attr(devattr);
     struct i2c_client *client = to_i2c_client(dev);
     struct i2c_bus0_hardware_monitor_data *data = i2c_get_clientdata(client);
+    struct i2c_bus0_hardware_monitor_sensors sensors;
     unsigned int MNTVSEN, MNTV;
     unsigned int voltage;
 
-    mutex_lock(&data->lock);
-    MNTVSEN = data->vSen[attr->index];
-    MNTV = data->vSenLsb[attr->index];
-    mutex_unlock(&data->lock);
+    i2c_bus0_hardware_monitor_sensors_get(data, &sensors);
+    MNTVSEN = sensors.vSen[attr->index];
+    MNTV = sensors.vSenLsb[attr->index];
 
     voltage = ((MNTVSEN << 2) + ((MNTV & 0xC0) >> 6));
     voltage *= ((2*VOL_MONITOR_UNIT)/VOL_MONITOR_UNIT);
@@ -2938,11 +3130,13 @@ static ssize_t show_temp_lm_sensors(struct device *dev, struct device_attribute
     struct sensor_device_attribute *attr = to_sensor_dev_attr(devattr);
     struct i2c_client *client = to_i2c_client(dev);
     struct i2c_bus0_hardware_monitor_data *data = i2c_get_clientdata(client);
+    struct i2c_bus0_hardware_monitor_sensors sensors;
 
-    if (data->remoteTempIsPositive[attr->index]==1)
-        return sprintf(buf, "%u\n", data->remoteTempInt[attr->index] * 1000 + data->remoteTempDecimal[attr->index]);
+    i2c_bus0_hardware_monitor_sensors_get(data, &sensors);
+    if (sensors.remoteTempIsPositive[attr->index]==1)
+        return sprintf(buf, "%u\n", sensors.remoteTempInt[attr->index] * 1000 + sensors.remoteTempDecimal[attr->index]);
     else
-        return sprintf(buf, "-%u\n", data->remoteTempInt[attr->index] * 1000 + data->remoteTempDecimal[attr->index]);
+        return sprintf(buf, "-%u\n", sensors.remoteTempInt[attr->index] * 1000 + sensors.remoteTempDecimal[attr->index]);
 }
 
 static ssize_t show_mac_temp_lm_sensors(struct device *dev, struct device_attribute *devattr, char *buf)
@@ -2958,13 +3152,13 @@ static ssize_t show_in_lm_sensors(struct device *dev, struct device_attribute *d
     struct sensor_device_attribute *attr = to_sensor_dev_attr(devattr);
     struct i2c_client *client = to_i2c_client(dev);
     struct i2c_bus0_hardware_monitor_data *data = i2c_get_clientdata(client);
+    struct i2c_bus0_hardware_monitor_sensors sensors;
     unsigned int MNTVSEN, MNTV;
     unsigned int voltage;
 
-    mutex_lock(&data->lock);
-    MNTVSEN = data->vSen[attr->index];
-    MNTV = data->vSenLsb[attr->index];
-    mutex_unlock(&data->lock);
+    i2c_bus0_hardware_monitor_sensors_get(data, &sensors);
+    MNTVSEN = sensors.vSen[attr->index];
+    MNTV = sensors.vSenLsb[attr->index];
 
     voltage = ((MNTVSEN << 2) + ((MNTV & 0xC0) >> 6));
     voltage *= ((2*VOL_MONITOR_UNIT)/VOL_MONITOR_UNIT);
@@ -2972,6 +3166,41 @@ static ssize_t show_in_lm_sensors(struct device *dev, struct device_attribute *d
     return sprintf(buf, "%u\n", (voltage/VOL_MONITOR_UNIT) * 1000 + voltage%VOL_MONITOR_UNIT);
 }
 
+/* Time of the last published update, in ms since boot. 0 until the first update. */
+static ssize_t show_last_updated(struct device *dev, struct device_attribute *devattr, char *buf)
+{
+    struct i2c_client *client = to_i2c_client(dev);
+    unsigned long updated = 0;
+    char valid = 0;
+    unsigned int seq;
+
+    if (client->adapter->nr == 0x0)
+    {
+        struct i2c_bus0_hardware_monitor_data *data = i2c_get_clientdata(client);
+
+        do {
+            seq = read_seqbegin(&data->snapshot_lock);
+            valid = data->hardware_monitor_data_valid;
+            updated = data->hardware_monitor_last_updated;
+        } while (read_seqretry(&data->snapshot_lock, seq));
+    }
+    else
+    {
+        struct i2c_bus1_hardware_monitor_data *data = i2c_get_clientdata(client);
+
+        do {
+            seq = read_seqbegin(&data->snapshot_lock);
+            valid = data->hardware_monitor_data_valid;
+            updated = data->hardware_monitor_last_updated;
+        } while (read_seqretry(&data->snapshot_lock, seq));
+    }
+
+    if (!valid)
+        return sprintf(buf, "0\n");
+    return sprintf(buf, "%u\n", jiffies_to_msecs(updated - INITIAL_JIFFIES));
+}
+
+static DEVICE_ATTR(last_updated, S_IRUGO, show_last_updated, NULL);
 static DEVICE_ATTR(mac_temp, S_IWUSR | S_IRUGO, show_mac_temp, set_mac_temp);
 static DEVICE_ATTR(chip_info, S_IRUGO, show_chip_info, NULL);
 static DEVICE_ATTR(board_build_rev, S_IRUGO, show_board_build_revision, NULL);
@@ -3153,6 +3382,7 @@ static SENSOR_DEVICE_ATTR(in7_max, S_IRUGO, show_in_minmax_lm_sensors, NULL, 106
 
 static struct attribute *i2c_bus0_hardware_monitor_attr[] = {
     &dev_attr_mac_temp.attr,
+    &dev_attr_last_updated.attr,
     &dev_attr_chip_info.attr,
     &dev_attr_board_build_rev.attr,
     &dev_attr_board_hardware_rev.attr,
@@ -3257,6 +3487,7 @@ static struct attribute *i2c_bus0_hardware_monitor_attr[] = {
 
 static struct attribute *i2c_bus0_hardware_monitor_attr_nc2x[] = {
     &dev_attr_mac_temp.attr,
+    &dev_attr_last_updated.attr,
     &dev_attr_chip_info.attr,
     &dev_attr_board_build_rev.attr,
     &dev_attr_board_hardware_rev.attr,
@@ -3361,6 +3592,7 @@ static struct attribute *i2c_bus0_hardware_monitor_attr_nc2x[] = {
 
 static struct attribute *i2c_bus0_hardware_monitor_attr_asterion[] = {
     &dev_attr_mac_temp.attr,
+    &dev_attr_last_updated.attr,
     &dev_attr_chip_info.attr,
     &dev_attr_board_build_rev.attr,
     &dev_attr_board_hardware_rev.attr,
@@ -3488,6 +3720,7 @@ static ssize_t show_port_abs(struct device *dev, struct device_attribute *devatt
     struct i2c_bus1_hardware_monitor_data *data = i2c_get_clientdata(&(pca9535pwr_client[0]));
     struct i2c_bus1_hardware_monitor_data *dataAst = i2c_get_clientdata(&(cpld_client_bus1));
     int rc = 0;
+    unsigned int seq;
 
     switch(platformModelId)
     {
@@ -3506,19 +3739,21 @@ static ssize_t show_port_abs(struct device *dev, struct device_attribute *devatt
             {
                 index = (attr->index / 2);
                 bit = ((attr->index & 0x01) ? 5 : 1);
-                mutex_lock(&dataAst->lock);
-                qsfpPortAbsAst = dataAst->sfpPortAbsRxLosStatus[index];
-                sfpPortDataValidAst = dataAst->sfpPortDataValidAst[attr->index];
-                mutex_unlock(&dataAst->lock);
+                do {
+                    seq = read_seqbegin(&dataAst->snapshot_lock);
+                    qsfpPortAbsAst = dataAst->ports.sfpPortAbsRxLosStatus[index];
+                    sfpPortDataValidAst = dataAst->ports.sfpPortDataValidAst[attr->index];
+                } while (read_seqretry(&dataAst->snapshot_lock, seq));
                 rc = ((PCA9553_TEST_BIT(qsfpPortAbsAst, bit) ? 0 : 1)&&sfpPortDataValidAst);
             }
             else
             {
                 index = (attr->index % 48);
-                mutex_lock(&dataAst->lock);
-                qsfpPortAbsAst = dataAst->qsfpPortAbsStatusAst[index];
-                sfpPortDataValidAst = dataAst->sfpPortDataValidAst[attr->index];
-                mutex_unlock(&dataAst->lock);
+                do {
+                    seq = read_seqbegin(&dataAst->snapshot_lock);
+                    qsfpPortAbsAst = dataAst->ports.qsfpPortAbsStatusAst[index];
+                    sfpPortDataValidAst = dataAst->ports.sfpPortDataValidAst[attr->index];
+                } while (read_seqretry(&dataAst->snapshot_lock, seq));
                 rc = ((PCA9553_TEST_BIT(qsfpPortAbsAst, 1) ? 0 : 1)&&sfpPortDataValidAst);
             }
         }
@@ -3531,10 +3766,11 @@ static ssize_t show_port_abs(struct device *dev, struct device_attribute *devatt
 
             index = (attr->index/16);
             bit = (attr->index%16);
-            mutex_lock(&data->lock);
-            qsfpPortAbs = data->qsfpPortAbsStatus[index];
-            qsfpPortDataValid = data->qsfpPortDataValid[index];
-            mutex_unlock(&data->lock);
+            do {
+                seq = read_seqbegin(&data->snapshot_lock);
+                qsfpPortAbs = data->ports.qsfpPortAbsStatus[index];
+                qsfpPortDataValid = data->ports.qsfpPortDataValid[index];
+            } while (read_seqretry(&data->snapshot_lock, seq));
             rc = ((PCA9553_TEST_BIT(qsfpPortAbs, bit)?0:1)&&(PCA9553_TEST_BIT(qsfpPortDataValid, bit)));
         }
             break;
@@ -3548,6 +3784,7 @@ static ssize_t show_port_rxlos(struct device *dev, struct device_attribute *deva
     struct sensor_device_attribute *attr = to_sensor_dev_attr(devattr);
     struct i2c_bus1_hardware_monitor_data *data = i2c_get_clientdata(&(pca9535pwr_client[0]));
     int rc = 0;
+    unsigned int seq;
 
     switch(platformModelId)
     {
@@ -3563,9 +3800,10 @@ static ssize_t show_port_rxlos(struct device *dev, struct device_attribute *deva
 
             index = (attr->index/16);
             bit = (attr->index%16);
-            mutex_lock(&data->lock);
-            qsfpPortRxLos = data->sfpPortRxLosStatus[index];
-            mutex_unlock(&data->lock);
+            do {
+                seq = read_seqbegin(&data->snapshot_lock);
+                qsfpPortRxLos = data->ports.sfpPortRxLosStatus[index];
+            } while (read_seqretry(&data->snapshot_lock, seq));
             rc = (PCA9553_TEST_BIT(qsfpPortRxLos, bit)?1:0);
         }
             break;
@@ -3577,9 +3815,10 @@ static ssize_t show_port_rxlos(struct device *dev, struct device_attribute *deva
 
             index = (attr->index / 2);
             bit = ((attr->index & 0x01) ? 4 : 0);
-            mutex_lock(&data->lock);
-            qsfpPortRxLos = data->sfpPortAbsRxLosStatus[index];
-            mutex_unlock(&data->lock);
+            do {
+                seq = read_seqbegin(&data->snapshot_lock);
+                qsfpPortRxLos = data->ports.sfpPortAbsRxLosStatus[index];
+            } while (read_seqretry(&data->snapshot_lock, seq));
             rc = (PCA9553_TEST_BIT(qsfpPortRxLos, bit) ? 1 : 0);
         }
             break;
@@ -3597,11 +3836,13 @@ static ssize_t show_port_data_a0(struct device *dev, struct device_attribute *de
     struct i2c_bus1_hardware_monitor_data *data = i2c_get_clientdata(&qsfpDataA0_client);
     unsigned char qsfpPortData[QSFP_DATA_SIZE];
     ssize_t count = 0;
+    unsigned int seq;
 
     memset(qsfpPortData, 0, QSFP_DATA_SIZE);
-    mutex_lock(&data->lock);
-    memcpy(qsfpPortData, &(data->qsfpPortDataA0[attr->index][0]), QSFP_DATA_SIZE);
-    mutex_unlock(&data->lock);
+    do {
+        seq = read_seqbegin(&data->snapshot_lock);
+        memcpy(qsfpPortData, &(data->ports.qsfpPortDataA0[attr->index][0]), QSFP_DATA_SIZE);
+    } while (read_seqretry(&data->snapshot_lock, seq));
 
     count = QSFP_DATA_SIZE;
     memcpy(buf, (char *)qsfpPortData, QSFP_DATA_SIZE);
@@ -3615,11 +3856,13 @@ static ssize_t show_port_data_a2(struct device *dev, struct device_attribute *de
     struct i2c_bus1_hardware_monitor_data *data = i2c_get_clientdata(&qsfpDataA2_client);
     unsigned char qsfpPortData[QSFP_DATA_SIZE];
     ssize_t count = 0;
+    unsigned int seq;
 
     memset(qsfpPortData, 0, QSFP_DATA_SIZE);
-    mutex_lock(&data->lock);
-    memcpy(qsfpPortData, &(data->qsfpPortDataA2[attr->index][0]), QSFP_DATA_SIZE);
-    mutex_unlock(&data->lock);
+    do {
+        seq = read_seqbegin(&data->snapshot_lock);
+        memcpy(qsfpPortData, &(data->ports.qsfpPortDataA2[attr->index][0]), QSFP_DATA_SIZE);
+    } while (read_seqretry(&data->snapshot_lock, seq));
 
     count = QSFP_DATA_SIZE;
     memcpy(buf, (char *)qsfpPortData, QSFP_DATA_SIZE);
@@ -3633,11 +3876,13 @@ static ssize_t show_port_sfp_copper(struct device *dev, struct device_attribute
     struct i2c_bus1_hardware_monitor_data *data = i2c_get_clientdata(&SfpCopperData_client);
     unsigned char SfpCopperPortData[SFP_COPPER_DATA_SIZE];
     ssize_t count = 0;
+    unsigned int seq;
 
     memset(SfpCopperPortData, 0, SFP_COPPER_DATA_SIZE);
-    mutex_lock(&data->lock);
-    memcpy(SfpCopperPortData, &(data->SfpCopperPortData[attr->index][0]), SFP_COPPER_DATA_SIZE);
-    mutex_unlock(&data->lock);
+    do {
+        seq = read_seqbegin(&data->snapshot_lock);
+        memcpy(SfpCopperPortData, &(data->ports.SfpCopperPortData[attr->index][0]), SFP_COPPER_DATA_SIZE);
+    } while (read_seqretry(&data->snapshot_lock, seq));
 
     count = SFP_COPPER_DATA_SIZE;
     memcpy(buf, (char *)SfpCopperPortData, SFP_COPPER_DATA_SIZE);
@@ -3652,19 +3897,21 @@ static ssize_t show_fan_abs(struct device *dev, struct device_attribute *devattr
     struct i2c_bus1_hardware_monitor_data *data = i2c_get_clientdata(client);
     unsigned int value = 0;
     unsigned int index = 0;
+    unsigned int seq;
 
-    mutex_lock(&data->lock);
-    if (attr->index<4)
-    {
-        value = (unsigned int)data->fanAbs[0];
-        index = attr->index;
-    }
-    else
-    {
-        value = (unsigned int)data->fanAbs[1];
-        index = (attr->index-3);
-    }
-    mutex_unlock(&data->lock);
+    do {
+        seq = read_seqbegin(&data->snapshot_lock);
+        if (attr->index<4)
+        {
+            value = (unsigned int)data->ports.fanAbs[0];
+            index = attr->index;
+        }
+        else
+        {
+            value = (unsigned int)data->ports.fanAbs[1];
+            index = (attr->index-3);
+        }
+    } while (read_seqretry(&data->snapshot_lock, seq));
 
     value &= (0x0004<<(index*4));
     return sprintf(buf, "%d\n", value?0:1);
@@ -3677,19 +3924,21 @@ static ssize_t show_fan_dir(struct device *dev, struct device_attribute *devattr
     struct i2c_bus1_hardware_monitor_data *data = i2c_get_clientdata(client);
     unsigned int value = 0;
     unsigned int index = 0;
+    unsigned int seq;
 
-    mutex_lock(&data->lock);
-    if (attr->index<4)
-    {
-        value = (unsigned int)data->fanDir[0];
-        index = attr->index;
-    }
-    else
-    {
-        value = (unsigned int)data->fanDir[1];
-        index = (attr->index-3);
-    }
-    mutex_unlock(&data->lock);
+    do {
+        seq = read_seqbegin(&data->snapshot_lock);
+        if (attr->index<4)
+        {
+            value = (unsigned int)data->ports.fanDir[0];
+            index = attr->index;
+        }
+        else
+        {
+            value = (unsigned int)data->ports.fanDir[1];
+            index = (attr->index-3);
+        }
+    } while (read_seqretry(&data->snapshot_lock, seq));
 
     value &= (0x0008<<(index*4));
     return sprintf(buf, "%d\n", value?0:1);
@@ -5485,6 +5734,7 @@ static ssize_t show_port_tx_fault(struct device *dev, struct device_attribute *d
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(devattr);
     int rc = 0;
+    unsigned int seq;
 
     switch(platformModelId)
     {
@@ -5496,9 +5746,10 @@ static ssize_t show_port_tx_fault(struct device *dev, struct device_attribute *d
 
             index = (attr->index / 16);
             bit = (attr->index % 16);
-            mutex_lock(&data->lock);
-            rc = (PCA9553_TEST_BIT(data->sfpPortTxFaultStatus[index], bit) ? 1 : 0);
-            mutex_unlock(&data->lock);
+            do {
+                seq = read_seqbegin(&data->snapshot_lock);
+                rc = (PCA9553_TEST_BIT(data->ports.sfpPortTxFaultStatus[index], bit) ? 1 : 0);
+            } while (read_seqretry(&data->snapshot_lock, seq));
         }
             break;
 
@@ -5517,9 +5768,10 @@ static ssize_t show_port_tx_fault(struct device *dev, struct device_attribute *d
 
             index = (attr->index / 2);
             bit = ((attr->index & 0x01) ? 7 : 3);
-            mutex_lock(&data->lock);
-            qsfpPortRxLos = data->sfpPortAbsRxLosStatus[index];
-            mutex_unlock(&data->lock);
+            do {
+                seq = read_seqbegin(&data->snapshot_lock);
+                qsfpPortRxLos = data->ports.sfpPortAbsRxLosStatus[index];
+            } while (read_seqretry(&data->snapshot_lock, seq));
             rc = (PCA9553_TEST_BIT(qsfpPortRxLos, bit) ? 1 : 0);
         }
             break;
@@ -5998,6 +6250,7 @@ static SENSOR_DEVICE_ATTR(fan21_input, S_IRUGO, show_psu_fan_speed, NULL, 101);
 
 static struct attribute *i2c_bus1_hardware_monitor_attr_huracan[] = {
     &dev_attr_eeprom.attr,
+    &dev_attr_last_updated.attr,
     &dev_attr_system_led.attr,
     &dev_attr_fan_led.attr,
     &sensor_dev_attr_psu1_led.dev_attr.attr,
@@ -6188,6 +6441,7 @@ static struct attribute *i2c_bus1_hardware_monitor_attr_huracan[] = {
 
 static struct attribute *i2c_bus1_hardware_monitor_attr_sesto[] = {
     &dev_attr_eeprom.attr,
+    &dev_attr_last_updated.attr,
     &dev_attr_system_led.attr,
     &dev_attr_fan_led.attr,
     &sensor_dev_attr_psu1_led.dev_attr.attr,
@@ -6613,6 +6867,7 @@ static struct attribute *i2c_bus1_hardware_monitor_attr_sesto[] = {
 
 static struct attribute *i2c_bus1_hardware_monitor_attr_nc2x[] = {
     &dev_attr_eeprom.attr,
+    &dev_attr_last_updated.attr,
     &dev_attr_system_led.attr,
     &dev_attr_fan_led.attr,
     &sensor_dev_attr_psu1_led.dev_attr.attr,
@@ -6989,6 +7244,7 @@ static struct attribute *i2c_bus1_hardware_monitor_attr_nc2x[] = {
 
 static struct attribute *i2c_bus1_hardware_monitor_attr_asterion[] = {
     &dev_attr_eeprom.attr,
+    &dev_attr_last_updated.attr,
     &dev_attr_system_led.attr,
     &dev_attr_fan_led.attr,
     &sensor_dev_attr_psu1_led.dev_attr.attr,
@@ -7450,7 +7706,7 @@ static struct attribute *i2c_bus1_hardware_monitor_attr_asterion[] = {
     NULL
 };
 
-static int is_port_present(struct i2c_bus1_hardware_monitor_data *data, int port)
+static int is_port_present(const struct i2c_bus1_hardware_monitor_ports *ports, int port)
 {
     int rc = 0;
 
@@ -7471,15 +7727,15 @@ static int is_port_present(struct i2c_bus1_hardware_monitor_data *data, int port
             {
                 index = (port / 2);
                 bit = ((port & 0x01) ? 5 : 1);
-                qsfpPortAbsAst = data->sfpPortAbsRxLosStatus[index];
-                sfpPortDataValidAst = data->sfpPortDataValidAst[port];
+                qsfpPortAbsAst = ports->sfpPortAbsRxLosStatus[index];
+                sfpPortDataValidAst = ports->sfpPortDataValidAst[port];
                 rc = ((PCA9553_TEST_BIT(qsfpPortAbsAst, bit) ? 0 : 1) && (sfpPortDataValidAst));
             }
             else
             {
                 index = (port % 48);
-                qsfpPortAbsAst = data->qsfpPortAbsStatusAst[index];
-                sfpPortDataValidAst = data->sfpPortDataValidAst[port];
+                qsfpPortAbsAst = ports->qsfpPortAbsStatusAst[index];
+                sfpPortDataValidAst = ports->sfpPortDataValidAst[port];
                 rc = ((PCA9553_TEST_BIT(qsfpPortAbsAst, 1) ? 0 : 1) && (sfpPortDataValidAst));
             }
         }
@@ -7492,8 +7748,8 @@ static int is_port_present(struct i2c_bus1_hardware_monitor_data *data, int port
 
             index = (port / 16);
             bit = (port % 16);
-            qsfpPortAbs = data->qsfpPortAbsStatus[index];
-            qsfpPortDataValid = data->qsfpPortDataValid[index];
+            qsfpPortAbs = ports->qsfpPortAbsStatus[index];
+            qsfpPortDataValid = ports->qsfpPortDataValid[index];
             rc = ((PCA9553_TEST_BIT(qsfpPortAbs, bit) ? 0 : 1) && (PCA9553_TEST_BIT(qsfpPortDataValid, bit)));
         }
             break;
@@ -7509,19 +7765,23 @@ static ssize_t get_qsfp_port_tx_rx_status(struct device *dev, struct device_attr
     struct i2c_client *client = to_i2c_client(dev);
     struct sensor_device_attribute *attr = to_sensor_dev_attr(devattr);
     int index = (client->addr - 1);
-    int val = 0;
+    int val = 0, present;
+    unsigned int seq;
 
     memset(qsfpPortData, 0, QSFP_DATA_SIZE);
 
-    mutex_lock(&data->lock);
-    if (is_port_present(data, index) == 1)
-        memcpy(qsfpPortData, &(data->qsfpPortDataA0[index][0]), QSFP_DATA_SIZE);
-    else
+    do {
+        seq = read_seqbegin(&data->snapshot_lock);
+        present = is_port_present(&data->ports, index);
+        if (present == 1)
+            memcpy(qsfpPortData, &(data->ports.qsfpPortDataA0[index][0]), QSFP_DATA_SIZE);
+    } while (read_seqretry(&data->snapshot_lock, seq));
+
+    if (present != 1)
     {
         qsfpPortData[SFF8436_RX_LOS_ADDR] = qsfpPortData[SFF8436_TX_FAULT_ADDR] = 0xF;
         qsfpPortData[SFF8436_TX_DISABLE_ADDR] = data->qsfpPortTxDisableData[index];
     }
-    mutex_unlock(&data->lock);
 
     switch (attr->index)
     {
@@ -7660,6 +7920,7 @@ static ssize_t set_qsfp_port_tx_status(struct device *dev, struct device_attribu
     struct sensor_device_attribute *attr = to_sensor_dev_attr(devattr);
     int index = (client->addr - 1);
     long disable;
+    unsigned int seq;
 
     if (kstrtol(buf, 10, &disable))
         return -EINVAL;
@@ -7668,7 +7929,10 @@ static ssize_t set_qsfp_port_tx_status(struct device *dev, struct device_attribu
     memset(qsfpPortData, 0, QSFP_DATA_SIZE);
 
     mutex_lock(&data->lock);
-    memcpy(qsfpPortData, &(data->qsfpPortDataA0[index][0]), QSFP_DATA_SIZE);
+    do {
+        seq = read_seqbegin(&data->snapshot_lock);
+        memcpy(qsfpPortData, &(data->ports.qsfpPortDataA0[index][0]), QSFP_DATA_SIZE);
+    } while (read_seqretry(&data->snapshot_lock, seq));
     switch (attr->index)
     {
         case TX_DISABLE:
@@ -8461,6 +8725,7 @@ static int w83795adg_hardware_monitor_probe(struct i2c_client *client,
 
         memset(data, 0, sizeof(struct i2c_bus0_hardware_monitor_data));
         mutex_init(&data->lock);
+        seqlock_init(&data->snapshot_lock);
         i2c_set_clientdata(client, data);
 
         dev_info(&client->dev, "%s device found on bus %d\n", client->name, client->adapter->nr);
@@ -8518,6 +8783,7 @@ static int w83795adg_hardware_monitor_probe(struct i2c_client *client,
 
         memset(data, 0, sizeof(struct i2c_bus1_hardware_monitor_data));
         mutex_init(&data->lock);
+        seqlock_init(&data->snapshot_lock);
         i2c_set_clientdata(client, data);
 
         dev_info(&client->dev, "%s device found on bus %d\n", client->name, client->adapter->nr);